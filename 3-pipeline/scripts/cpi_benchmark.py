@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+CPI benchmark for the 3-pipeline CPU variants
+
+Runs every workload on the Verilator model of every variant until the
+workload reaches its idle loop (-halt-loop), reads the event counters the
+harness prints at exit (-perf) and prints a Markdown table of cycles, retired
+instructions, CPI, hazard stall cycles and control flushes.
+
+The models are expected in verilog/verilator/<variant>/obj_dir/VTop, which is
+what "make benchmark" builds. With --baseline, cycle counts are compared with
+an earlier --output file and the script fails if any of them grew by more
+than --tolerance percent.
+
+Usage:
+    python3 scripts/cpi_benchmark.py [--output now.csv] [--baseline before.csv]
+"""
+
+import argparse
+import csv
+import re
+import subprocess
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+STAGE_DIR = Path(__file__).resolve().parent.parent
+
+VARIANTS: List[str] = ['threestage', 'fivestage_stall', 'fivestage_forward', 'fivestage_final']
+PROGRAMS: List[str] = ['fibonacci', 'quicksort', 'hazard', 'hazard_extended', 'sb']
+FIELDS: List[str] = ['cycles', 'instret', 'cpi', 'hazard_stalls', 'control_flushes']
+
+PERF_LINE = re.compile(r'^perf: (.*)$', re.MULTILINE)
+
+
+def run(model: Path, program: Path, max_ticks: int) -> Optional[Dict[str, str]]:
+    """Runs one workload; returns the counters, or None if it never halted."""
+    result = subprocess.run(
+        [str(model), '-fast-clock', '-halt-loop', '-perf', '-time', str(max_ticks),
+         '-instruction', str(program)],
+        cwd=model.parent, capture_output=True, text=True)
+    match = PERF_LINE.search(result.stdout)
+    if result.returncode != 0 or 'Idle loop at' not in result.stdout or not match:
+        sys.stderr.write(f'{model.parent.parent.name}/{program.stem}: no idle loop '
+                         f'within {max_ticks} ticks (exit {result.returncode})\n')
+        return None
+    return dict(field.split('=', 1) for field in match.group(1).split())
+
+
+def load_baseline(path: Path) -> Dict[Tuple[str, str], int]:
+    with open(path, newline='') as f:
+        return {(row['variant'], row['program']): int(row['cycles']) for row in csv.DictReader(f)}
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='CPI benchmark for the 3-pipeline CPU variants.')
+    parser.add_argument('--variants', nargs='+', default=VARIANTS)
+    parser.add_argument('--programs', nargs='+', default=PROGRAMS)
+    parser.add_argument('--time', type=int, default=4000000,
+                        help='harness ticks per run (4 per CPU cycle)')
+    parser.add_argument('--output', type=Path, help='write the results as CSV')
+    parser.add_argument('--baseline', type=Path, help='CSV of an earlier run to compare cycles with')
+    parser.add_argument('--tolerance', type=float, default=0.0,
+                        help='allowed cycle growth over the baseline, in percent')
+    args = parser.parse_args()
+
+    rows: List[Dict[str, str]] = []
+    failed = False
+    for program in args.programs:
+        binary = STAGE_DIR / 'src/main/resources' / f'{program}.asmbin'
+        for variant in args.variants:
+            model = STAGE_DIR / 'verilog/verilator' / variant / 'obj_dir/VTop'
+            if not model.exists():
+                sys.exit(f'{model} not found; run "make benchmark" to build the models')
+            counters = run(model, binary, args.time)
+            if counters is None:
+                failed = True
+                continue
+            rows.append({'variant': variant, 'program': program, **counters})
+
+    baseline = load_baseline(args.baseline) if args.baseline else {}
+    print('| Workload | Variant | Cycles | Instret | CPI | Stall cycles | Flushes |' +
+          (' vs baseline |' if baseline else ''))
+    print('|---|---|---:|---:|---:|---:|---:|' + ('---:|' if baseline else ''))
+    for row in rows:
+        line = (f"| {row['program']} | {row['variant']} | {row['cycles']} | {row['instret']} "
+                f"| {row['cpi']} | {row['hazard_stalls']} | {row['control_flushes']} |")
+        before = baseline.get((row['variant'], row['program']))
+        if before:
+            growth = (int(row['cycles']) - before) * 100.0 / before
+            line += f' {growth:+.1f}% |'
+            if growth > args.tolerance:
+                failed = True
+        elif baseline:
+            line += ' new |'
+        print(line)
+
+    if args.output:
+        with open(args.output, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=['variant', 'program'] + FIELDS)
+            writer.writeheader()
+            writer.writerows(rows)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -10,10 +10,10 @@ import riscv.core.CPU
 import riscv.core.CPUBundle
 import riscv.ImplementationType
 
-class Top extends Module {
+class Top(implementation: Int = ImplementationType.ThreeStage) extends Module {
   val io = IO(new CPUBundle)
 
-  val cpu = Module(new CPU(implementation = ImplementationType.ThreeStage))
+  val cpu = Module(new CPU(implementation))
 
   io.device_select              := 0.U
   cpu.io.debug_read_address     := io.debug_read_address
@@ -29,9 +29,23 @@ class Top extends Module {
   cpu.io.instruction_valid := io.instruction_valid
 }
 
+// Without arguments, emits the three-stage CPU into verilog/verilator. With a
+// variant name (see ImplementationType.ByName), emits that CPU into
+// verilog/verilator/<variant>, so several models can be built side by side.
 object VerilogGenerator extends App {
+  val (implementation, targetDir) = args.headOption match {
+    case None => (ImplementationType.ThreeStage, "3-pipeline/verilog/verilator")
+    case Some(name) =>
+      val implementation = ImplementationType.ByName.getOrElse(
+        name,
+        throw new IllegalArgumentException(
+          s"unknown variant $name, expected one of ${ImplementationType.ByName.keys.mkString(", ")}"
+        )
+      )
+      (implementation, s"3-pipeline/verilog/verilator/$name")
+  }
   (new ChiselStage).emitVerilog(
-    new Top(),
-    Array("--target-dir", "3-pipeline/verilog/verilator")
+    new Top(implementation),
+    Array("--target-dir", targetDir)
   )
 }
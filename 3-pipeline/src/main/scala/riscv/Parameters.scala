@@ -12,6 +12,14 @@ object ImplementationType {
   val FiveStageStall   = 1
   val FiveStageForward = 2
   val FiveStageFinal   = 3
+
+  // Package names under riscv.core, used to pick the Verilator model
+  val ByName: Map[String, Int] = Map(
+    "threestage"        -> ThreeStage,
+    "fivestage_stall"   -> FiveStageStall,
+    "fivestage_forward" -> FiveStageForward,
+    "fivestage_final"   -> FiveStageFinal
+  )
 }
 
 object Parameters {
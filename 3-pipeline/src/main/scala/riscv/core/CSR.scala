@@ -19,6 +19,14 @@ object CSRRegister {
   val MCAUSE   = 0x342.U(Parameters.CSRRegisterAddrWidth)
   val CycleL   = 0xc00.U(Parameters.CSRRegisterAddrWidth)
   val CycleH   = 0xc80.U(Parameters.CSRRegisterAddrWidth)
+  val InstretL = 0xc02.U(Parameters.CSRRegisterAddrWidth)
+  val InstretH = 0xc82.U(Parameters.CSRRegisterAddrWidth)
+
+  // Read-only event counters, numbered as in 4-soc
+  val MHPMCounter4L = 0xb04.U(Parameters.CSRRegisterAddrWidth) // Hazard stall cycles
+  val MHPMCounter4H = 0xb84.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter6L = 0xb06.U(Parameters.CSRRegisterAddrWidth) // Control flush events
+  val MHPMCounter6H = 0xb86.U(Parameters.CSRRegisterAddrWidth)
 }
 
 class CSR extends Module {
@@ -29,6 +37,11 @@ class CSR extends Module {
     val reg_write_data_ex      = Input(UInt(Parameters.DataWidth))
     val debug_reg_read_address = Input(UInt(Parameters.CSRRegisterAddrWidth))
 
+    // Performance events from the pipeline, sampled once per cycle
+    val instruction_retired = Input(Bool()) // A non-bubble instruction left EX
+    val hazard_stall        = Input(Bool()) // PC held by the hazard unit
+    val control_stall       = Input(Bool()) // Wrong-path fetch flushed by a jump
+
     val id_reg_read_data    = Output(UInt(Parameters.DataWidth))
     val debug_reg_read_data = Output(UInt(Parameters.DataWidth))
 
@@ -42,18 +55,36 @@ class CSR extends Module {
   val mepc     = RegInit(UInt(Parameters.DataWidth), 0.U)
   val mcause   = RegInit(UInt(Parameters.DataWidth), 0.U)
   val cycles   = RegInit(UInt(64.W), 0.U)
+  val instret  = RegInit(UInt(64.W), 0.U)
+  val stalls   = RegInit(UInt(64.W), 0.U)
+  val flushes  = RegInit(UInt(64.W), 0.U)
   val regLUT =
     IndexedSeq(
-      CSRRegister.MSTATUS  -> mstatus,
-      CSRRegister.MIE      -> mie,
-      CSRRegister.MTVEC    -> mtvec,
-      CSRRegister.MSCRATCH -> mscratch,
-      CSRRegister.MEPC     -> mepc,
-      CSRRegister.MCAUSE   -> mcause,
-      CSRRegister.CycleL   -> cycles(31, 0),
-      CSRRegister.CycleH   -> cycles(63, 32),
+      CSRRegister.MSTATUS       -> mstatus,
+      CSRRegister.MIE           -> mie,
+      CSRRegister.MTVEC         -> mtvec,
+      CSRRegister.MSCRATCH      -> mscratch,
+      CSRRegister.MEPC          -> mepc,
+      CSRRegister.MCAUSE        -> mcause,
+      CSRRegister.CycleL        -> cycles(31, 0),
+      CSRRegister.CycleH        -> cycles(63, 32),
+      CSRRegister.InstretL      -> instret(31, 0),
+      CSRRegister.InstretH      -> instret(63, 32),
+      CSRRegister.MHPMCounter4L -> stalls(31, 0),
+      CSRRegister.MHPMCounter4H -> stalls(63, 32),
+      CSRRegister.MHPMCounter6L -> flushes(31, 0),
+      CSRRegister.MHPMCounter6H -> flushes(63, 32),
     )
   cycles := cycles + 1.U
+  when(io.instruction_retired) {
+    instret := instret + 1.U
+  }
+  when(io.hazard_stall) {
+    stalls := stalls + 1.U
+  }
+  when(io.control_stall) {
+    flushes := flushes + 1.U
+  }
 
   // If the pipeline and the CLINT are going to read and write the CSR at the same time, let the pipeline write first.
   // This is implemented in a single cycle by passing reg_write_data_ex to clint and writing the data from the CLINT to the CSR.
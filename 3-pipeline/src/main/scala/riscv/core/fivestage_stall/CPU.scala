@@ -166,4 +166,7 @@ class CPU extends Module {
   csr_regs.io.reg_write_data_ex      := ex.io.csr_write_data
   csr_regs.io.debug_reg_read_address := io.csr_debug_read_address
   io.csr_debug_read_data             := csr_regs.io.debug_reg_read_data
+  csr_regs.io.instruction_retired    := id2ex.io.output_instruction =/= InstructionsNop.nop
+  csr_regs.io.hazard_stall           := ctrl.io.pc_stall
+  csr_regs.io.control_stall          := ctrl.io.if_flush
 }
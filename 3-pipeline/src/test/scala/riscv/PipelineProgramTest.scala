@@ -139,6 +139,28 @@ class PipelineProgramTest extends AnyFlatSpec with ChiselScalatestTester {
       }
     }
 
+    it should "count retired instructions, stalls and flushes" in {
+      runProgram("hazard.asmbin", cfg) { c =>
+        c.clock.step(1000)
+        def counter(address: UInt): BigInt = {
+          c.io.csr_debug_read_address.poke(address)
+          c.clock.step()
+          c.io.csr_debug_read_data.peek().litValue
+        }
+        val instret = counter(CSRRegister.InstretL)
+        val cycles  = counter(CSRRegister.CycleL)
+        val stalls  = counter(CSRRegister.MHPMCounter4L)
+        val flushes = counter(CSRRegister.MHPMCounter6L)
+        assert(instret > 0 && instret < cycles, s"${cfg.name}: instret $instret, cycles $cycles")
+        assert(flushes > 0, s"${cfg.name}: hazard.S takes jumps, but no flush was counted")
+        cfg.implementation match {
+          case ImplementationType.ThreeStage     => assert(stalls == 0, s"${cfg.name}: $stalls stall cycles")
+          case ImplementationType.FiveStageStall => assert(stalls > 0, s"${cfg.name}: RAW hazards did not stall")
+          case _                                 =>
+        }
+      }
+    }
+
     it should "handle machine-mode traps" in {
       runProgram("irqtrap.asmbin", cfg) { c =>
         c.clock.setTimeout(0)
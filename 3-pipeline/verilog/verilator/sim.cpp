@@ -1,296 +1,106 @@
-#include <verilated.h>
-#include <verilated_vcd_c.h>
-
-#include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <memory>
-#include <string>
-#include <vector>
+#include <cstdio>
 
+#include "harness.h"
 #include "VTop.h"  // From Verilating "top.v"
 
-
-class Memory
-{
-    std::vector<uint32_t> memory;
-
-public:
-    Memory(size_t size) : memory(size, 0) {}
-
-    uint32_t read(size_t address)
-    {
-        address = address / 4;
-        if (address >= memory.size()) {
-            printf("invalid read address 0x%08x\n", address * 4);
-            return 0;
-        }
-        return memory[address];
-    }
-
-    uint32_t readInst(size_t address)
-    {
-        address = address / 4;
-        if (address >= memory.size()) {
-            printf("invalid read Inst address 0x%08x\n", address * 4);
-            return 0;
-        }
-
-        return memory[address];
-    }
-
-    void write(size_t address, uint32_t value, bool write_strobe[4])
-    {
-        address = address / 4;
-        uint32_t write_mask = 0;
-        if (write_strobe[0])
-            write_mask |= 0x000000FF;
-        if (write_strobe[1])
-            write_mask |= 0x0000FF00;
-        if (write_strobe[2])
-            write_mask |= 0x00FF0000;
-        if (write_strobe[3])
-            write_mask |= 0xFF000000;
-        if (address >= memory.size()) {
-            printf("invalid write address 0x%08x\n", address * 4);
-            return;
-        }
-        memory[address] =
-            (memory[address] & ~write_mask) | (value & write_mask);
-    }
-
-    void load_binary(std::string const &filename, size_t load_address = 0x1000)
-    {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("Could not open file " + filename);
-        }
-        file.seekg(0, std::ios::end);
-        size_t size = file.tellg();
-        if (load_address + size > memory.size() * 4) {
-            throw std::runtime_error(
-                "File " + filename + " is too large (File is " +
-                std::to_string(size) + " bytes. Memory is " +
-                std::to_string(memory.size() * 4 - load_address) + " bytes.)");
-        }
-        file.seekg(0, std::ios::beg);
-        for (int i = 0; i < size / 4; ++i) {
-            file.read(reinterpret_cast<char *>(&memory[i + load_address / 4]),
-                      sizeof(uint32_t));
-        }
-    }
-};
-
-class VCDTracer
-{
-    VerilatedVcdC *tfp = nullptr;
-
-public:
-    void enable(std::string const &filename, VTop &top)
-    {
-        Verilated::traceEverOn(true);
-        tfp = new VerilatedVcdC;
-        top.trace(tfp, 99);
-        tfp->open(filename.c_str());
-        tfp->set_time_resolution("1ps");
-        tfp->set_time_unit("1ns");
-        if (!tfp->isOpen()) {
-            throw std::runtime_error("Failed to open VCD dump file " +
-                                     filename);
-        }
-    }
-
-    void dump(vluint64_t time)
+// Device select 2 is the UART transmit register; everything else on the bus
+// is RAM.
+//
+// -halt-loop stops at the idle loop the workloads end in, and -perf prints
+// the pipeline's event counters at exit; together they are what the CPI
+// benchmark (scripts/cpi_benchmark.py) runs.
+struct Stage : HarnessStage<VTop> {
+    static constexpr unsigned DEVICE_SELECT_BITS = 3;
+    static constexpr bool CHECK_READ = true;
+    static constexpr bool CHECK_WRITE = true;
+    using Devices = DeviceMap<DeviceSlot<2, ConsoleUart>>;
+
+    // "j ." ending the assembly tests and the "wfi; j loop" of init.S
+    static constexpr uint32_t JUMP_SELF = 0x0000006f;
+    static constexpr uint32_t JUMP_BACK = 0xffdff06f;
+
+    // CSR addresses of the counters (riscv.core.CSRRegister)
+    static constexpr uint32_t CYCLE = 0xc00;
+    static constexpr uint32_t INSTRET = 0xc02;
+    static constexpr uint32_t HAZARD_STALLS = 0xb04;
+    static constexpr uint32_t CONTROL_FLUSHES = 0xb06;
+
+    bool halt_loop = false;
+    bool perf = false;
+    uint32_t fetch_pc = UINT32_MAX;
+    uint32_t idle_pc = UINT32_MAX;
+
+    static uint32_t device_select(const VTop &top)
     {
-        if (tfp) {
-            tfp->dump(time);
-        }
+        return top.io_device_select;
     }
 
-    ~VCDTracer()
+    void configure(const HarnessArgs &args)
     {
-        if (tfp) {
-            tfp->close();
-            delete tfp;
-        }
-    }
-};
-
-uint32_t parse_number(std::string const &str)
-{
-    if (str.size() > 2) {
-        auto &&prefix = str.substr(0, 2);
-        if (prefix == "0x" || prefix == "0X") {
-            return std::stoul(str.substr(2), nullptr, 16);
-        }
+        halt_loop = args.has("-halt-loop");
+        perf = args.has("-perf");
     }
-    return std::stoul(str);
-}
-
-class Simulator
-{
-    vluint64_t main_time = 0;
-    vluint64_t max_sim_time = 10000;
-    uint32_t halt_address = 0;
-    size_t memory_words = 1024 * 1024;  // 4MB
-    bool dump_vcd = false;
-    std::unique_ptr<VTop> top;
-    std::unique_ptr<VCDTracer> vcd_tracer;
-    std::unique_ptr<Memory> memory;
-    bool dump_signature = false;
-    unsigned long signature_begin, signature_end;
-    std::string signature_filename;
-    std::string instruction_filename;
-
-public:
-    void parse_args(std::vector<std::string> const &args)
-    {
-        if (auto it = std::find(args.begin(), args.end(), "-halt");
-            it != args.end()) {
-            halt_address = parse_number(*(it + 1));
-        }
-
-        if (auto it = std::find(args.begin(), args.end(), "-memory");
-            it != args.end()) {
-            memory_words = std::stoull(*(it + 1));
-        }
-
-        if (auto it = std::find(args.begin(), args.end(), "-time");
-            it != args.end()) {
-            max_sim_time = std::stoull(*(it + 1));
-        }
-
-        if (auto it = std::find(args.begin(), args.end(), "-vcd");
-            it != args.end()) {
-            vcd_tracer->enable(*(it + 1), *top);
-        }
 
-        if (auto it = std::find(args.begin(), args.end(), "-signature");
-            it != args.end()) {
-            dump_signature = true;
-            signature_begin = parse_number(*(it + 1));
-            signature_end = parse_number(*(it + 2));
-            signature_filename = *(it + 3);
-        }
+    void reset(VTop &top) { top.io_interrupt_flag = 0; }
 
-        if (auto it = std::find(args.begin(), args.end(), "-instruction");
-            it != args.end()) {
-            instruction_filename = *(it + 1);
-        }
-    }
+    // The default loop has always raised the external interrupt line on odd
+    // ticks (it was written as main_time & 0x00ff0 == 0xff0, which C++ binds
+    // as main_time & 1). Kept so programs that enable interrupts behave as
+    // before; -fast-clock leaves the line low.
+    void drive(VTop &top, vluint64_t tick) { top.io_interrupt_flag = tick & 1; }
 
-    Simulator(std::vector<std::string> const &args)
-        : top(std::make_unique<VTop>()),
-          vcd_tracer(std::make_unique<VCDTracer>())
+    // At a rising edge io_instruction still holds the word fetched from the
+    // previous PC. The run stops when the idle-loop jump is fetched for the
+    // second time: the first pass has then been resolved, so every older
+    // instruction has left EX and been counted. A stalled fetch repeats the
+    // same PC and does not count as a second fetch.
+    bool cycle(VTop &top)
     {
-        parse_args(args);
-        memory = std::make_unique<Memory>(memory_words);
-        if (!instruction_filename.empty()) {
-            memory->load_binary(instruction_filename);
-        }
+        if (!halt_loop)
+            return true;
+        uint32_t pc = fetch_pc;
+        fetch_pc = top.io_instruction_address;
+        uint32_t word = top.io_instruction;
+        if (pc == fetch_pc || (word != JUMP_SELF && word != JUMP_BACK))
+            return true;
+        if (pc != idle_pc) {
+            idle_pc = pc;
+            return true;
+        }
+        std::cout << "Idle loop at 0x" << std::hex << pc << std::dec
+                  << std::endl;
+        return false;
     }
 
-    void run()
+    static uint64_t read_counter(VTop &top, uint32_t address)
     {
-        top->reset = 1;
-        top->clock = 0;
-        top->io_instruction_valid = 1;
-        top->eval();
-        vcd_tracer->dump(main_time);
-        uint32_t data_memory_read_word = 0;
-        uint32_t inst_memory_read_word = 0;
-        uint32_t timer_interrupt = 0;
-        uint32_t counter = 0;
-        uint32_t clocktime = 1;
-        bool memory_write_strobe[4] = {false};
-        int uart_write_time_counter = 0,
-            uart_write_time_limit =
-                4;  // every limit, an UART write completes; this is tricky part
-        while (main_time < max_sim_time && !Verilated::gotFinish()) {
-            ++main_time;
-            ++counter;
-            if (counter > clocktime) {
-                top->clock = !top->clock;
-                counter = 0;
-            }
-            if (main_time & 0x00ff0 == 0xff0) {
-                top->io_interrupt_flag = 1;
-            } else {
-                top->io_interrupt_flag = 0;
-            }
-            if (main_time > 2) {
-                top->reset = 0;
-            }
-            // top->io_mem_slave_read_data = memory_read_word;
-            top->io_memory_bundle_read_data = data_memory_read_word;
-            top->io_instruction = inst_memory_read_word;
-            top->clock = !top->clock;
-            top->eval();
-            top->io_interrupt_flag = 0;
-
-            if (top->io_device_select == 2 &&
-                top->io_memory_bundle_write_enable) {
-                if (uart_write_time_counter == 0)
-                    std::cout << (char) top->io_memory_bundle_write_data
-                              << std::flush;  // Output to UART
-                uart_write_time_counter =
-                    (uart_write_time_counter + 1) % uart_write_time_limit;
-            } else {
-                uart_write_time_counter = 0;
-            }
-
-            data_memory_read_word = memory->read(top->io_memory_bundle_address);
-            inst_memory_read_word =
-                memory->readInst(top->io_instruction_address);
-
-            if (top->io_memory_bundle_write_enable) {
-                memory_write_strobe[0] = top->io_memory_bundle_write_strobe_0;
-                memory_write_strobe[1] = top->io_memory_bundle_write_strobe_1;
-                memory_write_strobe[2] = top->io_memory_bundle_write_strobe_2;
-                memory_write_strobe[3] = top->io_memory_bundle_write_strobe_3;
-                memory->write(top->io_memory_bundle_address,
-                              top->io_memory_bundle_write_data,
-                              memory_write_strobe);
-            }
-            vcd_tracer->dump(main_time);
-            if (halt_address) {
-                if (memory->read(halt_address) == 0xBABECAFE) {
-                    break;
-                }
-            }
-
-            // print simulation progress in percentage every 1%
-            if (main_time % (max_sim_time / 100) == 0) {
-                std::cout << "Simulation progress: "
-                          << (main_time * 100 / max_sim_time) << "%"
-                          << std::endl;
-            }
-        }
-
-        if (dump_signature) {
-            char data[9] = {0};
-            std::ofstream signature_file(signature_filename);
-            for (size_t addr = signature_begin; addr < signature_end;
-                 addr += 4) {
-                snprintf(data, 9, "%08x", memory->read(addr));
-                signature_file << data << std::endl;
-            }
-        }
+        uint64_t value = 0;
+        for (uint32_t half = 0; half < 2; half++) {
+            top.io_csr_debug_read_address = address + half * 0x80;
+            top.eval();
+            value |= uint64_t(uint32_t(top.io_csr_debug_read_data))
+                     << (32 * half);
+        }
+        return value;
     }
 
-    ~Simulator()
+    // One key=value line, parsed by the benchmark script
+    void finish(VTop &top)
     {
-        if (top) {
-            top->final();
-        }
+        if (!perf)
+            return;
+        uint64_t cycles = read_counter(top, CYCLE);
+        uint64_t instret = read_counter(top, INSTRET);
+        printf("perf: cycles=%llu instret=%llu cpi=%.3f hazard_stalls=%llu "
+               "control_flushes=%llu\n",
+               (unsigned long long) cycles, (unsigned long long) instret,
+               instret ? double(cycles) / instret : 0.0,
+               (unsigned long long) read_counter(top, HAZARD_STALLS),
+               (unsigned long long) read_counter(top, CONTROL_FLUSHES));
     }
 };
 
 int main(int argc, char **argv)
 {
-    Verilated::commandArgs(argc, argv);
-    std::vector<std::string> args(argv, argv + argc);
-    Simulator simulator(args);
-    simulator.run();
-    return 0;
+    return Harness<Stage>::main(argc, argv);
 }
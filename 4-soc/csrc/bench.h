@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+// Result reporting for the standard benchmarks (coremark.c, dhrystone.c)
+//
+// A benchmark times its measured loop with bench_begin()/bench_end(), which
+// read mcycle/minstret and also open sim-control region 0, then prints one
+// line over the UART:
+//
+//   BENCH <name> iterations=<n> cycles=<c> instret=<i> valid=<0|1>
+//
+// scripts/cpu_bench.py (make bench) parses these lines into CSV/JSON. Scores
+// are per MHz, derived from cycles alone, so they hold for any clock.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#include "mmio.h"
+
+typedef struct {
+    uint32_t cycle;
+    uint32_t instret;
+} bench_time_t;
+
+static inline void bench_read(bench_time_t *t)
+{
+    __asm__ volatile("csrr %0, mcycle" : "=r"(t->cycle));
+    __asm__ volatile("csrr %0, minstret" : "=r"(t->instret));
+}
+
+static inline void bench_putc(char c)
+{
+    while (!(*UART_STATUS & 0x01))
+        ;
+    *UART_SEND = (uint32_t) c;
+}
+
+static inline void bench_puts(const char *s)
+{
+    while (*s)
+        bench_putc(*s++);
+}
+
+static inline void bench_put_uint(uint32_t val)
+{
+    char buf[11];
+    int i = 0;
+
+    do {
+        buf[i++] = (char) ('0' + val % 10);
+        val /= 10;
+    } while (val);
+    while (i > 0)
+        bench_putc(buf[--i]);
+}
+
+static inline void bench_begin(bench_time_t *start)
+{
+    *SIM_REGION_BEGIN = 0;
+    bench_read(start);
+}
+
+static inline void bench_end(bench_time_t *end)
+{
+    bench_read(end);
+    *SIM_REGION_END = 0;
+}
+
+/* Print the BENCH line; returns the exit status for main() (0 if valid) */
+static inline int bench_report(const char *name,
+                               uint32_t iterations,
+                               const bench_time_t *start,
+                               const bench_time_t *end,
+                               int valid)
+{
+    *UART_ENABLE = 1;
+    bench_puts("BENCH ");
+    bench_puts(name);
+    bench_puts(" iterations=");
+    bench_put_uint(iterations);
+    bench_puts(" cycles=");
+    bench_put_uint(end->cycle - start->cycle);
+    bench_puts(" instret=");
+    bench_put_uint(end->instret - start->instret);
+    bench_puts(" valid=");
+    bench_putc(valid ? '1' : '0');
+    bench_puts("\n");
+    return valid ? 0 : 1;
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: MIT
+// CoreMark-style benchmark for MyCPU
+//
+// Follows the structure of EEMBC CoreMark: each iteration runs the three
+// CoreMark workloads on a seed derived from the iteration number and folds
+// their results into a CRC-16:
+//   - list: find, reverse and merge-sort a 64-node linked list
+//   - matrix: 16x16 int16 multiply by a constant, by a vector and by a
+//     matrix, with bit extraction on the products
+//   - state: a state machine classifying a comma-separated list of numbers
+//
+// It is not the certified CoreMark (no core_portme, different data sizes),
+// so its CoreMark/MHz compares MyCPU builds with each other and is only
+// indicative against published scores. Result: a BENCH line (bench.h); the
+// run is valid when the final CRC matches COREMARK_EXPECTED_CRC.
+
+#include <stdint.h>
+
+#include "bench.h"
+
+#ifndef COREMARK_ITERATIONS
+#define COREMARK_ITERATIONS 20
+#endif
+
+/* Final CRC of the default 20 iterations (host reference run); other
+ * iteration counts are not checked
+ */
+#define COREMARK_EXPECTED_CRC 0x34a9
+
+#define LIST_NODES 64
+#define MATRIX_N 16
+
+typedef struct list_node {
+    struct list_node *next;
+    int16_t data;
+    int16_t idx;
+} list_node_t;
+
+static list_node_t list_pool[LIST_NODES];
+static int16_t mat_a[MATRIX_N * MATRIX_N];
+static int16_t mat_b[MATRIX_N * MATRIX_N];
+static int32_t mat_c[MATRIX_N * MATRIX_N];
+
+/* Numbers for the state machine: integers, floats, exponents, invalid */
+static const char state_input[] =
+    "5012,1234,-874,+122,-110,0.6e-1,-.15e3,51.3e+4,34.4e2,T0.3e-1F,"
+    "-T.T++Tq,1T3.4e4z,4.56e-7,0.12,-1.2e-9,+7.4,-0.,0203,1T12,-1,-30,";
+
+enum { ST_START, ST_INT, ST_FLOAT, ST_EXP, ST_SCI, ST_INVALID, ST_COUNT };
+
+static uint16_t crc_byte(uint8_t data, uint16_t crc)
+{
+    for (int i = 0; i < 8; i++) {
+        uint8_t x16 = (uint8_t) ((data & 1) ^ (crc & 1));
+        data >>= 1;
+        if (x16) {
+            crc ^= 0x4002;
+            crc = (uint16_t) ((crc >> 1) | 0x8000);
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc_u16(uint16_t v, uint16_t crc)
+{
+    crc = crc_byte((uint8_t) v, crc);
+    return crc_byte((uint8_t) (v >> 8), crc);
+}
+
+static uint16_t crc_u32(uint32_t v, uint16_t crc)
+{
+    crc = crc_u16((uint16_t) v, crc);
+    return crc_u16((uint16_t) (v >> 16), crc);
+}
+
+/* ---- List workload ---- */
+
+static list_node_t *list_init(uint16_t seed)
+{
+    for (int i = 0; i < LIST_NODES; i++) {
+        list_pool[i].next = i + 1 < LIST_NODES ? &list_pool[i + 1] : 0;
+        list_pool[i].idx = (int16_t) i;
+        seed = (uint16_t) (seed * 25173u + 13849u);
+        list_pool[i].data = (int16_t) (seed & 0x7fff);
+    }
+    return &list_pool[0];
+}
+
+static list_node_t *list_find(list_node_t *list, int16_t data)
+{
+    while (list && (list->data & 0xff) != (data & 0xff))
+        list = list->next;
+    return list;
+}
+
+static list_node_t *list_reverse(list_node_t *list)
+{
+    list_node_t *prev = 0;
+
+    while (list) {
+        list_node_t *next = list->next;
+        list->next = prev;
+        prev = list;
+        list = next;
+    }
+    return prev;
+}
+
+static int list_cmp_data(const list_node_t *a, const list_node_t *b)
+{
+    return a->data - b->data;
+}
+
+static int list_cmp_idx(const list_node_t *a, const list_node_t *b)
+{
+    return a->idx - b->idx;
+}
+
+/* Bottom-up merge sort, as in CoreMark's core_list_mergesort() */
+static list_node_t *list_sort(list_node_t *list,
+                              int (*cmp)(const list_node_t *,
+                                         const list_node_t *))
+{
+    for (int insize = 1;; insize *= 2) {
+        list_node_t *p = list, *tail = 0;
+        int merges = 0;
+
+        list = 0;
+        while (p) {
+            list_node_t *q = p;
+            int psize = 0, qsize = insize;
+
+            merges++;
+            for (int i = 0; i < insize && q; i++) {
+                psize++;
+                q = q->next;
+            }
+            while (psize > 0 || (qsize > 0 && q)) {
+                list_node_t *e;
+                if (psize == 0) {
+                    e = q, q = q->next, qsize--;
+                } else if (qsize == 0 || !q || cmp(p, q) <= 0) {
+                    e = p, p = p->next, psize--;
+                } else {
+                    e = q, q = q->next, qsize--;
+                }
+                if (tail)
+                    tail->next = e;
+                else
+                    list = e;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->next = 0;
+        if (merges <= 1)
+            return list;
+    }
+}
+
+static uint16_t bench_list(uint16_t seed, uint16_t crc)
+{
+    list_node_t *list = list_init(seed);
+    uint32_t found = 0, missed = 0;
+
+    for (int i = 0; i < 16; i++) {
+        list_node_t *hit = list_find(list, (int16_t) (seed + i * 37));
+        if (hit) {
+            found++;
+            crc = crc_u16((uint16_t) hit->data, crc);
+        } else {
+            missed++;
+        }
+        list = list_reverse(list);
+    }
+    list = list_sort(list, list_cmp_data);
+    for (list_node_t *n = list; n; n = n->next)
+        crc = crc_u16((uint16_t) n->data, crc);
+    list = list_sort(list, list_cmp_idx);
+    crc = crc_u16((uint16_t) list->next->data, crc);
+    return crc_u32(found << 16 | missed, crc);
+}
+
+/* ---- Matrix workload ---- */
+
+static uint16_t bench_matrix(uint16_t seed, uint16_t crc)
+{
+    int32_t sum = 0;
+
+    for (int i = 0; i < MATRIX_N * MATRIX_N; i++) {
+        seed = (uint16_t) (seed * 25173u + 13849u);
+        mat_a[i] = (int16_t) ((seed >> 4) & 0xff);
+        mat_b[i] = (int16_t) (((seed >> 8) & 0xff) - 0x80);
+    }
+
+    /* Matrix times constant, accumulated with a running threshold */
+    for (int i = 0; i < MATRIX_N * MATRIX_N; i++) {
+        mat_c[i] = (int32_t) mat_a[i] * (int16_t) seed;
+        sum += mat_c[i] > sum ? 1 : -1;
+    }
+    crc = crc_u32((uint32_t) sum, crc);
+
+    /* Matrix times vector (first row of B) */
+    for (int i = 0; i < MATRIX_N; i++) {
+        int32_t acc = 0;
+        for (int j = 0; j < MATRIX_N; j++)
+            acc += (int32_t) mat_a[i * MATRIX_N + j] * mat_b[j];
+        mat_c[i] = acc;
+        crc = crc_u32((uint32_t) acc, crc);
+    }
+
+    /* Matrix times matrix, then bit extraction from each product */
+    for (int i = 0; i < MATRIX_N; i++) {
+        for (int j = 0; j < MATRIX_N; j++) {
+            int32_t acc = 0;
+            for (int k = 0; k < MATRIX_N; k++)
+                acc += (int32_t) mat_a[i * MATRIX_N + k] *
+                       mat_b[k * MATRIX_N + j];
+            mat_c[i * MATRIX_N + j] = acc;
+        }
+    }
+    sum = 0;
+    for (int i = 0; i < MATRIX_N * MATRIX_N; i++)
+        sum += (mat_c[i] >> 2) & 0xf;
+    return crc_u32((uint32_t) sum, crc);
+}
+
+/* ---- State machine workload ---- */
+
+static int is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* Classify one comma-terminated token; returns its final state */
+static int state_token(const char **p, uint32_t *transitions)
+{
+    int state = ST_START;
+
+    for (char c = **p; c && c != ','; c = *++*p) {
+        int next = state;
+        switch (state) {
+        case ST_START:
+            if (is_digit(c))
+                next = ST_INT;
+            else if (c == '+' || c == '-')
+                next = ST_START;
+            else if (c == '.')
+                next = ST_FLOAT;
+            else
+                next = ST_INVALID;
+            break;
+        case ST_INT:
+            if (c == '.')
+                next = ST_FLOAT;
+            else if (!is_digit(c))
+                next = ST_INVALID;
+            break;
+        case ST_FLOAT:
+            if (c == 'e' || c == 'E')
+                next = ST_EXP;
+            else if (!is_digit(c))
+                next = ST_INVALID;
+            break;
+        case ST_EXP:
+            if (is_digit(c) || c == '+' || c == '-')
+                next = ST_SCI;
+            else
+                next = ST_INVALID;
+            break;
+        case ST_SCI:
+            if (!is_digit(c))
+                next = ST_INVALID;
+            break;
+        default:
+            break;
+        }
+        if (next != state)
+            transitions[next]++;
+        state = next;
+    }
+    if (**p == ',')
+        ++*p;
+    return state;
+}
+
+static uint16_t bench_state(uint16_t seed, uint16_t crc)
+{
+    uint32_t final[ST_COUNT] = {0}, transitions[ST_COUNT] = {0};
+    char input[sizeof(state_input)];
+
+    /* Corrupt every seed-selected character, as CoreMark does per pass */
+    for (unsigned i = 0; i < sizeof(state_input); i++) {
+        char c = state_input[i];
+        if (c != ',' && c && ((i + seed) & 0x1f) == 0)
+            c = (char) (c ^ 0x10);
+        input[i] = c;
+    }
+
+    for (const char *p = input; *p;)
+        final[state_token(&p, transitions)]++;
+    for (int i = 0; i < ST_COUNT; i++) {
+        crc = crc_u32(final[i], crc);
+        crc = crc_u32(transitions[i], crc);
+    }
+    return crc;
+}
+
+int main(void)
+{
+    bench_time_t start, end;
+    uint16_t crc = 0;
+
+    bench_begin(&start);
+    for (uint32_t i = 0; i < COREMARK_ITERATIONS; i++) {
+        uint16_t seed = (uint16_t) (0x3415 ^ (i * 0x2f1));
+        crc = bench_list(seed, crc);
+        crc = bench_matrix(seed, crc);
+        crc = bench_state(seed, crc);
+    }
+    bench_end(&end);
+
+    return bench_report("coremark", COREMARK_ITERATIONS, &start, &end,
+                        COREMARK_ITERATIONS != 20 ||
+                            crc == COREMARK_EXPECTED_CRC);
+}
@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: MIT
+// Dhrystone 2.1-style benchmark for MyCPU
+//
+// The procedures, data types and main loop of Reinhold Weicker's Dhrystone
+// 2.1, in one file with the procedures kept out of line (the original splits
+// them over dhry_1.c and dhry_2.c for the same reason). strcpy and strcmp
+// come from mini_libc.
+//
+// DMIPS/MHz = runs * 10^6 / cycles / 1757 (Dhrystones per second of the VAX
+// 11/780); scripts/cpu_bench.py computes it from the BENCH line (bench.h).
+// The run is valid when the globals end with the values the Dhrystone
+// reference output lists.
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "mini_libc.h"
+
+#ifndef DHRYSTONE_RUNS
+#define DHRYSTONE_RUNS 2000
+#endif
+
+#define NOINLINE __attribute__((noinline))
+
+typedef enum { IDENT_1, IDENT_2, IDENT_3, IDENT_4, IDENT_5 } enumeration_t;
+
+typedef int one_thirty_t;
+typedef int one_fifty_t;
+typedef char capital_letter_t;
+typedef int boolean_t;
+typedef char str_30_t[31];
+typedef int arr_1_dim_t[50];
+typedef int arr_2_dim_t[50][50];
+
+typedef struct record {
+    struct record *ptr_comp;
+    enumeration_t discr;
+    union {
+        struct {
+            enumeration_t enum_comp;
+            int int_comp;
+            char str_comp[31];
+        } var_1;
+        struct {
+            enumeration_t e_comp_2;
+            char str_2_comp[31];
+        } var_2;
+        struct {
+            char ch_1_comp;
+            char ch_2_comp;
+        } var_3;
+    } variant;
+} record_t;
+
+static record_t *ptr_glob, *next_ptr_glob;
+static record_t rec_glob, next_rec_glob;
+static int int_glob;
+static boolean_t bool_glob;
+static char ch_1_glob, ch_2_glob;
+static arr_1_dim_t arr_1_glob;
+static arr_2_dim_t arr_2_glob;
+
+static NOINLINE void proc_7(one_fifty_t int_1_par_val,
+                            one_fifty_t int_2_par_val,
+                            one_fifty_t *int_par_ref)
+{
+    one_fifty_t int_loc = int_1_par_val + 2;
+    *int_par_ref = int_2_par_val + int_loc;
+}
+
+static NOINLINE boolean_t func_3(enumeration_t enum_par_val)
+{
+    enumeration_t enum_loc = enum_par_val;
+    return enum_loc == IDENT_3;
+}
+
+static NOINLINE void proc_6(enumeration_t enum_val_par,
+                            enumeration_t *enum_ref_par)
+{
+    *enum_ref_par = enum_val_par;
+    if (!func_3(enum_val_par))
+        *enum_ref_par = IDENT_4;
+    switch (enum_val_par) {
+    case IDENT_1:
+        *enum_ref_par = IDENT_1;
+        break;
+    case IDENT_2:
+        *enum_ref_par = int_glob > 100 ? IDENT_1 : IDENT_4;
+        break;
+    case IDENT_3:
+        *enum_ref_par = IDENT_2;
+        break;
+    case IDENT_4:
+        break;
+    case IDENT_5:
+        *enum_ref_par = IDENT_3;
+        break;
+    }
+}
+
+static NOINLINE void proc_3(record_t **ptr_ref_par)
+{
+    if (ptr_glob)
+        *ptr_ref_par = ptr_glob->ptr_comp;
+    proc_7(10, int_glob, &ptr_glob->variant.var_1.int_comp);
+}
+
+static NOINLINE void proc_1(record_t *ptr_val_par)
+{
+    record_t *next_record = ptr_val_par->ptr_comp;
+
+    *ptr_val_par->ptr_comp = *ptr_glob;
+    ptr_val_par->variant.var_1.int_comp = 5;
+    next_record->variant.var_1.int_comp = ptr_val_par->variant.var_1.int_comp;
+    next_record->ptr_comp = ptr_val_par->ptr_comp;
+    proc_3(&next_record->ptr_comp);
+    if (next_record->discr == IDENT_1) {
+        next_record->variant.var_1.int_comp = 6;
+        proc_6(ptr_val_par->variant.var_1.enum_comp,
+               &next_record->variant.var_1.enum_comp);
+        next_record->ptr_comp = ptr_glob->ptr_comp;
+        proc_7(next_record->variant.var_1.int_comp, 10,
+               &next_record->variant.var_1.int_comp);
+    } else {
+        *ptr_val_par = *ptr_val_par->ptr_comp;
+    }
+}
+
+static NOINLINE void proc_2(one_fifty_t *int_par_ref)
+{
+    one_fifty_t int_loc = *int_par_ref + 10;
+    enumeration_t enum_loc = IDENT_2;
+
+    do {
+        if (ch_1_glob == 'A') {
+            int_loc -= 1;
+            *int_par_ref = int_loc - int_glob;
+            enum_loc = IDENT_1;
+        }
+    } while (enum_loc != IDENT_1);
+}
+
+static NOINLINE void proc_4(void)
+{
+    boolean_t bool_loc = ch_1_glob == 'A';
+
+    bool_glob = bool_loc | bool_glob;
+    ch_2_glob = 'B';
+}
+
+static NOINLINE void proc_5(void)
+{
+    ch_1_glob = 'A';
+    bool_glob = 0;
+}
+
+static NOINLINE void proc_8(arr_1_dim_t arr_1_par_ref,
+                            arr_2_dim_t arr_2_par_ref,
+                            int int_1_par_val,
+                            int int_2_par_val)
+{
+    one_fifty_t int_loc = int_1_par_val + 5;
+
+    arr_1_par_ref[int_loc] = int_2_par_val;
+    arr_1_par_ref[int_loc + 1] = arr_1_par_ref[int_loc];
+    arr_1_par_ref[int_loc + 30] = int_loc;
+    for (one_fifty_t i = int_loc; i <= int_loc + 1; ++i)
+        arr_2_par_ref[int_loc][i] = int_loc;
+    arr_2_par_ref[int_loc][int_loc - 1] += 1;
+    arr_2_par_ref[int_loc + 20][int_loc] = arr_1_par_ref[int_loc];
+    int_glob = 5;
+}
+
+static NOINLINE enumeration_t func_1(capital_letter_t ch_1_par_val,
+                                     capital_letter_t ch_2_par_val)
+{
+    capital_letter_t ch_1_loc = ch_1_par_val;
+    capital_letter_t ch_2_loc = ch_1_loc;
+
+    if (ch_2_loc != ch_2_par_val)
+        return IDENT_1;
+    ch_1_glob = ch_1_loc;
+    return IDENT_2;
+}
+
+static NOINLINE boolean_t func_2(str_30_t str_1_par_ref, str_30_t str_2_par_ref)
+{
+    one_thirty_t int_loc = 2;
+    capital_letter_t ch_loc = 0;
+
+    while (int_loc <= 2) {
+        if (func_1(str_1_par_ref[int_loc], str_2_par_ref[int_loc + 1]) ==
+            IDENT_1) {
+            ch_loc = 'A';
+            int_loc += 1;
+        }
+    }
+    if (ch_loc >= 'W' && ch_loc < 'Z')
+        int_loc = 7;
+    if (ch_loc == 'R')
+        return 1;
+    if (strcmp(str_1_par_ref, str_2_par_ref) > 0) {
+        int_loc += 7;
+        int_glob = int_loc;
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    one_fifty_t int_1_loc = 0, int_2_loc = 0, int_3_loc = 0;
+    enumeration_t enum_loc = IDENT_1;
+    str_30_t str_1_loc, str_2_loc;
+    bench_time_t start, end;
+
+    next_ptr_glob = &next_rec_glob;
+    ptr_glob = &rec_glob;
+    ptr_glob->ptr_comp = next_ptr_glob;
+    ptr_glob->discr = IDENT_1;
+    ptr_glob->variant.var_1.enum_comp = IDENT_3;
+    ptr_glob->variant.var_1.int_comp = 40;
+    strcpy(ptr_glob->variant.var_1.str_comp, "DHRYSTONE PROGRAM, SOME STRING");
+    strcpy(str_1_loc, "DHRYSTONE PROGRAM, 1'ST STRING");
+    arr_2_glob[8][7] = 10;
+
+    bench_begin(&start);
+    for (int run = 1; run <= DHRYSTONE_RUNS; ++run) {
+        proc_5();
+        proc_4();
+        int_1_loc = 2;
+        int_2_loc = 3;
+        strcpy(str_2_loc, "DHRYSTONE PROGRAM, 2'ND STRING");
+        enum_loc = IDENT_2;
+        bool_glob = !func_2(str_1_loc, str_2_loc);
+        while (int_1_loc < int_2_loc) {
+            int_3_loc = 5 * int_1_loc - int_2_loc;
+            proc_7(int_1_loc, int_2_loc, &int_3_loc);
+            int_1_loc += 1;
+        }
+        proc_8(arr_1_glob, arr_2_glob, int_1_loc, int_3_loc);
+        proc_1(ptr_glob);
+        for (char ch_index = 'A'; ch_index <= ch_2_glob; ++ch_index) {
+            if (enum_loc == func_1(ch_index, 'C')) {
+                proc_6(IDENT_1, &enum_loc);
+                strcpy(str_2_loc, "DHRYSTONE PROGRAM, 3'RD STRING");
+                int_2_loc = run;
+                int_glob = run;
+            }
+        }
+        int_2_loc = int_2_loc * int_1_loc;
+        int_1_loc = int_2_loc / int_3_loc;
+        int_2_loc = 7 * (int_2_loc - int_3_loc) - int_1_loc;
+        proc_2(&int_1_loc);
+    }
+    bench_end(&end);
+
+    int valid =
+        int_glob == 5 && bool_glob == 1 && ch_1_glob == 'A' &&
+        ch_2_glob == 'B' && arr_1_glob[8] == 7 &&
+        arr_2_glob[8][7] == DHRYSTONE_RUNS + 10 && ptr_glob->discr == IDENT_1 &&
+        ptr_glob->variant.var_1.enum_comp == IDENT_3 &&
+        ptr_glob->variant.var_1.int_comp == 17 &&
+        next_ptr_glob->discr == IDENT_1 &&
+        next_ptr_glob->variant.var_1.enum_comp == IDENT_2 &&
+        next_ptr_glob->variant.var_1.int_comp == 18 && int_1_loc == 5 &&
+        int_2_loc == 13 && int_3_loc == 7 && enum_loc == IDENT_2 &&
+        !strcmp(str_1_loc, "DHRYSTONE PROGRAM, 1'ST STRING") &&
+        !strcmp(str_2_loc, "DHRYSTONE PROGRAM, 2'ND STRING");
+
+    return bench_report("dhrystone", DHRYSTONE_RUNS, &start, &end, valid);
+}
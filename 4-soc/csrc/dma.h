@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MIT
+// DMA controller driver
+//
+// The controller copies COUNT words from SRC to DST as a second bus master,
+// below the CPU's own accesses, while the CPU keeps running:
+//   - Memory to memory: both addresses increment; main memory is moved in
+//     bursts
+//   - Memory to peripheral: the destination stays fixed (VGA STREAM_DATA,
+//     audio DATA); paced transfers wait for room in the audio FIFO
+//
+// Coherence with the data cache:
+//   - The DMA reads main memory behind the cache, so dma_start() writes dirty
+//     lines back first (FENCE.I)
+//   - Lines the DMA writes are invalidated in the data cache by hardware; if
+//     the destination holds code, run FENCE.I after completion
+//
+// The data TCM (tcm.h) is invisible to the controller: at those addresses it
+// reads and writes the main memory the TCM shadows. Neither SRC nor DST may
+// point at TCM_DATA/TCM_BSS objects, nor at locals of a TCM_STACK program.
+//
+// Completion interrupt: with DMA_CTRL_IRQ the controller raises a machine
+// external interrupt (mcause 0x8000000B) until done is cleared with
+// dma_ack(), so the trap handler must call it.
+
+#ifndef DMA_H
+#define DMA_H
+
+#include <stdint.h>
+
+#include "mmio.h"
+
+static inline int dma_busy(void)
+{
+    return (*DMA_STATUS & DMA_STATUS_BUSY) != 0;
+}
+
+/* Clear done, dropping the completion interrupt */
+static inline void dma_ack(void)
+{
+    *DMA_STATUS = DMA_STATUS_DONE;
+}
+
+/* Start a transfer of words words; flags are DMA_CTRL_* bits besides START.
+ * src and dst must lie outside the data TCM (see above) */
+static inline void dma_start(const void *src,
+                             volatile void *dst,
+                             uint32_t words,
+                             uint32_t flags)
+{
+    while (dma_busy())
+        ;
+    /* Write back dirty lines of the source buffer */
+    __asm__ volatile("fence.i" ::: "memory");
+    *DMA_SRC = (uint32_t) (uintptr_t) src;
+    *DMA_DST = (uint32_t) (uintptr_t) dst;
+    *DMA_COUNT = words;
+    *DMA_CTRL = flags | DMA_CTRL_START;
+}
+
+static inline void dma_wait(void)
+{
+    while (dma_busy())
+        ;
+    dma_ack();
+}
+
+/* Memory to memory copy without waiting */
+static inline void dma_copy(void *dst, const void *src, uint32_t words)
+{
+    dma_start(src, dst, words, DMA_CTRL_SRC_INC | DMA_CTRL_DST_INC);
+}
+
+/* Stream packed pixels into the VGA framebuffer upload port */
+static inline void dma_to_vga_stream(const uint32_t *pixels, uint32_t words)
+{
+    dma_start(pixels, (volatile void *) (uintptr_t) VGA_ADDR_STREAM_DATA,
+              words, DMA_CTRL_SRC_INC);
+}
+
+/* Stream samples into the audio FIFO, paced by its free space */
+static inline void dma_to_audio(const uint32_t *samples, uint32_t words)
+{
+    dma_start(samples, &AUDIO_DATA, words, DMA_CTRL_SRC_INC | DMA_CTRL_PACE);
+}
+
+#endif /* DMA_H */
@@ -11,6 +11,7 @@
 #define PICOSYNTH_DSP_MATH_H_
 
 #include "picosynth.h"
+#include "tcm.h"
 
 /* Default to 8-bit LUT if no mode specified */
 #if !defined(PICOSYNTH_SINE_LUT_8BIT) && !defined(PICOSYNTH_SINE_LUT_16BIT) && \
@@ -29,9 +30,10 @@
 #endif
 #endif
 
-/* Sine LUTs: quarter-cycle with extra entry for interpolation */
+/* Sine LUTs: quarter-cycle with extra entry for interpolation; in the data
+ * TCM, as sine oscillators read them every sample without wavetables */
 #if defined(PICOSYNTH_SINE_LUT_8BIT) && PICOSYNTH_SINE_LUT_8BIT
-static const q7_t sine_lut8[129] = {
+static const q7_t sine_lut8[129] TCM_RODATA = {
     0,    6,    12,   19,   25,   31,   37,   43,   49,   54,   60,   65,
     71,   76,   81,   85,   90,   94,   98,   102,  106,  109,  112,  115,
     117,  120,  122,  123,  125,  126,  126,  127,  127,  127,  126,  126,
@@ -45,7 +47,7 @@ static const q7_t sine_lut8[129] = {
     -49,  -43,  -37,  -31,  -25,  -19,  -12,  -6,   0,
 };
 #elif defined(PICOSYNTH_SINE_LUT_16BIT) && PICOSYNTH_SINE_LUT_16BIT
-static const q15_t sine_lut16[257] = {
+static const q15_t sine_lut16[257] TCM_RODATA = {
     0,      804,    1608,   2410,   3212,   4011,   4808,   5602,   6393,
     7179,   7962,   8739,   9512,   10278,  11039,  11793,  12539,  13279,
     14010,  14732,  15446,  16151,  16846,  17530,  18204,  18868,  19519,
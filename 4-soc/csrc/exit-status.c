@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+#include "mmio.h"
+
+/*
+ * Exit status self-test for the simulator (make check-exit)
+ *
+ * main() returns EXIT_STATUS_EXPECTED, and crt0 (init.S) stores it to
+ * SIM_EXIT, which must end the run with that status. Before returning, the
+ * program dirties data cache lines and marks a timed region, so the stores
+ * to the control page (0x100) also have to get past the data cache and the
+ * store buffer. A different status, or a run that only stops when the core
+ * sits idle in wfi, means control page writes are lost on the way.
+ */
+#define EXIT_STATUS_EXPECTED 3
+#define WORDS 256
+
+static uint32_t buffer[WORDS];
+
+int main(void)
+{
+    *SIM_REGION_BEGIN = 0;
+    for (uint32_t i = 0; i < WORDS; i++)
+        buffer[i] = i * 0x9E3779B9u;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < WORDS; i++)
+        sum += buffer[i] ^ i;
+    *SIM_REGION_END = 0;
+
+    /* A wrong sum must not pass as the expected status either */
+    return sum ? EXIT_STATUS_EXPECTED : 1;
+}
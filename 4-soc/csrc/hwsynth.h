@@ -2,7 +2,7 @@
 // Hardware Synthesizer Driver Header - Complete picosynth implementation
 //
 // Features:
-//   - 4-voice polyphony
+//   - 16-voice polyphony (HWSYNTH_VOICES; the hardware reports its count)
 //   - 5 waveforms: Saw, Square, Triangle, Sine, Noise
 //   - AHDSR Envelope (Attack-Hold-Decay-Sustain-Release)
 //   - SVF Filter with LP/HP/BP modes and resonance
@@ -25,11 +25,22 @@
 #define HWSYNTH_STATUS  (*(volatile uint32_t*)(HWSYNTH_BASE + 0x08))
 #define HWSYNTH_SAMPLE  (*(volatile int16_t*)(HWSYNTH_BASE + 0x0C))
 
+// Voice set: bit n for voice n
+#define HWSYNTH_VOICE_MASK  (*(volatile uint32_t*)(HWSYNTH_BASE + 0x800))  // Voices that play
+#define HWSYNTH_ACTIVE      (*(volatile uint32_t*)(HWSYNTH_BASE + 0x804))  // Envelope running (RO)
+#define HWSYNTH_VOICE_COUNT (*(volatile uint32_t*)(HWSYNTH_BASE + 0x808))  // Voices built in (RO)
+
+// Voices the driver addresses; must match Parameters.HWSynthVoices
+#ifndef HWSYNTH_VOICES
+#define HWSYNTH_VOICES  16
+#endif
+
 // Voice base addresses (32 bytes per voice)
 #define HWSYNTH_VOICE0  (HWSYNTH_BASE + 0x10)
 #define HWSYNTH_VOICE1  (HWSYNTH_BASE + 0x30)
 #define HWSYNTH_VOICE2  (HWSYNTH_BASE + 0x50)
 #define HWSYNTH_VOICE3  (HWSYNTH_BASE + 0x70)
+#define HWSYNTH_VOICE(n) (HWSYNTH_VOICE0 + (n)*0x20)
 
 // Voice register offsets
 #define VOICE_FREQ      0x00    // [15:0] Phase increment
@@ -41,7 +52,7 @@
 #define VOICE_GATE      0x18    // [0]gate [1]trigger
 
 // Voice register accessors
-#define HWSYNTH_VOICE_REG(n, off)  (*(volatile uint32_t*)(HWSYNTH_VOICE0 + (n)*0x20 + (off)))
+#define HWSYNTH_VOICE_REG(n, off)  (*(volatile uint32_t*)(HWSYNTH_VOICE(n) + (off)))
 
 // ============================================================================
 // Waveform types
@@ -83,19 +94,26 @@ static inline int hwsynth_init(void) {
     if (HWSYNTH_ID != HWSYNTH_ID_EXPECTED) {
         return -1;
     }
+    if (HWSYNTH_VOICE_COUNT < HWSYNTH_VOICES) {
+        return -2;  // Built with fewer voices than this driver drives
+    }
     HWSYNTH_CTRL = 0x00;  // Disable
+    HWSYNTH_VOICE_MASK = 0;
     return 0;
 }
 
 // ============================================================================
 // Global control
 // ============================================================================
-static inline void hwsynth_enable(uint8_t voice_mask) {
+// voice_mask: bit n enables voice n
+static inline void hwsynth_enable(uint32_t voice_mask) {
+    HWSYNTH_VOICE_MASK = voice_mask;
     HWSYNTH_CTRL = 0x01 | ((voice_mask & 0xF) << 4);
 }
 
 static inline void hwsynth_disable(void) {
     HWSYNTH_CTRL = 0x00;
+    HWSYNTH_VOICE_MASK = 0;
 }
 
 // ============================================================================
@@ -104,20 +122,20 @@ static inline void hwsynth_disable(void) {
 
 // Set voice frequency directly
 static inline void hwsynth_set_freq(uint8_t voice, uint16_t freq) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_FREQ) = freq;
 }
 
 // Set voice frequency from MIDI note
 static inline void hwsynth_set_note(uint8_t voice, uint8_t note) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     uint16_t freq = (note >= 60 && note <= 95) ? midi_to_freq[note - 60] : 1554;
     HWSYNTH_VOICE_REG(voice, VOICE_FREQ) = freq;
 }
 
 // Set waveform type
 static inline void hwsynth_set_wave(uint8_t voice, uint8_t wave) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_WAVE) = wave & 0x7;
 }
 
@@ -125,14 +143,14 @@ static inline void hwsynth_set_wave(uint8_t voice, uint8_t wave) {
 static inline void hwsynth_set_envelope(uint8_t voice,
                                         uint8_t attack, uint8_t hold,
                                         uint8_t decay, uint8_t release) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_ENV_ADSR) =
         attack | ((uint32_t)hold << 8) | ((uint32_t)decay << 16) | ((uint32_t)release << 24);
 }
 
 // Set sustain level (0-32767)
 static inline void hwsynth_set_sustain(uint8_t voice, uint16_t level) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_ENV_SUS) = level;
 }
 
@@ -142,7 +160,7 @@ static inline void hwsynth_set_sustain(uint8_t voice, uint16_t level) {
 // mode: FILTER_LP, FILTER_HP, or FILTER_BP
 static inline void hwsynth_set_filter(uint8_t voice,
                                       uint16_t cutoff, uint8_t resonance, uint8_t mode) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_FILTER) =
         cutoff | ((uint32_t)resonance << 16) | ((uint32_t)(mode & 0x3) << 24);
 }
@@ -151,7 +169,7 @@ static inline void hwsynth_set_filter(uint8_t voice,
 // amount: signed, how much envelope affects cutoff (-32768 to 32767)
 // enable: 1 to enable modulation, 0 to disable
 static inline void hwsynth_set_env_mod(uint8_t voice, int16_t amount, uint8_t enable) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_MOD) =
         ((uint32_t)(uint16_t)amount) | ((uint32_t)(enable & 1) << 16);
 }
@@ -160,12 +178,12 @@ static inline void hwsynth_set_env_mod(uint8_t voice, int16_t amount, uint8_t en
 // Gate control (note on/off)
 // ============================================================================
 static inline void hwsynth_gate_on(uint8_t voice) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_GATE) = 0x03;  // gate=1, trigger=1
 }
 
 static inline void hwsynth_gate_off(uint8_t voice) {
-    if (voice >= 4) return;
+    if (voice >= HWSYNTH_VOICES) return;
     HWSYNTH_VOICE_REG(voice, VOICE_GATE) = 0x00;  // gate=0
 }
 
@@ -182,8 +200,9 @@ static inline int hwsynth_sample_ready(void) {
     return (HWSYNTH_STATUS & 0x01) != 0;
 }
 
-static inline uint8_t hwsynth_active_voices(void) {
-    return (HWSYNTH_STATUS >> 4) & 0xF;
+// Bit n set while voice n's envelope runs
+static inline uint32_t hwsynth_active_voices(void) {
+    return HWSYNTH_ACTIVE;
 }
 
 // ============================================================================
@@ -204,30 +204,33 @@ midi_error_t midi_file_select_track(midi_file_t *mf, uint16_t track)
     return MIDI_ERR_INVALID_TRACK;
 }
 
-midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
+/* Parse the next event at a track cursor.
+ * Shared by the single-track reader and the merged iterator; tempo and
+ * other file-wide state are left to the caller.
+ */
+static midi_error_t parse_event(const uint8_t *buffer,
+                                midi_cursor_t *c,
+                                midi_event_t *evt)
 {
     uint32_t delta;
     size_t vlq_len;
     uint8_t status;
     size_t remaining;
 
-    if (!mf || !evt)
-        return MIDI_ERR_INVALID_EVENT;
-
-    if (mf->track_ended)
+    if (c->ended)
         return MIDI_ERR_END_OF_TRACK;
 
-    if (mf->buf_pos >= mf->track_end)
+    if (c->pos >= c->end)
         return MIDI_ERR_END_OF_TRACK;
 
-    remaining = mf->track_end - mf->buf_pos;
+    remaining = c->end - c->pos;
 
     /* Read delta time */
-    vlq_len = read_vlq(mf->buffer + mf->buf_pos, remaining, &delta);
+    vlq_len = read_vlq(buffer + c->pos, remaining, &delta);
     if (vlq_len == 0)
         return MIDI_ERR_TRUNCATED;
 
-    mf->buf_pos += vlq_len;
+    c->pos += vlq_len;
     remaining -= vlq_len;
 
     if (remaining == 0)
@@ -238,29 +241,29 @@ midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
     evt->delta_time = delta;
 
     /* Guard against track_time overflow */
-    if (delta > UINT32_MAX - mf->track_time)
+    if (delta > UINT32_MAX - c->time)
         return MIDI_ERR_INVALID_EVENT;
 
-    mf->track_time += delta;
-    evt->abs_time = mf->track_time;
+    c->time += delta;
+    evt->abs_time = c->time;
 
     /* Read status byte */
-    status = mf->buffer[mf->buf_pos];
+    status = buffer[c->pos];
 
     if (status & 0x80) {
         /* New status byte */
-        mf->buf_pos++;
+        c->pos++;
         remaining--;
 
         if (status < 0xF0) {
             /* Channel message - update running status */
-            mf->running_status = status;
+            c->running_status = status;
         }
     } else {
         /* Running status */
-        if (mf->running_status == 0)
+        if (c->running_status == 0)
             return MIDI_ERR_INVALID_EVENT;
-        status = mf->running_status;
+        status = c->running_status;
     }
 
     evt->status = status;
@@ -276,11 +279,11 @@ midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
             return MIDI_ERR_TRUNCATED;
 
         if (data_len >= 1) {
-            evt->data1 = mf->buffer[mf->buf_pos++];
+            evt->data1 = buffer[c->pos++];
             remaining--;
         }
         if (data_len >= 2) {
-            evt->data2 = mf->buffer[mf->buf_pos++];
+            evt->data2 = buffer[c->pos++];
             remaining--;
         }
     } else if (status == 0xFF) {
@@ -290,43 +293,38 @@ midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
         if (remaining < 1)
             return MIDI_ERR_TRUNCATED;
 
-        evt->meta_type = mf->buffer[mf->buf_pos++];
+        evt->meta_type = buffer[c->pos++];
         remaining--;
 
-        vlq_len = read_vlq(mf->buffer + mf->buf_pos, remaining, &meta_len);
+        vlq_len = read_vlq(buffer + c->pos, remaining, &meta_len);
         if (vlq_len == 0)
             return MIDI_ERR_TRUNCATED;
 
-        mf->buf_pos += vlq_len;
+        c->pos += vlq_len;
         remaining -= vlq_len;
 
         if (remaining < meta_len)
             return MIDI_ERR_TRUNCATED;
 
         evt->meta_length = meta_len;
-        evt->meta_data = mf->buffer + mf->buf_pos;
+        evt->meta_data = buffer + c->pos;
         evt->type = 0xFF;
 
-        /* Handle tempo changes */
-        if (evt->meta_type == MIDI_META_TEMPO && meta_len == 3) {
-            mf->tempo = read_be24(evt->meta_data);
-        }
-
         /* Check for end of track */
         if (evt->meta_type == MIDI_META_END_OF_TRACK) {
-            mf->track_ended = 1;
+            c->ended = 1;
         }
 
-        mf->buf_pos += meta_len;
+        c->pos += meta_len;
     } else if (status == 0xF0 || status == 0xF7) {
         /* SysEx event */
         uint32_t sysex_len;
 
-        vlq_len = read_vlq(mf->buffer + mf->buf_pos, remaining, &sysex_len);
+        vlq_len = read_vlq(buffer + c->pos, remaining, &sysex_len);
         if (vlq_len == 0)
             return MIDI_ERR_TRUNCATED;
 
-        mf->buf_pos += vlq_len;
+        c->pos += vlq_len;
         remaining -= vlq_len;
 
         if (remaining < sysex_len)
@@ -334,29 +332,29 @@ midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
 
         evt->type = status;
         evt->meta_length = sysex_len;
-        evt->meta_data = mf->buffer + mf->buf_pos;
+        evt->meta_data = buffer + c->pos;
 
-        mf->buf_pos += sysex_len;
+        c->pos += sysex_len;
 
         /* Clear running status after SysEx */
-        mf->running_status = 0;
+        c->running_status = 0;
     } else {
         /* System common messages - consume their data bytes properly */
         evt->type = status;
-        mf->running_status = 0;
+        c->running_status = 0;
 
         switch (status) {
         case 0xF1: /* MIDI Time Code Quarter Frame - 1 data byte */
         case 0xF3: /* Song Select - 1 data byte */
             if (remaining < 1)
                 return MIDI_ERR_TRUNCATED;
-            evt->data1 = mf->buffer[mf->buf_pos++];
+            evt->data1 = buffer[c->pos++];
             break;
         case 0xF2: /* Song Position Pointer - 2 data bytes */
             if (remaining < 2)
                 return MIDI_ERR_TRUNCATED;
-            evt->data1 = mf->buffer[mf->buf_pos++];
-            evt->data2 = mf->buffer[mf->buf_pos++];
+            evt->data1 = buffer[c->pos++];
+            evt->data2 = buffer[c->pos++];
             break;
         case 0xF6: /* Tune Request - no data */
         case 0xF8: /* Timing Clock - no data */
@@ -375,6 +373,40 @@ midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
     return MIDI_OK;
 }
 
+/* Apply the file-wide effect of an event */
+static void apply_event(midi_file_t *mf, const midi_event_t *evt)
+{
+    if (evt->type == 0xFF && evt->meta_type == MIDI_META_TEMPO &&
+        evt->meta_length == 3)
+        mf->tempo = read_be24(evt->meta_data);
+}
+
+midi_error_t midi_file_next_event(midi_file_t *mf, midi_event_t *evt)
+{
+    midi_cursor_t c;
+    midi_error_t err;
+
+    if (!mf || !evt)
+        return MIDI_ERR_INVALID_EVENT;
+
+    c.pos = mf->buf_pos;
+    c.end = mf->track_end;
+    c.time = mf->track_time;
+    c.running_status = mf->running_status;
+    c.ended = mf->track_ended;
+
+    err = parse_event(mf->buffer, &c, evt);
+
+    mf->buf_pos = c.pos;
+    mf->track_time = c.time;
+    mf->running_status = c.running_status;
+    mf->track_ended = c.ended;
+
+    if (err == MIDI_OK)
+        apply_event(mf, evt);
+    return err;
+}
+
 uint32_t midi_ticks_to_ms(const midi_file_t *mf, uint32_t ticks)
 {
     uint64_t us;
@@ -425,3 +457,204 @@ uint32_t midi_ticks_to_samples(const midi_file_t *mf,
     /* Saturate to UINT32_MAX on overflow */
     return samples > UINT32_MAX ? UINT32_MAX : (uint32_t) samples;
 }
+
+/* Heap order of the merged iterator: earlier tick first, then lower track */
+static int merge_before(const midi_merge_t *m, uint8_t a, uint8_t b)
+{
+    uint32_t ta = m->pending[a].abs_time;
+    uint32_t tb = m->pending[b].abs_time;
+    return ta < tb || (ta == tb && a < b);
+}
+
+static void merge_sift_up(midi_merge_t *m, uint8_t i)
+{
+    while (i > 0) {
+        uint8_t parent = (uint8_t) ((i - 1) / 2);
+        uint8_t t;
+        if (!merge_before(m, m->heap[i], m->heap[parent]))
+            break;
+        t = m->heap[i];
+        m->heap[i] = m->heap[parent];
+        m->heap[parent] = t;
+        i = parent;
+    }
+}
+
+static void merge_sift_down(midi_merge_t *m, uint8_t i)
+{
+    for (;;) {
+        uint8_t best = i;
+        uint8_t left = (uint8_t) (2 * i + 1);
+        uint8_t right = (uint8_t) (2 * i + 2);
+        uint8_t t;
+        if (left < m->heap_size &&
+            merge_before(m, m->heap[left], m->heap[best]))
+            best = left;
+        if (right < m->heap_size &&
+            merge_before(m, m->heap[right], m->heap[best]))
+            best = right;
+        if (best == i)
+            break;
+        t = m->heap[i];
+        m->heap[i] = m->heap[best];
+        m->heap[best] = t;
+        i = best;
+    }
+}
+
+midi_error_t midi_merge_open(midi_merge_t *m, midi_file_t *mf)
+{
+    uint32_t chunk_id, chunk_len;
+    size_t pos;
+    midi_error_t err;
+
+    if (!m || !mf || !mf->buffer || mf->buf_len < 14)
+        return MIDI_ERR_INVALID_HEADER;
+
+    memset(m, 0, sizeof(midi_merge_t));
+    m->mf = mf;
+    m->refill = -1;
+    mf->tempo = MIDI_DEFAULT_TEMPO;
+
+    if (mf->header.ntracks > MIDI_MERGE_MAX_TRACKS)
+        return MIDI_ERR_UNSUPPORTED_FMT;
+
+    /* One scan over the chunks finds every track */
+    chunk_len = read_be32(mf->buffer + 4);
+    if (chunk_len > mf->buf_len - 8)
+        return MIDI_ERR_TRUNCATED;
+    pos = 8 + chunk_len;
+
+    while (m->ntracks < mf->header.ntracks && pos + 8 <= mf->buf_len) {
+        chunk_id = read_be32(mf->buffer + pos);
+        chunk_len = read_be32(mf->buffer + pos + 4);
+
+        if (chunk_len > mf->buf_len - pos - 8)
+            return MIDI_ERR_TRUNCATED;
+
+        if (chunk_id == MIDI_CHUNK_MTRK) {
+            uint8_t t = (uint8_t) m->ntracks++;
+            m->cursor[t].pos = pos + 8;
+            m->cursor[t].end = pos + 8 + chunk_len;
+
+            /* Parse ahead; empty tracks never enter the heap */
+            err = parse_event(mf->buffer, &m->cursor[t], &m->pending[t]);
+            if (err == MIDI_OK) {
+                m->heap[m->heap_size] = t;
+                merge_sift_up(m, m->heap_size++);
+            } else if (err != MIDI_ERR_END_OF_TRACK) {
+                return err;
+            }
+        }
+
+        pos += 8 + chunk_len;
+    }
+
+    if (m->ntracks < mf->header.ntracks)
+        return MIDI_ERR_INVALID_TRACK;
+
+    return MIDI_OK;
+}
+
+midi_error_t midi_merge_next(midi_merge_t *m,
+                             midi_event_t *evt,
+                             uint16_t *track)
+{
+    midi_error_t err;
+    uint8_t t;
+
+    if (!m || !evt)
+        return MIDI_ERR_INVALID_EVENT;
+
+    if (m->error != MIDI_OK)
+        return m->error;
+
+    /* Advance the track returned last; it still sits at the heap root */
+    if (m->refill >= 0) {
+        t = (uint8_t) m->refill;
+        m->refill = -1;
+        err = parse_event(m->mf->buffer, &m->cursor[t], &m->pending[t]);
+        if (err == MIDI_ERR_END_OF_TRACK) {
+            m->heap[0] = m->heap[--m->heap_size];
+        } else if (err != MIDI_OK) {
+            m->error = err;
+            return err;
+        }
+        merge_sift_down(m, 0);
+    }
+
+    if (m->heap_size == 0)
+        return MIDI_ERR_END_OF_FILE;
+
+    t = m->heap[0];
+    *evt = m->pending[t];
+    if (track)
+        *track = t;
+    m->refill = (int8_t) t;
+
+    apply_event(m->mf, evt);
+    return MIDI_OK;
+}
+
+midi_error_t midi_file_compile(midi_file_t *mf,
+                               uint32_t sample_rate,
+                               midi_compiled_event_t *events,
+                               size_t max_events,
+                               size_t *count)
+{
+    midi_merge_t m;
+    midi_event_t evt;
+    uint16_t track;
+    uint32_t tempo;
+    uint32_t seg_tick = 0;   /* Tick of the last tempo change */
+    uint32_t seg_sample = 0; /* Its time in samples */
+    size_t n = 0;
+    midi_error_t err;
+
+    if (!mf || !count)
+        return MIDI_ERR_INVALID_EVENT;
+
+    *count = 0;
+
+    err = midi_merge_open(&m, mf);
+    if (err != MIDI_OK)
+        return err;
+
+    for (;;) {
+        tempo = mf->tempo;
+        err = midi_merge_next(&m, &evt, &track);
+        if (err == MIDI_ERR_END_OF_FILE)
+            break;
+        if (err != MIDI_OK)
+            return err;
+
+        if (mf->tempo != tempo) {
+            /* Close the segment at the old tempo, continue at the new one */
+            uint32_t new_tempo = mf->tempo;
+            mf->tempo = tempo;
+            seg_sample +=
+                midi_ticks_to_samples(mf, evt.abs_time - seg_tick, sample_rate);
+            seg_tick = evt.abs_time;
+            mf->tempo = new_tempo;
+        }
+
+        /* Only channel messages reach the playback loop */
+        if (evt.status >= 0xF0)
+            continue;
+
+        if (events && n < max_events) {
+            midi_compiled_event_t *out = &events[n];
+            out->sample = seg_sample + midi_ticks_to_samples(
+                                           mf, evt.abs_time - seg_tick,
+                                           sample_rate);
+            out->status = evt.status;
+            out->data1 = evt.data1;
+            out->data2 = evt.data2;
+            out->track = (uint8_t) track;
+        }
+        n++;
+    }
+
+    *count = n;
+    return (events && n > max_events) ? MIDI_ERR_BUFFER_FULL : MIDI_OK;
+}
@@ -14,6 +14,12 @@
  *       }
  *   }
  *
+ * Format 1 files interleave their tracks in time. midi_merge_open() and
+ * midi_merge_next() yield the events of all tracks in global time order;
+ * midi_file_compile() goes one step further and flattens the file into an
+ * array of channel events stamped in samples, for a playback loop that does
+ * no parsing at all.
+ *
  * Reference: MIDI 1.0 Detailed Specification (midi.org)
  */
 
@@ -33,6 +39,7 @@ typedef enum {
     MIDI_ERR_INVALID_EVENT,   /* Malformed event data */
     MIDI_ERR_END_OF_TRACK,    /* No more events in current track */
     MIDI_ERR_END_OF_FILE,     /* No more tracks to process */
+    MIDI_ERR_BUFFER_FULL,     /* Caller-provided array too small */
 } midi_error_t;
 
 /* MIDI event types (status byte high nibble) */
@@ -110,6 +117,43 @@ typedef struct {
     uint32_t tempo; /* Default: 500000 (120 BPM) */
 } midi_file_t;
 
+/* Maximum number of tracks the merged iterator follows */
+#define MIDI_MERGE_MAX_TRACKS 16
+
+/* Read position within one track */
+typedef struct {
+    size_t pos;             /* Next byte to parse */
+    size_t end;             /* End of track data */
+    uint32_t time;          /* Accumulated time in ticks */
+    uint8_t running_status; /* Running status byte */
+    uint8_t ended;          /* End of track seen */
+} midi_cursor_t;
+
+/* Merged iterator over all tracks of a file.
+ * Every live track has its next event parsed ahead; a min-heap of track
+ * indices keyed by (abs_time, track) picks the earliest one, so events at
+ * the same tick come out in track order.
+ */
+typedef struct {
+    midi_file_t *mf;
+    uint16_t ntracks;   /* Tracks found in the file */
+    uint8_t heap_size;  /* Tracks with an event pending */
+    int8_t refill;      /* Track yielded last, to be advanced; -1 if none */
+    midi_error_t error; /* Sticky parse error */
+    uint8_t heap[MIDI_MERGE_MAX_TRACKS];
+    midi_cursor_t cursor[MIDI_MERGE_MAX_TRACKS];
+    midi_event_t pending[MIDI_MERGE_MAX_TRACKS];
+} midi_merge_t;
+
+/* Channel event of a compiled file (8 bytes) */
+typedef struct {
+    uint32_t sample; /* Time in samples from the start of the file */
+    uint8_t status;  /* Status byte (type | channel) */
+    uint8_t data1;   /* First data byte */
+    uint8_t data2;   /* Second data byte (0 if unused) */
+    uint8_t track;   /* Source track index */
+} midi_compiled_event_t;
+
 /**
  * Open and parse MIDI file header.
  * @param mf      Parser state (caller-allocated)
@@ -163,6 +207,46 @@ uint32_t midi_ticks_to_samples(const midi_file_t *mf,
                                uint32_t ticks,
                                uint32_t sample_rate);
 
+/**
+ * Start a merged iteration over all tracks.
+ * Resets the tempo to the default, as playback starts at tick 0.
+ * @param m   Iterator state (caller-allocated)
+ * @param mf  Opened parser state, kept by the iterator for buffer and tempo
+ * @return MIDI_OK on success, MIDI_ERR_UNSUPPORTED_FMT with more than
+ *         MIDI_MERGE_MAX_TRACKS tracks, or a parse error of a first event
+ */
+midi_error_t midi_merge_open(midi_merge_t *m, midi_file_t *mf);
+
+/**
+ * Read the next event of the file in global time order.
+ * Tempo meta events update mf->tempo as they are returned.
+ * @param m      Iterator state
+ * @param evt    Event structure to fill (caller-allocated)
+ * @param track  Receives the source track index (may be NULL)
+ * @return MIDI_OK on success, MIDI_ERR_END_OF_FILE when all tracks are done
+ */
+midi_error_t midi_merge_next(midi_merge_t *m,
+                             midi_event_t *evt,
+                             uint16_t *track);
+
+/**
+ * Flatten a file into its channel events in time order.
+ * Timestamps follow every tempo change, accumulated per tempo segment so
+ * they do not drift. Meta and SysEx events are dropped.
+ * @param mf          Opened parser state (tempo is left at the last change)
+ * @param sample_rate Sample rate in Hz
+ * @param events      Output array, or NULL to only count
+ * @param max_events  Capacity of events
+ * @param count       Receives the number of channel events in the file
+ * @return MIDI_OK on success, MIDI_ERR_BUFFER_FULL if the array was filled
+ *         before the end, or a parse error
+ */
+midi_error_t midi_file_compile(midi_file_t *mf,
+                               uint32_t sample_rate,
+                               midi_compiled_event_t *events,
+                               size_t max_events,
+                               size_t *count);
+
 /**
  * Check if event is a note-on with velocity > 0.
  * Note: MIDI note-on with velocity 0 is equivalent to note-off.
@@ -1,65 +1,244 @@
-#include <stddef.h>
-#include <stdint.h>
-#include "mini_libc.h"
-#define HEAP_SIZE (32 * 1024)
-
-static uint8_t g_heap[HEAP_SIZE];
-static size_t g_heap_off;
-void *memcpy(void *dest, const void *src, unsigned int n)
-{
-    char *d = dest;
-    const char *s = src;
-    while (n--)
-        *d++ = *s++;
-    return dest;
-}
-
-void *memmove(void *dest, const void *src, unsigned int n)
-{
-    char *d = dest;
-    const char *s = src;
-
-    if (d < s) {
-        while (n--)
-            *d++ = *s++;
-    } else {
-        d += n;
-        s += n;
-        while (n--)
-            *--d = *--s;
-    }
-    return dest;
-}
-
-void *memset(void *dest, int c, unsigned int n)
-{
-    unsigned char *d = dest;
-    while (n--)
-        *d++ = (unsigned char) c;
-    return dest;
-}
-
-unsigned int strlen(const char *s)
-{
-    unsigned int len = 0;
-    while (*s++)
-        len++;
-    return len;
-}
-
-void *malloc(size_t n) {
-    n = (n + 7u) & ~7u;
-    if (g_heap_off + n > HEAP_SIZE) return (void*)0;
-    void *p = &g_heap[g_heap_off];
-    g_heap_off += n;
-    return p;
-}
-
-void free(void *p) { (void)p; }
-
-void *calloc(size_t nmemb, size_t size) {
-    size_t n = nmemb * size;
-    void *p = malloc(n);
-    if (p) memset(p, 0, n);
-    return p;
-}
+/*
+ * mini_libc.c - Freestanding runtime support for the csrc programs
+ *
+ * Word-wide mem* and strlen, byte-wise strcpy/strcmp, and a size-class allocator over the heap that
+ * init.S and link.lds leave between the end of .bss and the stack limit.
+ * Built with -fno-tree-loop-distribute-patterns so the byte loops here are
+ * not turned back into calls to themselves.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mini_libc.h"
+
+/* Word access that may alias any object type */
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+void *memcpy(void *dest, const void *src, unsigned int n)
+{
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+
+    /* Word copy when both pointers can reach alignment together */
+    if ((((uintptr_t) d ^ (uintptr_t) s) & 3) == 0) {
+        word_t *dw;
+        const word_t *sw;
+
+        while (((uintptr_t) d & 3) && n) {
+            *d++ = *s++;
+            n--;
+        }
+        dw = (word_t *) d;
+        sw = (const word_t *) s;
+        for (; n >= 16; n -= 16, dw += 4, sw += 4) {
+            dw[0] = sw[0];
+            dw[1] = sw[1];
+            dw[2] = sw[2];
+            dw[3] = sw[3];
+        }
+        for (; n >= 4; n -= 4)
+            *dw++ = *sw++;
+        d = (uint8_t *) dw;
+        s = (const uint8_t *) sw;
+    }
+
+    while (n--)
+        *d++ = *s++;
+    return dest;
+}
+
+void *memmove(void *dest, const void *src, unsigned int n)
+{
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+
+    /* Forward copy is safe unless dest starts inside src */
+    if (d <= s || d >= s + n)
+        return memcpy(dest, src, n);
+
+    /* Overlapping with dest above src: copy down from the end */
+    d += n;
+    s += n;
+    if ((((uintptr_t) d ^ (uintptr_t) s) & 3) == 0) {
+        word_t *dw;
+        const word_t *sw;
+
+        while (((uintptr_t) d & 3) && n) {
+            *--d = *--s;
+            n--;
+        }
+        dw = (word_t *) d;
+        sw = (const word_t *) s;
+        for (; n >= 16; n -= 16) {
+            dw -= 4;
+            sw -= 4;
+            dw[3] = sw[3];
+            dw[2] = sw[2];
+            dw[1] = sw[1];
+            dw[0] = sw[0];
+        }
+        for (; n >= 4; n -= 4)
+            *--dw = *--sw;
+        d = (uint8_t *) dw;
+        s = (const uint8_t *) sw;
+    }
+
+    while (n--)
+        *--d = *--s;
+    return dest;
+}
+
+void *memset(void *dest, int c, unsigned int n)
+{
+    uint8_t *d = dest;
+    uint32_t w = (uint8_t) c;
+    word_t *dw;
+
+    while (((uintptr_t) d & 3) && n) {
+        *d++ = (uint8_t) c;
+        n--;
+    }
+
+    w |= w << 8;
+    w |= w << 16;
+    dw = (word_t *) d;
+    for (; n >= 16; n -= 16, dw += 4) {
+        dw[0] = w;
+        dw[1] = w;
+        dw[2] = w;
+        dw[3] = w;
+    }
+    for (; n >= 4; n -= 4)
+        *dw++ = w;
+
+    d = (uint8_t *) dw;
+    while (n--)
+        *d++ = (uint8_t) c;
+    return dest;
+}
+
+size_t strlen(const char *s)
+{
+    const char *p = s;
+    const word_t *w;
+
+    while ((uintptr_t) p & 3) {
+        if (!*p)
+            return (size_t) (p - s);
+        p++;
+    }
+
+    /* A word holds a zero byte iff (x - 0x01..) & ~x & 0x80.. is non-zero.
+     * Aligned word reads never cross into an unmapped page.
+     */
+    w = (const word_t *) p;
+    while (!((*w - 0x01010101u) & ~*w & 0x80808080u))
+        w++;
+
+    p = (const char *) w;
+    while (*p)
+        p++;
+    return (size_t) (p - s);
+}
+
+char *strcpy(char *dest, const char *src)
+{
+    char *d = dest;
+
+    while ((*d++ = *src++))
+        ;
+    return dest;
+}
+
+int strcmp(const char *a, const char *b)
+{
+    while (*a && *a == *b)
+        a++, b++;
+    return (unsigned char) *a - (unsigned char) *b;
+}
+
+/* Heap bounds: end of .bss up to the data TCM (both link.lds) */
+extern uint8_t __heap_start[];
+extern uint8_t __heap_end[];
+
+/* Size classes are powers of two from 16 bytes to 1 MB, header included.
+ * Freed blocks go on the list of their class and are reused as they are,
+ * so a free/malloc cycle of the same size never grows the heap; blocks are
+ * neither split nor coalesced.
+ */
+#define HEAP_MIN_SHIFT 4
+#define HEAP_CLASSES 17
+
+/* Block header, 8 bytes so payloads stay 8-byte aligned */
+typedef struct {
+    uint32_t size_class;
+    uint32_t reserved;
+} heap_block_t;
+
+/* Free blocks link through their first payload word */
+typedef struct heap_free {
+    struct heap_free *next;
+} heap_free_t;
+
+static heap_free_t *heap_free_list[HEAP_CLASSES];
+static uint8_t *heap_next;
+
+void *malloc(size_t n)
+{
+    heap_block_t *b;
+    uint32_t cls = 0;
+    size_t need = n + sizeof(heap_block_t);
+
+    if (n > (1u << (HEAP_MIN_SHIFT + HEAP_CLASSES - 1)) - sizeof(heap_block_t))
+        return NULL;
+
+    while (((size_t) 1 << (HEAP_MIN_SHIFT + cls)) < need)
+        cls++;
+
+    if (heap_free_list[cls]) {
+        heap_free_t *f = heap_free_list[cls];
+        heap_free_list[cls] = f->next;
+        return f;
+    }
+
+    if (!heap_next) {
+        uintptr_t start = (uintptr_t) __heap_start;
+        heap_next = (uint8_t *) ((start + 7) & ~(uintptr_t) 7);
+    }
+
+    if (((size_t) 1 << (HEAP_MIN_SHIFT + cls)) >
+        (size_t) (__heap_end - heap_next))
+        return NULL;
+
+    b = (heap_block_t *) heap_next;
+    b->size_class = cls;
+    heap_next += (size_t) 1 << (HEAP_MIN_SHIFT + cls);
+    return b + 1;
+}
+
+void free(void *p)
+{
+    heap_free_t *f = p;
+    uint32_t cls;
+
+    if (!p)
+        return;
+
+    cls = ((heap_block_t *) p - 1)->size_class;
+    f->next = heap_free_list[cls];
+    heap_free_list[cls] = f;
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    size_t n = nmemb * size;
+    void *p;
+
+    if (size && n / size != nmemb)
+        return NULL;
+
+    p = malloc(n);
+    if (p)
+        memset(p, 0, n);
+    return p;
+}
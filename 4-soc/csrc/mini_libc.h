@@ -1,12 +1,20 @@
-#pragma once
-#include <stddef.h>
-#include <stdint.h>
-
-void *memset(void *dest, int c, unsigned int n);
-void *memcpy(void *dest, const void *src, unsigned int n);
-void *memmove(void *dest, const void *src, unsigned int n);
-size_t strlen(const char *s);
-
-void *malloc(size_t n);
-void free(void *p);
-void *calloc(size_t nmemb, size_t size);
\ No newline at end of file
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* Freestanding runtime shared by every csrc program (see mini_libc.c).
+ * The compiler emits calls to the mem* functions for struct copies and
+ * clearing loops even with -fno-builtin.
+ */
+
+void *memset(void *dest, int c, unsigned int n);
+void *memcpy(void *dest, const void *src, unsigned int n);
+void *memmove(void *dest, const void *src, unsigned int n);
+size_t strlen(const char *s);
+char *strcpy(char *dest, const char *src);
+int strcmp(const char *a, const char *b);
+
+/* Heap between __heap_start and __heap_end (link.lds) */
+void *malloc(size_t n);
+void free(void *p);
+void *calloc(size_t nmemb, size_t size);
@@ -23,7 +23,8 @@
  *   +0x08: VGA_INTR_STATUS - Vblank interrupt flag (W1C)
  *   +0x10: VGA_UPLOAD_ADDR - Framebuffer upload address (nibble index + frame)
  *   +0x14: VGA_STREAM_DATA - 8 pixels packed in 32-bit word (auto-increment)
- *   +0x20: VGA_CTRL        - Display enable, blank, swap request, frame select
+ *   +0x20: VGA_CTRL        - Display enable, blank, swap request, frame
+ *                            select, vblank interrupt enable
  *   +0x24-0x60: VGA_PALETTE[0-15] - 6-bit VGA colors (RRGGBB)
  *
  * Two access patterns are supported:
@@ -60,6 +61,23 @@
 #define VGA_NUM_FRAMES 12
 #define VGA_EXPECTED_ID 0x56474131u /* 'VGA1' */
 
+/* VGA_STATUS bits */
+#define VGA_STATUS_VBLANK (1u << 0)
+#define VGA_STATUS_SAFE_TO_SWAP (1u << 1)
+
+/* VGA_INTR_STATUS bits */
+#define VGA_INTR_VBLANK (1u << 0)
+
+/* VGA_CTRL bits. With VBLANK_IE set, each vblank start latches
+ * VGA_INTR_VBLANK and raises a machine external interrupt (interrupt_flag
+ * bit 3) until it is cleared.
+ */
+#define VGA_CTRL_ENABLE (1u << 0)
+#define VGA_CTRL_BLANK (1u << 1)
+#define VGA_CTRL_SWAP_REQ (1u << 2)
+#define VGA_CTRL_FRAME(n) ((uint32_t) (n) << 4)
+#define VGA_CTRL_VBLANK_IE (1u << 8)
+
 /* VGA MMIO access helper functions */
 static inline void vga_write32(uint32_t addr, uint32_t val)
 {
@@ -110,6 +128,9 @@ static inline uint32_t vga_pack8_pixels(const uint8_t *pixels)
  *   +0x08: UART_INTERRUPT - Interrupt enable (write: non-zero enables)
  *   +0x0C: UART_RECV      - Receive data register (read clears interrupt)
  *   +0x10: UART_SEND      - Transmit data register (write-only)
+ *   +0x14: UART_IRQ_EN    - Level interrupt enables (RW, interrupt_flag bit 4)
+ *                           bit 0: RX FIFO non-empty
+ *                           bit 1: TX ready
  *
  * TX Operation:
  *   - Architecture: CPU → Buffer (1 byte) → Tx (shift register) → txd pin
@@ -142,6 +163,11 @@ static inline uint32_t vga_pack8_pixels(const uint8_t *pixels)
 #define UART_INTERRUPT ((volatile uint32_t *) (UART_BASE + 0x08)) /* WO */
 #define UART_RECV ((volatile uint32_t *) (UART_BASE + 0x0C))      /* RO */
 #define UART_SEND ((volatile uint32_t *) (UART_BASE + 0x10))      /* WO */
+#define UART_IRQ_EN ((volatile uint32_t *) (UART_BASE + 0x14))    /* RW */
+
+/* UART_IRQ_EN bits; uart-ring.c drives them */
+#define UART_IRQ_RX (1u << 0)
+#define UART_IRQ_TX (1u << 1)
 
 /* Legacy alias for backward compatibility */
 #define UART_ENABLE UART_INTERRUPT
@@ -179,18 +205,99 @@ static inline uint32_t vga_pack8_pixels(const uint8_t *pixels)
  *   }
  */
 
-/* Test harness registers (simulation only) */
+/**
+ * Simulation control registers (simulation only, base: 0x00000100)
+ *
+ * Plain RAM on hardware; the Verilator harness also decodes stores here.
+ *
+ * Register Map:
+ *   +0x00: TEST_DONE_FLAG   - Write 0xCAFEF00D: test finished, stop (status 0)
+ *   +0x04: TEST_RESULT      - Result word reported with TEST_DONE_FLAG
+ *   +0x08: SIM_EXIT         - Stop now, exit status = value & 0xFF
+ *   +0x0C: SIM_TIMESTAMP    - Print cycle and host time, tagged with value
+ *   +0x10: SIM_REGION_BEGIN - Start measurement region n (0-7)
+ *   +0x14: SIM_REGION_END   - Stop region n; cycles are summed and reported
+ *   +0x18: (reserved)       - End of the decoded registers (SimControl::LIMIT)
+ *   +0x1C: (RAM word)       - 0x464C457F when the simulator loaded an ELF and
+ *                             zeroed .bss; init.S then skips clearing it
+ *
+ * crt0 (init.S) writes main()'s return value to SIM_EXIT.
+ */
 /* Cast via uintptr_t to suppress -Warray-bounds warning at -O2 */
 #define TEST_DONE_FLAG ((volatile uint32_t *) (uintptr_t) 0x100)
 #define TEST_RESULT ((volatile uint32_t *) (uintptr_t) 0x104)
+#define SIM_EXIT ((volatile uint32_t *) (uintptr_t) 0x108)
+#define SIM_TIMESTAMP ((volatile uint32_t *) (uintptr_t) 0x10C)
+#define SIM_REGION_BEGIN ((volatile uint32_t *) (uintptr_t) 0x110)
+#define SIM_REGION_END ((volatile uint32_t *) (uintptr_t) 0x114)
 
+/**
+ * Audio output (base: 0x60000000), one sample per 1/11025 s from the FIFO
+ *
+ * Register Map:
+ *   +0x00: AUDIO_ID        - 0x41554449 'AUDI' (RO)
+ *   +0x04: AUDIO_STATUS    - [2] below watermark, [1] full, [0] empty (RO)
+ *   +0x08: AUDIO_DATA      - Push a 16-bit sample; dropped while full (WO)
+ *   +0x0C: AUDIO_LEVEL     - Samples queued (RO)
+ *   +0x10: AUDIO_WATERMARK - Below the watermark while LEVEL <= WATERMARK
+ *   +0x14: AUDIO_CTRL      - [0] watermark interrupt enable
+ *   +0x18: AUDIO_UNDERRUN  - Sample ticks that found the FIFO empty since the
+ *                            first sample; write to clear
+ *
+ * The watermark interrupt is a machine external interrupt that stays pending
+ * until the FIFO is refilled above WATERMARK. Block rendering:
+ *
+ *   AUDIO_WATERMARK = PICOSYNTH_BLOCK_SIZE;
+ *   for (;;) {
+ *     while (!(AUDIO_STATUS & AUDIO_BELOW_WATERMARK))
+ *       __asm__ volatile("wfi");
+ *     // render PICOSYNTH_BLOCK_SIZE samples into AUDIO_DATA
+ *   }
+ */
 #define AUDIO_BASE   0x60000000u
 #define AUDIO_ID     (*(volatile uint32_t*)(AUDIO_BASE + 0x00))
 #define AUDIO_STATUS (*(volatile uint32_t*)(AUDIO_BASE + 0x04))
 #define AUDIO_DATA   (*(volatile uint32_t*)(AUDIO_BASE + 0x08))
+#define AUDIO_LEVEL  (*(volatile uint32_t*)(AUDIO_BASE + 0x0C))
+#define AUDIO_WATERMARK (*(volatile uint32_t*)(AUDIO_BASE + 0x10))
+#define AUDIO_CTRL   (*(volatile uint32_t*)(AUDIO_BASE + 0x14))
+#define AUDIO_UNDERRUN (*(volatile uint32_t*)(AUDIO_BASE + 0x18))
 
 #define AUDIO_FIFO_EMPTY (1 << 0)
 #define AUDIO_FIFO_FULL  (1 << 1)
+#define AUDIO_BELOW_WATERMARK (1 << 2)
+
+#define AUDIO_CTRL_IRQ (1 << 0)
+
+/**
+ * DMA controller (base: 0xA0000000)
+ *
+ * Register Map:
+ *   +0x00: DMA_ID     - Peripheral identification (RO: 0x444D4131 = 'DMA1')
+ *   +0x04: DMA_STATUS - [1] done (write 1 to clear), [0] busy
+ *   +0x08: DMA_SRC    - Source address (word aligned)
+ *   +0x0C: DMA_DST    - Destination address (word aligned)
+ *   +0x10: DMA_COUNT  - Words to copy
+ *   +0x14: DMA_CTRL   - [4] pace, [3] irq, [2] dst_inc, [1] src_inc, [0] start
+ *
+ * SRC/DST/COUNT/CTRL writes are ignored while busy. See dma.h.
+ */
+#define DMA_BASE 0xA0000000u
+#define DMA_ID ((volatile uint32_t *) (DMA_BASE + 0x00))     /* RO */
+#define DMA_STATUS ((volatile uint32_t *) (DMA_BASE + 0x04)) /* RW */
+#define DMA_SRC ((volatile uint32_t *) (DMA_BASE + 0x08))    /* RW */
+#define DMA_DST ((volatile uint32_t *) (DMA_BASE + 0x0C))    /* RW */
+#define DMA_COUNT ((volatile uint32_t *) (DMA_BASE + 0x10))  /* RW */
+#define DMA_CTRL ((volatile uint32_t *) (DMA_BASE + 0x14))   /* RW */
+
+#define DMA_STATUS_BUSY (1u << 0)
+#define DMA_STATUS_DONE (1u << 1)
+
+#define DMA_CTRL_START (1u << 0)
+#define DMA_CTRL_SRC_INC (1u << 1)
+#define DMA_CTRL_DST_INC (1u << 2)
+#define DMA_CTRL_IRQ (1u << 3)
+#define DMA_CTRL_PACE (1u << 4)
 
 
 #endif /* MMIO_H */
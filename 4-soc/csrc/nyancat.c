@@ -2,6 +2,10 @@
 // Nyancat animation program for VGA peripheral (4-soc version)
 // Uses delta-RLE compression for superior compression ratio
 // When USE_PREPACKED_FRAMES=1, uses host-prepacked frame words.
+//
+// Playback is vblank driven and double buffered: frame N is shown from one
+// VGA slot while frame N+1 is decoded into the other, the vblank interrupt
+// handler flips the slots, and the CPU waits in WFI the rest of the time.
 
 #include <stdint.h>
 
@@ -12,6 +16,7 @@
 
 #if USE_PREPACKED_FRAMES
 #include "nyancat-frames.h"
+#include "tcm.h"
 #endif
 
 #if !USE_PREPACKED_FRAMES
@@ -32,6 +37,12 @@ static inline void copy_buffer(uint8_t *dest, const uint8_t *src, int n)
 #define PALETTE_SIZE 14  // Nyancat color count
 #define PALETTE_MAX 16   // VGA palette entries
 
+// Display each frame for this many vblanks (72 Hz / 4 = 18 frames/s)
+#define VBLANKS_PER_FRAME 4
+
+// mcause of a machine external interrupt (the VGA vblank here)
+#define MCAUSE_EXTERNAL 0x8000000Bu
+
 // Opcode format constants
 #define OPCODE_MASK 0xF0   // Extract opcode type
 #define PARAM_MASK 0x0F    // Extract opcode parameter
@@ -81,9 +92,10 @@ void vga_init_palette(void)
 
 #if !USE_PREPACKED_FRAMES
 // Frame buffers for delta decompression (8KB total)
-// Only needed when runtime decompression is used
-static uint8_t frame_buffer[FRAME_SIZE];       // Current frame buffer
-static uint8_t prev_frame_buffer[FRAME_SIZE];  // Previous frame for delta
+// Only needed when runtime decompression is used; the previous frame, read
+// back for every delta, lives in the data TCM
+static uint8_t frame_buffer[FRAME_SIZE];              // Current frame buffer
+static uint8_t prev_frame_buffer[FRAME_SIZE] TCM_BSS; // Previous frame for delta
 #endif
 
 // Compressed nyancat frames from nyancat-frames.h; offsets index into this
@@ -97,11 +109,10 @@ extern const uint8_t nyancat_compressed_data[];
 // Frame 1-11 (delta): 0x0X=SetColor, 0x1Y=Skip(1-16), 0x2Y=Repeat(1-16),
 //                      0x3Y=Skip*16(16-256), 0x4Y=Repeat*16(16-256),
 //                      0x5Y=Skip*64(64-1024)
-void vga_upload_frame_delta(int frame_index)
+void vga_upload_frame_delta(int frame_index, int slot)
 {
-    // Set upload address to start of frame
-    vga_write32(VGA_ADDR_UPLOAD_ADDR,
-                ((uint32_t) (frame_index & 0xF) << 16) | 0);
+    // Set upload address to start of the slot
+    vga_write32(VGA_ADDR_UPLOAD_ADDR, ((uint32_t) (slot & 0xF) << 16) | 0);
 
 #if USE_PREPACKED_FRAMES
     // Directly upload prepacked words for this frame (saves 8KB .bss)
@@ -203,11 +214,10 @@ void vga_upload_frame_delta(int frame_index)
 #else
 
 // Fallback: baseline opcode-RLE decompression
-void vga_upload_frame_rle(int frame_index)
+void vga_upload_frame_rle(int frame_index, int slot)
 {
-    // Set upload address to start of frame
-    vga_write32(VGA_ADDR_UPLOAD_ADDR,
-                ((uint32_t) (frame_index & 0xF) << 16) | 0);
+    // Set upload address to start of the slot
+    vga_write32(VGA_ADDR_UPLOAD_ADDR, ((uint32_t) (slot & 0xF) << 16) | 0);
 
     // Get compressed data for this frame with bounds
     uint16_t offset = nyancat_frame_offsets[frame_index];
@@ -253,12 +263,42 @@ void vga_upload_frame_rle(int frame_index)
 
 #endif
 
-// Simple delay function (~20Hz frame rate)
-// Use inline assembly to prevent compiler optimization
-static inline void delay(uint32_t cycles)
+// Decode one animation frame into a VGA frame slot
+static void upload_frame(int frame_index, int slot)
 {
-    for (uint32_t i = 0; i < cycles; i++)
-        __asm__ volatile("nop");
+#if NYANCAT_COMPRESSION_DELTA
+    vga_upload_frame_delta(frame_index, slot);
+#else
+    vga_upload_frame_rle(frame_index, slot);
+#endif
+}
+
+// Display state shared with the vblank handler
+static volatile uint32_t front_slot;    // Slot on screen (0 or 1)
+static volatile uint32_t swap_pending;  // Back slot holds the next frame
+static uint32_t vblanks;                // Vblanks since the last swap
+
+extern void enable_interrupt(void);
+
+// Vblank handler (overrides the weak trap_handler in init.S): once the frame
+// on screen has had its VBLANKS_PER_FRAME, show the back slot. Switching the
+// frame select inside vblank never tears.
+void trap_handler(uint32_t mepc, uint32_t mcause)
+{
+    (void) mepc;
+
+    if (mcause != MCAUSE_EXTERNAL ||
+        !(vga_read32(VGA_ADDR_INTR_STATUS) & VGA_INTR_VBLANK))
+        return;
+    vga_write32(VGA_ADDR_INTR_STATUS, VGA_INTR_VBLANK);
+
+    if (++vblanks < VBLANKS_PER_FRAME || !swap_pending)
+        return;
+    vblanks = 0;
+    front_slot ^= 1;
+    vga_write32(VGA_ADDR_CTRL, VGA_CTRL_FRAME(front_slot) | VGA_CTRL_VBLANK_IE |
+                                   VGA_CTRL_ENABLE);
+    swap_pending = 0;
 }
 
 int main(void)
@@ -268,31 +308,21 @@ int main(void)
     if (id != VGA_EXPECTED_ID)
         return 1;
 
-    // Initialize palette and enable display
+    // Show frame 0 from slot 0 with the vblank interrupt on
     vga_init_palette();
-    vga_write32(VGA_ADDR_CTRL, 0x01);
-
-#if NYANCAT_COMPRESSION_DELTA
-    // Upload all frames (delta decompression) while keeping frame 0 displayed
-    for (int frame = 0; frame < FRAME_COUNT; frame++)
-        vga_upload_frame_delta(frame);
-
-    // Animate: cycle through frames infinitely
-    for (uint32_t frame = 0;;) {
-        vga_write32(VGA_ADDR_CTRL, (frame << 4) | 0x01);
-        delay(50000);
-        frame = (frame + 1 < FRAME_COUNT) ? frame + 1 : 0;
+    upload_frame(0, 0);
+    front_slot = 0;
+    vga_write32(VGA_ADDR_INTR_STATUS, VGA_INTR_VBLANK);
+    vga_write32(VGA_ADDR_CTRL,
+                VGA_CTRL_FRAME(0) | VGA_CTRL_VBLANK_IE | VGA_CTRL_ENABLE);
+    enable_interrupt();
+
+    // Animate: decode the next frame into the slot off screen, then sleep
+    // until the handler has swapped it in
+    for (int frame = 1;; frame = (frame + 1 < FRAME_COUNT) ? frame + 1 : 0) {
+        upload_frame(frame, (int) (front_slot ^ 1));
+        swap_pending = 1;
+        while (swap_pending)
+            __asm__ volatile("wfi");
     }
-#else
-    // Upload all frames (baseline RLE) while keeping frame 0 displayed
-    for (int frame = 0; frame < FRAME_COUNT; frame++)
-        vga_upload_frame_rle(frame);
-
-    // Animate: cycle through frames infinitely
-    for (uint32_t frame = 0;;) {
-        vga_write32(VGA_ADDR_CTRL, (frame << 4) | 0x01);
-        delay(50000);
-        frame = (frame + 1 < FRAME_COUNT) ? frame + 1 : 0;
-    }
-#endif
 }
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+// Picosynth microbenchmark: cycles per sample of each node type, a full
+// voice and N-voice mixes
+//
+// Each case builds a synth whose voices hold only the nodes under test,
+// starts a note on every voice, renders one warm-up block and then times
+// BENCH_SAMPLES samples of picosynth_process_block() with mcycle. Filter and
+// mixer inputs come from a constant outside the voice, so a node case costs
+// that node plus the per-voice and master overhead.
+//
+// Every case prints a BENCH line (bench.h; make bench collects them) and
+// its cycles per sample against the real-time budget of the 50 MHz core,
+// CPU_HZ / SAMPLE_RATE = 4535 cycles at 11025 Hz. A case is valid when the
+// rendered block is not silent.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "picosynth.h"
+
+#define CPU_HZ 50000000u
+#define BUDGET_CYCLES (CPU_HZ / SAMPLE_RATE)
+#define BENCH_SAMPLES 2048
+#define MAX_VOICES 8
+
+typedef void (*bench_patch_t)(picosynth_voice_t *v);
+
+typedef struct {
+    const char *name;
+    uint8_t voices;
+    uint8_t nodes;
+    bench_patch_t patch;
+} bench_case_t;
+
+static q15_t samples[BENCH_SAMPLES];
+static const q15_t bench_input = 12000; /* Filter and mixer input */
+static picosynth_wave_func_t bench_wave; /* Waveform of osc_patch() */
+
+static void osc_patch(picosynth_voice_t *v)
+{
+    picosynth_init_osc(picosynth_voice_get_node(v, 0), NULL,
+                       picosynth_voice_freq_ptr(v), bench_wave);
+    picosynth_voice_set_out(v, 0);
+}
+
+#define WAVE_PATCH(wave)                          \
+    static void wave_##wave(picosynth_voice_t *v) \
+    {                                             \
+        bench_wave = picosynth_wave_##wave;       \
+        osc_patch(v);                             \
+    }
+
+WAVE_PATCH(saw)
+WAVE_PATCH(square)
+WAVE_PATCH(triangle)
+WAVE_PATCH(falling)
+WAVE_PATCH(exp)
+WAVE_PATCH(noise)
+WAVE_PATCH(sine)
+WAVE_PATCH(table_sine)
+WAVE_PATCH(bl_saw)
+WAVE_PATCH(bl_square)
+
+static const picosynth_env_ms_params_t bench_env = {
+    .atk_ms = 10,
+    .dec_ms = 100,
+    .sus_pct = 80,
+    .rel_ms = 50,
+};
+
+static void env_patch(picosynth_voice_t *v)
+{
+    picosynth_init_env_ms(picosynth_voice_get_node(v, 0), NULL, &bench_env);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void lp_patch(picosynth_voice_t *v)
+{
+    picosynth_init_lp(picosynth_voice_get_node(v, 0), NULL, &bench_input, 5000);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void hp_patch(picosynth_voice_t *v)
+{
+    picosynth_init_hp(picosynth_voice_get_node(v, 0), NULL, &bench_input, 5000);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void svf_lp_patch(picosynth_voice_t *v)
+{
+    picosynth_init_svf_lp(picosynth_voice_get_node(v, 0), NULL, &bench_input,
+                          picosynth_svf_freq(1000), Q15_MAX / 2);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void svf_hp_patch(picosynth_voice_t *v)
+{
+    picosynth_init_svf_hp(picosynth_voice_get_node(v, 0), NULL, &bench_input,
+                          picosynth_svf_freq(1000), Q15_MAX / 2);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void svf_bp_patch(picosynth_voice_t *v)
+{
+    picosynth_init_svf_bp(picosynth_voice_get_node(v, 0), NULL, &bench_input,
+                          picosynth_svf_freq(1000), Q15_MAX / 2);
+    picosynth_voice_set_out(v, 0);
+}
+
+static void mix_patch(picosynth_voice_t *v)
+{
+    picosynth_init_mix(picosynth_voice_get_node(v, 0), NULL, &bench_input,
+                       &bench_input, &bench_input);
+    picosynth_voice_set_out(v, 0);
+}
+
+/* The patch of the picosynth.h example: envelope -> saw -> low-pass */
+static void voice_patch(picosynth_voice_t *v)
+{
+    picosynth_node_t *env = picosynth_voice_get_node(v, 0);
+    picosynth_node_t *osc = picosynth_voice_get_node(v, 1);
+    picosynth_node_t *flt = picosynth_voice_get_node(v, 2);
+
+    picosynth_init_env_ms(env, NULL, &bench_env);
+    picosynth_init_osc(osc, &env->out, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_saw);
+    picosynth_init_lp(flt, NULL, &osc->out, 5000);
+    picosynth_voice_set_out(v, 2);
+}
+
+static const bench_case_t cases[] = {
+    {"picosynth.saw", 1, 1, wave_saw},
+    {"picosynth.square", 1, 1, wave_square},
+    {"picosynth.triangle", 1, 1, wave_triangle},
+    {"picosynth.falling", 1, 1, wave_falling},
+    {"picosynth.exp", 1, 1, wave_exp},
+    {"picosynth.noise", 1, 1, wave_noise},
+    {"picosynth.sine", 1, 1, wave_sine},
+    {"picosynth.table_sine", 1, 1, wave_table_sine},
+    {"picosynth.bl_saw", 1, 1, wave_bl_saw},
+    {"picosynth.bl_square", 1, 1, wave_bl_square},
+    {"picosynth.env", 1, 1, env_patch},
+    {"picosynth.lp", 1, 1, lp_patch},
+    {"picosynth.hp", 1, 1, hp_patch},
+    {"picosynth.svf_lp", 1, 1, svf_lp_patch},
+    {"picosynth.svf_hp", 1, 1, svf_hp_patch},
+    {"picosynth.svf_bp", 1, 1, svf_bp_patch},
+    {"picosynth.mix", 1, 1, mix_patch},
+    {"picosynth.voice", 1, 3, voice_patch},
+    {"picosynth.voices2", 2, 3, voice_patch},
+    {"picosynth.voices4", 4, 3, voice_patch},
+    {"picosynth.voices8", MAX_VOICES, 3, voice_patch},
+};
+
+/* Cycles per sample with two decimals, and the share of the budget */
+static void print_cost(uint32_t cycles)
+{
+    uint32_t hundredths = (uint32_t) ((uint64_t) cycles * 100 / BENCH_SAMPLES);
+    uint32_t permille = (uint32_t) ((uint64_t) cycles * 1000 /
+                                    ((uint64_t) BENCH_SAMPLES * BUDGET_CYCLES));
+
+    bench_puts("  ");
+    bench_put_uint(hundredths / 100);
+    bench_putc('.');
+    if (hundredths % 100 < 10)
+        bench_putc('0');
+    bench_put_uint(hundredths % 100);
+    bench_puts(" cycles/sample, ");
+    bench_put_uint(permille / 10);
+    bench_putc('.');
+    bench_put_uint(permille % 10);
+    bench_puts("% of budget\n");
+}
+
+/* Returns 0 when the case ran and was not silent */
+static int run_case(const bench_case_t *c)
+{
+    picosynth_t *s = picosynth_create(c->voices, c->nodes);
+    bench_time_t start, end;
+    int audible = 0;
+
+    if (!s) {
+        bench_puts(c->name);
+        bench_puts(": picosynth_create failed\n");
+        return 1;
+    }
+    for (uint8_t i = 0; i < c->voices; i++) {
+        c->patch(picosynth_get_voice(s, i));
+        picosynth_note_on(s, i, (uint8_t) (48 + 7 * i));
+    }
+
+    picosynth_process_block(s, samples, PICOSYNTH_BLOCK_SIZE);
+    bench_begin(&start);
+    picosynth_process_block(s, samples, BENCH_SAMPLES);
+    bench_end(&end);
+    picosynth_destroy(s);
+
+    for (int i = 0; i < BENCH_SAMPLES && !audible; i++)
+        audible = samples[i] != 0;
+
+    int status = bench_report(c->name, BENCH_SAMPLES, &start, &end, audible);
+    print_cost(end.cycle - start.cycle);
+    return status;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    bench_puts("picosynth microbenchmark: ");
+    bench_put_uint(BENCH_SAMPLES);
+    bench_puts(" samples per case, budget ");
+    bench_put_uint(BUDGET_CYCLES);
+    bench_puts(" cycles/sample\n");
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        failed |= run_case(&cases[i]);
+    return failed;
+}
@@ -65,9 +65,9 @@ static inline int audio_fifo_full(void) {
 }
 
 // ============================================================================
-// Simple Voice Allocator for 4-voice polyphony
+// Simple Voice Allocator, one slot per hardware voice
 // ============================================================================
-#define MAX_VOICES 4
+#define MAX_VOICES HWSYNTH_VOICES
 
 typedef struct {
     uint8_t note;       // MIDI note (0 = free)
@@ -75,6 +75,7 @@ typedef struct {
 } voice_slot_t;
 
 static voice_slot_t voice_slots[MAX_VOICES];
+static int next_voice;  // Round-robin start, so released notes ring out
 
 // Find a free voice or steal the oldest one
 static int allocate_voice(uint8_t note) {
@@ -85,15 +86,19 @@ static int allocate_voice(uint8_t note) {
         }
     }
 
-    // Find a free voice
-    for (int i = 0; i < MAX_VOICES; i++) {
+    // Find a free voice, the least recently allocated first
+    for (int n = 0; n < MAX_VOICES; n++) {
+        int i = (next_voice + n) % MAX_VOICES;
         if (!voice_slots[i].active) {
+            next_voice = (i + 1) % MAX_VOICES;
             return i;
         }
     }
 
-    // All voices busy - steal voice 0 (simple strategy)
-    return 0;
+    // All voices busy - steal the next one in turn
+    int i = next_voice;
+    next_voice = (i + 1) % MAX_VOICES;
+    return i;
 }
 
 static int find_voice_by_note(uint8_t note) {
@@ -237,9 +242,11 @@ int main(void) {
         setup_voice(i, WAVE_SAW);
     }
 
-    // Enable all 4 voices
-    hwsynth_enable(0x0F);
-    print_str("All 4 voices enabled.\n\n");
+    // Enable every voice
+    hwsynth_enable((uint32_t)((1ull << MAX_VOICES) - 1));
+    print_str("All ");
+    print_dec(MAX_VOICES);
+    print_str(" voices enabled.\n\n");
 
     // Play melody
     print_str("Playing Twinkle Twinkle Little Star...\n");
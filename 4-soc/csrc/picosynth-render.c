@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: MIT
+// Picosynth offline renderer: the host build of picosynth.c renders a patch
+// to a 16-bit mono WAV file at SAMPLE_RATE, far faster than real time.
+//
+// picosynth.h replaces the custom-0 DSP and RV32M inline assembly with
+// bit-exact C off RISC-V, so the samples equal what the core computes:
+// without -m the piano plays melody.h exactly as example.c does, and the
+// WAV can be compared sample by sample with the audio stream of the RTL
+// simulation (make check-picosynth). With -m the patch plays the channel
+// events of a Standard MIDI File instead.
+//
+// Usage: picosynth-render [-p piano|lead] [-m file.mid] [-o out.wav]
+//                         [-t tail_ms]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "midifile.h"
+#include "piano.h"
+#include "picosynth.h"
+
+#define LEAD_VOICES 8
+#define MAX_EVENTS 65536
+
+typedef struct {
+    const char *name;
+    picosynth_t *(*create)(void);
+    void (*note_on)(picosynth_t *s, uint8_t note);
+    void (*note_off)(picosynth_t *s, uint8_t note);
+} patch_t;
+
+// Piano: monophonic, the latest note wins and only its own note-off ends it
+static uint8_t piano_note;
+
+static void piano_midi_on(picosynth_t *s, uint8_t note)
+{
+    piano_note = note;
+    piano_note_on(s, note);
+}
+
+static void piano_midi_off(picosynth_t *s, uint8_t note)
+{
+    if (note == piano_note)
+        piano_note_off(s);
+}
+
+// Lead: the patch of the picosynth.h example (envelope -> saw -> low-pass)
+// on LEAD_VOICES voices; a new note takes a free voice or the oldest one
+static uint8_t lead_notes[LEAD_VOICES];
+static uint32_t lead_started[LEAD_VOICES];
+static uint32_t lead_count;
+
+static picosynth_t *lead_create(void)
+{
+    picosynth_t *s = picosynth_create(LEAD_VOICES, 3);
+    if (!s)
+        return NULL;
+    for (uint8_t i = 0; i < LEAD_VOICES; i++) {
+        picosynth_voice_t *v = picosynth_get_voice(s, i);
+        picosynth_node_t *env = picosynth_voice_get_node(v, 0);
+        picosynth_node_t *osc = picosynth_voice_get_node(v, 1);
+        picosynth_node_t *flt = picosynth_voice_get_node(v, 2);
+
+        picosynth_init_env_ms(env, NULL,
+                              &(picosynth_env_ms_params_t){
+                                  .atk_ms = 10,
+                                  .dec_ms = 100,
+                                  .sus_pct = 80,
+                                  .rel_ms = 50,
+                              });
+        picosynth_init_osc(osc, &env->out, picosynth_voice_freq_ptr(v),
+                           picosynth_wave_saw);
+        picosynth_init_lp(flt, NULL, &osc->out, 5000);
+        picosynth_voice_set_out(v, 2);
+    }
+    return s;
+}
+
+static void lead_note_on(picosynth_t *s, uint8_t note)
+{
+    uint8_t voice = 0;
+    for (uint8_t i = 0; i < LEAD_VOICES; i++) {
+        if (!lead_notes[i]) {
+            voice = i;
+            break;
+        }
+        if (lead_started[i] < lead_started[voice])
+            voice = i;
+    }
+    lead_notes[voice] = note;
+    lead_started[voice] = ++lead_count;
+    picosynth_note_on(s, voice, note);
+}
+
+static void lead_note_off(picosynth_t *s, uint8_t note)
+{
+    for (uint8_t i = 0; i < LEAD_VOICES; i++) {
+        if (lead_notes[i] == note) {
+            lead_notes[i] = 0;
+            picosynth_note_off(s, i);
+        }
+    }
+}
+
+static const patch_t patches[] = {
+    {"piano", piano_create, piano_midi_on, piano_midi_off},
+    {"lead", lead_create, lead_note_on, lead_note_off},
+};
+
+static void put_le(FILE *f, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        fputc((value >> (8 * i)) & 0xFF, f);
+}
+
+// 16-bit mono PCM; the sizes are filled in by wav_close()
+static FILE *wav_open(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return NULL;
+    fwrite("RIFF", 1, 4, f);
+    put_le(f, 0, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put_le(f, 16, 4);
+    put_le(f, 1, 2); // PCM
+    put_le(f, 1, 2); // Mono
+    put_le(f, SAMPLE_RATE, 4);
+    put_le(f, SAMPLE_RATE * 2, 4);
+    put_le(f, 2, 2);
+    put_le(f, 16, 2);
+    fwrite("data", 1, 4, f);
+    put_le(f, 0, 4);
+    return f;
+}
+
+static void wav_write(FILE *f, const q15_t *samples, uint32_t n)
+{
+    uint8_t bytes[2 * PICOSYNTH_BLOCK_SIZE];
+    for (uint32_t done = 0; done < n;) {
+        uint32_t chunk = n - done < PICOSYNTH_BLOCK_SIZE ? n - done : PICOSYNTH_BLOCK_SIZE;
+        for (uint32_t i = 0; i < chunk; i++) {
+            bytes[2 * i] = (uint16_t) samples[done + i] & 0xFF;
+            bytes[2 * i + 1] = (uint16_t) samples[done + i] >> 8;
+        }
+        fwrite(bytes, 2, chunk, f);
+        done += chunk;
+    }
+}
+
+static int wav_close(FILE *f, uint32_t samples)
+{
+    fseek(f, 4, SEEK_SET);
+    put_le(f, 36 + samples * 2, 4);
+    fseek(f, 40, SEEK_SET);
+    put_le(f, samples * 2, 4);
+    return fclose(f);
+}
+
+// Renders n samples in blocks
+static uint32_t render(picosynth_t *s, FILE *wav, uint32_t n)
+{
+    q15_t block[PICOSYNTH_BLOCK_SIZE];
+    for (uint32_t left = n; left;) {
+        uint32_t chunk = left < PICOSYNTH_BLOCK_SIZE ? left : PICOSYNTH_BLOCK_SIZE;
+        picosynth_process_block(s, block, chunk);
+        wav_write(wav, block, chunk);
+        left -= chunk;
+    }
+    return n;
+}
+
+// melody.h on the piano, sample for sample as example.c
+static uint32_t render_melody(picosynth_t *s, FILE *wav)
+{
+    piano_melody_t m = {0};
+    q15_t block[PICOSYNTH_BLOCK_SIZE];
+    uint32_t samples = 0, n = 0;
+    for (;;) {
+        piano_melody_step(&m, s);
+        if (m.done)
+            break;
+        block[n++] = picosynth_process(s);
+        if (n == PICOSYNTH_BLOCK_SIZE) {
+            wav_write(wav, block, n);
+            samples += n;
+            n = 0;
+        }
+    }
+    wav_write(wav, block, n);
+    return samples + n;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = length > 0 ? malloc(length) : NULL;
+    if (data && fread(data, 1, length, f) != (size_t) length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = data ? (size_t) length : 0;
+    return data;
+}
+
+// Channel events of a MIDI file (all channels) on the patch
+static int render_midi(const patch_t *patch, picosynth_t *s, FILE *wav,
+                       const char *path, uint32_t *samples)
+{
+    size_t size;
+    uint8_t *data = read_file(path, &size);
+    if (!data) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return -1;
+    }
+
+    static midi_compiled_event_t events[MAX_EVENTS];
+    midi_file_t mf;
+    size_t count = 0;
+    midi_error_t err = midi_file_open(&mf, data, size);
+    if (err == MIDI_OK)
+        err = midi_file_compile(&mf, SAMPLE_RATE, events, MAX_EVENTS, &count);
+    if (err != MIDI_OK) {
+        fprintf(stderr, "%s: MIDI error %d\n", path, err);
+        free(data);
+        return -1;
+    }
+
+    *samples = 0;
+    for (size_t i = 0; i < count; i++) {
+        const midi_compiled_event_t *e = &events[i];
+        *samples += render(s, wav, e->sample - *samples);
+        uint8_t type = e->status & 0xF0;
+        if (type == MIDI_STATUS_NOTE_ON && e->data2)
+            patch->note_on(s, e->data1);
+        else if (type == MIDI_STATUS_NOTE_OFF || type == MIDI_STATUS_NOTE_ON)
+            patch->note_off(s, e->data1);
+    }
+    free(data);
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-p piano|lead] [-m file.mid] [-o out.wav] "
+            "[-t tail_ms]\n"
+            "  -p: patch (default piano)\n"
+            "  -m: MIDI file to play; without it the piano plays melody.h "
+            "as example.c\n"
+            "  -o: WAV output (default picosynth.wav)\n"
+            "  -t: silence rendered after the last event (default 1000)\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *patch_name = "piano", *midi = NULL, *out = "picosynth.wav";
+    uint32_t tail_ms = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            patch_name = argv[++i];
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            midi = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            out = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            tail_ms = strtoul(argv[++i], NULL, 0);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    const patch_t *patch = NULL;
+    for (size_t i = 0; i < sizeof(patches) / sizeof(patches[0]); i++)
+        if (!strcmp(patch_name, patches[i].name))
+            patch = &patches[i];
+    if (!patch || (!midi && patch->create != piano_create)) {
+        fprintf(stderr, "%s: unknown patch %s%s\n", argv[0], patch_name,
+                patch ? " without -m (melody.h is piano only)" : "");
+        return 2;
+    }
+
+    picosynth_t *s = patch->create();
+    FILE *wav = s ? wav_open(out) : NULL;
+    if (!wav) {
+        fprintf(stderr, "%s: cannot create %s\n", argv[0],
+                s ? out : "the synth");
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t samples = 0;
+    if (!midi)
+        samples = render_melody(s, wav);
+    else if (render_midi(patch, s, wav, midi, &samples) < 0)
+        return 1;
+    samples += render(s, wav, PICOSYNTH_MS(tail_ms));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    picosynth_destroy(s);
+    if (wav_close(wav, samples)) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], out);
+        return 1;
+    }
+
+    double host = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    double audio = (double) samples / SAMPLE_RATE;
+    fprintf(stderr, "%s: %u samples (%.2f s) in %.3f s, %.0fx real time\n",
+            out, samples, audio, host, host > 0 ? audio / host : 0.0);
+    return 0;
+}
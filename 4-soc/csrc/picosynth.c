@@ -5,6 +5,10 @@
 
 #include "dsp-math.h"
 #include "picosynth.h"
+#include "tcm.h"
+#if PICOSYNTH_WAVETABLE
+#include "wavetables.h"
+#endif
 
 /* Envelope state: bits 30-31 = mode, bits 0-29 = value
  * Mode 0 (0x00): Attack - ramp up to peak
@@ -22,15 +26,62 @@
  */
 #define DC_BLOCK_ALPHA 32604
 
+/* Node input during a render. Node outputs over a run of len samples are
+ * buffered per node in buf[0..len]: buf[0] is the output before the run,
+ * buf[t + 1] the output for sample t. A renderer reads p[t] for the output
+ * of sample t and p[t + 1] for the state update after it. Inputs fixed over
+ * the run (the voice frequency, nodes not rendered yet) have mask 0 and read
+ * p[0] throughout.
+ */
+typedef struct {
+    const q15_t *p; /* NULL = unused */
+    uint32_t mask;
+} block_in_t;
+
+#define BLOCK_IN(in, t) ((in).p[(uint32_t) (t) & (in).mask])
+
+/* Renders one node over a run of len samples, see node renderers below */
+typedef void (*render_fn_t)(const picosynth_voice_t *v,
+                            picosynth_node_t *n,
+                            q15_t *y,
+                            const block_in_t *in,
+                            int len);
+
+/* Plan step input sources besides node indices */
+#define PLAN_IN_NONE (-1) /* Unused input */
+#define PLAN_IN_FREQ (-2) /* The voice's own frequency */
+#define PLAN_IN_PTR (-3)  /* Fixed pointer outside the voice */
+
+typedef struct {
+    render_fn_t render;  /* Specialised for the node type */
+    const q15_t *ptr[4]; /* PLAN_IN_PTR inputs */
+    int8_t in[4];        /* Gain, then type-specific inputs (node_inputs()) */
+    uint8_t node;        /* Node index */
+} plan_step_t;
+
+/* Execution plan of a voice, built by picosynth_voice_finalize(): the nodes
+ * its output depends on with their inputs resolved, so rendering neither
+ * dispatches on node types nor maps pointers back to nodes.
+ */
+typedef struct {
+    plan_step_t *steps;
+    uint32_t nodes;    /* Bit N = node N is a step */
+    uint8_t n_steps;
+    uint8_t out;       /* Output node index */
+    uint8_t refs;      /* Voices running this plan */
+    bool feed_forward; /* No step reads a later step */
+} picosynth_plan_t;
+
 /* Opaque type definitions */
 struct picosynth_voice {
     uint8_t note;            /* Current MIDI note */
     uint8_t gate : 1;        /* 1=key held, 0=released */
     uint8_t out_idx;         /* Output node index */
-    uint8_t node_usage_mask; /* Bit N = node N affects output */
     q15_t freq;              /* Base frequency (phase increment) */
     picosynth_node_t *nodes;
     uint8_t n_nodes;
+    picosynth_t *synth;      /* Owner, whose plan slots this voice uses */
+    picosynth_plan_t *plan;  /* NULL until finalized */
 };
 
 struct picosynth {
@@ -39,6 +90,12 @@ struct picosynth {
     uint16_t voice_enable_mask; /* Bit N = voice N active */
     /* DC blocker state (placed after main mixer, before soft clipper) */
     int32_t dc_x_prev, dc_y_prev; /* Previous input, output */
+    /* Node outputs over a block, PICOSYNTH_BLOCK_SIZE + 1 samples per node
+     * (see block_in_t) */
+    q15_t *block_out;
+    /* Plan slots, one per voice; voices wired alike share one */
+    picosynth_plan_t *plans;
+    plan_step_t *plan_steps; /* n_nodes steps per slot */
 };
 
 /* LFSR seed for noise generator.
@@ -48,32 +105,6 @@ struct picosynth {
  */
 static uint32_t lfsr_seed = 0x12345678;
 
-/* Fast calloc to reduce allocator overhead in simulation.
- * Falls back to malloc and clears memory with 32-bit stores when possible.
- */
-void *memset(void *dest, int c, unsigned int n)
-{
-    unsigned char *d = dest;
-    while (n--)
-        *d++ = (unsigned char) c;
-    return dest;
-}
-static void *picosynth_calloc(size_t nmemb, size_t size)
-{
-    size_t n = u32_mul((uint32_t) nmemb, (uint32_t) size);
-    uint8_t *p = (uint8_t *)malloc(n);
-    if (!p)
-        return NULL;
-    size_t words = u32_div((uint32_t) n, 4);
-    size_t tail = u32_rem((uint32_t) n, 4);
-    uint32_t *w = (uint32_t *)p;
-    for (size_t i = 0; i < words; i++)
-        w[i] = 0;
-    for (size_t i = 0; i < tail; i++)
-        p[u32_mul((uint32_t) words, 4) + i] = 0;
-    return p;
-}
-
 static void voice_note_on(picosynth_voice_t *v, uint8_t note)
 {
     v->note = note;
@@ -121,119 +152,97 @@ static void voice_note_off(picosynth_voice_t *v)
 /* Map a pointer to a node's output field back to the node index.
  * Returns -1 if the pointer doesn't point to any node's output.
  */
-static int ptr_to_node_idx(picosynth_voice_t *v, const q15_t *ptr)
+static int ptr_to_node_idx(const picosynth_voice_t *v, const q15_t *ptr)
 {
     if (!ptr)
         return -1;
 
-    /* Check if ptr points to any node's out field */
-    for (int i = 0; i < v->n_nodes; i++) {
-        if (ptr == &v->nodes[i].out)
-            return i;
-    }
-    return -1; /* External pointer (e.g., voice freq) */
+    /* Check if ptr points to any node's out field: nodes are one array, so
+     * that is its offset from the first out field in whole nodes */
+    uintptr_t off = (uintptr_t) ptr - (uintptr_t) &v->nodes[0].out;
+    if (off % sizeof(picosynth_node_t) ||
+        off / sizeof(picosynth_node_t) >= v->n_nodes)
+        return -1; /* External pointer (e.g., voice freq) */
+    return (int) (off / sizeof(picosynth_node_t));
 }
 
-/* Recursively mark node and all its dependencies as used.
- * Note: mask is 8-bit, so only nodes 0-7 can be tracked. For voices with >8
- * nodes, the mask optimization is disabled (mask stays 0, all nodes processed).
+/* Synth state (voices, nodes, plans and block outputs) comes from an arena
+ * in the data TCM (tcm.h) while it lasts, then from the heap, so that the
+ * per-sample loop runs on single-cycle memory. The arena is reused once
+ * every synth has been destroyed.
  */
-static void mark_node_used(picosynth_voice_t *v, int idx)
-{
-    if (idx < 0 || idx >= v->n_nodes)
-        return;
-    /* Skip nodes >= 8 to avoid UB from oversized shift. If any node >= 8 is
-     * in the dependency chain, we can't use the optimization safely. */
-    if (idx >= 8) {
-        v->node_usage_mask = 0; /* Disable optimization */
-        return;
-    }
-
-    uint8_t bit = (uint8_t) (1u << idx);
-    if (v->node_usage_mask & bit)
-        return; /* Already marked, avoid infinite recursion */
+#ifndef PICOSYNTH_TCM_ARENA
+#define PICOSYNTH_TCM_ARENA 4096
+#endif
 
-    v->node_usage_mask |= bit;
-    picosynth_node_t *n = &v->nodes[idx];
+static uint8_t synth_arena[PICOSYNTH_TCM_ARENA] TCM_BSS
+    __attribute__((aligned(8)));
+static uint32_t synth_arena_used;
+static uint32_t synth_count; /* Synths not destroyed yet */
 
-    /* Trace gain input (common to all node types) */
-    int dep = ptr_to_node_idx(v, n->gain);
-    if (dep >= 0)
-        mark_node_used(v, dep);
-
-    /* Trace type-specific inputs */
-    switch (n->type) {
-    case PICOSYNTH_NODE_OSC:
-        /* freq typically points to voice->freq, not a node */
-        dep = ptr_to_node_idx(v, n->osc.freq);
-        if (dep >= 0)
-            mark_node_used(v, dep);
-        dep = ptr_to_node_idx(v, n->osc.detune);
-        if (dep >= 0)
-            mark_node_used(v, dep);
-        break;
-    case PICOSYNTH_NODE_LP:
-    case PICOSYNTH_NODE_HP:
-        dep = ptr_to_node_idx(v, n->flt.in);
-        if (dep >= 0)
-            mark_node_used(v, dep);
-        break;
-    case PICOSYNTH_NODE_SVF_LP:
-    case PICOSYNTH_NODE_SVF_HP:
-    case PICOSYNTH_NODE_SVF_BP:
-        dep = ptr_to_node_idx(v, n->svf.in);
-        if (dep >= 0)
-            mark_node_used(v, dep);
-        break;
-    case PICOSYNTH_NODE_MIX:
-        for (int j = 0; j < 3; j++) {
-            dep = ptr_to_node_idx(v, n->mix.in[j]);
-            if (dep >= 0)
-                mark_node_used(v, dep);
-        }
-        break;
-    default:
-        break;
+static void *synth_calloc(uint32_t count, uint32_t size)
+{
+    uint32_t bytes = (u32_mul(count, size) + 7) & ~7u;
+    if (bytes && bytes <= PICOSYNTH_TCM_ARENA - synth_arena_used) {
+        void *p = synth_arena + synth_arena_used;
+        synth_arena_used += bytes;
+        memset(p, 0, bytes);
+        return p;
     }
+    return calloc(count, size);
 }
 
-/* Update node usage mask by tracing dependencies from output node.
- * Call this after wiring nodes, before processing.
- */
-static void voice_update_usage_mask(picosynth_voice_t *v)
+static void synth_free(void *p)
 {
-    v->node_usage_mask = 0;
-    if (v->out_idx < v->n_nodes)
-        mark_node_used(v, v->out_idx);
+    if ((uint8_t *) p < synth_arena ||
+        (uint8_t *) p >= synth_arena + PICOSYNTH_TCM_ARENA)
+        free(p);
 }
 
 picosynth_t *picosynth_create(uint8_t voices, uint8_t nodes)
 {
     if (nodes > PICOSYNTH_MAX_NODES)
         return NULL;
+    if (!synth_count)
+        synth_arena_used = 0;
 
-    picosynth_t *s = picosynth_calloc(1, sizeof(picosynth_t));
+    picosynth_t *s = synth_calloc(1, sizeof(picosynth_t));
     if (!s)
         return NULL;
 
     s->num_voices = voices;
-    s->voices = picosynth_calloc(voices, sizeof(picosynth_voice_t));
-    if (!s->voices) {
-        free(s);
+    s->voices = synth_calloc(voices, sizeof(picosynth_voice_t));
+    s->block_out = synth_calloc((uint32_t) nodes * (PICOSYNTH_BLOCK_SIZE + 1),
+                                sizeof(q15_t));
+    s->plans = synth_calloc(voices, sizeof(picosynth_plan_t));
+    s->plan_steps = synth_calloc(u32_mul(voices, nodes), sizeof(plan_step_t));
+    if (!s->voices || (nodes && !s->block_out) || (voices && !s->plans) ||
+        (voices && nodes && !s->plan_steps)) {
+        synth_free(s->plan_steps);
+        synth_free(s->plans);
+        synth_free(s->block_out);
+        synth_free(s->voices);
+        synth_free(s);
         return NULL;
     }
 
     for (int i = 0; i < voices; i++) {
+        s->plans[i].steps = s->plan_steps + u32_mul(i, nodes);
+        s->voices[i].synth = s;
         s->voices[i].n_nodes = nodes;
-        s->voices[i].nodes = picosynth_calloc(nodes, sizeof(picosynth_node_t));
+        s->voices[i].nodes = synth_calloc(nodes, sizeof(picosynth_node_t));
         if (!s->voices[i].nodes) {
             for (int j = 0; j < i; j++)
-                free(s->voices[j].nodes);
-            free(s->voices);
-            free(s);
+                synth_free(s->voices[j].nodes);
+            synth_free(s->plan_steps);
+            synth_free(s->plans);
+            synth_free(s->block_out);
+            synth_free(s->voices);
+            synth_free(s);
             return NULL;
         }
     }
+    synth_count++;
     return s;
 }
 
@@ -243,9 +252,13 @@ void picosynth_destroy(picosynth_t *s)
         return;
 
     for (int i = 0; i < s->num_voices; i++)
-        free(s->voices[i].nodes);
-    free(s->voices);
-    free(s);
+        synth_free(s->voices[i].nodes);
+    synth_free(s->plan_steps);
+    synth_free(s->plans);
+    synth_free(s->block_out);
+    synth_free(s->voices);
+    synth_free(s);
+    synth_count--;
 }
 
 picosynth_voice_t *picosynth_get_voice(picosynth_t *s, uint8_t idx)
@@ -266,7 +279,7 @@ void picosynth_voice_set_out(picosynth_voice_t *v, uint8_t idx)
 {
     if (v && idx < v->n_nodes) {
         v->out_idx = idx;
-        voice_update_usage_mask(v);
+        picosynth_voice_finalize(v);
     }
 }
 
@@ -617,289 +630,691 @@ static q15_t soft_clip(int32_t x)
     return q15_sat(i32_mul(picosynth_sine_impl((q15_t) a), sign));
 }
 
-q15_t picosynth_process(picosynth_t *s)
+/* Disable a voice once it is fully silent (gate off, all envelopes at zero).
+ * Only applies to voices 0-15 tracked by 16-bit mask.
+ */
+static void voice_check_silent(picosynth_t *s, int vi)
 {
-    if (!s)
-        return 0;
+    picosynth_voice_t *v = &s->voices[vi];
+    if (vi >= 16 || v->gate)
+        return;
 
-    int32_t out = 0;
+    for (int i = 0; i < v->n_nodes; i++) {
+        if (v->nodes[i].type == PICOSYNTH_NODE_ENV &&
+            (v->nodes[i].state & ENVELOPE_STATE_VALUE_MASK) != 0)
+            return;
+    }
+    s->voice_enable_mask &= (uint16_t) ~(1u << vi);
+}
 
-    for (int vi = 0; vi < s->num_voices; vi++) {
-        /* Skip inactive voices via bitfield check (voices 0-15 only) */
-        if (vi < 16 && !(s->voice_enable_mask & (1u << vi)))
-            continue;
+/* Gain of the voice mix, 0 when a single voice is not scaled */
+static q15_t mix_gain(const picosynth_t *s)
+{
+    if (s->num_voices > 1)
+        return (q15_t) i32_div(Q15_MAX, (int32_t) s->num_voices);
+    return 0;
+}
 
-        picosynth_voice_t *v = &s->voices[vi];
-        picosynth_node_t *nodes = v->nodes;
-        int32_t tmp[PICOSYNTH_MAX_NODES];
-
-        /* Two-pass processing per voice:
-         * 1. Compute outputs from current state of all nodes.
-         *    This ensures inputs for a node (e.g. filter) are based on the
-         *    outputs of other nodes (e.g. oscillator) from the same sample.
-         * 2. Update the internal state of all nodes for the next sample.
-         *    This prevents race conditions where a node's state is updated
-         *    before its output has been consumed by other nodes.
-         */
+/* Master stage: mix gain, DC blocker and soft clipper */
+static q15_t master_process(picosynth_t *s, int32_t out, q15_t gain)
+{
+    if (gain)
+        out = qmul32x16(out, gain);
 
-        /* Pass 1: compute outputs from current state */
-        uint8_t mask = v->node_usage_mask;
-        for (int i = 0; i < v->n_nodes && nodes[i].type != PICOSYNTH_NODE_NONE;
-             i++) {
-            /* Skip nodes that don't affect output (if mask is set) */
-            if (mask && !(mask & (1u << i))) {
-                tmp[i] = 0;
-                continue;
-            }
-            picosynth_node_t *n = &nodes[i];
-            switch (n->type) {
-            case PICOSYNTH_NODE_OSC:
-                tmp[i] = n->osc.wave(n->state & Q15_MAX);
-                break;
-            case PICOSYNTH_NODE_ENV:
-                /* Envelope output is scaled down and squared for a non-linear
-                 * curve.
-                 */
-                tmp[i] = (n->state & ENVELOPE_STATE_VALUE_MASK) >> 4;
-                tmp[i] = i32_mul(tmp[i], tmp[i]) >> 15; /* Squared curve */
-                if (n->env.sustain < 0)
-                    tmp[i] = -tmp[i];
-                break;
-            case PICOSYNTH_NODE_LP:
-                tmp[i] =
-                    qmul32x16(n->flt.accum, n->flt.coeff);
-                break;
-            case PICOSYNTH_NODE_HP:
-                /* High-pass is the input signal minus the low-pass signal */
-                if (n->flt.in) {
-                    tmp[i] = qmul32x16(n->flt.accum, n->flt.coeff);
-                    tmp[i] = *n->flt.in - tmp[i];
-                } else {
-                    tmp[i] = 0;
-                }
-                break;
-            case PICOSYNTH_NODE_SVF_LP:
-                /* SVF low-pass output: scaled down from internal precision */
-                tmp[i] = n->svf.lp >> 8;
-                break;
-            case PICOSYNTH_NODE_SVF_HP: {
-                /* SVF high-pass: hp = in - lp - q*bp */
-                int32_t in_val = n->svf.in ? ((int32_t) *n->svf.in) << 8 : 0;
-                int32_t q_bp = qmul32x16(n->svf.bp, n->svf.q);
-                int32_t hp = i32_sub_sat(i32_sub_sat(in_val, n->svf.lp), q_bp);
-                tmp[i] = hp >> 8;
-                break;
-            }
-            case PICOSYNTH_NODE_SVF_BP:
-                /* SVF band-pass output */
-                tmp[i] = n->svf.bp >> 8;
-                break;
-            case PICOSYNTH_NODE_MIX: {
-                int32_t sum = 0;
-                for (int j = 0; j < 3; j++)
-                    if (n->mix.in[j])
-                        sum += *n->mix.in[j];
-                tmp[i] = sum;
-                break;
-            }
-            default:
-                tmp[i] = 0;
-                break;
-            }
+    /* DC blocker: y[n] = x[n] - x[n-1] + alpha * y[n-1]
+     * Removes DC offset introduced by waveshaping and asymmetric waveforms.
+     * Uses hardware saturation to prevent overflow. No rounding on feedback
+     * (truncation ensures full decay to zero, rounding leaves residual DC).
+     */
+    int32_t delta = i32_sub_sat(out, s->dc_x_prev);
+    int32_t fb = qmul32x16(s->dc_y_prev, DC_BLOCK_ALPHA);
+    int32_t dc_out = i32_add_sat(delta, fb);
 
-            if (n->gain)
-                tmp[i] = qmul32x16(tmp[i], *n->gain);
-        }
+    s->dc_x_prev = out;
+    s->dc_y_prev = dc_out;
 
-        /* Pass 2: update state for next sample */
-        for (int i = 0; i < v->n_nodes && nodes[i].type != PICOSYNTH_NODE_NONE;
-             i++) {
-            /* Skip nodes that don't affect output (if mask is set) */
-            if (mask && !(mask & (1u << i)))
-                continue;
-            picosynth_node_t *n = &nodes[i];
-            n->out = q15_sat(tmp[i]);
-
-            switch (n->type) {
-            case PICOSYNTH_NODE_OSC:
-                if (n->osc.freq)
-                    n->state += *n->osc.freq;
-                if (n->osc.detune)
-                    n->state += *n->osc.detune;
-                n->state =
-                    (int32_t) (((uint32_t) n->state) & (uint32_t) Q15_MAX);
-                break;
-            case PICOSYNTH_NODE_ENV: {
-                /* Block-based AHDSR envelope: compute rate at block
-                 * boundaries, check for phase transitions per-sample. */
-                uint32_t mode = ((uint32_t) n->state) & ENVELOPE_MODE_MASK;
-
-                /* Recompute rate at block boundary */
-                if (n->env.block_counter == 0) {
-                    n->env.block_counter = PICOSYNTH_BLOCK_SIZE;
-                    if (!v->gate) {
-                        n->env.block_rate = -n->env.release; /* Informational */
-                    } else if (mode == ENVELOPE_MODE_DECAY) {
-                        n->env.block_rate = -n->env.decay; /* Informational */
-                    } else if (mode == ENVELOPE_MODE_HOLD) {
-                        n->env.block_rate = 0; /* Hold at peak */
-                    } else {
-                        n->env.block_rate = n->env.attack;
-                    }
+    return soft_clip(dc_out);
+}
+
+
+/* Collect the inputs of a node: gain first, then the type-specific ones.
+ * Returns the number of inputs.
+ */
+static int node_inputs(const picosynth_node_t *n, const q15_t *in[4])
+{
+    int k = 0;
+    in[k++] = n->gain;
+    switch (n->type) {
+    case PICOSYNTH_NODE_OSC:
+        in[k++] = n->osc.freq;
+        in[k++] = n->osc.detune;
+        break;
+    case PICOSYNTH_NODE_LP:
+    case PICOSYNTH_NODE_HP:
+        in[k++] = n->flt.in;
+        break;
+    case PICOSYNTH_NODE_SVF_LP:
+    case PICOSYNTH_NODE_SVF_HP:
+    case PICOSYNTH_NODE_SVF_BP:
+        in[k++] = n->svf.in;
+        break;
+    case PICOSYNTH_NODE_MIX:
+        for (int j = 0; j < 3; j++)
+            in[k++] = n->mix.in[j];
+        break;
+    default:
+        break;
+    }
+    return k;
+}
+
+/* Node renderers. Each runs one node for len samples with its state in
+ * locals, y[t] receiving the output for sample t. Every sample has two
+ * steps: the output from the current state (reading inputs at t), then the
+ * state update for the next sample (reading inputs at t + 1, which for the
+ * node itself is y[t]).
+ */
+
+/* Apply the gain input at sample t and saturate */
+static inline q15_t block_gain(const block_in_t *g, int t, int32_t x)
+{
+    if (g->p)
+        x = qmul32x16(x, BLOCK_IN(*g, t));
+    return q15_sat(x);
+}
+
+static inline int32_t osc_advance(int32_t phase, const block_in_t *in, int t)
+{
+    if (in[1].p)
+        phase += BLOCK_IN(in[1], t + 1);
+    if (in[2].p)
+        phase += BLOCK_IN(in[2], t + 1);
+    return (int32_t) (((uint32_t) phase) & (uint32_t) Q15_MAX);
+}
+
+static void render_osc(const picosynth_voice_t *v,
+                       picosynth_node_t *n,
+                       q15_t *y,
+                       const block_in_t *in,
+                       int len)
+{
+    int32_t phase = n->state;
+    picosynth_wave_func_t wave = n->osc.wave;
+    for (int t = 0; t < len; t++) {
+        y[t] = block_gain(&in[0], t, wave(phase & Q15_MAX));
+        phase = osc_advance(phase, in, t);
+    }
+    n->state = phase;
+}
+
+#if PICOSYNTH_WAVETABLE
+/* Linearly interpolated read of a WAVETABLE_SIZE + 1 sample table */
+static inline q15_t wavetable_read(const q15_t *tab, q15_t phase)
+{
+    int idx = (phase >> 7) & (WAVETABLE_SIZE - 1);
+    int32_t r = tab[idx];
+    return (q15_t) (r + (((tab[idx + 1] - r) * (phase & 0x7F)) >> 7));
+}
+
+/* Mip level of a band-limited set for a phase increment: level l holds the
+ * harmonics that stay below Nyquist for increments below 2^(7 + l)
+ */
+static inline int wavetable_level(int32_t inc)
+{
+    if (inc < 0)
+        inc = -inc;
+    int l = 0;
+    while (l < WAVETABLE_LEVELS - 1 && (inc >> (7 + l)))
+        l++;
+    return l;
+}
+
+/* Wavetable oscillator. Band-limited sets take their mip level from the
+ * phase increment at the start of the run, so it holds for a block.
+ */
+static void render_osc_table(const picosynth_voice_t *v,
+                             picosynth_node_t *n,
+                             q15_t *y,
+                             const block_in_t *in,
+                             int len)
+{
+    const q15_t *tab = wavetable_sine;
+    if (n->osc.wave != picosynth_wave_table_sine) {
+        int32_t inc = (in[1].p ? BLOCK_IN(in[1], 1) : 0) +
+                      (in[2].p ? BLOCK_IN(in[2], 1) : 0);
+        int l = wavetable_level(inc);
+        tab = n->osc.wave == picosynth_wave_bl_saw ? wavetable_saw[l]
+                                                   : wavetable_square[l];
+    }
+
+    int32_t phase = n->state;
+    for (int t = 0; t < len; t++) {
+        y[t] = block_gain(&in[0], t, wavetable_read(tab, phase & Q15_MAX));
+        phase = osc_advance(phase, in, t);
+    }
+    n->state = phase;
+}
+#endif
+
+/* Sine is the common case: inlined instead of called through osc.wave */
+static void render_osc_sine(const picosynth_voice_t *v,
+                            picosynth_node_t *n,
+                            q15_t *y,
+                            const block_in_t *in,
+                            int len)
+{
+    int32_t phase = n->state;
+    for (int t = 0; t < len; t++) {
+        y[t] = block_gain(&in[0], t, picosynth_sine_impl(phase & Q15_MAX));
+        phase = osc_advance(phase, in, t);
+    }
+    n->state = phase;
+}
+
+static void render_env(const picosynth_voice_t *v,
+                       picosynth_node_t *n,
+                       q15_t *y,
+                       const block_in_t *in,
+                       int len)
+{
+    int32_t state = n->state;
+    int32_t block_rate = n->env.block_rate;
+    uint8_t block_counter = n->env.block_counter;
+    int32_t hold_counter = n->env.hold_counter;
+    const bool gate = v->gate;
+    const bool invert = n->env.sustain < 0;
+    const int32_t attack = n->env.attack, hold = n->env.hold;
+    const int32_t decay = n->env.decay, release = n->env.release;
+    const q15_t decay_coeff = n->env.decay_coeff;
+    const q15_t release_coeff = n->env.release_coeff;
+    q15_t sus_abs = invert ? -n->env.sustain : n->env.sustain;
+    const int32_t sus_level = sus_abs << 4;
+
+    for (int t = 0; t < len; t++) {
+        /* Envelope output is scaled down and squared for a non-linear
+         * curve.
+         */
+        int32_t x = (state & ENVELOPE_STATE_VALUE_MASK) >> 4;
+        x = i32_mul(x, x) >> 15; /* Squared curve */
+        if (invert)
+            x = -x;
+        y[t] = block_gain(&in[0], t, x);
+
+        /* Block-based AHDSR envelope: compute rate at block boundaries,
+         * check for phase transitions per-sample.
+         */
+        uint32_t mode = ((uint32_t) state) & ENVELOPE_MODE_MASK;
+        if (block_counter == 0) {
+            block_counter = PICOSYNTH_BLOCK_SIZE;
+            if (!gate)
+                block_rate = -release; /* Informational */
+            else if (mode == ENVELOPE_MODE_DECAY)
+                block_rate = -decay; /* Informational */
+            else if (mode == ENVELOPE_MODE_HOLD)
+                block_rate = 0; /* Hold at peak */
+            else
+                block_rate = attack;
+        }
+        block_counter--;
+
+        int32_t val = state & ENVELOPE_STATE_VALUE_MASK;
+        if (gate) {
+            if (mode == ENVELOPE_MODE_DECAY) {
+                /* Decay/Sustain phase: exponential decay toward sustain */
+                val = sus_level + qmul32x16(val - sus_level, decay_coeff);
+                if (val < sus_level)
+                    val = sus_level;
+            } else if (mode == ENVELOPE_MODE_HOLD) {
+                /* Hold phase: maintain peak, count down */
+                val = (int32_t) Q15_MAX << 4;
+                if (hold_counter > 0)
+                    hold_counter--;
+                if (hold_counter == 0) {
+                    mode = ENVELOPE_MODE_DECAY;
+                    block_counter = 0;
                 }
-                n->env.block_counter--;
-
-                /* Apply rate based on mode */
-                int32_t val = n->state & ENVELOPE_STATE_VALUE_MASK;
-                if (v->gate) {
-                    if (mode == ENVELOPE_MODE_DECAY) {
-                        /* Decay/Sustain phase */
-                        q15_t sus_abs = n->env.sustain < 0 ? -n->env.sustain
-                                                           : n->env.sustain;
-                        int32_t sus_level = sus_abs << 4;
-                        int32_t delta = val - sus_level;
-                        /* Exponential decay of delta toward sustain */
-                        val =
-                            sus_level +
-                            qmul32x16(delta, n->env.decay_coeff); // HW accelerated
-                        if (val < sus_level)
-                            val = sus_level;
-                    } else if (mode == ENVELOPE_MODE_HOLD) {
-                        /* Hold phase: maintain peak, count down */
-                        val = (int32_t) Q15_MAX << 4; /* Stay at peak */
-                        if (n->env.hold_counter > 0)
-                            n->env.hold_counter--;
-                        if (n->env.hold_counter == 0) {
-                            /* Transition to decay mode */
-                            mode = ENVELOPE_MODE_DECAY;
-                            n->env.block_counter = 0;
-                        }
+            } else {
+                /* Attack phase: ramp up to peak */
+                val += block_rate;
+                if (val >= (int32_t) Q15_MAX << 4) {
+                    val = (int32_t) Q15_MAX << 4;
+                    if (hold > 0) {
+                        mode = ENVELOPE_MODE_HOLD;
+                        hold_counter = hold;
                     } else {
-                        /* Attack phase: ramp up to peak */
-                        val += n->env.block_rate;
-                        if (val >= (int32_t) Q15_MAX << 4) {
-                            val = (int32_t) Q15_MAX << 4;
-                            /* Check if hold phase is configured */
-                            if (n->env.hold > 0) {
-                                mode = ENVELOPE_MODE_HOLD;
-                                n->env.hold_counter = n->env.hold;
-                            } else {
-                                mode = ENVELOPE_MODE_DECAY;
-                            }
-                            /* Force rate recalculation next sample */
-                            n->env.block_counter = 0;
-                        }
+                        mode = ENVELOPE_MODE_DECAY;
                     }
-                    n->state = (int32_t) (((uint32_t) val) | mode);
-                } else {
-                    /* Exponential release (mode cleared) */
-                    val = qmul32x16(val, n->env.release_coeff);
-                    if (val < 16)
-                        val = 0;
-                    n->state = val; /* mode bits clear during release */
+                    /* Force rate recalculation next sample */
+                    block_counter = 0;
                 }
-                break;
             }
-            case PICOSYNTH_NODE_LP:
-            case PICOSYNTH_NODE_HP: {
-                /* Smooth cutoff changes to avoid zipper noise.
-                 * Time constant: ~256 samples (~23ms @ 11kHz, ~6ms @ 44kHz).
-                 */
-                int32_t coeff_delta =
-                    (int32_t) n->flt.coeff_target - n->flt.coeff;
-                if (coeff_delta) {
-                    int32_t step = coeff_delta >> 8;
-                    if (step == 0)
-                        step = coeff_delta > 0 ? 1 : -1;
-                    n->flt.coeff = q15_sat((int32_t) n->flt.coeff + step);
-                }
+            state = (int32_t) (((uint32_t) val) | mode);
+        } else {
+            /* Exponential release (mode bits clear during release) */
+            val = qmul32x16(val, release_coeff);
+            if (val < 16)
+                val = 0;
+            state = val;
+        }
+    }
+    n->state = state;
+    n->env.block_rate = block_rate;
+    n->env.block_counter = block_counter;
+    n->env.hold_counter = hold_counter;
+}
 
-                /* Single-pole filter accumulator update:
-                 * accum += (input - output)
-                 * where output is the filtered signal from the previous sample.
-                 * This implements a simple recursive filter.
-                 */
-                int32_t input_val = n->flt.in ? *n->flt.in : 0;
-                int32_t delta = input_val - n->out;
-                n->flt.accum = i32_add_sat(n->flt.accum, delta);
-                break;
-            }
-            case PICOSYNTH_NODE_SVF_LP:
-            case PICOSYNTH_NODE_SVF_HP:
-            case PICOSYNTH_NODE_SVF_BP: {
-                /* Smooth frequency changes to avoid zipper noise */
-                int32_t f_delta = (int32_t) n->svf.f_target - n->svf.f;
-                if (f_delta) {
-                    int32_t step = f_delta >> 8;
-                    if (step == 0)
-                        step = f_delta > 0 ? 1 : -1;
-                    n->svf.f = q15_sat((int32_t) n->svf.f + step);
-                }
+/* Single-pole filter; high-pass is the input minus the low-pass signal */
+static inline void filter_render(picosynth_node_t *n,
+                                 q15_t *y,
+                                 const block_in_t *in,
+                                 int len,
+                                 bool hp)
+{
+    int32_t accum = n->flt.accum;
+    q15_t coeff = n->flt.coeff;
+    const q15_t coeff_target = n->flt.coeff_target;
+    for (int t = 0; t < len; t++) {
+        int32_t x = qmul32x16(accum, coeff);
+        if (hp)
+            x = in[1].p ? BLOCK_IN(in[1], t) - x : 0;
+        y[t] = block_gain(&in[0], t, x);
+
+        /* Smooth cutoff changes to avoid zipper noise.
+         * Time constant: ~256 samples (~23ms @ 11kHz, ~6ms @ 44kHz).
+         */
+        int32_t coeff_delta = (int32_t) coeff_target - coeff;
+        if (coeff_delta) {
+            int32_t step = coeff_delta >> 8;
+            if (step == 0)
+                step = coeff_delta > 0 ? 1 : -1;
+            coeff = q15_sat((int32_t) coeff + step);
+        }
+
+        /* accum += (input - output) */
+        int32_t input_val = in[1].p ? BLOCK_IN(in[1], t + 1) : 0;
+        accum = i32_add_sat(accum, input_val - y[t]);
+    }
+    n->flt.accum = accum;
+    n->flt.coeff = coeff;
+}
+
+static void render_lp(const picosynth_voice_t *v,
+                      picosynth_node_t *n,
+                      q15_t *y,
+                      const block_in_t *in,
+                      int len)
+{
+    filter_render(n, y, in, len, false);
+}
+
+static void render_hp(const picosynth_voice_t *v,
+                      picosynth_node_t *n,
+                      q15_t *y,
+                      const block_in_t *in,
+                      int len)
+{
+    filter_render(n, y, in, len, true);
+}
+
+/* State Variable Filter:
+ * hp = in - lp - q*bp
+ * lp_new = lp + f*bp
+ * bp_new = bp + f*hp
+ *
+ * States stored with <<8 scaling for precision.
+ */
+static inline void svf_render(picosynth_node_t *n,
+                              q15_t *y,
+                              const block_in_t *in,
+                              int len,
+                              picosynth_node_type_t type)
+{
+    int32_t lp = n->svf.lp, bp = n->svf.bp;
+    q15_t f = n->svf.f;
+    const q15_t f_target = n->svf.f_target, q = n->svf.q;
+    for (int t = 0; t < len; t++) {
+        int32_t x;
+        if (type == PICOSYNTH_NODE_SVF_LP) {
+            x = lp >> 8;
+        } else if (type == PICOSYNTH_NODE_SVF_BP) {
+            x = bp >> 8;
+        } else {
+            int32_t in_val = in[1].p ? ((int32_t) BLOCK_IN(in[1], t)) << 8 : 0;
+            int32_t q_bp = qmul32x16(bp, q);
+            x = i32_sub_sat(i32_sub_sat(in_val, lp), q_bp) >> 8;
+        }
+        y[t] = block_gain(&in[0], t, x);
+
+        /* Smooth frequency changes to avoid zipper noise */
+        int32_t f_delta = (int32_t) f_target - f;
+        if (f_delta) {
+            int32_t step = f_delta >> 8;
+            if (step == 0)
+                step = f_delta > 0 ? 1 : -1;
+            f = q15_sat((int32_t) f + step);
+        }
+
+        int32_t in_val = in[1].p ? ((int32_t) BLOCK_IN(in[1], t + 1)) << 8 : 0;
+        int32_t q_bp = qmul32x16(bp, q);
+        int32_t hp = i32_sub_sat(i32_sub_sat(in_val, lp), q_bp);
+        lp = i32_add_sat(lp, qmul32x16(bp, f));
+        bp = i32_add_sat(bp, qmul32x16(hp, f));
+    }
+    n->svf.lp = lp;
+    n->svf.bp = bp;
+    n->svf.f = f;
+}
+
+static void render_svf_lp(const picosynth_voice_t *v,
+                          picosynth_node_t *n,
+                          q15_t *y,
+                          const block_in_t *in,
+                          int len)
+{
+    svf_render(n, y, in, len, PICOSYNTH_NODE_SVF_LP);
+}
+
+static void render_svf_hp(const picosynth_voice_t *v,
+                          picosynth_node_t *n,
+                          q15_t *y,
+                          const block_in_t *in,
+                          int len)
+{
+    svf_render(n, y, in, len, PICOSYNTH_NODE_SVF_HP);
+}
+
+static void render_svf_bp(const picosynth_voice_t *v,
+                          picosynth_node_t *n,
+                          q15_t *y,
+                          const block_in_t *in,
+                          int len)
+{
+    svf_render(n, y, in, len, PICOSYNTH_NODE_SVF_BP);
+}
+
+static void render_mix(const picosynth_voice_t *v,
+                       picosynth_node_t *n,
+                       q15_t *y,
+                       const block_in_t *in,
+                       int len)
+{
+    for (int t = 0; t < len; t++) {
+        int32_t sum = 0;
+        for (int j = 1; j < 4; j++)
+            if (in[j].p)
+                sum += BLOCK_IN(in[j], t);
+        y[t] = block_gain(&in[0], t, sum);
+    }
+}
+
+/* Unknown node types output silence */
+static void render_silent(const picosynth_voice_t *v,
+                          picosynth_node_t *n,
+                          q15_t *y,
+                          const block_in_t *in,
+                          int len)
+{
+    for (int t = 0; t < len; t++)
+        y[t] = block_gain(&in[0], t, 0);
+}
 
-                /* State Variable Filter update:
-                 * hp = in - lp - q*bp
-                 * lp_new = lp + f*bp
-                 * bp_new = bp + f*hp
-                 *
-                 * States stored with <<8 scaling for precision.
-                 */
-                int32_t in_val = n->svf.in ? ((int32_t) *n->svf.in) << 8 : 0;
-                int32_t lp = n->svf.lp;
-                int32_t bp = n->svf.bp;
-
-
-                /* Compute high-pass: hp = in - lp - q*bp */
-                int32_t q_bp = qmul32x16(bp, n->svf.q);
-                int32_t hp = i32_sub_sat(i32_sub_sat(in_val, lp), q_bp);
-
-                /* Update low-pass: lp += f*bp */
-                int32_t f_bp = qmul32x16(bp, n->svf.f);
-                n->svf.lp = i32_add_sat(lp, f_bp);
-
-                /* Update band-pass: bp += f*hp */
-                int32_t f_hp = qmul32x16(hp, n->svf.f);
-                n->svf.bp = i32_add_sat(bp, f_hp);
-                break;
+static render_fn_t node_render_fn(const picosynth_node_t *n)
+{
+    switch (n->type) {
+    case PICOSYNTH_NODE_OSC:
+        if (n->osc.wave == picosynth_wave_sine)
+            return render_osc_sine;
+#if PICOSYNTH_WAVETABLE
+        if (n->osc.wave == picosynth_wave_table_sine ||
+            n->osc.wave == picosynth_wave_bl_saw ||
+            n->osc.wave == picosynth_wave_bl_square)
+            return render_osc_table;
+#endif
+        return render_osc;
+    case PICOSYNTH_NODE_ENV:
+        return render_env;
+    case PICOSYNTH_NODE_LP:
+        return render_lp;
+    case PICOSYNTH_NODE_HP:
+        return render_hp;
+    case PICOSYNTH_NODE_SVF_LP:
+        return render_svf_lp;
+    case PICOSYNTH_NODE_SVF_HP:
+        return render_svf_hp;
+    case PICOSYNTH_NODE_SVF_BP:
+        return render_svf_bp;
+    case PICOSYNTH_NODE_MIX:
+        return render_mix;
+    default:
+        return render_silent;
+    }
+}
+
+/* Build the plan of a voice into p.
+ *
+ * Steps keep node order rather than a topological one: it is what defines
+ * the result. A node reads an earlier node's output for the same sample and
+ * a later node's output for the previous sample, so reordering would move
+ * the one-sample delay of a backward-wired patch. Nodes from the first
+ * PICOSYNTH_NODE_NONE on are not run.
+ */
+static void plan_build(const picosynth_voice_t *v, picosynth_plan_t *p)
+{
+    const picosynth_node_t *nodes = v->nodes;
+    const q15_t *ptrs[4];
+
+    int n_active = 0;
+    while (n_active < v->n_nodes && nodes[n_active].type != PICOSYNTH_NODE_NONE)
+        n_active++;
+
+    /* Nodes the output depends on, traced from the output node */
+    uint32_t used = 0;
+    uint8_t stack[PICOSYNTH_MAX_NODES];
+    int sp = 0;
+    if (v->out_idx < v->n_nodes) {
+        used = 1u << v->out_idx;
+        stack[sp++] = v->out_idx;
+    }
+    while (sp) {
+        int i = stack[--sp];
+        for (int k = node_inputs(&nodes[i], ptrs); k-- > 0;) {
+            int j = ptr_to_node_idx(v, ptrs[k]);
+            if (j >= 0 && !(used & (1u << j))) {
+                used |= 1u << j;
+                stack[sp++] = (uint8_t) j;
             }
-            default:
-                break;
+        }
+    }
+    if (n_active < 32)
+        used &= (1u << n_active) - 1;
+
+    memset(p->steps, 0, v->n_nodes * sizeof(plan_step_t));
+    p->nodes = used;
+    p->n_steps = 0;
+    p->out = v->out_idx;
+    p->feed_forward = true;
+    for (int i = 0; i < n_active; i++) {
+        if (!(used & (1u << i)))
+            continue;
+        plan_step_t *st = &p->steps[p->n_steps++];
+        st->node = (uint8_t) i;
+        st->render = node_render_fn(&nodes[i]);
+        int n_in = node_inputs(&nodes[i], ptrs);
+        for (int k = 0; k < 4; k++) {
+            int j = k < n_in ? ptr_to_node_idx(v, ptrs[k]) : -1;
+            if (k >= n_in || !ptrs[k]) {
+                st->in[k] = PLAN_IN_NONE;
+            } else if (j >= 0) {
+                st->in[k] = (int8_t) j;
+                if (j > i && (used & (1u << j)))
+                    p->feed_forward = false;
+            } else if (ptrs[k] == &v->freq) {
+                st->in[k] = PLAN_IN_FREQ;
+            } else {
+                st->in[k] = PLAN_IN_PTR;
+                st->ptr[k] = ptrs[k];
             }
         }
+    }
+}
 
-        out += v->nodes[v->out_idx].out;
+static bool plans_equal(const picosynth_plan_t *a, const picosynth_plan_t *b)
+{
+    return a->nodes == b->nodes && a->n_steps == b->n_steps &&
+           a->out == b->out && a->feed_forward == b->feed_forward &&
+           !memcmp(a->steps, b->steps, a->n_steps * sizeof(plan_step_t));
+}
 
-        /* Disable voice when fully silent (gate off, all envelopes at zero).
-         * Only applies to voices 0-15 tracked by 16-bit mask. */
-        if (vi < 16 && !v->gate) {
-            bool silent = true;
-            for (int i = 0; i < v->n_nodes && silent; i++) {
-                if (nodes[i].type == PICOSYNTH_NODE_ENV &&
-                    (nodes[i].state & ENVELOPE_STATE_VALUE_MASK) != 0)
-                    silent = false;
-            }
-            if (silent)
-                s->voice_enable_mask &= (uint16_t) ~(1u << vi);
+void picosynth_voice_finalize(picosynth_voice_t *v)
+{
+    if (!v)
+        return;
+
+    picosynth_t *s = v->synth;
+    if (v->plan)
+        v->plan->refs--;
+    v->plan = NULL;
+
+    /* One slot per voice and this voice holds none: a free one exists */
+    picosynth_plan_t *p = s->plans;
+    while (p->refs)
+        p++;
+    plan_build(v, p);
+
+    /* Share an identical plan of another voice */
+    for (int i = 0; i < s->num_voices; i++) {
+        picosynth_plan_t *q = &s->plans[i];
+        if (q != p && q->refs && plans_equal(p, q)) {
+            p = q;
+            break;
         }
     }
+    p->refs++;
+    v->plan = p;
+}
 
-    if (s->num_voices > 1) {
-        q15_t gain = (q15_t) i32_div(Q15_MAX, (int32_t) s->num_voices);
-        out = qmul32x16(out, gain);
+/* Output buffer of node i: PICOSYNTH_BLOCK_SIZE + 1 samples, see block_in_t */
+static inline q15_t *node_buf(picosynth_t *s, int i)
+{
+    return s->block_out + i * (PICOSYNTH_BLOCK_SIZE + 1);
+}
+
+/* Resolve the inputs of a plan step against the voice. An earlier step (or
+ * the node itself) reads from its buffer; a later node has not run yet and
+ * reads as its current output.
+ */
+static void step_inputs(picosynth_t *s,
+                        picosynth_voice_t *v,
+                        const picosynth_plan_t *p,
+                        const plan_step_t *st,
+                        block_in_t *in)
+{
+    for (int k = 0; k < 4; k++) {
+        int src = st->in[k];
+        in[k].mask = 0;
+        if (src >= 0 && src <= st->node && (p->nodes & (1u << src))) {
+            in[k].p = node_buf(s, src);
+            in[k].mask = ~0u;
+        } else if (src >= 0) {
+            in[k].p = &v->nodes[src].out;
+        } else if (src == PLAN_IN_FREQ) {
+            in[k].p = &v->freq;
+        } else if (src == PLAN_IN_PTR) {
+            in[k].p = st->ptr[k];
+        } else {
+            in[k].p = NULL;
+        }
     }
+}
 
-    /* DC blocker: y[n] = x[n] - x[n-1] + alpha * y[n-1]
-     * Removes DC offset introduced by waveshaping and asymmetric waveforms.
-     * Uses hardware saturation to prevent overflow. No rounding on feedback
-     * (truncation ensures full decay to zero, rounding leaves residual DC).
-     */
-    int32_t delta = i32_sub_sat(out, s->dc_x_prev);
-    int32_t fb = qmul32x16(s->dc_y_prev, DC_BLOCK_ALPHA);
-    int32_t dc_out = i32_add_sat(delta, fb);
+/* Render len samples of a voice and add them to mix[]. A feed-forward plan
+ * runs step by step over all of them; a later node feeding an earlier one
+ * needs its output one sample behind, so such a plan runs a sample at a
+ * time.
+ */
+static void voice_render(picosynth_t *s,
+                         picosynth_voice_t *v,
+                         int32_t *mix,
+                         int len)
+{
+    if (!v->plan)
+        picosynth_voice_finalize(v);
+    const picosynth_plan_t *p = v->plan;
+    if (p->out >= v->n_nodes)
+        return;
 
-    s->dc_x_prev = out;
-    s->dc_y_prev = dc_out;
+    int run = p->feed_forward ? len : 1;
+    block_in_t in[4];
+    for (int t0 = 0; t0 < len; t0 += run) {
+        for (int k = 0; k < p->n_steps; k++) {
+            const plan_step_t *st = &p->steps[k];
+            picosynth_node_t *n = &v->nodes[st->node];
+            q15_t *buf = node_buf(s, st->node);
+            step_inputs(s, v, p, st, in);
+            buf[0] = n->out;
+            st->render(v, n, buf + 1, in, run);
+            n->out = buf[run];
+        }
 
-    return soft_clip(dc_out);
+        block_in_t out = {&v->nodes[p->out].out, 0};
+        if (p->nodes & (1u << p->out)) {
+            out.p = node_buf(s, p->out);
+            out.mask = ~0u;
+        }
+        for (int t = 0; t < run; t++)
+            mix[t0 + t] += BLOCK_IN(out, t + 1);
+    }
+}
+
+q15_t picosynth_process(picosynth_t *s)
+{
+    if (!s)
+        return 0;
+
+    int32_t out = 0;
+
+    for (int vi = 0; vi < s->num_voices; vi++) {
+        /* Skip inactive voices via bitfield check (voices 0-15 only) */
+        if (vi < 16 && !(s->voice_enable_mask & (1u << vi)))
+            continue;
+
+        voice_render(s, &s->voices[vi], &out, 1);
+        voice_check_silent(s, vi);
+    }
+
+    return master_process(s, out, mix_gain(s));
+}
+
+void picosynth_process_block(picosynth_t *s, q15_t *out, uint32_t n)
+{
+    if (!out)
+        return;
+    if (!s) {
+        memset(out, 0, n * sizeof(q15_t));
+        return;
+    }
+
+    q15_t gain = mix_gain(s);
+    while (n) {
+        int len = n < PICOSYNTH_BLOCK_SIZE ? (int) n : PICOSYNTH_BLOCK_SIZE;
+        int32_t mix[PICOSYNTH_BLOCK_SIZE];
+        for (int t = 0; t < len; t++)
+            mix[t] = 0;
+
+        for (int vi = 0; vi < s->num_voices; vi++) {
+            if (vi < 16 && !(s->voice_enable_mask & (1u << vi)))
+                continue;
+
+            voice_render(s, &s->voices[vi], mix, len);
+            /* Once per block: a voice that falls silent plays to its end */
+            voice_check_silent(s, vi);
+        }
+
+        for (int t = 0; t < len; t++)
+            out[t] = master_process(s, mix[t], gain);
+        out += len;
+        n -= (uint32_t) len;
+    }
 }
 
 q15_t picosynth_wave_saw(q15_t phase)
@@ -945,4 +1360,36 @@ q15_t picosynth_wave_noise(q15_t phase)
 q15_t picosynth_wave_sine(q15_t phase)
 {
     return picosynth_sine_impl(phase);
-}
\ No newline at end of file
+}
+
+#if PICOSYNTH_WAVETABLE
+q15_t picosynth_wave_table_sine(q15_t phase)
+{
+    return wavetable_read(wavetable_sine, phase);
+}
+
+q15_t picosynth_wave_bl_saw(q15_t phase)
+{
+    return wavetable_read(wavetable_saw[0], phase);
+}
+
+q15_t picosynth_wave_bl_square(q15_t phase)
+{
+    return wavetable_read(wavetable_square[0], phase);
+}
+#else
+q15_t picosynth_wave_table_sine(q15_t phase)
+{
+    return picosynth_sine_impl(phase);
+}
+
+q15_t picosynth_wave_bl_saw(q15_t phase)
+{
+    return picosynth_wave_saw(phase);
+}
+
+q15_t picosynth_wave_bl_square(q15_t phase)
+{
+    return picosynth_wave_square(phase);
+}
+#endif
\ No newline at end of file
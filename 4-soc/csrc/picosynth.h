@@ -22,6 +22,8 @@
  *
  *   picosynth_note_on(s, 0, 60);
  *   q15_t sample = picosynth_process(s);
+ *   q15_t buf[PICOSYNTH_BLOCK_SIZE];
+ *   picosynth_process_block(s, buf, PICOSYNTH_BLOCK_SIZE);
  *   picosynth_destroy(s);
  */
 
@@ -35,8 +37,9 @@
 #define SAMPLE_RATE 11025
 #endif
 
-/* Block size for envelope processing optimization.
- * Rate computed once per block, transitions checked per-sample.
+/* Block size for envelope processing optimization and
+ * picosynth_process_block(). Envelope rate computed once per block,
+ * transitions checked per-sample.
  * Maximum 255 (uint8_t counter). Typical values: 16, 32, 64.
  */
 #ifndef PICOSYNTH_BLOCK_SIZE
@@ -60,6 +63,14 @@
 #error "PICOSYNTH_MAX_NODES must be <= 255 (uint8_t n_nodes)"
 #endif
 
+/* Wavetable oscillators (picosynth_wave_table_sine(), picosynth_wave_bl_*).
+ * 1 = precomputed tables from wavetables.h (~9 KB .rodata),
+ * 0 = fall back to the computed waveforms.
+ */
+#ifndef PICOSYNTH_WAVETABLE
+#define PICOSYNTH_WAVETABLE 1
+#endif
+
 /**
  * Q15 fixed-point: signed 16-bit, 15 fractional bits.
  * Range: [-1.0, +1.0) as [-32768, +32767].
@@ -97,8 +108,29 @@ static inline q15_t q15_sat(int32_t x)
  *   5    | QMUL16R     | Q15 16x16 multiply with rounding
  *   6    | SSHL16      | 16-bit saturating shift left
  *   7    | QMUL32x16   | Q15 32x16 multiply: (a * b[15:0]) >> 15
+ *
+ * Packed 2x16 variants (funct7 = 0x01), two Q15 lanes per register:
+ *
+ * funct3 | Instruction | Description
+ * -------|-------------|------------------------------------------
+ *   0    | PQMUL16     | QMUL16 on both lanes
+ *   1    | PSADD16     | SADD16 on both lanes
+ *   2    | PSSUB16     | SSUB16 on both lanes
+ *   3    | PDOT16      | (a.lo * b.lo + a.hi * b.hi) >> 15, 32-bit
+ *
+ * Host builds (picosynth-render, no __riscv) get bit-exact C versions of
+ * these and of the RV32M helpers below instead of the inline assembly, so
+ * they render the same samples as the core.
  *============================================================================*/
 
+#ifdef __riscv
+#define PICOSYNTH_HOST 0
+#else
+#define PICOSYNTH_HOST 1
+#endif
+
+#if !PICOSYNTH_HOST
+
 /* Q15 16x16 multiply: (a * b) >> 15
  * Input: two Q15 values [-1.0, +1.0)
  * Output: Q15 product
@@ -189,14 +221,161 @@ static inline int32_t qmul32x16(int32_t a, q15_t b)
                  : "r"(a), "r"(b));
     return (int32_t) result;
 }
+#else
+/* Products are formed in 32 or 64 bits and shifted arithmetically, as the
+ * ALU does; the low bits are kept without saturation where it keeps them.
+ */
+static inline q15_t q15_mul(q15_t a, q15_t b)
+{
+    return (q15_t) (((int32_t) a * b) >> 15);
+}
+
+static inline q15_t q15_add_sat(q15_t a, q15_t b)
+{
+    return q15_sat((int32_t) a + b);
+}
+
+static inline q15_t q15_sub_sat(q15_t a, q15_t b)
+{
+    return q15_sat((int32_t) a - b);
+}
+
+static inline int32_t i32_add_sat(int32_t a, int32_t b)
+{
+    int64_t sum = (int64_t) a + b;
+    return sum > INT32_MAX ? INT32_MAX : sum < INT32_MIN ? INT32_MIN : sum;
+}
+
+static inline int32_t i32_sub_sat(int32_t a, int32_t b)
+{
+    int64_t diff = (int64_t) a - b;
+    return diff > INT32_MAX ? INT32_MAX : diff < INT32_MIN ? INT32_MIN : diff;
+}
+
+/* Rounds half away from zero (0x3FFF below zero), as QMUL16R */
+static inline q15_t q15_mul_r(q15_t a, q15_t b)
+{
+    int32_t p = (int32_t) a * b;
+    return (q15_t) ((p + (p >= 0 ? 0x4000 : 0x3FFF)) >> 15);
+}
+
+static inline q15_t q15_shl_sat(q15_t a, uint8_t shamt)
+{
+    int64_t v = (int64_t) a * ((int64_t) 1 << (shamt & 31));
+    return v > Q15_MAX ? Q15_MAX : v < -32768 ? (q15_t) Q15_MIN : (q15_t) v;
+}
+
+static inline int32_t qmul32x16(int32_t a, q15_t b)
+{
+    return (int32_t) (((int64_t) a * b) >> 15);
+}
+#endif /* !PICOSYNTH_HOST */
+
+/* Two Q15 values in one register: lane 0 in bits [15:0], lane 1 in [31:16] */
+typedef uint32_t q15x2_t;
+
+static inline q15x2_t q15x2_pack(q15_t lo, q15_t hi)
+{
+    return (uint16_t) lo | ((uint32_t) (uint16_t) hi << 16);
+}
+
+static inline q15_t q15x2_lo(q15x2_t x)
+{
+    return (q15_t) (x & 0xFFFF);
+}
+
+static inline q15_t q15x2_hi(q15x2_t x)
+{
+    return (q15_t) (x >> 16);
+}
+
+#if !PICOSYNTH_HOST
+/* Dual Q15 multiply: q15_mul() on each lane */
+static inline q15x2_t q15x2_mul(q15x2_t a, q15x2_t b)
+{
+    uint32_t result;
+    asm volatile(".insn r 0x0B, 0x0, 0x01, %0, %1, %2"
+                 : "=r"(result)
+                 : "r"(a), "r"(b));
+    return result;
+}
+
+/* Dual 16-bit saturating add: q15_add_sat() on each lane */
+static inline q15x2_t q15x2_add_sat(q15x2_t a, q15x2_t b)
+{
+    uint32_t result;
+    asm volatile(".insn r 0x0B, 0x1, 0x01, %0, %1, %2"
+                 : "=r"(result)
+                 : "r"(a), "r"(b));
+    return result;
+}
+
+/* Dual 16-bit saturating subtract: q15_sub_sat() on each lane */
+static inline q15x2_t q15x2_sub_sat(q15x2_t a, q15x2_t b)
+{
+    uint32_t result;
+    asm volatile(".insn r 0x0B, 0x2, 0x01, %0, %1, %2"
+                 : "=r"(result)
+                 : "r"(a), "r"(b));
+    return result;
+}
+
+/* Q15 dot product of the two lanes: (a.lo * b.lo + a.hi * b.hi) >> 15
+ * Result is in [-65536, 65536], so it can be added to a 32-bit accumulator
+ * (plain add, or i32_add_sat()) without overflow per step.
+ * Mixing two voices by their gains is one PDOT16 and one add instead of two
+ * multiplies and two adds.
+ */
+static inline int32_t q15x2_dot(q15x2_t a, q15x2_t b)
+{
+    uint32_t result;
+    asm volatile(".insn r 0x0B, 0x3, 0x01, %0, %1, %2"
+                 : "=r"(result)
+                 : "r"(a), "r"(b));
+    return (int32_t) result;
+}
+#else
+static inline q15x2_t q15x2_mul(q15x2_t a, q15x2_t b)
+{
+    return q15x2_pack(q15_mul(q15x2_lo(a), q15x2_lo(b)),
+                      q15_mul(q15x2_hi(a), q15x2_hi(b)));
+}
+
+static inline q15x2_t q15x2_add_sat(q15x2_t a, q15x2_t b)
+{
+    return q15x2_pack(q15_add_sat(q15x2_lo(a), q15x2_lo(b)),
+                      q15_add_sat(q15x2_hi(a), q15x2_hi(b)));
+}
+
+static inline q15x2_t q15x2_sub_sat(q15x2_t a, q15x2_t b)
+{
+    return q15x2_pack(q15_sub_sat(q15x2_lo(a), q15x2_lo(b)),
+                      q15_sub_sat(q15x2_hi(a), q15x2_hi(b)));
+}
+
+static inline int32_t q15x2_dot(q15x2_t a, q15x2_t b)
+{
+    int64_t sum = (int32_t) q15x2_lo(a) * q15x2_lo(b) +
+                  (int64_t) ((int32_t) q15x2_hi(a) * q15x2_hi(b));
+    return (int32_t) (sum >> 15);
+}
+#endif /* !PICOSYNTH_HOST */
+
+/* Multiply-accumulate: acc + q15x2_dot(a, b), saturating */
+static inline int32_t q15x2_mac(int32_t acc, q15x2_t a, q15x2_t b)
+{
+    return i32_add_sat(acc, q15x2_dot(a, b));
+}
 
 /*============================================================================
  * RV32M Integer Multiply/Divide Hardware Acceleration
  *
  * Standard RISC-V M extension instructions for integer arithmetic.
  * These use the hardware multiplier/divider instead of software emulation.
+ * The host versions follow the same rules for division by zero and overflow.
  *============================================================================*/
 
+#if !PICOSYNTH_HOST
 /* 32-bit signed multiplication (lower 32 bits of 64-bit result)
  * Uses RV32M MUL instruction
  */
@@ -291,6 +470,60 @@ static inline uint32_t u32_rem(uint32_t a, uint32_t b)
     asm volatile("remu %0, %1, %2" : "=r"(result) : "r"(a), "r"(b));
     return result;
 }
+#else
+static inline int32_t i32_mul(int32_t a, int32_t b)
+{
+    return (int32_t) ((uint32_t) a * (uint32_t) b);
+}
+
+static inline uint32_t u32_mul(uint32_t a, uint32_t b)
+{
+    return a * b;
+}
+
+static inline int32_t i32_mulh(int32_t a, int32_t b)
+{
+    return (int32_t) (((int64_t) a * b) >> 32);
+}
+
+static inline uint32_t u32_mulhu(uint32_t a, uint32_t b)
+{
+    return (uint32_t) (((uint64_t) a * b) >> 32);
+}
+
+static inline int32_t i32_mulhsu(int32_t a, uint32_t b)
+{
+    return (int32_t) (((int64_t) a * (int64_t) b) >> 32);
+}
+
+static inline int32_t i32_div(int32_t a, int32_t b)
+{
+    if (b == 0)
+        return -1;
+    if (a == INT32_MIN && b == -1)
+        return INT32_MIN;
+    return a / b;
+}
+
+static inline uint32_t u32_div(uint32_t a, uint32_t b)
+{
+    return b ? a / b : 0xFFFFFFFF;
+}
+
+static inline int32_t i32_rem(int32_t a, int32_t b)
+{
+    if (b == 0)
+        return a;
+    if (a == INT32_MIN && b == -1)
+        return 0;
+    return a % b;
+}
+
+static inline uint32_t u32_rem(uint32_t a, uint32_t b)
+{
+    return b ? a % b : a;
+}
+#endif /* !PICOSYNTH_HOST */
 
 /* 64-bit unsigned division using 32-bit hardware divider
  * Computes (a_hi:a_lo) / b where b is 32-bit
@@ -311,8 +544,8 @@ static inline uint64_t u64_div_u32(uint64_t a, uint32_t b)
      */
     uint32_t q_hi, r_hi, q_lo;
 
-    asm volatile("divu %0, %1, %2" : "=r"(q_hi) : "r"(a_hi), "r"(b));
-    asm volatile("remu %0, %1, %2" : "=r"(r_hi) : "r"(a_hi), "r"(b));
+    q_hi = u32_div(a_hi, b);
+    r_hi = u32_rem(a_hi, b);
 
     /* Binary long division for (r_hi:a_lo) / b */
     uint64_t remainder = ((uint64_t) r_hi << 32) | a_lo;
@@ -469,9 +702,17 @@ picosynth_voice_t *picosynth_get_voice(picosynth_t *s, uint8_t idx);
 /* Get node by index within voice (NULL if out of bounds) */
 picosynth_node_t *picosynth_voice_get_node(picosynth_voice_t *v, uint8_t idx);
 
-/* Set which node provides voice output (also recomputes usage mask) */
+/* Set which node provides voice output (also finalizes the voice) */
 void picosynth_voice_set_out(picosynth_voice_t *v, uint8_t idx);
 
+/* Compile the voice's wiring into its execution plan: the nodes the output
+ * depends on, in node order, with a renderer per node type and inputs
+ * resolved up front. Voices wired alike share one plan.
+ * picosynth_voice_set_out() does this; call it again after changing a
+ * node's inputs, type or waveform.
+ */
+void picosynth_voice_finalize(picosynth_voice_t *v);
+
 /* Get pointer to voice's frequency (for wiring to oscillator) */
 const q15_t *picosynth_voice_freq_ptr(picosynth_voice_t *v);
 
@@ -488,7 +729,10 @@ q15_t picosynth_midi_to_freq(uint8_t note);
 q15_t picosynth_debug_octave8_freq(uint8_t idx);
 const q15_t *picosynth_debug_octave8_ptr(void);
 
-/* Initialize oscillator node. Set n->osc.detune after init if needed. */
+/* Initialize oscillator node. Set n->osc.detune after init if needed.
+ * @wave selects the backend: a computed waveform, or a wavetable one
+ *       (picosynth_wave_table_sine, picosynth_wave_bl_saw/square).
+ */
 void picosynth_init_osc(picosynth_node_t *n,
                         const q15_t *gain,
                         const q15_t *freq,
@@ -578,6 +822,16 @@ void picosynth_init_mix(picosynth_node_t *n,
 /* Process one sample (mix all voices, apply soft clipping) */
 q15_t picosynth_process(picosynth_t *s);
 
+/* Process n samples into out, the same as n calls of picosynth_process().
+ * Renders node by node in blocks of PICOSYNTH_BLOCK_SIZE samples, keeping
+ * each node's state in registers across the block. Voices wired with
+ * feedback (a node taking input from a later node) fall back to per-sample
+ * processing. A released voice that falls silent is disabled at
+ * the end of its block rather than at that sample, and noise oscillators in
+ * several voices draw from the shared LFSR in a different order.
+ */
+void picosynth_process_block(picosynth_t *s, q15_t *out, uint32_t n);
+
 /* Waveform generators. Input: phase [0, Q15_MAX]. Output: sample [-Q15_MAX,
  * Q15_MAX].
  */
@@ -589,6 +843,15 @@ q15_t picosynth_wave_exp(q15_t phase);      /* Exponential decay [0, Q15_MAX] */
 q15_t picosynth_wave_noise(q15_t phase);    /* White noise (phase ignored) */
 q15_t picosynth_wave_sine(q15_t phase);     /* Sine (LUT-based or sinf) */
 
+/* Wavetable waveforms: one interpolated table lookup per sample. In an
+ * oscillator node the band-limited ones switch to a table per octave of
+ * frequency, holding only harmonics below Nyquist, so high notes do not
+ * alias; called directly they read the full-band table.
+ */
+q15_t picosynth_wave_table_sine(q15_t phase); /* Sine, 16-bit table */
+q15_t picosynth_wave_bl_saw(q15_t phase);     /* Band-limited rising saw */
+q15_t picosynth_wave_bl_square(q15_t phase);  /* Band-limited square */
+
 /* Convert milliseconds to sample count */
 #define PICOSYNTH_MS(ms) ((uint32_t) ((long) (ms) * SAMPLE_RATE / 1000))
 
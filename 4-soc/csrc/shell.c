@@ -2,56 +2,17 @@
 // MyCPU is freely redistributable under the MIT License. See the file
 // "LICENSE" for information on usage and redistribution of this file.
 
+#include "mini_libc.h"
 #include "mmio.h"
-
-/* Bare-metal runtime support - compiler may optimize loops to these */
-void *memcpy(void *dest, const void *src, unsigned int n)
-{
-    char *d = dest;
-    const char *s = src;
-    while (n--)
-        *d++ = *s++;
-    return dest;
-}
-
-void *memmove(void *dest, const void *src, unsigned int n)
-{
-    char *d = dest;
-    const char *s = src;
-
-    if (d < s) {
-        while (n--)
-            *d++ = *s++;
-    } else {
-        d += n;
-        s += n;
-        while (n--)
-            *--d = *--s;
-    }
-    return dest;
-}
-
-void *memset(void *dest, int c, unsigned int n)
-{
-    unsigned char *d = dest;
-    while (n--)
-        *d++ = (unsigned char) c;
-    return dest;
-}
-
-unsigned int strlen(const char *s)
-{
-    unsigned int len = 0;
-    while (*s++)
-        len++;
-    return len;
-}
+#include "picosynth.h"
+#include "uart-ring.h"
 
 /* MyCPU Shell - Interactive shell with line editing
  *
  * Features:
  *   - RISC-V processor information commands (info, csr, perf)
  *   - Memory inspection utilities (mem, memw)
+ *   - Interrupt-driven buffered console I/O (uart-ring.c)
  *   - linenoise-style line editing with cursor movement
  *   - Command history with up/down arrow navigation
  *
@@ -73,6 +34,7 @@ unsigned int strlen(const char *s)
  *   mem    - Read memory: mem <address>
  *   memw   - Write memory: memw <address> <value>
  *   perf   - Show performance counters (mcycle, minstret, CPI)
+ *   bench  - Run a built-in kernel: bench [name|all] [iterations]
  *   clear  - Clear screen
  *   reboot - Software reset
  */
@@ -81,37 +43,30 @@ unsigned int strlen(const char *s)
 #define LINE_BUF_SIZE 80
 #define MAX_ARGS 8
 
-/* Check if TX is ready (buffer can accept data) */
-static inline int uart_tx_ready(void)
-{
-    return (*UART_STATUS & 0x01) != 0;
-}
-
-/* Send character with TX ready polling (required to avoid dropped chars) */
+/* Console I/O goes through the interrupt-driven rings (uart-ring.c): output
+ * returns once queued and line input sleeps in wfi until a key arrives
+ */
 static inline void uart_putc(unsigned char c)
 {
-    while (!uart_tx_ready())
-        ; /* Wait for TX buffer ready */
-    *UART_SEND = (unsigned int) c;
+    uart_ring_putc((char) c);
 }
 
 static void uart_puts(const char *s)
 {
-    while (*s)
-        uart_putc((unsigned char) *s++);
+    uart_ring_puts(s);
 }
 
-
-static inline int uart_rx_ready(void)
+static unsigned char uart_getc(void)
 {
-    return (*UART_STATUS & 0x02) != 0;
+    return uart_ring_getc();
 }
 
-static unsigned char uart_getc(void)
+/* Machine external interrupt: only the UART is enabled here */
+void trap_handler(unsigned int mepc, unsigned int mcause)
 {
-    while (!uart_rx_ready())
-        ;
-    return (unsigned char) (*UART_RECV & 0xFF);
+    (void) mepc;
+    if (mcause == 0x8000000Bu)
+        uart_ring_isr();
 }
 
 /* String comparison (returns 1 if equal) */
@@ -225,6 +180,16 @@ static inline unsigned int read_minstret(void)
     return val;
 }
 
+/* Parse decimal string to integer (stops at the first non-digit) */
+static unsigned int parse_dec(const char *s)
+{
+    unsigned int val = 0;
+
+    while (*s >= '0' && *s <= '9')
+        val = val * 10 + (unsigned int) (*s++ - '0');
+    return val;
+}
+
 /* Parse hexadecimal string to integer */
 static unsigned int parse_hex(const char *s)
 {
@@ -337,6 +302,7 @@ static void cmd_help(void)
     uart_puts("  mem <addr>   Read memory (e.g., mem 0x20000000)\r\n");
     uart_puts("  memw <a> <v> Write memory (e.g., memw 0x20000020 0x01)\r\n");
     uart_puts("  perf         Show performance counters\r\n");
+    uart_puts("  bench [k] [n] Run kernel k (or all) n times\r\n");
     uart_puts("  clear        Clear screen\r\n");
     uart_puts("  reboot       Software reset\r\n");
     uart_puts("\r\n");
@@ -365,6 +331,10 @@ static void cmd_info(void)
         uart_putc('D');
     if (misa & (1 << ('C' - 'A')))
         uart_putc('C');
+    if (misa & (1 << ('B' - 'A')))
+        uart_putc('B');
+    if (misa & (1 << ('X' - 'A')))
+        uart_putc('X');
     uart_puts("\r\n");
 
     /* Vendor info */
@@ -482,6 +452,19 @@ static unsigned int umod(unsigned int num, unsigned int den)
     return num;
 }
 
+/* Print cycles / instret as CPI with two decimals */
+static void print_cpi(unsigned int cycles, unsigned int instret)
+{
+    unsigned int cpi_int = udiv(cycles, instret);
+    unsigned int cpi_frac = udiv(umod(cycles, instret) * 100, instret);
+
+    print_uint(cpi_int);
+    uart_puts(".");
+    if (cpi_frac < 10)
+        uart_putc('0');
+    print_uint(cpi_frac);
+}
+
 /* Command: perf - Show performance counters */
 static void cmd_perf(void)
 {
@@ -497,23 +480,320 @@ static void cmd_perf(void)
     uart_puts("\r\n");
 
     if (instret > 0) {
-        unsigned int cpi_int = udiv(cycles, instret);
-        unsigned int cpi_frac = umod(udiv(cycles * 100, instret), 100);
-
         uart_puts("  CPI:      ");
-        print_uint(cpi_int);
-        uart_puts(".");
-        if (cpi_frac < 10)
-            uart_putc('0');
-        print_uint(cpi_frac);
+        print_cpi(cycles, instret);
         uart_puts("\r\n");
     }
 }
 
+/* Benchmark kernels
+ *
+ * Each kernel runs a fixed unit of work per iteration and returns a checksum
+ * so the compiler cannot drop the work. setup (optional) prepares data and
+ * teardown (optional) releases it, both outside the measured window.
+ */
+#define BENCH_COPY_WORDS 1024  /* memcpy: 4 KB per iteration */
+#define BENCH_CHASE_WORDS 4096 /* Pointer ring: 16 KB, 16x the D-cache */
+#define BENCH_MAC_TAPS 64      /* Q15 MAC: taps per iteration */
+#define BENCH_HPM_COUNT 6      /* mhpmcounter3-8 */
+
+typedef struct {
+    const char *name;
+    const char *desc;           /* What one iteration does */
+    unsigned int default_iters; /* Used when bench gets no count */
+    void (*setup)(void);
+    unsigned int (*run)(unsigned int iters);
+    void (*teardown)(void);
+} bench_kernel_t;
+
+typedef struct {
+    unsigned int cycle;
+    unsigned int instret;
+    unsigned int hpm[BENCH_HPM_COUNT];
+} bench_counters_t;
+
+static unsigned int bench_src[BENCH_COPY_WORDS];
+static unsigned int bench_dst[BENCH_COPY_WORDS];
+static unsigned int bench_chase[BENCH_CHASE_WORDS];
+static q15_t bench_mac_x[BENCH_MAC_TAPS];
+static q15_t bench_mac_h[BENCH_MAC_TAPS];
+static picosynth_t *bench_synth;
+static volatile unsigned int bench_sink;
+
+static const char *const bench_hpm_names[BENCH_HPM_COUNT] = {
+    "mispredict", "hazard", "mem stall", "ctrl stall", "btb miss", "branches",
+};
+
+static inline unsigned int bench_lcg(unsigned int x)
+{
+    return x * 1103515245u + 12345u;
+}
+
+static void bench_read_counters(bench_counters_t *c)
+{
+    __asm__ volatile("csrr %0, mcycle" : "=r"(c->cycle));
+    __asm__ volatile("csrr %0, minstret" : "=r"(c->instret));
+    __asm__ volatile("csrr %0, mhpmcounter3" : "=r"(c->hpm[0]));
+    __asm__ volatile("csrr %0, mhpmcounter4" : "=r"(c->hpm[1]));
+    __asm__ volatile("csrr %0, mhpmcounter5" : "=r"(c->hpm[2]));
+    __asm__ volatile("csrr %0, mhpmcounter6" : "=r"(c->hpm[3]));
+    __asm__ volatile("csrr %0, mhpmcounter7" : "=r"(c->hpm[4]));
+    __asm__ volatile("csrr %0, mhpmcounter8" : "=r"(c->hpm[5]));
+}
+
+static void bench_memcpy_setup(void)
+{
+    for (int i = 0; i < BENCH_COPY_WORDS; i++)
+        bench_src[i] = bench_lcg(i);
+}
+
+static unsigned int bench_memcpy_run(unsigned int iters)
+{
+    unsigned int sum = 0;
+
+    for (unsigned int i = 0; i < iters; i++) {
+        memcpy(bench_dst, bench_src, sizeof(bench_dst));
+        sum += bench_dst[i & (BENCH_COPY_WORDS - 1)];
+    }
+    return sum;
+}
+
+/* One random cycle through the ring (Sattolo's shuffle), so every load
+ * depends on the previous one and the prefetch-friendly order is gone
+ */
+static void bench_chase_setup(void)
+{
+    unsigned int x = 1;
+
+    for (int i = 0; i < BENCH_CHASE_WORDS; i++)
+        bench_chase[i] = i;
+    for (int i = BENCH_CHASE_WORDS - 1; i > 0; i--) {
+        x = bench_lcg(x);
+        int j = (x >> 8) % i;
+        unsigned int t = bench_chase[i];
+        bench_chase[i] = bench_chase[j];
+        bench_chase[j] = t;
+    }
+}
+
+static unsigned int bench_chase_run(unsigned int iters)
+{
+    unsigned int idx = 0;
+
+    for (unsigned int i = 0; i < iters; i++)
+        idx = bench_chase[idx];
+    return idx;
+}
+
+/* Two data-dependent branches per iteration on pseudo-random bits */
+static unsigned int bench_branch_run(unsigned int iters)
+{
+    unsigned int x = 1, a = 0, b = 0;
+
+    for (unsigned int i = 0; i < iters; i++) {
+        x = bench_lcg(x);
+        if (x & 0x10000)
+            a++;
+        else
+            b += x;
+        if (x & 0x200000)
+            b ^= a;
+    }
+    return a + b;
+}
+
+static unsigned int bench_div_run(unsigned int iters)
+{
+    unsigned int n = 0xdeadbeef, sum = 0;
+
+    for (unsigned int i = 0; i < iters; i++) {
+        unsigned int d = (i & 0xffff) | 1;
+        sum += n / d + n % d;
+        n ^= sum;
+    }
+    return sum;
+}
+
+static void bench_mac_setup(void)
+{
+    unsigned int x = 7;
+
+    for (int i = 0; i < BENCH_MAC_TAPS; i++) {
+        x = bench_lcg(x);
+        bench_mac_x[i] = (q15_t) (x >> 16);
+        bench_mac_h[i] = (q15_t) (x >> 1);
+    }
+}
+
+static unsigned int bench_mac_run(unsigned int iters)
+{
+    int32_t out = 0;
+
+    for (unsigned int i = 0; i < iters; i++) {
+        int32_t acc = 0;
+        for (int k = 0; k < BENCH_MAC_TAPS; k++)
+            acc += (int32_t) bench_mac_x[k] * bench_mac_h[k] >> 15;
+        bench_mac_x[i & (BENCH_MAC_TAPS - 1)] = (q15_t) acc;
+        out += acc;
+    }
+    return (unsigned int) out;
+}
+
+/* One voice: envelope -> saw oscillator -> one-pole low-pass */
+static void bench_synth_setup(void)
+{
+    bench_synth = picosynth_create(1, 3);
+    if (!bench_synth)
+        return;
+
+    picosynth_voice_t *v = picosynth_get_voice(bench_synth, 0);
+    picosynth_node_t *env = picosynth_voice_get_node(v, 0);
+    picosynth_node_t *osc = picosynth_voice_get_node(v, 1);
+    picosynth_node_t *flt = picosynth_voice_get_node(v, 2);
+
+    picosynth_init_env_ms(env, NULL,
+                          &(picosynth_env_ms_params_t){
+                              .atk_ms = 10,
+                              .dec_ms = 100,
+                              .sus_pct = 80,
+                              .rel_ms = 50,
+                          });
+    picosynth_init_osc(osc, &env->out, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_saw);
+    picosynth_init_lp(flt, NULL, &osc->out, 5000);
+    picosynth_voice_set_out(v, 2);
+    picosynth_note_on(bench_synth, 0, 60);
+}
+
+static unsigned int bench_synth_run(unsigned int iters)
+{
+    q15_t buf[PICOSYNTH_BLOCK_SIZE];
+    unsigned int sum = 0;
+
+    if (!bench_synth)
+        return 0;
+    while (iters > 0) {
+        unsigned int n =
+            iters < PICOSYNTH_BLOCK_SIZE ? iters : PICOSYNTH_BLOCK_SIZE;
+        picosynth_process_block(bench_synth, buf, n);
+        sum += (unsigned int) buf[n - 1];
+        iters -= n;
+    }
+    return sum;
+}
+
+static void bench_synth_teardown(void)
+{
+    picosynth_destroy(bench_synth);
+    bench_synth = NULL;
+}
+
+static const bench_kernel_t bench_kernels[] = {
+    {"memcpy", "4 KB memcpy", 64, bench_memcpy_setup, bench_memcpy_run,
+     NULL},
+    {"chase", "dependent load, 16 KB ring", 20000, bench_chase_setup,
+     bench_chase_run, NULL},
+    {"branch", "two random branches", 20000, NULL, bench_branch_run, NULL},
+    {"div", "32-bit divide and remainder", 5000, NULL, bench_div_run, NULL},
+    {"mac", "64-tap Q15 dot product", 500, bench_mac_setup, bench_mac_run,
+     NULL},
+    {"synth", "one picosynth voice sample", 4096, bench_synth_setup,
+     bench_synth_run, bench_synth_teardown},
+};
+
+#define BENCH_KERNEL_COUNT \
+    ((int) (sizeof(bench_kernels) / sizeof(bench_kernels[0])))
+
+static void bench_print_row(const char *label, unsigned int val)
+{
+    uart_puts("  ");
+    uart_puts(label);
+    for (int pad = 12 - (int) strlen(label); pad > 0; pad--)
+        uart_putc(' ');
+    print_uint(val);
+    uart_puts("\r\n");
+}
+
+static void bench_run_kernel(const bench_kernel_t *k, unsigned int iters)
+{
+    bench_counters_t start, end;
+
+    if (iters == 0)
+        iters = k->default_iters;
+    if (k->setup)
+        k->setup();
+
+    /* Let queued output drain so its interrupts stay out of the window */
+    uart_ring_flush();
+    bench_read_counters(&start);
+    unsigned int result = k->run(iters);
+    bench_read_counters(&end);
+
+    bench_sink = result;
+    if (k->teardown)
+        k->teardown();
+
+    unsigned int cycles = end.cycle - start.cycle;
+    unsigned int instret = end.instret - start.instret;
+
+    uart_puts(k->name);
+    uart_puts(": ");
+    print_uint(iters);
+    uart_puts(" x ");
+    uart_puts(k->desc);
+    uart_puts("\r\n");
+    bench_print_row("cycles", cycles);
+    bench_print_row("instret", instret);
+    if (instret > 0) {
+        uart_puts("  CPI         ");
+        print_cpi(cycles, instret);
+        uart_puts("\r\n");
+    }
+    for (int i = 0; i < BENCH_HPM_COUNT; i++)
+        bench_print_row(bench_hpm_names[i], end.hpm[i] - start.hpm[i]);
+}
+
+/* Command: bench - Run built-in benchmark kernels */
+static void cmd_bench(int argc, char *argv[])
+{
+    if (argc < 2) {
+        uart_puts("Usage: bench <kernel|all> [iterations]\r\n");
+        uart_puts("Kernels:\r\n");
+        for (int i = 0; i < BENCH_KERNEL_COUNT; i++) {
+            uart_puts("  ");
+            uart_puts(bench_kernels[i].name);
+            uart_puts(" - ");
+            uart_puts(bench_kernels[i].desc);
+            uart_puts(" (default ");
+            print_uint(bench_kernels[i].default_iters);
+            uart_puts(")\r\n");
+        }
+        return;
+    }
+
+    unsigned int iters = argc > 2 ? parse_dec(argv[2]) : 0;
+    int all = str_eq(argv[1], "all");
+    int found = 0;
+
+    for (int i = 0; i < BENCH_KERNEL_COUNT; i++) {
+        if (all || str_eq(argv[1], bench_kernels[i].name)) {
+            bench_run_kernel(&bench_kernels[i], iters);
+            found = 1;
+        }
+    }
+    if (!found) {
+        uart_puts("Unknown kernel: ");
+        uart_puts(argv[1]);
+        uart_puts("\r\nType 'bench' for the list.\r\n");
+    }
+}
+
 /* Command: reboot - Software reset */
 static void cmd_reboot(void)
 {
     uart_puts("Rebooting...\r\n");
+    uart_ring_flush();
+    uart_ring_stop();
 
     /* Jump to reset vector */
     __asm__ volatile("jr zero");
@@ -540,6 +820,8 @@ static void process_command(char *line)
         cmd_memw(argc, argv);
     } else if (str_eq(argv[0], "perf")) {
         cmd_perf();
+    } else if (str_eq(argv[0], "bench")) {
+        cmd_bench(argc, argv);
     } else if (str_eq(argv[0], "clear") || str_eq(argv[0], "cls")) {
         term_clear_screen();
     } else if (str_eq(argv[0], "reboot") || str_eq(argv[0], "reset")) {
@@ -557,8 +839,9 @@ int main(void)
     for (int i = 0; i < LINE_BUF_SIZE / 4 + 1; i++)
         line_buf_words[i] = 0;
 
-    /* Initialize UART */
+    /* Initialize UART and its interrupt-driven rings */
     *UART_ENABLE = 1;
+    uart_ring_init();
 
     uart_puts("\r\nMyCPU Shell - Type 'help' for commands\r\n");
 
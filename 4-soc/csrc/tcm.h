@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+#ifndef TCM_H
+#define TCM_H
+
+/**
+ * Data TCM placement
+ *
+ * A core built with DataTCMBytes=16384 keeps 16 KiB of on-chip RAM at
+ * 0x00300000 (Parameters.DataTCMBase) that loads and stores reach in one
+ * cycle, without the bus or the data cache; without it (the default) the
+ * range is main memory. link.lds puts these sections at its base:
+ *
+ *   TCM_DATA   - initialized data, copied in by init.S
+ *   TCM_RODATA - constant tables, copied in by init.S
+ *   TCM_BSS    - zeroed data, cleared by init.S
+ *
+ *   static q15_t history[64] TCM_BSS;
+ *
+ * The stack stays in main memory. TCM_STACK, once at file scope in the
+ * program, moves it to the rest of the TCM:
+ *
+ *   TCM_STACK;
+ *
+ * The link then fails below 4 KiB of stack, and a deeper stack overwrites
+ * TCM_BSS objects before the trap-entry check in init.S can notice.
+ *
+ * Only the CPU sees the TCM: DMA reads and writes the main memory below it,
+ * so keep DMA buffers out (and off the stack with TCM_STACK). Off RISC-V (the
+ * host build of picosynth) the macros are empty.
+ */
+#ifdef __riscv
+#define TCM_DATA __attribute__((section(".tcm.data")))
+#define TCM_RODATA __attribute__((section(".tcm.rodata")))
+#define TCM_BSS __attribute__((section(".tcm.bss")))
+#define TCM_STACK __asm__(".globl __tcm_stack\n.set __tcm_stack, 1")
+#else
+#define TCM_DATA
+#define TCM_RODATA
+#define TCM_BSS
+#define TCM_STACK
+#endif
+
+#endif /* TCM_H */
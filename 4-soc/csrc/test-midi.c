@@ -142,6 +142,26 @@ static const uint8_t midi_running_status[] = {
     /* End of track */
     0x00, 0xFF, 0x2F, 0x00};
 
+/* Format 1: tempo map plus two interleaved note tracks */
+static const uint8_t midi_format1[] = {
+    /* MThd header */
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, /* format 1 */
+    0, 3,                                 /* 3 tracks */
+    0x01, 0xE0,                           /* 480 ticks per quarter */
+    /* Track 0: 120 BPM, 240 BPM from tick 480 */
+    'M', 'T', 'r', 'k', 0, 0, 0, 19,
+    0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,
+    0x83, 0x60, 0xFF, 0x51, 0x03, 0x03, 0xD0, 0x90,
+    0x00, 0xFF, 0x2F, 0x00,
+    /* Track 1: C4 from tick 0 to 480 */
+    'M', 'T', 'r', 'k', 0, 0, 0, 13,
+    0x00, 0x90, 60, 100, 0x83, 0x60, 0x80, 60, 0,
+    0x00, 0xFF, 0x2F, 0x00,
+    /* Track 2: G4 from tick 240 to 720, on channel 1 */
+    'M', 'T', 'r', 'k', 0, 0, 0, 14,
+    0x81, 0x70, 0x91, 67, 100, 0x83, 0x60, 0x81, 67, 0,
+    0x00, 0xFF, 0x2F, 0x00};
+
 static void test_midi_open_valid(void)
 {
     midi_file_t mf;
@@ -406,6 +426,98 @@ static void test_midi_helper_functions(void)
     TEST_ASSERT(midi_is_note_off(&evt), "note-off detected");
 }
 
+static void test_midi_merge(void)
+{
+    midi_file_t mf;
+    midi_merge_t m;
+    midi_event_t evt;
+    midi_error_t err;
+    uint16_t track;
+    uint32_t last_time = 0;
+    int in_order = 1;
+    int n = 0;
+    const uint8_t expected_notes[] = {60, 67, 60, 67};
+    const uint16_t expected_tracks[] = {1, 2, 1, 2};
+    const uint32_t expected_times[] = {0, 240, 480, 720};
+
+    err = midi_file_open(&mf, midi_format1, sizeof(midi_format1));
+    TEST_ASSERT_EQ(err, MIDI_OK, "open format 1 file");
+    err = midi_merge_open(&m, &mf);
+    TEST_ASSERT_EQ(err, MIDI_OK, "open merged iterator");
+    TEST_ASSERT_EQ(m.ntracks, 3, "3 tracks found");
+
+    while ((err = midi_merge_next(&m, &evt, &track)) == MIDI_OK) {
+        if (evt.abs_time < last_time)
+            in_order = 0;
+        last_time = evt.abs_time;
+        if (evt.type != MIDI_STATUS_NOTE_ON && evt.type != MIDI_STATUS_NOTE_OFF)
+            continue;
+        if (n < 4) {
+            TEST_ASSERT_EQ(midi_note_number(&evt), expected_notes[n],
+                           "merged note");
+            TEST_ASSERT_EQ(track, expected_tracks[n], "merged track");
+            TEST_ASSERT_EQ(evt.abs_time, expected_times[n], "merged time");
+        }
+        n++;
+    }
+
+    TEST_ASSERT_EQ(err, MIDI_ERR_END_OF_FILE, "merge ends at end of file");
+    TEST_ASSERT_EQ(n, 4, "4 note events merged");
+    TEST_ASSERT(in_order, "events in global time order");
+    TEST_ASSERT_EQ(mf.tempo, 250000, "tempo change applied");
+    err = midi_merge_next(&m, &evt, NULL);
+    TEST_ASSERT_EQ(err, MIDI_ERR_END_OF_FILE, "merge stays at end of file");
+
+    /* A format 0 file merges into its single track */
+    n = 0;
+    midi_file_open(&mf, midi_scale, sizeof(midi_scale));
+    err = midi_merge_open(&m, &mf);
+    TEST_ASSERT_EQ(err, MIDI_OK, "merge format 0 file");
+    while (midi_merge_next(&m, &evt, &track) == MIDI_OK) {
+        if (midi_is_note_on(&evt))
+            n++;
+    }
+    TEST_ASSERT_EQ(n, 8, "8 notes merged from format 0");
+
+    /* A parse error in a first event fails the open */
+    midi_file_open(&mf, invalid_vlq, sizeof(invalid_vlq));
+    err = midi_merge_open(&m, &mf);
+    TEST_ASSERT(err != MIDI_OK, "reject invalid VLQ in merge");
+}
+
+static void test_midi_compile(void)
+{
+    midi_file_t mf;
+    midi_compiled_event_t events[4];
+    midi_error_t err;
+    size_t count;
+
+    midi_file_open(&mf, midi_format1, sizeof(midi_format1));
+
+    err = midi_file_compile(&mf, 11025, NULL, 0, &count);
+    TEST_ASSERT_EQ(err, MIDI_OK, "count compiled events");
+    TEST_ASSERT_EQ(count, 4, "4 channel events");
+
+    err = midi_file_compile(&mf, 11025, events, 4, &count);
+    TEST_ASSERT_EQ(err, MIDI_OK, "compile format 1 file");
+    TEST_ASSERT_EQ(count, 4, "4 events compiled");
+    TEST_ASSERT_EQ(events[0].status, 0x90, "note-on C4");
+    TEST_ASSERT_EQ(events[0].sample, 0, "C4 on at sample 0");
+    TEST_ASSERT_EQ(events[1].status, 0x91, "note-on G4 on channel 1");
+    TEST_ASSERT_EQ(events[1].track, 2, "G4 from track 2");
+    /* 240 ticks at 120 BPM = 250ms */
+    TEST_ASSERT_EQ(events[1].sample, 2756, "G4 on at 250ms");
+    TEST_ASSERT_EQ(events[2].data1, 60, "C4 off third");
+    TEST_ASSERT_EQ(events[2].sample, 5512, "C4 off at 500ms");
+    /* Then 240 ticks at 240 BPM = 125ms */
+    TEST_ASSERT_EQ(events[3].sample, 5512 + 1378, "G4 off after tempo change");
+
+    err = midi_file_compile(&mf, 11025, events, 2, &count);
+    TEST_ASSERT_EQ(err, MIDI_ERR_BUFFER_FULL, "report a full array");
+    TEST_ASSERT_EQ(count, 4, "full array still counts every event");
+    TEST_ASSERT_EQ(events[1].data1, 67, "array filled up to its size");
+}
+
 void test_midi_all(void)
 {
     test_midi_open_valid();
@@ -420,4 +532,6 @@ void test_midi_all(void)
     test_midi_timing();
     test_midi_ticks_to_samples();
     test_midi_helper_functions();
+    test_midi_merge();
+    test_midi_compile();
 }
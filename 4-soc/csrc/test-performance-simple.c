@@ -6,37 +6,6 @@
 #include "picosynth.h"
 #include "mmio.h"
 
-/* Minimal allocator for bare-metal tests (avoids libc dependency). */
-#define PERF_HEAP_SIZE (32 * 1024u)
-static uint8_t g_perf_heap[PERF_HEAP_SIZE];
-static size_t g_perf_heap_off;
-
-void *malloc(size_t n) {
-    n = (n + 7u) & ~7u;
-    if (g_perf_heap_off + n > PERF_HEAP_SIZE)
-        return (void *)0;
-    void *p = &g_perf_heap[g_perf_heap_off];
-    g_perf_heap_off += n;
-    return p;
-}
-
-void free(void *p) { (void)p; }
-
-static void *perf_memset(void *dest, int c, unsigned int n) {
-    unsigned char *d = (unsigned char *)dest;
-    while (n--)
-        *d++ = (unsigned char)c;
-    return dest;
-}
-
-void *calloc(size_t nmemb, size_t size) {
-    size_t n = nmemb * size;
-    void *p = malloc(n);
-    if (p)
-        perf_memset(p, 0, n);
-    return p;
-}
-
 /* UART functions */
 void uart_putc(char c) {
     while (!(*UART_STATUS & 0x1));
@@ -398,6 +398,142 @@ static void test_null_safety(void)
     TEST_ASSERT(1, "NULL pointer handling didn't crash");
 }
 
+/* Test rewiring after picosynth_voice_set_out() takes effect on finalize */
+static void test_voice_finalize(void)
+{
+    /* Voice 0 is rewired from osc1 to osc2 after set_out, voice 1 is wired
+     * to osc2 from the start; node 9 keeps the voice beyond 8 nodes.
+     */
+    picosynth_t *s = picosynth_create(2, 10);
+    TEST_ASSERT(s != NULL, "synth creation");
+
+    for (int vi = 0; vi < 2; vi++) {
+        picosynth_voice_t *v = picosynth_get_voice(s, vi);
+        picosynth_node_t *env = picosynth_voice_get_node(v, 0);
+        picosynth_node_t *osc1 = picosynth_voice_get_node(v, 1);
+        picosynth_node_t *osc2 = picosynth_voice_get_node(v, 2);
+        picosynth_node_t *flt = picosynth_voice_get_node(v, 9);
+        picosynth_init_env(env, NULL,
+                           &(picosynth_env_params_t) {
+                               .attack = 30000,
+                               .hold = 0,
+                               .decay = 500,
+                               .sustain = Q15_MAX,
+                               .release = 500,
+                           });
+        picosynth_init_osc(osc1, &env->out, picosynth_voice_freq_ptr(v),
+                           picosynth_wave_sine);
+        picosynth_init_osc(osc2, &env->out, picosynth_voice_freq_ptr(v),
+                           picosynth_wave_square);
+        for (int i = 3; i < 9; i++)
+            picosynth_init_mix(picosynth_voice_get_node(v, (uint8_t) i), NULL,
+                               NULL, NULL, NULL);
+        picosynth_init_lp(flt, NULL, vi ? &osc2->out : &osc1->out, 8000);
+        picosynth_voice_set_out(v, 9);
+        if (vi == 0) {
+            flt->flt.in = &osc2->out;
+            picosynth_voice_finalize(v);
+        }
+    }
+
+    picosynth_note_on(s, 0, 60);
+    picosynth_note_on(s, 1, 60);
+    picosynth_voice_t *v0 = picosynth_get_voice(s, 0);
+    picosynth_voice_t *v1 = picosynth_get_voice(s, 1);
+    int mismatches = 0, non_zero = 0;
+    for (int i = 0; i < 300; i++) {
+        picosynth_process(s);
+        q15_t a = picosynth_voice_get_node(v0, 9)->out;
+        q15_t b = picosynth_voice_get_node(v1, 9)->out;
+        if (a != b)
+            mismatches++;
+        if (a != 0)
+            non_zero++;
+    }
+    TEST_ASSERT(non_zero > 200, "rewired voice produces output");
+    TEST_ASSERT_EQ(mismatches, 0, "rewired voice follows its new input");
+
+    picosynth_destroy(s);
+}
+
+/* Build a 2-voice patch for test_process_block(). Voice 0 is wired forward
+ * (LFO -> detune, env -> osc gain -> SVF); voice 1 feeds its filter back into
+ * the oscillator's detune, so it takes the per-sample path.
+ */
+static picosynth_t *block_test_synth(void)
+{
+    picosynth_t *s = picosynth_create(2, 4);
+    if (!s)
+        return NULL;
+
+    picosynth_voice_t *v = picosynth_get_voice(s, 0);
+    picosynth_node_t *lfo = picosynth_voice_get_node(v, 0);
+    picosynth_node_t *env = picosynth_voice_get_node(v, 1);
+    picosynth_node_t *osc = picosynth_voice_get_node(v, 2);
+    picosynth_node_t *flt = picosynth_voice_get_node(v, 3);
+    picosynth_env_params_t params = {
+        .attack = 3000,
+        .hold = 40,
+        .decay = 500,
+        .sustain = Q15_MAX / 2,
+        .release = 500,
+    };
+    picosynth_init_osc(lfo, NULL, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_triangle);
+    picosynth_init_env(env, NULL, &params);
+    picosynth_init_osc(osc, &env->out, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_sine);
+    osc->osc.detune = &lfo->out;
+    picosynth_init_svf_lp(flt, NULL, &osc->out, picosynth_svf_freq(800),
+                          Q15_MAX / 2);
+    picosynth_voice_set_out(v, 3);
+
+    v = picosynth_get_voice(s, 1);
+    env = picosynth_voice_get_node(v, 0);
+    osc = picosynth_voice_get_node(v, 1);
+    flt = picosynth_voice_get_node(v, 2);
+    picosynth_init_env(env, NULL, &params);
+    picosynth_init_osc(osc, &env->out, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_saw);
+    picosynth_init_lp(flt, NULL, &osc->out, 4000);
+    osc->osc.detune = &flt->out;
+    picosynth_voice_set_out(v, 2);
+
+    picosynth_note_on(s, 0, 60);
+    picosynth_note_on(s, 1, 67);
+    return s;
+}
+
+/* Test block rendering matches per-sample rendering */
+static void test_process_block(void)
+{
+    picosynth_t *a = block_test_synth();
+    picosynth_t *b = block_test_synth();
+    TEST_ASSERT(a != NULL && b != NULL, "synth creation");
+
+    /* Chunks that straddle PICOSYNTH_BLOCK_SIZE boundaries */
+    q15_t buf[PICOSYNTH_BLOCK_SIZE + 5];
+    int mismatches = 0, non_zero = 0;
+    for (int done = 0; done < 400; done += PICOSYNTH_BLOCK_SIZE + 5) {
+        picosynth_process_block(b, buf, PICOSYNTH_BLOCK_SIZE + 5);
+        for (int i = 0; i < PICOSYNTH_BLOCK_SIZE + 5; i++) {
+            q15_t expect = picosynth_process(a);
+            if (buf[i] != expect)
+                mismatches++;
+            if (expect != 0)
+                non_zero++;
+        }
+    }
+    TEST_ASSERT(non_zero > 200, "block test patch produces output");
+    TEST_ASSERT_EQ(mismatches, 0, "block output matches picosynth_process");
+
+    picosynth_process_block(NULL, buf, 4);
+    TEST_ASSERT(buf[0] == 0 && buf[3] == 0, "block of NULL synth is silence");
+
+    picosynth_destroy(a);
+    picosynth_destroy(b);
+}
+
 void test_synth_all(void)
 {
     TEST_RUN(test_synth_create);
@@ -413,5 +549,7 @@ void test_synth_all(void)
     TEST_RUN(test_voice_freq_ptr);
     TEST_RUN(test_voice_set_out);
     TEST_RUN(test_null_graph_inputs);
+    TEST_RUN(test_voice_finalize);
+    TEST_RUN(test_process_block);
     TEST_RUN(test_null_safety);
 }
@@ -151,6 +151,69 @@ static void test_wave_exp(void)
     }
 }
 
+/* Test wavetable waveforms read like their computed counterparts */
+static void test_wave_table(void)
+{
+    q15_t phases[] = {0, Q15_MAX / 8, Q15_MAX / 4, Q15_MAX / 2,
+                      Q15_MAX * 3 / 4};
+    for (int i = 0; i < 5; i++) {
+        int32_t diff = picosynth_wave_table_sine(phases[i]) -
+                       picosynth_wave_sine(phases[i]);
+        TEST_ASSERT_RANGE(diff, -300, 300, "table sine follows sine");
+    }
+
+    /* Band-limited: same shape, Gibbs ripple instead of sharp edges */
+    TEST_ASSERT_RANGE(picosynth_wave_bl_saw(Q15_MAX / 4), -17000, -12000,
+                      "bl saw rises through -1/2");
+    TEST_ASSERT_RANGE(picosynth_wave_bl_saw(Q15_MAX * 3 / 4), 12000, 17000,
+                      "bl saw rises through +1/2");
+    TEST_ASSERT(picosynth_wave_bl_square(Q15_MAX / 4) > 20000,
+                "bl square first half positive");
+    TEST_ASSERT(picosynth_wave_bl_square(Q15_MAX * 3 / 4) < -20000,
+                "bl square second half negative");
+}
+
+#if PICOSYNTH_WAVETABLE
+/* Run a bare band-limited saw oscillator at a note; counts samples that
+ * differ from the full-band table and the peak output.
+ */
+static void bl_saw_note(uint8_t note, int *full_band_diffs, int *peak)
+{
+    picosynth_t *s = picosynth_create(1, 1);
+    picosynth_voice_t *v = picosynth_get_voice(s, 0);
+    picosynth_node_t *osc = picosynth_voice_get_node(v, 0);
+    picosynth_init_osc(osc, NULL, picosynth_voice_freq_ptr(v),
+                       picosynth_wave_bl_saw);
+    picosynth_voice_set_out(v, 0);
+    picosynth_note_on(s, 0, note);
+
+    *full_band_diffs = 0;
+    *peak = 0;
+    for (int i = 0; i < 200; i++) {
+        q15_t phase = (q15_t) osc->state;
+        picosynth_process(s);
+        if (osc->out != picosynth_wave_bl_saw(phase))
+            (*full_band_diffs)++;
+        if (osc->out > *peak)
+            *peak = osc->out;
+    }
+    picosynth_destroy(s);
+}
+
+/* Test band-limited oscillators drop harmonics as the note rises */
+static void test_wave_bl_mip_levels(void)
+{
+    int diffs, peak;
+    bl_saw_note(12, &diffs, &peak);
+    TEST_ASSERT_EQ(diffs, 0, "low note reads the full-band table");
+
+    /* Above 4 kHz only the fundamental stays below Nyquist */
+    bl_saw_note(96, &diffs, &peak);
+    TEST_ASSERT(diffs > 150, "high note reads a band-limited table");
+    TEST_ASSERT_RANGE(peak, 10000, 20000, "high note is a bare fundamental");
+}
+#endif
+
 void test_waveform_all(void)
 {
     TEST_RUN(test_wave_sine_range);
@@ -162,4 +225,8 @@ void test_waveform_all(void)
     TEST_RUN(test_wave_triangle);
     TEST_RUN(test_wave_noise);
     TEST_RUN(test_wave_exp);
+    TEST_RUN(test_wave_table);
+#if PICOSYNTH_WAVETABLE
+    TEST_RUN(test_wave_bl_mip_levels);
+#endif
 }
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MIT
+// Interrupt-driven buffered UART driver (see uart-ring.h)
+//
+// Each ring has one producer and one consumer, so free-running head/tail
+// counters need no locking: putc/getc run in the program, the ISR runs with
+// interrupts off and only ever advances its own side.
+
+#include <stdint.h>
+
+#include "mmio.h"
+#include "uart-ring.h"
+
+#if UART_RING_TX_SIZE & (UART_RING_TX_SIZE - 1)
+#error "UART_RING_TX_SIZE must be a power of two"
+#endif
+#if UART_RING_RX_SIZE & (UART_RING_RX_SIZE - 1)
+#error "UART_RING_RX_SIZE must be a power of two"
+#endif
+
+#define UART_STATUS_TX_READY 0x01
+#define UART_STATUS_RX_VALID 0x02
+
+#define MSTATUS_MIE 8
+
+extern void enable_interrupt(void);
+
+static char tx_buf[UART_RING_TX_SIZE];
+static volatile uint32_t tx_head; /* Advanced by uart_ring_putc() */
+static volatile uint32_t tx_tail; /* Advanced by the ISR */
+
+static unsigned char rx_buf[UART_RING_RX_SIZE];
+static volatile uint32_t rx_head; /* Advanced by the ISR */
+static volatile uint32_t rx_tail; /* Advanced by uart_ring_getc() */
+
+static volatile uint32_t irq_en; /* Shadow of UART_IRQ_EN */
+
+static void set_irq_en(uint32_t en)
+{
+    irq_en = en;
+    *UART_IRQ_EN = en;
+}
+
+void uart_ring_init(void)
+{
+    tx_head = tx_tail = 0;
+    rx_head = rx_tail = 0;
+    set_irq_en(UART_IRQ_RX);
+    enable_interrupt();
+}
+
+void uart_ring_stop(void)
+{
+    set_irq_en(0);
+    __asm__ volatile("csrci mstatus, %0" ::"i"(MSTATUS_MIE));
+}
+
+void uart_ring_putc(char c)
+{
+    /* Ring full: sleep until the ISR takes a byte, with the same MIE-off
+     * check as uart_ring_getc()
+     */
+    while (tx_head - tx_tail >= UART_RING_TX_SIZE) {
+        __asm__ volatile("csrci mstatus, %0" ::"i"(MSTATUS_MIE));
+        if (tx_head - tx_tail >= UART_RING_TX_SIZE)
+            __asm__ volatile("wfi");
+        __asm__ volatile("csrsi mstatus, %0" ::"i"(MSTATUS_MIE));
+    }
+    tx_buf[tx_head & (UART_RING_TX_SIZE - 1)] = c;
+    tx_head++;
+
+    /* The ISR only ever clears the TX enable, so this cannot lose it */
+    if (!(irq_en & UART_IRQ_TX))
+        set_irq_en(irq_en | UART_IRQ_TX);
+}
+
+void uart_ring_puts(const char *s)
+{
+    while (*s)
+        uart_ring_putc(*s++);
+}
+
+void uart_ring_flush(void)
+{
+    while (tx_head != tx_tail)
+        ;
+    while (!(*UART_STATUS & UART_STATUS_TX_READY))
+        ;
+}
+
+int uart_ring_rx_ready(void)
+{
+    return rx_head != rx_tail;
+}
+
+unsigned char uart_ring_getc(void)
+{
+    /* wfi wakes on a pending interrupt even with mstatus.MIE clear, so
+     * checking the ring with interrupts off cannot sleep past a byte that
+     * arrived just before the wfi
+     */
+    while (rx_head == rx_tail) {
+        __asm__ volatile("csrci mstatus, %0" ::"i"(MSTATUS_MIE));
+        if (rx_head == rx_tail)
+            __asm__ volatile("wfi");
+        __asm__ volatile("csrsi mstatus, %0" ::"i"(MSTATUS_MIE));
+    }
+
+    unsigned char c = rx_buf[rx_tail & (UART_RING_RX_SIZE - 1)];
+    rx_tail++;
+    return c;
+}
+
+int uart_ring_isr(void)
+{
+    int serviced = 0;
+
+    /* RX: empty the FIFO; bytes that find the ring full are dropped */
+    while (*UART_STATUS & UART_STATUS_RX_VALID) {
+        unsigned char c = (unsigned char) (*UART_RECV & 0xFF);
+        if (rx_head - rx_tail < UART_RING_RX_SIZE) {
+            rx_buf[rx_head & (UART_RING_RX_SIZE - 1)] = c;
+            rx_head++;
+        }
+        serviced = 1;
+    }
+
+    /* TX: refill the one-byte buffer, and drop the TX enable once the ring
+     * is empty so an idle transmitter does not keep interrupting
+     */
+    if ((irq_en & UART_IRQ_TX) && (*UART_STATUS & UART_STATUS_TX_READY)) {
+        serviced = 1;
+        while (tx_tail != tx_head &&
+               (*UART_STATUS & UART_STATUS_TX_READY)) {
+            *UART_SEND = (uint32_t) (unsigned char)
+                tx_buf[tx_tail & (UART_RING_TX_SIZE - 1)];
+            tx_tail++;
+        }
+        if (tx_tail == tx_head)
+            set_irq_en(irq_en & ~UART_IRQ_TX);
+    }
+    return serviced;
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// Interrupt-driven buffered UART driver
+//
+// TX and RX go through ring buffers that the UART level interrupt
+// (UART_IRQ_EN, machine external interrupt, mcause 0x8000000B) drains and
+// fills, so uart_ring_putc() returns as soon as the byte is queued instead
+// of waiting about one character time per byte.
+//
+// The program's trap_handler() must call uart_ring_isr() for external
+// interrupts; it returns non-zero when it serviced the UART. Before main()
+// returns (init.S then stops the simulation) or the program jumps away, call
+// uart_ring_flush() so queued output is not lost, and uart_ring_stop() before
+// jumping to the reset vector.
+
+#ifndef UART_RING_H
+#define UART_RING_H
+
+#ifndef UART_RING_TX_SIZE
+#define UART_RING_TX_SIZE 256 /* Power of two */
+#endif
+#ifndef UART_RING_RX_SIZE
+#define UART_RING_RX_SIZE 64 /* Power of two */
+#endif
+
+/* Enable the UART RX interrupt and machine interrupts (enable_interrupt) */
+void uart_ring_init(void);
+
+/* Disable the UART interrupts and mstatus.MIE; queued bytes are kept */
+void uart_ring_stop(void);
+
+/* Queue a byte; sleeps in wfi only while the TX ring is full */
+void uart_ring_putc(char c);
+void uart_ring_puts(const char *s);
+
+/* Wait until every queued byte has been handed to the UART */
+void uart_ring_flush(void);
+
+/* Non-zero if a received byte is waiting */
+int uart_ring_rx_ready(void);
+
+/* Next received byte, sleeping in wfi until one arrives */
+unsigned char uart_ring_getc(void);
+
+/* Service the UART from trap_handler(); returns non-zero if it was pending */
+int uart_ring_isr(void);
+
+#endif /* UART_RING_H */
@@ -0,0 +1,516 @@
+// SPDX-License-Identifier: MIT
+// Auto-generated picosynth wavetables
+// DO NOT EDIT - Generated by scripts/gen-wavetables.py
+
+#ifndef PICOSYNTH_WAVETABLES_H_
+#define PICOSYNTH_WAVETABLES_H_
+
+#include "picosynth.h"
+#include "tcm.h"
+
+#define WAVETABLE_SIZE 256
+#define WAVETABLE_LEVELS 8
+
+/* Sine, full cycle (data TCM: every sine oscillator reads it) */
+static const q15_t wavetable_sine[WAVETABLE_SIZE + 1] TCM_RODATA = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,
+      7962,   8739,   9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,
+     15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,
+     22005,  22594,  23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,  30273,  30571,
+     30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+     32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,
+     32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,
+     26319,  25832,  25329,  24811,  24279,  23731,  23170,  22594,  22005,  21403,
+     20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,
+     14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,
+     -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,
+     -9512, -10278, -11039, -11793, -12539, -13279, -14010, -14732, -15446, -16151,
+    -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683,
+    -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+    -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678,
+    -32728, -32757, -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571, -30273, -29956,
+    -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832,
+    -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403, -20787, -20159,
+    -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,
+     -4808,  -4011,  -3212,  -2410,  -1608,   -804,      0,
+};
+
+/* Band-limited rising saw, one level per octave */
+static const q15_t wavetable_saw[8][WAVETABLE_SIZE + 1] = {
+    /* Level 0: 127 harmonics */
+    {
+             0, -32767, -24823, -29174, -25705, -28009, -25729, -27253, -25525, -26637,
+        -25230, -26085, -24887, -25569, -24518, -25073, -24132, -24591, -23734, -24118,
+        -23329, -23652, -22918, -23191, -22503, -22733, -22085, -22279, -21664, -21827,
+        -21241, -21376, -20816, -20927, -20390, -20480, -19962, -20033, -19534, -19588,
+        -19105, -19143, -18675, -18699, -18245, -18255, -17814, -17812, -17382, -17369,
+        -16951, -16927, -16518, -16485, -16086, -16043, -15653, -15602, -15220, -15161,
+        -14787, -14720, -14353, -14279, -13920, -13838, -13486, -13398, -13052, -12958,
+        -12618, -12518, -12183, -12078, -11749, -11638, -11315, -11198, -10880, -10758,
+        -10445, -10319, -10011,  -9879,  -9576,  -9440,  -9141,  -9000,  -8706,  -8561,
+         -8271,  -8121,  -7836,  -7682,  -7401,  -7243,  -6966,  -6804,  -6531,  -6365,
+         -6095,  -5926,  -5660,  -5487,  -5225,  -5048,  -4790,  -4609,  -4354,  -4170,
+         -3919,  -3731,  -3483,  -3292,  -3048,  -2853,  -2613,  -2414,  -2177,  -1975,
+         -1742,  -1536,  -1306,  -1097,   -871,   -658,   -435,   -219,      0,    219,
+           435,    658,    871,   1097,   1306,   1536,   1742,   1975,   2177,   2414,
+          2613,   2853,   3048,   3292,   3483,   3731,   3919,   4170,   4354,   4609,
+          4790,   5048,   5225,   5487,   5660,   5926,   6095,   6365,   6531,   6804,
+          6966,   7243,   7401,   7682,   7836,   8121,   8271,   8561,   8706,   9000,
+          9141,   9440,   9576,   9879,  10011,  10319,  10445,  10758,  10880,  11198,
+         11315,  11638,  11749,  12078,  12183,  12518,  12618,  12958,  13052,  13398,
+         13486,  13838,  13920,  14279,  14353,  14720,  14787,  15161,  15220,  15602,
+         15653,  16043,  16086,  16485,  16518,  16927,  16951,  17369,  17382,  17812,
+         17814,  18255,  18245,  18699,  18675,  19143,  19105,  19588,  19534,  20033,
+         19962,  20480,  20390,  20927,  20816,  21376,  21241,  21827,  21664,  22279,
+         22085,  22733,  22503,  23191,  22918,  23652,  23329,  24118,  23734,  24591,
+         24132,  25073,  24518,  25569,  24887,  26085,  25230,  26637,  25525,  27253,
+         25729,  28009,  25705,  29174,  24823,  32767,      0,
+    },
+    /* Level 1: 64 harmonics */
+    {
+             0, -24336, -32548, -27853, -24387, -26758, -28515, -26450, -24834, -26063,
+        -26912, -25494, -24422, -25233, -25717, -24593, -23784, -24376, -24662, -23706,
+        -23052, -23511, -23672, -22826, -22274, -22641, -22716, -21948, -21470, -21770,
+        -21781, -21071, -20648, -20897, -20860, -20195, -19815, -20024, -19949, -19320,
+        -18975, -19151, -19043, -18444, -18129, -18277, -18143, -17570, -17278, -17404,
+        -17247, -16695, -16425, -16530, -16353, -15820, -15568, -15656, -15462, -14945,
+        -14710, -14782, -14572, -14071, -13850, -13908, -13684, -13196, -12989, -13033,
+        -12798, -12322, -12126, -12159, -11912, -11447, -11263, -11285, -11027, -10573,
+        -10399, -10411, -10143,  -9698,  -9534,  -9537,  -9259,  -8824,  -8669,  -8662,
+         -8376,  -7950,  -7803,  -7788,  -7493,  -7075,  -6937,  -6914,  -6611,  -6201,
+         -6070,  -6040,  -5729,  -5327,  -5204,  -5165,  -4847,  -4452,  -4337,  -4291,
+         -3966,  -3578,  -3470,  -3417,  -3084,  -2704,  -2602,  -2542,  -2203,  -1829,
+         -1735,  -1668,  -1322,   -955,   -867,   -794,   -441,    -81,      0,     81,
+           441,    794,    867,    955,   1322,   1668,   1735,   1829,   2203,   2542,
+          2602,   2704,   3084,   3417,   3470,   3578,   3966,   4291,   4337,   4452,
+          4847,   5165,   5204,   5327,   5729,   6040,   6070,   6201,   6611,   6914,
+          6937,   7075,   7493,   7788,   7803,   7950,   8376,   8662,   8669,   8824,
+          9259,   9537,   9534,   9698,  10143,  10411,  10399,  10573,  11027,  11285,
+         11263,  11447,  11912,  12159,  12126,  12322,  12798,  13033,  12989,  13196,
+         13684,  13908,  13850,  14071,  14572,  14782,  14710,  14945,  15462,  15656,
+         15568,  15820,  16353,  16530,  16425,  16695,  17247,  17404,  17278,  17570,
+         18143,  18277,  18129,  18444,  19043,  19151,  18975,  19320,  19949,  20024,
+         19815,  20195,  20860,  20897,  20648,  21071,  21781,  21770,  21470,  21948,
+         22716,  22641,  22274,  22826,  23672,  23511,  23052,  23706,  24662,  24376,
+         23784,  24593,  25717,  25233,  24422,  25494,  26912,  26063,  24834,  26450,
+         28515,  26758,  24387,  27853,  32548,  24336,      0,
+    },
+    /* Level 2: 32 harmonics */
+    {
+             0, -13497, -24255, -30525, -32107, -30264, -27059, -24445, -23520, -24263,
+        -25803, -27027, -27193, -26257, -24782, -23548, -23099, -23470, -24234, -24787,
+        -24709, -23979, -22951, -22119, -21820, -22059, -22530, -22814, -22633, -21995,
+        -21176, -20537, -20314, -20485, -20799, -20936, -20696, -20112, -19415, -18893,
+        -18716, -18843, -19058, -19101, -18824, -18275, -17660, -17217, -17071, -17169,
+        -17315, -17290, -16987, -16463, -15908, -15522, -15399, -15475, -15569, -15494,
+        -15170, -14666, -14157, -13816, -13711, -13770, -13822, -13707, -13367, -12879,
+        -12407, -12102, -12012, -12056, -12075, -11926, -11572, -11098, -10657, -10383,
+        -10306, -10338, -10327, -10150,  -9784,  -9321,  -8908,  -8661,  -8595,  -8615,
+         -8579,  -8376,  -8000,  -7547,  -7159,  -6936,  -6879,  -6891,  -6831,  -6605,
+         -6220,  -5776,  -5410,  -5209,  -5162,  -5164,  -5082,  -4836,  -4441,  -4006,
+         -3661,  -3481,  -3442,  -3436,  -3334,  -3067,  -2664,  -2237,  -1912,  -1752,
+         -1721,  -1707,  -1585,  -1299,   -888,   -469,   -163,    -22,      0,     22,
+           163,    469,    888,   1299,   1585,   1707,   1721,   1752,   1912,   2237,
+          2664,   3067,   3334,   3436,   3442,   3481,   3661,   4006,   4441,   4836,
+          5082,   5164,   5162,   5209,   5410,   5776,   6220,   6605,   6831,   6891,
+          6879,   6936,   7159,   7547,   8000,   8376,   8579,   8615,   8595,   8661,
+          8908,   9321,   9784,  10150,  10327,  10338,  10306,  10383,  10657,  11098,
+         11572,  11926,  12075,  12056,  12012,  12102,  12407,  12879,  13367,  13707,
+         13822,  13770,  13711,  13816,  14157,  14666,  15170,  15494,  15569,  15475,
+         15399,  15522,  15908,  16463,  16987,  17290,  17315,  17169,  17071,  17217,
+         17660,  18275,  18824,  19101,  19058,  18843,  18716,  18893,  19415,  20112,
+         20696,  20936,  20799,  20485,  20314,  20537,  21176,  21995,  22633,  22814,
+         22530,  22059,  21820,  22119,  22951,  23979,  24709,  24787,  24234,  23470,
+         23099,  23548,  24782,  26257,  27193,  27027,  25803,  24263,  23520,  24445,
+         27059,  30264,  32107,  30525,  24255,  13497,      0,
+    },
+    /* Level 3: 16 harmonics */
+    {
+             0,  -6929, -13474, -19287, -24092, -27706, -30056, -31181, -31219, -30390,
+        -28965, -27234, -25474, -23918, -22738, -22027, -21799, -21997, -22511, -23194,
+        -23891, -24459, -24789, -24817, -24529, -23962, -23191, -22316, -21448, -20688,
+        -20113, -19767, -19657, -19751, -19989, -20292, -20573, -20756, -20781, -20618,
+        -20268, -19758, -19143, -18490, -17869, -17342, -16955, -16729, -16659, -16715,
+        -16851, -17006, -17120, -17143, -17038, -16792, -16413, -15930, -15390, -14844,
+        -14345, -13937, -13647, -13483, -13435, -13471, -13549, -13621, -13640, -13570,
+        -13388, -13092, -12696, -12230, -11736, -11257, -10836, -10504, -10277, -10155,
+        -10121, -10143, -10183, -10197, -10151, -10016,  -9780,  -9448,  -9040,  -8586,
+         -8125,  -7697,  -7334,  -7058,  -6879,  -6788,  -6765,  -6776,  -6785,  -6756,
+         -6657,  -6471,  -6193,  -5833,  -5414,  -4970,  -4537,  -4149,  -3833,  -3605,
+         -3466,  -3401,  -3387,  -3389,  -3373,  -3305,  -3162,  -2931,  -2615,  -2230,
+         -1803,  -1368,   -959,   -608,   -335,   -150,    -46,     -6,      0,      6,
+            46,    150,    335,    608,    959,   1368,   1803,   2230,   2615,   2931,
+          3162,   3305,   3373,   3389,   3387,   3401,   3466,   3605,   3833,   4149,
+          4537,   4970,   5414,   5833,   6193,   6471,   6657,   6756,   6785,   6776,
+          6765,   6788,   6879,   7058,   7334,   7697,   8125,   8586,   9040,   9448,
+          9780,  10016,  10151,  10197,  10183,  10143,  10121,  10155,  10277,  10504,
+         10836,  11257,  11736,  12230,  12696,  13092,  13388,  13570,  13640,  13621,
+         13549,  13471,  13435,  13483,  13647,  13937,  14345,  14844,  15390,  15930,
+         16413,  16792,  17038,  17143,  17120,  17006,  16851,  16715,  16659,  16729,
+         16955,  17342,  17869,  18490,  19143,  19758,  20268,  20618,  20781,  20756,
+         20573,  20292,  19989,  19751,  19657,  19767,  20113,  20688,  21448,  22316,
+         23191,  23962,  24529,  24817,  24789,  24459,  23891,  23194,  22511,  21997,
+         21799,  22027,  22738,  23918,  25474,  27234,  28965,  30390,  31219,  31181,
+         30056,  27706,  24092,  19287,  13474,   6929,      0,
+    },
+    /* Level 4: 8 harmonics */
+    {
+             0,  -3488,  -6923, -10253, -13428, -16403, -19138, -21598, -23757, -25594,
+        -27098, -28264, -29097, -29607, -29813, -29739, -29416, -28877, -28160, -27304,
+        -26350, -25337, -24303, -23284, -22312, -21414, -20613, -19927, -19365, -18936,
+        -18638, -18466, -18412, -18461, -18596, -18798, -19046, -19316, -19589, -19842,
+        -20057, -20218, -20310, -20324, -20252, -20093, -19847, -19518, -19115, -18648,
+        -18129, -17574, -16998, -16416, -15845, -15299, -14791, -14332, -13932, -13596,
+        -13327, -13126, -12991, -12915, -12892, -12912, -12963, -13034, -13111, -13182,
+        -13234, -13257, -13240, -13176, -13059, -12886, -12656, -12370, -12032, -11649,
+        -11228, -10778, -10310,  -9835,  -9363,  -8907,  -8475,  -8076,  -7718,  -7407,
+         -7145,  -6934,  -6772,  -6658,  -6585,  -6548,  -6538,  -6545,  -6560,  -6573,
+         -6573,  -6552,  -6501,  -6414,  -6284,  -6108,  -5886,  -5616,  -5303,  -4949,
+         -4562,  -4148,  -3717,  -3277,  -2838,  -2410,  -2002,  -1621,  -1274,   -968,
+          -705,   -488,   -316,   -187,    -98,    -42,    -13,     -2,      0,      2,
+            13,     42,     98,    187,    316,    488,    705,    968,   1274,   1621,
+          2002,   2410,   2838,   3277,   3717,   4148,   4562,   4949,   5303,   5616,
+          5886,   6108,   6284,   6414,   6501,   6552,   6573,   6573,   6560,   6545,
+          6538,   6548,   6585,   6658,   6772,   6934,   7145,   7407,   7718,   8076,
+          8475,   8907,   9363,   9835,  10310,  10778,  11228,  11649,  12032,  12370,
+         12656,  12886,  13059,  13176,  13240,  13257,  13234,  13182,  13111,  13034,
+         12963,  12912,  12892,  12915,  12991,  13126,  13327,  13596,  13932,  14332,
+         14791,  15299,  15845,  16416,  16998,  17574,  18129,  18648,  19115,  19518,
+         19847,  20093,  20252,  20324,  20310,  20218,  20057,  19842,  19589,  19316,
+         19046,  18798,  18596,  18461,  18412,  18466,  18638,  18936,  19365,  19927,
+         20613,  21414,  22312,  23284,  24303,  25337,  26350,  27304,  28160,  28877,
+         29416,  29739,  29813,  29607,  29097,  28264,  27098,  25594,  23757,  21598,
+         19138,  16403,  13428,  10253,   6923,   3488,      0,
+    },
+    /* Level 5: 4 harmonics */
+    {
+             0,  -1747,  -3487,  -5210,  -6911,  -8580, -10211, -11797, -13330, -14805,
+        -16216, -17556, -18822, -20008, -21110, -22126, -23052, -23886, -24626, -25272,
+        -25824, -26281, -26644, -26915, -27095, -27188, -27197, -27124, -26974, -26752,
+        -26462, -26109, -25699, -25237, -24728, -24180, -23598, -22987, -22355, -21706,
+        -21047, -20384, -19721, -19064, -18417, -17787, -17176, -16588, -16028, -15498,
+        -15000, -14538, -14112, -13724, -13374, -13064, -12792, -12559, -12363, -12203,
+        -12078, -11985, -11921, -11886, -11874, -11885, -11913, -11956, -12011, -12073,
+        -12140, -12208, -12273, -12333, -12383, -12421, -12444, -12450, -12436, -12399,
+        -12339, -12254, -12142, -12003, -11835, -11640, -11417, -11166, -10889, -10586,
+        -10258,  -9908,  -9537,  -9147,  -8740,  -8319,  -7887,  -7446,  -6999,  -6548,
+         -6097,  -5648,  -5204,  -4768,  -4342,  -3929,  -3530,  -3149,  -2786,  -2444,
+         -2123,  -1825,  -1551,  -1301,  -1076,   -875,   -698,   -545,   -414,   -305,
+          -217,   -146,    -93,    -54,    -28,    -12,     -4,      0,      0,      0,
+             4,     12,     28,     54,     93,    146,    217,    305,    414,    545,
+           698,    875,   1076,   1301,   1551,   1825,   2123,   2444,   2786,   3149,
+          3530,   3929,   4342,   4768,   5204,   5648,   6097,   6548,   6999,   7446,
+          7887,   8319,   8740,   9147,   9537,   9908,  10258,  10586,  10889,  11166,
+         11417,  11640,  11835,  12003,  12142,  12254,  12339,  12399,  12436,  12450,
+         12444,  12421,  12383,  12333,  12273,  12208,  12140,  12073,  12011,  11956,
+         11913,  11885,  11874,  11886,  11921,  11985,  12078,  12203,  12363,  12559,
+         12792,  13064,  13374,  13724,  14112,  14538,  15000,  15498,  16028,  16588,
+         17176,  17787,  18417,  19064,  19721,  20384,  21047,  21706,  22355,  22987,
+         23598,  24180,  24728,  25237,  25699,  26109,  26462,  26752,  26974,  27124,
+         27197,  27188,  27095,  26915,  26644,  26281,  25824,  25272,  24626,  23886,
+         23052,  22126,  21110,  20008,  18822,  17556,  16216,  14805,  13330,  11797,
+         10211,   8580,   6911,   5210,   3487,   1747,      0,
+    },
+    /* Level 6: 2 harmonics */
+    {
+             0,   -874,  -1747,  -2617,  -3483,  -4344,  -5199,  -6045,  -6883,  -7710,
+         -8526,  -9329, -10118, -10892, -11650, -12391, -13114, -13817, -14500, -15161,
+        -15801, -16418, -17011, -17580, -18123, -18641, -19133, -19597, -20034, -20443,
+        -20824, -21177, -21500, -21795, -22060, -22296, -22503, -22681, -22829, -22948,
+        -23038, -23099, -23132, -23136, -23113, -23063, -22986, -22882, -22753, -22599,
+        -22420, -22218, -21992, -21745, -21476, -21186, -20877, -20550, -20204, -19842,
+        -19463, -19070, -18663, -18243, -17812, -17369, -16917, -16457, -15988, -15514,
+        -15034, -14549, -14061, -13571, -13080, -12588, -12097, -11607, -11121, -10637,
+        -10158,  -9685,  -9217,  -8757,  -8304,  -7859,  -7423,  -6997,  -6582,  -6177,
+         -5784,  -5403,  -5034,  -4678,  -4335,  -4005,  -3689,  -3387,  -3099,  -2825,
+         -2565,  -2319,  -2088,  -1871,  -1668,  -1478,  -1303,  -1141,   -991,   -855,
+          -731,   -619,   -519,   -430,   -351,   -282,   -223,   -172,   -130,    -95,
+           -67,    -45,    -28,    -16,     -8,     -4,     -1,      0,      0,      0,
+             1,      4,      8,     16,     28,     45,     67,     95,    130,    172,
+           223,    282,    351,    430,    519,    619,    731,    855,    991,   1141,
+          1303,   1478,   1668,   1871,   2088,   2319,   2565,   2825,   3099,   3387,
+          3689,   4005,   4335,   4678,   5034,   5403,   5784,   6177,   6582,   6997,
+          7423,   7859,   8304,   8757,   9217,   9685,  10158,  10637,  11121,  11607,
+         12097,  12588,  13080,  13571,  14061,  14549,  15034,  15514,  15988,  16457,
+         16917,  17369,  17812,  18243,  18663,  19070,  19463,  19842,  20204,  20550,
+         20877,  21186,  21476,  21745,  21992,  22218,  22420,  22599,  22753,  22882,
+         22986,  23063,  23113,  23136,  23132,  23099,  23038,  22948,  22829,  22681,
+         22503,  22296,  22060,  21795,  21500,  21177,  20824,  20443,  20034,  19597,
+         19133,  18641,  18123,  17580,  17011,  16418,  15801,  15161,  14500,  13817,
+         13114,  12391,  11650,  10892,  10118,   9329,   8526,   7710,   6883,   6045,
+          5199,   4344,   3483,   2617,   1747,    874,      0,
+    },
+    /* Level 7: 1 harmonics */
+    {
+             0,   -437,   -874,  -1310,  -1746,  -2180,  -2613,  -3045,  -3475,  -3903,
+         -4328,  -4751,  -5170,  -5587,  -6001,  -6410,  -6816,  -7218,  -7615,  -8008,
+         -8396,  -8779,  -9157,  -9529,  -9896, -10256, -10610, -10958, -11300, -11634,
+        -11962, -12282, -12595, -12900, -13197, -13487, -13769, -14042, -14306, -14562,
+        -14810, -15048, -15277, -15498, -15708, -15910, -16101, -16283, -16456, -16618,
+        -16770, -16913, -17045, -17166, -17278, -17379, -17469, -17549, -17619, -17678,
+        -17726, -17763, -17790, -17806, -17812, -17806, -17790, -17763, -17726, -17678,
+        -17619, -17549, -17469, -17379, -17278, -17166, -17045, -16913, -16770, -16618,
+        -16456, -16283, -16101, -15910, -15708, -15498, -15277, -15048, -14810, -14562,
+        -14306, -14042, -13769, -13487, -13197, -12900, -12595, -12282, -11962, -11634,
+        -11300, -10958, -10610, -10256,  -9896,  -9529,  -9157,  -8779,  -8396,  -8008,
+         -7615,  -7218,  -6816,  -6410,  -6001,  -5587,  -5170,  -4751,  -4328,  -3903,
+         -3475,  -3045,  -2613,  -2180,  -1746,  -1310,   -874,   -437,      0,    437,
+           874,   1310,   1746,   2180,   2613,   3045,   3475,   3903,   4328,   4751,
+          5170,   5587,   6001,   6410,   6816,   7218,   7615,   8008,   8396,   8779,
+          9157,   9529,   9896,  10256,  10610,  10958,  11300,  11634,  11962,  12282,
+         12595,  12900,  13197,  13487,  13769,  14042,  14306,  14562,  14810,  15048,
+         15277,  15498,  15708,  15910,  16101,  16283,  16456,  16618,  16770,  16913,
+         17045,  17166,  17278,  17379,  17469,  17549,  17619,  17678,  17726,  17763,
+         17790,  17806,  17812,  17806,  17790,  17763,  17726,  17678,  17619,  17549,
+         17469,  17379,  17278,  17166,  17045,  16913,  16770,  16618,  16456,  16283,
+         16101,  15910,  15708,  15498,  15277,  15048,  14810,  14562,  14306,  14042,
+         13769,  13487,  13197,  12900,  12595,  12282,  11962,  11634,  11300,  10958,
+         10610,  10256,   9896,   9529,   9157,   8779,   8396,   8008,   7615,   7218,
+          6816,   6410,   6001,   5587,   5170,   4751,   4328,   3903,   3475,   3045,
+          2613,   2180,   1746,   1310,    874,    437,      0,
+    },
+};
+
+/* Band-limited square, one level per octave */
+static const q15_t wavetable_square[8][WAVETABLE_SIZE + 1] = {
+    /* Level 0: 127 harmonics */
+    {
+             0,  30342,  23233,  27440,  24445,  26773,  24868,  26481,  25081,  26318,
+         25209,  26214,  25295,  26143,  25356,  26090,  25401,  26051,  25436,  26020,
+         25464,  25995,  25486,  25974,  25505,  25957,  25520,  25943,  25533,  25931,
+         25545,  25921,  25554,  25912,  25562,  25904,  25570,  25897,  25576,  25892,
+         25581,  25887,  25586,  25882,  25590,  25878,  25594,  25875,  25597,  25872,
+         25599,  25870,  25601,  25868,  25603,  25866,  25605,  25865,  25606,  25864,
+         25607,  25863,  25607,  25863,  25607,  25863,  25607,  25863,  25607,  25864,
+         25606,  25865,  25605,  25866,  25603,  25868,  25601,  25870,  25599,  25872,
+         25597,  25875,  25594,  25878,  25590,  25882,  25586,  25887,  25581,  25892,
+         25576,  25897,  25570,  25904,  25562,  25912,  25554,  25921,  25545,  25931,
+         25533,  25943,  25520,  25957,  25505,  25974,  25486,  25995,  25464,  26020,
+         25436,  26051,  25401,  26090,  25356,  26143,  25295,  26214,  25209,  26318,
+         25081,  26481,  24868,  26773,  24445,  27440,  23233,  30342,      0, -30342,
+        -23233, -27440, -24445, -26773, -24868, -26481, -25081, -26318, -25209, -26214,
+        -25295, -26143, -25356, -26090, -25401, -26051, -25436, -26020, -25464, -25995,
+        -25486, -25974, -25505, -25957, -25520, -25943, -25533, -25931, -25545, -25921,
+        -25554, -25912, -25562, -25904, -25570, -25897, -25576, -25892, -25581, -25887,
+        -25586, -25882, -25590, -25878, -25594, -25875, -25597, -25872, -25599, -25870,
+        -25601, -25868, -25603, -25866, -25605, -25865, -25606, -25864, -25607, -25863,
+        -25607, -25863, -25607, -25863, -25607, -25863, -25607, -25864, -25606, -25865,
+        -25605, -25866, -25603, -25868, -25601, -25870, -25599, -25872, -25597, -25875,
+        -25594, -25878, -25590, -25882, -25586, -25887, -25581, -25892, -25576, -25897,
+        -25570, -25904, -25562, -25912, -25554, -25921, -25545, -25931, -25533, -25943,
+        -25520, -25957, -25505, -25974, -25486, -25995, -25464, -26020, -25436, -26051,
+        -25401, -26090, -25356, -26143, -25295, -26214, -25209, -26318, -25081, -26481,
+        -24868, -26773, -24445, -27440, -23233, -30342,      0,
+    },
+    /* Level 1: 64 harmonics */
+    {
+             0,  22459,  30343,  26350,  23230,  25491,  27445,  25864,  24438,  25656,
+         26781,  25788,  24858,  25697,  26492,  25764,  25068,  25713,  26332,  25753,
+         25193,  25721,  26232,  25747,  25275,  25725,  26164,  25743,  25332,  25728,
+         26116,  25741,  25373,  25730,  26080,  25740,  25404,  25731,  26054,  25739,
+         25427,  25732,  26033,  25738,  25445,  25733,  26018,  25737,  25458,  25733,
+         26007,  25737,  25468,  25734,  25999,  25736,  25474,  25734,  25994,  25736,
+         25478,  25735,  25991,  25735,  25479,  25735,  25991,  25735,  25478,  25736,
+         25994,  25734,  25474,  25736,  25999,  25734,  25468,  25737,  26007,  25733,
+         25458,  25737,  26018,  25733,  25445,  25738,  26033,  25732,  25427,  25739,
+         26054,  25731,  25404,  25740,  26080,  25730,  25373,  25741,  26116,  25728,
+         25332,  25743,  26164,  25725,  25275,  25747,  26232,  25721,  25193,  25753,
+         26332,  25713,  25068,  25764,  26492,  25697,  24858,  25788,  26781,  25656,
+         24438,  25864,  27445,  25491,  23230,  26350,  30343,  22459,      0, -22459,
+        -30343, -26350, -23230, -25491, -27445, -25864, -24438, -25656, -26781, -25788,
+        -24858, -25697, -26492, -25764, -25068, -25713, -26332, -25753, -25193, -25721,
+        -26232, -25747, -25275, -25725, -26164, -25743, -25332, -25728, -26116, -25741,
+        -25373, -25730, -26080, -25740, -25404, -25731, -26054, -25739, -25427, -25732,
+        -26033, -25738, -25445, -25733, -26018, -25737, -25458, -25733, -26007, -25737,
+        -25468, -25734, -25999, -25736, -25474, -25734, -25994, -25736, -25478, -25735,
+        -25991, -25735, -25479, -25735, -25991, -25735, -25478, -25736, -25994, -25734,
+        -25474, -25736, -25999, -25734, -25468, -25737, -26007, -25733, -25458, -25737,
+        -26018, -25733, -25445, -25738, -26033, -25732, -25427, -25739, -26054, -25731,
+        -25404, -25740, -26080, -25730, -25373, -25741, -26116, -25728, -25332, -25743,
+        -26164, -25725, -25275, -25747, -26232, -25721, -25193, -25753, -26332, -25713,
+        -25068, -25764, -26492, -25697, -24858, -25788, -26781, -25656, -24438, -25864,
+        -27445, -25491, -23230, -26350, -30343, -22459,      0,
+    },
+    /* Level 2: 32 harmonics */
+    {
+             0,  12435,  22461,  28509,  30350,  29032,  26348,  24055,  23217,  23929,
+         25493,  26918,  27464,  26973,  25862,  24821,  24413,  24790,  25658,  26485,
+         26813,  26504,  25786,  25095,  24818,  25082,  25699,  26298,  26539,  26307,
+         25761,  25229,  25013,  25222,  25716,  26199,  26396,  26204,  25750,  25303,
+         25121,  25299,  25724,  26143,  26315,  26146,  25743,  25345,  25182,  25343,
+         25729,  26112,  26270,  26114,  25739,  25367,  25214,  25366,  25733,  26098,
+         26249,  26099,  25736,  25374,  25224,  25374,  25736,  26099,  26249,  26098,
+         25733,  25366,  25214,  25367,  25739,  26114,  26270,  26112,  25729,  25343,
+         25182,  25345,  25743,  26146,  26315,  26143,  25724,  25299,  25121,  25303,
+         25750,  26204,  26396,  26199,  25716,  25222,  25013,  25229,  25761,  26307,
+         26539,  26298,  25699,  25082,  24818,  25095,  25786,  26504,  26813,  26485,
+         25658,  24790,  24413,  24821,  25862,  26973,  27464,  26918,  25493,  23929,
+         23217,  24055,  26348,  29032,  30350,  28509,  22461,  12435,      0, -12435,
+        -22461, -28509, -30350, -29032, -26348, -24055, -23217, -23929, -25493, -26918,
+        -27464, -26973, -25862, -24821, -24413, -24790, -25658, -26485, -26813, -26504,
+        -25786, -25095, -24818, -25082, -25699, -26298, -26539, -26307, -25761, -25229,
+        -25013, -25222, -25716, -26199, -26396, -26204, -25750, -25303, -25121, -25299,
+        -25724, -26143, -26315, -26146, -25743, -25345, -25182, -25343, -25729, -26112,
+        -26270, -26114, -25739, -25367, -25214, -25366, -25733, -26098, -26249, -26099,
+        -25736, -25374, -25224, -25374, -25736, -26099, -26249, -26098, -25733, -25366,
+        -25214, -25367, -25739, -26114, -26270, -26112, -25729, -25343, -25182, -25345,
+        -25743, -26146, -26315, -26143, -25724, -25299, -25121, -25303, -25750, -26204,
+        -26396, -26199, -25716, -25222, -25013, -25229, -25761, -26307, -26539, -26298,
+        -25699, -25082, -24818, -25095, -25786, -26504, -26813, -26485, -25658, -24790,
+        -24413, -24821, -25862, -26973, -27464, -26918, -25493, -23929, -23217, -24055,
+        -26348, -29032, -30350, -28509, -22461, -12435,      0,
+    },
+    /* Level 3: 16 harmonics */
+    {
+             0,   6379,  12436,  17879,  22469,  26044,  28529,  29939,  30375,  30005,
+         29049,  27747,  26340,  25041,  24018,  23378,  23166,  23362,  23894,  24651,
+         25502,  26315,  26975,  27399,  27543,  27406,  27028,  26479,  25852,  25243,
+         24742,  24415,  24303,  24411,  24714,  25157,  25669,  26171,  26589,  26863,
+         26958,  26865,  26605,  26220,  25773,  25331,  24962,  24717,  24632,  24716,
+         24953,  25304,  25715,  26123,  26467,  26695,  26775,  26696,  26471,  26136,
+         25741,  25348,  25015,  24793,  24715,  24793,  25015,  25348,  25741,  26136,
+         26471,  26696,  26775,  26695,  26467,  26123,  25715,  25304,  24953,  24716,
+         24632,  24717,  24962,  25331,  25773,  26220,  26605,  26865,  26958,  26863,
+         26589,  26171,  25669,  25157,  24714,  24411,  24303,  24415,  24742,  25243,
+         25852,  26479,  27028,  27406,  27543,  27399,  26975,  26315,  25502,  24651,
+         23894,  23362,  23166,  23378,  24018,  25041,  26340,  27747,  29049,  30005,
+         30375,  29939,  28529,  26044,  22469,  17879,  12436,   6379,      0,  -6379,
+        -12436, -17879, -22469, -26044, -28529, -29939, -30375, -30005, -29049, -27747,
+        -26340, -25041, -24018, -23378, -23166, -23362, -23894, -24651, -25502, -26315,
+        -26975, -27399, -27543, -27406, -27028, -26479, -25852, -25243, -24742, -24415,
+        -24303, -24411, -24714, -25157, -25669, -26171, -26589, -26863, -26958, -26865,
+        -26605, -26220, -25773, -25331, -24962, -24717, -24632, -24716, -24953, -25304,
+        -25715, -26123, -26467, -26695, -26775, -26696, -26471, -26136, -25741, -25348,
+        -25015, -24793, -24715, -24793, -25015, -25348, -25741, -26136, -26471, -26696,
+        -26775, -26695, -26467, -26123, -25715, -25304, -24953, -24716, -24632, -24717,
+        -24962, -25331, -25773, -26220, -26605, -26865, -26958, -26863, -26589, -26171,
+        -25669, -25157, -24714, -24411, -24303, -24415, -24742, -25243, -25852, -26479,
+        -27028, -27406, -27543, -27399, -26975, -26315, -25502, -24651, -23894, -23362,
+        -23166, -23378, -24018, -25041, -26340, -27747, -29049, -30005, -30375, -29939,
+        -28529, -26044, -22469, -17879, -12436,  -6379,      0,
+    },
+    /* Level 4: 8 harmonics */
+    {
+             0,   3210,   6380,   9469,  12441,  15260,  17894,  20315,  22501,  24432,
+         26097,  27489,  28605,  29450,  30033,  30369,  30476,  30377,  30098,  29667,
+         29115,  28471,  27768,  27036,  26303,  25597,  24941,  24356,  23859,  23463,
+         23177,  23006,  22949,  23004,  23163,  23415,  23748,  24145,  24590,  25064,
+         25549,  26025,  26477,  26887,  27241,  27528,  27739,  27867,  27910,  27867,
+         27743,  27543,  27276,  26953,  26587,  26192,  25783,  25377,  24988,  24631,
+         24318,  24063,  23873,  23756,  23717,  23756,  23873,  24063,  24318,  24631,
+         24988,  25377,  25783,  26192,  26587,  26953,  27276,  27543,  27743,  27867,
+         27910,  27867,  27739,  27528,  27241,  26887,  26477,  26025,  25549,  25064,
+         24590,  24145,  23748,  23415,  23163,  23004,  22949,  23006,  23177,  23463,
+         23859,  24356,  24941,  25597,  26303,  27036,  27768,  28471,  29115,  29667,
+         30098,  30377,  30476,  30369,  30033,  29450,  28605,  27489,  26097,  24432,
+         22501,  20315,  17894,  15260,  12441,   9469,   6380,   3210,      0,  -3210,
+         -6380,  -9469, -12441, -15260, -17894, -20315, -22501, -24432, -26097, -27489,
+        -28605, -29450, -30033, -30369, -30476, -30377, -30098, -29667, -29115, -28471,
+        -27768, -27036, -26303, -25597, -24941, -24356, -23859, -23463, -23177, -23006,
+        -22949, -23004, -23163, -23415, -23748, -24145, -24590, -25064, -25549, -26025,
+        -26477, -26887, -27241, -27528, -27739, -27867, -27910, -27867, -27743, -27543,
+        -27276, -26953, -26587, -26192, -25783, -25377, -24988, -24631, -24318, -24063,
+        -23873, -23756, -23717, -23756, -23873, -24063, -24318, -24631, -24988, -25377,
+        -25783, -26192, -26587, -26953, -27276, -27543, -27743, -27867, -27910, -27867,
+        -27739, -27528, -27241, -26887, -26477, -26025, -25549, -25064, -24590, -24145,
+        -23748, -23415, -23163, -23004, -22949, -23006, -23177, -23463, -23859, -24356,
+        -24941, -25597, -26303, -27036, -27768, -28471, -29115, -29667, -30098, -30377,
+        -30476, -30369, -30033, -29450, -28605, -27489, -26097, -24432, -22501, -20315,
+        -17894, -15260, -12441,  -9469,  -6380,  -3210,      0,
+    },
+    /* Level 5: 4 harmonics */
+    {
+             0,   1608,   3210,   4804,   6382,   7942,   9478,  10986,  12461,  13899,
+         15297,  16650,  17955,  19208,  20407,  21549,  22630,  23650,  24605,  25494,
+         26316,  27070,  27755,  28370,  28917,  29394,  29803,  30145,  30420,  30630,
+         30778,  30865,  30893,  30866,  30785,  30655,  30478,  30258,  29998,  29703,
+         29376,  29020,  28641,  28242,  27827,  27401,  26967,  26530,  26093,  25661,
+         25236,  24824,  24427,  24049,  23692,  23360,  23056,  22781,  22539,  22330,
+         22157,  22021,  21923,  21864,  21845,  21864,  21923,  22021,  22157,  22330,
+         22539,  22781,  23056,  23360,  23692,  24049,  24427,  24824,  25236,  25661,
+         26093,  26530,  26967,  27401,  27827,  28242,  28641,  29020,  29376,  29703,
+         29998,  30258,  30478,  30655,  30785,  30866,  30893,  30865,  30778,  30630,
+         30420,  30145,  29803,  29394,  28917,  28370,  27755,  27070,  26316,  25494,
+         24605,  23650,  22630,  21549,  20407,  19208,  17955,  16650,  15297,  13899,
+         12461,  10986,   9478,   7942,   6382,   4804,   3210,   1608,      0,  -1608,
+         -3210,  -4804,  -6382,  -7942,  -9478, -10986, -12461, -13899, -15297, -16650,
+        -17955, -19208, -20407, -21549, -22630, -23650, -24605, -25494, -26316, -27070,
+        -27755, -28370, -28917, -29394, -29803, -30145, -30420, -30630, -30778, -30865,
+        -30893, -30866, -30785, -30655, -30478, -30258, -29998, -29703, -29376, -29020,
+        -28641, -28242, -27827, -27401, -26967, -26530, -26093, -25661, -25236, -24824,
+        -24427, -24049, -23692, -23360, -23056, -22781, -22539, -22330, -22157, -22021,
+        -21923, -21864, -21845, -21864, -21923, -22021, -22157, -22330, -22539, -22781,
+        -23056, -23360, -23692, -24049, -24427, -24824, -25236, -25661, -26093, -26530,
+        -26967, -27401, -27827, -28242, -28641, -29020, -29376, -29703, -29998, -30258,
+        -30478, -30655, -30785, -30866, -30893, -30865, -30778, -30630, -30420, -30145,
+        -29803, -29394, -28917, -28370, -27755, -27070, -26316, -25494, -24605, -23650,
+        -22630, -21549, -20407, -19208, -17955, -16650, -15297, -13899, -12461, -10986,
+         -9478,  -7942,  -6382,  -4804,  -3210,  -1608,      0,
+    },
+    /* Level 6: 2 harmonics */
+    {
+             0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,
+          7962,   8739,   9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,
+         15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,
+         22005,  22594,  23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+         27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,  30273,  30571,
+         30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+         32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,
+         32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+         30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,
+         26319,  25832,  25329,  24811,  24279,  23731,  23170,  22594,  22005,  21403,
+         20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,
+         14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+          6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,
+         -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,
+         -9512, -10278, -11039, -11793, -12539, -13279, -14010, -14732, -15446, -16151,
+        -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+        -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683,
+        -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+        -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678,
+        -32728, -32757, -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+        -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571, -30273, -29956,
+        -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832,
+        -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403, -20787, -20159,
+        -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+        -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,
+         -4808,  -4011,  -3212,  -2410,  -1608,   -804,      0,
+    },
+    /* Level 7: 1 harmonics */
+    {
+             0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,
+          7962,   8739,   9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,
+         15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,
+         22005,  22594,  23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+         27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,  30273,  30571,
+         30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+         32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,
+         32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+         30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,
+         26319,  25832,  25329,  24811,  24279,  23731,  23170,  22594,  22005,  21403,
+         20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,
+         14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+          6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,
+         -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,
+         -9512, -10278, -11039, -11793, -12539, -13279, -14010, -14732, -15446, -16151,
+        -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+        -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683,
+        -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+        -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678,
+        -32728, -32757, -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+        -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571, -30273, -29956,
+        -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832,
+        -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403, -20787, -20159,
+        -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+        -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,
+         -4808,  -4011,  -3212,  -2410,  -1608,   -804,      0,
+    },
+};
+
+#endif /* PICOSYNTH_WAVETABLES_H_ */
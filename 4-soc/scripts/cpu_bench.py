@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Standard CPU benchmarks on the 4-soc Verilator model
+
+Runs the CoreMark-style and Dhrystone-style programs (csrc/coremark.c,
+csrc/dhrystone.c) and the picosynth microbenchmark (csrc/picosynth-bench.c)
+headless on verilog/verilator/obj_dir/VTop, parses the BENCH lines they print
+(csrc/bench.h) and writes one row per line as CSV and JSON:
+
+    program, iterations, cycles, instret, cpi, metric, score, valid
+
+Scores come from CPU cycles only: CoreMark/MHz = iterations * 10^6 / cycles,
+DMIPS/MHz = runs * 10^6 / cycles / 1757, and cycles/sample for each
+picosynth case. The exit status is non-zero when a program fails to report
+or reports an invalid run.
+
+Usage:
+    python3 scripts/cpu_bench.py [--csv FILE] [--json FILE]
+"""
+
+import argparse
+import csv
+import json
+import re
+import subprocess
+import sys
+from pathlib import Path
+from typing import Dict, List
+
+STAGE_DIR = Path(__file__).resolve().parent.parent
+MODEL = STAGE_DIR / 'verilog/verilator/obj_dir/VTop'
+
+# Program and the name of its score
+BENCHMARKS: Dict[str, str] = {
+    'coremark': 'CoreMark/MHz',
+    'dhrystone': 'DMIPS/MHz',
+    'picosynth-bench': 'cycles/sample',
+}
+
+# Dhrystones per second of the VAX 11/780, the 1 DMIPS reference
+VAX_DHRYSTONES = 1757
+
+BENCH_LINE = re.compile(
+    r'^BENCH (\S+) iterations=(\d+) cycles=(\d+) instret=(\d+) valid=([01])', re.MULTILINE)
+
+FIELDS = ['program', 'iterations', 'cycles', 'instret', 'cpi', 'metric', 'score', 'valid']
+
+
+def score(program: str, iterations: int, cycles: int) -> float:
+    if program == 'picosynth-bench':
+        return cycles / iterations if iterations else 0.0
+    per_mhz = iterations * 1e6 / cycles if cycles else 0.0
+    if program == 'dhrystone':
+        per_mhz /= VAX_DHRYSTONES
+    return per_mhz
+
+
+def run(program: str) -> List[Dict[str, object]]:
+    """One row per BENCH line; single-result programs name it after themselves."""
+    binary = STAGE_DIR / 'csrc' / f'{program}.asmbin'
+    result = subprocess.run(
+        [str(MODEL), '-i', str(binary), '--headless', '--uart-fast', '--fast-clock'],
+        cwd=MODEL.parent, capture_output=True, text=True)
+    rows = []
+    for match in BENCH_LINE.finditer(result.stdout):
+        iterations, cycles, instret = (int(match.group(i)) for i in (2, 3, 4))
+        rows.append({
+            'program': match.group(1),
+            'iterations': iterations,
+            'cycles': cycles,
+            'instret': instret,
+            'cpi': round(cycles / instret, 4) if instret else 0.0,
+            'metric': BENCHMARKS[program],
+            'score': round(score(program, iterations, cycles), 4),
+            'valid': match.group(5) == '1',
+        })
+    return rows
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Standard CPU benchmarks on the 4-soc model.')
+    parser.add_argument('--csv', default='bench-results.csv', help='CSV output')
+    parser.add_argument('--json', default='bench-results.json', help='JSON output')
+    args = parser.parse_args()
+
+    if not MODEL.exists():
+        sys.exit('no VTop built; run "make verilator"')
+
+    results: List[Dict[str, object]] = []
+    failed = False
+    for program in BENCHMARKS:
+        rows = run(program)
+        if not rows:
+            sys.stderr.write(f'{program}: no BENCH line\n')
+            failed = True
+        for row in rows:
+            if not row['valid']:
+                sys.stderr.write(f"{row['program']}: result check failed\n")
+                failed = True
+        results.extend(rows)
+
+    with open(args.csv, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=FIELDS)
+        writer.writeheader()
+        writer.writerows(results)
+    with open(args.json, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+
+    print('| Program | Iterations | Cycles | CPI | Score |')
+    print('|---|---:|---:|---:|---:|')
+    for row in results:
+        print(f"| {row['program']} | {row['iterations']} | {row['cycles']:,} | {row['cpi']:.3f} | "
+              f"{row['score']:.3f} {row['metric']} |")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
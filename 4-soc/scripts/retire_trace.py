@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Offline analysis of the retire traces written by "VTop --retire-trace"
+
+    stats   instruction mix, hottest basic blocks (by cycles) and load/store
+            reuse distance, counted in distinct --line sized blocks touched
+            in between
+    diff    compares the trace with a reference, in lockstep, and reports the
+            first divergence with the instructions leading up to it
+
+A diff reference is either another retire trace, in which case rd values and
+memory addresses are compared too, or a text log with one instruction per
+line: the first 0x-prefixed number is the PC and an optional second one the
+instruction word, as in spike -l or an rv32emu trace of the same program.
+Reference lines before the trace's first PC (boot code) and NOPs, which the
+CPU does not trace, are skipped. Files ending in .zst are read through
+"zstd -dc".
+
+Usage:
+    python3 scripts/retire_trace.py stats trace.bin.zst [--top 20] [--line 64]
+    python3 scripts/retire_trace.py diff trace.bin.zst reference.log
+"""
+
+import argparse
+import collections
+import re
+import subprocess
+import sys
+from typing import BinaryIO, Dict, Iterator, List, NamedTuple, Optional, Tuple
+
+MAGIC = b'MYCPURT1'
+PC_JUMP, CYCLES, INSN, RD, MEM = 1, 2, 4, 8, 16
+INSN_TABLE_SIZE = 4096
+NOP = 0x00000013
+MASK = 0xFFFFFFFF
+
+
+class Record(NamedTuple):
+    cycle: int
+    pc: int
+    instruction: int
+    rd: Optional[int]           # None when no register was written
+    rd_data: int
+    mem_address: Optional[int]  # loads and stores only
+
+
+def open_input(path: str) -> BinaryIO:
+    if path.endswith('.zst'):
+        return subprocess.Popen(['zstd', '-dc', path], stdout=subprocess.PIPE).stdout
+    return open(path, 'rb')
+
+
+def read_trace(path: str) -> Iterator[Record]:
+    """Decodes a retire trace; see common/sim/retire_trace.h for the format."""
+    data = open_input(path).read()
+    if data[:8] != MAGIC:
+        sys.exit(f'{path}: not a retire trace')
+    pos = 8
+
+    def varint() -> int:
+        nonlocal pos
+        value, shift = 0, 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+
+    def signed() -> int:
+        value = varint()
+        return (value >> 1) ^ -(value & 1)
+
+    pc, cycle, mem_address = 0xFFFFFFFC, 0, 0
+    regs = [0] * 32
+    table: List[Tuple[int, int]] = [(MASK, 0)] * INSN_TABLE_SIZE
+    while pos < len(data):
+        flags = data[pos]
+        pos += 1
+        pc = (pc + 4 + (signed() if flags & PC_JUMP else 0)) & MASK
+        cycle += 1 + (varint() if flags & CYCLES else 0)
+        slot = (pc >> 2) % INSN_TABLE_SIZE
+        if flags & INSN:
+            instruction = int.from_bytes(data[pos:pos + 4], 'little')
+            pos += 4
+            table[slot] = (pc, instruction)
+        else:
+            instruction = table[slot][1]
+        rd = None
+        if flags & RD:
+            rd = data[pos]
+            pos += 1
+            regs[rd] = (regs[rd] + signed()) & MASK
+        address = None
+        if flags & MEM:
+            mem_address = (mem_address + signed()) & MASK
+            address = mem_address
+        yield Record(cycle, pc, instruction, rd, regs[rd] if rd is not None else 0, address)
+
+
+def classify(instruction: int) -> str:
+    opcode = instruction & 0x7F
+    if opcode == 0x33 and instruction >> 25 == 1:
+        return 'mul/div'
+    return {
+        0x03: 'load', 0x23: 'store', 0x63: 'branch', 0x6F: 'jal', 0x67: 'jalr',
+        0x13: 'alu-imm', 0x33: 'alu', 0x37: 'lui', 0x17: 'auipc', 0x73: 'system',
+        0x0F: 'fence',
+    }.get(opcode, f'opcode 0x{opcode:02x}')
+
+
+class Fenwick:
+    def __init__(self, size: int) -> None:
+        self.tree = [0] * (size + 1)
+
+    def add(self, index: int, delta: int) -> None:
+        index += 1
+        while index < len(self.tree):
+            self.tree[index] += delta
+            index += index & -index
+
+    def prefix(self, index: int) -> int:
+        """Sum of entries [0, index)."""
+        total = 0
+        while index > 0:
+            total += self.tree[index]
+            index -= index & -index
+        return total
+
+
+def bucket(distance: Optional[int]) -> str:
+    if distance is None:
+        return 'cold'
+    if distance == 0:
+        return '0'
+    low = 1 << (distance.bit_length() - 1)
+    return f'{low}-{2 * low - 1}' if low > 1 else '1'
+
+
+def stats(args: argparse.Namespace) -> None:
+    mix: Dict[str, int] = collections.Counter()
+    blocks: Dict[int, List[int]] = {}  # start pc -> [executions, instructions, cycles]
+    accesses: List[Tuple[str, int]] = []
+    block: Optional[List[int]] = None
+    first_cycle, last_cycle, previous_pc, total = None, 0, None, 0
+    for record in read_trace(args.trace):
+        total += 1
+        mix[classify(record.instruction)] += 1
+        if first_cycle is None:
+            first_cycle = record.cycle
+        if block is None or record.pc != previous_pc + 4:
+            block = blocks.setdefault(record.pc, [0, 0, 0])
+            block[0] += 1
+        block[1] += 1
+        block[2] += record.cycle - last_cycle if last_cycle else 1
+        last_cycle, previous_pc = record.cycle, record.pc
+        if record.mem_address is not None:
+            kind = 'store' if record.instruction & 0x7F == 0x23 else 'load'
+            accesses.append((kind, record.mem_address // args.line))
+    if not total:
+        sys.exit(f'{args.trace}: empty trace')
+
+    cycles = last_cycle - first_cycle + 1
+    print(f'{total} instructions over {cycles} cycles (CPI {cycles / total:.3f})\n')
+    print('| Class | Count | Share |')
+    print('|---|---:|---:|')
+    for name, count in sorted(mix.items(), key=lambda item: -item[1]):
+        print(f'| {name} | {count} | {100.0 * count / total:.1f}% |')
+
+    print('\n| Block | Executions | Instructions | Cycles | Share |')
+    print('|---|---:|---:|---:|---:|')
+    for start, (executions, instructions, block_cycles) in sorted(
+            blocks.items(), key=lambda item: -item[1][2])[:args.top]:
+        print(f'| 0x{start:08x} | {executions} | {instructions} | {block_cycles} '
+              f'| {100.0 * block_cycles / cycles:.1f}% |')
+
+    # Reuse distance: distinct blocks touched since the previous access to the
+    # same block, i.e. live "last access" marks between the two positions
+    histogram: Dict[str, Dict[str, int]] = {'load': collections.Counter(),
+                                            'store': collections.Counter()}
+    marks = Fenwick(len(accesses))
+    last: Dict[int, int] = {}
+    for position, (kind, line) in enumerate(accesses):
+        previous = last.get(line)
+        distance = None
+        if previous is not None:
+            distance = marks.prefix(position) - marks.prefix(previous + 1)
+            marks.add(previous, -1)
+        marks.add(position, 1)
+        last[line] = position
+        histogram[kind][bucket(distance)] += 1
+
+    order = ['0', '1'] + [f'{1 << n}-{(2 << n) - 1}' for n in range(1, 32)] + ['cold']
+    print(f'\n| Reuse distance ({args.line}-byte blocks) | Loads | Stores |')
+    print('|---|---:|---:|')
+    for name in order:
+        loads, stores = histogram['load'][name], histogram['store'][name]
+        if loads or stores:
+            print(f'| {name} | {loads} | {stores} |')
+
+
+def read_log(path: str) -> Iterator[Tuple[int, Optional[int]]]:
+    """(pc, instruction or None) for each line of a text reference trace."""
+    number = re.compile(r'0x([0-9a-fA-F]+)')
+    with open_input(path) as f:
+        for line in f:
+            fields = number.findall(line.decode(errors='replace'))
+            if fields:
+                yield int(fields[0], 16) & MASK, int(fields[1], 16) & MASK if len(fields) > 1 else None
+
+
+def diff(args: argparse.Namespace) -> None:
+    with open_input(args.reference) as f:
+        binary = f.read(8) == MAGIC
+    trace = read_trace(args.trace)
+    if binary:
+        reference = ((r.pc, r.instruction, r) for r in read_trace(args.reference))
+    else:
+        reference = ((pc, instruction, None) for pc, instruction in read_log(args.reference)
+                     if instruction != NOP)
+
+    history: collections.deque = collections.deque(maxlen=args.context)
+    matched = 0
+    record = next(trace, None)
+    if record is None:
+        sys.exit(f'{args.trace}: empty trace')
+    expected = next(reference, None)
+    while expected is not None and expected[0] != record.pc:
+        expected = next(reference, None)
+    if expected is None:
+        sys.exit(f'reference never reaches 0x{record.pc:08x}')
+
+    while record is not None and expected is not None:
+        pc, instruction, other = expected
+        problem = None
+        if record.pc != pc:
+            problem = f'pc 0x{record.pc:08x}, reference 0x{pc:08x}'
+        elif instruction is not None and record.instruction != instruction:
+            problem = f'instruction 0x{record.instruction:08x}, reference 0x{instruction:08x}'
+        elif other is not None and (record.rd, record.rd_data) != (other.rd, other.rd_data):
+            problem = f'rd x{record.rd}=0x{record.rd_data:08x}, reference x{other.rd}=0x{other.rd_data:08x}'
+        elif other is not None and record.mem_address != other.mem_address:
+            problem = f'address {record.mem_address}, reference {other.mem_address}'
+        if problem:
+            print(f'Divergence after {matched} instructions, at cycle {record.cycle}: {problem}')
+            for earlier in history:
+                print(f'  0x{earlier.pc:08x}: 0x{earlier.instruction:08x}')
+            print(f'> 0x{record.pc:08x}: 0x{record.instruction:08x}')
+            sys.exit(1)
+        history.append(record)
+        matched += 1
+        record, expected = next(trace, None), next(reference, None)
+
+    if record is not None:
+        print(f'{matched} instructions match; the reference ends first')
+    else:
+        print(f'{matched} instructions match' + ('; the trace ends first' if expected else ''))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Analyse 4-soc retire traces.')
+    commands = parser.add_subparsers(dest='command', required=True)
+    parser_stats = commands.add_parser('stats', help='instruction mix, hot blocks, reuse distance')
+    parser_stats.add_argument('trace')
+    parser_stats.add_argument('--top', type=int, default=20, help='basic blocks to list')
+    parser_stats.add_argument('--line', type=int, default=64, help='reuse distance granularity in bytes')
+    parser_diff = commands.add_parser('diff', help='lockstep comparison with a reference trace')
+    parser_diff.add_argument('trace')
+    parser_diff.add_argument('reference')
+    parser_diff.add_argument('--context', type=int, default=8, help='instructions shown before a divergence')
+    args = parser.parse_args()
+    if args.command == 'stats':
+        stats(args)
+    else:
+        diff(args)
+
+
+if __name__ == '__main__':
+    main()
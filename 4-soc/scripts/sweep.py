@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Design-space sweep over 4-soc Parameters
+
+Builds one Verilator model per point of a parameter matrix and runs every
+program on every model, spread over the host's cores. Each -p option lists
+the values of one Parameters knob (see the MYCPU_PARAMS note in
+Parameters.scala); the sweep covers their cartesian product:
+
+    python3 scripts/sweep.py -p BTBEntries=16,32,64 -p DividerRadix4=true,false \\
+        coremark dhrystone csrc/picosynth-bench.asmbin
+
+Models are cached in sweep/<key>/, where the key hashes the configuration
+and the Scala, harness and shared simulator sources, so an unchanged point is
+never rebuilt. Verilog generation runs one sbt at a time; the C++ builds and
+the simulations run --jobs at a time. Each run is a one-program --batch of
+the harness, and its report line (stop reason, exit status, performance
+counters) becomes one row of the comparison table, which is printed as
+Markdown and written as CSV and JSON. Cycle ratios are against the first
+configuration.
+
+Programs are csrc names (built by "make sweep") or .asmbin/.elf paths.
+
+Usage:
+    python3 scripts/sweep.py -p NAME=V1,V2 [...] [--cycles N] [--jobs J]
+        [--csv FILE] [--json FILE] program...
+"""
+
+import argparse
+import csv
+import hashlib
+import itertools
+import json
+import os
+import shutil
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+STAGE_DIR = Path(__file__).resolve().parent.parent
+ROOT_DIR = STAGE_DIR.parent
+CACHE_DIR = STAGE_DIR / 'sweep'
+SIM_SOURCE = STAGE_DIR / 'verilog/verilator/sim.cpp'
+SIM_COMMON_DIR = ROOT_DIR / 'common/sim'
+
+# Everything a model is built from, besides its configuration
+SOURCES = [STAGE_DIR / 'src/main/scala', ROOT_DIR / 'common/src/main/scala', SIM_SOURCE, SIM_COMMON_DIR]
+
+# Report members shown in the table (all of them go to CSV and JSON)
+COLUMNS = [('cycles', 'Cycles'), ('instret', 'Instret'), ('cpi', 'CPI'), ('branch_mpki', 'Branch MPKI'),
+           ('icache_misses', 'I$ misses'), ('dcache_misses', 'D$ misses')]
+
+Config = Tuple[Tuple[str, str], ...]
+
+
+def parse_matrix(options: List[str]) -> List[Config]:
+    axes = []
+    for option in options:
+        name, sep, values = option.partition('=')
+        if not sep or not values:
+            sys.exit(f'-p {option}: expected NAME=V1,V2,...')
+        axes.append([(name.strip(), value.strip()) for value in values.split(',')])
+    return [tuple(point) for point in itertools.product(*axes)]
+
+
+def label(config: Config) -> str:
+    return ','.join(f'{name}={value}' for name, value in config) or 'default'
+
+
+def source_digest() -> str:
+    digest = hashlib.sha256()
+    for source in SOURCES:
+        files = sorted(source.rglob('*')) if source.is_dir() else [source]
+        for path in files:
+            if path.is_file():
+                digest.update(str(path.relative_to(ROOT_DIR)).encode())
+                digest.update(path.read_bytes())
+    return digest.hexdigest()
+
+
+def model_dir(config: Config, sources: str) -> Path:
+    key = hashlib.sha256(f'{sources}\n{label(config)}'.encode()).hexdigest()[:16]
+    return CACHE_DIR / key
+
+
+def generate(config: Config, build: Path) -> bool:
+    """Elaborates Top into build/Top.v with the configuration applied."""
+    build.mkdir(parents=True, exist_ok=True)
+    env = dict(os.environ, MYCPU_PARAMS=label(config) if config else '')
+    env['PATH'] = f"{Path.home() / '.local/bin'}:{env.get('PATH', '')}"
+    result = subprocess.run(
+        ['sbt', 'project soc', f'runMain board.verilator.VerilogGenerator {build}'],
+        cwd=ROOT_DIR, env=env, capture_output=True, text=True)
+    (build / 'generate.log').write_text(result.stdout + result.stderr)
+    return result.returncode == 0 and (build / 'Top.v').exists()
+
+
+def compile_model(build: Path) -> bool:
+    """Verilates build/Top.v with the harness into build/obj_dir/VTop."""
+    sdl_cflags = subprocess.run(['sdl2-config', '--cflags'], capture_output=True, text=True).stdout.strip()
+    sdl_libs = subprocess.run(['sdl2-config', '--libs'], capture_output=True, text=True).stdout.strip()
+    log = open(build / 'build.log', 'w')
+    result = subprocess.run(
+        ['verilator', '--exe', '--cc', str(SIM_SOURCE), 'Top.v',
+         '-CFLAGS', f'{sdl_cflags} -I. -I{SIM_COMMON_DIR}', '-LDFLAGS', f'{sdl_libs} -pthread'],
+        cwd=build, stdout=log, stderr=subprocess.STDOUT)
+    if result.returncode == 0:
+        result = subprocess.run(['make', '-s', '-C', 'obj_dir', '-f', 'VTop.mk'],
+                                cwd=build, stdout=log, stderr=subprocess.STDOUT)
+    log.close()
+    return result.returncode == 0 and (build / 'obj_dir/VTop').exists()
+
+
+def resolve(program: str) -> Path:
+    path = Path(program)
+    if path.suffix in ('.asmbin', '.elf'):
+        return path.resolve()
+    return STAGE_DIR / 'csrc' / f'{program}.asmbin'
+
+
+def run(model: Path, binary: Path, cycles: int) -> Optional[Dict[str, object]]:
+    """One harness run in its own directory; returns its batch report line."""
+    work = model.parent.parent / 'runs' / binary.stem
+    shutil.rmtree(work, ignore_errors=True)
+    work.mkdir(parents=True)
+    (work / 'job.manifest').write_text(f'{binary} cycles={2 * cycles} wav={binary.stem}.wav\n')
+    env = dict(os.environ, SDL_VIDEODRIVER='dummy', SDL_AUDIODRIVER='dummy')
+    with open(work / 'run.log', 'w') as log:
+        subprocess.run([str(model), '--headless', '--fast-clock', '--batch', 'job.manifest',
+                        '--report', 'report.jsonl'], cwd=work, env=env, stdout=log, stderr=subprocess.STDOUT)
+    report = work / 'report.jsonl'
+    lines = report.read_text().splitlines() if report.exists() else []
+    return json.loads(lines[-1]) if lines else None
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Parameter sweep over 4-soc Verilator models.')
+    parser.add_argument('-p', '--param', action='append', default=[], metavar='NAME=V1,V2',
+                        help='Parameters knob and its values (repeatable)')
+    parser.add_argument('--cycles', type=int, default=250000000, help='CPU cycle limit per run')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count() or 1, help='parallel builds and runs')
+    parser.add_argument('--csv', default='sweep-results.csv', help='CSV output')
+    parser.add_argument('--json', default='sweep-results.json', help='JSON output')
+    parser.add_argument('programs', nargs='+', help='csrc program names or .asmbin/.elf paths')
+    args = parser.parse_args()
+
+    configs = parse_matrix(args.param)
+    binaries = [resolve(program) for program in args.programs]
+    missing = [str(b) for b in binaries if not b.exists()]
+    if missing:
+        sys.exit(f'missing programs: {", ".join(missing)} (make -C csrc <name>.asmbin)')
+
+    sources = source_digest()
+    builds = {config: model_dir(config, sources) for config in configs}
+    todo = [config for config in configs if not (builds[config] / 'obj_dir/VTop').exists()]
+    print(f'{len(configs)} configurations ({len(configs) - len(todo)} cached), '
+          f'{len(binaries)} programs, {args.jobs} jobs')
+
+    # sbt holds a lock on the project, so elaboration is serial; each model
+    # compiles while the next one is being generated
+    failed = set()
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        compiles = {}
+        for config in todo:
+            print(f'  generating {label(config)}')
+            if not generate(config, builds[config]):
+                sys.stderr.write(f'{label(config)}: Verilog generation failed, see '
+                                 f'{builds[config] / "generate.log"}\n')
+                failed.add(config)
+                continue
+            (builds[config] / 'config.txt').write_text(label(config) + '\n')
+            compiles[config] = pool.submit(compile_model, builds[config])
+        for config, future in compiles.items():
+            if not future.result():
+                sys.stderr.write(f'{label(config)}: build failed, see {builds[config] / "build.log"}\n')
+                failed.add(config)
+
+        jobs = [(config, binary) for config in configs if config not in failed for binary in binaries]
+        reports = pool.map(lambda job: run(builds[job[0]] / 'obj_dir/VTop', job[1], args.cycles), jobs)
+        results: List[Dict[str, object]] = []
+        for (config, binary), report in zip(jobs, reports):
+            if report is None:
+                sys.stderr.write(f'{label(config)}: {binary.stem} did not report\n')
+                failed.add(config)
+                continue
+            row: Dict[str, object] = {'config': label(config), 'program': binary.stem}
+            row.update(dict(config))
+            row.update({k: v for k, v in report.items() if k != 'program'})
+            results.append(row)
+
+    baseline = {row['program']: row['cycles'] for row in results if row['config'] == label(configs[0])}
+    for row in results:
+        base = baseline.get(row['program'])
+        row['vs_first'] = round(row['cycles'] / base, 4) if base else None
+
+    fields = list(dict.fromkeys(key for row in results for key in row))
+    with open(args.csv, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(results)
+    with open(args.json, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+
+    print('\n| Program | Configuration | Stop | ' + ' | '.join(title for _, title in COLUMNS) + ' | vs first |')
+    print('|---|---|---|' + '---:|' * (len(COLUMNS) + 1))
+    for row in sorted(results, key=lambda r: str(r['program'])):
+        cells = [f'{row[key]:.3f}' if isinstance(row[key], float) else f'{row[key]:,}' for key, _ in COLUMNS]
+        ratio = f"{row['vs_first']:.3f}x" if row['vs_first'] else '-'
+        print(f"| {row['program']} | {row['config']} | {row['stop']} | " + ' | '.join(cells) + f' | {ratio} |')
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Simulation throughput benchmark for the 4-soc Verilator builds
+
+Runs nyancat (VGA on, SDL dummy drivers) and picosynth-hw (headless) for a
+fixed number of CPU cycles on each build profile and prints CPU cycles per
+host second, taking the median of --repeat runs. Profiles whose VTop has not
+been built are skipped:
+
+    default   verilog/verilator/obj_dir       (make verilator)
+    fast      verilog/verilator/obj_dir_fast  (make verilator-fast)
+
+Usage:
+    python3 scripts/throughput_bench.py [--cycles N] [--repeat R]
+"""
+
+import argparse
+import os
+import re
+import statistics
+import subprocess
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional
+
+STAGE_DIR = Path(__file__).resolve().parent.parent
+
+PROFILES: Dict[str, str] = {
+    'default': 'verilog/verilator/obj_dir',
+    'fast': 'verilog/verilator/obj_dir_fast',
+}
+
+# Program and the harness options it runs with
+WORKLOADS: Dict[str, List[str]] = {
+    'nyancat': [],
+    'picosynth-hw': ['--headless'],
+}
+
+# "⏱️  <cycles> CPU cycles in <seconds> s (<khz> kHz simulated)"
+SUMMARY = re.compile(r'(\d+) CPU cycles in ([0-9.e+-]+) s')
+
+
+def run(model: Path, program: str, options: List[str], cycles: int) -> Optional[float]:
+    """Returns simulated CPU cycles per host second, or None on failure."""
+    env = dict(os.environ, SDL_VIDEODRIVER='dummy', SDL_AUDIODRIVER='dummy')
+    binary = STAGE_DIR / 'csrc' / f'{program}.asmbin'
+    # --cycles counts harness cycles, two per CPU cycle
+    result = subprocess.run(
+        [str(model), '-i', str(binary), '--fast-clock', '--cycles', str(2 * cycles),
+         '--wav', f'bench-{program}.wav'] + options,
+        cwd=model.parent, env=env, capture_output=True, text=True)
+    match = SUMMARY.search(result.stdout)
+    if not match or float(match.group(2)) <= 0:
+        sys.stderr.write(f'{model}: {program} failed (exit {result.returncode})\n')
+        return None
+    return int(match.group(1)) / float(match.group(2))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Throughput of the 4-soc Verilator build profiles.')
+    parser.add_argument('--cycles', type=int, default=5000000, help='CPU cycles per run')
+    parser.add_argument('--repeat', type=int, default=3, help='runs per measurement (median)')
+    args = parser.parse_args()
+
+    models = {name: STAGE_DIR / path / 'VTop' for name, path in PROFILES.items()}
+    models = {name: model for name, model in models.items() if model.exists()}
+    if not models:
+        sys.exit('no VTop built; run "make verilator" and/or "make verilator-fast"')
+
+    print(f'{args.cycles} CPU cycles per run, median of {args.repeat}\n')
+    print('| Program | Profile | CPU cycles/s | vs default |')
+    print('|---|---|---:|---:|')
+    failed = False
+    for program, options in WORKLOADS.items():
+        baseline = None
+        for name, model in models.items():
+            rates = [run(model, program, options, args.cycles) for _ in range(args.repeat)]
+            if None in rates:
+                failed = True
+                continue
+            rate = statistics.median(rates)
+            if name == 'default':
+                baseline = rate
+            speedup = f'{rate / baseline:.2f}x' if baseline else '-'
+            print(f'| {program} | {name} | {rate:,.0f} | {speedup} |')
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
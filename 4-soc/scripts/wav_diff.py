@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Sample-by-sample comparison of two 16-bit mono WAV files
+
+The audio stream of an RTL simulation ("VTop --wav") is compared with the
+golden model rendered by csrc/picosynth-render. The streams match when their
+lengths differ by at most --tolerance samples and every sample both hold is
+equal; an empty comparison never matches. The first differing samples are
+listed with their time.
+
+Usage:
+    python3 scripts/wav_diff.py output.wav reference.wav [--tolerance 0] [--show 8]
+"""
+
+import argparse
+import array
+import sys
+import wave
+
+
+def read_samples(path: str) -> 'tuple[array.array, int]':
+    with wave.open(path, 'rb') as f:
+        if f.getsampwidth() != 2 or f.getnchannels() != 1:
+            sys.exit(f'{path}: not 16-bit mono')
+        samples = array.array('h', f.readframes(f.getnframes()))
+        if sys.byteorder == 'big':
+            samples.byteswap()
+        return samples, f.getframerate()
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('output', help='WAV of the simulation')
+    parser.add_argument('reference', help='WAV of the golden model')
+    parser.add_argument('--tolerance', type=int, default=0, help='samples the lengths may differ by')
+    parser.add_argument('--show', type=int, default=8, help='differing samples to list')
+    args = parser.parse_args()
+
+    output, rate = read_samples(args.output)
+    reference, reference_rate = read_samples(args.reference)
+    if rate != reference_rate:
+        print(f'sample rate {rate} Hz, reference {reference_rate} Hz')
+        return 1
+
+    common = min(len(output), len(reference))
+    if common == 0:
+        print(f'nothing to compare: {len(output)} samples, reference {len(reference)}')
+        return 1
+    diffs = [i for i in range(common) if output[i] != reference[i]]
+    for i in diffs[:args.show]:
+        print(f'sample {i} ({i / rate:.4f} s): {output[i]}, reference {reference[i]}')
+
+    if diffs:
+        peak = max(abs(output[i] - reference[i]) for i in diffs)
+        print(f'{len(diffs)} of {common} samples differ, first at {diffs[0]}, largest error {peak}')
+        return 1
+    if abs(len(output) - len(reference)) > args.tolerance:
+        print(f'{len(output)} samples, reference {len(reference)}: lengths differ by more than {args.tolerance}')
+        return 1
+    print(f'{common} samples match ({common / rate:.2f} s of {len(reference) / rate:.2f} s)')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
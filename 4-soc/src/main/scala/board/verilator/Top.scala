@@ -3,60 +3,86 @@ package board.verilator
 
 import bus.AXI4LiteSlave
 import bus.AXI4LiteSlaveBundle
-import bus.BusArbiter
 import bus.BusSwitch
 import chisel3._
 import chisel3.stage.ChiselStage
+import chisel3.util._
+import peripheral.DMA
 import peripheral.DummySlave
 import peripheral.Uart
 import peripheral.VGA
+import peripheral.VGAFramebufferWrite
 import peripheral.AudioPeripheral
 import peripheral.HWSynth
 import riscv.core.CPU
+import riscv.core.DebugWriteBundle
+import riscv.core.RetireBundle
 import riscv.Parameters
 
 class Top extends Module {
   val io = IO(new Bundle {
     val signal_interrupt = Input(Bool())
 
-    // Instruction interface (external ROM in testbench)
+    // Instruction interface (external ROM in testbench). With the instruction
+    // cache enabled, instructions are fetched over mem_slave instead and
+    // instruction_valid only enables fetching; instruction is then unused.
     val instruction_address = Output(UInt(Parameters.AddrWidth))
     val instruction         = Input(UInt(Parameters.InstructionWidth))
     val instruction_valid   = Input(Bool())
 
-    val mem_slave = new AXI4LiteSlaveBundle(Parameters.AddrBits, Parameters.DataBits)
+    val mem_slave       = new AXI4LiteSlaveBundle(Parameters.AddrBits, Parameters.DataBits)
+    val mem_write_ready = Input(Bool()) // RAM accepts a write beat (harness memory timing model)
 
     // VGA peripheral outputs
-    val vga_pixclk      = Input(Clock())     // VGA pixel clock (31.5 MHz)
-    val vga_hsync       = Output(Bool())     // Horizontal sync
-    val vga_vsync       = Output(Bool())     // Vertical sync
-    val vga_rrggbb      = Output(UInt(6.W))  // 6-bit color output
-    val vga_activevideo = Output(Bool())     // Active display region
-    val vga_x_pos       = Output(UInt(10.W)) // Current pixel X position
-    val vga_y_pos       = Output(UInt(10.W)) // Current pixel Y position
+    val vga_pixclk       = Input(Clock())     // VGA pixel clock (31.5 MHz)
+    val vga_hsync        = Output(Bool())     // Horizontal sync
+    val vga_vsync        = Output(Bool())     // Vertical sync
+    val vga_rrggbb       = Output(UInt(6.W))  // 6-bit color output
+    val vga_activevideo  = Output(Bool())     // Active display region
+    val vga_x_pos        = Output(UInt(10.W)) // Current pixel X position
+    val vga_y_pos        = Output(UInt(10.W)) // Current pixel Y position
+    val vga_vblank_armed = Output(Bool())     // Vblank interrupt will come (keeps WFI from counting as idle)
+    val vga_fb_write     = Output(Valid(new VGAFramebufferWrite)) // Framebuffer write (simulation sideband)
+    val vga_ctrl         = Output(UInt(32.W))                     // CTRL register (simulation sideband)
+    val vga_palette      = Output(Vec(16, UInt(6.W)))             // Palette (simulation sideband)
 
     // UART peripheral outputs
-    val uart_txd       = Output(UInt(1.W))   // UART TX data
-    val uart_rxd       = Input(UInt(1.W))    // UART RX data
-    val uart_interrupt = Output(Bool())      // UART interrupt signal
+    val uart_txd       = Output(UInt(1.W))               // UART TX data
+    val uart_rxd       = Input(UInt(1.W))                // UART RX data
+    val uart_interrupt = Output(Bool())                  // UART interrupt signal
+    val uart_tx_byte   = Output(Valid(UInt(8.W)))        // Byte accepted by TX (simulation sideband)
+    val uart_tx_busy   = Output(Bool())                  // TX byte pending (keeps WFI from counting as idle)
+    val uart_rx_inject = Flipped(Decoupled(UInt(8.W)))   // Byte pushed into RX FIFO (simulation sideband)
 
     // Audio peripheral outputs
     val audio_sample       = Output(UInt(16.W))
     val audio_sample_valid = Output(Bool())
+    val audio_pending      = Output(Bool())                    // Samples queued (keeps WFI from counting as idle)
+    val audio_underruns    = Output(UInt(Parameters.DataWidth)) // Sample ticks that found the FIFO empty
 
     // Hardware synth peripheral outputs
     val hwsynth_sample       = Output(SInt(16.W))
     val hwsynth_sample_valid = Output(Bool())
 
+    // DMA transfer in progress (keeps the harness from taking WFI for idle)
+    val dma_busy = Output(Bool())
+
     val cpu_debug_read_address     = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
     val cpu_debug_read_data        = Output(UInt(Parameters.DataWidth))
     val cpu_csr_debug_read_address = Input(UInt(Parameters.CSRRegisterAddrWidth))
     val cpu_csr_debug_read_data    = Output(UInt(Parameters.DataWidth))
+    val cpu_debug_write            = Input(new DebugWriteBundle) // State write (fast-forward)
+    val cpu_retire                 = Output(new RetireBundle) // Retired instruction (simulation sideband)
+    val cpu_retire_b               = Output(new RetireBundle) // Second of a dual-issue pair
   })
 
-  // AXI4-Lite memory model provided by Verilator C++ harness (sim.cpp)
-  val mem_slave = Module(new AXI4LiteSlave(Parameters.AddrBits, Parameters.DataBits))
+  // AXI4-Lite memory model provided by Verilator C++ harness (sim.cpp). It
+  // serves the caches' line bursts, one mem_slave access per word, and paces
+  // writes through mem_write_ready.
+  val mem_slave =
+    Module(new AXI4LiteSlave(Parameters.AddrBits, Parameters.DataBits, burst = true, writeReady = true))
   io.mem_slave <> mem_slave.io.bundle
+  mem_slave.io.write_ready.get := io.mem_write_ready
 
   // VGA peripheral
   val vga = Module(new VGA)
@@ -70,10 +96,12 @@ class Top extends Module {
   // Hardware synth peripheral
   val hwsynth = Module(new HWSynth)
 
-  val cpu         = Module(new CPU)
-  val dummy       = Module(new DummySlave)
-  val bus_arbiter = Module(new BusArbiter)
-  val bus_switch  = Module(new BusSwitch)
+  // DMA controller: register slave and second bus master
+  val dma = Module(new DMA)
+
+  val cpu        = Module(new CPU)
+  val dummy      = Module(new DummySlave)
+  val bus_switch = Module(new BusSwitch)
 
   // Instruction fetch (external ROM in testbench)
   io.instruction_address := cpu.io.instruction_address
@@ -87,9 +115,7 @@ class Top extends Module {
   cpu.io.memory_bundle.write_data_accepted := false.B
   cpu.io.memory_bundle.busy := false.B
   cpu.io.memory_bundle.granted := false.B
-
-  // Bus arbiter
-  bus_arbiter.io.bus_request(0) := true.B
+  cpu.io.memory_bundle.write_beat := false.B
 
   // Bus switch
   bus_switch.io.master <> cpu.io.axi4_channels
@@ -99,8 +125,9 @@ class Top extends Module {
   bus_switch.io.slaves(2) <> uart.io.channels
   bus_switch.io.slaves(3) <> audio.io.channels
   bus_switch.io.slaves(4) <> hwsynth.io.channels
+  bus_switch.io.slaves(5) <> dma.io.channels
 
-  for (i <- 5 until Parameters.SlaveDeviceCount) {
+  for (i <- 6 until Parameters.SlaveDeviceCount) {
     bus_switch.io.slaves(i) <> dummy.io.channels
   }
 
@@ -112,33 +139,61 @@ class Top extends Module {
   io.vga_activevideo := vga.io.activevideo
   io.vga_x_pos := vga.io.x_pos
   io.vga_y_pos := vga.io.y_pos
+  io.vga_vblank_armed := vga.io.vblank_armed
+  io.vga_fb_write := vga.io.fb_write
+  io.vga_ctrl := vga.io.ctrl
+  io.vga_palette := vga.io.palette
 
   // UART connections
   io.uart_txd := uart.io.txd
   uart.io.rxd := io.uart_rxd
   io.uart_interrupt := uart.io.signal_interrupt
+  io.uart_tx_byte := uart.io.tx_byte
+  io.uart_tx_busy := uart.io.tx_busy
+  uart.io.rx_inject <> io.uart_rx_inject
 
   // Audio connections
   io.audio_sample := audio.io.sample
   io.audio_sample_valid := audio.io.sample_valid
+  io.audio_pending := audio.io.pending
+  io.audio_underruns := audio.io.underruns
 
   // Hardware synth connections
   io.hwsynth_sample := hwsynth.io.sample
   io.hwsynth_sample_valid := hwsynth.io.sample_valid
 
-  // Interrupt
-  cpu.io.interrupt_flag := io.signal_interrupt
+  // DMA connections: its transfers share the CPU's bus master; audio
+  // streams are paced by the sample FIFO
+  cpu.io.dma_bundle <> dma.io.bus
+  dma.io.pace := audio.io.fifo_ready
+  io.dma_busy := dma.io.busy
+
+  // Interrupt: bit 0 from the harness (timer); external: bit 1 DMA done,
+  // bit 2 audio FIFO below its watermark, bit 3 VGA vblank, bit 4 UART
+  // (enabled RX/TX conditions, for the buffered driver)
+  cpu.io.interrupt_flag := Cat(
+    uart.io.irq,
+    vga.io.intr,
+    audio.io.signal_interrupt,
+    dma.io.signal_interrupt,
+    io.signal_interrupt
+  )
 
   // Debug interfaces
   cpu.io.debug_read_address := io.cpu_debug_read_address
   io.cpu_debug_read_data := cpu.io.debug_read_data
   cpu.io.csr_debug_read_address := io.cpu_csr_debug_read_address
   io.cpu_csr_debug_read_data := cpu.io.csr_debug_read_data
+  cpu.io.debug_write := io.cpu_debug_write
+  io.cpu_retire := cpu.io.retire
+  io.cpu_retire_b := cpu.io.retire_b
 }
 
+// Optional argument: output directory (scripts/sweep.py builds one per
+// configuration)
 object VerilogGenerator extends App {
   (new ChiselStage).emitVerilog(
     new Top(),
-    Array("--target-dir", "4-soc/verilog/verilator")
+    Array("--target-dir", args.headOption.getOrElse("4-soc/verilog/verilator"))
   )
 }
@@ -17,7 +17,8 @@ import riscv.Parameters
  * control/status register access with single-beat transactions only.
  *
  * Protocol Characteristics:
- * - Single-beat (non-burst) transactions only
+ * - Single-beat transactions, plus AXI4 INCR bursts where both ends support
+ *   them (see below)
  * - Fixed data width (32-bit in this implementation)
  * - Separate read and write channels (can operate independently)
  * - VALID/READY handshake on all channels
@@ -28,10 +29,24 @@ import riscv.Parameters
  * - Write Response (B): Slave acknowledges write completion
  * - Read Address (AR): Master provides read address
  * - Read Data (R): Slave returns read data with response
+ *
+ * Bursts:
+ * - The channels also carry the AXI4 burst signals AxLEN (beats - 1), AxSIZE
+ *   (always one word), AxBURST (always INCR), WLAST and RLAST
+ * - AXI4LiteMaster issues a burst when its bundle asks for burst_length > 0,
+ *   and one address handshake and one write response then cover every beat
+ * - AXI4LiteSlave(burst = true) serves them (main memory); with the default
+ *   burst = false it ignores AxLEN and answers a single beat with RLAST set,
+ *   as do the other peripherals, so only memory may be sent bursts
  */
 object AXI4Lite {
-  val protWidth = 3 // Protection type width (privileged, secure, instruction/data)
-  val respWidth = 2 // Response width (OKAY=0, EXOKAY=1, SLVERR=2, DECERR=3)
+  val protWidth  = 3 // Protection type width (privileged, secure, instruction/data)
+  val respWidth  = 2 // Response width (OKAY=0, EXOKAY=1, SLVERR=2, DECERR=3)
+  val lenWidth   = 8 // Burst length width (AxLEN = beats - 1, up to 256 beats)
+  val sizeWidth  = 3 // Burst size width (AxSIZE = log2(bytes per beat))
+  val burstWidth = 2 // Burst type width (FIXED=0, INCR=1, WRAP=2)
+
+  val BurstIncr = 1
 }
 
 class AXI4LiteWriteAddressChannel(addrWidth: Int) extends Bundle {
@@ -39,6 +54,9 @@ class AXI4LiteWriteAddressChannel(addrWidth: Int) extends Bundle {
   val AWREADY = Input(Bool())
   val AWADDR  = Output(UInt(addrWidth.W))
   val AWPROT  = Output(UInt(AXI4Lite.protWidth.W))
+  val AWLEN   = Output(UInt(AXI4Lite.lenWidth.W))
+  val AWSIZE  = Output(UInt(AXI4Lite.sizeWidth.W))
+  val AWBURST = Output(UInt(AXI4Lite.burstWidth.W))
 }
 
 class AXI4LiteWriteDataChannel(dataWidth: Int) extends Bundle {
@@ -46,6 +64,7 @@ class AXI4LiteWriteDataChannel(dataWidth: Int) extends Bundle {
   val WREADY = Input(Bool())
   val WDATA  = Output(UInt(dataWidth.W))
   val WSTRB  = Output(UInt((dataWidth / 8).W))
+  val WLAST  = Output(Bool())
 }
 
 class AXI4LiteWriteResponseChannel extends Bundle {
@@ -59,6 +78,9 @@ class AXI4LiteReadAddressChannel(addrWidth: Int) extends Bundle {
   val ARREADY = Input(Bool())
   val ARADDR  = Output(UInt(addrWidth.W))
   val ARPROT  = Output(UInt(AXI4Lite.protWidth.W))
+  val ARLEN   = Output(UInt(AXI4Lite.lenWidth.W))
+  val ARSIZE  = Output(UInt(AXI4Lite.sizeWidth.W))
+  val ARBURST = Output(UInt(AXI4Lite.burstWidth.W))
 }
 
 class AXI4LiteReadDataChannel(dataWidth: Int) extends Bundle {
@@ -66,6 +88,7 @@ class AXI4LiteReadDataChannel(dataWidth: Int) extends Bundle {
   val RREADY = Output(Bool())
   val RDATA  = Input(UInt(dataWidth.W))
   val RRESP  = Input(UInt(AXI4Lite.respWidth.W))
+  val RLAST  = Input(Bool())
 }
 
 class AXI4LiteInterface(addrWidth: Int, dataWidth: Int) extends Bundle {
@@ -107,6 +130,7 @@ class AXI4LiteSlaveBundle(addrWidth: Int, dataWidth: Int) extends Bundle {
   val write        = Output(Bool())           // tell slave device to write
   val write_data   = Output(UInt(dataWidth.W))
   val write_strobe = Output(Vec(Parameters.WordSize, Bool()))
+  val burst        = Output(Bool())           // read/write is a later beat of a burst (next word)
 }
 
 // Bundle for master device to interact with AXI4-Lite bus
@@ -118,26 +142,54 @@ class AXI4LiteMasterBundle(addrWidth: Int, dataWidth: Int) extends Bundle {
   val write_data          = Input(UInt(dataWidth.W))
   val write_strobe        = Input(Vec(Parameters.WordSize, Bool()))
   val busy                = Output(Bool()) // if busy, master is not ready
-  val read_valid          = Output(Bool()) // read transaction complete
+  val read_valid          = Output(Bool()) // read_data valid (once per beat of a burst)
   val write_valid         = Output(Bool()) // write transaction complete (BRESP received)
   val write_data_accepted = Output(Bool()) // write data accepted by slave (WREADY && WVALID)
+  val write_beat          = Output(Bool()) // write_data taken (each beat of a burst), present the next
+  // Beats - 1 (AxLEN) of the next transaction; 0 = single beat
+  val burst_length = Input(UInt(AXI4Lite.lenWidth.W))
 }
 
 object AXI4LiteStates extends ChiselEnum {
   val Idle, ReadAddr, ReadData, WriteAddr, WriteData, WriteResp = Value
 }
 
-class AXI4LiteSlave(addrWidth: Int, dataWidth: Int) extends Module {
+/**
+ * AXI4 slave adapter: turns channel transactions into bundle reads and writes
+ *
+ * With burst = true every beat of an INCR burst becomes its own bundle access
+ * at the next word address, with bundle.burst set from the second beat on. A
+ * read beat is requested once the previous one has been taken (read_valid
+ * is only sampled while read is high, so a device answering one cycle late
+ * cannot return stale data for the next word); write beats are accepted one
+ * per cycle. With burst = false (the peripherals) AxLEN and WLAST are ignored
+ * and every transaction is a single beat.
+ *
+ * With writeReady = true the device paces write beats through io.write_ready:
+ * WREADY is held low while it is false, so a memory model can refuse writes
+ * while its write queue is full. Otherwise every beat is accepted at once.
+ */
+class AXI4LiteSlave(addrWidth: Int, dataWidth: Int, burst: Boolean = false, writeReady: Boolean = false)
+    extends Module {
   val io = IO(new Bundle {
-    val channels = Flipped(new AXI4LiteChannels(addrWidth, dataWidth))
-    val bundle   = new AXI4LiteSlaveBundle(addrWidth, dataWidth)
+    val channels    = Flipped(new AXI4LiteChannels(addrWidth, dataWidth))
+    val bundle      = new AXI4LiteSlaveBundle(addrWidth, dataWidth)
+    val write_ready = if (writeReady) Some(Input(Bool())) else None
   })
+  val accept_write = io.write_ready.getOrElse(true.B)
 
   val state = RegInit(AXI4LiteStates.Idle)
 
   val addr = RegInit(0.U(addrWidth.W)) // Fixed: was dataWidth, should be addrWidth
   io.bundle.address := addr
 
+  // Read beats left after the current one; whether the next write beat is the
+  // first; whether the bundle access is a later beat
+  val remaining  = RegInit(0.U(AXI4Lite.lenWidth.W))
+  val first_beat = RegInit(true.B)
+  val later_beat = RegInit(false.B)
+  io.bundle.burst := later_beat
+
   // Read signals
   val read = RegInit(false.B)
   io.bundle.read := read
@@ -150,6 +202,8 @@ class AXI4LiteSlave(addrWidth: Int, dataWidth: Int) extends Module {
   io.channels.read_data_channel.RVALID := RVALID
   val RRESP = RegInit(0.U(AXI4Lite.respWidth.W))
   io.channels.read_data_channel.RRESP := RRESP
+  val RLAST = RegInit(false.B)
+  io.channels.read_data_channel.RLAST := RLAST
 
   // Write signals
   val write = RegInit(false.B)
@@ -162,7 +216,7 @@ class AXI4LiteSlave(addrWidth: Int, dataWidth: Int) extends Module {
   val AWREADY = RegInit(false.B)
   io.channels.write_address_channel.AWREADY := AWREADY
   val WREADY = RegInit(false.B)
-  io.channels.write_data_channel.WREADY := WREADY
+  io.channels.write_data_channel.WREADY := WREADY && accept_write
   val BVALID = RegInit(false.B)
   io.channels.write_response_channel.BVALID := BVALID
   val BRESP = WireInit(0.U(AXI4Lite.respWidth.W))
@@ -187,47 +241,67 @@ class AXI4LiteSlave(addrWidth: Int, dataWidth: Int) extends Module {
     is(AXI4LiteStates.ReadAddr) {
       when(io.channels.read_address_channel.ARVALID && ARREADY) {
         // Capture address
-        addr    := io.channels.read_address_channel.ARADDR
-        ARREADY := false.B
-        read    := true.B
-        state   := AXI4LiteStates.ReadData
+        addr       := io.channels.read_address_channel.ARADDR
+        remaining  := (if (burst) io.channels.read_address_channel.ARLEN else 0.U)
+        later_beat := false.B
+        ARREADY    := false.B
+        read       := true.B
+        state      := AXI4LiteStates.ReadData
       }
     }
 
     is(AXI4LiteStates.ReadData) {
-      when(io.bundle.read_valid) {
+      when(RVALID && io.channels.read_data_channel.RREADY) {
+        // Master acknowledged data: done, or request the next beat
+        RVALID := false.B
+        when(RLAST) {
+          state := AXI4LiteStates.Idle
+        }.otherwise {
+          addr       := addr + (dataWidth / 8).U
+          remaining  := remaining - 1.U
+          later_beat := true.B
+          read       := true.B
+        }
+      }
+
+      when(read && io.bundle.read_valid) {
         // Data ready from slave device
         read_data := io.bundle.read_data
         RVALID    := true.B
         RRESP     := 0.U // OKAY response
+        RLAST     := remaining === 0.U
         read      := false.B
       }
-
-      when(RVALID && io.channels.read_data_channel.RREADY) {
-        // Master acknowledged data
-        RVALID := false.B
-        state  := AXI4LiteStates.Idle
-      }
     }
 
     is(AXI4LiteStates.WriteAddr) {
       when(io.channels.write_address_channel.AWVALID && AWREADY) {
         // Capture write address
-        addr    := io.channels.write_address_channel.AWADDR
-        AWREADY := false.B
-        WREADY  := true.B
-        state   := AXI4LiteStates.WriteData
+        addr       := io.channels.write_address_channel.AWADDR
+        first_beat := true.B
+        AWREADY    := false.B
+        WREADY     := true.B
+        state      := AXI4LiteStates.WriteData
       }
     }
 
     is(AXI4LiteStates.WriteData) {
-      when(io.channels.write_data_channel.WVALID && WREADY) {
-        // Capture write data
+      write := false.B
+
+      when(io.channels.write_data_channel.WVALID && WREADY && accept_write) {
+        // Capture write data; later beats go to the next word
         write_data   := io.channels.write_data_channel.WDATA
         write_strobe := VecInit(io.channels.write_data_channel.WSTRB.asBools)
-        WREADY       := false.B
         write        := true.B
-        state        := AXI4LiteStates.WriteResp
+        first_beat   := false.B
+        later_beat   := !first_beat
+        when(!first_beat) {
+          addr := addr + (dataWidth / 8).U
+        }
+        when(if (burst) io.channels.write_data_channel.WLAST else true.B) {
+          WREADY := false.B
+          state  := AXI4LiteStates.WriteResp
+        }
       }
     }
 
@@ -245,6 +319,16 @@ class AXI4LiteSlave(addrWidth: Int, dataWidth: Int) extends Module {
   }
 }
 
+/**
+ * AXI4 master adapter: runs one bundle transaction at a time over the channels
+ *
+ * A transaction is single-beat unless bundle.burst_length asks for an INCR
+ * burst. Burst reads raise read_valid once per beat, in address order; the
+ * last beat's read_valid comes in the first Idle cycle, as for a single read.
+ * Burst writes take WDATA straight from bundle.write_data, and write_beat
+ * pulses as each beat is accepted so the requester can present the next;
+ * write_valid follows the single write response.
+ */
 class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
   val io = IO(new Bundle {
     val channels = new AXI4LiteChannels(addrWidth, dataWidth)
@@ -258,6 +342,17 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
   io.channels.read_address_channel.ARADDR  := addr
   io.channels.write_address_channel.AWADDR := addr
 
+  // Burst length of the transaction in flight, and write beats still to send
+  // after the current one
+  val len        = RegInit(0.U(AXI4Lite.lenWidth.W))
+  val beats_left = RegInit(0.U(AXI4Lite.lenWidth.W))
+  io.channels.read_address_channel.ARLEN    := len
+  io.channels.write_address_channel.AWLEN   := len
+  io.channels.read_address_channel.ARSIZE   := log2Ceil(dataWidth / 8).U
+  io.channels.write_address_channel.AWSIZE  := log2Ceil(dataWidth / 8).U
+  io.channels.read_address_channel.ARBURST  := AXI4Lite.BurstIncr.U
+  io.channels.write_address_channel.AWBURST := AXI4Lite.BurstIncr.U
+
   // Read signals
   val read_valid = RegInit(false.B)
   io.bundle.read_valid := read_valid
@@ -279,6 +374,15 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
   val write_strobe = RegInit(VecInit(Seq.fill(Parameters.WordSize)(false.B)))
   io.channels.write_data_channel.WSTRB := write_strobe.asUInt
 
+  // Single writes send the data captured in Idle; burst beats come straight
+  // from the requester, which holds each one until write_beat
+  val burst_write = len =/= 0.U
+  when(burst_write) {
+    io.channels.write_data_channel.WDATA := io.bundle.write_data
+    io.channels.write_data_channel.WSTRB := io.bundle.write_strobe.asUInt
+  }
+  io.channels.write_data_channel.WLAST := beats_left === 0.U
+
   val AWVALID = RegInit(false.B)
   io.channels.write_address_channel.AWVALID := AWVALID
   val WVALID = RegInit(false.B)
@@ -292,6 +396,8 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
 
   io.channels.write_address_channel.AWPROT := 0.U
 
+  io.bundle.write_beat := state === AXI4LiteStates.WriteData && WVALID && io.channels.write_data_channel.WREADY
+
   // Performance optimization: Assert ARVALID/AWVALID in Idle to save 1 cycle
   // per transaction. Both addr and ARVALID/AWVALID are registered, so they
   // update synchronously on the same clock edge - no address capture race.
@@ -305,12 +411,15 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
       when(io.bundle.read && !io.bundle.write) {
         // Start read transaction - assert ARVALID immediately (saves 1 cycle)
         addr    := io.bundle.address
+        len     := io.bundle.burst_length
         ARVALID := true.B
         RREADY  := true.B
         state   := AXI4LiteStates.ReadData
       }.elsewhen(io.bundle.write) {
         // Start write transaction - assert AWVALID/WVALID immediately (saves 1 cycle)
         addr         := io.bundle.address
+        len          := io.bundle.burst_length
+        beats_left   := io.bundle.burst_length
         write_data   := io.bundle.write_data
         write_strobe := io.bundle.write_strobe
         AWVALID      := true.B
@@ -320,17 +429,21 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
     }
 
     is(AXI4LiteStates.ReadData) {
+      read_valid := false.B
+
       // Deassert ARVALID after address handshake completes
       when(ARVALID && io.channels.read_address_channel.ARREADY) {
         ARVALID := false.B
       }
 
       when(io.channels.read_data_channel.RVALID && RREADY) {
-        // Data received from slave
+        // Data received from slave; the transaction ends with the last beat
         read_data  := io.channels.read_data_channel.RDATA
-        RREADY     := false.B
         read_valid := true.B
-        state      := AXI4LiteStates.Idle
+        when(io.channels.read_data_channel.RLAST) {
+          RREADY := false.B
+          state  := AXI4LiteStates.Idle
+        }
       }
     }
 
@@ -341,11 +454,15 @@ class AXI4LiteMaster(addrWidth: Int, dataWidth: Int) extends Module {
       }
 
       when(WVALID && io.channels.write_data_channel.WREADY) {
-        // Data accepted by slave - signal for posted-write optimization
-        WVALID              := false.B
-        BREADY              := true.B
-        write_data_accepted := true.B // Pipeline can proceed before BRESP
-        state               := AXI4LiteStates.WriteResp
+        when(beats_left === 0.U) {
+          // Last data accepted by slave - signal for posted-write optimization
+          WVALID              := false.B
+          BREADY              := true.B
+          write_data_accepted := true.B // Pipeline can proceed before BRESP
+          state               := AXI4LiteStates.WriteResp
+        }.otherwise {
+          beats_left := beats_left - 1.U
+        }
       }
     }
 
@@ -10,19 +10,17 @@ import riscv.Parameters
 /**
  * Bus arbiter for multi-master AXI4-Lite bus access.
  *
- * NOTE: This module is currently unused in 4-soc as the system operates with
- * a single bus master (CPU). It exists as infrastructure for future multi-master
- * configurations (e.g., DMA controller, debug interface, or additional cores).
+ * Used inside riscv.core.CPU, where the DMA controller (master 0), the
+ * instruction cache refills (master 1) and the data accesses of MemoryAccess
+ * (master 2) share the CPU's single AXI4-Lite master. The arbiter only picks
+ * who starts the next transaction; CPU.scala routes the responses back to the
+ * master that started it.
  *
  * Implementation: Static priority arbitration where higher-numbered masters have
- * higher priority. Master 0 (CPU) is lowest priority, which would allow DMA or
- * debug access to preempt normal CPU bus transactions when needed.
- *
- * To enable multi-master operation:
- *   1. Set Parameters.MasterDeviceCount > 1
- *   2. Instantiate BusArbiter in Top.scala
- *   3. Connect arbiter between masters and BusSwitch
- *   4. Gate master bus signals through bus_granted
+ * higher priority, so a load or store waits for at most the transaction in
+ * flight, and the DMA only gets the cycles the CPU leaves free. Further
+ * masters (debug interface) would be added by raising
+ * Parameters.MasterDeviceCount.
  */
 class BusArbiter extends Module {
   val io = IO(new Bundle {
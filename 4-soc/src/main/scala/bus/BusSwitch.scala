@@ -19,9 +19,9 @@ import riscv.Parameters
  *   Slave 0: 0x0000_0000 - 0x1FFF_FFFF (Main Memory)
  *   Slave 1: 0x2000_0000 - 0x3FFF_FFFF (VGA Controller)
  *   Slave 2: 0x4000_0000 - 0x5FFF_FFFF (UART Controller)
- *   Slave 3: 0x6000_0000 - 0x7FFF_FFFF (Reserved/DummySlave)
- *   Slave 4: 0x8000_0000 - 0x9FFF_FFFF (Reserved/DummySlave)
- *   Slave 5: 0xA000_0000 - 0xBFFF_FFFF (Reserved/DummySlave)
+ *   Slave 3: 0x6000_0000 - 0x7FFF_FFFF (Audio)
+ *   Slave 4: 0x8000_0000 - 0x9FFF_FFFF (Hardware Synth)
+ *   Slave 5: 0xA000_0000 - 0xBFFF_FFFF (DMA Controller)
  *   Slave 6: 0xC000_0000 - 0xDFFF_FFFF (Reserved/DummySlave)
  *   Slave 7: 0xE000_0000 - 0xFFFF_FFFF (Reserved/DummySlave)
  *
@@ -38,6 +38,9 @@ import riscv.Parameters
  *   - VALID gating: Only selected slave sees VALID assertions
  *   - Mux1H response: Fast one-hot multiplexer for slave responses
  *   - DummySlave support: Unmapped regions respond with DECERR (no deadlock)
+ *   - Bursts: AxLEN/AxSIZE/AxBURST/WLAST go to every slave like the other
+ *     payload signals; the read selection is held until RLAST, so every beat
+ *     of a burst read comes from the same slave
  */
 class BusSwitch extends Module {
   val io = IO(new Bundle {
@@ -60,7 +63,9 @@ class BusSwitch extends Module {
   // back-to-back transactions where completion and new start occur same cycle.
   when(io.master.read_address_channel.ARVALID) {
     read_sel := sel
-  }.elsewhen(io.master.read_data_channel.RVALID && io.master.read_data_channel.RREADY) {
+  }.elsewhen(
+    io.master.read_data_channel.RVALID && io.master.read_data_channel.RREADY && io.master.read_data_channel.RLAST
+  ) {
     read_sel := 0.U
   }
 
@@ -81,11 +86,15 @@ class BusSwitch extends Module {
     io.slaves(i).write_address_channel.AWVALID := io.master.write_address_channel.AWVALID && hit
     io.slaves(i).write_address_channel.AWADDR  := io.master.write_address_channel.AWADDR
     io.slaves(i).write_address_channel.AWPROT  := io.master.write_address_channel.AWPROT
+    io.slaves(i).write_address_channel.AWLEN   := io.master.write_address_channel.AWLEN
+    io.slaves(i).write_address_channel.AWSIZE  := io.master.write_address_channel.AWSIZE
+    io.slaves(i).write_address_channel.AWBURST := io.master.write_address_channel.AWBURST
 
     // Write data channel: combinational sel (transaction start)
     io.slaves(i).write_data_channel.WVALID := io.master.write_data_channel.WVALID && hit
     io.slaves(i).write_data_channel.WDATA  := io.master.write_data_channel.WDATA
     io.slaves(i).write_data_channel.WSTRB  := io.master.write_data_channel.WSTRB
+    io.slaves(i).write_data_channel.WLAST  := io.master.write_data_channel.WLAST
 
     // Write response channel: latched sel (response phase)
     io.slaves(i).write_response_channel.BREADY := io.master.write_response_channel.BREADY && write_sel(i)
@@ -94,6 +103,9 @@ class BusSwitch extends Module {
     io.slaves(i).read_address_channel.ARVALID := io.master.read_address_channel.ARVALID && hit
     io.slaves(i).read_address_channel.ARADDR  := io.master.read_address_channel.ARADDR
     io.slaves(i).read_address_channel.ARPROT  := io.master.read_address_channel.ARPROT
+    io.slaves(i).read_address_channel.ARLEN   := io.master.read_address_channel.ARLEN
+    io.slaves(i).read_address_channel.ARSIZE  := io.master.read_address_channel.ARSIZE
+    io.slaves(i).read_address_channel.ARBURST := io.master.read_address_channel.ARBURST
 
     // Read data channel: latched sel (response phase)
     io.slaves(i).read_data_channel.RREADY := io.master.read_data_channel.RREADY && read_sel(i)
@@ -111,4 +123,5 @@ class BusSwitch extends Module {
   io.master.read_data_channel.RVALID     := Mux1H(read_sel, io.slaves.map(_.read_data_channel.RVALID))
   io.master.read_data_channel.RDATA      := Mux1H(read_sel, io.slaves.map(_.read_data_channel.RDATA))
   io.master.read_data_channel.RRESP      := Mux1H(read_sel, io.slaves.map(_.read_data_channel.RRESP))
+  io.master.read_data_channel.RLAST      := Mux1H(read_sel, io.slaves.map(_.read_data_channel.RLAST))
 }
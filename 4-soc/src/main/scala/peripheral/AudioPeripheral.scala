@@ -1,94 +1,155 @@
-// SPDX-License-Identifier: MIT
-package peripheral
-
-import bus.AXI4LiteChannels
-import bus.AXI4LiteSlave
-import chisel3._
-import chisel3.util._
-import riscv.Parameters
-
-/**
- * Audio output peripheral with AXI4-Lite interface
- *
- * Memory map (Base: 0x60000000):
- *   0x00: ID     - Peripheral identification (RO: 0x41554449 = 'AUDI')
- *   0x04: STATUS - [1] fifo_full, [0] fifo_empty
- *   0x08: DATA   - Write: push 16-bit PCM sample into FIFO
- *
- * Output interface:
- *   - sample       : 16-bit unsigned PCM sample
- *   - sample_valid : asserted when a sample is dequeued
- */
-class AudioPeripheral extends Module {
-  val io = IO(new Bundle {
-    val channels = Flipped(new AXI4LiteChannels(8, Parameters.DataBits))
-    val sample = Output(UInt(16.W))
-    val sample_valid = Output(Bool())
-  })
-
-  // ================= Constants =================
-  object Reg {
-    val ID     = 0x00
-    val STATUS = 0x04
-    val DATA   = 0x08
-  }
-  
-  val AUDIO_ID = "h41554449".U  // 'AUDI'
-
-  // ================= AXI4-Lite Slave =================
-  val slave = Module(new AXI4LiteSlave(8, Parameters.DataBits))
-  slave.io.channels <> io.channels
-
-  // MMIO address decode (offset inside peripheral)
-  val addr = slave.io.bundle.address & 0xff.U
-  val addr_id     = addr === Reg.ID.U
-  val addr_status = addr === Reg.STATUS.U
-  val addr_data   = addr === Reg.DATA.U
-
-  // ================= Sample FIFO =================
-  // Depth 262144 to hold full 1-second audio buffer at 11025 Hz
-  val fifo = Module(new Queue(UInt(16.W), entries = 16384))
-  fifo.io.enq.valid := false.B
-  fifo.io.enq.bits  := 0.U
-
-  // ================= AXI Write Handling =================
-  when(slave.io.bundle.write && addr_data) {
-    when(fifo.io.enq.ready) {
-      fifo.io.enq.valid := true.B
-      fifo.io.enq.bits  := slave.io.bundle.write_data(15, 0)
-    }
-    // If FIFO full, data is dropped (software should poll STATUS)
-  }
-
-  // ================= AXI Read Handling =================
-  val read_data_prepared = WireDefault(0.U(32.W))  // 默認返回 0
-
-  when(addr_id) {
-    read_data_prepared := AUDIO_ID
-  }.elsewhen(addr_status) {
-    read_data_prepared := Cat(
-      0.U(30.W),
-      !fifo.io.enq.ready,  // bit 1: fifo_full
-      !fifo.io.deq.valid   // bit 0: fifo_empty
-    )
-  }
-  // DATA 暫存器是寫入專用，讀取返回 0（已由 WireDefault 處理）
-
-  // 與 VGA/UART 一致的時序規則
-  slave.io.bundle.read_valid := slave.io.bundle.read
-  slave.io.bundle.read_data := read_data_prepared
-
-private val SYS_CLK_HZ = 50000000      // 添加這行
-private val SAMPLE_RATE_HZ = 11025     // 添加這行
-private val DIV = SYS_CLK_HZ / SAMPLE_RATE_HZ  // ~4535
-
-private val CNT_WIDTH = log2Ceil(DIV + 1)
-val tickCnt = RegInit(0.U(CNT_WIDTH.W))
-val tick = (tickCnt === (DIV - 1).U)   // 添加這行
-tickCnt := Mux(tick, 0.U, tickCnt + 1.U)  // 添加這行
-
-// Only dequeue ONE sample per audio tick
-fifo.io.deq.ready := tick
-io.sample := fifo.io.deq.bits
-io.sample_valid := fifo.io.deq.fire
-}
+// SPDX-License-Identifier: MIT
+package peripheral
+
+import bus.AXI4LiteChannels
+import bus.AXI4LiteSlave
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * Audio output peripheral with AXI4-Lite interface
+ *
+ * Memory map (Base: 0x60000000):
+ *   0x00: ID        - Peripheral identification (RO: 0x41554449 = 'AUDI')
+ *   0x04: STATUS    - [2] below watermark, [1] fifo_full, [0] fifo_empty
+ *   0x08: DATA      - Write: push 16-bit PCM sample into FIFO
+ *   0x0C: LEVEL     - Samples in the FIFO (RO)
+ *   0x10: WATERMARK - Low watermark: below it while LEVEL <= WATERMARK
+ *   0x14: CTRL      - [0] watermark interrupt enable
+ *   0x18: UNDERRUN  - Sample ticks that found the FIFO empty since the first
+ *                     sample; any write clears it and waits for a new first
+ *
+ * The watermark interrupt is level-sensitive: it stays up until the FIFO is
+ * refilled above WATERMARK or the interrupt is disabled, so firmware can
+ * render a block of samples per interrupt and sleep in WFI in between.
+ *
+ * Output interface:
+ *   - sample           : 16-bit unsigned PCM sample
+ *   - sample_valid     : asserted when a sample is dequeued
+ *   - fifo_ready       : FIFO has room (paces DMA streams to DATA)
+ *   - signal_interrupt : below watermark, interrupt enabled
+ *   - pending          : FIFO not empty, so samples are still to play
+ *   - underruns        : UNDERRUN register (simulation report)
+ *
+ * @param depth        Samples the FIFO holds
+ * @param tickDivider  Clock cycles per output sample (50 MHz / 11025 Hz)
+ */
+class AudioPeripheral(depth: Int = Parameters.AudioFifoDepth, tickDivider: Int = 50000000 / 11025) extends Module {
+  require(depth >= 2, "Audio FIFO needs at least 2 entries")
+
+  val io = IO(new Bundle {
+    val channels = Flipped(new AXI4LiteChannels(8, Parameters.DataBits))
+    val sample = Output(UInt(16.W))
+    val sample_valid = Output(Bool())
+    val fifo_ready = Output(Bool())
+    val signal_interrupt = Output(Bool())
+    val pending = Output(Bool())
+    val underruns = Output(UInt(Parameters.DataWidth))
+  })
+
+  // ================= Constants =================
+  object Reg {
+    val ID        = 0x00
+    val STATUS    = 0x04
+    val DATA      = 0x08
+    val LEVEL     = 0x0c
+    val WATERMARK = 0x10
+    val CTRL      = 0x14
+    val UNDERRUN  = 0x18
+  }
+  
+  val AUDIO_ID = "h41554449".U  // 'AUDI'
+
+  // ================= AXI4-Lite Slave =================
+  val slave = Module(new AXI4LiteSlave(8, Parameters.DataBits))
+  slave.io.channels <> io.channels
+
+  // MMIO address decode (offset inside peripheral)
+  val addr = slave.io.bundle.address & 0xff.U
+  val addr_id     = addr === Reg.ID.U
+  val addr_status = addr === Reg.STATUS.U
+  val addr_data   = addr === Reg.DATA.U
+
+  // ================= Sample FIFO =================
+  val fifo = Module(new Queue(UInt(16.W), entries = depth))
+  fifo.io.enq.valid := false.B
+  fifo.io.enq.bits  := 0.U
+
+  val level     = fifo.io.count
+  val watermark = RegInit(0.U(log2Ceil(depth + 1).W))
+  val irq_en    = RegInit(false.B)
+  val underruns = RegInit(0.U(Parameters.DataWidth))
+  val started   = RegInit(false.B) // A sample was queued since UNDERRUN was last cleared
+  val below     = level <= watermark
+
+  // ================= AXI Write Handling =================
+  when(slave.io.bundle.write && addr_data) {
+    when(fifo.io.enq.ready) {
+      fifo.io.enq.valid := true.B
+      fifo.io.enq.bits  := slave.io.bundle.write_data(15, 0)
+      started           := true.B
+    }
+    // If FIFO full, data is dropped (software should poll STATUS)
+  }
+  when(slave.io.bundle.write) {
+    switch(addr) {
+      is(Reg.WATERMARK.U) {
+        val data = slave.io.bundle.write_data
+        watermark := Mux(data >= depth.U, depth.U, data)
+      }
+      is(Reg.CTRL.U) { irq_en := slave.io.bundle.write_data(0) }
+    }
+  }
+
+  // ================= AXI Read Handling =================
+  val read_data_prepared = WireDefault(0.U(32.W))  // 默認返回 0
+
+  when(addr_id) {
+    read_data_prepared := AUDIO_ID
+  }.elsewhen(addr_status) {
+    read_data_prepared := Cat(
+      0.U(29.W),
+      below,               // bit 2: at or below the watermark
+      !fifo.io.enq.ready,  // bit 1: fifo_full
+      !fifo.io.deq.valid   // bit 0: fifo_empty
+    )
+  }.elsewhen(addr === Reg.LEVEL.U) {
+    read_data_prepared := level
+  }.elsewhen(addr === Reg.WATERMARK.U) {
+    read_data_prepared := watermark
+  }.elsewhen(addr === Reg.CTRL.U) {
+    read_data_prepared := irq_en
+  }.elsewhen(addr === Reg.UNDERRUN.U) {
+    read_data_prepared := underruns
+  }
+  // DATA 暫存器是寫入專用，讀取返回 0（已由 WireDefault 處理）
+
+  // 與 VGA/UART 一致的時序規則
+  slave.io.bundle.read_valid := slave.io.bundle.read
+  slave.io.bundle.read_data := read_data_prepared
+
+  // ================= Sample Clock =================
+  private val CNT_WIDTH = log2Ceil(tickDivider + 1)
+  val tickCnt = RegInit(0.U(CNT_WIDTH.W))
+  val tick = tickCnt === (tickDivider - 1).U
+  tickCnt := Mux(tick, 0.U, tickCnt + 1.U)
+
+  // Only dequeue ONE sample per audio tick
+  fifo.io.deq.ready := tick
+  io.sample := fifo.io.deq.bits
+  io.sample_valid := fifo.io.deq.fire
+  io.fifo_ready := fifo.io.enq.ready
+
+  // A tick with nothing to play after the stream started is an underrun
+  when(slave.io.bundle.write && addr === Reg.UNDERRUN.U) {
+    underruns := 0.U
+    started   := false.B
+  }.elsewhen(tick && started && !fifo.io.deq.valid) {
+    underruns := underruns + 1.U
+  }
+
+  io.signal_interrupt := irq_en && below
+  io.pending := fifo.io.deq.valid
+  io.underruns := underruns
+}
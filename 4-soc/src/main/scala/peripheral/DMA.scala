@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package peripheral
+
+import bus.AXI4LiteChannels
+import bus.AXI4LiteSlave
+import chisel3._
+import chisel3.util._
+import riscv.core.BusBundle
+import riscv.Parameters
+
+/**
+ * DMA controller: copies words between memory and peripherals while the CPU
+ * runs, as a second bus master beside it
+ *
+ * Memory map (Base: 0xA0000000):
+ *   0x00: ID     - Peripheral identification (RO: 0x444d4131 = 'DMA1')
+ *   0x04: STATUS - [1] done (W1C), [0] busy
+ *   0x08: SRC    - Source address (word aligned; advances while busy)
+ *   0x0C: DST    - Destination address (word aligned; advances while busy)
+ *   0x10: COUNT  - Words to copy (counts down while busy)
+ *   0x14: CTRL   - [4] pace, [3] interrupt enable, [2] dst_inc, [1] src_inc;
+ *                  writing [0] = 1 starts the descriptor in SRC/DST/COUNT
+ *
+ * Descriptors:
+ * - Memory to peripheral: src_inc, fixed destination such as VGA STREAM_DATA
+ *   or the audio DATA register
+ * - Memory to memory: src_inc and dst_inc
+ * - pace waits for io.pace before each destination write (the audio FIFO
+ *   having room), so a stream cannot overrun its peripheral
+ *
+ * Operation:
+ * - Reads of up to bufferWords words from main memory with src_inc are one
+ *   burst into the buffer, other reads one word each; writes to main memory
+ *   with dst_inc are one burst, other writes one single-beat transaction per
+ *   word in order
+ * - SRC/DST/COUNT/CTRL writes are ignored while busy; done is set (and the
+ *   interrupt raised, if enabled) when COUNT reaches 0, and cleared by
+ *   writing 1 to it or by the next start
+ *
+ * The bus port goes through the CPU's arbiter below its own accesses, and
+ * does not look into the CPU's data cache: dirty lines of the source must be
+ * written back first (FENCE.I), see csrc/dma.h. The CPU invalidates cached
+ * lines the DMA writes to.
+ *
+ * @param bufferWords Words moved per chunk (at most 256, the burst limit)
+ */
+class DMA(bufferWords: Int = Parameters.DMABufferWords) extends Module {
+  require(bufferWords >= 1 && bufferWords <= 256, "DMA buffer must hold 1 to 256 words")
+
+  val io = IO(new Bundle {
+    val channels = Flipped(new AXI4LiteChannels(8, Parameters.DataBits))
+    val bus      = new BusBundle // Master port (CPU wrapper's arbiter)
+
+    val pace             = Input(Bool())  // Paced destination can take a word
+    val signal_interrupt = Output(Bool()) // Descriptor done, interrupt enabled
+    val busy             = Output(Bool()) // Transfer in progress
+  })
+
+  // ================= Constants =================
+  object Reg {
+    val ID     = 0x00
+    val STATUS = 0x04
+    val SRC    = 0x08
+    val DST    = 0x0c
+    val COUNT  = 0x10
+    val CTRL   = 0x14
+  }
+
+  val DMA_ID = "h444d4131".U // 'DMA1'
+
+  object State extends ChiselEnum {
+    val sIdle, sRead, sWrite = Value
+  }
+  val state = RegInit(State.sIdle)
+
+  val src     = RegInit(0.U(Parameters.AddrWidth))
+  val dst     = RegInit(0.U(Parameters.AddrWidth))
+  val count   = RegInit(0.U(Parameters.DataWidth))
+  val src_inc = RegInit(false.B)
+  val dst_inc = RegInit(false.B)
+  val irq_en  = RegInit(false.B)
+  val pace    = RegInit(false.B)
+  val done    = RegInit(false.B)
+
+  // Current chunk: words in the buffer, the word being moved, and whether its
+  // bus transaction has been granted
+  val buffer = Reg(Vec(bufferWords, UInt(Parameters.DataWidth)))
+  val chunk  = RegInit(0.U(log2Ceil(bufferWords + 1).W))
+  val beat   = RegInit(0.U(log2Ceil(bufferWords).max(1).W))
+  val issued = RegInit(false.B)
+
+  def isMemory(address: UInt): Bool =
+    address(Parameters.AddrBits - 1, Parameters.AddrBits - Parameters.SlaveDeviceCountBits) === 0.U
+
+  // Words of the next chunk: a burst's worth when the source allows one
+  def chunkWords(words: UInt, inc: Bool, address: UInt): UInt =
+    Mux(inc && isMemory(address), Mux(words < bufferWords.U, words, bufferWords.U), 1.U)
+
+  val read_burst  = src_inc && isMemory(src)
+  val write_burst = dst_inc && isMemory(dst)
+
+  io.busy             := state =/= State.sIdle
+  io.signal_interrupt := done && irq_en
+
+  // ================= AXI4-Lite Slave =================
+  val slave = Module(new AXI4LiteSlave(8, Parameters.DataBits))
+  slave.io.channels <> io.channels
+
+  val addr = slave.io.bundle.address & 0xff.U
+
+  val read_data_prepared = WireDefault(0.U(32.W))
+  switch(addr) {
+    is(Reg.ID.U) { read_data_prepared := DMA_ID }
+    is(Reg.STATUS.U) { read_data_prepared := Cat(done, io.busy) }
+    is(Reg.SRC.U) { read_data_prepared := src }
+    is(Reg.DST.U) { read_data_prepared := dst }
+    is(Reg.COUNT.U) { read_data_prepared := count }
+    is(Reg.CTRL.U) { read_data_prepared := Cat(pace, irq_en, dst_inc, src_inc, 0.U(1.W)) }
+  }
+  slave.io.bundle.read_valid := slave.io.bundle.read
+  slave.io.bundle.read_data  := read_data_prepared
+
+  when(slave.io.bundle.write) {
+    val data = slave.io.bundle.write_data
+    when(addr === Reg.STATUS.U && data(1)) {
+      done := false.B
+    }
+    when(!io.busy) {
+      switch(addr) {
+        is(Reg.SRC.U) { src := Cat(data(31, 2), 0.U(2.W)) }
+        is(Reg.DST.U) { dst := Cat(data(31, 2), 0.U(2.W)) }
+        is(Reg.COUNT.U) { count := data }
+        is(Reg.CTRL.U) {
+          src_inc := data(1)
+          dst_inc := data(2)
+          irq_en  := data(3)
+          pace    := data(4)
+          when(data(0)) {
+            done := count === 0.U
+            when(count =/= 0.U) {
+              chunk  := chunkWords(count, data(1), src)
+              beat   := 0.U
+              issued := false.B
+              state  := State.sRead
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // ================= Bus Master =================
+  io.bus.request      := false.B
+  io.bus.read         := false.B
+  io.bus.write        := false.B
+  io.bus.address      := src
+  io.bus.write_data   := buffer(beat)
+  io.bus.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(true.B))
+  io.bus.burst_length := 0.U
+
+  // The transaction in flight, or the one granted in this cycle
+  val started = io.bus.request && (io.bus.read || io.bus.write) && io.bus.granted
+  val active  = issued || started
+
+  switch(state) {
+    is(State.sRead) {
+      io.bus.request      := true.B
+      io.bus.read         := !issued
+      io.bus.burst_length := Mux(read_burst, chunk - 1.U, 0.U)
+      when(started) {
+        issued := true.B
+      }
+      when(active && io.bus.read_valid) {
+        buffer(beat) := io.bus.read_data
+        beat         := beat + 1.U
+        when(src_inc) {
+          src := src + 4.U
+        }
+        when(beat === chunk - 1.U) {
+          beat   := 0.U
+          issued := false.B
+          state  := State.sWrite
+        }
+      }
+    }
+
+    is(State.sWrite) {
+      val ready = issued || !pace || io.pace
+      io.bus.request      := ready
+      io.bus.write        := ready && !issued
+      io.bus.address      := dst
+      io.bus.burst_length := Mux(write_burst, chunk - 1.U, 0.U)
+      when(started) {
+        issued := true.B
+      }
+      val last_word = Mux(write_burst, true.B, beat === chunk - 1.U)
+      when(active && io.bus.write_beat && write_burst) {
+        // Present each word until the master has taken it
+        dst := dst + 4.U
+        when(beat =/= chunk - 1.U) {
+          beat := beat + 1.U
+        }
+      }
+      when(active && io.bus.write_valid) {
+        issued := false.B
+        when(!write_burst) {
+          beat := beat + 1.U
+          when(dst_inc) {
+            dst := dst + 4.U
+          }
+        }
+        when(last_word) {
+          val remaining = count - chunk
+          count := remaining
+          beat  := 0.U
+          chunk := chunkWords(remaining, src_inc, src)
+          state := Mux(remaining === 0.U, State.sIdle, State.sRead)
+          done  := remaining === 0.U
+        }
+      }
+    }
+  }
+}
@@ -45,6 +45,7 @@ class DummySlave extends Module {
   io.channels.read_data_channel.RVALID := read_pending
   io.channels.read_data_channel.RDATA  := "hDEADBEEF".U // Distinctive pattern for debugging
   io.channels.read_data_channel.RRESP  := DECERR
+  io.channels.read_data_channel.RLAST  := true.B // Single beat, like the other Lite slaves
 
   when(read_pending && io.channels.read_data_channel.RREADY) {
     read_pending := false.B
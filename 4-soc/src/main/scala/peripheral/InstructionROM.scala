@@ -7,6 +7,7 @@ package peripheral
 import java.io.FileWriter
 import java.nio.file.Files
 import java.nio.file.Paths
+import java.nio.file.StandardCopyOption
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 
@@ -14,7 +15,16 @@ import chisel3._
 import chisel3.util.experimental.loadMemoryFromFileInline
 import riscv.Parameters
 
-class InstructionROM(instructionFilename: String) extends Module {
+/**
+ * Program ROM, initialised from verilog/<program>.txt when the simulation
+ * starts
+ *
+ * @param words ROM size in words, zero-filled past the program; 0 fits the
+ *              program. With a fixed size, programs loaded under the same file
+ *              name elaborate to the same design, so one compiled model can
+ *              run them all (ComplianceTestBase).
+ */
+class InstructionROM(instructionFilename: String, words: Int = 0) extends Module {
   val io = IO(new Bundle {
     val address = Input(UInt(Parameters.AddrWidth))
     val data    = Output(UInt(Parameters.InstructionWidth))
@@ -46,18 +56,27 @@ class InstructionROM(instructionFilename: String) extends Module {
     instructions = instructions :+ BigInt(0x00000013L)
     instructions = instructions :+ BigInt(0x00000013L)
     instructions = instructions :+ BigInt(0x00000013L)
+    require(
+      instructions.length <= words || words == 0,
+      s"$instructionFilename: ${instructions.length} words do not fit a $words-word ROM"
+    )
+    instructions = instructions.padTo(words, BigInt(0))
     val currentDir = System.getProperty("user.dir")
     // Extract just the filename from instructionFilename (handles absolute paths)
     val baseName   = Paths.get(instructionFilename).getFileName.toString
     val exeTxtPath = Paths.get(currentDir, "verilog", f"${baseName}.txt")
     // Create verilog directory if it doesn't exist
     Files.createDirectories(exeTxtPath.getParent)
-    val writer = new FileWriter(exeTxtPath.toString)
+    // Written aside and renamed into place, so that a simulation of another
+    // test starting meanwhile never reads a partial file
+    val tempPath = Files.createTempFile(exeTxtPath.getParent, baseName, ".tmp")
+    val writer   = new FileWriter(tempPath.toString)
     for (i <- instructions.indices) {
       // Use @address\ndata format for loadMemoryFromFileInline compatibility
       writer.write(f"@$i%x\n${instructions(i)}%08x\n")
     }
     writer.close()
+    Files.move(tempPath, exeTxtPath, StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE)
     (exeTxtPath, instructions.length)
   }
 }
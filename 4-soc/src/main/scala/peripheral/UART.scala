@@ -29,6 +29,7 @@ object UartConstants {
   val REG_INTERRUPT = 0x08 // Interrupt enable - write-only
   val REG_RX_DATA   = 0x0c // Received data - read clears interrupt
   val REG_TX_DATA   = 0x10 // Transmit data - write-only
+  val REG_IRQ_EN    = 0x14 // irq enables: RX non-empty (bit 0), TX ready (bit 1)
 }
 
 class UartIO extends DecoupledIO(UInt(8.W))
@@ -158,11 +159,13 @@ class Buffer extends Module {
 
 /**
  * A transmitter with a single buffer.
+ * busy: a byte is buffered or its frame is still on the line.
  */
 class BufferedTx(frequency: Int, baudRate: Int) extends Module {
   val io = IO(new Bundle {
     val txd     = Output(UInt(1.W))
     val channel = Flipped(new UartIO())
+    val busy    = Output(Bool())
   })
   val tx  = Module(new Tx(frequency, baudRate))
   val buf = Module(new Buffer)
@@ -170,6 +173,7 @@ class BufferedTx(frequency: Int, baudRate: Int) extends Module {
   buf.io.in <> io.channel
   tx.io.channel <> buf.io.out
   io.txd <> tx.io.txd
+  io.busy := buf.io.out.valid || !tx.io.channel.ready
 }
 
 /**
@@ -181,11 +185,21 @@ class BufferedTx(frequency: Int, baudRate: Int) extends Module {
  *   0x08: INTERRUPT - Interrupt enable/status (write: enable, read: N/A)
  *   0x0C: RX_DATA   - Received data from FIFO (read dequeues one byte)
  *   0x10: TX_DATA   - Transmit data (write-only)
+ *   0x14: IRQ_EN    - irq enables: bit 0 RX FIFO non-empty, bit 1 TX ready
  *
  * Features:
  *   - 4-entry RX FIFO: Buffers incoming bytes to prevent character loss
  *     when CPU is busy. STATUS.rx_valid reflects FIFO non-empty status.
  *   - Backpressure: RX module won't start receiving new byte if FIFO is full.
+ *   - Transaction-level sideband for simulation: tx_byte reports each byte
+ *     accepted into the TX buffer, and rx_inject enqueues bytes straight into
+ *     the RX FIFO (bypassing the serial line). Leave rx_inject.valid low on
+ *     hardware; the Verilator harness drives it in --uart-fast mode. tx_busy
+ *     is high while a byte waits or is being sent, so the harness does not
+ *     take a wfi waiting for TX ready for an idle program.
+ *   - irq: level interrupt for buffered drivers, high while an enabled
+ *     condition holds (RX FIFO non-empty, TX buffer ready). signal_interrupt
+ *     keeps the older RX flag behavior of the INTERRUPT register.
  *
  * Limitations:
  *   - Single-byte TX buffer: If TX buffer is full when CPU writes to TX_DATA,
@@ -203,9 +217,16 @@ class Uart(frequency: Int, baudRate: Int) extends Module {
     val rxd              = Input(UInt(1.W))
     val txd              = Output(UInt(1.W))
     val signal_interrupt = Output(Bool())
+    val irq              = Output(Bool()) // Enabled RX/TX conditions (IRQ_EN)
+
+    // Simulation sideband (see class comment)
+    val tx_byte   = Output(Valid(UInt(8.W)))
+    val tx_busy   = Output(Bool())
+    val rx_inject = Flipped(Decoupled(UInt(8.W)))
   })
 
   val interrupt = RegInit(false.B)
+  val irq_en    = RegInit(0.U(2.W))
   val slave     = Module(new AXI4LiteSlave(8, Parameters.DataBits))
   slave.io.channels <> io.channels
 
@@ -224,6 +245,7 @@ class Uart(frequency: Int, baudRate: Int) extends Module {
   val addr_interrupt = addr === REG_INTERRUPT.U
   val addr_rx_data   = addr === REG_RX_DATA.U
   val addr_tx_data   = addr === REG_TX_DATA.U
+  val addr_irq_en    = addr === REG_IRQ_EN.U
 
   // AXI4-Lite Read handling
   // Only assert read_valid when there's an active read request
@@ -238,10 +260,17 @@ class Uart(frequency: Int, baudRate: Int) extends Module {
     read_data_prepared := baudRate.U
   }.elsewhen(addr_rx_data) {
     read_data_prepared := rxFifo.io.deq.bits
+  }.elsewhen(addr_irq_en) {
+    read_data_prepared := irq_en
   }
 
   // RX FIFO connections: RX module -> FIFO -> CPU read
-  rxFifo.io.enq <> rx.io.channel
+  // Injected bytes take priority; the serial receiver is held off (it keeps
+  // the byte in valReg) for the cycle an injected byte is enqueued.
+  rxFifo.io.enq.valid := rx.io.channel.valid || io.rx_inject.valid
+  rxFifo.io.enq.bits  := Mux(io.rx_inject.valid, io.rx_inject.bits, rx.io.channel.bits)
+  rx.io.channel.ready := rxFifo.io.enq.ready && !io.rx_inject.valid
+  io.rx_inject.ready  := rxFifo.io.enq.ready
   // Dequeue from FIFO when CPU reads UART_RECV
   rxFifo.io.deq.ready := slave.io.bundle.read && addr_rx_data
 
@@ -263,6 +292,10 @@ class Uart(frequency: Int, baudRate: Int) extends Module {
     }
   }
 
+  when(slave.io.bundle.write && addr_irq_en) {
+    irq_en := slave.io.bundle.write_data(1, 0)
+  }
+
   // TX channel: only write when buffer is ready (backpressure handling)
   tx.io.channel.valid := false.B
   tx.io.channel.bits  := 0.U
@@ -278,7 +311,12 @@ class Uart(frequency: Int, baudRate: Int) extends Module {
     // Production implementation should stall AXI response until buffer ready.
   }
 
+  io.tx_byte.valid    := tx.io.channel.fire
+  io.tx_byte.bits     := tx.io.channel.bits
+  io.tx_busy          := tx.io.busy
+
   io.txd              := tx.io.txd
   rx.io.rxd           := io.rxd
   io.signal_interrupt := interrupt
+  io.irq              := (irq_en(0) && rxFifo.io.deq.valid) || (irq_en(1) && tx.io.channel.ready)
 }
@@ -25,23 +25,37 @@ import riscv.Parameters
  * VGA timing: 640×480 @ 72Hz
  *   H_TOTAL=832, V_TOTAL=520, pixel clock=31.5 MHz
  *
+ * Simulation sideband:
+ *   fb_write reports every framebuffer word written over MMIO, and ctrl and
+ *   palette mirror the display registers, so a harness can rebuild frames at
+ *   transaction level instead of sampling the 640×480 pixel stream.
+ *
  * Lost-sync detection:
  *   The timing_error_count field in STATUS tracks timing anomalies in the pixel
  *   clock domain. Errors indicate counter overflow (h_count >= H_TOTAL or
  *   v_count >= V_TOTAL) which should never occur in normal operation. Non-zero
  *   values suggest clock domain issues, configuration errors, or hardware faults.
  */
+class VGAFramebufferWrite extends Bundle {
+  val address = UInt(13.W) // Word index: frame * 512 + pixel / 8
+  val data    = UInt(32.W) // 8 palette indices, pixel 0 in bits 3:0
+}
+
 class VGA extends Module {
   val io = IO(new Bundle {
-    val channels    = Flipped(new AXI4LiteChannels(8, Parameters.DataBits))
-    val pixClock    = Input(Clock())     // VGA pixel clock (31.5 MHz)
-    val hsync       = Output(Bool())     // Horizontal sync
-    val vsync       = Output(Bool())     // Vertical sync
-    val rrggbb      = Output(UInt(6.W))  // 6-bit color output
-    val activevideo = Output(Bool())     // Active display region
-    val intr        = Output(Bool())     // Interrupt output (vblank)
-    val x_pos       = Output(UInt(10.W)) // Current pixel X position
-    val y_pos       = Output(UInt(10.W)) // Current pixel Y position
+    val channels     = Flipped(new AXI4LiteChannels(8, Parameters.DataBits))
+    val pixClock     = Input(Clock())     // VGA pixel clock (31.5 MHz)
+    val hsync        = Output(Bool())     // Horizontal sync
+    val vsync        = Output(Bool())     // Vertical sync
+    val rrggbb       = Output(UInt(6.W))  // 6-bit color output
+    val activevideo  = Output(Bool())     // Active display region
+    val intr         = Output(Bool())     // Interrupt output (vblank)
+    val vblank_armed = Output(Bool())     // Vblank interrupt enabled on a running display
+    val x_pos        = Output(UInt(10.W)) // Current pixel X position
+    val y_pos        = Output(UInt(10.W)) // Current pixel Y position
+    val fb_write     = Output(Valid(new VGAFramebufferWrite)) // Simulation sideband
+    val ctrl         = Output(UInt(32.W))                     // CTRL register (simulation sideband)
+    val palette      = Output(Vec(16, UInt(6.W)))             // Palette registers (simulation sideband)
   })
 
   // ============ VGA Timing Parameters ============
@@ -161,7 +175,8 @@ class VGA extends Module {
       intrStatusReg := 1.U
     }
 
-    io.intr := (intrStatusReg =/= 0.U) && ctrl_vblank_ie
+    io.intr         := (intrStatusReg =/= 0.U) && ctrl_vblank_ie
+    io.vblank_armed := ctrl_vblank_ie && ctrl_en
 
     // MMIO address decode (mask to get offset within peripheral)
     val addr             = slave.io.bundle.address & 0xff.U // VGA registers at 0x00-0xFF
@@ -267,6 +282,12 @@ class VGA extends Module {
     framebuffer.io.wea   := fb_write_en
     framebuffer.io.addra := fb_write_addr
     framebuffer.io.dina  := fb_write_data
+
+    io.fb_write.valid        := fb_write_en
+    io.fb_write.bits.address := fb_write_addr
+    io.fb_write.bits.data    := fb_write_data
+    io.ctrl                  := ctrlReg
+    io.palette               := paletteReg
   }
 
   // ============ Pixel Clock Domain (pixclk) ============
@@ -11,12 +11,15 @@ import chisel3.util._
  * CPU implementation variants.
  *
  * Historical note: Values 0-2 were earlier implementations (single-cycle, stall-only,
- * basic forwarding) that have been superseded. Only FiveStageFinal (3) remains as
- * the production-ready 5-stage pipelined processor with full forwarding and early
- * branch resolution.
+ * basic forwarding) that have been superseded. FiveStageFinal (3) is the
+ * production-ready 5-stage pipelined processor with full forwarding and early
+ * branch resolution. DualIssue (4) is the same pipeline two instructions wide:
+ * a second ALU-only issue slot beside the first, which keeps the only memory
+ * pipe (PipelinedCPU with dualIssue).
  */
 object ImplementationType {
   val FiveStageFinal = 3
+  val DualIssue      = 4
 }
 
 /**
@@ -25,8 +28,39 @@ object ImplementationType {
  * These parameters define the processor's architectural width, memory layout,
  * and peripheral configuration. Changing these values affects hardware synthesis
  * and software compatibility.
+ *
+ * The microarchitecture knobs (predictor, cache, TCM, store buffer, divider and
+ * peripheral sizes) can be overridden at elaboration without editing this
+ * file: MYCPU_PARAMS="BTBEntries=64,DividerRadix4=false" in the environment
+ * of the Verilog generator, as scripts/sweep.py does. Unknown names fail the
+ * elaboration.
  */
 object Parameters {
+  private val overrides: Map[String, String] =
+    sys.env
+      .getOrElse("MYCPU_PARAMS", "")
+      .split(',')
+      .map(_.trim)
+      .filter(_.nonEmpty)
+      .map { setting =>
+        setting.split("=", 2) match {
+          case Array(name, value) => name.trim -> value.trim
+          case _                  => throw new IllegalArgumentException(s"MYCPU_PARAMS: expected name=value, got $setting")
+        }
+      }
+      .toMap
+  private val tunable = scala.collection.mutable.Set[String]()
+
+  private def tune(name: String, default: Int): Int = {
+    tunable += name
+    overrides.get(name).map(_.toInt).getOrElse(default)
+  }
+
+  private def tune(name: String, default: Boolean): Boolean = {
+    tunable += name
+    overrides.get(name).map(_.toBoolean).getOrElse(default)
+  }
+
   // RV32I: 32-bit address and data widths
   val AddrBits  = 32
   val AddrWidth = AddrBits.W
@@ -63,12 +97,100 @@ object Parameters {
   // Program entry point: 0x1000 (after reset vector area)
   val EntryAddress = 0x1000.U(Parameters.AddrWidth)
 
-  // AXI4-Lite bus topology: single master (CPU), 8 slave address regions
-  // Address decoding uses upper 3 bits: 0x00-0x1F=RAM, 0x20-0x3F=VGA, etc.
-  val MasterDeviceCount    = 1
+  // AXI4-Lite bus topology: three masters share the CPU's bus (the DMA
+  // controller, instruction cache refills and data accesses), 8 slave address
+  // regions. Address decoding uses upper 3 bits: 0x00-0x1F=RAM, 0x20-0x3F=VGA, etc.
+  val MasterDeviceCount    = 3
   val SlaveDeviceCount     = 8
   val SlaveDeviceCountBits = log2Up(Parameters.SlaveDeviceCount) // 3 bits
 
+  // Pipeline variant (ImplementationType): 3 is the single-issue pipeline, 4
+  // the dual-issue one, which pairs instructions only with the instruction
+  // cache on
+  val Implementation = tune("Implementation", ImplementationType.FiveStageFinal)
+
+  // Branch prediction (InstructionFetch): BTB size and associativity, and the
+  // gshare direction predictor for conditional branches (0 history bits turns
+  // it into a bimodal table)
+  val BTBEntries        = tune("BTBEntries", 32)
+  val BTBWays           = tune("BTBWays", 2)
+  val PHTEntries        = tune("PHTEntries", 256)
+  val GlobalHistoryBits = tune("GlobalHistoryBits", 8)
+
+  // Return address stack depth, and the indirect jump target predictor: entries
+  // and ways (powers of 2) and path history bits (0 indexes by PC alone)
+  val RASDepth               = tune("RASDepth", 8)
+  val IndirectBTBEntries     = tune("IndirectBTBEntries", 64)
+  val IndirectBTBWays        = tune("IndirectBTBWays", 4)
+  val IndirectBTBHistoryBits = tune("IndirectBTBHistoryBits", 8)
+
+  // Instruction cache (PipelinedCPU fetch path): lines in total, ways per set
+  // and words per line; 1 KiB in 2 ways by default. 0 lines fetches from the
+  // external instruction port instead, with no latency.
+  val ICacheLines     = tune("ICacheLines", 64)
+  val ICacheWays      = tune("ICacheWays", 2)
+  val ICacheLineWords = tune("ICacheLineWords", 4)
+
+  // Data cache (between MemoryAccess and the bus, main memory only): the
+  // same geometry, write-back. 0 lines sends every load and store to the bus,
+  // the default until make check-cached has passed with it on.
+  val DCacheLines     = tune("DCacheLines", 0)
+  val DCacheWays      = tune("DCacheWays", 2)
+  val DCacheLineWords = tune("DCacheLineWords", 4)
+
+  // The page below the program image is never cached and its stores never
+  // merge: the simulator decodes its control registers (0x100, see
+  // common/sim/sim_control.h) from the writes there, so each store must reach
+  // the bus, once and in order
+  val UncachedBytes = 0x1000
+
+  // Main memory (device 0) above the uncached page: what the data cache holds
+  // and the store buffer may merge
+  def cacheable(address: UInt): Bool =
+    address(AddrBits - 1, AddrBits - SlaveDeviceCountBits) === 0.U &&
+      address(AddrBits - SlaveDeviceCountBits - 1, log2Ceil(UncachedBytes)) =/= 0.U
+
+  // Data TCM (DataTCM, beside MemoryAccess): on-chip RAM at DataTCMBase that
+  // loads and stores reach in the MEM cycle without the bus. It shadows that
+  // main memory range for the CPU only; csrc/link.lds puts the .tcm sections
+  // there (and the stack on request). 0 bytes sends those addresses to main
+  // memory, the default until make check-tcm has passed with 16384.
+  val DataTCMBase  = 0x00300000L
+  val DataTCMBytes = tune("DataTCMBytes", 0)
+
+  // Store buffer between MemoryAccess and the data cache: stores complete at
+  // once and drain in the background. 0 entries holds every store until done,
+  // the default until make check-cached has passed with it on.
+  val StoreBufferEntries = tune("StoreBufferEntries", 0)
+
+  // Cache refills and dirty line write-backs as one AXI4 INCR burst per line;
+  // false sends a single-beat transaction per word instead
+  val MemoryBursts = tune("MemoryBursts", true)
+
+  // DIV/REM on the radix-4 divider (2 quotient bits per cycle, stops early);
+  // false keeps the fixed-latency combinational one
+  val DividerRadix4 = tune("DividerRadix4", true)
+
+  // Bit manipulation (Zba, Zbb and Zbs, together the B extension) in the
+  // ALU; false decodes those encodings as before. Build csrc to match
+  // (BITMANIP=0 for a core without them)
+  val BitManip = tune("BitManip", true)
+
+  // DMA controller: words read from main memory per burst (and written per
+  // burst to it)
+  val DMABufferWords = tune("DMABufferWords", 4)
+
+  // Audio peripheral sample FIFO: 16-bit samples queued for the 11025 Hz
+  // output, about 1.5 s at the default depth
+  val AudioFifoDepth = tune("AudioFifoDepth", 16384)
+
+  // Hardware synthesizer voices, stepped one per cycle by a shared datapath
+  // after every sample tick (4 to 32)
+  val HWSynthVoices = tune("HWSynthVoices", 16)
+
   // Default timer interval: 1 second at 100MHz clock
   val TimerDefaultLimit = 100000000
+
+  private val unknown = overrides.keySet -- tunable
+  require(unknown.isEmpty, s"MYCPU_PARAMS: unknown parameters ${unknown.mkString(", ")}")
 }
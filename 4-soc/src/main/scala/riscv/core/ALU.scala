@@ -23,7 +23,11 @@ object ALUFunctions extends ChiselEnum {
   val zero, add, sub, sll, slt, xor, or, and, srl, sra, sltu,
       mul, mulh, mulhsu, mulhu, div, divu, rem, remu,
       qmul16, sadd16, ssub16, sadd32, ssub32,
-      qmul16r, sshl16, qmul32x16 = Value
+      qmul16r, sshl16, qmul32x16,
+      pqmul16, psadd16, pssub16, pdot16,
+      sh1add, sh2add, sh3add, andn, orn, xnor, clz, ctz, cpop,
+      min, minu, max, maxu, sextb, sexth, zexth, rol, ror, orcb, rev8,
+      bclr, bext, binv, bset = Value
 }
 
 /**
@@ -39,6 +43,15 @@ object ALUFunctions extends ChiselEnum {
  * separate Multiplier module for multi-cycle execution. The ALU simply
  * passes through the multiplier result when func is mul/mulh/mulhsu/mulhu.
  *
+ * Packed DSP functions (pqmul16, psadd16, pssub16) apply the matching 16-bit
+ * operation to both halves of op1/op2 at once; pdot16 sums the two lane
+ * products for a 32-bit accumulator.
+ *
+ * Bit manipulation (Zba, Zbb, Zbs) functions take rs1 as op1 and rs2 or the
+ * immediate as op2: shNadd adds op1 << N to op2, the bit ops (bclr, bext,
+ * binv, bset) and rotates index op2[4:0], and the unary ones (clz, ctz, cpop,
+ * sext/zext, orc.b, rev8) ignore op2.
+ *
  * Shift amounts use only lower 5 bits of op2 (RISC-V spec: shamt[4:0]).
  * Comparison results are 1-bit values zero-extended to 32 bits.
  *
@@ -58,6 +71,15 @@ class ALU extends Module {
     val div_result = Input(UInt(Parameters.DataWidth))
   })
 
+  // Packed 2x16 helpers: lanes are (op[15:0], op[31:16]) as signed Q15
+  def lanes(x: UInt): Seq[SInt] = Seq(x(15, 0).asSInt, x(31, 16).asSInt)
+  def saturate16(x: SInt): UInt =
+    Mux(x > 32767.S, 0x7fff.U(16.W), Mux(x < -32768.S, 0x8000.U(16.W), x(15, 0)))
+
+  val shamt = io.op2(4, 0)
+  val bit   = UIntToOH(shamt, Parameters.DataBits)
+  val twice = Cat(io.op1, io.op1) // Rotates take a window of two copies
+
   io.result := 0.U
   switch(io.func) {
     is(ALUFunctions.add) {
@@ -184,5 +206,99 @@ class ALU extends Module {
       // Right shift by 15, keep lower 32 bits
       io.result := (product >> 15)(31, 0)
     }
+    // Packed DSP: both 16-bit lanes at once, each like its scalar op
+    is(ALUFunctions.pqmul16) {
+      val products = lanes(io.op1).zip(lanes(io.op2)).map { case (a, b) => ((a * b).asUInt >> 15)(15, 0) }
+      io.result := Cat(products(1), products(0))
+    }
+    is(ALUFunctions.psadd16) {
+      val sums = lanes(io.op1).zip(lanes(io.op2)).map { case (a, b) => saturate16(a +& b) }
+      io.result := Cat(sums(1), sums(0))
+    }
+    is(ALUFunctions.pssub16) {
+      val diffs = lanes(io.op1).zip(lanes(io.op2)).map { case (a, b) => saturate16(a -& b) }
+      io.result := Cat(diffs(1), diffs(0))
+    }
+    is(ALUFunctions.pdot16) {
+      // (a.lo * b.lo + a.hi * b.hi) >> 15: at most 2^16, no saturation needed
+      val products = lanes(io.op1).zip(lanes(io.op2)).map { case (a, b) => a * b }
+      val sum      = products(0) +& products(1)
+      io.result := (sum >> 15).pad(32).asUInt
+    }
+    // Zba: address generation
+    is(ALUFunctions.sh1add) {
+      io.result := (io.op1 << 1)(31, 0) + io.op2
+    }
+    is(ALUFunctions.sh2add) {
+      io.result := (io.op1 << 2)(31, 0) + io.op2
+    }
+    is(ALUFunctions.sh3add) {
+      io.result := (io.op1 << 3)(31, 0) + io.op2
+    }
+    // Zbb: logic with negate, counts, min/max, extension, rotates, bytes
+    is(ALUFunctions.andn) {
+      io.result := io.op1 & ~io.op2
+    }
+    is(ALUFunctions.orn) {
+      io.result := io.op1 | ~io.op2
+    }
+    is(ALUFunctions.xnor) {
+      io.result := ~(io.op1 ^ io.op2)
+    }
+    is(ALUFunctions.clz) {
+      io.result := Mux(io.op1 === 0.U, 32.U, PriorityEncoder(Reverse(io.op1)))
+    }
+    is(ALUFunctions.ctz) {
+      io.result := Mux(io.op1 === 0.U, 32.U, PriorityEncoder(io.op1))
+    }
+    is(ALUFunctions.cpop) {
+      io.result := PopCount(io.op1)
+    }
+    is(ALUFunctions.min) {
+      io.result := Mux(io.op1.asSInt < io.op2.asSInt, io.op1, io.op2)
+    }
+    is(ALUFunctions.minu) {
+      io.result := Mux(io.op1 < io.op2, io.op1, io.op2)
+    }
+    is(ALUFunctions.max) {
+      io.result := Mux(io.op1.asSInt < io.op2.asSInt, io.op2, io.op1)
+    }
+    is(ALUFunctions.maxu) {
+      io.result := Mux(io.op1 < io.op2, io.op2, io.op1)
+    }
+    is(ALUFunctions.sextb) {
+      io.result := Cat(Fill(24, io.op1(7)), io.op1(7, 0))
+    }
+    is(ALUFunctions.sexth) {
+      io.result := Cat(Fill(16, io.op1(15)), io.op1(15, 0))
+    }
+    is(ALUFunctions.zexth) {
+      io.result := io.op1(15, 0)
+    }
+    is(ALUFunctions.rol) {
+      io.result := (twice << shamt)(63, 32)
+    }
+    is(ALUFunctions.ror) {
+      io.result := (twice >> shamt)(31, 0)
+    }
+    is(ALUFunctions.orcb) {
+      io.result := Cat((3 to 0 by -1).map(i => Fill(8, io.op1(8 * i + 7, 8 * i).orR)))
+    }
+    is(ALUFunctions.rev8) {
+      io.result := Cat((0 until 4).map(i => io.op1(8 * i + 7, 8 * i)))
+    }
+    // Zbs: single bit at op2[4:0]
+    is(ALUFunctions.bclr) {
+      io.result := io.op1 & ~bit
+    }
+    is(ALUFunctions.bext) {
+      io.result := (io.op1 >> shamt)(0)
+    }
+    is(ALUFunctions.binv) {
+      io.result := io.op1 ^ bit
+    }
+    is(ALUFunctions.bset) {
+      io.result := io.op1 | bit
+    }
   }
 }
@@ -12,16 +12,79 @@ import riscv.core.InstructionsTypeI
 import riscv.core.InstructionsTypeR
 import riscv.core.InstructionsTypeM
 import riscv.core.InstructionsTypeDSP
+import riscv.core.InstructionsTypeDSPPacked
+import riscv.core.InstructionsTypeBitManip
+import riscv.Parameters
 
 class ALUControl extends Module {
   val io = IO(new Bundle {
     val opcode = Input(UInt(7.W))
     val funct3 = Input(UInt(3.W))
     val funct7 = Input(UInt(7.W))
+    val rs2    = Input(UInt(5.W)) // Selects the unary bit manipulation ops
 
     val alu_funct = Output(ALUFunctions())
   })
 
+  // Zba/Zbb/Zbs by funct7 group and funct3; zero for any other encoding,
+  // which then decodes as the base instruction
+  def op(funct7: UInt, funct3: Int): UInt = Cat(funct7, funct3.U(3.W))
+  val funct   = Cat(io.funct7, io.funct3)
+  val is_rev8 = io.rs2 === InstructionsTypeBitManip.rev8
+  val is_orcb = io.rs2 === InstructionsTypeBitManip.orcb
+
+  val bitmanip_immediate = MuxLookup(
+    funct,
+    ALUFunctions.zero
+  )(
+    IndexedSeq(
+      op(InstructionsTypeBitManip.rot, 1) -> MuxLookup(
+        io.rs2,
+        ALUFunctions.zero
+      )(
+        IndexedSeq(
+          InstructionsTypeBitManip.clz   -> ALUFunctions.clz,
+          InstructionsTypeBitManip.ctz   -> ALUFunctions.ctz,
+          InstructionsTypeBitManip.cpop  -> ALUFunctions.cpop,
+          InstructionsTypeBitManip.sextb -> ALUFunctions.sextb,
+          InstructionsTypeBitManip.sexth -> ALUFunctions.sexth
+        )
+      ),
+      op(InstructionsTypeBitManip.rot, 5)  -> ALUFunctions.ror,
+      op(InstructionsTypeBitManip.bclr, 1) -> ALUFunctions.bclr,
+      op(InstructionsTypeBitManip.bclr, 5) -> ALUFunctions.bext,
+      op(InstructionsTypeBitManip.binv, 1) -> ALUFunctions.binv,
+      op(InstructionsTypeBitManip.binv, 5) -> Mux(is_rev8, ALUFunctions.rev8, ALUFunctions.zero),
+      op(InstructionsTypeBitManip.bset, 1) -> ALUFunctions.bset,
+      op(InstructionsTypeBitManip.bset, 5) -> Mux(is_orcb, ALUFunctions.orcb, ALUFunctions.zero)
+    )
+  )
+
+  val bitmanip_register = MuxLookup(
+    funct,
+    ALUFunctions.zero
+  )(
+    IndexedSeq(
+      op(InstructionsTypeBitManip.shadd, 2)  -> ALUFunctions.sh1add,
+      op(InstructionsTypeBitManip.shadd, 4)  -> ALUFunctions.sh2add,
+      op(InstructionsTypeBitManip.shadd, 6)  -> ALUFunctions.sh3add,
+      op(InstructionsTypeBitManip.inv, 4)    -> ALUFunctions.xnor,
+      op(InstructionsTypeBitManip.inv, 6)    -> ALUFunctions.orn,
+      op(InstructionsTypeBitManip.inv, 7)    -> ALUFunctions.andn,
+      op(InstructionsTypeBitManip.minmax, 4) -> ALUFunctions.min,
+      op(InstructionsTypeBitManip.minmax, 5) -> ALUFunctions.minu,
+      op(InstructionsTypeBitManip.minmax, 6) -> ALUFunctions.max,
+      op(InstructionsTypeBitManip.minmax, 7) -> ALUFunctions.maxu,
+      op(InstructionsTypeBitManip.rot, 1)    -> ALUFunctions.rol,
+      op(InstructionsTypeBitManip.rot, 5)    -> ALUFunctions.ror,
+      op(InstructionsTypeBitManip.zexth, 4)  -> Mux(io.rs2 === 0.U, ALUFunctions.zexth, ALUFunctions.zero),
+      op(InstructionsTypeBitManip.bclr, 1)   -> ALUFunctions.bclr,
+      op(InstructionsTypeBitManip.bclr, 5)   -> ALUFunctions.bext,
+      op(InstructionsTypeBitManip.binv, 1)   -> ALUFunctions.binv,
+      op(InstructionsTypeBitManip.bset, 1)   -> ALUFunctions.bset
+    )
+  )
+
   io.alu_funct := ALUFunctions.zero
 
   switch(io.opcode) {
@@ -41,6 +104,11 @@ class ALUControl extends Module {
           InstructionsTypeI.sri   -> Mux(io.funct7(5), ALUFunctions.sra, ALUFunctions.srl)
         )
       )
+      if (Parameters.BitManip) {
+        when(bitmanip_immediate =/= ALUFunctions.zero) {
+          io.alu_funct := bitmanip_immediate
+        }
+      }
     }
     is(InstructionTypes.RM) {
       // Check if this is M-extension (funct7 = 0x01) or R-type (funct7 = 0x00/0x20)
@@ -78,6 +146,11 @@ class ALUControl extends Module {
             InstructionsTypeR.sr      -> Mux(io.funct7(5), ALUFunctions.sra, ALUFunctions.srl)
           )
         )
+        if (Parameters.BitManip) {
+          when(bitmanip_register =/= ALUFunctions.zero) {
+            io.alu_funct := bitmanip_register
+          }
+        }
       }
     }
     is(InstructionTypes.B) {
@@ -103,21 +176,36 @@ class ALUControl extends Module {
     }
     is(InstructionTypes.CUSTOM) {
       // DSP extension instructions (custom-0)
-      io.alu_funct := MuxLookup(
-        io.funct3,
-        ALUFunctions.zero
-      )(
-        IndexedSeq(
-          InstructionsTypeDSP.qmul16 -> ALUFunctions.qmul16,
-          InstructionsTypeDSP.sadd16 -> ALUFunctions.sadd16,
-          InstructionsTypeDSP.ssub16 -> ALUFunctions.ssub16,
-          InstructionsTypeDSP.sadd32 -> ALUFunctions.sadd32,
-          InstructionsTypeDSP.ssub32 -> ALUFunctions.ssub32,
-          InstructionsTypeDSP.qmul16r -> ALUFunctions.qmul16r,
-          InstructionsTypeDSP.sshl16 -> ALUFunctions.sshl16,
-          InstructionsTypeDSP.qmul32x16 -> ALUFunctions.qmul32x16
+      when(io.funct7 === InstructionsTypeDSPPacked.funct7) {
+        // Packed 2x16 variants
+        io.alu_funct := MuxLookup(
+          io.funct3,
+          ALUFunctions.zero
+        )(
+          IndexedSeq(
+            InstructionsTypeDSPPacked.pqmul16 -> ALUFunctions.pqmul16,
+            InstructionsTypeDSPPacked.psadd16 -> ALUFunctions.psadd16,
+            InstructionsTypeDSPPacked.pssub16 -> ALUFunctions.pssub16,
+            InstructionsTypeDSPPacked.pdot16  -> ALUFunctions.pdot16
+          )
         )
-      )
+      }.otherwise {
+        io.alu_funct := MuxLookup(
+          io.funct3,
+          ALUFunctions.zero
+        )(
+          IndexedSeq(
+            InstructionsTypeDSP.qmul16 -> ALUFunctions.qmul16,
+            InstructionsTypeDSP.sadd16 -> ALUFunctions.sadd16,
+            InstructionsTypeDSP.ssub16 -> ALUFunctions.ssub16,
+            InstructionsTypeDSP.sadd32 -> ALUFunctions.sadd32,
+            InstructionsTypeDSP.ssub32 -> ALUFunctions.ssub32,
+            InstructionsTypeDSP.qmul16r -> ALUFunctions.qmul16r,
+            InstructionsTypeDSP.sshl16 -> ALUFunctions.sshl16,
+            InstructionsTypeDSP.qmul32x16 -> ALUFunctions.qmul32x16
+          )
+        )
+      }
     }
   }
 }
@@ -12,9 +12,11 @@ import riscv.Parameters
  * Branch Target Buffer with 2-bit Saturating Counter Predictor
  *
  * Architecture:
- * - Direct-mapped cache indexed by PC bits (configurable size, default 16 entries)
+ * - Set-associative cache indexed by PC bits (default 16 entries, direct-mapped)
  * - Each entry stores: valid bit, tag, target address, 2-bit counter
  * - Prediction: taken on hit AND counter >= 2 (weakly/strongly taken)
+ * - Replacement: an invalid way if there is one, otherwise the first way whose
+ *   not-recently-used bit is clear (true LRU for 2 ways)
  *
  * 2-bit Saturating Counter States:
  * - 0: Strongly Not Taken (SNT)
@@ -30,17 +32,24 @@ import riscv.Parameters
  * Operation:
  * - IF stage: Look up BTB using current PC, predict taken if hit && counter >= 2
  * - ID stage: Update BTB when branch/jump resolves, adjust counter
+ * - hit/target are also provided on their own, for a separate direction
+ *   predictor (see PatternHistoryTable)
  *
  * Performance:
  * - Better than static "always taken" for alternating branch patterns
  * - Hysteresis prevents single misprediction from flipping direction
+ * - Associativity removes conflict misses between hot branches whose PCs
+ *   share index bits (e.g. loops 2^n words apart)
  *
  * @param entries Number of BTB entries (must be power of 2)
+ * @param ways    Entries per set (power of 2, at most entries)
  */
-class BranchTargetBuffer(entries: Int = 16) extends Module {
+class BranchTargetBuffer(entries: Int = 16, ways: Int = 1) extends Module {
   require(isPow2(entries), "BTB entries must be power of 2")
+  require(isPow2(ways) && ways <= entries, "BTB ways must be a power of 2 no larger than entries")
 
-  val indexBits = log2Ceil(entries)
+  val sets      = entries / ways
+  val indexBits = log2Ceil(sets)
   val tagBits   = Parameters.AddrBits - indexBits - 2 // -2 for 4-byte alignment
 
   val io = IO(new Bundle {
@@ -48,6 +57,8 @@ class BranchTargetBuffer(entries: Int = 16) extends Module {
     val pc              = Input(UInt(Parameters.AddrWidth))
     val predicted_pc    = Output(UInt(Parameters.AddrWidth))
     val predicted_taken = Output(Bool())
+    val hit             = Output(Bool())                     // Entry present, whatever its counter
+    val target          = Output(UInt(Parameters.AddrWidth)) // Stored target (valid on hit)
 
     // Update interface (ID stage) - registered update
     val update_valid  = Input(Bool())
@@ -56,57 +67,81 @@ class BranchTargetBuffer(entries: Int = 16) extends Module {
     val update_taken  = Input(Bool()) // Whether branch was actually taken
   })
 
-  // BTB entry structure
-  val valid   = RegInit(VecInit(Seq.fill(entries)(false.B)))
-  val tags    = Reg(Vec(entries, UInt(tagBits.W)))
-  val targets = Reg(Vec(entries, UInt(Parameters.AddrBits.W)))
+  // BTB entry structure: [set][way]
+  val valid   = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B)))))
+  val tags    = Reg(Vec(sets, Vec(ways, UInt(tagBits.W))))
+  val targets = Reg(Vec(sets, Vec(ways, UInt(Parameters.AddrBits.W))))
 
   // 2-bit saturating counters for direction prediction
   // States: 0=SNT, 1=WNT, 2=WT, 3=ST (predict taken when >= 2)
-  val counters = RegInit(VecInit(Seq.fill(entries)(2.U(2.W)))) // Initialize to Weakly Taken
+  val counters = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(2.U(2.W)))))) // Initialize to Weakly Taken
 
-  // Index and tag extraction (index/tag bits computed from entry count)
-  def getIndex(pc: UInt): UInt = pc(indexBits + 1, 2)
+  // Not-recently-used bits, set on every update of a way
+  val used = RegInit(VecInit(Seq.fill(sets)(0.U(ways.W))))
+
+  // Index and tag extraction (index/tag bits computed from set count)
+  def getIndex(pc: UInt): UInt = if (indexBits == 0) 0.U else pc(indexBits + 1, 2)
   def getTag(pc: UInt): UInt   = pc(Parameters.AddrBits - 1, indexBits + 2)
 
+  def lookup(index: UInt, tag: UInt): (Bool, UInt) = {
+    val matches = VecInit((0 until ways).map(w => valid(index)(w) && tags(index)(w) === tag))
+    (matches.asUInt.orR, OHToUInt(matches))
+  }
+
   // Prediction logic (combinational - available same cycle)
-  val pred_index = getIndex(io.pc)
-  val pred_tag   = getTag(io.pc)
-  val hit        = valid(pred_index) && (tags(pred_index) === pred_tag)
+  val pred_index      = getIndex(io.pc)
+  val (hit, pred_way) = lookup(pred_index, getTag(io.pc))
+  val pred_counter    = counters(pred_index)(pred_way)
+  val pred_target     = targets(pred_index)(pred_way)
 
   // Predict taken only if BTB hit AND counter indicates taken (>= 2)
-  val predict_taken = hit && (counters(pred_index) >= 2.U)
+  val predict_taken = hit && (pred_counter >= 2.U)
   io.predicted_taken := predict_taken
   // Only redirect to target when predicting taken; otherwise fall through to pc+4
-  io.predicted_pc := Mux(predict_taken, targets(pred_index), io.pc + 4.U)
+  io.predicted_pc := Mux(predict_taken, pred_target, io.pc + 4.U)
+  io.hit          := hit
+  io.target       := pred_target
 
   // Update logic (registered - takes effect next cycle)
   when(io.update_valid) {
-    val upd_index = getIndex(io.update_pc)
-    val upd_tag   = getTag(io.update_pc)
-    val entry_hit = valid(upd_index) && (tags(upd_index) === upd_tag)
+    val upd_index            = getIndex(io.update_pc)
+    val upd_tag              = getTag(io.update_pc)
+    val (entry_hit, hit_way) = lookup(upd_index, upd_tag)
+
+    // Victim for a new entry: first invalid way, else first not-recently-used way
+    val invalid    = ~valid(upd_index).asUInt
+    val not_used   = ~used(upd_index)
+    val victim     = Mux(invalid.orR, PriorityEncoder(invalid), PriorityEncoder(not_used))
+    val upd_way    = Mux(entry_hit, hit_way, victim)
+    val upd_count  = counters(upd_index)(upd_way)
+    val touch_mask = UIntToOH(upd_way, ways)
+    // Clear the other bits once every way has been used
+    val touched   = used(upd_index) | touch_mask
+    val next_used = Mux(touched.andR, touch_mask, touched)
 
     when(io.update_taken) {
       // Branch taken: allocate/update entry, saturating increment counter
-      valid(upd_index)   := true.B
-      tags(upd_index)    := upd_tag
-      targets(upd_index) := io.update_target
+      valid(upd_index)(upd_way)   := true.B
+      tags(upd_index)(upd_way)    := upd_tag
+      targets(upd_index)(upd_way) := io.update_target
+      used(upd_index)             := next_used
       // Saturating increment: cap at 3 (ST)
       when(entry_hit) {
-        counters(upd_index) := Mux(counters(upd_index) === 3.U, 3.U, counters(upd_index) + 1.U)
+        counters(upd_index)(upd_way) := Mux(upd_count === 3.U, 3.U, upd_count + 1.U)
       }.otherwise {
         // New entry: initialize to Weakly Taken (2)
-        counters(upd_index) := 2.U
+        counters(upd_index)(upd_way) := 2.U
       }
     }.otherwise {
       // Branch not taken: decrement counter if entry exists
       // Invalidate entry when counter reaches 0 (Strongly Not Taken) to free slot
       when(entry_hit) {
-        when(counters(upd_index) === 1.U) {
+        used(upd_index) := next_used
+        when(upd_count === 1.U) {
           // Counter will reach 0: invalidate entry instead of keeping dead weight
-          valid(upd_index) := false.B
-        }.elsewhen(counters(upd_index) > 1.U) {
-          counters(upd_index) := counters(upd_index) - 1.U
+          valid(upd_index)(upd_way) := false.B
+        }.elsewhen(upd_count > 1.U) {
+          counters(upd_index)(upd_way) := upd_count - 1.U
         }
         // counter === 0.U: already at SNT, keep saturated (shouldn't happen if we invalidate at 0)
       }
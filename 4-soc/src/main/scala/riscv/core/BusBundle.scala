@@ -4,9 +4,19 @@
 
 package riscv.core
 
+import bus.AXI4Lite
 import chisel3._
 import riscv.Parameters
 
+/**
+ * Requester side of the CPU's bus (MemoryAccess, the caches, the arbiter).
+ *
+ * A transaction starts with request and read/write high while granted. It is
+ * a single beat unless burst_length (beats - 1) is set in that cycle, which
+ * makes it an INCR burst over consecutive words: reads then see read_valid
+ * once per beat, and writes hold write_data/write_strobe for each beat until
+ * write_beat, with one write_valid at the end. Only main memory takes bursts.
+ */
 class BusBundle extends Bundle {
   val address             = Output(UInt(Parameters.AddrWidth))
   val read                = Output(Bool())
@@ -20,4 +30,6 @@ class BusBundle extends Bundle {
   val busy                = Input(Bool())
   val request             = Output(Bool())
   val granted             = Input(Bool())
+  val burst_length        = Output(UInt(AXI4Lite.lenWidth.W))
+  val write_beat          = Input(Bool()) // Burst write: current beat taken
 }
@@ -5,17 +5,31 @@
 package riscv.core
 
 import bus.AXI4LiteMaster
+import bus.BusArbiter
 import chisel3._
+import chisel3.util.OHToUInt
 import riscv.ImplementationType
 import riscv.Parameters
 // PipelinedCPU is now in the same package (riscv.core)
 
-class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends Module {
-  val io = IO(new CPUBundle)
+class CPU(
+    val implementation: Int = Parameters.Implementation,
+    val icacheLines: Int = Parameters.ICacheLines,
+    val dcacheLines: Int = Parameters.DCacheLines,
+    val dataTCMBytes: Int = Parameters.DataTCMBytes
+) extends Module {
+  val io = IO(new CPUWrapperBundle)
 
   implementation match {
-    case ImplementationType.FiveStageFinal =>
-      val cpu = Module(new PipelinedCPU)
+    case ImplementationType.FiveStageFinal | ImplementationType.DualIssue =>
+      val cpu = Module(
+        new PipelinedCPU(
+          icacheLines,
+          dcacheLines,
+          dataTCMBytes = dataTCMBytes,
+          dualIssue = implementation == ImplementationType.DualIssue
+        )
+      )
 
       // Connect instruction fetch interface
       io.instruction_address   := cpu.io.instruction_address
@@ -29,19 +43,76 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       val full_bus_address = cpu.io.device_select ## cpu.io.memory_bundle
         .address(Parameters.AddrBits - Parameters.SlaveDeviceCountBits - 1, 0)
 
-      // BusBundle to AXI4LiteMasterBundle adapter
-      axi_master.io.bundle.address      := full_bus_address
-      axi_master.io.bundle.read         := cpu.io.memory_bundle.request && cpu.io.memory_bundle.read
-      axi_master.io.bundle.write        := cpu.io.memory_bundle.request && cpu.io.memory_bundle.write
-      axi_master.io.bundle.write_data   := cpu.io.memory_bundle.write_data
-      axi_master.io.bundle.write_strobe := cpu.io.memory_bundle.write_strobe
+      // The DMA controller (master 0), instruction cache refills (master 1) and
+      // data accesses (master 2, highest priority) share the AXI4-Lite master.
+      // The arbiter decides who may start the next transaction; the winner's
+      // responses, and for a write the data it presents, are routed back to it
+      // until the transaction ends, whatever the requests do meanwhile.
+      val bus_arbiter = Module(new BusArbiter)
+      val dma_bus     = io.dma_bundle
+      val fetch_bus   = cpu.io.instruction_bundle
+      bus_arbiter.io.bus_request(0) := dma_bus.request
+      bus_arbiter.io.bus_request(1) := fetch_bus.request
+      bus_arbiter.io.bus_request(2) := cpu.io.memory_bundle.request
+      val dma_granted   = bus_arbiter.io.bus_granted(0)
+      val fetch_granted = bus_arbiter.io.bus_granted(1)
+      val data_granted  = bus_arbiter.io.bus_granted(2)
+
+      // Master of the transaction in flight
+      val owner       = RegInit(2.U(2.W))
+      val dma_owner   = owner === 0.U
+      val fetch_owner = owner === 1.U
+      val data_owner  = owner === 2.U
+
+      val data_read  = cpu.io.memory_bundle.request && cpu.io.memory_bundle.read
+      val data_write = cpu.io.memory_bundle.request && cpu.io.memory_bundle.write
+      val fetch_read = fetch_bus.request && fetch_bus.read
+      val dma_read   = dma_bus.request && dma_bus.read
+      val dma_write  = dma_bus.request && dma_bus.write
+
+      // Write data comes from the granted master when a transaction starts and
+      // from the owner for the later beats of a burst
+      val dma_writing = Mux(axi_master.io.bundle.busy, dma_owner, dma_granted)
+
+      // BusBundle to AXI4LiteMasterBundle adapter (the master samples these when idle)
+      axi_master.io.bundle.address := Mux(
+        data_granted,
+        full_bus_address,
+        Mux(fetch_granted, fetch_bus.address, dma_bus.address)
+      )
+      axi_master.io.bundle.read         := Mux(data_granted, data_read, Mux(fetch_granted, fetch_read, dma_read))
+      axi_master.io.bundle.write        := Mux(data_granted, data_write, dma_granted && dma_write)
+      axi_master.io.bundle.write_data   := Mux(dma_writing, dma_bus.write_data, cpu.io.memory_bundle.write_data)
+      axi_master.io.bundle.write_strobe := Mux(dma_writing, dma_bus.write_strobe, cpu.io.memory_bundle.write_strobe)
+      axi_master.io.bundle.burst_length := Mux(
+        data_granted,
+        cpu.io.memory_bundle.burst_length,
+        Mux(fetch_granted, fetch_bus.burst_length, dma_bus.burst_length)
+      )
 
       cpu.io.memory_bundle.read_data           := axi_master.io.bundle.read_data
-      cpu.io.memory_bundle.read_valid          := axi_master.io.bundle.read_valid
-      cpu.io.memory_bundle.write_valid         := axi_master.io.bundle.write_valid
-      cpu.io.memory_bundle.write_data_accepted := axi_master.io.bundle.write_data_accepted
+      cpu.io.memory_bundle.read_valid          := axi_master.io.bundle.read_valid && data_owner
+      cpu.io.memory_bundle.write_valid         := axi_master.io.bundle.write_valid && data_owner
+      cpu.io.memory_bundle.write_data_accepted := axi_master.io.bundle.write_data_accepted && data_owner
       cpu.io.memory_bundle.busy                := axi_master.io.bundle.busy
-      cpu.io.memory_bundle.granted             := !axi_master.io.bundle.busy // Granted when not busy
+      cpu.io.memory_bundle.granted             := !axi_master.io.bundle.busy && data_granted
+      cpu.io.memory_bundle.write_beat          := axi_master.io.bundle.write_beat && data_owner
+
+      fetch_bus.read_data           := axi_master.io.bundle.read_data
+      fetch_bus.read_valid          := axi_master.io.bundle.read_valid && fetch_owner
+      fetch_bus.write_valid         := false.B
+      fetch_bus.write_data_accepted := false.B
+      fetch_bus.busy                := axi_master.io.bundle.busy
+      fetch_bus.granted             := !axi_master.io.bundle.busy && fetch_granted
+      fetch_bus.write_beat          := false.B
+
+      dma_bus.read_data           := axi_master.io.bundle.read_data
+      dma_bus.read_valid          := axi_master.io.bundle.read_valid && dma_owner
+      dma_bus.write_valid         := axi_master.io.bundle.write_valid && dma_owner
+      dma_bus.write_data_accepted := axi_master.io.bundle.write_data_accepted && dma_owner
+      dma_bus.busy                := axi_master.io.bundle.busy
+      dma_bus.granted             := !axi_master.io.bundle.busy && dma_granted
+      dma_bus.write_beat          := axi_master.io.bundle.write_beat && dma_owner
 
       // Connect AXI4-Lite channels to top-level
       io.axi4_channels <> axi_master.io.channels
@@ -51,6 +122,7 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       cpu.io.axi4_channels.read_data_channel.RVALID      := false.B
       cpu.io.axi4_channels.read_data_channel.RDATA       := 0.U
       cpu.io.axi4_channels.read_data_channel.RRESP       := 0.U
+      cpu.io.axi4_channels.read_data_channel.RLAST       := false.B
       cpu.io.axi4_channels.write_address_channel.AWREADY := false.B
       cpu.io.axi4_channels.write_data_channel.WREADY     := false.B
       cpu.io.axi4_channels.write_response_channel.BVALID := false.B
@@ -59,7 +131,7 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       // Connect device select and bus address from wrapper
       io.device_select := cpu.io.device_select
 
-      // Latch bus address for the duration of each AXI transaction.
+      // Latch bus address (and the owner) for the duration of each AXI transaction.
       // AXI4LiteMaster captures cpu.io.memory_bundle.address in the Idle state and
       // asserts ARVALID/AWVALID on the next cycle. If the CPU pipeline advances in
       // between, the combinational cpu.io.memory_bundle.address/device_select would
@@ -67,21 +139,32 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       // wrong slave. By registering bus_address when a new request starts and
       // holding it while the master is busy, we ensure stable routing.
       val bus_address_reg  = RegInit(0.U(Parameters.AddrWidth))
-      val next_bus_address = full_bus_address
+      val next_bus_address = axi_master.io.bundle.address
 
-      // New transaction starts when master is idle (not busy) and CPU issues a
-      // read or write request on the BusBundle.
+      // New transaction starts when master is idle (not busy) and the granted
+      // side issues a read or write request on its BusBundle.
       val start_bus_transaction =
-        !axi_master.io.bundle.busy &&
-          cpu.io.memory_bundle.request &&
-          (cpu.io.memory_bundle.read || cpu.io.memory_bundle.write)
+        !axi_master.io.bundle.busy && (axi_master.io.bundle.read || axi_master.io.bundle.write)
 
       when(start_bus_transaction) {
         bus_address_reg := next_bus_address
+        owner           := OHToUInt(bus_arbiter.io.bus_granted.asUInt)
       }
 
       io.bus_address := bus_address_reg
 
+      // Words the DMA writes to main memory, one per beat taken, for the data
+      // cache to drop its copy of the line
+      val dma_write_address = RegInit(0.U(Parameters.AddrWidth))
+      when(start_bus_transaction) {
+        dma_write_address := next_bus_address
+      }.elsewhen(dma_owner && axi_master.io.bundle.write_beat) {
+        dma_write_address := dma_write_address + 4.U
+      }
+      cpu.io.snoop.valid := dma_owner && axi_master.io.bundle.write_beat &&
+        dma_write_address(Parameters.AddrBits - 1, Parameters.AddrBits - Parameters.SlaveDeviceCountBits) === 0.U
+      cpu.io.snoop.bits := dma_write_address
+
       // Connect wrapper memory_bundle outputs (pass through from CPU)
       io.memory_bundle.address      := cpu.io.memory_bundle.address
       io.memory_bundle.read         := cpu.io.memory_bundle.read
@@ -89,6 +172,7 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       io.memory_bundle.write_data   := cpu.io.memory_bundle.write_data
       io.memory_bundle.write_strobe := cpu.io.memory_bundle.write_strobe
       io.memory_bundle.request      := cpu.io.memory_bundle.request
+      io.memory_bundle.burst_length := cpu.io.memory_bundle.burst_length
 
       // Note: io.memory_bundle inputs (read_data, read_valid, write_valid, busy, granted)
       // are not connected at Top level - they're for debugging/bypass only
@@ -104,6 +188,11 @@ class CPU(val implementation: Int = ImplementationType.FiveStageFinal) extends M
       cpu.io.csr_debug_read_address := io.csr_debug_read_address
       io.csr_debug_read_data        := cpu.io.csr_debug_read_data
 
+      cpu.io.debug_write := io.debug_write
+
+      io.retire   := cpu.io.retire
+      io.retire_b := cpu.io.retire_b
+
       // Connect debug bus signals
       io.debug_bus_write_enable := cpu.io.memory_bundle.write
       io.debug_bus_write_data   := cpu.io.memory_bundle.write_data
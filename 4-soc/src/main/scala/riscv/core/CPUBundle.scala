@@ -7,8 +7,53 @@ package riscv.core
 import bus.AXI4LiteChannels
 import bus.AXI4LiteMasterBundle
 import chisel3._
+import chisel3.util.Valid
 import riscv.Parameters
 
+/**
+ * One retired instruction per cycle with valid set, in program order. The
+ * dual-issue pipeline retires up to two: the second of a pair on retire_b,
+ * which is never valid without retire in the same cycle.
+ *
+ * Sampled at the write-back stage: rd_data is the value written to rd when
+ * rd_write is set, and mem_address is the effective address of loads and
+ * stores (the ALU result otherwise). Pipeline bubbles carry a NOP encoding and
+ * are never marked valid, so architectural NOPs do not appear either.
+ */
+class RetireBundle extends Bundle {
+  val valid       = Bool()
+  val pc          = UInt(Parameters.AddrWidth)
+  val instruction = UInt(Parameters.InstructionWidth)
+  val rd_write    = Bool()
+  val rd          = UInt(Parameters.PhysicalRegisterAddrWidth)
+  val rd_data     = UInt(Parameters.DataWidth)
+  val mem_address = UInt(Parameters.AddrWidth)
+}
+
+/**
+ * One architectural state write from the simulator, used to start the
+ * pipeline from a state computed elsewhere (functional fast-forward).
+ *
+ * target selects the register file (address = register number), a CSR
+ * (address = CSR number), the PC or a data TCM word (address = word index).
+ * Writes go through the write-back and CSR write ports, so the simulator
+ * must hold instruction_valid low and let the pipeline drain to bubbles
+ * first; the PC write redirects fetch.
+ */
+class DebugWriteBundle extends Bundle {
+  val valid   = Bool()
+  val target  = UInt(2.W)
+  val address = UInt(16.W)
+  val data    = UInt(Parameters.DataWidth)
+}
+
+object DebugWriteTarget {
+  val Register = 0.U(2.W)
+  val CSR      = 1.U(2.W)
+  val PC       = 2.U(2.W)
+  val TCM      = 3.U(2.W)
+}
+
 class CPUBundle extends Bundle {
   // Instruction fetch interface
   val instruction_address = Output(UInt(Parameters.AddrWidth))
@@ -32,8 +77,38 @@ class CPUBundle extends Bundle {
   val csr_debug_read_address = Input(UInt(Parameters.CSRRegisterAddrWidth))
   val csr_debug_read_data    = Output(UInt(Parameters.DataWidth))
 
+  // State writes (simulation only; tie off with 0.U.asTypeOf)
+  val debug_write = Input(new DebugWriteBundle)
+
+  // Retire trace (simulation only; unconnected outputs are optimised away);
+  // retire_b is the younger instruction of a dual-issue pair
+  val retire   = Output(new RetireBundle)
+  val retire_b = Output(new RetireBundle)
+
   // Bus address and write strobes for BusSwitch/arbiter AXI4-Lite routing
   val bus_address            = Output(UInt(Parameters.AddrWidth))
   val debug_bus_write_enable = Output(Bool())
   val debug_bus_write_data   = Output(UInt(Parameters.DataWidth))
 }
+
+/**
+ * The CPU wrapper's interface: CPUBundle plus the port of a bus master outside
+ * the CPU (Top's DMA controller), which the wrapper arbitrates below its own
+ * accesses for the AXI4-Lite master. Keep request low without one.
+ */
+class CPUWrapperBundle extends CPUBundle {
+  val dma_bundle = Flipped(new BusBundle)
+}
+
+/**
+ * PipelinedCPU's interface: CPUBundle plus the instruction cache refill port,
+ * which the CPU wrapper arbitrates with memory_bundle for the AXI4-Lite master.
+ * Tied off when the cache is disabled (Parameters.ICacheLines = 0).
+ *
+ * snoop carries each word the DMA writes to main memory, so that the data
+ * cache drops its stale copy of the line.
+ */
+class PipelinedCPUBundle extends CPUBundle {
+  val instruction_bundle = new BusBundle
+  val snoop              = Input(Valid(UInt(Parameters.AddrWidth)))
+}
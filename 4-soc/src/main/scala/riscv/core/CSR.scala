@@ -26,6 +26,7 @@ object CSRRegister {
   // CSR addresses per RISC-V Privileged Spec v1.12, Section 3.1-3.2
   // Machine Information Registers
   val MSTATUS  = 0x300.U(Parameters.CSRRegisterAddrWidth)
+  val MISA     = 0x301.U(Parameters.CSRRegisterAddrWidth)
   val MIE      = 0x304.U(Parameters.CSRRegisterAddrWidth)
   val MTVEC    = 0x305.U(Parameters.CSRRegisterAddrWidth)
   val MSCRATCH = 0x340.U(Parameters.CSRRegisterAddrWidth)
@@ -45,20 +46,48 @@ object CSRRegister {
   val MInstretH = 0xb82.U(Parameters.CSRRegisterAddrWidth) // Upper 32 bits of minstret
 
   // Hardware Performance Counters (M-mode read/write)
-  val MHPMCounter3L = 0xb03.U(Parameters.CSRRegisterAddrWidth) // Branch mispredictions (BTB/RAS wrong)
-  val MHPMCounter3H = 0xb83.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter4L = 0xb04.U(Parameters.CSRRegisterAddrWidth) // Hazard stall cycles
-  val MHPMCounter4H = 0xb84.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter5L = 0xb05.U(Parameters.CSRRegisterAddrWidth) // Memory stall cycles
-  val MHPMCounter5H = 0xb85.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter6L = 0xb06.U(Parameters.CSRRegisterAddrWidth) // Control stall cycles (flush penalty)
-  val MHPMCounter6H = 0xb86.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter7L = 0xb07.U(Parameters.CSRRegisterAddrWidth) // BTB miss penalty (taken but not predicted)
-  val MHPMCounter7H = 0xb87.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter8L = 0xb08.U(Parameters.CSRRegisterAddrWidth) // Total branches resolved
-  val MHPMCounter8H = 0xb88.U(Parameters.CSRRegisterAddrWidth)
-  val MHPMCounter9L = 0xb09.U(Parameters.CSRRegisterAddrWidth) // BTB predictions (BTB said "taken")
-  val MHPMCounter9H = 0xb89.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter3L  = 0xb03.U(Parameters.CSRRegisterAddrWidth) // Branch mispredictions (BTB/RAS wrong)
+  val MHPMCounter3H  = 0xb83.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter4L  = 0xb04.U(Parameters.CSRRegisterAddrWidth) // Hazard stall cycles
+  val MHPMCounter4H  = 0xb84.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter5L  = 0xb05.U(Parameters.CSRRegisterAddrWidth) // Memory stall cycles
+  val MHPMCounter5H  = 0xb85.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter6L  = 0xb06.U(Parameters.CSRRegisterAddrWidth) // Control stall cycles (flush penalty)
+  val MHPMCounter6H  = 0xb86.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter7L  = 0xb07.U(Parameters.CSRRegisterAddrWidth) // BTB miss penalty (taken but not predicted)
+  val MHPMCounter7H  = 0xb87.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter8L  = 0xb08.U(Parameters.CSRRegisterAddrWidth) // Total branches resolved
+  val MHPMCounter8H  = 0xb88.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter9L  = 0xb09.U(Parameters.CSRRegisterAddrWidth) // BTB predictions (BTB said "taken")
+  val MHPMCounter9H  = 0xb89.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter10L = 0xb0a.U(Parameters.CSRRegisterAddrWidth) // Conditional branches resolved
+  val MHPMCounter10H = 0xb8a.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter11L = 0xb0b.U(Parameters.CSRRegisterAddrWidth) // PHT direction mispredictions
+  val MHPMCounter11H = 0xb8b.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter12L = 0xb0c.U(Parameters.CSRRegisterAddrWidth) // I-cache hits
+  val MHPMCounter12H = 0xb8c.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter13L = 0xb0d.U(Parameters.CSRRegisterAddrWidth) // I-cache misses (line refills)
+  val MHPMCounter13H = 0xb8d.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter14L = 0xb0e.U(Parameters.CSRRegisterAddrWidth) // D-cache hits
+  val MHPMCounter14H = 0xb8e.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter15L = 0xb0f.U(Parameters.CSRRegisterAddrWidth) // D-cache misses (line refills)
+  val MHPMCounter15H = 0xb8f.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter16L = 0xb10.U(Parameters.CSRRegisterAddrWidth) // D-cache writebacks (dirty lines)
+  val MHPMCounter16H = 0xb90.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter17L = 0xb11.U(Parameters.CSRRegisterAddrWidth) // Store buffer full stall cycles
+  val MHPMCounter17H = 0xb91.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter18L = 0xb12.U(Parameters.CSRRegisterAddrWidth) // Store drain stall cycles
+  val MHPMCounter18H = 0xb92.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter19L = 0xb13.U(Parameters.CSRRegisterAddrWidth) // Loads forwarded from the store buffer
+  val MHPMCounter19H = 0xb93.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter20L = 0xb14.U(Parameters.CSRRegisterAddrWidth) // Divider busy cycles
+  val MHPMCounter20H = 0xb94.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter21L = 0xb15.U(Parameters.CSRRegisterAddrWidth) // Divisions completed
+  val MHPMCounter21H = 0xb95.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter22L = 0xb16.U(Parameters.CSRRegisterAddrWidth) // Return mispredictions
+  val MHPMCounter22H = 0xb96.U(Parameters.CSRRegisterAddrWidth)
+  val MHPMCounter23L = 0xb17.U(Parameters.CSRRegisterAddrWidth) // Indirect jump mispredictions
+  val MHPMCounter23H = 0xb97.U(Parameters.CSRRegisterAddrWidth)
 
   // Machine Counter-Inhibit Register (0x320)
   val MCOUNTINHIBIT = 0x320.U(Parameters.CSRRegisterAddrWidth)
@@ -71,6 +100,20 @@ object CSRRegister {
   // mhpmcounter7: BTB miss penalty (branch taken but not in BTB)
   // mhpmcounter8: Total branches resolved (for accuracy = 1 - mhpmcounter3/mhpmcounter8)
   // mhpmcounter9: BTB predictions (BTB predicted "taken" for branch analysis)
+  // mhpmcounter10: Conditional branches resolved (PHT accuracy denominator)
+  // mhpmcounter11: PHT direction mispredictions (accuracy = 1 - mhpmcounter11/mhpmcounter10)
+  // mhpmcounter12: I-cache hits (fetches served without a refill)
+  // mhpmcounter13: I-cache misses (hit rate = mhpmcounter12/(mhpmcounter12+mhpmcounter13))
+  // mhpmcounter14: D-cache hits (cached loads/stores served without the bus, hits under a miss included)
+  // mhpmcounter15: D-cache misses (hit rate = mhpmcounter14/(mhpmcounter14+mhpmcounter15))
+  // mhpmcounter16: D-cache writebacks (dirty lines evicted or flushed by FENCE.I)
+  // mhpmcounter17: Store buffer full stall cycles (store waits for a free entry)
+  // mhpmcounter18: Store drain stall cycles (load of a partly buffered word, MMIO load or FENCE waiting)
+  // mhpmcounter19: Loads forwarded from the store buffer
+  // mhpmcounter20: Divider busy cycles (EX waits for DIV/REM)
+  // mhpmcounter21: Divisions completed (average divide latency = mhpmcounter20/mhpmcounter21)
+  // mhpmcounter22: Return mispredictions (returns the RAS did not predict correctly)
+  // mhpmcounter23: Indirect jump mispredictions (other JALRs the IndirectBTB did not predict correctly)
 }
 
 /**
@@ -78,7 +121,8 @@ object CSRRegister {
  *
  * Implements RISC-V privileged architecture CSRs including:
  * - Machine trap setup/handling registers (mstatus, mtvec, mepc, mcause, etc.)
- * - Hardware performance counters (mcycle, minstret, mhpmcounter3-9)
+ * - misa (0x301), read-only: RV32 IMXB, B only with Parameters.BitManip
+ * - Hardware performance counters (mcycle, minstret, mhpmcounter3-23)
  * - Counter inhibit register (mcountinhibit) for selective counter gating
  *
  * Performance Counter Mapping:
@@ -91,6 +135,20 @@ object CSRRegister {
  * - mhpmcounter7 (0xB07): BTB miss/wrong-target events [EVENTS]
  * - mhpmcounter8 (0xB08): Total branches resolved [EVENTS] (accuracy denominator)
  * - mhpmcounter9 (0xB09): BTB predictions [EVENTS] (BTB predicted "taken")
+ * - mhpmcounter10 (0xB0A): Conditional branches resolved [EVENTS]
+ * - mhpmcounter11 (0xB0B): PHT direction mispredictions [EVENTS]
+ * - mhpmcounter12 (0xB0C): I-cache hits [EVENTS]
+ * - mhpmcounter13 (0xB0D): I-cache misses (line refills) [EVENTS]
+ * - mhpmcounter14 (0xB0E): D-cache hits [EVENTS]
+ * - mhpmcounter15 (0xB0F): D-cache misses (line refills) [EVENTS]
+ * - mhpmcounter16 (0xB10): D-cache writebacks (dirty lines) [EVENTS]
+ * - mhpmcounter17 (0xB11): Store buffer full stall cycles [CYCLES]
+ * - mhpmcounter18 (0xB12): Store drain stall cycles [CYCLES]
+ * - mhpmcounter19 (0xB13): Loads forwarded from the store buffer [EVENTS]
+ * - mhpmcounter20 (0xB14): Divider busy cycles [CYCLES]
+ * - mhpmcounter21 (0xB15): Divisions completed [EVENTS]
+ * - mhpmcounter22 (0xB16): Return mispredictions [EVENTS]
+ * - mhpmcounter23 (0xB17): Indirect jump mispredictions [EVENTS]
  *
  * Counter Semantics (IMPORTANT):
  * - CYCLES counters: Increment once per clock cycle while condition is true
@@ -106,13 +164,14 @@ object CSRRegister {
  * - Control Overhead: mhpmcounter6 events (each flush = 1 cycle penalty)
  * - BTB Cold Miss Rate: mhpmcounter7 / mhpmcounter8
  * - BTB Coverage: mhpmcounter9 / mhpmcounter8 (how often BTB predicts)
+ * - PHT Accuracy: 1 - (mhpmcounter11 / mhpmcounter10)
  *
  * mcountinhibit (0x320) Bit Mapping:
  * - Bit 0: Inhibit mcycle
  * - Bit 1: Reserved (hardwired to 0)
  * - Bit 2: Inhibit minstret
- * - Bits 3-9: Inhibit mhpmcounter3-9
- * - Bits 10-31: Reserved (hardwired to 0)
+ * - Bits 3-23: Inhibit mhpmcounter3-23
+ * - Bits 24-31: Reserved (hardwired to 0)
  *
  * Features:
  * - Atomic 64-bit reads: Shadow registers latch high word when low word is read
@@ -144,6 +203,7 @@ class CSR extends Module {
 
     // Performance counter inputs (directly from pipeline stages)
     val instruction_retired  = Input(Bool()) // Instruction completed in WB stage
+    val slot_b_retired       = Input(Bool()) // Dual issue: slot B of a pair completed too
     val branch_misprediction = Input(Bool()) // BTB or RAS misprediction detected
     val hazard_stall         = Input(Bool()) // Data hazard stall (load-use, RAW)
     val memory_stall         = Input(Bool()) // Memory/AXI bus stall
@@ -151,6 +211,20 @@ class CSR extends Module {
     val btb_miss_taken       = Input(Bool()) // Branch taken but not in BTB
     val branch_resolved      = Input(Bool()) // Branch/jump resolved in ID stage
     val btb_predicted        = Input(Bool()) // BTB predicted "taken" for this branch
+    val cond_branch_resolved = Input(Bool()) // Conditional branch resolved in ID stage
+    val pht_mispredict       = Input(Bool()) // PHT predicted the wrong direction for it
+    val icache_hit           = Input(Bool()) // Fetch served by the instruction cache
+    val icache_miss          = Input(Bool()) // Instruction cache line refill started
+    val dcache_hit           = Input(Bool()) // Load/store served by the data cache
+    val dcache_miss          = Input(Bool()) // Data cache line refill started
+    val dcache_writeback     = Input(Bool()) // Dirty data cache line written back
+    val store_buffer_full    = Input(Bool()) // Store waits for a free store buffer entry
+    val store_drain_stall    = Input(Bool()) // Load or FENCE waits for buffered stores
+    val store_forwarded      = Input(Bool()) // Load answered from the store buffer
+    val divider_busy         = Input(Bool()) // EX waits for a DIV/REM
+    val divider_done         = Input(Bool()) // Divider result ready
+    val ras_mispredict       = Input(Bool()) // Return resolved without a correct RAS prediction
+    val indirect_mispredict  = Input(Bool()) // Other JALR resolved without a correct prediction
   })
 
   // Machine Trap Setup/Handling Registers
@@ -161,48 +235,97 @@ class CSR extends Module {
   val mepc     = RegInit(UInt(Parameters.DataWidth), 0.U)
   val mcause   = RegInit(UInt(Parameters.DataWidth), 0.U)
 
+  // misa: MXL = 1 (RV32), extensions I, M, X (the custom-0 DSP ops) and B
+  // (Zba, Zbb and Zbs) when built in. Read-only; writes are ignored.
+  val misa = (
+    (1L << 30) | (1L << ('X' - 'A')) | (1L << ('M' - 'A')) | (1L << ('I' - 'A')) |
+      (if (Parameters.BitManip) 1L << ('B' - 'A') else 0L)
+  ).U(Parameters.DataWidth)
+
   // Machine Counter-Inhibit Register (mcountinhibit)
   // Bit 0: CY - inhibit mcycle, Bit 2: IR - inhibit minstret
-  // Bits 3-9: HPM3-9 - inhibit mhpmcounter3-9
+  // Bits 3-23: HPM3-23 - inhibit mhpmcounter3-23
   val mcountinhibit = RegInit(0.U(32.W))
 
   // Hardware Performance Counters (64-bit)
-  val mcycle       = RegInit(0.U(64.W)) // Clock cycles
-  val minstret     = RegInit(0.U(64.W)) // Instructions retired
-  val mhpmcounter3 = RegInit(0.U(64.W)) // Branch mispredictions (BTB/RAS wrong)
-  val mhpmcounter4 = RegInit(0.U(64.W)) // Hazard stall cycles
-  val mhpmcounter5 = RegInit(0.U(64.W)) // Memory stall cycles
-  val mhpmcounter6 = RegInit(0.U(64.W)) // Control stall cycles
-  val mhpmcounter7 = RegInit(0.U(64.W)) // BTB miss penalty
-  val mhpmcounter8 = RegInit(0.U(64.W)) // Total branches resolved
-  val mhpmcounter9 = RegInit(0.U(64.W)) // BTB predictions
+  val mcycle        = RegInit(0.U(64.W)) // Clock cycles
+  val minstret      = RegInit(0.U(64.W)) // Instructions retired
+  val mhpmcounter3  = RegInit(0.U(64.W)) // Branch mispredictions (BTB/RAS wrong)
+  val mhpmcounter4  = RegInit(0.U(64.W)) // Hazard stall cycles
+  val mhpmcounter5  = RegInit(0.U(64.W)) // Memory stall cycles
+  val mhpmcounter6  = RegInit(0.U(64.W)) // Control stall cycles
+  val mhpmcounter7  = RegInit(0.U(64.W)) // BTB miss penalty
+  val mhpmcounter8  = RegInit(0.U(64.W)) // Total branches resolved
+  val mhpmcounter9  = RegInit(0.U(64.W)) // BTB predictions
+  val mhpmcounter10 = RegInit(0.U(64.W)) // Conditional branches resolved
+  val mhpmcounter11 = RegInit(0.U(64.W)) // PHT direction mispredictions
+  val mhpmcounter12 = RegInit(0.U(64.W)) // I-cache hits
+  val mhpmcounter13 = RegInit(0.U(64.W)) // I-cache misses (line refills)
+  val mhpmcounter14 = RegInit(0.U(64.W)) // D-cache hits
+  val mhpmcounter15 = RegInit(0.U(64.W)) // D-cache misses (line refills)
+  val mhpmcounter16 = RegInit(0.U(64.W)) // D-cache writebacks (dirty lines)
+  val mhpmcounter17 = RegInit(0.U(64.W)) // Store buffer full stall cycles
+  val mhpmcounter18 = RegInit(0.U(64.W)) // Store drain stall cycles
+  val mhpmcounter19 = RegInit(0.U(64.W)) // Loads forwarded from the store buffer
+  val mhpmcounter20 = RegInit(0.U(64.W)) // Divider busy cycles
+  val mhpmcounter21 = RegInit(0.U(64.W)) // Divisions completed
+  val mhpmcounter22 = RegInit(0.U(64.W)) // Return mispredictions
+  val mhpmcounter23 = RegInit(0.U(64.W)) // Indirect jump mispredictions
 
   // Shadow registers for atomic 64-bit reads
   // When software reads the low 32 bits, we latch the high 32 bits into a shadow register.
   // This prevents torn reads when the counter increments between reading low and high words.
   // The shadow register is returned when reading the high word.
-  val mcycle_shadow       = RegInit(0.U(32.W))
-  val minstret_shadow     = RegInit(0.U(32.W))
-  val mhpmcounter3_shadow = RegInit(0.U(32.W))
-  val mhpmcounter4_shadow = RegInit(0.U(32.W))
-  val mhpmcounter5_shadow = RegInit(0.U(32.W))
-  val mhpmcounter6_shadow = RegInit(0.U(32.W))
-  val mhpmcounter7_shadow = RegInit(0.U(32.W))
-  val mhpmcounter8_shadow = RegInit(0.U(32.W))
-  val mhpmcounter9_shadow = RegInit(0.U(32.W))
+  val mcycle_shadow        = RegInit(0.U(32.W))
+  val minstret_shadow      = RegInit(0.U(32.W))
+  val mhpmcounter3_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter4_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter5_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter6_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter7_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter8_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter9_shadow  = RegInit(0.U(32.W))
+  val mhpmcounter10_shadow = RegInit(0.U(32.W))
+  val mhpmcounter11_shadow = RegInit(0.U(32.W))
+  val mhpmcounter12_shadow = RegInit(0.U(32.W))
+  val mhpmcounter13_shadow = RegInit(0.U(32.W))
+  val mhpmcounter14_shadow = RegInit(0.U(32.W))
+  val mhpmcounter15_shadow = RegInit(0.U(32.W))
+  val mhpmcounter16_shadow = RegInit(0.U(32.W))
+  val mhpmcounter17_shadow = RegInit(0.U(32.W))
+  val mhpmcounter18_shadow = RegInit(0.U(32.W))
+  val mhpmcounter19_shadow = RegInit(0.U(32.W))
+  val mhpmcounter20_shadow = RegInit(0.U(32.W))
+  val mhpmcounter21_shadow = RegInit(0.U(32.W))
+  val mhpmcounter22_shadow = RegInit(0.U(32.W))
+  val mhpmcounter23_shadow = RegInit(0.U(32.W))
 
   // Latch high word when low word is read (for atomic 64-bit reads)
   val reading_cycle_low =
     io.reg_read_address_id === CSRRegister.CycleL || io.reg_read_address_id === CSRRegister.MCycleL
   val reading_instret_low =
     io.reg_read_address_id === CSRRegister.InstretL || io.reg_read_address_id === CSRRegister.MInstretL
-  val reading_hpm3_low = io.reg_read_address_id === CSRRegister.MHPMCounter3L
-  val reading_hpm4_low = io.reg_read_address_id === CSRRegister.MHPMCounter4L
-  val reading_hpm5_low = io.reg_read_address_id === CSRRegister.MHPMCounter5L
-  val reading_hpm6_low = io.reg_read_address_id === CSRRegister.MHPMCounter6L
-  val reading_hpm7_low = io.reg_read_address_id === CSRRegister.MHPMCounter7L
-  val reading_hpm8_low = io.reg_read_address_id === CSRRegister.MHPMCounter8L
-  val reading_hpm9_low = io.reg_read_address_id === CSRRegister.MHPMCounter9L
+  val reading_hpm3_low  = io.reg_read_address_id === CSRRegister.MHPMCounter3L
+  val reading_hpm4_low  = io.reg_read_address_id === CSRRegister.MHPMCounter4L
+  val reading_hpm5_low  = io.reg_read_address_id === CSRRegister.MHPMCounter5L
+  val reading_hpm6_low  = io.reg_read_address_id === CSRRegister.MHPMCounter6L
+  val reading_hpm7_low  = io.reg_read_address_id === CSRRegister.MHPMCounter7L
+  val reading_hpm8_low  = io.reg_read_address_id === CSRRegister.MHPMCounter8L
+  val reading_hpm9_low  = io.reg_read_address_id === CSRRegister.MHPMCounter9L
+  val reading_hpm10_low = io.reg_read_address_id === CSRRegister.MHPMCounter10L
+  val reading_hpm11_low = io.reg_read_address_id === CSRRegister.MHPMCounter11L
+  val reading_hpm12_low = io.reg_read_address_id === CSRRegister.MHPMCounter12L
+  val reading_hpm13_low = io.reg_read_address_id === CSRRegister.MHPMCounter13L
+  val reading_hpm14_low = io.reg_read_address_id === CSRRegister.MHPMCounter14L
+  val reading_hpm15_low = io.reg_read_address_id === CSRRegister.MHPMCounter15L
+  val reading_hpm16_low = io.reg_read_address_id === CSRRegister.MHPMCounter16L
+  val reading_hpm17_low = io.reg_read_address_id === CSRRegister.MHPMCounter17L
+  val reading_hpm18_low = io.reg_read_address_id === CSRRegister.MHPMCounter18L
+  val reading_hpm19_low = io.reg_read_address_id === CSRRegister.MHPMCounter19L
+  val reading_hpm20_low = io.reg_read_address_id === CSRRegister.MHPMCounter20L
+  val reading_hpm21_low = io.reg_read_address_id === CSRRegister.MHPMCounter21L
+  val reading_hpm22_low = io.reg_read_address_id === CSRRegister.MHPMCounter22L
+  val reading_hpm23_low = io.reg_read_address_id === CSRRegister.MHPMCounter23L
 
   when(reading_cycle_low) {
     mcycle_shadow := mcycle(63, 32)
@@ -231,25 +354,81 @@ class CSR extends Module {
   when(reading_hpm9_low) {
     mhpmcounter9_shadow := mhpmcounter9(63, 32)
   }
+  when(reading_hpm10_low) {
+    mhpmcounter10_shadow := mhpmcounter10(63, 32)
+  }
+  when(reading_hpm11_low) {
+    mhpmcounter11_shadow := mhpmcounter11(63, 32)
+  }
+  when(reading_hpm12_low) {
+    mhpmcounter12_shadow := mhpmcounter12(63, 32)
+  }
+  when(reading_hpm13_low) {
+    mhpmcounter13_shadow := mhpmcounter13(63, 32)
+  }
+  when(reading_hpm14_low) {
+    mhpmcounter14_shadow := mhpmcounter14(63, 32)
+  }
+  when(reading_hpm15_low) {
+    mhpmcounter15_shadow := mhpmcounter15(63, 32)
+  }
+  when(reading_hpm16_low) {
+    mhpmcounter16_shadow := mhpmcounter16(63, 32)
+  }
+  when(reading_hpm17_low) {
+    mhpmcounter17_shadow := mhpmcounter17(63, 32)
+  }
+  when(reading_hpm18_low) {
+    mhpmcounter18_shadow := mhpmcounter18(63, 32)
+  }
+  when(reading_hpm19_low) {
+    mhpmcounter19_shadow := mhpmcounter19(63, 32)
+  }
+  when(reading_hpm20_low) {
+    mhpmcounter20_shadow := mhpmcounter20(63, 32)
+  }
+  when(reading_hpm21_low) {
+    mhpmcounter21_shadow := mhpmcounter21(63, 32)
+  }
+  when(reading_hpm22_low) {
+    mhpmcounter22_shadow := mhpmcounter22(63, 32)
+  }
+  when(reading_hpm23_low) {
+    mhpmcounter23_shadow := mhpmcounter23(63, 32)
+  }
 
   // Counter inhibit bits
-  val inhibit_cy   = mcountinhibit(0) // Bit 0: mcycle
-  val inhibit_ir   = mcountinhibit(2) // Bit 2: minstret
-  val inhibit_hpm3 = mcountinhibit(3) // Bit 3: mhpmcounter3
-  val inhibit_hpm4 = mcountinhibit(4) // Bit 4: mhpmcounter4
-  val inhibit_hpm5 = mcountinhibit(5) // Bit 5: mhpmcounter5
-  val inhibit_hpm6 = mcountinhibit(6) // Bit 6: mhpmcounter6
-  val inhibit_hpm7 = mcountinhibit(7) // Bit 7: mhpmcounter7
-  val inhibit_hpm8 = mcountinhibit(8) // Bit 8: mhpmcounter8
-  val inhibit_hpm9 = mcountinhibit(9) // Bit 9: mhpmcounter9
+  val inhibit_cy    = mcountinhibit(0) // Bit 0: mcycle
+  val inhibit_ir    = mcountinhibit(2) // Bit 2: minstret
+  val inhibit_hpm3  = mcountinhibit(3) // Bit 3: mhpmcounter3
+  val inhibit_hpm4  = mcountinhibit(4) // Bit 4: mhpmcounter4
+  val inhibit_hpm5  = mcountinhibit(5) // Bit 5: mhpmcounter5
+  val inhibit_hpm6  = mcountinhibit(6) // Bit 6: mhpmcounter6
+  val inhibit_hpm7  = mcountinhibit(7) // Bit 7: mhpmcounter7
+  val inhibit_hpm8  = mcountinhibit(8) // Bit 8: mhpmcounter8
+  val inhibit_hpm9  = mcountinhibit(9) // Bit 9: mhpmcounter9
+  val inhibit_hpm10 = mcountinhibit(10) // Bit 10: mhpmcounter10
+  val inhibit_hpm11 = mcountinhibit(11) // Bit 11: mhpmcounter11
+  val inhibit_hpm12 = mcountinhibit(12) // Bit 12: mhpmcounter12
+  val inhibit_hpm13 = mcountinhibit(13) // Bit 13: mhpmcounter13
+  val inhibit_hpm14 = mcountinhibit(14) // Bit 14: mhpmcounter14
+  val inhibit_hpm15 = mcountinhibit(15) // Bit 15: mhpmcounter15
+  val inhibit_hpm16 = mcountinhibit(16) // Bit 16: mhpmcounter16
+  val inhibit_hpm17 = mcountinhibit(17) // Bit 17: mhpmcounter17
+  val inhibit_hpm18 = mcountinhibit(18) // Bit 18: mhpmcounter18
+  val inhibit_hpm19 = mcountinhibit(19) // Bit 19: mhpmcounter19
+  val inhibit_hpm20 = mcountinhibit(20) // Bit 20: mhpmcounter20
+  val inhibit_hpm21 = mcountinhibit(21) // Bit 21: mhpmcounter21
+  val inhibit_hpm22 = mcountinhibit(22) // Bit 22: mhpmcounter22
+  val inhibit_hpm23 = mcountinhibit(23) // Bit 23: mhpmcounter23
 
   // Increment counters (after shadow latching to get consistent snapshot)
   // Each counter respects its mcountinhibit bit
   when(!inhibit_cy) {
     mcycle := mcycle + 1.U
   }
-  when(io.instruction_retired && !inhibit_ir) {
-    minstret := minstret + 1.U
+  when((io.instruction_retired || io.slot_b_retired) && !inhibit_ir) {
+    minstret := minstret + io.instruction_retired + io.slot_b_retired
   }
   when(io.branch_misprediction && !inhibit_hpm3) {
     mhpmcounter3 := mhpmcounter3 + 1.U
@@ -272,6 +451,48 @@ class CSR extends Module {
   when(io.btb_predicted && !inhibit_hpm9) {
     mhpmcounter9 := mhpmcounter9 + 1.U
   }
+  when(io.cond_branch_resolved && !inhibit_hpm10) {
+    mhpmcounter10 := mhpmcounter10 + 1.U
+  }
+  when(io.pht_mispredict && !inhibit_hpm11) {
+    mhpmcounter11 := mhpmcounter11 + 1.U
+  }
+  when(io.icache_hit && !inhibit_hpm12) {
+    mhpmcounter12 := mhpmcounter12 + 1.U
+  }
+  when(io.icache_miss && !inhibit_hpm13) {
+    mhpmcounter13 := mhpmcounter13 + 1.U
+  }
+  when(io.dcache_hit && !inhibit_hpm14) {
+    mhpmcounter14 := mhpmcounter14 + 1.U
+  }
+  when(io.dcache_miss && !inhibit_hpm15) {
+    mhpmcounter15 := mhpmcounter15 + 1.U
+  }
+  when(io.dcache_writeback && !inhibit_hpm16) {
+    mhpmcounter16 := mhpmcounter16 + 1.U
+  }
+  when(io.store_buffer_full && !inhibit_hpm17) {
+    mhpmcounter17 := mhpmcounter17 + 1.U
+  }
+  when(io.store_drain_stall && !inhibit_hpm18) {
+    mhpmcounter18 := mhpmcounter18 + 1.U
+  }
+  when(io.store_forwarded && !inhibit_hpm19) {
+    mhpmcounter19 := mhpmcounter19 + 1.U
+  }
+  when(io.divider_busy && !inhibit_hpm20) {
+    mhpmcounter20 := mhpmcounter20 + 1.U
+  }
+  when(io.divider_done && !inhibit_hpm21) {
+    mhpmcounter21 := mhpmcounter21 + 1.U
+  }
+  when(io.ras_mispredict && !inhibit_hpm22) {
+    mhpmcounter22 := mhpmcounter22 + 1.U
+  }
+  when(io.indirect_mispredict && !inhibit_hpm23) {
+    mhpmcounter23 := mhpmcounter23 + 1.U
+  }
 
   // Register lookup table for CSR reads
   // High word reads use shadow registers for atomic 64-bit reads
@@ -279,6 +500,7 @@ class CSR extends Module {
     IndexedSeq(
       // Machine trap registers
       CSRRegister.MSTATUS  -> mstatus,
+      CSRRegister.MISA     -> misa,
       CSRRegister.MIE      -> mie,
       CSRRegister.MTVEC    -> mtvec,
       CSRRegister.MSCRATCH -> mscratch,
@@ -298,26 +520,88 @@ class CSR extends Module {
       CSRRegister.MInstretL -> minstret(31, 0),
       CSRRegister.MInstretH -> minstret_shadow,
       // Hardware performance counters
-      CSRRegister.MHPMCounter3L -> mhpmcounter3(31, 0),
-      CSRRegister.MHPMCounter3H -> mhpmcounter3_shadow,
-      CSRRegister.MHPMCounter4L -> mhpmcounter4(31, 0),
-      CSRRegister.MHPMCounter4H -> mhpmcounter4_shadow,
-      CSRRegister.MHPMCounter5L -> mhpmcounter5(31, 0),
-      CSRRegister.MHPMCounter5H -> mhpmcounter5_shadow,
-      CSRRegister.MHPMCounter6L -> mhpmcounter6(31, 0),
-      CSRRegister.MHPMCounter6H -> mhpmcounter6_shadow,
-      CSRRegister.MHPMCounter7L -> mhpmcounter7(31, 0),
-      CSRRegister.MHPMCounter7H -> mhpmcounter7_shadow,
-      CSRRegister.MHPMCounter8L -> mhpmcounter8(31, 0),
-      CSRRegister.MHPMCounter8H -> mhpmcounter8_shadow,
-      CSRRegister.MHPMCounter9L -> mhpmcounter9(31, 0),
-      CSRRegister.MHPMCounter9H -> mhpmcounter9_shadow,
+      CSRRegister.MHPMCounter3L  -> mhpmcounter3(31, 0),
+      CSRRegister.MHPMCounter3H  -> mhpmcounter3_shadow,
+      CSRRegister.MHPMCounter4L  -> mhpmcounter4(31, 0),
+      CSRRegister.MHPMCounter4H  -> mhpmcounter4_shadow,
+      CSRRegister.MHPMCounter5L  -> mhpmcounter5(31, 0),
+      CSRRegister.MHPMCounter5H  -> mhpmcounter5_shadow,
+      CSRRegister.MHPMCounter6L  -> mhpmcounter6(31, 0),
+      CSRRegister.MHPMCounter6H  -> mhpmcounter6_shadow,
+      CSRRegister.MHPMCounter7L  -> mhpmcounter7(31, 0),
+      CSRRegister.MHPMCounter7H  -> mhpmcounter7_shadow,
+      CSRRegister.MHPMCounter8L  -> mhpmcounter8(31, 0),
+      CSRRegister.MHPMCounter8H  -> mhpmcounter8_shadow,
+      CSRRegister.MHPMCounter9L  -> mhpmcounter9(31, 0),
+      CSRRegister.MHPMCounter9H  -> mhpmcounter9_shadow,
+      CSRRegister.MHPMCounter10L -> mhpmcounter10(31, 0),
+      CSRRegister.MHPMCounter10H -> mhpmcounter10_shadow,
+      CSRRegister.MHPMCounter11L -> mhpmcounter11(31, 0),
+      CSRRegister.MHPMCounter11H -> mhpmcounter11_shadow,
+      CSRRegister.MHPMCounter12L -> mhpmcounter12(31, 0),
+      CSRRegister.MHPMCounter12H -> mhpmcounter12_shadow,
+      CSRRegister.MHPMCounter13L -> mhpmcounter13(31, 0),
+      CSRRegister.MHPMCounter13H -> mhpmcounter13_shadow,
+      CSRRegister.MHPMCounter14L -> mhpmcounter14(31, 0),
+      CSRRegister.MHPMCounter14H -> mhpmcounter14_shadow,
+      CSRRegister.MHPMCounter15L -> mhpmcounter15(31, 0),
+      CSRRegister.MHPMCounter15H -> mhpmcounter15_shadow,
+      CSRRegister.MHPMCounter16L -> mhpmcounter16(31, 0),
+      CSRRegister.MHPMCounter16H -> mhpmcounter16_shadow,
+      CSRRegister.MHPMCounter17L -> mhpmcounter17(31, 0),
+      CSRRegister.MHPMCounter17H -> mhpmcounter17_shadow,
+      CSRRegister.MHPMCounter18L -> mhpmcounter18(31, 0),
+      CSRRegister.MHPMCounter18H -> mhpmcounter18_shadow,
+      CSRRegister.MHPMCounter19L -> mhpmcounter19(31, 0),
+      CSRRegister.MHPMCounter19H -> mhpmcounter19_shadow,
+      CSRRegister.MHPMCounter20L -> mhpmcounter20(31, 0),
+      CSRRegister.MHPMCounter20H -> mhpmcounter20_shadow,
+      CSRRegister.MHPMCounter21L -> mhpmcounter21(31, 0),
+      CSRRegister.MHPMCounter21H -> mhpmcounter21_shadow,
+      CSRRegister.MHPMCounter22L -> mhpmcounter22(31, 0),
+      CSRRegister.MHPMCounter22H -> mhpmcounter22_shadow,
+      CSRRegister.MHPMCounter23L -> mhpmcounter23(31, 0),
+      CSRRegister.MHPMCounter23H -> mhpmcounter23_shadow,
+    )
+
+  // The debug port is sampled by the simulator while the clock is held, so a
+  // low/high pair can never tear there. High words read live values instead
+  // of the shadows, which only follow software reads of the low word.
+  val liveHighLUT =
+    IndexedSeq(
+      CSRRegister.CycleH         -> mcycle(63, 32),
+      CSRRegister.InstretH       -> minstret(63, 32),
+      CSRRegister.MCycleH        -> mcycle(63, 32),
+      CSRRegister.MInstretH      -> minstret(63, 32),
+      CSRRegister.MHPMCounter3H  -> mhpmcounter3(63, 32),
+      CSRRegister.MHPMCounter4H  -> mhpmcounter4(63, 32),
+      CSRRegister.MHPMCounter5H  -> mhpmcounter5(63, 32),
+      CSRRegister.MHPMCounter6H  -> mhpmcounter6(63, 32),
+      CSRRegister.MHPMCounter7H  -> mhpmcounter7(63, 32),
+      CSRRegister.MHPMCounter8H  -> mhpmcounter8(63, 32),
+      CSRRegister.MHPMCounter9H  -> mhpmcounter9(63, 32),
+      CSRRegister.MHPMCounter10H -> mhpmcounter10(63, 32),
+      CSRRegister.MHPMCounter11H -> mhpmcounter11(63, 32),
+      CSRRegister.MHPMCounter12H -> mhpmcounter12(63, 32),
+      CSRRegister.MHPMCounter13H -> mhpmcounter13(63, 32),
+      CSRRegister.MHPMCounter14H -> mhpmcounter14(63, 32),
+      CSRRegister.MHPMCounter15H -> mhpmcounter15(63, 32),
+      CSRRegister.MHPMCounter16H -> mhpmcounter16(63, 32),
+      CSRRegister.MHPMCounter17H -> mhpmcounter17(63, 32),
+      CSRRegister.MHPMCounter18H -> mhpmcounter18(63, 32),
+      CSRRegister.MHPMCounter19H -> mhpmcounter19(63, 32),
+      CSRRegister.MHPMCounter20H -> mhpmcounter20(63, 32),
+      CSRRegister.MHPMCounter21H -> mhpmcounter21(63, 32),
+      CSRRegister.MHPMCounter22H -> mhpmcounter22(63, 32),
+      CSRRegister.MHPMCounter23H -> mhpmcounter23(63, 32),
     )
+  val liveHighAddresses = liveHighLUT.map(_._1.litValue).toSet
+  val debugLUT          = regLUT.filterNot { case (addr, _) => liveHighAddresses(addr.litValue) } ++ liveHighLUT
 
   // If the pipeline and the CLINT are going to read and write the CSR at the same time, let the pipeline write first.
   // This is implemented in a single cycle by passing reg_write_data_ex to clint and writing the data from the CLINT to the CSR.
   io.id_reg_read_data    := MuxLookup(io.reg_read_address_id, 0.U)(regLUT)
-  io.debug_reg_read_data := MuxLookup(io.debug_reg_read_address, 0.U)(regLUT)
+  io.debug_reg_read_data := MuxLookup(io.debug_reg_read_address, 0.U)(debugLUT)
 
   io.clint_access_bundle.mstatus := Mux(
     io.reg_write_enable_ex && io.reg_write_address_ex === CSRRegister.MSTATUS,
@@ -367,9 +651,9 @@ class CSR extends Module {
     }.elsewhen(io.reg_write_address_ex === CSRRegister.MSCRATCH) {
       mscratch := io.reg_write_data_ex
     }.elsewhen(io.reg_write_address_ex === CSRRegister.MCOUNTINHIBIT) {
-      // Only bits 0, 2, 3-9 are writable (bit 1 is reserved, upper bits hardwired to 0)
-      // Mask: 0x000003fd = bits 0,2,3,4,5,6,7,8,9 (skip bit 1, clear bits 10-31)
-      mcountinhibit := io.reg_write_data_ex & "h000003fd".U
+      // Only bits 0, 2, 3-23 are writable (bit 1 is reserved, upper bits hardwired to 0)
+      // Mask: 0x00fffffd = bits 0,2,3,...,23 (skip bit 1, clear bits 24-31)
+      mcountinhibit := io.reg_write_data_ex & "h00fffffd".U
     }
   }
 
@@ -413,6 +697,62 @@ class CSR extends Module {
       mhpmcounter9 := Cat(mhpmcounter9(63, 32), io.reg_write_data_ex)
     }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter9H) {
       mhpmcounter9 := Cat(io.reg_write_data_ex, mhpmcounter9(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter10L) {
+      mhpmcounter10 := Cat(mhpmcounter10(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter10H) {
+      mhpmcounter10 := Cat(io.reg_write_data_ex, mhpmcounter10(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter11L) {
+      mhpmcounter11 := Cat(mhpmcounter11(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter11H) {
+      mhpmcounter11 := Cat(io.reg_write_data_ex, mhpmcounter11(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter12L) {
+      mhpmcounter12 := Cat(mhpmcounter12(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter12H) {
+      mhpmcounter12 := Cat(io.reg_write_data_ex, mhpmcounter12(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter13L) {
+      mhpmcounter13 := Cat(mhpmcounter13(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter13H) {
+      mhpmcounter13 := Cat(io.reg_write_data_ex, mhpmcounter13(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter14L) {
+      mhpmcounter14 := Cat(mhpmcounter14(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter14H) {
+      mhpmcounter14 := Cat(io.reg_write_data_ex, mhpmcounter14(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter15L) {
+      mhpmcounter15 := Cat(mhpmcounter15(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter15H) {
+      mhpmcounter15 := Cat(io.reg_write_data_ex, mhpmcounter15(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter16L) {
+      mhpmcounter16 := Cat(mhpmcounter16(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter16H) {
+      mhpmcounter16 := Cat(io.reg_write_data_ex, mhpmcounter16(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter17L) {
+      mhpmcounter17 := Cat(mhpmcounter17(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter17H) {
+      mhpmcounter17 := Cat(io.reg_write_data_ex, mhpmcounter17(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter18L) {
+      mhpmcounter18 := Cat(mhpmcounter18(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter18H) {
+      mhpmcounter18 := Cat(io.reg_write_data_ex, mhpmcounter18(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter19L) {
+      mhpmcounter19 := Cat(mhpmcounter19(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter19H) {
+      mhpmcounter19 := Cat(io.reg_write_data_ex, mhpmcounter19(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter20L) {
+      mhpmcounter20 := Cat(mhpmcounter20(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter20H) {
+      mhpmcounter20 := Cat(io.reg_write_data_ex, mhpmcounter20(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter21L) {
+      mhpmcounter21 := Cat(mhpmcounter21(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter21H) {
+      mhpmcounter21 := Cat(io.reg_write_data_ex, mhpmcounter21(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter22L) {
+      mhpmcounter22 := Cat(mhpmcounter22(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter22H) {
+      mhpmcounter22 := Cat(io.reg_write_data_ex, mhpmcounter22(31, 0))
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter23L) {
+      mhpmcounter23 := Cat(mhpmcounter23(63, 32), io.reg_write_data_ex)
+    }.elsewhen(io.reg_write_address_ex === CSRRegister.MHPMCounter23H) {
+      mhpmcounter23 := Cat(io.reg_write_data_ex, mhpmcounter23(31, 0))
     }
   }
 }
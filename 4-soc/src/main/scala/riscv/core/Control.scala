@@ -210,10 +210,18 @@ import riscv.Parameters
  * - Branch penalty reduced to 1 cycle (0 with BTB/RAS)
  * - Minimal stalls through aggressive forwarding
  *
+ * Dual Issue:
+ * - ID may hold a pair; slot B (rs1_id_b/rs2_id_b, 0 when empty) never
+ *   jumps, loads or stores, so it only joins the load-use and JAL/JALR checks
+ * - Slot B in EX (rd_ex_b) is one more result a jump in ID waits for
+ * - A stall holds or flushes both slots together
+ *
  * @note Most complex control logic but best performance
  * @note Requires ID-stage forwarding paths for full benefit
+ *
+ * @param dualIssue Add the slot B inputs
  */
-class Control extends Module {
+class Control(dualIssue: Boolean = false) extends Module {
   val io = IO(new Bundle {
     val jump_flag               = Input(Bool())                                     // id.io.if_jump_flag
     val jump_instruction_id     = Input(Bool())                                     // id.io.ctrl_jump_instruction           //
@@ -234,6 +242,11 @@ class Control extends Module {
     // Multiplier/divider control signals (M-extension)
     val mul_busy = Input(Bool()) // ex.io.mul_busy
     val div_busy = Input(Bool()) // ex.io.div_busy
+    // Dual issue: slot B's sources in ID (id_b.io.regs_reg1/2_read_address)
+    // and destination in EX (id2ex_b.io.output_regs_write_address)
+    val rs1_id_b = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
+    val rs2_id_b = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
+    val rd_ex_b  = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
 
     val if_flush = Output(Bool())
     val id_flush = Output(Bool())
@@ -261,6 +274,17 @@ class Control extends Module {
     io.rd_ex =/= 0.U &&
     (io.rd_ex === io.rs1_id || io.rd_ex === io.rs2_id)
 
+  // ============ Dual Issue ============
+  // Slot B in ID reads rd (a load or JAL/JALR result not yet forwardable)
+  def read_by_slot_b(rd: UInt): Bool =
+    (io.rs1_id_b.toSeq ++ io.rs2_id_b).map(rs => rd =/= 0.U && rs === rd).foldLeft(false.B)(_ || _)
+  // Jump in ID needs slot B's result from EX
+  val ex_b_hazard_for_branch = io.rd_ex_b
+    .map(rd => io.jump_instruction_id && rd =/= 0.U && (rd === io.rs1_id || rd === io.rs2_id))
+    .getOrElse(false.B)
+  // Load in EX, slot B in ID reads its destination
+  val load_use_slot_b = io.memory_read_enable_ex && read_by_slot_b(io.rd_ex)
+
   // ============ Store-Load Hazard Detection ============
   // When a store is in MEM stage and a load is in EX stage, we must stall the load.
   // Without this, the load could start reading from memory before the store writes,
@@ -289,7 +313,7 @@ class Control extends Module {
   // Solution: Stall when EX has JAL/JALR and ID reads the destination register.
   val jal_jalr_hazard_ex = (io.regs_write_source_ex === RegWriteSource.NextInstructionAddress) &&
     io.rd_ex =/= 0.U &&
-    (io.rd_ex === io.rs1_id || io.rd_ex === io.rs2_id)
+    (io.rd_ex === io.rs1_id || io.rd_ex === io.rs2_id || read_by_slot_b(io.rd_ex))
 
   // ============ JAL/JALR Hazard in MEM Stage ============
   // Similar to EX stage, but for when JAL/JALR has advanced to MEM.
@@ -303,7 +327,7 @@ class Control extends Module {
   // Without this stall, forwarding from MEM gives wrong value (ALU result/jump target).
   val jal_jalr_hazard_mem = (io.regs_write_source_mem === RegWriteSource.NextInstructionAddress) &&
     io.rd_mem =/= 0.U &&
-    (io.rd_mem === io.rs1_id || io.rd_mem === io.rs2_id)
+    (io.rd_mem === io.rs1_id || io.rd_mem === io.rs2_id || read_by_slot_b(io.rd_mem))
 
   // ============ JAL/JALR Hazard in WB Stage ============
   // Due to pipeline register delay, when JAL/JALR enters WB at a rising edge,
@@ -320,7 +344,7 @@ class Control extends Module {
   // cycle to propagate JAL's values through mem2wb before allowing dependent instructions.
   val jal_jalr_hazard_wb = (io.regs_write_source_wb === RegWriteSource.NextInstructionAddress) &&
     io.rd_wb =/= 0.U &&
-    (io.rd_wb === io.rs1_id || io.rd_wb === io.rs2_id)
+    (io.rd_wb === io.rs1_id || io.rd_wb === io.rs2_id || read_by_slot_b(io.rd_wb))
 
   // Complex hazard detection for early branch resolution in ID stage
   when(
@@ -381,6 +405,13 @@ class Control extends Module {
         io.mul_busy || io.div_busy
         // Multiplier/divider is computing, stall pipeline until result is ready
         // Example: MUL/DIV x1, x2, x3 [EX, cycles 1-3]; ADD x4, x1, x5 [ID] → stall
+
+        || // OR
+
+        // --- Condition 8: Dual issue, slot B hazards ---
+        load_use_slot_b || ex_b_hazard_for_branch
+        // Load in EX whose destination slot B in ID reads, or a jump in ID
+        // reading slot B's result in EX
   ) {
     // Stall action: Insert bubble and freeze pipeline
     //
@@ -402,7 +433,7 @@ class Control extends Module {
     // JAL/JALR hazard: must flush to prevent capturing stale register file value
     // Includes WB stage hazard due to pipeline register delay
     val is_jal_jalr_hazard = jal_jalr_hazard_ex || jal_jalr_hazard_mem || jal_jalr_hazard_wb
-    io.id_flush := is_load_use_hazard || is_jal_jalr_hazard
+    io.id_flush := is_load_use_hazard || load_use_slot_b || is_jal_jalr_hazard
     io.pc_stall := true.B // Freeze PC (don't fetch next instruction)
     io.if_stall := true.B // Freeze IF/ID (hold fetched instruction)
     // Suppress branch decision when there's EX or MEM hazard for branch
@@ -412,7 +443,7 @@ class Control extends Module {
       io.memory_read_enable_mem &&
       io.rd_mem =/= 0.U &&
       (io.rd_mem === io.rs1_id || io.rd_mem === io.rs2_id)
-    io.branch_hazard := ex_hazard_for_branch || mem_hazard_for_branch
+    io.branch_hazard := ex_hazard_for_branch || ex_b_hazard_for_branch || mem_hazard_for_branch
     // Export JAL/JALR hazard for PipelinedCPU to bypass mem_stall suppression
     io.jal_jalr_hazard := is_jal_jalr_hazard
 
@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv.core
+
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * Data Cache: write-back, write-allocate cache between MemoryAccess and the bus
+ *
+ * Purpose:
+ * - Loads and stores to main memory (device 0) complete in the MEM cycle on a
+ *   hit instead of waiting for an AXI4-Lite round trip
+ * - MMIO (every other device) and the first page of main memory, where the
+ *   simulator's control registers sit (Parameters.cacheable), pass through
+ *   uncached, in program order with the cached accesses
+ *
+ * Architecture:
+ * - lines lines of lineWords words, ways ways per set (1 = direct-mapped)
+ * - Address = | tag | set index | word in line | byte |
+ * - Data in a combinational-read memory with one row (all ways) per set;
+ *   tags, valid and dirty bits in registers
+ * - Replacement: first invalid way, else the not-recently-used way
+ *
+ * Operation:
+ * - Hit: granted and read_valid/write_valid in the same cycle; a store merges
+ *   its bytes into the word and marks the line dirty
+ * - Miss: the line goes to the miss buffer (one outstanding line). A store
+ *   completes at once with its bytes held there; a load waits for the line.
+ *   A dirty victim is written back first, then the line is read from word 0,
+ *   with the buffered store bytes kept over the memory ones, and installed
+ *   (dirty if any store went to it). Write-backs and refills are one bus
+ *   burst per line, or one single-beat transaction per word with
+ *   burst = false
+ * - Under a miss, hits to other lines proceed, stores to the missing line
+ *   merge into the buffer and loads to it wait for the install. Other misses
+ *   and MMIO wait until the buffer is free
+ * - flush (FENCE.I) writes back every dirty line once the accesses already
+ *   in MEM are done, so that instruction fetch sees stored code; flushing
+ *   stays high until the walk ends
+ * - snoop (a word another bus master wrote to memory) drops the line holding
+ *   it, dirty or not: that master's writes win, and it is up to software to
+ *   write the line back (flush) before, and not to touch it while the other
+ *   master runs
+ *
+ * hit counts accesses served without a refill of their own (stores merged
+ * into the miss buffer included), miss counts refills and writeback counts
+ * dirty lines written back.
+ *
+ * @param lines     Lines in total (power of 2)
+ * @param ways      Lines per set (power of 2)
+ * @param lineWords Words per line (power of 2, at least 2)
+ * @param burst     Move each line with one bus burst
+ */
+class DataCache(
+    lines: Int = Parameters.DCacheLines,
+    ways: Int = Parameters.DCacheWays,
+    lineWords: Int = Parameters.DCacheLineWords,
+    burst: Boolean = Parameters.MemoryBursts
+) extends Module {
+  require(isPow2(lines) && isPow2(ways) && lines >= 2 * ways, "D-cache needs at least two sets")
+  require(isPow2(lineWords) && lineWords >= 2, "D-cache lines must be a power of 2 words, at least 2")
+  val sets       = lines / ways
+  val wayBits    = log2Ceil(ways)
+  val wordBits   = log2Ceil(lineWords)
+  val indexBits  = log2Ceil(sets)
+  val offsetBits = wordBits + 2
+  val tagBits    = Parameters.AddrBits - indexBits - offsetBits
+  val lineBits   = Parameters.AddrBits - offsetBits
+
+  val io = IO(new Bundle {
+    // MemoryAccess side (full address)
+    val cpu = Flipped(new BusBundle)
+    // Bus side (to the CPU wrapper's AXI4-Lite master)
+    val bus = new BusBundle
+
+    val flush    = Input(Bool())  // FENCE.I: write back every dirty line
+    val flushing = Output(Bool()) // Flush requested or in progress
+
+    val snoop = Input(Valid(UInt(Parameters.AddrWidth))) // Word written by another bus master
+
+    val hit       = Output(Bool()) // Cached access served without a refill
+    val miss      = Output(Bool()) // Line refill allocated
+    val writeback = Output(Bool()) // Dirty line write-back started
+  })
+
+  object State extends ChiselEnum {
+    val sIdle, sUncached, sWriteback, sRefill, sInstall, sFlush = Value
+  }
+  val state = RegInit(State.sIdle)
+
+  val valid = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B)))))
+  val dirty = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B)))))
+  val tags  = Reg(Vec(sets, Vec(ways, UInt(tagBits.W))))
+  val data  = Mem(sets, Vec(ways * lineWords, UInt(Parameters.DataWidth)))
+
+  // Not-recently-used bits, set on every hit and fill of a way
+  val used = RegInit(VecInit(Seq.fill(sets)(0.U(ways.W))))
+
+  def getWord(address: UInt): UInt  = address(offsetBits - 1, 2)
+  def getIndex(address: UInt): UInt = address(offsetBits + indexBits - 1, offsetBits)
+  def getTag(address: UInt): UInt   = address(Parameters.AddrBits - 1, offsetBits + indexBits)
+  def getLine(address: UInt): UInt  = address(Parameters.AddrBits - 1, offsetBits)
+
+  // Position of a word in a data row
+  def slot(way: UInt, word: UInt): UInt = if (ways == 1) word else Cat(way(wayBits - 1, 0), word)
+
+  def touch(index: UInt, way: UInt): Unit = {
+    val touched = used(index) | UIntToOH(way, ways)
+    used(index) := Mux(touched.andR, UIntToOH(way, ways), touched)
+  }
+
+  // Bytes of value selected by strobe, the others from old
+  def merge(old: UInt, value: UInt, strobe: UInt): UInt =
+    VecInit((0 until Parameters.WordSize).map { i =>
+      Mux(strobe(i), value(8 * i + 7, 8 * i), old(8 * i + 7, 8 * i))
+    }).asUInt
+
+  // Miss buffer: the line being refilled and the store bytes sent to it
+  val mshr_valid = RegInit(false.B)
+  val mshr_line  = RegInit(0.U(lineBits.W))
+  val mshr_way   = RegInit(0.U(wayBits.max(1).W))
+  val mshr_load  = RegInit(false.B) // A load waits for the line
+  val mshr_data  = Reg(Vec(lineWords, UInt(Parameters.DataWidth)))
+  val mshr_mask  = RegInit(VecInit(Seq.fill(lineWords)(0.U(Parameters.WordSize.W))))
+  val mshr_index = mshr_line(indexBits - 1, 0)
+
+  // Line being written back (victim or flushed line)
+  val wb_index = RegInit(0.U(indexBits.W))
+  val wb_way   = RegInit(0.U(wayBits.max(1).W))
+  val wb_tag   = RegInit(0.U(tagBits.W))
+
+  // Word of the current refill/write-back, and whether its bus transaction
+  // (the burst for the whole line, or this word's) has been granted
+  val beat        = RegInit(0.U(wordBits.W))
+  val issued      = RegInit(false.B)
+  val last_beat   = beat === (lineWords - 1).U
+  val line_length = (if (burst) lineWords - 1 else 0).U
+
+  val flushing   = RegInit(false.B)
+  val flush_slot = RegInit(0.U((log2Ceil(lines) + 1).W))
+  val flush_set  = flush_slot(log2Ceil(lines) - 1, wayBits)
+  val flush_way  = if (ways == 1) 0.U else flush_slot(wayBits - 1, 0)
+
+  // Lookup (combinational - available same cycle)
+  val address      = io.cpu.address
+  val cached       = Parameters.cacheable(address)
+  val access       = io.cpu.request && (io.cpu.read || io.cpu.write)
+  val index        = getIndex(address)
+  val matches      = VecInit((0 until ways).map(w => valid(index)(w) && tags(index)(w) === getTag(address)))
+  val hit          = matches.asUInt.orR
+  val hit_way      = OHToUInt(matches)
+  val hit_word     = data(index)(slot(hit_way, getWord(address)))
+  val strobe       = io.cpu.write_strobe.asUInt
+  val in_mshr_line = mshr_valid && getLine(address) === mshr_line
+  val idle         = state === State.sIdle
+  // Hits may proceed while a miss is being written back or refilled
+  val under_miss = mshr_valid && (state === State.sWriteback || state === State.sRefill)
+
+  io.cpu.read_data           := hit_word
+  io.cpu.read_valid          := false.B
+  io.cpu.write_valid         := false.B
+  io.cpu.write_data_accepted := false.B
+  io.cpu.busy                := !idle
+  io.cpu.granted             := false.B
+  io.cpu.write_beat          := false.B
+
+  io.bus.request      := false.B
+  io.bus.read         := false.B
+  io.bus.write        := false.B
+  io.bus.address      := address
+  io.bus.write_data   := io.cpu.write_data
+  io.bus.write_strobe := io.cpu.write_strobe
+  io.bus.burst_length := 0.U
+
+  io.flushing  := flushing
+  io.hit       := false.B
+  io.miss      := false.B
+  io.writeback := false.B
+
+  val allocate      = WireDefault(false.B)
+  val store_to_mshr = WireDefault(false.B)
+
+  when(access && cached) {
+    when(in_mshr_line) {
+      // Secondary miss: stores merge into the buffer, a load waits for it
+      when(under_miss) {
+        io.cpu.granted     := true.B
+        io.cpu.write_valid := io.cpu.write
+        store_to_mshr      := io.cpu.write
+        io.hit             := true.B
+        when(io.cpu.read) {
+          mshr_load := true.B
+        }
+      }
+    }.elsewhen(hit && (idle || under_miss)) {
+      io.cpu.granted     := true.B
+      io.cpu.read_valid  := io.cpu.read
+      io.cpu.write_valid := io.cpu.write
+      io.hit             := true.B
+      touch(index, hit_way)
+      when(io.cpu.write) {
+        data.write(
+          index,
+          VecInit(Seq.fill(ways * lineWords)(merge(hit_word, io.cpu.write_data, strobe))),
+          UIntToOH(slot(hit_way, getWord(address)), ways * lineWords).asBools
+        )
+        dirty(index)(hit_way) := true.B
+      }
+    }.elsewhen(idle) {
+      // Victim: first invalid way, else first not-recently-used way
+      val invalid = ~valid(index).asUInt
+      val victim  = Mux(invalid.orR, PriorityEncoder(invalid), PriorityEncoder(~used(index)))
+      io.cpu.granted       := true.B
+      io.cpu.write_valid   := io.cpu.write
+      io.miss              := true.B
+      allocate             := true.B
+      store_to_mshr        := io.cpu.write
+      mshr_valid           := true.B
+      mshr_line            := getLine(address)
+      mshr_way             := victim
+      mshr_load            := io.cpu.read
+      beat                 := 0.U
+      issued               := false.B
+      valid(index)(victim) := false.B
+      when(valid(index)(victim) && dirty(index)(victim)) {
+        wb_index     := index
+        wb_way       := victim
+        wb_tag       := tags(index)(victim)
+        io.writeback := true.B
+        state        := State.sWriteback
+      }.otherwise {
+        state := State.sRefill
+      }
+    }
+  }.elsewhen(access && idle) {
+    // MMIO: one transaction straight through
+    io.bus.request := true.B
+    io.bus.read    := io.cpu.read
+    io.bus.write   := io.cpu.write
+    io.cpu.granted := io.bus.granted
+    when(io.bus.granted) {
+      state := State.sUncached
+    }
+  }.elsewhen(idle && flushing) {
+    flush_slot := 0.U
+    state      := State.sFlush
+  }
+
+  // Miss buffer contents: refilled words under the buffered store bytes, then
+  // this cycle's store on top
+  val refill_done = state === State.sRefill && issued && io.bus.read_valid
+  for (w <- 0 until lineWords) {
+    val refilled = Mux(
+      refill_done && beat === w.U,
+      merge(io.bus.read_data, mshr_data(w), mshr_mask(w)),
+      mshr_data(w)
+    )
+    val stored = store_to_mshr && getWord(address) === w.U
+    mshr_data(w) := Mux(stored, merge(refilled, io.cpu.write_data, strobe), refilled)
+    mshr_mask(w) := Mux(allocate, 0.U, mshr_mask(w)) | Mux(stored, strobe, 0.U)
+  }
+
+  switch(state) {
+    is(State.sUncached) {
+      io.bus.request     := true.B
+      io.cpu.read_data   := io.bus.read_data
+      io.cpu.read_valid  := io.bus.read_valid
+      io.cpu.write_valid := io.bus.write_valid
+      when(io.bus.read_valid || io.bus.write_valid) {
+        state := State.sIdle
+      }
+    }
+
+    is(State.sWriteback) {
+      io.bus.request      := true.B
+      io.bus.write        := !issued
+      io.bus.address      := Cat(wb_tag, wb_index, beat, 0.U(2.W))
+      io.bus.write_data   := data(wb_index)(slot(wb_way, beat))
+      io.bus.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(true.B))
+      io.bus.burst_length := line_length
+      when(!issued && io.bus.granted) {
+        issued := true.B
+      }
+      if (burst) {
+        // Present each word until the master has taken it; one response
+        // ends the whole line
+        when(issued && io.bus.write_beat) {
+          beat := beat + 1.U
+        }
+        when(issued && io.bus.write_valid) {
+          issued := false.B
+          state  := Mux(mshr_valid, State.sRefill, State.sFlush)
+        }
+      } else {
+        when(issued && io.bus.write_valid) {
+          issued := false.B
+          beat   := beat + 1.U
+          when(last_beat) {
+            state := Mux(mshr_valid, State.sRefill, State.sFlush)
+          }
+        }
+      }
+    }
+
+    is(State.sRefill) {
+      io.bus.request      := true.B
+      io.bus.read         := !issued
+      io.bus.address      := Cat(mshr_line, beat, 0.U(2.W))
+      io.bus.burst_length := line_length
+      when(!issued && io.bus.granted) {
+        issued := true.B
+      }
+      when(refill_done) {
+        beat := beat + 1.U
+        when(!burst.B || last_beat) {
+          issued := false.B
+        }
+        when(last_beat) {
+          state := State.sInstall
+        }
+      }
+    }
+
+    is(State.sInstall) {
+      data.write(
+        mshr_index,
+        VecInit(Seq.tabulate(ways * lineWords)(i => mshr_data(i % lineWords))),
+        VecInit(Seq.tabulate(ways * lineWords)(i => mshr_way === (i / lineWords).U))
+      )
+      valid(mshr_index)(mshr_way) := true.B
+      dirty(mshr_index)(mshr_way) := mshr_mask.asUInt.orR
+      tags(mshr_index)(mshr_way)  := mshr_line(lineBits - 1, indexBits)
+      touch(mshr_index, mshr_way)
+      // Answer the load that waited for the line
+      io.cpu.read_data  := mshr_data(getWord(address))
+      io.cpu.read_valid := mshr_load
+      mshr_load         := false.B
+      mshr_valid        := false.B
+      state             := State.sIdle
+    }
+
+    is(State.sFlush) {
+      when(flush_slot === lines.U) {
+        flushing := false.B
+        state    := State.sIdle
+      }.otherwise {
+        flush_slot := flush_slot + 1.U
+        when(valid(flush_set)(flush_way) && dirty(flush_set)(flush_way)) {
+          wb_index                    := flush_set
+          wb_way                      := flush_way
+          wb_tag                      := tags(flush_set)(flush_way)
+          dirty(flush_set)(flush_way) := false.B
+          beat                        := 0.U
+          issued                      := false.B
+          io.writeback                := true.B
+          state                       := State.sWriteback
+        }
+      }
+    }
+  }
+
+  // After the state machine, so a flush requested as the walk ends is kept
+  when(io.flush) {
+    flushing := true.B
+  }
+
+  // Last, so that it wins over a store marking the line dirty in this cycle
+  when(io.snoop.valid) {
+    val snoop_index = getIndex(io.snoop.bits)
+    for (w <- 0 until ways) {
+      when(tags(snoop_index)(w) === getTag(io.snoop.bits)) {
+        valid(snoop_index)(w) := false.B
+        dirty(snoop_index)(w) := false.B
+      }
+    }
+  }
+}
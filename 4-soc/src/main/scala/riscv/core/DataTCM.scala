@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv.core
+
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * MemoryAccess side of the data TCM: address of the access in MEM, whether
+ * it falls in the TCM, the word there, and the store to it.
+ */
+class DataTCMBundle extends Bundle {
+  val address      = Output(UInt(Parameters.AddrWidth))
+  val hit          = Input(Bool())
+  val read_data    = Input(UInt(Parameters.DataWidth))
+  val write        = Output(Bool())
+  val write_data   = Output(UInt(Parameters.DataWidth))
+  val write_strobe = Output(Vec(Parameters.WordSize, Bool()))
+}
+
+/**
+ * Data TCM: tightly coupled data RAM beside MemoryAccess
+ *
+ * Purpose:
+ * - Loads and stores to [base, base + bytes) complete in the MEM cycle with
+ *   no bus transaction, no data cache lookup and no store buffer entry, so
+ *   their latency never depends on a miss or on other bus masters. Software
+ *   keeps hot data there (csrc/link.lds, csrc/tcm.h)
+ *
+ * Architecture:
+ * - A combinational-read memory of bytes / 4 words, byte-strobed on write,
+ *   like the data cache's data array (BlockRAM's registered read would need
+ *   the address a stage earlier)
+ * - The range shadows main memory for the CPU alone: the data cache, DMA and
+ *   the simulator's RAM never see its contents, so buffers shared with
+ *   another bus master belong elsewhere
+ *
+ * debug_write with target TCM writes the word at index address, for the
+ * simulator to load the TCM after a functional fast-forward; indexes past
+ * the end are ignored.
+ *
+ * @param bytes Size in bytes (power of 2, 64 B to 64 KiB)
+ * @param base  First address, aligned to the size
+ */
+class DataTCM(bytes: Int = Parameters.DataTCMBytes, base: Long = Parameters.DataTCMBase) extends Module {
+  require(isPow2(bytes) && bytes >= 64 && bytes <= 65536, "data TCM must be a power of 2 from 64 B to 64 KiB")
+  require(base % bytes == 0, "data TCM base must be aligned to its size")
+  val words     = bytes / Parameters.WordSize
+  val indexBits = log2Ceil(words)
+  val sizeBits  = log2Ceil(bytes)
+
+  val io = IO(new Bundle {
+    val cpu         = Flipped(new DataTCMBundle)
+    val debug_write = Input(new DebugWriteBundle)
+  })
+
+  val data = Mem(words, Vec(Parameters.WordSize, UInt(Parameters.ByteWidth)))
+
+  def toBytes(word: UInt): Vec[UInt] =
+    VecInit((0 until Parameters.WordSize).map(i => word(8 * i + 7, 8 * i)))
+
+  val index = io.cpu.address(sizeBits - 1, 2)
+  io.cpu.hit       := io.cpu.address(Parameters.AddrBits - 1, sizeBits) === (base >> sizeBits).U
+  io.cpu.read_data := data(index).asUInt
+
+  // One write port: the simulator's writes come while the pipeline is held
+  val debug_write = io.debug_write.valid && io.debug_write.target === DebugWriteTarget.TCM &&
+    io.debug_write.address < words.U
+  when(debug_write || (io.cpu.write && io.cpu.hit)) {
+    data.write(
+      Mux(debug_write, io.debug_write.address(indexBits - 1, 0), index),
+      toBytes(Mux(debug_write, io.debug_write.data, io.cpu.write_data)),
+      Mux(debug_write, VecInit(Seq.fill(Parameters.WordSize)(true.B)), io.cpu.write_strobe)
+    )
+  }
+}
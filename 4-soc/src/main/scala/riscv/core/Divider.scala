@@ -26,8 +26,20 @@ import riscv.Parameters
  * - Cycle 0: Start asserted, inputs latched
  * - Cycle 1..N: Busy
  * - Cycle N+1: valid asserted for 1 cycle
+ *
+ * radix4 = true: radix-4 restoring division of the operand magnitudes, two
+ * quotient bits per cycle. It starts at the highest quotient bit that can be
+ * set (from the leading zeros of both operands), so an n-bit quotient takes
+ * ceil(n/2) cycles, N = ceil(n/2) + 1. Division by zero, by a power of two
+ * (1 included) and of a smaller dividend finish after the set-up cycle,
+ * N = 1.
+ *
+ * radix4 = false: a combinational divide behind a fixed latency, N = 5 (32-bit)
+ * or 9 (64-bit).
+ *
+ * @param radix4 Iterative radix-4 divider with early termination
  */
-class Divider extends Module {
+class Divider(radix4: Boolean = Parameters.DividerRadix4) extends Module {
   val io = IO(new Bundle {
     val start  = Input(Bool())
     val op1    = Input(UInt(32.W))
@@ -46,7 +58,7 @@ class Divider extends Module {
   })
 
   object State extends ChiselEnum {
-    val sIdle, sCompute, sDone = Value
+    val sIdle, sSetup, sCompute, sDone = Value
   }
   val state = RegInit(State.sIdle)
 
@@ -81,10 +93,87 @@ class Divider extends Module {
         funct3Reg := io.funct3
         use64Reg := io.use_64
         counter := 0.U
-        state := State.sCompute
+        state := (if (radix4) State.sSetup else State.sCompute)
+      }
+    }
+    is(State.sDone) {
+      io.valid := true.B
+      state := State.sIdle
+    }
+  }
+
+  if (radix4) {
+    // Operand magnitudes (64-bit mode is unsigned) and result signs
+    val signed   = !use64Reg && !funct3Reg(0)
+    val op1Neg   = signed && op1Reg(31)
+    val op2Neg   = signed && op2Reg(31)
+    val dividend = Mux(op1Neg, 0.U(32.W) - op1Reg(31, 0), op1Reg)
+    val divisor  = Mux(op2Neg, 0.U(32.W) - op2Reg(31, 0), op2Reg)
+
+    // Partial remainder (always below the divisor), and the dividend bits
+    // still to bring down with the quotient digits shifted in behind them
+    val remAcc  = RegInit(0.U(64.W))
+    val quotAcc = RegInit(0.U(64.W))
+    val divReg  = RegInit(0.U(64.W))
+    val div3Reg = RegInit(0.U(66.W)) // 3 * divisor
+    val quotNeg = RegInit(false.B)
+    val remNeg  = RegInit(false.B)
+
+    // Signed and 32-bit results from the magnitudes
+    def finish(quot: UInt, rem: UInt, negQuot: Bool, negRem: Bool): UInt = {
+      val value = Mux(funct3Reg(1), Mux(negRem, 0.U - rem, rem), Mux(negQuot, 0.U - quot, quot))
+      Mux(use64Reg, value, value(31, 0))
+    }
+
+    when(state === State.sSetup) {
+      val quotNegNow = op1Neg =/= op2Neg
+      when(divisor === 0.U) {
+        // Quotient all ones, remainder the dividend (RISC-V M)
+        resultReg := Mux(funct3Reg(1), op1Reg, Mux(use64Reg, ~0.U(64.W), ~0.U(32.W)))
+        state     := State.sDone
+      }.elsewhen((divisor & (divisor - 1.U)) === 0.U) {
+        // Power of two: a shift; covers the signed overflow case as well
+        val shift = Log2(divisor)
+        resultReg := finish(dividend >> shift, dividend & (divisor - 1.U), quotNegNow, op1Neg)
+        state     := State.sDone
+      }.elsewhen(dividend < divisor) {
+        resultReg := finish(0.U, dividend, quotNegNow, op1Neg)
+        state     := State.sDone
+      }.otherwise {
+        // Quotient bits below 2^n only, brought down two at a time
+        val quotBits = (PriorityEncoder(Reverse(divisor)) - PriorityEncoder(Reverse(dividend))) +& 1.U
+        val steps    = (quotBits +& 1.U) >> 1
+        val skipped  = steps << 1
+        remAcc  := dividend >> skipped
+        quotAcc := (dividend << (64.U - skipped))(63, 0)
+        divReg  := divisor
+        div3Reg := divisor +& (divisor << 1)
+        quotNeg := quotNegNow
+        remNeg  := op1Neg
+        counter := steps
+        state   := State.sCompute
       }
     }
-    is(State.sCompute) {
+
+    when(state === State.sCompute) {
+      // Largest digit d with d * divisor <= partial
+      val partial  = Cat(remAcc, quotAcc(63, 62))
+      val ge3      = partial >= div3Reg
+      val ge2      = partial >= (divReg << 1)
+      val ge1      = partial >= divReg
+      val digit    = Mux(ge3, 3.U, Mux(ge2, 2.U, Mux(ge1, 1.U, 0.U)))
+      val nextRem  = (partial - Mux(ge3, div3Reg, Mux(ge2, divReg << 1, Mux(ge1, divReg, 0.U))))(63, 0)
+      val nextQuot = Cat(quotAcc(61, 0), digit)
+      remAcc  := nextRem
+      quotAcc := nextQuot
+      counter := counter - 1.U
+      when(counter === 1.U) {
+        resultReg := finish(nextQuot, nextRem, quotNeg, remNeg)
+        state     := State.sDone
+      }
+    }
+  } else {
+    when(state === State.sCompute) {
       when(counter === 0.U) {
         when(use64Reg) {
           // 64-bit unsigned division (for __divdi3 acceleration)
@@ -144,9 +233,5 @@ class Divider extends Module {
         state := State.sDone
       }
     }
-    is(State.sDone) {
-      io.valid := true.B
-      state := State.sIdle
-    }
   }
 }
@@ -20,6 +20,7 @@ import riscv.Parameters
  * - reg2_data: Store data (forwarded from EX stage)
  * - funct3: Memory access width (byte/half/word) and sign-extension mode
  * - memory_*_enable: Triggers AXI4-Lite bus transactions in MEM stage
+ * - instruction: Instruction word, carried on for the retire trace only
  *
  * No flush input: EX2MEM never flushes because by the time an instruction
  * reaches this point, all control hazards have been resolved. Memory stalls
@@ -32,6 +33,7 @@ class EX2MEM extends Module {
     val regs_write_source   = Input(UInt(2.W))
     val regs_write_address  = Input(UInt(Parameters.AddrWidth))
     val instruction_address = Input(UInt(Parameters.AddrWidth))
+    val instruction         = Input(UInt(Parameters.InstructionWidth))
     val funct3              = Input(UInt(3.W))
     val reg2_data           = Input(UInt(Parameters.DataWidth))
     val memory_read_enable  = Input(Bool())
@@ -43,6 +45,7 @@ class EX2MEM extends Module {
     val output_regs_write_source   = Output(UInt(2.W))
     val output_regs_write_address  = Output(UInt(Parameters.AddrWidth))
     val output_instruction_address = Output(UInt(Parameters.AddrWidth))
+    val output_instruction         = Output(UInt(Parameters.InstructionWidth))
     val output_funct3              = Output(UInt(Parameters.DataWidth))
     val output_reg2_data           = Output(UInt(Parameters.DataWidth))
     val output_memory_read_enable  = Output(Bool())
@@ -78,6 +81,12 @@ class EX2MEM extends Module {
   instruction_address.io.flush  := flush
   io.output_instruction_address := instruction_address.io.out
 
+  val instruction = Module(new PipelineRegister(Parameters.InstructionBits, InstructionsNop.nop))
+  instruction.io.in     := io.instruction
+  instruction.io.stall  := stall
+  instruction.io.flush  := flush
+  io.output_instruction := instruction.io.out
+
   val funct3 = Module(new PipelineRegister(3))
   funct3.io.in     := io.funct3
   funct3.io.stall  := stall
@@ -24,8 +24,10 @@ class Execute extends Module {
     val csr_read_data       = Input(UInt(Parameters.DataWidth))
     val forward_from_mem    = Input(UInt(Parameters.DataWidth))
     val forward_from_wb     = Input(UInt(Parameters.DataWidth))
-    val reg1_forward        = Input(UInt(2.W))
-    val reg2_forward        = Input(UInt(2.W))
+    val forward_from_mem_b  = Input(UInt(Parameters.DataWidth)) // Dual issue: slot B results
+    val forward_from_wb_b   = Input(UInt(Parameters.DataWidth))
+    val reg1_forward        = Input(UInt(3.W))
+    val reg2_forward        = Input(UInt(3.W))
 
     val mem_alu_result = Output(UInt(Parameters.DataWidth))
     val mem_reg2_data  = Output(UInt(Parameters.DataWidth))
@@ -51,6 +53,7 @@ class Execute extends Module {
   alu_ctrl.io.opcode := opcode
   alu_ctrl.io.funct3 := funct3
   alu_ctrl.io.funct7 := funct7
+  alu_ctrl.io.rs2    := io.instruction(24, 20)
   alu.io.func        := alu_ctrl.io.alu_funct
   
   // Detect M-extension instructions
@@ -87,8 +90,10 @@ class Execute extends Module {
     io.reg1_data
   )(
     IndexedSeq(
-      ForwardingType.ForwardFromMEM -> io.forward_from_mem,
-      ForwardingType.ForwardFromWB  -> io.forward_from_wb
+      ForwardingType.ForwardFromMEM  -> io.forward_from_mem,
+      ForwardingType.ForwardFromWB   -> io.forward_from_wb,
+      ForwardingType.ForwardFromMEMB -> io.forward_from_mem_b,
+      ForwardingType.ForwardFromWBB  -> io.forward_from_wb_b
     )
   )
   alu.io.op1 := Mux(
@@ -102,8 +107,10 @@ class Execute extends Module {
     io.reg2_data
   )(
     IndexedSeq(
-      ForwardingType.ForwardFromMEM -> io.forward_from_mem,
-      ForwardingType.ForwardFromWB  -> io.forward_from_wb
+      ForwardingType.ForwardFromMEM  -> io.forward_from_mem,
+      ForwardingType.ForwardFromWB   -> io.forward_from_wb,
+      ForwardingType.ForwardFromMEMB -> io.forward_from_mem_b,
+      ForwardingType.ForwardFromWBB  -> io.forward_from_wb_b
     )
   )
   alu.io.op2 := Mux(
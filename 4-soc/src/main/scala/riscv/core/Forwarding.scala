@@ -5,6 +5,7 @@
 package riscv.core
 
 import chisel3._
+import chisel3.util.MuxCase
 import riscv.Parameters
 
 /**
@@ -14,11 +15,37 @@ import riscv.Parameters
  * - NoForward: Use register file value (no forwarding needed)
  * - ForwardFromMEM: Forward from EX/MEM pipeline register (1 cycle old)
  * - ForwardFromWB: Forward from MEM/WB pipeline register (2 cycles old)
+ * - ForwardFromMEMB/ForwardFromWBB: The same registers of issue slot B
+ *   (dual-issue pipeline only)
  */
 object ForwardingType {
-  val NoForward      = 0.U(2.W)
-  val ForwardFromMEM = 1.U(2.W)
-  val ForwardFromWB  = 2.U(2.W)
+  val NoForward       = 0.U(3.W)
+  val ForwardFromMEM  = 1.U(3.W)
+  val ForwardFromWB   = 2.U(3.W)
+  val ForwardFromMEMB = 3.U(3.W)
+  val ForwardFromWBB  = 4.U(3.W)
+}
+
+/**
+ * Issue slot B of the dual-issue pipeline as the forwarding unit sees it: its
+ * sources in ID and EX, its results in MEM and WB, and the paths chosen for
+ * its sources. Connected as the slot A ports are, from id_b, id2ex_b,
+ * ex2mem_b and mem2wb_b.
+ */
+class ForwardingSlotBundle extends Bundle {
+  val rs1_id               = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val rs2_id               = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val rs1_ex               = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val rs2_ex               = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val rd_mem               = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val reg_write_enable_mem = Input(Bool())
+  val rd_wb                = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
+  val reg_write_enable_wb  = Input(Bool())
+
+  val reg1_forward_id = Output(UInt(3.W))
+  val reg2_forward_id = Output(UInt(3.W))
+  val reg1_forward_ex = Output(UInt(3.W))
+  val reg2_forward_ex = Output(UInt(3.W))
 }
 
 /**
@@ -53,10 +80,16 @@ object ForwardingType {
  * NOP               # Only 1 bubble needed (vs. 2 without ID forwarding)
  * ```
  *
+ * Dual issue (slot_b): each stage holds up to two instructions, slot B the
+ * younger, so the newest result is in order slot B in MEM, slot A in MEM,
+ * slot B in WB, slot A in WB. Both slots' sources are resolved that way.
+ *
  * @note This is the most optimized forwarding configuration
  * @note ID forwarding requires additional bypass paths in decode stage
+ *
+ * @param dualIssue Add the slot B producers and consumers (slot_b)
  */
-class Forwarding extends Module {
+class Forwarding(dualIssue: Boolean = false) extends Module {
   val io = IO(new Bundle() {
     val rs1_id               = Input(UInt(Parameters.PhysicalRegisterAddrWidth)) // id.io.regs_reg1_read_address             //
     val rs2_id               = Input(UInt(Parameters.PhysicalRegisterAddrWidth)) // id.io.regs_reg2_read_address             //
@@ -67,10 +100,12 @@ class Forwarding extends Module {
     val rd_wb                = Input(UInt(Parameters.PhysicalRegisterAddrWidth)) // mem2wb.io.output_regs_write_address
     val reg_write_enable_wb  = Input(Bool())                                     // mem2wb.io.output_regs_write_enable
 
-    val reg1_forward_id = Output(UInt(2.W)) // id.io.reg1_forward                       //
-    val reg2_forward_id = Output(UInt(2.W)) // id.io.reg2_forward                       //
-    val reg1_forward_ex = Output(UInt(2.W)) // ex.io.reg1_forward
-    val reg2_forward_ex = Output(UInt(2.W)) // ex.io.reg2_forward
+    val reg1_forward_id = Output(UInt(3.W)) // id.io.reg1_forward                       //
+    val reg2_forward_id = Output(UInt(3.W)) // id.io.reg2_forward                       //
+    val reg1_forward_ex = Output(UInt(3.W)) // ex.io.reg1_forward
+    val reg2_forward_ex = Output(UInt(3.W)) // ex.io.reg2_forward
+
+    val slot_b = if (dualIssue) Some(new ForwardingSlotBundle) else None
   })
 
   // ==================== EX Stage Forwarding Logic ====================
@@ -135,4 +170,27 @@ class Forwarding extends Module {
     // No forwarding needed for ID stage rs2
     io.reg2_forward_id := ForwardingType.NoForward
   }
+
+  // ==================== Dual Issue ====================
+  // Replaces the selections above: a slot B result is newer than the slot A
+  // result in the same stage
+  io.slot_b.foreach { b =>
+    def source(rs: UInt): UInt = MuxCase(
+      ForwardingType.NoForward,
+      IndexedSeq(
+        (b.reg_write_enable_mem && rs === b.rd_mem && b.rd_mem =/= 0.U)   -> ForwardingType.ForwardFromMEMB,
+        (io.reg_write_enable_mem && rs === io.rd_mem && io.rd_mem =/= 0.U) -> ForwardingType.ForwardFromMEM,
+        (b.reg_write_enable_wb && rs === b.rd_wb && b.rd_wb =/= 0.U)      -> ForwardingType.ForwardFromWBB,
+        (io.reg_write_enable_wb && rs === io.rd_wb && io.rd_wb =/= 0.U)    -> ForwardingType.ForwardFromWB
+      )
+    )
+    io.reg1_forward_ex := source(io.rs1_ex)
+    io.reg2_forward_ex := source(io.rs2_ex)
+    io.reg1_forward_id := source(io.rs1_id)
+    io.reg2_forward_id := source(io.rs2_id)
+    b.reg1_forward_ex  := source(b.rs1_ex)
+    b.reg2_forward_ex  := source(b.rs2_ex)
+    b.reg1_forward_id  := source(b.rs1_id)
+    b.reg2_forward_id  := source(b.rs2_id)
+  }
 }
@@ -5,6 +5,7 @@
 package riscv.core
 
 import chisel3._
+import chisel3.util.log2Ceil
 import riscv.core.PipelineRegister
 import riscv.Parameters
 
@@ -12,7 +13,7 @@ import riscv.Parameters
  * IF/ID Pipeline Register: Instruction Fetch to Instruction Decode boundary.
  *
  * Captures and buffers the fetched instruction along with its address and all
- * branch prediction metadata (BTB, RAS, IndirectBTB). This register is the
+ * branch prediction metadata (BTB, PHT, RAS, IndirectBTB). This register is the
  * first pipeline boundary and controls instruction flow into the decode stage.
  *
  * Stall behavior: When stalled, holds current instruction for re-execution.
@@ -21,8 +22,14 @@ import riscv.Parameters
  *
  * Branch prediction signals flow alongside the instruction so the ID stage
  * can compare predicted vs actual branch outcomes and trigger corrections.
+ * The RAS checkpoint is flagged valid for every captured fetch, so a flushed
+ * slot (valid 0) never rolls the stack back to its reset value.
  */
-class IF2ID extends Module {
+class IF2ID(
+    phtIndexBits: Int = log2Ceil(Parameters.PHTEntries),
+    ibtbIndexBits: Int = log2Ceil(Parameters.IndirectBTBEntries / Parameters.IndirectBTBWays),
+    rasCheckpointBits: Int = ReturnAddressStack.checkpointBits(Parameters.RASDepth)
+) extends Module {
   val io = IO(new Bundle {
     val stall                 = Input(Bool())
     val flush                 = Input(Bool())
@@ -35,6 +42,10 @@ class IF2ID extends Module {
     val ras_predicted_target  = Input(UInt(Parameters.AddrWidth)) // RAS predicted return address
     val ibtb_predicted_valid  = Input(Bool())                     // IndirectBTB prediction valid from IF
     val ibtb_predicted_target = Input(UInt(Parameters.AddrWidth)) // IndirectBTB predicted target
+    val ibtb_index            = Input(UInt(ibtbIndexBits.W))      // IndirectBTB set used for it
+    val ras_checkpoint        = Input(UInt(rasCheckpointBits.W))  // RAS state after this fetch
+    val pht_predicted_taken   = Input(Bool())                     // PHT direction from IF stage
+    val pht_index             = Input(UInt(phtIndexBits.W))       // PHT counter used for it
 
     val output_instruction           = Output(UInt(Parameters.DataWidth))
     val output_instruction_address   = Output(UInt(Parameters.AddrWidth))
@@ -45,6 +56,11 @@ class IF2ID extends Module {
     val output_ras_predicted_target  = Output(UInt(Parameters.AddrWidth)) // RAS target to ID stage
     val output_ibtb_predicted_valid  = Output(Bool())                     // IndirectBTB prediction to ID
     val output_ibtb_predicted_target = Output(UInt(Parameters.AddrWidth)) // IndirectBTB target to ID
+    val output_ibtb_index            = Output(UInt(ibtbIndexBits.W))      // IndirectBTB set to train in ID
+    val output_ras_checkpoint        = Output(UInt(rasCheckpointBits.W))  // RAS state to restore on flush
+    val output_ras_checkpoint_valid  = Output(Bool())                     // Not a flushed slot
+    val output_pht_predicted_taken   = Output(Bool())                     // PHT direction to ID stage
+    val output_pht_index             = Output(UInt(phtIndexBits.W))       // PHT counter to train in ID
   })
 
   val instruction = Module(new PipelineRegister(defaultValue = InstructionsNop.nop))
@@ -103,4 +119,36 @@ class IF2ID extends Module {
   ibtb_predicted_target.io.stall  := io.stall
   ibtb_predicted_target.io.flush  := io.flush
   io.output_ibtb_predicted_target := ibtb_predicted_target.io.out
+
+  val ibtb_index = Module(new PipelineRegister(ibtbIndexBits))
+  ibtb_index.io.in     := io.ibtb_index
+  ibtb_index.io.stall  := io.stall
+  ibtb_index.io.flush  := io.flush
+  io.output_ibtb_index := ibtb_index.io.out
+
+  // RAS checkpoint passed through pipeline
+  val ras_checkpoint = Module(new PipelineRegister(rasCheckpointBits))
+  ras_checkpoint.io.in     := io.ras_checkpoint
+  ras_checkpoint.io.stall  := io.stall
+  ras_checkpoint.io.flush  := io.flush
+  io.output_ras_checkpoint := ras_checkpoint.io.out
+
+  val ras_checkpoint_valid = Module(new PipelineRegister(1))
+  ras_checkpoint_valid.io.in     := true.B
+  ras_checkpoint_valid.io.stall  := io.stall
+  ras_checkpoint_valid.io.flush  := io.flush
+  io.output_ras_checkpoint_valid := ras_checkpoint_valid.io.out.asBool
+
+  // PHT prediction and index passed through pipeline
+  val pht_predicted_taken = Module(new PipelineRegister(1))
+  pht_predicted_taken.io.in     := io.pht_predicted_taken
+  pht_predicted_taken.io.stall  := io.stall
+  pht_predicted_taken.io.flush  := io.flush
+  io.output_pht_predicted_taken := pht_predicted_taken.io.out.asBool
+
+  val pht_index = Module(new PipelineRegister(phtIndexBits))
+  pht_index.io.in     := io.pht_index
+  pht_index.io.stall  := io.stall
+  pht_index.io.flush  := io.flush
+  io.output_pht_index := pht_index.io.out
 }
@@ -17,8 +17,10 @@ import riscv.Parameters
  * - IndirectBTB fills the gap: JALR with computed targets (function pointers, vtables)
  *
  * Key Insight:
- * JALR target = rs1 + imm. Same PC can produce different targets based on rs1 value.
- * IndirectBTB tracks (PC, rs1_hash) → target mappings to predict computed jumps.
+ * JALR target = rs1 + imm. Same PC can produce different targets, and which
+ * one usually follows from the path that led to it: the oscillator loop
+ * calls n->osc.wave for each voice in turn, so the previous indirect targets
+ * tell which voice (and waveform) comes next.
  *
  * Use Cases:
  * - Function pointers: JALR rd=ra, rs1=t0 (target varies based on pointer value)
@@ -27,10 +29,24 @@ import riscv.Parameters
  * - Indirect calls through PLT/GOT
  *
  * Architecture:
- * - 8-entry fully-associative table (small but effective for hot indirect jumps)
- * - Each entry: valid, pc_tag (upper PC bits), rs1_hash (8-bit hash), target, age
- * - Lookup: Match PC AND rs1_hash for high-confidence prediction
- * - Replacement: LRU-approximated via age counter
+ * - entries-entry, ways-way set-associative table
+ * - Each entry: valid, pc_tag (PC[31:2]), target
+ * - Set index = PC[setBits+1:2] XOR path history folded to setBits, so one
+ *   JALR gets an entry per recent path and the pc_tag keeps other JALRs out
+ * - Path history: historyBits bits, two target bits (PC[3:2]) shifted in for
+ *   every resolved JALR, returns included
+ * - Replacement: an invalid way if there is one, otherwise the first way whose
+ *   not-recently-used bit is clear (as in BranchTargetBuffer)
+ *
+ * Operation:
+ * - IF stage: combinational lookup for the fetch PC; the set index used is
+ *   output so that it travels with the instruction to ID
+ * - ID stage: the resolved JALR trains the entry in that set and its target
+ *   is shifted into the history
+ *
+ * Like the PHT's global history, the path history is updated at resolution,
+ * not speculatively; training with the carried index keeps prediction and
+ * update on the same set either way.
  *
  * Integration Priority (in InstructionFetch):
  * 1. RAS prediction for returns (JALR rs1=link, rd=x0)
@@ -40,143 +56,93 @@ import riscv.Parameters
  * Performance Impact:
  * - Reduces indirect jump misprediction penalty for repetitive patterns
  * - Complements RAS (handles non-return JALR)
- * - Small area overhead (8 x ~72 bits = 576 bits storage)
- *
- * Bergamot Reference:
- * This addresses a gap noted in Bergamot documentation where indirect branch
- * prediction was identified as a limitation. The design tracks PC + rs1_hash
- * to capture correlation between register state and jump targets.
+ * - 64 x ~61 bits of storage with the default 64 entries, 4 ways
  *
- * @param entries Number of IndirectBTB entries (default 8)
+ * @param entries     Number of IndirectBTB entries (power of 2)
+ * @param ways        Entries per set (power of 2, at most entries / 2)
+ * @param historyBits Path history length in bits (0 = index by PC alone)
  */
-class IndirectBTB(entries: Int = 8) extends Module {
+class IndirectBTB(entries: Int = 64, ways: Int = 4, historyBits: Int = 8) extends Module {
   require(isPow2(entries) && entries >= 4, "IndirectBTB entries must be power of 2 and >= 4")
+  require(isPow2(ways) && ways <= entries / 2, "IndirectBTB ways must be a power of 2, at most entries / 2")
+  require(historyBits >= 0, "IndirectBTB history cannot be negative")
 
-  val indexBits = log2Ceil(entries)
+  val sets      = entries / ways
+  val setBits   = log2Ceil(sets)
   val pcTagBits = Parameters.AddrBits - 2 // Full PC except 2 LSBs (word alignment)
-  val hashBits  = 8                       // rs1 value hash width
 
   val io = IO(new Bundle {
     // Prediction interface (IF stage) - combinational lookup
-    // Note: rs1_hash not used for prediction lookup (not available in IF stage).
-    // Prediction uses PC-only matching - less accurate but available early.
-    // Multiple entries with same PC will return most recently used target.
     val pc               = Input(UInt(Parameters.AddrWidth))
     val predicted_target = Output(UInt(Parameters.AddrWidth))
     val hit              = Output(Bool())
+    val index            = Output(UInt(setBits.W))
 
-    // Update interface (ID stage) - registered update
-    // Full (PC, rs1_hash) used for update to disambiguate different callers.
-    val update_valid    = Input(Bool())
-    val update_pc       = Input(UInt(Parameters.AddrWidth))
-    val update_rs1_hash = Input(UInt(hashBits.W))
-    val update_target   = Input(UInt(Parameters.AddrWidth))
+    // Update interface (ID stage) - registered update of the set used at fetch
+    val update_valid  = Input(Bool())
+    val update_pc     = Input(UInt(Parameters.AddrWidth))
+    val update_index  = Input(UInt(setBits.W))
+    val update_target = Input(UInt(Parameters.AddrWidth))
+
+    // Path history update (ID stage, every resolved JALR)
+    val path_valid  = Input(Bool())
+    val path_target = Input(UInt(Parameters.AddrWidth))
   })
 
-  // Entry structure: valid + pc_tag + rs1_hash + target + age
-  val valid     = RegInit(VecInit(Seq.fill(entries)(false.B)))
-  val pc_tags   = Reg(Vec(entries, UInt(pcTagBits.W)))
-  val rs1_hashs = Reg(Vec(entries, UInt(hashBits.W)))
-  val targets   = Reg(Vec(entries, UInt(Parameters.AddrBits.W)))
-  val ages      = RegInit(VecInit(Seq.fill(entries)(0.U(log2Ceil(entries).W))))
+  // Entry structure: [set][way]
+  val valid   = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B)))))
+  val pc_tags = Reg(Vec(sets, Vec(ways, UInt(pcTagBits.W))))
+  val targets = Reg(Vec(sets, Vec(ways, UInt(Parameters.AddrBits.W))))
+
+  // Not-recently-used bits, set on every update of a way
+  val used = RegInit(VecInit(Seq.fill(sets)(0.U(ways.W))))
+
+  val history = RegInit(0.U(historyBits.max(1).W))
 
   // Tag extraction (PC[31:2] for full address match)
   def getPcTag(pc: UInt): UInt = pc(Parameters.AddrBits - 1, 2)
 
-  // Prediction logic - PC-only associative search
-  // Note: rs1_hash not used for lookup (not available in IF stage).
-  // If multiple entries match same PC (different rs1_hash), use lowest age (MRU).
-  val pred_pc_tag = getPcTag(io.pc)
-
-  // Find all entries matching PC (ignoring rs1_hash)
-  val pc_hit_vec = VecInit((0 until entries).map { i =>
-    valid(i) && (pc_tags(i) === pred_pc_tag)
-  })
-  val hit_any = pc_hit_vec.asUInt.orR
+  // History folded to the set index width
+  val folded_history =
+    if (historyBits == 0) 0.U(setBits.W)
+    else history.asBools.grouped(setBits).map(bits => VecInit(bits).asUInt.pad(setBits)).reduce(_ ^ _)
 
-  // Select entry with lowest age (most recently used) among PC matches
-  // This gives best prediction when same JALR has multiple targets
-  val hit_ages = VecInit((0 until entries).map { i =>
-    Mux(pc_hit_vec(i), ages(i), (entries - 1).U) // Non-matching entries get max age
-  })
-  val min_age   = hit_ages.reduce((a, b) => Mux(a < b, a, b))
-  val mru_vec   = VecInit((0 until entries).map(i => pc_hit_vec(i) && (ages(i) === min_age)))
-  val hit_index = PriorityEncoder(mru_vec.asUInt)
-
-  io.hit              := hit_any
-  io.predicted_target := Mux(hit_any, targets(hit_index), 0.U)
-
-  // Update age counters on hit (move-to-front approximation)
-  // Skip if update is also happening this cycle (update path handles age management)
-  when(hit_any && !io.update_valid) {
-    // Reset age of hit entry, increment others
-    for (i <- 0 until entries) {
-      when(mru_vec(i)) {
-        ages(i) := 0.U
-      }.elsewhen(valid(i) && ages(i) < (entries - 1).U) {
-        ages(i) := ages(i) + 1.U
-      }
-    }
+  def lookup(index: UInt, tag: UInt): (Bool, UInt) = {
+    val matches = VecInit((0 until ways).map(w => valid(index)(w) && pc_tags(index)(w) === tag))
+    (matches.asUInt.orR, OHToUInt(matches))
   }
 
-  // Update logic - find entry to replace or update
+  // Prediction logic (combinational - available same cycle)
+  val pred_index      = io.pc(setBits + 1, 2) ^ folded_history
+  val (hit, pred_way) = lookup(pred_index, getPcTag(io.pc))
+
+  io.index            := pred_index
+  io.hit              := hit
+  io.predicted_target := Mux(hit, targets(pred_index)(pred_way), 0.U)
+
+  // Update logic - overwrite the JALR's entry in the set, or allocate one
   when(io.update_valid) {
-    val upd_pc_tag = getPcTag(io.update_pc)
-
-    // Check if entry already exists (update case)
-    val existing_vec = VecInit((0 until entries).map { i =>
-      valid(i) && (pc_tags(i) === upd_pc_tag) && (rs1_hashs(i) === io.update_rs1_hash)
-    })
-    val existing_any   = existing_vec.asUInt.orR
-    val existing_index = PriorityEncoder(existing_vec.asUInt)
-
-    // Find invalid entry for new allocation
-    val invalid_vec   = VecInit((0 until entries).map(i => !valid(i)))
-    val invalid_any   = invalid_vec.asUInt.orR
-    val invalid_index = PriorityEncoder(invalid_vec.asUInt)
-
-    // Find oldest entry for eviction (LRU approximation)
-    val oldest_age   = ages.reduce((a, b) => Mux(a > b, a, b))
-    val oldest_vec   = VecInit((0 until entries).map(i => valid(i) && (ages(i) === oldest_age)))
-    val oldest_index = PriorityEncoder(oldest_vec.asUInt)
-
-    // Select target index: existing > invalid > oldest
-    val target_index = Mux(
-      existing_any,
-      existing_index,
-      Mux(invalid_any, invalid_index, oldest_index)
-    )
-
-    // Update entry
-    valid(target_index)     := true.B
-    pc_tags(target_index)   := upd_pc_tag
-    rs1_hashs(target_index) := io.update_rs1_hash
-    targets(target_index)   := io.update_target
-
-    // Reset age of updated entry, age others
-    for (i <- 0 until entries) {
-      when(i.U === target_index) {
-        ages(i) := 0.U
-      }.elsewhen(valid(i) && ages(i) < (entries - 1).U) {
-        ages(i) := ages(i) + 1.U
-      }
-    }
+    val upd_tag              = getPcTag(io.update_pc)
+    val (entry_hit, hit_way) = lookup(io.update_index, upd_tag)
+
+    // Victim for a new entry: first invalid way, else first not-recently-used way
+    val invalid  = ~valid(io.update_index).asUInt
+    val not_used = ~used(io.update_index)
+    val victim   = Mux(invalid.orR, PriorityEncoder(invalid), PriorityEncoder(not_used))
+    val upd_way  = Mux(entry_hit, hit_way, victim)
+    // Clear the other bits once every way has been used
+    val touch_mask = UIntToOH(upd_way, ways)
+    val touched    = used(io.update_index) | touch_mask
+
+    valid(io.update_index)(upd_way)   := true.B
+    pc_tags(io.update_index)(upd_way) := upd_tag
+    targets(io.update_index)(upd_way) := io.update_target
+    used(io.update_index)             := Mux(touched.andR, touch_mask, touched)
   }
-}
 
-/**
- * Hash function for rs1 value compression
- *
- * Reduces 32-bit register value to 8-bit hash for storage efficiency.
- * XOR-fold provides reasonable distribution for pointer values.
- */
-object IndirectBTBHash {
-  def apply(value: UInt): UInt = {
-    // XOR fold 32 bits to 8 bits: bytes XORed together
-    val b0 = value(7, 0)
-    val b1 = value(15, 8)
-    val b2 = value(23, 16)
-    val b3 = value(31, 24)
-    b0 ^ b1 ^ b2 ^ b3
+  if (historyBits > 0) {
+    when(io.path_valid) {
+      history := Cat(history, io.path_target(3, 2))(historyBits - 1, 0)
+    }
   }
 }
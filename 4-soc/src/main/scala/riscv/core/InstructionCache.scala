@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv.core
+
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * Instruction Cache: set-associative cache in front of InstructionFetch
+ *
+ * Purpose:
+ * - Replaces the zero-latency external instruction port with fetches from the
+ *   same memory the data side uses, as on an FPGA with a single DRAM
+ * - Hits return the instruction in the same cycle, so the IF stage and the
+ *   branch predictors see no difference from the old ROM port
+ *
+ * Architecture:
+ * - lines lines of lineWords words, ways ways per set (1 = direct-mapped)
+ * - Address = | tag | set index | word in line | 00 |
+ * - Data in combinational-read memories, tags and valid bits in registers
+ * - Replacement: first invalid way, else the not-recently-used way (as in
+ *   the BTB; exact LRU for 2 ways)
+ *
+ * Operation:
+ * - A miss deasserts valid, which makes InstructionFetch hold the PC and
+ *   send bubbles, and starts a refill of the whole line over the bus bundle
+ *   from word 0, driven like MemoryAccess drives its loads (request/read
+ *   until granted, then wait for read_valid): one burst read of the line, or
+ *   one single-beat read per word with burst = false
+ * - The refilled way is invalidated when the refill starts and becomes valid
+ *   with its new tag after the last word
+ * - A redirect during a refill does not cancel it; the new PC is looked up
+ *   once the line is in
+ *
+ * next_instruction is the word after instruction, from a second read port of
+ * the data memory, for dual issue; it is valid when that word is in the same
+ * line (a hit never spans two lines).
+ *
+ * invalidate (FENCE.I) clears every line; a refill in progress still
+ * completes but is not installed, since it may hold words read before the
+ * stores the fence orders.
+ *
+ * @param lines     Lines in total (power of 2)
+ * @param ways      Lines per set (power of 2)
+ * @param lineWords Words per line (power of 2, at least 2)
+ * @param burst     Refill each line with one bus burst
+ */
+class InstructionCache(
+    lines: Int = Parameters.ICacheLines,
+    ways: Int = Parameters.ICacheWays,
+    lineWords: Int = Parameters.ICacheLineWords,
+    burst: Boolean = Parameters.MemoryBursts
+) extends Module {
+  require(isPow2(lines) && isPow2(ways) && lines >= 2 * ways, "I-cache needs at least two sets")
+  require(isPow2(lineWords) && lineWords >= 2, "I-cache lines must be a power of 2 words, at least 2")
+  val sets       = lines / ways
+  val wordBits   = log2Ceil(lineWords)
+  val indexBits  = log2Ceil(sets)
+  val offsetBits = wordBits + 2
+  val tagBits    = Parameters.AddrBits - indexBits - offsetBits
+
+  val io = IO(new Bundle {
+    // Fetch interface (IF stage) - combinational lookup
+    val address     = Input(UInt(Parameters.AddrWidth))
+    val enable      = Input(Bool()) // Fetching allowed (program loaded)
+    val instruction = Output(UInt(Parameters.InstructionWidth))
+    val valid       = Output(Bool()) // instruction is the word at address
+
+    val next_instruction = Output(Valid(UInt(Parameters.InstructionWidth))) // Word at address + 4
+
+    val invalidate     = Input(Bool())  // FENCE.I
+    val refill_started = Output(Bool()) // Miss: a line refill starts this cycle
+
+    // Refill interface (arbitrated with the data side in CPU.scala)
+    val bus = new BusBundle
+  })
+
+  object State extends ChiselEnum {
+    val sIdle, sRequest, sWait = Value
+  }
+  val state = RegInit(State.sIdle)
+
+  val valid = RegInit(VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B)))))
+  val tags  = Reg(Vec(sets, Vec(ways, UInt(tagBits.W))))
+  val data  = Mem(sets * lineWords, Vec(ways, UInt(Parameters.InstructionWidth)))
+
+  // Not-recently-used bits, set on every hit and fill of a way
+  val used = RegInit(VecInit(Seq.fill(sets)(0.U(ways.W))))
+
+  def getWord(address: UInt): UInt  = address(offsetBits - 1, 2)
+  def getIndex(address: UInt): UInt = address(offsetBits + indexBits - 1, offsetBits)
+  def getTag(address: UInt): UInt   = address(Parameters.AddrBits - 1, offsetBits + indexBits)
+
+  def touch(index: UInt, way: UInt): Unit = {
+    val touched = used(index) | UIntToOH(way, ways)
+    used(index) := Mux(touched.andR, UIntToOH(way, ways), touched)
+  }
+
+  // Lookup (combinational - available same cycle)
+  val index   = getIndex(io.address)
+  val matches = VecInit((0 until ways).map(w => valid(index)(w) && tags(index)(w) === getTag(io.address)))
+  val hit     = matches.asUInt.orR
+  val hit_way = OHToUInt(matches)
+
+  io.instruction := data(Cat(index, getWord(io.address)))(hit_way)
+  io.valid       := hit && io.enable
+
+  val word = getWord(io.address)
+  io.next_instruction.bits  := data(Cat(index, word + 1.U))(hit_way)
+  io.next_instruction.valid := io.valid && word =/= (lineWords - 1).U
+
+  when(io.valid) {
+    touch(index, hit_way)
+  }
+
+  // Line being refilled
+  val refill_line    = RegInit(0.U((Parameters.AddrBits - offsetBits).W))
+  val refill_word    = RegInit(0.U(wordBits.W))
+  val refill_way     = RegInit(0.U(log2Ceil(ways).max(1).W))
+  val refill_discard = RegInit(false.B)
+  val refill_index   = refill_line(indexBits - 1, 0)
+
+  io.bus.request      := state =/= State.sIdle
+  io.bus.read         := state === State.sRequest
+  io.bus.address      := Cat(refill_line, refill_word, 0.U(2.W))
+  io.bus.write        := false.B
+  io.bus.write_data   := 0.U
+  io.bus.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(false.B))
+  io.bus.burst_length := (if (burst) lineWords - 1 else 0).U
+
+  val start_refill = state === State.sIdle && io.enable && !hit && !io.invalidate
+  io.refill_started := start_refill
+
+  switch(state) {
+    is(State.sIdle) {
+      when(start_refill) {
+        // Victim: first invalid way, else first not-recently-used way
+        val invalid = ~valid(index).asUInt
+        val victim  = Mux(invalid.orR, PriorityEncoder(invalid), PriorityEncoder(~used(index)))
+        refill_line          := io.address(Parameters.AddrBits - 1, offsetBits)
+        refill_word          := 0.U
+        refill_way           := victim
+        refill_discard       := false.B
+        valid(index)(victim) := false.B
+        state                := State.sRequest
+      }
+    }
+
+    is(State.sRequest) {
+      when(io.bus.granted) {
+        state := State.sWait
+      }
+    }
+
+    is(State.sWait) {
+      when(io.bus.read_valid) {
+        data.write(
+          Cat(refill_index, refill_word),
+          VecInit(Seq.fill(ways)(io.bus.read_data)),
+          UIntToOH(refill_way, ways).asBools
+        )
+        refill_word := refill_word + 1.U
+        state       := (if (burst) State.sWait else State.sRequest)
+        when(refill_word === (lineWords - 1).U) {
+          valid(refill_index)(refill_way) := !refill_discard
+          tags(refill_index)(refill_way)  := refill_line(refill_line.getWidth - 1, indexBits)
+          touch(refill_index, refill_way)
+          state := State.sIdle
+        }
+      }
+    }
+  }
+
+  // FENCE.I: after the refill logic, so it also wins over a line completing
+  when(io.invalidate) {
+    valid := VecInit(Seq.fill(sets)(VecInit(Seq.fill(ways)(false.B))))
+    when(state =/= State.sIdle) {
+      refill_discard := true.B
+    }
+  }
+}
@@ -8,6 +8,48 @@ import chisel3._
 import chisel3.util._
 import riscv.Parameters
 
+/**
+ * Pairing rules of the dual-issue pipeline (PipelinedCPU with dualIssue).
+ *
+ * Two sequential instructions issue together when the second (slot B) is a
+ * single-cycle integer operation, which the ALU-only second pipe can execute,
+ * and does not depend on the first (slot A). Slot A takes loads, stores and
+ * integer operations, M included, but no jump, branch, SYSTEM or FENCE: a
+ * pair is never split by a redirect in ID, and the memory pipe, the
+ * multiplier/divider and the CSRs stay in slot A. Slot B may not write slot
+ * A's destination either, so the two write ports never collide.
+ *
+ * The rules see only the two raw words, so that InstructionFetch can apply
+ * them and step the PC by 8 for a pair.
+ */
+object IssuePairing {
+  private def opcode(instruction: UInt) = instruction(6, 0)
+
+  // Single-cycle ALU operations (OP without M, OP-IMM, LUI, AUIPC, custom-0 DSP)
+  def aluOnly(instruction: UInt): Bool = {
+    val op = opcode(instruction)
+    op === InstructionTypes.I || op === InstructionTypes.CUSTOM || op === Instructions.lui ||
+    op === Instructions.auipc || (op === InstructionTypes.RM && instruction(31, 25) =/= 1.U)
+  }
+
+  def pairable(first: UInt, second: UInt): Bool = {
+    val op        = opcode(first)
+    val first_ok =
+      aluOnly(first) || op === InstructionTypes.RM || op === InstructionTypes.L || op === InstructionTypes.S
+    val rd        = first(11, 7)
+    val writes_rd = op =/= InstructionTypes.S && rd =/= 0.U
+
+    val second_op = opcode(second)
+    val reads_rs1 = second_op === InstructionTypes.I || second_op === InstructionTypes.RM ||
+      second_op === InstructionTypes.CUSTOM
+    val reads_rs2 = second_op === InstructionTypes.RM || second_op === InstructionTypes.CUSTOM
+    val depends = writes_rd && (
+      (reads_rs1 && second(19, 15) === rd) || (reads_rs2 && second(24, 20) === rd) || second(11, 7) === rd
+    )
+    first_ok && aluOnly(second) && !depends
+  }
+}
+
 class InstructionDecode extends Module {
   val io = IO(new Bundle {
     val instruction               = Input(UInt(Parameters.InstructionWidth))
@@ -16,8 +58,10 @@ class InstructionDecode extends Module {
     val reg2_data                 = Input(UInt(Parameters.DataWidth)) // regs.io.read_data2
     val forward_from_mem          = Input(UInt(Parameters.DataWidth)) // mem.io.forward_data
     val forward_from_wb           = Input(UInt(Parameters.DataWidth)) // wb.io.regs_write_data
-    val reg1_forward              = Input(UInt(2.W))                  // forwarding.io.reg1_forward_id
-    val reg2_forward              = Input(UInt(2.W))                  // forwarding.io.reg2_forward_id
+    val forward_from_mem_b        = Input(UInt(Parameters.DataWidth)) // ex2mem_b.io.output_alu_result (dual issue)
+    val forward_from_wb_b         = Input(UInt(Parameters.DataWidth)) // mem2wb_b.io.output_alu_result (dual issue)
+    val reg1_forward              = Input(UInt(3.W))                  // forwarding.io.reg1_forward_id
+    val reg2_forward              = Input(UInt(3.W))                  // forwarding.io.reg2_forward_id
     val interrupt_assert          = Input(Bool())                     // clint.io.id_interrupt_assert
     val interrupt_handler_address = Input(UInt(Parameters.AddrWidth)) // clint.io.id_interrupt_handler_address
     // Suppress branch decision when there's a RAW hazard with EX stage
@@ -128,16 +172,20 @@ class InstructionDecode extends Module {
 //  io.clint_jump_address := io.interrupt_handler_address
   val reg1_data_forwarded = MuxLookup(io.reg1_forward, 0.U)(
     IndexedSeq(
-      ForwardingType.NoForward      -> io.reg1_data,
-      ForwardingType.ForwardFromWB  -> io.forward_from_wb,
-      ForwardingType.ForwardFromMEM -> io.forward_from_mem
+      ForwardingType.NoForward       -> io.reg1_data,
+      ForwardingType.ForwardFromWB   -> io.forward_from_wb,
+      ForwardingType.ForwardFromMEM  -> io.forward_from_mem,
+      ForwardingType.ForwardFromWBB  -> io.forward_from_wb_b,
+      ForwardingType.ForwardFromMEMB -> io.forward_from_mem_b
     )
   )
   val reg2_data_forwarded = MuxLookup(io.reg2_forward, 0.U)(
     IndexedSeq(
-      ForwardingType.NoForward      -> io.reg2_data,
-      ForwardingType.ForwardFromWB  -> io.forward_from_wb,
-      ForwardingType.ForwardFromMEM -> io.forward_from_mem
+      ForwardingType.NoForward       -> io.reg2_data,
+      ForwardingType.ForwardFromWB   -> io.forward_from_wb,
+      ForwardingType.ForwardFromMEM  -> io.forward_from_mem,
+      ForwardingType.ForwardFromWBB  -> io.forward_from_wb_b,
+      ForwardingType.ForwardFromMEMB -> io.forward_from_mem_b
     )
   )
   val reg1_data = Mux(uses_rs1, reg1_data_forwarded, 0.U)
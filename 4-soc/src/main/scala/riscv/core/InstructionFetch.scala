@@ -5,7 +5,9 @@
 package riscv.core
 
 import chisel3._
+import chisel3.util.log2Ceil
 import chisel3.util.MuxCase
+import chisel3.util.Valid
 import riscv.Parameters
 
 object ProgramCounter {
@@ -19,16 +21,29 @@ object ProgramCounter {
  * branch prediction using two complementary predictors:
  *
  * Branch Target Buffer (BTB):
- * - 32-entry direct-mapped cache indexed by PC[6:2]
+ * - btbEntries-entry, btbWays-way set-associative cache (default 32 entries, 2 ways)
  * - Stores branch/jump targets with 2-bit saturating counters
- * - Predicts taken when: BTB hit AND counter >= 2 (weakly/strongly taken)
+ * - Jumps: predicted taken when BTB hit AND counter >= 2 (weakly/strongly taken)
  * - Updated in ID stage when branches resolve
  *
+ * Pattern History Table (PHT):
+ * - gshare counters indexed by PC XOR global branch history
+ * - Conditional branches: predicted taken when BTB hit AND PHT counter >= 2;
+ *   the BTB only supplies the target
+ * - Trained in ID stage with the index used at fetch (carried in IF2ID)
+ *
  * Return Address Stack (RAS):
- * - 4-entry circular stack for JALR return prediction
+ * - rasDepth-entry circular stack for JALR return prediction (default 8)
  * - Push on call: JAL/JALR with rd=x1 (ra) or rd=x5 (t0)
  * - Pop on return: JALR with rs1=x1/x5, rd=x0
  * - Speculative pop in IF stage when return pattern detected
+ * - The stack checkpoint after each fetch travels through IF2ID; an IF2ID
+ *   flush restores the one of the instruction in ID
+ *
+ * Indirect Branch Target Buffer (IndirectBTB):
+ * - ibtbEntries-entry, ibtbWays-way table for other JALR (default 64, 4 ways)
+ * - Set indexed by PC XOR path history of recent JALR targets; the index
+ *   travels through IF2ID for training in ID, as the PHT index does
  *
  * Prediction Priority (highest to lowest):
  * 1. Pending jump (deferred from stall) - correctness requirement
@@ -36,7 +51,7 @@ object ProgramCounter {
  * 3. Jump from ID stage - actual resolved target
  * 4. RAS prediction - return address prediction (most specific for returns)
  * 5. BTB prediction - branch/jump target prediction
- * 6. Sequential PC+4 - default fall-through
+ * 6. Sequential PC+4 (PC+8 after a dual-issue pair) - default fall-through
  *
  * BTB vs RAS Selection:
  * For JALR instructions, both BTB and RAS may have predictions:
@@ -52,6 +67,15 @@ object ProgramCounter {
  * - BTB aliasing: BTB hit on non-branch instruction → redirect to PC+4, invalidate entry
  * - RAS wrong target: RAS predicted return address incorrect → redirect to correct target
  *
+ * Dual Issue:
+ * - rom_instruction_next is the following word, when the fetch source has it
+ *   (the instruction cache, within a line); invalid on the single-issue
+ *   pipeline
+ * - pair: that word goes to ID as issue slot B (IssuePairing rules) and the
+ *   sequential PC is PC+8. Slot A of a pair is no control transfer, so the
+ *   predictors only ever see slot A, and a BTB hit on it (an alias, to be
+ *   corrected to PC+4) keeps it unpaired
+ *
  * Performance Characteristics:
  * - Correct BTB/RAS prediction: 0 cycle penalty (flush suppressed)
  * - BTB/RAS misprediction: 1 cycle penalty (IF flush)
@@ -62,8 +86,34 @@ object ProgramCounter {
  * - mhpmcounter7: BTB miss penalty (cold misses + wrong target predictions)
  * - mhpmcounter8: Total branches resolved (accuracy denominator)
  * - mhpmcounter9: BTB predictions made (coverage numerator)
+ * - mhpmcounter10: Conditional branches resolved
+ * - mhpmcounter11: PHT direction mispredictions
+ * - mhpmcounter22: Return mispredictions
+ * - mhpmcounter23: Indirect jump mispredictions
+ *
+ * @param btbEntries  BTB entries (power of 2)
+ * @param btbWays     BTB associativity (power of 2)
+ * @param phtEntries  PHT counters (power of 2)
+ * @param historyBits Global history length (0 = bimodal)
+ * @param rasDepth    Return address stack entries (power of 2)
+ * @param ibtbEntries Indirect jump target entries (power of 2)
+ * @param ibtbWays    Indirect jump target associativity (power of 2)
+ * @param ibtbHistory Indirect jump path history bits (0 = PC only)
  */
-class InstructionFetch extends Module {
+class InstructionFetch(
+    btbEntries: Int = Parameters.BTBEntries,
+    btbWays: Int = Parameters.BTBWays,
+    phtEntries: Int = Parameters.PHTEntries,
+    historyBits: Int = Parameters.GlobalHistoryBits,
+    rasDepth: Int = Parameters.RASDepth,
+    ibtbEntries: Int = Parameters.IndirectBTBEntries,
+    ibtbWays: Int = Parameters.IndirectBTBWays,
+    ibtbHistory: Int = Parameters.IndirectBTBHistoryBits
+) extends Module {
+  val phtIndexBits      = log2Ceil(phtEntries)
+  val ibtbIndexBits     = log2Ceil(ibtbEntries / ibtbWays)
+  val rasCheckpointBits = ReturnAddressStack.checkpointBits(rasDepth)
+
   val io = IO(new Bundle {
     val stall_flag_ctrl   = Input(Bool())
     val jump_flag_id      = Input(Bool())
@@ -71,11 +121,18 @@ class InstructionFetch extends Module {
     val rom_instruction   = Input(UInt(Parameters.DataWidth))
     val instruction_valid = Input(Bool())
 
+    // Dual issue: the word after rom_instruction, and whether it pairs with it
+    val rom_instruction_next = Input(Valid(UInt(Parameters.InstructionWidth)))
+    val pair                 = Output(Bool())
+
     // BTB misprediction correction (from ID stage)
     val btb_mispredict         = Input(Bool())                     // BTB predicted wrong
     val btb_correction_addr    = Input(UInt(Parameters.AddrWidth)) // Correct PC
     val btb_correct_prediction = Input(Bool())                     // BTB predicted correctly - skip PC redirect
 
+    // PC written by the simulator (PipelinedCPU debug_write), above all else
+    val debug_pc = Input(Valid(UInt(Parameters.AddrWidth)))
+
     val instruction_address = Output(UInt(Parameters.AddrWidth))
     val id_instruction      = Output(UInt(Parameters.InstructionWidth))
 
@@ -89,47 +146,70 @@ class InstructionFetch extends Module {
     val btb_update_target = Input(UInt(Parameters.AddrWidth))
     val btb_update_taken  = Input(Bool())
 
+    // PHT prediction info passed to ID stage
+    val pht_predicted_taken = Output(Bool())
+    val pht_index           = Output(UInt(phtIndexBits.W))
+
+    // PHT update interface (from ID stage, conditional branches only)
+    val pht_update_valid = Input(Bool())
+    val pht_update_index = Input(UInt(phtIndexBits.W))
+    val pht_update_taken = Input(Bool())
+
     // RAS prediction info passed to ID stage
     val ras_predicted_valid  = Output(Bool())
     val ras_predicted_target = Output(UInt(Parameters.AddrWidth))
+    val ras_checkpoint       = Output(UInt(rasCheckpointBits.W)) // Stack state after this fetch
 
     // RAS update interface (from ID stage)
     val ras_push      = Input(Bool()) // JAL with rd=ra detected
     val ras_push_addr = Input(UInt(Parameters.AddrWidth))
     val ras_pop       = Input(Bool()) // JALR with rs1=ra resolved (for misprediction handling)
 
-    // RAS misprediction correction (from ID stage)
+    // RAS rollback on IF2ID flush (checkpoint of the instruction in ID)
     val ras_restore       = Input(Bool())
-    val ras_restore_addr  = Input(UInt(Parameters.AddrWidth))
-    val ras_restore_valid = Input(Bool())
+    val ras_restore_point = Input(UInt(rasCheckpointBits.W))
 
     // IndirectBTB prediction info passed to ID stage
     val ibtb_predicted_valid  = Output(Bool())
     val ibtb_predicted_target = Output(UInt(Parameters.AddrWidth))
+    val ibtb_index            = Output(UInt(ibtbIndexBits.W))
 
     // IndirectBTB update interface (from ID stage)
-    val ibtb_update_valid    = Input(Bool())
-    val ibtb_update_pc       = Input(UInt(Parameters.AddrWidth))
-    val ibtb_update_rs1_hash = Input(UInt(8.W))
-    val ibtb_update_target   = Input(UInt(Parameters.AddrWidth))
+    val ibtb_update_valid  = Input(Bool())
+    val ibtb_update_pc     = Input(UInt(Parameters.AddrWidth))
+    val ibtb_update_index  = Input(UInt(ibtbIndexBits.W))
+    val ibtb_update_target = Input(UInt(Parameters.AddrWidth))
+    val ibtb_path_valid    = Input(Bool()) // Any JALR resolved (path history)
+    val ibtb_path_target   = Input(UInt(Parameters.AddrWidth))
   })
   val pc = RegInit(ProgramCounter.EntryAddress)
 
-  // Branch Target Buffer for branch prediction (32 entries for better coverage)
-  val btb = Module(new BranchTargetBuffer(entries = 32))
+  // Branch Target Buffer for branch targets, gshare PHT for branch directions
+  val btb = Module(new BranchTargetBuffer(entries = btbEntries, ways = btbWays))
   btb.io.pc := pc
-
-  // BTB prediction: use predicted target if BTB predicts taken
-  val btb_next_pc = btb.io.predicted_pc
-  io.btb_predicted_taken  := btb.io.predicted_taken
-  io.btb_predicted_target := btb.io.predicted_pc
+  val pht = Module(new PatternHistoryTable(entries = phtEntries, historyBits = historyBits))
+  pht.io.pc := pc
+
+  // Conditional branches take their direction from the PHT, jumps from the
+  // BTB counter; either way the target needs a BTB hit
+  val is_cond_branch = io.rom_instruction(6, 0) === InstructionTypes.B && io.instruction_valid
+  val btb_taken      = Mux(is_cond_branch, btb.io.hit && pht.io.predicted_taken, btb.io.predicted_taken)
+  // Slot B follows slot A unless the BTB sends fetch elsewhere after it
+  val pair = io.instruction_valid && io.rom_instruction_next.valid && !btb_taken &&
+    IssuePairing.pairable(io.rom_instruction, io.rom_instruction_next.bits)
+  val btb_next_pc = Mux(btb_taken, btb.io.target, pc + Mux(pair, 8.U, 4.U))
+  io.pair := pair
+  io.btb_predicted_taken  := btb_taken
+  io.btb_predicted_target := btb_next_pc
+  io.pht_predicted_taken  := pht.io.predicted_taken
+  io.pht_index            := pht.io.index
 
   // Return Address Stack for JALR return prediction
-  val ras = Module(new ReturnAddressStack(depth = 4))
+  val ras = Module(new ReturnAddressStack(depth = rasDepth))
 
   // Indirect Branch Target Buffer for non-return JALR prediction
   // Handles function pointers, vtables, computed jumps that RAS doesn't cover
-  val ibtb = Module(new IndirectBTB(entries = 8))
+  val ibtb = Module(new IndirectBTB(entries = ibtbEntries, ways = ibtbWays, historyBits = ibtbHistory))
   ibtb.io.pc := pc
 
   // Detect JALR with rs1=ra (x1) or rs1=t0 (x5) in fetched instruction for speculative pop
@@ -149,8 +229,8 @@ class InstructionFetch extends Module {
   ras.io.push_addr     := io.ras_push_addr
   ras.io.pop           := speculative_ras_pop || io.ras_pop
   ras.io.restore       := io.ras_restore
-  ras.io.restore_addr  := io.ras_restore_addr
-  ras.io.restore_valid := io.ras_restore_valid
+  ras.io.restore_point := io.ras_restore_point
+  io.ras_checkpoint    := ras.io.checkpoint
 
   // RAS prediction output (for ID stage to detect misprediction)
   io.ras_predicted_valid  := ras.io.valid && speculative_ras_pop
@@ -164,6 +244,7 @@ class InstructionFetch extends Module {
   // IndirectBTB prediction output (for ID stage to detect misprediction)
   io.ibtb_predicted_valid  := ibtb_prediction_hit
   io.ibtb_predicted_target := ibtb.io.predicted_target
+  io.ibtb_index            := ibtb.io.index
 
   // Latch jump request when stall is active
   // Problem: When mem_stall releases, PipelineRegister's combinational bypass
@@ -212,11 +293,12 @@ class InstructionFetch extends Module {
     Mux(
       ibtb_prediction_hit,
       ibtb.io.predicted_target,                          // IndirectBTB prediction for non-return JALR
-      Mux(btb.io.predicted_taken, btb_next_pc, pc + 4.U) // BTB prediction or sequential
+      btb_next_pc                                        // BTB prediction or sequential
     )
   )
 
   // Next PC selection priority:
+  // 0. PC written by the simulator
   // 1. Pending jump (deferred from stall)
   // 2. BTB misprediction correction (rollback to sequential PC)
   // 3. Actual jump from ID stage (branch taken / jump)
@@ -226,6 +308,7 @@ class InstructionFetch extends Module {
   val next_pc = MuxCase(
     default_next_pc,
     IndexedSeq(
+      io.debug_pc.valid                             -> io.debug_pc.bits,
       take_pending                                  -> pending_jump_addr,
       take_btb_correction                           -> io.btb_correction_addr,
       take_current                                  -> io.jump_address_id,
@@ -244,9 +327,16 @@ class InstructionFetch extends Module {
   btb.io.update_target := io.btb_update_target
   btb.io.update_taken  := io.btb_update_taken
 
+  // PHT update interface
+  pht.io.update_valid := io.pht_update_valid
+  pht.io.update_index := io.pht_update_index
+  pht.io.update_taken := io.pht_update_taken
+
   // IndirectBTB update interface - connect external update signals
-  ibtb.io.update_valid    := io.ibtb_update_valid
-  ibtb.io.update_pc       := io.ibtb_update_pc
-  ibtb.io.update_rs1_hash := io.ibtb_update_rs1_hash
-  ibtb.io.update_target   := io.ibtb_update_target
+  ibtb.io.update_valid  := io.ibtb_update_valid
+  ibtb.io.update_pc     := io.ibtb_update_pc
+  ibtb.io.update_index  := io.ibtb_update_index
+  ibtb.io.update_target := io.ibtb_update_target
+  ibtb.io.path_valid    := io.ibtb_path_valid
+  ibtb.io.path_target   := io.ibtb_path_target
 }
@@ -84,6 +84,39 @@ object InstructionsTypeDSP {
   val qmul32x16 = "b111".U // Q15 32x16 multiply: (op1 * op2[15:0]) >> 15
 }
 
+// Packed 2x16 variants of the DSP ops: funct7 = 0000001 with these funct3,
+// each 16-bit lane of rs1/rs2 processed independently
+object InstructionsTypeDSPPacked {
+  val funct7  = "b0000001".U
+  val pqmul16 = "b000".U // Dual Q15 multiply
+  val psadd16 = "b001".U // Dual 16-bit saturating add
+  val pssub16 = "b010".U // Dual 16-bit saturating sub
+  val pdot16  = "b011".U // Q15 dot product: (lo * lo + hi * hi) >> 15, 32-bit
+}
+
+// Bit manipulation (Zba, Zbb, Zbs): funct7 selects the group and funct3 the
+// operation, the OP-IMM forms sharing funct7 (imm[11:5]) with the OP ones.
+// Unary ops live under OP-IMM with the operation in the rs2 field.
+object InstructionsTypeBitManip {
+  val shadd  = "b0010000".U // sh1add 010, sh2add 100, sh3add 110
+  val inv    = "b0100000".U // xnor 100, orn 110, andn 111 (beside sub/sra)
+  val minmax = "b0000101".U // min 100, minu 101, max 110, maxu 111
+  val rot    = "b0110000".U // rol 001, ror/rori 101, unary ops 001
+  val zexth  = "b0000100".U // zext.h 100 with rs2 = 0
+  val bclr   = "b0100100".U // bclr/bclri 001, bext/bexti 101
+  val binv   = "b0110100".U // binv/binvi 001, rev8 101
+  val bset   = "b0010100".U // bset/bseti 001, orc.b 101
+
+  // rs2 field of the unary ops
+  val clz   = "b00000".U
+  val ctz   = "b00001".U
+  val cpop  = "b00010".U
+  val sextb = "b00100".U
+  val sexth = "b00101".U
+  val orcb  = "b00111".U
+  val rev8  = "b11000".U
+}
+
 object InstructionsTypeB {
   val beq  = "b000".U
   val bne  = "b001".U
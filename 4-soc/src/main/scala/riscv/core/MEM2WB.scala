@@ -20,6 +20,7 @@ import riscv.Parameters
  * - memory_read_data: Load result after byte/half extraction and sign-extension
  * - instruction_address: Used to compute PC+4 for JAL/JALR writeback
  * - regs_write_*: Register file write control signals
+ * - instruction, trace_valid: Retire trace (see PipelinedCPU io.retire)
  *
  * Critical timing note: The inputs to this register come from MemoryAccess's
  * latched outputs (wb_*), not from ex2mem, to preserve correct values across
@@ -29,6 +30,8 @@ class MEM2WB extends Module {
   val io = IO(new Bundle() {
     val stall               = Input(Bool())
     val instruction_address = Input(UInt(Parameters.AddrWidth))
+    val instruction         = Input(UInt(Parameters.InstructionWidth))
+    val trace_valid         = Input(Bool())
     val alu_result          = Input(UInt(Parameters.DataWidth))
     val regs_write_enable   = Input(Bool())
     val regs_write_source   = Input(UInt(2.W))
@@ -37,6 +40,8 @@ class MEM2WB extends Module {
     val csr_read_data       = Input(UInt(Parameters.DataWidth))
 
     val output_instruction_address = Output(UInt(Parameters.AddrWidth))
+    val output_instruction         = Output(UInt(Parameters.InstructionWidth))
+    val output_trace_valid         = Output(Bool())
     val output_alu_result          = Output(UInt(Parameters.DataWidth))
     val output_regs_write_enable   = Output(Bool())
     val output_regs_write_source   = Output(UInt(2.W))
@@ -83,6 +88,18 @@ class MEM2WB extends Module {
   instruction_address.io.flush  := flush
   io.output_instruction_address := instruction_address.io.out
 
+  val instruction = Module(new PipelineRegister(Parameters.InstructionBits, InstructionsNop.nop))
+  instruction.io.in     := io.instruction
+  instruction.io.stall  := stall
+  instruction.io.flush  := flush
+  io.output_instruction := instruction.io.out
+
+  val trace_valid = Module(new PipelineRegister(1))
+  trace_valid.io.in     := io.trace_valid
+  trace_valid.io.stall  := stall
+  trace_valid.io.flush  := flush
+  io.output_trace_valid := trace_valid.io.out
+
   val csr_read_data = Module(new PipelineRegister())
   csr_read_data.io.in     := io.csr_read_data
   csr_read_data.io.stall  := stall
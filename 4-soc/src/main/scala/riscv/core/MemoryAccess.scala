@@ -27,7 +27,10 @@ object MemoryAccessStates extends ChiselEnum {
  * - Latched control signals to handle stall release timing
  *
  * State Machine:
- * - Idle: Monitor memory_read_enable/memory_write_enable, start transactions
+ * - Idle: Monitor memory_read_enable/memory_write_enable, start transactions;
+ *   one granted with read_valid/write_valid in the same cycle (a data cache
+ *   hit) completes without a stall, and so does one to the data TCM, which
+ *   never reaches the bus
  * - Read: Wait for bus.read_valid, extract data, release stall
  * - Write: Wait for bus.write_valid (BRESP), release stall
  *
@@ -39,8 +42,10 @@ object MemoryAccessStates extends ChiselEnum {
  *   are latched for MEM2WB to ensure correct writeback after read completes.
  * - forward_to_ex uses latched values ONLY while in Read state; after
  *   completion, the new instruction's values must be used.
+ *
+ * @param tcm Add the port to a DataTCM
  */
-class MemoryAccess extends Module {
+class MemoryAccess(tcm: Boolean = false) extends Module {
   val io = IO(new Bundle() {
     val alu_result          = Input(UInt(Parameters.DataWidth))                 // used as memory address
     val reg2_data           = Input(UInt(Parameters.DataWidth))
@@ -63,6 +68,7 @@ class MemoryAccess extends Module {
     val wb_regs_write_enable  = Output(Bool())
 
     val bus = new BusBundle
+    val tcm = if (tcm) Some(new DataTCMBundle) else None
   })
   val mem_address_index = io.alu_result(log2Up(Parameters.WordSize) - 1, 0).asUInt
   val mem_access_state  = RegInit(MemoryAccessStates.Idle)
@@ -114,9 +120,20 @@ class MemoryAccess extends Module {
   io.bus.write_data      := 0.U
   io.bus.write_strobe    := VecInit(Seq.fill(Parameters.WordSize)(false.B))
   io.bus.write           := false.B
+  io.bus.burst_length    := 0.U
   io.wb_memory_read_data := latched_memory_read_data // Use latched value
   io.ctrl_stall_flag     := false.B
 
+  // Data TCM: the access in MEM hits it by address; stores take the bus's
+  // write data and strobes computed below
+  val tcm_hit = io.tcm.map(_.hit).getOrElse(false.B)
+  io.tcm.foreach { port =>
+    port.address      := io.alu_result
+    port.write        := false.B
+    port.write_data   := io.bus.write_data
+    port.write_strobe := io.bus.write_strobe
+  }
+
   // Misaligned access handling:
   // RISC-V spec allows implementation-defined behavior for misaligned accesses.
   // Current implementation supports within-word misalignment for byte and halfword:
@@ -128,6 +145,56 @@ class MemoryAccess extends Module {
   // Cross-word-boundary accesses would require two bus transactions and are not implemented.
   // For strict compliance with exception-based handling, add misalignment trap logic.
 
+  // Loaded data: byte/halfword extraction with sign extension.
+  // Use io.funct3 and mem_address_index directly - PipelineRegister is purely
+  // sequential (io.out := reg), NOT combinational bypass, so these signals
+  // remain stable during the entire bus transaction while mem_stall is asserted.
+  val data = Mux(tcm_hit, io.tcm.map(_.read_data).getOrElse(0.U), io.bus.read_data)
+
+  val processed_data = MuxLookup(
+    io.funct3,
+    0.U,
+    IndexedSeq(
+      InstructionsTypeL.lb -> MuxLookup(
+        mem_address_index,
+        Cat(Fill(24, data(31)), data(31, 24)),
+        IndexedSeq(
+          0.U -> Cat(Fill(24, data(7)), data(7, 0)),
+          1.U -> Cat(Fill(24, data(15)), data(15, 8)),
+          2.U -> Cat(Fill(24, data(23)), data(23, 16))
+        )
+      ),
+      InstructionsTypeL.lbu -> MuxLookup(
+        mem_address_index,
+        Cat(Fill(24, 0.U), data(31, 24)),
+        IndexedSeq(
+          0.U -> Cat(Fill(24, 0.U), data(7, 0)),
+          1.U -> Cat(Fill(24, 0.U), data(15, 8)),
+          2.U -> Cat(Fill(24, 0.U), data(23, 16))
+        )
+      ),
+      InstructionsTypeL.lh -> MuxLookup(
+        mem_address_index,
+        Cat(Fill(16, data(31)), data(31, 16)), // offset 3: best-effort (crosses word boundary)
+        IndexedSeq(
+          0.U -> Cat(Fill(16, data(15)), data(15, 0)), // bytes 0-1
+          1.U -> Cat(Fill(16, data(23)), data(23, 8)), // bytes 1-2
+          2.U -> Cat(Fill(16, data(31)), data(31, 16)) // bytes 2-3
+        )
+      ),
+      InstructionsTypeL.lhu -> MuxLookup(
+        mem_address_index,
+        Cat(Fill(16, 0.U), data(31, 16)), // offset 3: best-effort (crosses word boundary)
+        IndexedSeq(
+          0.U -> Cat(Fill(16, 0.U), data(15, 0)), // bytes 0-1
+          1.U -> Cat(Fill(16, 0.U), data(23, 8)), // bytes 1-2
+          2.U -> Cat(Fill(16, 0.U), data(31, 16)) // bytes 2-3
+        )
+      ),
+      InstructionsTypeL.lw -> data
+    )
+  )
+
   // State machine: handle Read/Write completion FIRST (independent of enable signals)
   // This fixes a critical bug where the state machine would get stuck if the pipeline
   // moved on (enable went low) before the bus transaction completed.
@@ -136,54 +203,6 @@ class MemoryAccess extends Module {
     io.bus.request     := true.B
     io.ctrl_stall_flag := true.B
     when(io.bus.read_valid) {
-      val data = io.bus.read_data
-      // Compute the processed data (byte/halfword extraction with sign extension)
-      // Use io.funct3 and mem_address_index directly - PipelineRegister is purely
-      // sequential (io.out := reg), NOT combinational bypass, so these signals
-      // remain stable during the entire bus transaction while mem_stall is asserted.
-      val processed_data = MuxLookup(
-        io.funct3,
-        0.U,
-        IndexedSeq(
-          InstructionsTypeL.lb -> MuxLookup(
-            mem_address_index,
-            Cat(Fill(24, data(31)), data(31, 24)),
-            IndexedSeq(
-              0.U -> Cat(Fill(24, data(7)), data(7, 0)),
-              1.U -> Cat(Fill(24, data(15)), data(15, 8)),
-              2.U -> Cat(Fill(24, data(23)), data(23, 16))
-            )
-          ),
-          InstructionsTypeL.lbu -> MuxLookup(
-            mem_address_index,
-            Cat(Fill(24, 0.U), data(31, 24)),
-            IndexedSeq(
-              0.U -> Cat(Fill(24, 0.U), data(7, 0)),
-              1.U -> Cat(Fill(24, 0.U), data(15, 8)),
-              2.U -> Cat(Fill(24, 0.U), data(23, 16))
-            )
-          ),
-          InstructionsTypeL.lh -> MuxLookup(
-            mem_address_index,
-            Cat(Fill(16, data(31)), data(31, 16)), // offset 3: best-effort (crosses word boundary)
-            IndexedSeq(
-              0.U -> Cat(Fill(16, data(15)), data(15, 0)), // bytes 0-1
-              1.U -> Cat(Fill(16, data(23)), data(23, 8)), // bytes 1-2
-              2.U -> Cat(Fill(16, data(31)), data(31, 16)) // bytes 2-3
-            )
-          ),
-          InstructionsTypeL.lhu -> MuxLookup(
-            mem_address_index,
-            Cat(Fill(16, 0.U), data(31, 16)), // offset 3: best-effort (crosses word boundary)
-            IndexedSeq(
-              0.U -> Cat(Fill(16, 0.U), data(15, 0)), // bytes 0-1
-              1.U -> Cat(Fill(16, 0.U), data(23, 8)), // bytes 1-2
-              2.U -> Cat(Fill(16, 0.U), data(31, 16)) // bytes 2-3
-            )
-          ),
-          InstructionsTypeL.lw -> data
-        )
-      )
       // Store in register for persistence after read_valid goes low
       latched_memory_read_data := processed_data
       // Also output immediately for forwarding on this cycle
@@ -210,7 +229,12 @@ class MemoryAccess extends Module {
     }
   }.otherwise {
     // Idle state: check enable signals to start new transactions
-    when(io.memory_read_enable) {
+    when(io.memory_read_enable && tcm_hit) {
+      // Data TCM: the word is read in this cycle, no stall, no Read state
+      latched_memory_read_data := processed_data
+      io.wb_memory_read_data   := processed_data
+      read_just_completed      := true.B
+    }.elsewhen(io.memory_read_enable) {
       // Start the read transaction when the bus is available
       io.ctrl_stall_flag := true.B
       io.bus.read        := true.B
@@ -221,7 +245,13 @@ class MemoryAccess extends Module {
       latched_regs_write_source  := io.regs_write_source
       latched_regs_write_address := io.regs_write_address
       latched_regs_write_enable  := io.regs_write_enable
-      when(io.bus.granted) {
+      when(io.bus.granted && io.bus.read_valid) {
+        // Served in the request cycle (data cache hit): no stall, no Read state
+        latched_memory_read_data := processed_data
+        io.wb_memory_read_data   := processed_data
+        io.ctrl_stall_flag       := false.B
+        read_just_completed      := true.B
+      }.elsewhen(io.bus.granted) {
         mem_access_state := MemoryAccessStates.Read
       }
     }.elsewhen(io.memory_write_enable) {
@@ -263,9 +293,19 @@ class MemoryAccess extends Module {
           io.bus.write_strobe(i) := true.B
         }
       }
-      io.bus.request := true.B
-      when(io.bus.granted) {
-        mem_access_state := MemoryAccessStates.Write
+      when(tcm_hit) {
+        // Data TCM: written at the clock edge, no bus transaction
+        io.bus.write       := false.B
+        io.ctrl_stall_flag := false.B
+        io.tcm.foreach(_.write := true.B)
+      }.otherwise {
+        io.bus.request := true.B
+        when(io.bus.granted && io.bus.write_valid) {
+          // Accepted in the request cycle (data cache): no stall, no Write state
+          io.ctrl_stall_flag := false.B
+        }.elsewhen(io.bus.granted) {
+          mem_access_state := MemoryAccessStates.Write
+        }
       }
     }
   }
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv.core
+
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * Pattern History Table: gshare direction predictor for conditional branches
+ *
+ * Purpose:
+ * - The BTB's per-entry counters only learn a bias per branch
+ * - Loop exits, alternating branches and branches that depend on an earlier
+ *   branch (the MIDI parser's status-byte checks) follow the recent outcome
+ *   pattern instead
+ * - Indexing the counters by PC XOR global history gives every such pattern
+ *   its own counter
+ *
+ * Architecture:
+ * - entries 2-bit saturating counters, initialised to Weakly Taken (2)
+ * - Index = PC[indexBits+1:2] XOR global history (historyBits most recent
+ *   conditional branch outcomes, newest in bit 0)
+ * - historyBits = 0 degenerates to a bimodal table indexed by PC alone
+ *
+ * Operation:
+ * - IF stage: combinational prediction for the fetch PC; the index used is
+ *   output so that it travels with the instruction to ID
+ * - ID stage: the resolved branch trains the counter at that index and
+ *   shifts its outcome into the history
+ *
+ * The history is updated at resolution, not speculatively, so a branch
+ * fetched while the previous one is still in ID predicts without that
+ * outcome. Training with the carried index keeps prediction and update on
+ * the same counter either way.
+ *
+ * @param entries     Number of counters (must be power of 2)
+ * @param historyBits Global history length, at most log2(entries)
+ */
+class PatternHistoryTable(entries: Int = 256, historyBits: Int = 8) extends Module {
+  require(isPow2(entries) && entries >= 2, "PHT entries must be power of 2")
+  val indexBits = log2Ceil(entries)
+  require(historyBits >= 0 && historyBits <= indexBits, "PHT history cannot be longer than the index")
+
+  val io = IO(new Bundle {
+    // Prediction interface (IF stage) - combinational lookup
+    val pc              = Input(UInt(Parameters.AddrWidth))
+    val predicted_taken = Output(Bool())
+    val index           = Output(UInt(indexBits.W))
+
+    // Update interface (ID stage) - registered update
+    val update_valid = Input(Bool())
+    val update_index = Input(UInt(indexBits.W))
+    val update_taken = Input(Bool())
+  })
+
+  val counters = RegInit(VecInit(Seq.fill(entries)(2.U(2.W))))
+  val history  = RegInit(0.U(historyBits.max(1).W))
+
+  val pc_bits = io.pc(indexBits + 1, 2)
+  val index   = if (historyBits == 0) pc_bits else pc_bits ^ history(historyBits - 1, 0)
+
+  io.index           := index
+  io.predicted_taken := counters(index)(1)
+
+  when(io.update_valid) {
+    val counter = counters(io.update_index)
+    counters(io.update_index) := Mux(
+      io.update_taken,
+      Mux(counter === 3.U, 3.U, counter + 1.U),
+      Mux(counter === 0.U, 0.U, counter - 1.U)
+    )
+    if (historyBits > 0) {
+      history := Cat(history(historyBits - 1, 0), io.update_taken)(historyBits - 1, 0)
+    }
+  }
+}
@@ -6,6 +6,7 @@ package riscv.core
 
 import chisel3._
 import chisel3.util.MuxLookup
+import chisel3.util.Valid
 import riscv.core.CPUBundle
 import riscv.core.CSR
 import riscv.core.RegisterFile
@@ -105,31 +106,79 @@ import riscv.Parameters
  *
  * Interface (CPUBundle):
  * - instruction_address: PC to instruction memory
- * - instruction/instruction_valid: Instruction memory interface
- * - memory_bundle: Data memory/MMIO interface (AXI4-Lite style)
+ * - instruction/instruction_valid: Instruction memory interface; with the
+ *   instruction cache (icacheLines > 0) only instruction_valid is used, as
+ *   the fetch enable
+ * - instruction_bundle: Instruction cache refills (PipelinedCPUBundle)
+ * - memory_bundle: Data memory/MMIO interface (AXI4-Lite style), behind the
+ *   data cache when dcacheLines > 0; the data TCM's range never reaches it
  * - device_select: Upper address bits for peripheral routing
  * - interrupt_flag: External interrupt input
  * - debug_read_address/data: Register file inspection
  * - csr_debug_read_address/data: CSR inspection
+ * - debug_write: Register, CSR, PC and data TCM writes from the simulator
+ * - retire: One retired instruction per cycle, for the simulation trace
+ *   (retire_b: the second of a dual-issue pair)
+ *
+ * Dual Issue (dualIssue, ImplementationType.DualIssue):
+ * - A second issue slot, B, runs beside every stage as an ALU-only pipe
+ *   (id_b, id2ex_b, an ALU, ex2mem_b, mem2wb_b); loads, stores, jumps,
+ *   M, CSR and SYSTEM instructions stay in slot A, with the only memory pipe
+ * - IF pairs the word after slot A's from the same instruction cache line
+ *   when IssuePairing allows it and steps the PC by 8; without the
+ *   instruction cache nothing pairs
+ * - Slot B's pipeline registers stall and flush with slot A's, so a pair
+ *   moves as one; slot B is the younger of the two
+ * - The register file has 4 read and 2 write ports, and forwarding prefers
+ *   slot B over slot A within a stage (Forwarding); Control also stalls for
+ *   slot B's load-use and JAL/JALR hazards
+ *
+ * @param icacheLines Instruction cache lines, 0 to fetch from the external port
+ * @param dcacheLines Data cache lines, 0 to send every load and store to the bus
+ * @param storeBufferEntries Store buffer entries, 0 to hold each store in MEM
+ *   until it is written
+ * @param dataTCMBytes Data TCM size, 0 to send its range to main memory
+ * @param dualIssue Add issue slot B (two-wide in-order pipeline)
  */
-class PipelinedCPU extends Module {
-  val io = IO(new CPUBundle)
-
-  val ctrl       = Module(new Control)
-  val regs       = Module(new RegisterFile)
+class PipelinedCPU(
+    icacheLines: Int = Parameters.ICacheLines,
+    dcacheLines: Int = Parameters.DCacheLines,
+    storeBufferEntries: Int = Parameters.StoreBufferEntries,
+    dataTCMBytes: Int = Parameters.DataTCMBytes,
+    dualIssue: Boolean = false
+) extends Module {
+  val io = IO(new PipelinedCPUBundle)
+
+  val ctrl       = Module(new Control(dualIssue))
+  val regs       = Module(new RegisterFile(dualIssue))
   val inst_fetch = Module(new InstructionFetch)
   val if2id      = Module(new IF2ID)
   val id         = Module(new InstructionDecode)
   val id2ex      = Module(new ID2EX)
   val ex         = Module(new Execute)
   val ex2mem     = Module(new EX2MEM)
-  val mem        = Module(new MemoryAccess)
+  val mem        = Module(new MemoryAccess(tcm = dataTCMBytes > 0))
   val mem2wb     = Module(new MEM2WB)
   val wb         = Module(new WriteBack)
-  val forwarding = Module(new Forwarding)
+  val forwarding = Module(new Forwarding(dualIssue))
   val clint      = Module(new CLINT)
   val csr_regs   = Module(new CSR)
 
+  // Slot B results in MEM and WB for the forwarding paths (dual issue; the
+  // single-issue pipeline never selects them)
+  val forward_from_mem_b = WireDefault(0.U(Parameters.DataWidth))
+  val forward_from_wb_b  = WireDefault(0.U(Parameters.DataWidth))
+
+  // Register value after the forwarding path select chose
+  def forwarded(select: UInt, register_data: UInt): UInt = MuxLookup(select, register_data)(
+    IndexedSeq(
+      ForwardingType.ForwardFromMEM  -> mem.io.forward_to_ex,
+      ForwardingType.ForwardFromWB   -> wb.io.regs_write_data,
+      ForwardingType.ForwardFromMEMB -> forward_from_mem_b,
+      ForwardingType.ForwardFromWBB  -> forward_from_wb_b
+    )
+  )
+
   ctrl.io.jump_flag               := id.io.if_jump_flag
   ctrl.io.jump_instruction_id     := id.io.ctrl_jump_instruction
   ctrl.io.rs1_id                  := id.io.regs_reg1_read_address
@@ -150,25 +199,74 @@ class PipelinedCPU extends Module {
   ctrl.io.mul_busy := ex.io.mul_busy
   ctrl.io.div_busy := ex.io.div_busy
 
-  regs.io.write_enable  := mem2wb.io.output_regs_write_enable
-  regs.io.write_address := mem2wb.io.output_regs_write_address
-  regs.io.write_data    := wb.io.regs_write_data
+  // Simulator state writes take the write-back and CSR write ports, which
+  // carry only bubbles while fetch is held
+  val debug_write_regs = io.debug_write.valid && io.debug_write.target === DebugWriteTarget.Register
+  val debug_write_csr  = io.debug_write.valid && io.debug_write.target === DebugWriteTarget.CSR
+  val debug_write_pc   = io.debug_write.valid && io.debug_write.target === DebugWriteTarget.PC
+
+  regs.io.write_enable  := mem2wb.io.output_regs_write_enable || debug_write_regs
+  regs.io.write_address := Mux(debug_write_regs, io.debug_write.address(4, 0), mem2wb.io.output_regs_write_address)
+  regs.io.write_data    := Mux(debug_write_regs, io.debug_write.data, wb.io.regs_write_data)
   regs.io.read_address1 := id.io.regs_reg1_read_address
   regs.io.read_address2 := id.io.regs_reg2_read_address
 
   regs.io.debug_read_address := io.debug_read_address
   io.debug_read_data         := regs.io.debug_read_data
 
+  // Store buffer between MEM and the data cache: stores leave MEM at once and
+  // drain in the background. A FENCE waits in MEM until it is empty, which
+  // orders buffered MMIO stores before later loads.
+  val store_buffer = if (storeBufferEntries > 0) Some(Module(new StoreBuffer(storeBufferEntries))) else None
+  val stores_empty = store_buffer.map(_.io.empty).getOrElse(true.B)
+  val mem_fence =
+    ex2mem.io.output_instruction(6, 0) === Instructions.fence && ex2mem.io.output_instruction(14, 12) === 0.U
+  val fence_stall = mem_fence && !stores_empty
+
   // Memory stall signal: freeze entire pipeline when AXI4 bus transactions are pending
-  val mem_stall = mem.io.ctrl_stall_flag
+  val mem_stall = mem.io.ctrl_stall_flag || fence_stall
 
   // Instruction memory interface
-  io.instruction_address          := inst_fetch.io.instruction_address
-  inst_fetch.io.stall_flag_ctrl   := ctrl.io.pc_stall || mem_stall
-  inst_fetch.io.jump_flag_id      := id.io.if_jump_flag
-  inst_fetch.io.jump_address_id   := id.io.if_jump_address
-  inst_fetch.io.rom_instruction   := io.instruction
-  inst_fetch.io.instruction_valid := io.instruction_valid
+  io.instruction_address        := inst_fetch.io.instruction_address
+  inst_fetch.io.stall_flag_ctrl := ctrl.io.pc_stall || mem_stall
+  inst_fetch.io.jump_flag_id    := id.io.if_jump_flag
+  inst_fetch.io.jump_address_id := id.io.if_jump_address
+  inst_fetch.io.debug_pc.valid  := debug_write_pc
+  inst_fetch.io.debug_pc.bits   := io.debug_write.data
+
+  // Data cache between MEM and the bus; while FENCE.I drains the store buffer
+  // and writes the data cache back, fetch waits so that it reads the stored
+  // code
+  val dcache          = if (dcacheLines > 0) Some(Module(new DataCache(lines = dcacheLines))) else None
+  val dcache_flushing = dcache.map(_.io.flushing).getOrElse(false.B)
+  val fence_i_pending = RegInit(false.B)
+  val fetch_held      = fence_i_pending || dcache_flushing
+
+  // Instruction cache: a miss reads as !instruction_valid, which holds the PC
+  // and sends bubbles to ID until the line is in
+  val icache = if (icacheLines > 0) Some(Module(new InstructionCache(lines = icacheLines))) else None
+  icache match {
+    case Some(cache) =>
+      cache.io.address                := inst_fetch.io.instruction_address
+      cache.io.enable                 := io.instruction_valid && !fetch_held
+      inst_fetch.io.rom_instruction   := cache.io.instruction
+      inst_fetch.io.instruction_valid := cache.io.valid && !fetch_held
+      io.instruction_bundle <> cache.io.bus
+      // Dual issue pairs with the next word of the same line
+      inst_fetch.io.rom_instruction_next.valid := cache.io.next_instruction.valid && !fetch_held && dualIssue.B
+      inst_fetch.io.rom_instruction_next.bits  := cache.io.next_instruction.bits
+    case None =>
+      inst_fetch.io.rom_instruction      := io.instruction
+      inst_fetch.io.instruction_valid    := io.instruction_valid && !fetch_held
+      inst_fetch.io.rom_instruction_next := 0.U.asTypeOf(Valid(UInt(Parameters.InstructionWidth)))
+      io.instruction_bundle.address      := 0.U
+      io.instruction_bundle.read         := false.B
+      io.instruction_bundle.write        := false.B
+      io.instruction_bundle.write_data   := 0.U
+      io.instruction_bundle.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(false.B))
+      io.instruction_bundle.request      := false.B
+      io.instruction_bundle.burst_length := 0.U
+  }
 
   // Prediction signals from IF2ID pipeline register (all predictors)
   val btb_predicted    = if2id.io.output_btb_predicted_taken
@@ -235,7 +333,25 @@ class PipelinedCPU extends Module {
     btb_correction_addr_raw
   )
 
-  inst_fetch.io.btb_mispredict         := btb_mispredict
+  // FENCE.I: invalidate the instruction cache, write back the data cache and
+  // refetch from PC+4 through the BTB correction path (PC+4 for a non-branch).
+  // It acts as it leaves ID, which holds fetch until the older stores are
+  // written: by the next cycle the store in EX (if any) has reached MEM, and
+  // once no store is in MEM or the store buffer the data cache starts its
+  // write-back walk, which holds fetch until it is done.
+  val id_fence_i =
+    if2id.io.output_instruction(6, 0) === Instructions.fence && if2id.io.output_instruction(14, 12) === 1.U
+  val fence_i        = id_fence_i && !ctrl.io.if_stall && !mem_stall
+  val stores_drained = stores_empty && !ex2mem.io.output_memory_write_enable
+  when(fence_i) {
+    fence_i_pending := true.B
+  }.elsewhen(stores_drained) {
+    fence_i_pending := false.B
+  }
+  icache.foreach(_.io.invalidate := fence_i)
+  dcache.foreach(_.io.flush := fence_i_pending && stores_drained)
+
+  inst_fetch.io.btb_mispredict         := btb_mispredict || fence_i
   inst_fetch.io.btb_correction_addr    := btb_correction_addr_effective
   inst_fetch.io.btb_correct_prediction := btb_correct_prediction
 
@@ -248,6 +364,13 @@ class PipelinedCPU extends Module {
   inst_fetch.io.btb_update_target := id.io.if_jump_address
   inst_fetch.io.btb_update_taken  := id.io.if_jump_flag && id_is_branch_or_jump // Non-branch = not taken
 
+  // PHT update: conditional branches train the counter they were predicted with
+  val id_is_cond_branch    = if2id.io.output_instruction(6, 0) === InstructionTypes.B
+  val cond_branch_resolved = id_is_cond_branch && !id.io.branch_hazard && !mem_stall
+  inst_fetch.io.pht_update_valid := cond_branch_resolved
+  inst_fetch.io.pht_update_index := if2id.io.output_pht_index
+  inst_fetch.io.pht_update_taken := actual_taken
+
   // Return Address Stack (RAS) update logic
   // Detect instruction type from ID stage for call/return pattern recognition
   val id_instruction = if2id.io.output_instruction
@@ -289,47 +412,30 @@ class PipelinedCPU extends Module {
   // If RAS prediction was wrong, the speculative pop removed an incorrect entry anyway
   inst_fetch.io.ras_pop := false.B // Speculative pop already done in IF stage
 
-  // RAS restore: disabled
-  // The previous implementation incorrectly pushed actual_target (JALR destination = rs1+imm),
-  // but the RAS should only contain return addresses (PC+4 from JAL/JALR calls).
-  // When RAS mispredicts, the popped value was wrong anyway (stack corrupted or empty),
-  // so there's nothing meaningful to restore. Pushing actual_target would corrupt the RAS
-  // with non-return addresses, degrading future predictions.
-  //
-  // The correct behavior is to accept the speculative pop:
-  // - If the pop removed a valid return address, it would have been correct (no misprediction)
-  // - If the pop removed garbage or was from empty stack, no harm in losing it
-  inst_fetch.io.ras_restore       := false.B
-  inst_fetch.io.ras_restore_addr  := 0.U
-  inst_fetch.io.ras_restore_valid := false.B
-
-  // ID-stage forwarding for register data (used by ID2EX and IndirectBTB hash)
+  // RAS restore: see the IF2ID flush below. The only wrong-path instruction
+  // is the one IF fetches while ID redirects, so rolling back to the checkpoint
+  // of the instruction in ID undoes its pop. A mispredicted return keeps its
+  // own pop, which was right even if the predicted address was not.
+
+  // ID-stage forwarding for register data (used by ID2EX)
   // This is critical for cases where an instruction reads a register written by
   // an instruction 2 stages ahead (e.g., jal writes ra, then addi, then sw reads ra).
   // By the time sw reaches EX stage, jal is past WB and EX forwarding can't help.
   // ID-stage forwarding captures the correct value when sw is in ID stage.
-  val id_reg1_data_forwarded = MuxLookup(forwarding.io.reg1_forward_id, regs.io.read_data1)(
-    IndexedSeq(
-      ForwardingType.ForwardFromMEM -> mem.io.forward_to_ex,
-      ForwardingType.ForwardFromWB  -> wb.io.regs_write_data
-    )
-  )
-  val id_reg2_data_forwarded = MuxLookup(forwarding.io.reg2_forward_id, regs.io.read_data2)(
-    IndexedSeq(
-      ForwardingType.ForwardFromMEM -> mem.io.forward_to_ex,
-      ForwardingType.ForwardFromWB  -> wb.io.regs_write_data
-    )
-  )
-
-  // IndirectBTB update: train on non-return JALR instructions when they resolve
-  // Update with (PC, rs1_hash) → target mapping to improve future predictions
-  // Uses forwarded rs1 value for hash calculation (same value used for target computation)
-  val ibtb_rs1_hash      = IndirectBTBHash(id_reg1_data_forwarded)
-  val ibtb_should_update = is_indirect_jalr && !id.io.branch_hazard && !mem_stall
-  inst_fetch.io.ibtb_update_valid    := ibtb_should_update
-  inst_fetch.io.ibtb_update_pc       := if2id.io.output_instruction_address
-  inst_fetch.io.ibtb_update_rs1_hash := ibtb_rs1_hash
-  inst_fetch.io.ibtb_update_target   := actual_target
+  val id_reg1_data_forwarded = forwarded(forwarding.io.reg1_forward_id, regs.io.read_data1)
+  val id_reg2_data_forwarded = forwarded(forwarding.io.reg2_forward_id, regs.io.read_data2)
+
+  // IndirectBTB update: train on non-return JALR instructions when they resolve,
+  // in the set they were predicted from (index carried in IF2ID). Every
+  // resolved JALR, returns included, extends the path history.
+  val jalr_resolved      = is_jalr && !id.io.branch_hazard && !mem_stall
+  val ibtb_should_update = jalr_resolved && is_indirect_jalr
+  inst_fetch.io.ibtb_update_valid  := ibtb_should_update
+  inst_fetch.io.ibtb_update_pc     := if2id.io.output_instruction_address
+  inst_fetch.io.ibtb_update_index  := if2id.io.output_ibtb_index
+  inst_fetch.io.ibtb_update_target := actual_target
+  inst_fetch.io.ibtb_path_valid    := jalr_resolved
+  inst_fetch.io.ibtb_path_target   := actual_target
 
   if2id.io.stall := ctrl.io.if_stall || mem_stall
   // Suppress IF2ID flush during mem_stall!
@@ -359,8 +465,8 @@ class PipelinedCPU extends Module {
   //   This is the key optimization: when prediction was correct,
   //   IF already fetched the correct next instruction, so no flush needed!
   val prediction_correct = btb_correct_prediction || ras_correct_predict || ibtb_correct_predict
-  val need_if_flush =
-    (ctrl.io.if_flush && !prediction_correct) || btb_mispredict || ras_wrong_target || ibtb_wrong_target
+  val need_if_flush = (ctrl.io.if_flush && !prediction_correct) || btb_mispredict || ras_wrong_target ||
+    ibtb_wrong_target || fence_i
   if2id.io.flush                 := need_if_flush && !mem_stall
   if2id.io.instruction           := inst_fetch.io.id_instruction
   if2id.io.instruction_address   := inst_fetch.io.instruction_address
@@ -371,6 +477,15 @@ class PipelinedCPU extends Module {
   if2id.io.ras_predicted_target  := inst_fetch.io.ras_predicted_target
   if2id.io.ibtb_predicted_valid  := inst_fetch.io.ibtb_predicted_valid
   if2id.io.ibtb_predicted_target := inst_fetch.io.ibtb_predicted_target
+  if2id.io.ibtb_index            := inst_fetch.io.ibtb_index
+  if2id.io.ras_checkpoint        := inst_fetch.io.ras_checkpoint
+  if2id.io.pht_predicted_taken   := inst_fetch.io.pht_predicted_taken
+  if2id.io.pht_index             := inst_fetch.io.pht_index
+
+  // Roll the RAS back to the checkpoint of the instruction in ID when IF2ID
+  // flushes (a flushed slot carries no checkpoint)
+  inst_fetch.io.ras_restore       := if2id.io.flush && if2id.io.output_ras_checkpoint_valid
+  inst_fetch.io.ras_restore_point := if2id.io.output_ras_checkpoint
 
   id.io.instruction               := if2id.io.output_instruction
   id.io.instruction_address       := if2id.io.output_instruction_address
@@ -378,6 +493,8 @@ class PipelinedCPU extends Module {
   id.io.reg2_data                 := regs.io.read_data2
   id.io.forward_from_mem          := mem.io.forward_to_ex
   id.io.forward_from_wb           := wb.io.regs_write_data
+  id.io.forward_from_mem_b        := forward_from_mem_b
+  id.io.forward_from_wb_b         := forward_from_wb_b
   id.io.reg1_forward              := forwarding.io.reg1_forward_id
   id.io.reg2_forward              := forwarding.io.reg2_forward_id
   id.io.interrupt_assert          := clint.io.id_interrupt_assert
@@ -427,6 +544,8 @@ class PipelinedCPU extends Module {
   ex.io.csr_read_data       := id2ex.io.output_csr_read_data
   ex.io.forward_from_mem    := mem.io.forward_to_ex
   ex.io.forward_from_wb     := wb.io.regs_write_data
+  ex.io.forward_from_mem_b  := forward_from_mem_b
+  ex.io.forward_from_wb_b   := forward_from_wb_b
   ex.io.reg1_forward        := forwarding.io.reg1_forward_ex
   ex.io.reg2_forward        := forwarding.io.reg2_forward_ex
 
@@ -436,6 +555,7 @@ class PipelinedCPU extends Module {
   ex2mem.io.regs_write_source   := id2ex.io.output_regs_write_source
   ex2mem.io.regs_write_address  := id2ex.io.output_regs_write_address
   ex2mem.io.instruction_address := id2ex.io.output_instruction_address
+  ex2mem.io.instruction         := id2ex.io.output_instruction
   ex2mem.io.funct3              := id2ex.io.output_instruction(14, 12)
   ex2mem.io.reg2_data           := ex.io.mem_reg2_data
   ex2mem.io.memory_read_enable  := id2ex.io.output_memory_read_enable
@@ -453,14 +573,35 @@ class PipelinedCPU extends Module {
   mem.io.regs_write_enable   := ex2mem.io.output_regs_write_enable
   mem.io.csr_read_data       := ex2mem.io.output_csr_read_data
   mem.io.instruction_address := ex2mem.io.output_instruction_address // For JAL/JALR forwarding
-  io.device_select := mem.io.bus
+  store_buffer.foreach(_.io.cpu <> mem.io.bus)
+  val mem_port = store_buffer.map(_.io.bus).getOrElse(mem.io.bus)
+  dcache.foreach(_.io.cpu <> mem_port)
+  dcache.foreach(_.io.snoop := io.snoop)
+  val data_bus = dcache.map(_.io.bus).getOrElse(mem_port)
+  io.device_select := data_bus
     .address(Parameters.AddrBits - 1, Parameters.AddrBits - Parameters.SlaveDeviceCountBits)
-  io.memory_bundle <> mem.io.bus
-  io.memory_bundle.address := 0.U(Parameters.SlaveDeviceCountBits.W) ## mem.io.bus
+  io.memory_bundle <> data_bus
+  io.memory_bundle.address := 0.U(Parameters.SlaveDeviceCountBits.W) ## data_bus
     .address(Parameters.AddrBits - 1 - Parameters.SlaveDeviceCountBits, 0)
 
+  // Data TCM beside MEM: its loads and stores complete there without the bus
+  val tcm = if (dataTCMBytes > 0) Some(Module(new DataTCM(dataTCMBytes))) else None
+  tcm.foreach(_.io.cpu <> mem.io.tcm.get)
+  tcm.foreach(_.io.debug_write := io.debug_write)
+
+  // EX2MEM holds while the multiplier/divider is busy but MEM2WB keeps
+  // sampling it, so only the first copy of each EX2MEM entry is traced.
+  val ex2mem_fresh = RegInit(false.B)
+  when(!(mem_stall || ex_busy)) {
+    ex2mem_fresh := true.B
+  }.elsewhen(!mem_stall) {
+    ex2mem_fresh := false.B
+  }
+
   mem2wb.io.stall               := mem_stall
   mem2wb.io.instruction_address := ex2mem.io.output_instruction_address
+  mem2wb.io.instruction         := ex2mem.io.output_instruction
+  mem2wb.io.trace_valid         := ex2mem_fresh && ex2mem.io.output_instruction =/= InstructionsNop.nop
   mem2wb.io.alu_result          := ex2mem.io.output_alu_result
   // Use MEM stage's latched outputs instead of ex2mem outputs for ALL writeback signals
   // This preserves correct values when mem_stall releases (PipelineRegister bypass issue)
@@ -494,9 +635,9 @@ class PipelinedCPU extends Module {
   clint.io.csr_bundle <> csr_regs.io.clint_access_bundle
 
   csr_regs.io.reg_read_address_id    := id.io.ex_csr_address
-  csr_regs.io.reg_write_enable_ex    := id2ex.io.output_csr_write_enable
-  csr_regs.io.reg_write_address_ex   := id2ex.io.output_csr_address
-  csr_regs.io.reg_write_data_ex      := ex.io.csr_write_data
+  csr_regs.io.reg_write_enable_ex    := id2ex.io.output_csr_write_enable || debug_write_csr
+  csr_regs.io.reg_write_address_ex   := Mux(debug_write_csr, io.debug_write.address(11, 0), id2ex.io.output_csr_address)
+  csr_regs.io.reg_write_data_ex      := Mux(debug_write_csr, io.debug_write.data, ex.io.csr_write_data)
   csr_regs.io.debug_reg_read_address := io.csr_debug_read_address
   io.csr_debug_read_data             := csr_regs.io.debug_reg_read_data
 
@@ -526,8 +667,10 @@ class PipelinedCPU extends Module {
   // - Count stores when they complete (write_data_accepted)
   // This may undercount branches that don't write registers, but matches typical CPI analysis.
   val wb_instruction_valid = mem2wb.io.output_regs_write_enable
-  val store_completed      = mem.io.bus.write && mem.io.bus.write_valid // Store completes
+  val tcm_store            = tcm.map(_.io.cpu.write).getOrElse(false.B)
+  val store_completed      = (mem.io.bus.write && mem.io.bus.write_valid) || tcm_store // Store completes
   csr_regs.io.instruction_retired := (wb_instruction_valid || store_completed) && !mem_stall
+  csr_regs.io.slot_b_retired      := false.B // Dual issue: see below
 
   // Branch misprediction: BTB, RAS, or IndirectBTB predicted wrong
   // Gate with !mem_stall to ensure single-cycle pulse.
@@ -598,17 +741,201 @@ class PipelinedCPU extends Module {
   // Pulse semantics: Single-cycle event per prediction (branch_hazard and mem_stall gating).
   csr_regs.io.btb_predicted := btb_predicted && is_branch_or_jump && !id.io.branch_hazard && !mem_stall
 
+  // Retire trace: MEM2WB holds an entry for as long as mem_stall is set, and
+  // the entry leaves WB in the first cycle without it.
+  io.retire.valid       := mem2wb.io.output_trace_valid && !mem_stall
+  io.retire.pc          := mem2wb.io.output_instruction_address
+  io.retire.instruction := mem2wb.io.output_instruction
+  io.retire.rd_write    := mem2wb.io.output_regs_write_enable
+  io.retire.rd          := mem2wb.io.output_regs_write_address
+  io.retire.rd_data     := wb.io.regs_write_data
+  io.retire.mem_address := mem2wb.io.output_alu_result
+  io.retire_b           := 0.U.asTypeOf(new RetireBundle) // Dual issue: see below
+
+  // Conditional branches (mhpmcounter10) and PHT direction mispredictions
+  // (mhpmcounter11): the gshare accuracy is 1 - mhpmcounter11 / mhpmcounter10.
+  // The PHT is counted whether or not the BTB supplied a target.
+  csr_regs.io.cond_branch_resolved := cond_branch_resolved
+  csr_regs.io.pht_mispredict       := cond_branch_resolved && (if2id.io.output_pht_predicted_taken =/= actual_taken)
+
+  // Instruction cache hits (mhpmcounter12) count fetches IF accepts, misses
+  // (mhpmcounter13) count line refills, wrong-path ones included
+  val fetch_accepted = !(ctrl.io.pc_stall || mem_stall)
+  csr_regs.io.icache_hit  := icache.map(_.io.valid && fetch_accepted).getOrElse(false.B)
+  csr_regs.io.icache_miss := icache.map(_.io.refill_started).getOrElse(false.B)
+
+  // Data cache hits, misses and dirty line write-backs (mhpmcounter14-16)
+  csr_regs.io.dcache_hit       := dcache.map(_.io.hit).getOrElse(false.B)
+  csr_regs.io.dcache_miss      := dcache.map(_.io.miss).getOrElse(false.B)
+  csr_regs.io.dcache_writeback := dcache.map(_.io.writeback).getOrElse(false.B)
+
+  // Store buffer full stalls, loads and FENCEs waiting for stores to drain, and
+  // loads answered from the buffer (mhpmcounter17-19)
+  csr_regs.io.store_buffer_full := store_buffer.map(_.io.full_stall).getOrElse(false.B)
+  csr_regs.io.store_drain_stall := store_buffer.map(_.io.drain_stall).getOrElse(false.B) || fence_stall
+  csr_regs.io.store_forwarded   := store_buffer.map(_.io.forwarded).getOrElse(false.B)
+
+  // Divider latency: cycles EX waits for DIV/REM (mhpmcounter20) and divisions
+  // done (mhpmcounter21); the average latency is hpm20 / hpm21
+  csr_regs.io.divider_busy := ex.io.div_busy
+  csr_regs.io.divider_done := ex.io.div_valid
+
+  // Return (mhpmcounter22) and other indirect jump (mhpmcounter23)
+  // mispredictions: JALRs fetch did not follow to their target, whether the
+  // RAS/IndirectBTB predicted a wrong target or had no prediction
+  csr_regs.io.ras_mispredict      := jalr_resolved && is_return && !prediction_correct
+  csr_regs.io.indirect_mispredict := jalr_resolved && is_indirect_jalr && !prediction_correct
+
+  // ============ Dual Issue: slot B ============
+  // An ALU-only pipe beside slot A. IF decides the pairing; slot B's pipeline
+  // registers take slot A's stall and flush, so the two move as one. Slot B
+  // has no memory access, so its MEM stage only carries the ALU result on.
+  if (dualIssue) {
+    val if2id_b    = Module(new PipelineRegister(defaultValue = InstructionsNop.nop))
+    val id_b       = Module(new InstructionDecode)
+    val id2ex_b    = Module(new ID2EX)
+    val alu_ctrl_b = Module(new ALUControl)
+    val alu_b      = Module(new ALU)
+    val ex2mem_b   = Module(new EX2MEM)
+    val mem2wb_b   = Module(new MEM2WB)
+    val slot       = forwarding.io.slot_b.get
+
+    forward_from_mem_b := ex2mem_b.io.output_alu_result
+    forward_from_wb_b  := mem2wb_b.io.output_alu_result
+
+    if2id_b.io.stall := if2id.io.stall
+    if2id_b.io.flush := if2id.io.flush
+    if2id_b.io.in    := Mux(inst_fetch.io.pair, inst_fetch.io.rom_instruction_next.bits, InstructionsNop.nop)
+
+    // ID: decode and register read (branch outputs unused; slot B never jumps)
+    val id_address_b = if2id.io.output_instruction_address + 4.U
+    id_b.io.instruction               := if2id_b.io.out
+    id_b.io.instruction_address       := id_address_b
+    id_b.io.reg1_data                 := regs.io.read_data3.get
+    id_b.io.reg2_data                 := regs.io.read_data4.get
+    id_b.io.forward_from_mem          := mem.io.forward_to_ex
+    id_b.io.forward_from_wb           := wb.io.regs_write_data
+    id_b.io.forward_from_mem_b        := forward_from_mem_b
+    id_b.io.forward_from_wb_b         := forward_from_wb_b
+    id_b.io.reg1_forward              := slot.reg1_forward_id
+    id_b.io.reg2_forward              := slot.reg2_forward_id
+    id_b.io.interrupt_assert          := false.B
+    id_b.io.interrupt_handler_address := 0.U
+    id_b.io.branch_hazard             := false.B
+    regs.io.read_address3.get         := id_b.io.regs_reg1_read_address
+    regs.io.read_address4.get         := id_b.io.regs_reg2_read_address
+    ctrl.io.rs1_id_b.get              := id_b.io.regs_reg1_read_address
+    ctrl.io.rs2_id_b.get              := id_b.io.regs_reg2_read_address
+
+    id2ex_b.io.stall                  := id2ex.io.stall
+    id2ex_b.io.flush                  := id2ex.io.flush
+    id2ex_b.io.instruction            := if2id_b.io.out
+    id2ex_b.io.instruction_address    := id_address_b
+    id2ex_b.io.reg1_data              := forwarded(slot.reg1_forward_id, regs.io.read_data3.get)
+    id2ex_b.io.reg2_data              := forwarded(slot.reg2_forward_id, regs.io.read_data4.get)
+    id2ex_b.io.regs_reg1_read_address := id_b.io.regs_reg1_read_address
+    id2ex_b.io.regs_reg2_read_address := id_b.io.regs_reg2_read_address
+    id2ex_b.io.regs_write_enable      := id_b.io.ex_reg_write_enable
+    id2ex_b.io.regs_write_address     := id_b.io.ex_reg_write_address
+    id2ex_b.io.regs_write_source      := id_b.io.ex_reg_write_source
+    id2ex_b.io.immediate              := id_b.io.ex_immediate
+    id2ex_b.io.aluop1_source          := id_b.io.ex_aluop1_source
+    id2ex_b.io.aluop2_source          := id_b.io.ex_aluop2_source
+    id2ex_b.io.csr_write_enable       := false.B
+    id2ex_b.io.csr_address            := 0.U
+    id2ex_b.io.memory_read_enable     := false.B
+    id2ex_b.io.memory_write_enable    := false.B
+    id2ex_b.io.csr_read_data          := 0.U
+    ctrl.io.rd_ex_b.get               := id2ex_b.io.output_regs_write_address
+
+    // EX: the ALU alone, operands forwarded as in Execute
+    val ex_instruction_b = id2ex_b.io.output_instruction
+    alu_ctrl_b.io.opcode := ex_instruction_b(6, 0)
+    alu_ctrl_b.io.funct3 := ex_instruction_b(14, 12)
+    alu_ctrl_b.io.funct7 := ex_instruction_b(31, 25)
+    alu_ctrl_b.io.rs2    := ex_instruction_b(24, 20)
+    alu_b.io.func        := alu_ctrl_b.io.alu_funct
+    alu_b.io.op1 := Mux(
+      id2ex_b.io.output_aluop1_source === ALUOp1Source.InstructionAddress,
+      id2ex_b.io.output_instruction_address,
+      forwarded(slot.reg1_forward_ex, id2ex_b.io.output_reg1_data)
+    )
+    alu_b.io.op2 := Mux(
+      id2ex_b.io.output_aluop2_source === ALUOp2Source.Immediate,
+      id2ex_b.io.output_immediate,
+      forwarded(slot.reg2_forward_ex, id2ex_b.io.output_reg2_data)
+    )
+    alu_b.io.mul_result := 0.U
+    alu_b.io.div_result := 0.U
+
+    ex2mem_b.io.stall               := ex2mem.io.stall
+    ex2mem_b.io.regs_write_enable   := id2ex_b.io.output_regs_write_enable
+    ex2mem_b.io.regs_write_source   := id2ex_b.io.output_regs_write_source
+    ex2mem_b.io.regs_write_address  := id2ex_b.io.output_regs_write_address
+    ex2mem_b.io.instruction_address := id2ex_b.io.output_instruction_address
+    ex2mem_b.io.instruction         := ex_instruction_b
+    ex2mem_b.io.funct3              := ex_instruction_b(14, 12)
+    ex2mem_b.io.reg2_data           := 0.U
+    ex2mem_b.io.memory_read_enable  := false.B
+    ex2mem_b.io.memory_write_enable := false.B
+    ex2mem_b.io.alu_result          := alu_b.io.result
+    ex2mem_b.io.csr_read_data       := 0.U
+
+    mem2wb_b.io.stall               := mem2wb.io.stall
+    mem2wb_b.io.instruction_address := ex2mem_b.io.output_instruction_address
+    mem2wb_b.io.instruction         := ex2mem_b.io.output_instruction
+    mem2wb_b.io.trace_valid         := ex2mem_fresh && ex2mem_b.io.output_instruction =/= InstructionsNop.nop
+    mem2wb_b.io.alu_result          := ex2mem_b.io.output_alu_result
+    mem2wb_b.io.regs_write_enable   := ex2mem_b.io.output_regs_write_enable
+    mem2wb_b.io.regs_write_source   := ex2mem_b.io.output_regs_write_source
+    mem2wb_b.io.regs_write_address  := ex2mem_b.io.output_regs_write_address
+    mem2wb_b.io.memory_read_data    := 0.U
+    mem2wb_b.io.csr_read_data       := 0.U
+
+    // WB: the second register file write port
+    regs.io.write_enable_b.get  := mem2wb_b.io.output_regs_write_enable
+    regs.io.write_address_b.get := mem2wb_b.io.output_regs_write_address
+    regs.io.write_data_b.get    := mem2wb_b.io.output_alu_result
+
+    slot.rs1_id               := id_b.io.regs_reg1_read_address
+    slot.rs2_id               := id_b.io.regs_reg2_read_address
+    slot.rs1_ex               := id2ex_b.io.output_regs_reg1_read_address
+    slot.rs2_ex               := id2ex_b.io.output_regs_reg2_read_address
+    slot.rd_mem               := ex2mem_b.io.output_regs_write_address
+    slot.reg_write_enable_mem := ex2mem_b.io.output_regs_write_enable
+    slot.rd_wb                := mem2wb_b.io.output_regs_write_address
+    slot.reg_write_enable_wb  := mem2wb_b.io.output_regs_write_enable
+
+    // Retires with slot A (the pair leaves WB together) and counts in minstret
+    val retire_b = mem2wb_b.io.output_trace_valid && !mem_stall
+    csr_regs.io.slot_b_retired := retire_b
+    io.retire_b.valid          := retire_b
+    io.retire_b.pc             := mem2wb_b.io.output_instruction_address
+    io.retire_b.instruction    := mem2wb_b.io.output_instruction
+    io.retire_b.rd_write       := mem2wb_b.io.output_regs_write_enable
+    io.retire_b.rd             := mem2wb_b.io.output_regs_write_address
+    io.retire_b.rd_data        := mem2wb_b.io.output_alu_result
+    io.retire_b.mem_address    := mem2wb_b.io.output_alu_result
+  }
+
   // Initialize unused CPUBundle signals (used by wrapper, not by pipeline core)
   io.bus_address                                 := 0.U
   io.axi4_channels.read_address_channel.ARADDR   := 0.U
   io.axi4_channels.read_address_channel.ARPROT   := 0.U
+  io.axi4_channels.read_address_channel.ARLEN    := 0.U
+  io.axi4_channels.read_address_channel.ARSIZE   := 0.U
+  io.axi4_channels.read_address_channel.ARBURST  := 0.U
   io.axi4_channels.read_address_channel.ARVALID  := false.B
   io.axi4_channels.read_data_channel.RREADY      := false.B
   io.axi4_channels.write_address_channel.AWADDR  := 0.U
   io.axi4_channels.write_address_channel.AWPROT  := 0.U
+  io.axi4_channels.write_address_channel.AWLEN   := 0.U
+  io.axi4_channels.write_address_channel.AWSIZE  := 0.U
+  io.axi4_channels.write_address_channel.AWBURST := 0.U
   io.axi4_channels.write_address_channel.AWVALID := false.B
   io.axi4_channels.write_data_channel.WDATA      := 0.U
   io.axi4_channels.write_data_channel.WSTRB      := 0.U
+  io.axi4_channels.write_data_channel.WLAST      := false.B
   io.axi4_channels.write_data_channel.WVALID     := false.B
   io.axi4_channels.write_response_channel.BREADY := false.B
   io.debug_bus_write_enable                      := false.B
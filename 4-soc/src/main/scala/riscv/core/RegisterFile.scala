@@ -18,7 +18,9 @@ object Registers extends Enumeration {
 // x0 is architecturally constant zero per RISC-V spec
 // Only 31 physical registers allocated (x1-x31), saving 3% resources
 // Write forwarding allows reading currently-being-written value (pipeline optimization)
-class RegisterFile extends Module {
+// dualIssue adds a second write port and two more read ports (4R2W) for
+// issue slot B; slot B is the younger instruction, so its write wins
+class RegisterFile(dualIssue: Boolean = false) extends Module {
   val io = IO(new Bundle {
     val write_enable  = Input(Bool())
     val write_address = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
@@ -29,6 +31,15 @@ class RegisterFile extends Module {
     val read_data1    = Output(UInt(Parameters.DataWidth))
     val read_data2    = Output(UInt(Parameters.DataWidth))
 
+    // Dual issue: slot B's write port and its two read ports
+    val write_enable_b  = if (dualIssue) Some(Input(Bool())) else None
+    val write_address_b = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
+    val write_data_b    = if (dualIssue) Some(Input(UInt(Parameters.DataWidth))) else None
+    val read_address3   = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
+    val read_address4   = if (dualIssue) Some(Input(UInt(Parameters.PhysicalRegisterAddrWidth))) else None
+    val read_data3      = if (dualIssue) Some(Output(UInt(Parameters.DataWidth))) else None
+    val read_data4      = if (dualIssue) Some(Output(UInt(Parameters.DataWidth))) else None
+
     val debug_read_address = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
     val debug_read_data    = Output(UInt(Parameters.DataWidth))
   })
@@ -36,44 +47,33 @@ class RegisterFile extends Module {
   // This saves 3% of register file resources (992 vs 1024 flip-flops)
   val registers = Reg(Vec(Parameters.PhysicalRegisters - 1, UInt(Parameters.DataWidth)))
 
+  // Write ports in priority order (the last one listed wins)
+  val writes = Seq((io.write_enable, io.write_address, io.write_data)) ++
+    (if (dualIssue) Seq((io.write_enable_b.get, io.write_address_b.get, io.write_data_b.get)) else Nil)
+
   when(!reset.asBool) {
-    when(io.write_enable && io.write_address =/= 0.U) {
-      // Map x1-x31 to indices 0-30 in physical storage
-      registers(io.write_address - 1.U) := io.write_data
+    for ((enable, address, data) <- writes) {
+      when(enable && address =/= 0.U) {
+        // Map x1-x31 to indices 0-30 in physical storage
+        registers(address - 1.U) := data
+      }
     }
   }
 
   // Read ports with x0 hardwired to zero and write forwarding for pipeline optimization
   // Timing optimization: nested Mux guards x0 first to avoid subtract on critical path
   // Priority: x0 check (fastest) → write forwarding → register read (with address mapping)
-  io.read_data1 := Mux(
-    io.read_address1 === 0.U,
-    0.U, // x0 always zero - fastest path
-    Mux(
-      io.write_enable && io.write_address === io.read_address1,
-      io.write_data,                    // Forward write data
-      registers(io.read_address1 - 1.U) // Physical storage (mapped)
-    )
-  )
-
-  io.read_data2 := Mux(
-    io.read_address2 === 0.U,
+  def read(address: UInt): UInt = Mux(
+    address === 0.U,
     0.U, // x0 always zero - fastest path
-    Mux(
-      io.write_enable && io.write_address === io.read_address2,
-      io.write_data,                    // Forward write data
-      registers(io.read_address2 - 1.U) // Physical storage (mapped)
-    )
-  )
-
-  io.debug_read_data := Mux(
-    io.debug_read_address === 0.U,
-    0.U, // x0 always zero - fastest path
-    Mux(
-      io.write_enable && io.write_address === io.debug_read_address,
-      io.write_data,                         // Forward write data
-      registers(io.debug_read_address - 1.U) // Physical storage (mapped)
-    )
+    writes.foldLeft(registers(address - 1.U)) { case (value, (enable, write_address, data)) =>
+      Mux(enable && write_address === address, data, value) // Forward write data
+    }
   )
 
+  io.read_data1      := read(io.read_address1)
+  io.read_data2      := read(io.read_address2)
+  io.debug_read_data := read(io.debug_read_address)
+  io.read_data3.foreach(_ := read(io.read_address3.get))
+  io.read_data4.foreach(_ := read(io.read_address4.get))
 }
@@ -22,25 +22,46 @@ import riscv.Parameters
  * - Note: Co-routine pattern (JAL rd=x5) also supported
  *
  * Architecture:
- * - 4-entry circular stack (configurable)
+ * - depth-entry circular buffer with a top-of-stack pointer and an entry count
  * - Push on CALL, Pop on RETURN
- * - Stack pointer wraps on overflow/underflow (graceful degradation)
+ * - Overflow: the pointer wraps and the push overwrites the oldest entry, so
+ *   the innermost depth returns of a deeper call chain still predict
+ * - Underflow: the count saturates at 0 and the prediction is invalid
  * - Combinational pop for same-cycle prediction
  *
+ * Checkpoint and Restore:
+ * - Returns pop in IF, calls push in ID. The one instruction IF fetches
+ *   behind a mispredicted branch may be a return whose pop has to be undone.
+ * - checkpoint is the (pointer, count) pair after this cycle's push and pop.
+ *   It travels with the fetched instruction through IF2ID.
+ * - When ID flushes IF2ID, restore rolls the pointer and count back to the
+ *   checkpoint of the instruction in ID, dropping the wrong-path pop. A push
+ *   from that instruction (a call) is applied on top of the restored state.
+ * - Pops never write an entry and only correct-path instructions reach ID to
+ *   push, so the pointer and count alone restore the stack exactly.
+ *
+ * Push and Pop in the Same Cycle:
+ * - The pushing call in ID is older than the popping return in IF, so the
+ *   return is predicted to the address being pushed and the stack is left
+ *   as it was (a call to a function that returns at once).
+ *
  * Integration Points:
  * - IF stage: Provides predicted return address when JALR rs1=ra detected
- * - ID stage: Push on JAL rd=ra, correction on misprediction
+ * - ID stage: Push on JAL rd=ra, restore on IF2ID flush
  *
  * Performance Impact:
  * - High accuracy for regular call/return patterns (~90%+ in typical code)
  * - Reduces JALR return misprediction penalty from 1-2 cycles to 0 cycles
- * - Minimal area overhead (4 x 32-bit registers + control logic)
+ * - Small area overhead (depth x 32-bit registers + control logic)
  *
- * @param depth Number of RAS entries (typically 4-8)
+ * @param depth Number of RAS entries (power of 2, typically 4-16)
  */
-class ReturnAddressStack(depth: Int = 4) extends Module {
+class ReturnAddressStack(depth: Int = 8) extends Module {
   require(depth >= 2 && isPow2(depth), "RAS depth must be power of 2 and >= 2")
 
+  val pointerBits = log2Ceil(depth)
+  val countBits   = log2Ceil(depth + 1)
+
   val io = IO(new Bundle {
     // Push interface (from ID stage on JAL rd=ra)
     val push      = Input(Bool())
@@ -53,53 +74,51 @@ class ReturnAddressStack(depth: Int = 4) extends Module {
     val predicted_addr = Output(UInt(Parameters.AddrWidth))
     val valid          = Output(Bool())
 
-    // Correction interface (from ID stage on misprediction)
-    // Allows restoring RAS state after speculative pops
+    // Stack state after this cycle's push/pop, carried with the fetched instruction
+    val checkpoint = Output(UInt(ReturnAddressStack.checkpointBits(depth).W))
+
+    // Rollback to the checkpoint of the instruction in ID (on IF2ID flush)
     val restore       = Input(Bool())
-    val restore_addr  = Input(UInt(Parameters.AddrWidth))
-    val restore_valid = Input(Bool())
+    val restore_point = Input(UInt(ReturnAddressStack.checkpointBits(depth).W))
   })
 
-  // Stack storage and pointer
+  // Stack storage, index of the top entry and number of valid entries
   val stack = Reg(Vec(depth, UInt(Parameters.AddrWidth)))
-  val sp    = RegInit(0.U(log2Ceil(depth + 1).W)) // 0 = empty, depth = full
-
-  // Calculate top of stack index (sp - 1, with wrap)
-  val tos_index = (sp - 1.U)(log2Ceil(depth) - 1, 0)
-
-  // Combinational prediction (available same cycle as pop request)
-  io.valid          := sp > 0.U
-  io.predicted_addr := Mux(io.valid, stack(tos_index), 0.U)
-
-  // Stack operations (priority: restore > push > pop)
-  when(io.restore) {
-    // Restore after misprediction - push the correct return address back
-    when(io.restore_valid && sp < depth.U) {
-      stack(sp(log2Ceil(depth) - 1, 0)) := io.restore_addr
-      sp                                := sp + 1.U
-    }
-  }.elsewhen(io.push && io.pop) {
-    // Simultaneous push and pop (rare but possible with tail calls)
-    // Replace TOS with new address, sp unchanged
-    stack(tos_index) := io.push_addr
-  }.elsewhen(io.push) {
-    // Push: store at sp, increment (with saturation at depth)
-    when(sp < depth.U) {
-      stack(sp(log2Ceil(depth) - 1, 0)) := io.push_addr
-      sp                                := sp + 1.U
-    }.otherwise {
-      // Overflow: shift stack down, push at top (oldest entry lost)
-      for (i <- 0 until depth - 1) {
-        stack(i) := stack(i + 1)
-      }
-      stack(depth - 1) := io.push_addr
-      // sp stays at depth
-    }
-  }.elsewhen(io.pop) {
-    // Pop: decrement sp (with saturation at 0)
-    when(sp > 0.U) {
-      sp := sp - 1.U
-    }
-    // Underflow: sp stays at 0, prediction invalid
+  val tos   = RegInit(0.U(pointerBits.W))
+  val count = RegInit(0.U(countBits.W)) // 0 = empty, depth = full
+
+  // Combinational prediction (available same cycle as pop request), with
+  // the address pushed by the older call in ID forwarded to the return
+  io.valid          := count =/= 0.U || io.push
+  io.predicted_addr := Mux(io.push, io.push_addr, Mux(count =/= 0.U, stack(tos), 0.U))
+
+  // A pop fetched on the path being flushed never happens
+  val pop        = io.pop && !io.restore
+  val base_tos   = Mux(io.restore, io.restore_point(pointerBits - 1, 0), tos)
+  val base_count = Mux(io.restore, io.restore_point(pointerBits + countBits - 1, pointerBits), count)
+
+  val next_tos   = WireDefault(base_tos)
+  val next_count = WireDefault(base_count)
+
+  when(io.push && !pop) {
+    // Push: advance the pointer, overwriting the oldest entry when full
+    val slot = base_tos + 1.U
+    stack(slot) := io.push_addr
+    next_tos    := slot
+    next_count  := Mux(base_count === depth.U, base_count, base_count + 1.U)
+  }.elsewhen(pop && !io.push && count =/= 0.U) {
+    next_tos   := tos - 1.U
+    next_count := count - 1.U
   }
+  // Push and pop together cancel out; a pop on an empty stack does nothing
+
+  tos   := next_tos
+  count := next_count
+
+  io.checkpoint := Cat(next_count, next_tos)
+}
+
+object ReturnAddressStack {
+  // Width of a checkpoint: the top-of-stack pointer and the entry count
+  def checkpointBits(depth: Int): Int = log2Ceil(depth) + log2Ceil(depth + 1)
 }
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv.core
+
+import chisel3._
+import chisel3.util._
+import riscv.Parameters
+
+/**
+ * Store Buffer: posts stores between MemoryAccess and the data cache (or the
+ * bus without one)
+ *
+ * Purpose:
+ * - A store completes in its MEM cycle (granted and write_valid together)
+ *   instead of holding the pipeline until the write response returns
+ * - The buffered stores drain in the background, one transaction at a time
+ *   from the oldest, whenever no load needs the port
+ *
+ * Architecture:
+ * - entries entries of word address, data and byte strobes, as a circular
+ *   FIFO (head = oldest)
+ * - A cached store (main memory above its first page, Parameters.cacheable)
+ *   to the word of the youngest entry merges into it, unless that entry is
+ *   the head, which may be draining
+ *
+ * Operation:
+ * - Store: takes a new entry (or merges), stalling only while the buffer is
+ *   full
+ * - Cached load: the youngest entry for its word answers it in the same cycle
+ *   if it holds all four bytes; with fewer bytes the load waits until that
+ *   entry has drained. Loads to other words go ahead of the buffered stores
+ * - MMIO and the first page: stores are buffered in program order and never
+ *   merged; a load waits until the buffer is empty, so it sees every earlier
+ *   MMIO store. Cached loads may pass buffered MMIO stores; a FENCE waits in
+ *   MEM until empty is set, which orders them
+ *
+ * full_stall and drain_stall are set in every cycle a store waits for an
+ * entry or a load waits for stores to drain; forwarded pulses for each load
+ * answered from the buffer.
+ *
+ * @param entries Buffered stores (power of 2, at least 2)
+ */
+class StoreBuffer(entries: Int = Parameters.StoreBufferEntries) extends Module {
+  require(isPow2(entries) && entries >= 2, "Store buffer needs a power of 2 entries, at least 2")
+  val ptrBits  = log2Ceil(entries)
+  val wordBits = Parameters.AddrBits - 2
+
+  val io = IO(new Bundle {
+    // MemoryAccess side
+    val cpu = Flipped(new BusBundle)
+    // Data cache side (or the bus without one)
+    val bus = new BusBundle
+
+    val empty = Output(Bool()) // No store left to drain
+
+    val full_stall  = Output(Bool()) // Store waits for a free entry
+    val drain_stall = Output(Bool()) // Load waits for buffered stores
+    val forwarded   = Output(Bool()) // Load answered from the buffer
+  })
+
+  object State extends ChiselEnum {
+    val sIdle, sLoad, sDrain = Value
+  }
+  val state = RegInit(State.sIdle)
+
+  val words   = Reg(Vec(entries, UInt(wordBits.W)))
+  val data    = Reg(Vec(entries, UInt(Parameters.DataWidth)))
+  val strobes = Reg(Vec(entries, UInt(Parameters.WordSize.W)))
+  val head    = RegInit(0.U(ptrBits.W))
+  val count   = RegInit(0.U(log2Ceil(entries + 1).W))
+
+  // Bytes of value selected by strobe, the others from old
+  def merge(old: UInt, value: UInt, strobe: UInt): UInt =
+    VecInit((0 until Parameters.WordSize).map { i =>
+      Mux(strobe(i), value(8 * i + 7, 8 * i), old(8 * i + 7, 8 * i))
+    }).asUInt
+
+  val word   = io.cpu.address(Parameters.AddrBits - 1, 2)
+  val cached = Parameters.cacheable(io.cpu.address)
+  val strobe = io.cpu.write_strobe.asUInt
+  val tail   = (head + count)(ptrBits - 1, 0)
+  val last   = tail - 1.U
+  val full   = count === entries.U
+
+  // Entries in age order, the head first; the last match is the youngest
+  val slots      = (0 until entries).map(i => head + i.U)
+  val matches    = slots.zipWithIndex.map { case (s, i) => i.U < count && words(s) === word }
+  val matching   = matches.reduce(_ || _)
+  val match_slot = PriorityMux(matches.reverse, slots.reverse)
+  val coalesce   = cached && count > 1.U && words(last) === word
+
+  io.cpu.read_data           := io.bus.read_data
+  io.cpu.read_valid          := false.B
+  io.cpu.write_valid         := false.B
+  io.cpu.write_data_accepted := false.B
+  io.cpu.busy                := io.bus.busy
+  io.cpu.granted             := false.B
+  io.cpu.write_beat          := false.B
+
+  // The head is presented whenever a drain may start
+  io.bus.request      := false.B
+  io.bus.read         := false.B
+  io.bus.write        := false.B
+  io.bus.address      := Cat(words(head), 0.U(2.W))
+  io.bus.write_data   := data(head)
+  io.bus.write_strobe := VecInit(strobes(head).asBools)
+  io.bus.burst_length := 0.U
+
+  io.empty       := count === 0.U
+  io.full_stall  := false.B
+  io.drain_stall := false.B
+  io.forwarded   := false.B
+
+  val push        = WireDefault(false.B)
+  val pop         = WireDefault(false.B)
+  val load_on_bus = WireDefault(false.B)
+
+  when(io.cpu.request && io.cpu.write) {
+    when(coalesce) {
+      io.cpu.granted     := true.B
+      io.cpu.write_valid := true.B
+      data(last)         := merge(data(last), io.cpu.write_data, strobe)
+      strobes(last)      := strobes(last) | strobe
+    }.elsewhen(!full) {
+      io.cpu.granted     := true.B
+      io.cpu.write_valid := true.B
+      push               := true.B
+      words(tail)        := word
+      data(tail)         := io.cpu.write_data
+      strobes(tail)      := strobe
+    }.otherwise {
+      io.full_stall := true.B
+    }
+  }.elsewhen(io.cpu.request && io.cpu.read) {
+    when(cached && matching) {
+      when(strobes(match_slot).andR) {
+        io.cpu.granted    := true.B
+        io.cpu.read_valid := true.B
+        io.cpu.read_data  := data(match_slot)
+        io.forwarded      := true.B
+      }.otherwise {
+        io.drain_stall := true.B
+      }
+    }.elsewhen(!cached && count =/= 0.U) {
+      io.drain_stall := true.B
+    }.elsewhen(state === State.sIdle) {
+      // Straight through, ahead of the drain
+      load_on_bus       := true.B
+      io.bus.request    := true.B
+      io.bus.read       := true.B
+      io.bus.address    := io.cpu.address
+      io.cpu.granted    := io.bus.granted
+      io.cpu.read_valid := io.bus.read_valid
+      when(io.bus.granted && !io.bus.read_valid) {
+        state := State.sLoad
+      }
+    }
+  }
+
+  switch(state) {
+    is(State.sIdle) {
+      when(!load_on_bus && count =/= 0.U) {
+        io.bus.request := true.B
+        io.bus.write   := true.B
+        when(io.bus.granted && io.bus.write_valid) {
+          pop := true.B
+        }.elsewhen(io.bus.granted) {
+          state := State.sDrain
+        }
+      }
+    }
+
+    is(State.sLoad) {
+      io.bus.request    := true.B
+      io.cpu.read_valid := io.bus.read_valid
+      when(io.bus.read_valid) {
+        state := State.sIdle
+      }
+    }
+
+    is(State.sDrain) {
+      io.bus.request := true.B
+      when(io.bus.write_valid) {
+        pop   := true.B
+        state := State.sIdle
+      }
+    }
+  }
+
+  when(pop) {
+    head := head + 1.U
+  }
+  count := count + push.asUInt - pop.asUInt
+}
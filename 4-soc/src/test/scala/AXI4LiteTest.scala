@@ -3,6 +3,7 @@
 // "LICENSE" for information on usage and redistribution of this file.
 
 import bus.AXI4LiteMaster
+import bus.AXI4LiteMasterBundle
 import bus.AXI4LiteSlave
 import chisel3._
 import chiseltest._
@@ -29,6 +30,7 @@ class AXI4LiteTest extends AnyFlatSpec with ChiselScalatestTester {
       master.io.bundle.write        := false.B
       master.io.bundle.write_data   := 0.U
       master.io.bundle.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(false.B))
+      master.io.bundle.burst_length := 0.U
 
       // Slave responds with test data
       slave.io.bundle.read_data  := "hDEADBEEF".U
@@ -66,6 +68,7 @@ class AXI4LiteTest extends AnyFlatSpec with ChiselScalatestTester {
       master.io.bundle.write        := true.B
       master.io.bundle.write_data   := "hCAFEBABE".U
       master.io.bundle.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(true.B))
+      master.io.bundle.burst_length := 0.U
 
       // Slave must drive read signals even for write test
       slave.io.bundle.read_data  := 0.U
@@ -85,4 +88,84 @@ class AXI4LiteTest extends AnyFlatSpec with ChiselScalatestTester {
       assert(dut.io.done.peek().litToBoolean, s"Write transaction did not complete in $cycles cycles")
     }
   }
+
+  // Master and burst slave in front of a 64-word memory that answers reads
+  // one cycle late, like peripheral.Memory
+  class BurstHarness extends Module {
+    val io = IO(new Bundle {
+      val bundle        = new AXI4LiteMasterBundle(Parameters.AddrBits, Parameters.DataBits)
+      val slave_read    = Output(Bool())
+      val slave_write   = Output(Bool())
+      val slave_burst   = Output(Bool())
+      val slave_address = Output(UInt(Parameters.AddrWidth))
+    })
+
+    val master = Module(new AXI4LiteMaster(Parameters.AddrBits, Parameters.DataBits))
+    val slave  = Module(new AXI4LiteSlave(Parameters.AddrBits, Parameters.DataBits, burst = true))
+    master.io.channels <> slave.io.channels
+    master.io.bundle <> io.bundle
+
+    val mem   = Mem(64, UInt(Parameters.DataWidth))
+    val index = slave.io.bundle.address(7, 2)
+    slave.io.bundle.read_data  := RegNext(mem(index))
+    slave.io.bundle.read_valid := RegNext(slave.io.bundle.read, false.B)
+    when(slave.io.bundle.write) {
+      mem(index) := slave.io.bundle.write_data
+    }
+
+    io.slave_read    := slave.io.bundle.read
+    io.slave_write   := slave.io.bundle.write
+    io.slave_burst   := slave.io.bundle.burst
+    io.slave_address := slave.io.bundle.address
+  }
+
+  it should "write and read back a 4-beat INCR burst" in {
+    test(new BurstHarness).withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+      dut.clock.setTimeout(200)
+      val words = Seq(0x11111111L, 0x22222222L, 0x33333333L, 0x44444444L)
+      dut.io.bundle.address.poke(0x20.U)
+      dut.io.bundle.burst_length.poke(3.U)
+      dut.io.bundle.write_strobe.foreach(_.poke(true.B))
+      dut.io.bundle.read.poke(false.B)
+
+      // Write: start, then hold each word until its beat is taken
+      var beat   = 0
+      var writes = Seq.empty[(Long, Boolean)]
+      dut.io.bundle.write.poke(true.B)
+      dut.io.bundle.write_data.poke(words(0).U)
+      dut.clock.step()
+      dut.io.bundle.write.poke(false.B)
+      while (!dut.io.bundle.write_valid.peekBoolean()) {
+        dut.io.bundle.write_data.poke(words(beat.min(3)).U)
+        if (dut.io.slave_write.peekBoolean()) {
+          writes :+= ((dut.io.slave_address.peekInt().toLong, dut.io.slave_burst.peekBoolean()))
+        }
+        if (dut.io.bundle.write_beat.peekBoolean()) beat += 1
+        dut.clock.step()
+      }
+      assert(beat == 4, s"$beat write beats taken")
+      assert(writes == Seq((0x20L, false), (0x24L, true), (0x28L, true), (0x2cL, true)))
+
+      // Read: one address handshake, one read_valid per word in order
+      var data      = Seq.empty[Long]
+      var addresses = Seq.empty[(Long, Boolean)]
+      dut.io.bundle.read.poke(true.B)
+      dut.clock.step()
+      dut.io.bundle.read.poke(false.B)
+      var last = false
+      while (!last) {
+        if (dut.io.bundle.read_valid.peekBoolean()) {
+          data :+= dut.io.bundle.read_data.peekInt().toLong
+          last = !dut.io.bundle.busy.peekBoolean()
+        }
+        if (dut.io.slave_read.peekBoolean()) {
+          val access = (dut.io.slave_address.peekInt().toLong, dut.io.slave_burst.peekBoolean())
+          if (!addresses.lastOption.contains(access)) addresses :+= access
+        }
+        dut.clock.step()
+      }
+      assert(data == words)
+      assert(addresses == Seq((0x20L, false), (0x24L, true), (0x28L, true), (0x2cL, true)))
+    }
+  }
 }
@@ -8,6 +8,7 @@ import chisel3._
 import chiseltest._
 import org.scalatest.flatspec.AnyFlatSpec
 import riscv.core.ALU
+import riscv.core.ALUControl
 import riscv.core.ALUFunctions
 
 class ALUTest extends AnyFlatSpec with ChiselScalatestTester {
@@ -169,4 +170,94 @@ class ALUTest extends AnyFlatSpec with ChiselScalatestTester {
       assert(runALU(dut, ALUFunctions.srl, 0, 31) == 0)
     }
   }
+
+  // ==================== Bit Manipulation (Zba/Zbb/Zbs) ====================
+
+  it should "perform Zba shift-and-add" in {
+    test(new ALU).withAnnotations(TestAnnotations.annos) { dut =>
+      assert(runALU(dut, ALUFunctions.sh1add, 3, 100) == 106)
+      assert(runALU(dut, ALUFunctions.sh2add, 3, 100) == 112)
+      assert(runALU(dut, ALUFunctions.sh3add, 3, 100) == 124)
+      assert(runALU(dut, ALUFunctions.sh3add, 0x20000001L, 0) == 8) // Shifted-out bits dropped
+    }
+  }
+
+  it should "perform Zbb logic, counts and min/max" in {
+    test(new ALU).withAnnotations(TestAnnotations.annos) { dut =>
+      assert(runALU(dut, ALUFunctions.andn, 0xff00ff00L, 0x0f0f0f0fL) == 0xf000f000L)
+      assert(runALU(dut, ALUFunctions.orn, 0, 0xffff0000L) == 0x0000ffffL)
+      assert(runALU(dut, ALUFunctions.xnor, 0xaaaaaaaaL, 0x55555555L) == 0)
+      assert(runALU(dut, ALUFunctions.clz, 0, 0) == 32)
+      assert(runALU(dut, ALUFunctions.clz, 1, 0) == 31)
+      assert(runALU(dut, ALUFunctions.clz, 0x80000000L, 0) == 0)
+      assert(runALU(dut, ALUFunctions.ctz, 0, 0) == 32)
+      assert(runALU(dut, ALUFunctions.ctz, 0x80000000L, 0) == 31)
+      assert(runALU(dut, ALUFunctions.ctz, 0x10, 0) == 4)
+      assert(runALU(dut, ALUFunctions.cpop, 0xf0f0, 0) == 8)
+      assert(runALU(dut, ALUFunctions.cpop, 0xffffffffL, 0) == 32)
+      assert(runALU(dut, ALUFunctions.min, 0xffffffffL, 1) == 0xffffffffL)
+      assert(runALU(dut, ALUFunctions.minu, 0xffffffffL, 1) == 1)
+      assert(runALU(dut, ALUFunctions.max, 0xffffffffL, 1) == 1)
+      assert(runALU(dut, ALUFunctions.maxu, 0xffffffffL, 1) == 0xffffffffL)
+    }
+  }
+
+  it should "perform Zbb extension, rotates and byte operations" in {
+    test(new ALU).withAnnotations(TestAnnotations.annos) { dut =>
+      assert(runALU(dut, ALUFunctions.sextb, 0x80, 0) == 0xffffff80L)
+      assert(runALU(dut, ALUFunctions.sextb, 0x17f, 0) == 0x7f)
+      assert(runALU(dut, ALUFunctions.sexth, 0x8000, 0) == 0xffff8000L)
+      assert(runALU(dut, ALUFunctions.zexth, 0xffff1234L, 0) == 0x1234)
+      assert(runALU(dut, ALUFunctions.rol, 0x80000001L, 1) == 3)
+      assert(runALU(dut, ALUFunctions.rol, 0x12345678L, 0) == 0x12345678L)
+      assert(runALU(dut, ALUFunctions.ror, 1, 1) == 0x80000000L)
+      assert(runALU(dut, ALUFunctions.ror, 0x12345678L, 8) == 0x78123456L)
+      assert(runALU(dut, ALUFunctions.ror, 0x12345678L, 32) == 0x12345678L) // 32 & 0x1F = 0
+      assert(runALU(dut, ALUFunctions.orcb, 0x00120300L, 0) == 0x00ffff00L)
+      assert(runALU(dut, ALUFunctions.rev8, 0x12345678L, 0) == 0x78563412L)
+    }
+  }
+
+  it should "perform Zbs single-bit operations" in {
+    test(new ALU).withAnnotations(TestAnnotations.annos) { dut =>
+      assert(runALU(dut, ALUFunctions.bset, 0, 31) == 0x80000000L)
+      assert(runALU(dut, ALUFunctions.bclr, 0xffffffffL, 0) == 0xfffffffeL)
+      assert(runALU(dut, ALUFunctions.binv, 0x10, 4) == 0)
+      assert(runALU(dut, ALUFunctions.bext, 0x10, 4) == 1)
+      assert(runALU(dut, ALUFunctions.bext, 0x10, 36) == 1) // 36 & 0x1F = 4
+      assert(runALU(dut, ALUFunctions.bext, 0x10, 3) == 0)
+    }
+  }
+
+  it should "decode bit manipulation encodings without disturbing the base ones" in {
+    test(new ALUControl).withAnnotations(TestAnnotations.annos) { dut =>
+      def decode(opcode: Int, funct3: Int, funct7: Int, rs2: Int = 0)(func: ALUFunctions.Type): Unit = {
+        dut.io.opcode.poke(opcode.U)
+        dut.io.funct3.poke(funct3.U)
+        dut.io.funct7.poke(funct7.U)
+        dut.io.rs2.poke(rs2.U)
+        dut.io.alu_funct.expect(func, f"opcode 0x$opcode%02x funct3 $funct3 funct7 0x$funct7%02x rs2 $rs2")
+      }
+      val OP     = 0x33
+      val OP_IMM = 0x13
+      decode(OP, 2, 0x10)(ALUFunctions.sh1add)
+      decode(OP, 7, 0x20)(ALUFunctions.andn)
+      decode(OP, 0, 0x20)(ALUFunctions.sub)
+      decode(OP, 5, 0x20)(ALUFunctions.sra)
+      decode(OP, 0, 0x01)(ALUFunctions.mul)
+      decode(OP, 6, 0x05)(ALUFunctions.max)
+      decode(OP, 4, 0x04)(ALUFunctions.zexth)
+      decode(OP, 1, 0x30)(ALUFunctions.rol)
+      decode(OP, 5, 0x24)(ALUFunctions.bext)
+      decode(OP_IMM, 1, 0x30, rs2 = 2)(ALUFunctions.cpop)
+      decode(OP_IMM, 1, 0x30, rs2 = 5)(ALUFunctions.sexth)
+      decode(OP_IMM, 5, 0x30, rs2 = 7)(ALUFunctions.ror)
+      decode(OP_IMM, 5, 0x34, rs2 = 24)(ALUFunctions.rev8)
+      decode(OP_IMM, 5, 0x14, rs2 = 7)(ALUFunctions.orcb)
+      decode(OP_IMM, 1, 0x14, rs2 = 9)(ALUFunctions.bset)
+      decode(OP_IMM, 1, 0x00, rs2 = 9)(ALUFunctions.sll)
+      decode(OP_IMM, 5, 0x20, rs2 = 3)(ALUFunctions.sra)
+      decode(OP_IMM, 5, 0x00, rs2 = 3)(ALUFunctions.srl)
+    }
+  }
 }
@@ -48,6 +48,7 @@ class AXI4WritePathTest extends AnyFlatSpec with ChiselScalatestTester {
         master.io.bundle.read         := false.B
         master.io.bundle.write_data   := "hDEADBEEF".U
         master.io.bundle.write_strobe := VecInit(Seq.fill(4)(true.B))
+        master.io.bundle.burst_length := 0.U
 
         when(master.io.bundle.write_valid) {
           write_complete := true.B
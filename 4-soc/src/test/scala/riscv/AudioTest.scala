@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import peripheral.AudioPeripheral
+
+class AudioTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Audio Peripheral")
+
+  val REG_STATUS    = 0x04
+  val REG_DATA      = 0x08
+  val REG_LEVEL     = 0x0c
+  val REG_WATERMARK = 0x10
+  val REG_CTRL      = 0x14
+  val REG_UNDERRUN  = 0x18
+
+  /** Helper: Perform AXI4-Lite write */
+  def axiWrite(dut: AudioPeripheral, addr: Int, data: Int): Unit = {
+    dut.io.channels.write_address_channel.AWVALID.poke(true.B)
+    dut.io.channels.write_address_channel.AWADDR.poke(addr.U)
+    dut.io.channels.write_address_channel.AWPROT.poke(0.U)
+    dut.io.channels.write_data_channel.WVALID.poke(true.B)
+    dut.io.channels.write_data_channel.WDATA.poke(data.U)
+    dut.io.channels.write_data_channel.WSTRB.poke(0xf.U)
+    dut.io.channels.write_response_channel.BREADY.poke(true.B)
+    var cycles = 0
+    while (!dut.io.channels.write_response_channel.BVALID.peekBoolean() && cycles < 20) {
+      dut.clock.step()
+      cycles += 1
+    }
+    dut.clock.step()
+    dut.io.channels.write_address_channel.AWVALID.poke(false.B)
+    dut.io.channels.write_data_channel.WVALID.poke(false.B)
+    dut.io.channels.write_response_channel.BREADY.poke(false.B)
+  }
+
+  /** Helper: Perform AXI4-Lite read */
+  def axiRead(dut: AudioPeripheral, addr: Int): BigInt = {
+    dut.io.channels.read_address_channel.ARVALID.poke(true.B)
+    dut.io.channels.read_address_channel.ARADDR.poke(addr.U)
+    dut.io.channels.read_address_channel.ARPROT.poke(0.U)
+    dut.io.channels.read_data_channel.RREADY.poke(true.B)
+    var cycles = 0
+    while (!dut.io.channels.read_data_channel.RVALID.peekBoolean() && cycles < 20) {
+      dut.clock.step()
+      cycles += 1
+    }
+    val data = dut.io.channels.read_data_channel.RDATA.peekInt()
+    dut.clock.step()
+    dut.io.channels.read_address_channel.ARVALID.poke(false.B)
+    dut.io.channels.read_data_channel.RREADY.poke(false.B)
+    dut.clock.step()
+    data
+  }
+
+  it should "report the level and interrupt while at or below the watermark" in {
+    // Slow sample clock: nothing plays while the test programs the FIFO
+    test(new AudioPeripheral(depth = 8, tickDivider = 2000)).withAnnotations(TestAnnotations.annos) { dut =>
+      axiWrite(dut, REG_WATERMARK, 2)
+      dut.io.signal_interrupt.expect(false.B, "interrupt raised while disabled")
+      axiWrite(dut, REG_CTRL, 1)
+      dut.io.signal_interrupt.expect(true.B, "empty FIFO is below the watermark")
+      for (i <- 1 to 3) axiWrite(dut, REG_DATA, 0x100 * i)
+      assert(axiRead(dut, REG_LEVEL) == 3)
+      assert(axiRead(dut, REG_STATUS) == 0x0)
+      dut.io.signal_interrupt.expect(false.B, "interrupt kept above the watermark")
+      dut.io.pending.expect(true.B)
+      // The first tick plays one sample and brings the level to the watermark
+      var cycles = 0
+      while (!dut.io.sample_valid.peekBoolean()) {
+        dut.clock.step()
+        cycles += 1
+        assert(cycles < 2100, "no sample played")
+      }
+      dut.io.sample.expect(0x100.U)
+      dut.clock.step()
+      dut.io.signal_interrupt.expect(true.B)
+      assert(axiRead(dut, REG_STATUS) == 0x4)
+      // Full: the extra sample is dropped
+      for (i <- 0 until 7) axiWrite(dut, REG_DATA, i)
+      assert(axiRead(dut, REG_LEVEL) == 8)
+      assert(axiRead(dut, REG_STATUS) == 0x2)
+    }
+  }
+
+  it should "count underruns only after the first sample until cleared" in {
+    test(new AudioPeripheral(depth = 8, tickDivider = 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      dut.clock.step(40)
+      assert(axiRead(dut, REG_UNDERRUN) == 0, "idle FIFO counted as underrun")
+      axiWrite(dut, REG_DATA, 0x1234)
+      axiWrite(dut, REG_DATA, 0x5678)
+      dut.clock.step(40)
+      val underruns = axiRead(dut, REG_UNDERRUN)
+      assert(underruns > 0 && underruns < 12)
+      dut.io.pending.expect(false.B)
+      assert(dut.io.underruns.peekInt() >= underruns, "underrun output lags the register")
+      axiWrite(dut, REG_UNDERRUN, 0)
+      dut.clock.step(40)
+      assert(axiRead(dut, REG_UNDERRUN) == 0, "cleared count did not wait for a new first sample")
+    }
+  }
+}
@@ -8,6 +8,7 @@ import chisel3._
 import chiseltest._
 import org.scalatest.flatspec.AnyFlatSpec
 import riscv.core.BranchTargetBuffer
+import riscv.core.PatternHistoryTable
 import riscv.core.ReturnAddressStack
 
 class BranchTargetBufferTest extends AnyFlatSpec with ChiselScalatestTester {
@@ -176,6 +177,110 @@ class BranchTargetBufferTest extends AnyFlatSpec with ChiselScalatestTester {
       dut.io.predicted_pc.expect(target2.U)
     }
   }
+  it should "keep conflicting branches in different ways of a 2-way set" in {
+    test(new BranchTargetBuffer(16, 2)).withAnnotations(TestAnnotations.annos) { dut =>
+      // 16 entries in 2 ways leave 8 sets, index = PC[4:2]; both PCs map to set 0
+      val pc1 = 0x1000L
+      val pc2 = 0x1020L
+
+      dut.io.update_valid.poke(true.B)
+      dut.io.update_taken.poke(true.B)
+      dut.io.update_pc.poke(pc1.U)
+      dut.io.update_target.poke(0x2000.U)
+      dut.clock.step()
+      dut.io.update_pc.poke(pc2.U)
+      dut.io.update_target.poke(0x3000.U)
+      dut.clock.step()
+      dut.io.update_valid.poke(false.B)
+
+      // Both entries survive, unlike the direct-mapped aliasing case above
+      dut.io.pc.poke(pc1.U)
+      dut.io.hit.expect(true.B)
+      dut.io.predicted_pc.expect(0x2000.U)
+      dut.io.pc.poke(pc2.U)
+      dut.io.hit.expect(true.B)
+      dut.io.predicted_pc.expect(0x3000.U)
+    }
+  }
+
+  it should "replace the not recently used way" in {
+    test(new BranchTargetBuffer(16, 2)).withAnnotations(TestAnnotations.annos) { dut =>
+      val pc1 = 0x1000L
+      val pc2 = 0x1020L
+      val pc3 = 0x1040L // Same set as pc1 and pc2
+
+      dut.io.update_valid.poke(true.B)
+      dut.io.update_taken.poke(true.B)
+      for ((pc, target) <- Seq(pc1 -> 0x2000L, pc2 -> 0x3000L, pc1 -> 0x2000L, pc3 -> 0x4000L)) {
+        // pc1 is touched again after pc2, so pc3 must evict pc2
+        dut.io.update_pc.poke(pc.U)
+        dut.io.update_target.poke(target.U)
+        dut.clock.step()
+      }
+      dut.io.update_valid.poke(false.B)
+
+      dut.io.pc.poke(pc1.U)
+      dut.io.hit.expect(true.B)
+      dut.io.pc.poke(pc2.U)
+      dut.io.hit.expect(false.B)
+      dut.io.pc.poke(pc3.U)
+      dut.io.hit.expect(true.B)
+      dut.io.predicted_pc.expect(0x4000.U)
+    }
+  }
+}
+
+class PatternHistoryTableTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Pattern History Table")
+
+  // Runs an outcome sequence through one branch at pc, training each
+  // prediction at the index it was made with, and returns the mispredictions
+  // seen after the first warmup outcomes
+  def mispredictions(dut: PatternHistoryTable, pc: Long, outcomes: Seq[Boolean], warmup: Int): Int = {
+    dut.io.pc.poke(pc.U)
+    var misses = 0
+    for ((taken, i) <- outcomes.zipWithIndex) {
+      val predicted = dut.io.predicted_taken.peek().litToBoolean
+      if (i >= warmup && predicted != taken) misses += 1
+      dut.io.update_valid.poke(true.B)
+      dut.io.update_index.poke(dut.io.index.peek())
+      dut.io.update_taken.poke(taken.B)
+      dut.clock.step()
+    }
+    dut.io.update_valid.poke(false.B)
+    misses
+  }
+
+  it should "predict weakly taken before training" in {
+    test(new PatternHistoryTable(64, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      dut.io.pc.poke(0x1000.U)
+      dut.io.update_valid.poke(false.B)
+      dut.io.predicted_taken.expect(true.B)
+    }
+  }
+
+  it should "learn an alternating branch through global history" in {
+    test(new PatternHistoryTable(64, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val outcomes = Seq.tabulate(40)(_ % 2 == 0)
+      assert(mispredictions(dut, 0x1000L, outcomes, 20) == 0)
+    }
+  }
+
+  it should "not learn an alternating branch without history (bimodal)" in {
+    test(new PatternHistoryTable(64, 0)).withAnnotations(TestAnnotations.annos) { dut =>
+      // A single counter oscillates between 2 and 3 and always predicts taken
+      val outcomes = Seq.tabulate(40)(_ % 2 == 0)
+      assert(mispredictions(dut, 0x1000L, outcomes, 20) == 10)
+    }
+  }
+
+  it should "saturate so one opposite outcome does not flip a strong prediction" in {
+    test(new PatternHistoryTable(64, 0)).withAnnotations(TestAnnotations.annos) { dut =>
+      mispredictions(dut, 0x1000L, Seq.fill(4)(false), 0)
+      mispredictions(dut, 0x1000L, Seq(true), 0)
+      dut.io.predicted_taken.expect(false.B)
+    }
+  }
 }
 
 class ReturnAddressStackTest extends AnyFlatSpec with ChiselScalatestTester {
@@ -232,7 +337,7 @@ class ReturnAddressStackTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
-  it should "handle overflow gracefully (shift down)" in {
+  it should "handle overflow gracefully (circular overwrite)" in {
     test(new ReturnAddressStack(4)).withAnnotations(TestAnnotations.annos) { dut =>
       dut.io.restore.poke(false.B)
       dut.io.pop.poke(false.B)
@@ -285,7 +390,7 @@ class ReturnAddressStackTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
-  it should "handle simultaneous push and pop (replace TOS)" in {
+  it should "forward a push to a pop in the same cycle" in {
     test(new ReturnAddressStack(4)).withAnnotations(TestAnnotations.annos) { dut =>
       dut.io.restore.poke(false.B)
 
@@ -295,23 +400,25 @@ class ReturnAddressStackTest extends AnyFlatSpec with ChiselScalatestTester {
       dut.io.pop.poke(false.B)
       dut.clock.step()
 
-      // Simultaneous push and pop (tail call pattern)
+      // Call in ID and its callee's return in IF: the return gets the new address
       dut.io.push.poke(true.B)
       dut.io.push_addr.poke(0x2000.U)
       dut.io.pop.poke(true.B)
+      dut.io.valid.expect(true.B)
+      dut.io.predicted_addr.expect(0x2000.U)
       dut.clock.step()
       dut.io.push.poke(false.B)
       dut.io.pop.poke(false.B)
 
-      // TOS should be replaced with 0x2000
+      // The stack is left as it was
       dut.io.valid.expect(true.B)
-      dut.io.predicted_addr.expect(0x2000.U)
+      dut.io.predicted_addr.expect(0x1000.U)
     }
   }
 
-  it should "restore state after misprediction" in {
+  it should "restore a checkpoint after misprediction" in {
     test(new ReturnAddressStack(4)).withAnnotations(TestAnnotations.annos) { dut =>
-      dut.io.push.poke(false.B)
+      dut.io.restore.poke(false.B)
       dut.io.pop.poke(false.B)
 
       // Push two addresses
@@ -319,26 +426,35 @@ class ReturnAddressStackTest extends AnyFlatSpec with ChiselScalatestTester {
       dut.io.push_addr.poke(0x1000.U)
       dut.clock.step()
       dut.io.push_addr.poke(0x2000.U)
+      val checkpoint = dut.io.checkpoint.peek() // State with both entries
       dut.clock.step()
       dut.io.push.poke(false.B)
 
-      // Speculative pop
+      // Wrong-path pops
       dut.io.pop.poke(true.B)
-      dut.clock.step()
+      dut.clock.step(2)
       dut.io.pop.poke(false.B)
+      dut.io.valid.expect(false.B)
 
-      // TOS is now 0x1000
-      dut.io.predicted_addr.expect(0x1000.U)
-
-      // Restore 0x2000 (misprediction recovery)
+      // Restore while the flushed fetch pops again, and a call pushes
       dut.io.restore.poke(true.B)
-      dut.io.restore_valid.poke(true.B)
-      dut.io.restore_addr.poke(0x2000.U)
+      dut.io.restore_point.poke(checkpoint)
+      dut.io.pop.poke(true.B)
+      dut.io.push.poke(true.B)
+      dut.io.push_addr.poke(0x3000.U)
       dut.clock.step()
       dut.io.restore.poke(false.B)
+      dut.io.pop.poke(false.B)
+      dut.io.push.poke(false.B)
 
-      // TOS should be back to 0x2000
-      dut.io.predicted_addr.expect(0x2000.U)
+      // Stack is 0x3000, 0x2000, 0x1000
+      for (exp <- Seq(0x3000L, 0x2000L, 0x1000L)) {
+        dut.io.predicted_addr.expect(exp.U)
+        dut.io.pop.poke(true.B)
+        dut.clock.step()
+      }
+      dut.io.pop.poke(false.B)
+      dut.io.valid.expect(false.B)
     }
   }
 }
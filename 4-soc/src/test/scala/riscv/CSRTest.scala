@@ -207,7 +207,7 @@ class CSRTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
-  it should "respect mcountinhibit mask (only bits 0,2,3-9 writable)" in {
+  it should "respect mcountinhibit mask (only bits 0,2,3-23 writable)" in {
     test(new CSR).withAnnotations(TestAnnotations.annos) { dut =>
       dut.io.clint_access_bundle.direct_write_enable.poke(false.B)
 
@@ -223,8 +223,8 @@ class CSRTest extends AnyFlatSpec with ChiselScalatestTester {
       dut.clock.step()
       val readback = dut.io.id_reg_read_data.peekInt()
 
-      // Only bits 0, 2, 3-9 should be set (mask 0x3fd)
-      assert(readback == 0x3fdL, f"mcountinhibit should mask to 0x3fd: got 0x$readback%08X")
+      // Only bits 0, 2, 3-23 should be set (mask 0xfffffd)
+      assert(readback == 0xfffffdL, f"mcountinhibit should mask to 0xfffffd: got 0x$readback%08X")
     }
   }
 
@@ -260,4 +260,43 @@ class CSRTest extends AnyFlatSpec with ChiselScalatestTester {
       assert(instret1 == instret0, s"minstret should be inhibited: was $instret0, now $instret1")
     }
   }
+
+  it should "return live high words on the debug port" in {
+    test(new CSR).withAnnotations(TestAnnotations.annos) { dut =>
+      dut.io.clint_access_bundle.direct_write_enable.poke(false.B)
+
+      // Set mcycle high word without any software read of the low word, so
+      // the shadow register stays at zero
+      dut.io.reg_write_enable_ex.poke(true.B)
+      dut.io.reg_write_address_ex.poke(CSRRegister.MCycleH)
+      dut.io.reg_write_data_ex.poke("h00000042".U)
+      dut.clock.step()
+      dut.io.reg_write_enable_ex.poke(false.B)
+
+      dut.io.reg_read_address_id.poke(CSRRegister.MCycleH)
+      dut.io.debug_reg_read_address.poke(CSRRegister.MCycleH)
+      assert(dut.io.id_reg_read_data.peekInt() == 0, "pipeline read should still return the shadow")
+      assert(dut.io.debug_reg_read_data.peekInt() == 0x42, "debug read should return the live high word")
+    }
+  }
+
+  it should "report the implemented extensions in a read-only misa" in {
+    test(new CSR).withAnnotations(TestAnnotations.annos) { dut =>
+      dut.io.clint_access_bundle.direct_write_enable.poke(false.B)
+
+      dut.io.reg_write_enable_ex.poke(true.B)
+      dut.io.reg_write_address_ex.poke(CSRRegister.MISA)
+      dut.io.reg_write_data_ex.poke(0.U)
+      dut.clock.step()
+      dut.io.reg_write_enable_ex.poke(false.B)
+
+      dut.io.reg_read_address_id.poke(CSRRegister.MISA)
+      val misa = dut.io.id_reg_read_data.peekInt().toLong
+      assert(misa >> 30 == 1, f"misa MXL should be 1 (RV32): 0x$misa%08X")
+      for (ext <- Seq('I', 'M', 'X') ++ (if (Parameters.BitManip) Seq('B') else Nil)) {
+        assert((misa >> (ext - 'A') & 1) == 1, f"misa lacks $ext: 0x$misa%08X")
+      }
+      assert((misa >> ('C' - 'A') & 1) == 0, "misa reports C, which is not implemented")
+    }
+  }
 }
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import scala.collection.mutable
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import peripheral.DMA
+
+class DMATest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("DMA Controller")
+
+  val REG_STATUS = 0x04
+  val REG_SRC    = 0x08
+  val REG_DST    = 0x0c
+  val REG_COUNT  = 0x10
+  val REG_CTRL   = 0x14
+
+  val CTRL_START   = 0x1
+  val CTRL_SRC_INC = 0x2
+  val CTRL_DST_INC = 0x4
+  val CTRL_IRQ     = 0x8
+  val CTRL_PACE    = 0x10
+
+  // Initial contents of the backing memory: distinct for every word
+  def word(address: Long): Long = (address * 3 + 0x5a) & 0xffffffffL
+
+  // Programs the controller over its AXI4-Lite port and serves its bus master
+  // port from a memory that grants at once and then moves one word per cycle:
+  // read data from the next cycle on, write beats likewise and the write
+  // response after the last one
+  class Harness(dut: DMA) {
+    val memory        = mutable.Map[Long, Long]()
+    val busWrites     = mutable.ArrayBuffer[(Long, Long)]() // (address, data) in order
+    val transactions  = mutable.ArrayBuffer[Int]()          // Beats of every bus transaction
+    var reads         = List.empty[Long]                    // Read beats still to answer
+    var writes        = List.empty[Long]                    // Write beats still to take
+    var writeResponse = false
+    private var next  = (List.empty[Long], List.empty[Long], false)
+
+    def read(address: Long): Long = memory.getOrElse(address, word(address))
+
+    dut.io.pace.poke(true.B)
+    dut.io.bus.busy.poke(false.B)
+    dut.io.bus.write_data_accepted.poke(false.B)
+    dut.io.channels.write_address_channel.AWVALID.poke(false.B)
+    dut.io.channels.write_data_channel.WVALID.poke(false.B)
+    dut.io.channels.write_response_channel.BREADY.poke(false.B)
+    dut.io.channels.read_address_channel.ARVALID.poke(false.B)
+    dut.io.channels.read_data_channel.RREADY.poke(false.B)
+
+    def cycle(): Unit = {
+      val idleBus = reads.isEmpty && writes.isEmpty && !writeResponse
+      dut.io.bus.granted.poke(idleBus.B)
+      dut.io.bus.read_valid.poke(reads.nonEmpty.B)
+      dut.io.bus.read_data.poke(reads.headOption.map(read).getOrElse(0L).U)
+      dut.io.bus.write_beat.poke(writes.nonEmpty.B)
+      dut.io.bus.write_valid.poke(writeResponse.B)
+      next = (reads.drop(1), writes.drop(1), writes.length == 1)
+      writes.headOption.foreach { address =>
+        val data = dut.io.bus.write_data.peekInt().toLong
+        memory(address) = data
+        busWrites += ((address, data))
+      }
+      if (idleBus && dut.io.bus.request.peekBoolean()) {
+        val address = dut.io.bus.address.peekInt().toLong
+        val beats   = List.tabulate(dut.io.bus.burst_length.peekInt().toInt + 1)(i => address + 4 * i)
+        if (dut.io.bus.read.peekBoolean()) {
+          transactions += beats.length
+          next = (beats, Nil, false)
+        } else if (dut.io.bus.write.peekBoolean()) {
+          transactions += beats.length
+          next = (Nil, beats, false)
+        }
+      }
+      dut.clock.step()
+      reads = next._1
+      writes = next._2
+      writeResponse = next._3
+    }
+
+    def writeReg(offset: Int, data: Long): Unit = {
+      dut.io.channels.write_address_channel.AWVALID.poke(true.B)
+      dut.io.channels.write_address_channel.AWADDR.poke(offset.U)
+      dut.io.channels.write_address_channel.AWPROT.poke(0.U)
+      dut.io.channels.write_data_channel.WVALID.poke(true.B)
+      dut.io.channels.write_data_channel.WDATA.poke(data.U)
+      dut.io.channels.write_data_channel.WSTRB.poke(0xf.U)
+      dut.io.channels.write_response_channel.BREADY.poke(true.B)
+      var cycles = 0
+      while (!dut.io.channels.write_response_channel.BVALID.peekBoolean()) {
+        cycle()
+        cycles += 1
+        assert(cycles < 20, f"register write to 0x$offset%02x never completed")
+      }
+      cycle()
+      dut.io.channels.write_address_channel.AWVALID.poke(false.B)
+      dut.io.channels.write_data_channel.WVALID.poke(false.B)
+      dut.io.channels.write_response_channel.BREADY.poke(false.B)
+    }
+
+    def readReg(offset: Int): Long = {
+      dut.io.channels.read_address_channel.ARVALID.poke(true.B)
+      dut.io.channels.read_address_channel.ARADDR.poke(offset.U)
+      dut.io.channels.read_address_channel.ARPROT.poke(0.U)
+      dut.io.channels.read_data_channel.RREADY.poke(true.B)
+      var cycles = 0
+      while (!dut.io.channels.read_data_channel.RVALID.peekBoolean()) {
+        cycle()
+        cycles += 1
+        assert(cycles < 20, f"register read of 0x$offset%02x never completed")
+      }
+      val data = dut.io.channels.read_data_channel.RDATA.peekInt().toLong
+      cycle()
+      dut.io.channels.read_address_channel.ARVALID.poke(false.B)
+      dut.io.channels.read_data_channel.RREADY.poke(false.B)
+      cycle()
+      data
+    }
+
+    def start(src: Long, dst: Long, words: Int, flags: Int): Unit = {
+      writeReg(REG_SRC, src)
+      writeReg(REG_DST, dst)
+      writeReg(REG_COUNT, words)
+      writeReg(REG_CTRL, flags | CTRL_START)
+    }
+
+    // Runs until the transfer is done
+    def finish(): Unit = {
+      var cycles = 0
+      while (dut.io.busy.peekBoolean() || writeResponse || writes.nonEmpty) {
+        cycle()
+        cycles += 1
+        assert(cycles < 500, "transfer never finished")
+      }
+    }
+  }
+
+  it should "copy memory to memory in bursts of the buffer size" in {
+    test(new DMA(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.start(0x1000, 0x2000, 10, CTRL_SRC_INC | CTRL_DST_INC)
+      h.finish()
+      for (i <- 0 until 10) assert(h.read(0x2000 + 4 * i) == word(0x1000 + 4 * i), s"word $i")
+      // Read and write bursts alternate, the last chunk shorter
+      assert(h.transactions == Seq(4, 4, 4, 4, 2, 2))
+      assert(h.readReg(REG_STATUS) == 0x2, "done not set")
+      assert(h.readReg(REG_SRC) == 0x1028 && h.readReg(REG_DST) == 0x2028)
+      assert(h.readReg(REG_COUNT) == 0)
+    }
+  }
+
+  it should "write a fixed peripheral address one word at a time in order" in {
+    test(new DMA(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.start(0x1000, 0x20000014L, 5, CTRL_SRC_INC)
+      h.finish()
+      assert(h.busWrites == (0 until 5).map(i => (0x20000014L, word(0x1000 + 4 * i))))
+      assert(h.transactions == Seq(4, 1, 1, 1, 1, 1, 1))
+    }
+  }
+
+  it should "hold paced writes until the destination has room" in {
+    test(new DMA(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      dut.io.pace.poke(false.B)
+      h.start(0x1000, 0x60000008L, 3, CTRL_SRC_INC | CTRL_PACE)
+      for (_ <- 0 until 30) h.cycle()
+      assert(h.busWrites.isEmpty, "paced write went out without room")
+      assert(dut.io.busy.peekBoolean())
+      dut.io.pace.poke(true.B)
+      h.cycle()
+      dut.io.pace.poke(false.B)
+      for (_ <- 0 until 30) h.cycle()
+      assert(h.busWrites.length == 1, "one slot of room let more than one write through")
+      dut.io.pace.poke(true.B)
+      h.finish()
+      assert(h.busWrites == (0 until 3).map(i => (0x60000008L, word(0x1000 + 4 * i))))
+    }
+  }
+
+  it should "ignore register writes while busy and interrupt when done" in {
+    test(new DMA(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.start(0x1000, 0x3000, 8, CTRL_SRC_INC | CTRL_DST_INC | CTRL_IRQ)
+      assert(dut.io.busy.peekBoolean())
+      h.writeReg(REG_COUNT, 1)
+      h.writeReg(REG_DST, 0x4000)
+      dut.io.signal_interrupt.expect(false.B)
+      h.finish()
+      assert(h.busWrites.map(_._1) == (0 until 8).map(i => 0x3000L + 4 * i))
+      dut.io.signal_interrupt.expect(true.B)
+      // The interrupt stays up until done is cleared
+      for (_ <- 0 until 5) h.cycle()
+      dut.io.signal_interrupt.expect(true.B)
+      h.writeReg(REG_STATUS, 0x2)
+      dut.io.signal_interrupt.expect(false.B)
+      assert(h.readReg(REG_STATUS) == 0)
+      // An empty descriptor is done at once, without bus traffic
+      h.start(0x1000, 0x3000, 0, CTRL_IRQ)
+      dut.io.busy.expect(false.B)
+      dut.io.signal_interrupt.expect(true.B)
+      assert(h.transactions.length == 4)
+    }
+  }
+}
@@ -6,11 +6,11 @@ import chiseltest._
 import org.scalatest.flatspec.AnyFlatSpec
 import riscv.core._
 
-class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
+class DSPTest extends AnyFlatSpec with CachedModelTester {
   behavior of "DSP Instructions"
 
   it should "perform Q15 fixed-point multiplication (QMUL16)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.qmul16)
 
       // Test case 1: 0.5 * 0.5 = 0.25
@@ -105,7 +105,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform Q15 multiply with rounding (QMUL16R)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.qmul16r)
 
       // 0x4000 * 0x4001 = 0x2001 with rounding
@@ -135,7 +135,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform 16-bit saturating shift-left (SSHL16)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.sshl16)
 
       // 0x4000 << 1 should saturate to 0x7FFF
@@ -165,7 +165,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform 16-bit saturating addition (SADD16)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.sadd16)
 
       // Test case 1: Normal addition (no overflow)
@@ -208,7 +208,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform 16-bit saturating subtraction (SSUB16)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.ssub16)
 
       // Test case 1: Normal subtraction (no overflow)
@@ -252,7 +252,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform 32-bit saturating add/sub (SADD32/SSUB32)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       def toU32(v: Long): BigInt = if (v < 0) (BigInt(1) << 32) + v else BigInt(v)
 
       // SADD32 normal
@@ -308,7 +308,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform DIV/REM operations (RV32M)" in {
-    test(new Divider) { dut =>
+    cachedTest(new Divider) { dut =>
       def runOp(op1: BigInt, op2: BigInt, funct3: Int): BigInt = {
         dut.io.start.poke(false.B)
         dut.clock.step(1)
@@ -435,7 +435,7 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "perform Q15 32x16 multiply (QMUL32x16)" in {
-    test(new ALU) { dut =>
+    cachedTest(new ALU) { dut =>
       dut.io.func.poke(ALUFunctions.qmul32x16)
 
       // Test case 1: 0x00010000 * 0x4000 >> 15 = 0x00008000
@@ -536,8 +536,71 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
+  // Packed 2x16 reference: each lane as its scalar op (QMUL16 keeps the low
+  // 16 bits, so -1.0 * -1.0 wraps to 0x8000 there too)
+  def lane(x: Long, i: Int): Int = ((x >> (16 * i)) & 0xffff).toShort.toInt
+  def sat16(x: Int): Int        = math.max(-32768, math.min(32767, x))
+  def referencePacked(func: ALUFunctions.Type, a: Long, b: Long): Long = {
+    val lanes = (0 until 2).map(i => (lane(a, i), lane(b, i)))
+    def pack(f: (Int, Int) => Int): Long =
+      lanes.zipWithIndex.map { case ((x, y), i) => (f(x, y) & 0xffffL) << (16 * i) }.sum
+    func match {
+      case ALUFunctions.pqmul16 => pack((x, y) => (x * y) >> 15)
+      case ALUFunctions.psadd16 => pack((x, y) => sat16(x + y))
+      case ALUFunctions.pssub16 => pack((x, y) => sat16(x - y))
+      case _                    => (lanes.map { case (x, y) => x.toLong * y }.sum >> 15) & 0xffffffffL
+    }
+  }
+
+  it should "process both 16-bit lanes at once (PQMUL16/PSADD16/PSSUB16/PDOT16)" in {
+    cachedTest(new ALU) { dut =>
+      val random = new scala.util.Random(0x2516)
+      val edges  = Seq(0x0000L, 0x0001L, 0x4000L, 0x7fffL, 0x8000L, 0xc000L, 0xffffL)
+      val words  = for (lo <- edges; hi <- edges) yield hi << 16 | lo
+      val operands =
+        words.zip(words.reverse) ++ Seq.fill(200)((random.nextInt() & 0xffffffffL, random.nextInt() & 0xffffffffL))
+      for (func <- Seq(ALUFunctions.pqmul16, ALUFunctions.psadd16, ALUFunctions.pssub16, ALUFunctions.pdot16)) {
+        dut.io.func.poke(func)
+        for ((a, b) <- operands) {
+          dut.io.op1.poke(a.U)
+          dut.io.op2.poke(b.U)
+          val expected = referencePacked(func, a, b)
+          val result   = dut.io.result.peekInt()
+          assert(result == expected, f"$func: 0x$a%08x, 0x$b%08x gave 0x$result%x, expected 0x$expected%08x")
+        }
+      }
+
+      // Dot product extremes: two -1.0 * -1.0 products give 2.0 (65536)
+      dut.io.op1.poke(0x80008000L.U)
+      dut.io.op2.poke(0x80008000L.U)
+      dut.io.result.expect(0x10000L.U)
+      dut.io.op2.poke(0x7fff7fffL.U)
+      dut.io.result.expect(0xffff0002L.U)
+    }
+  }
+
+  it should "decode the packed DSP ops from funct7 = 0000001" in {
+    cachedTest(new ALUControl) { dut =>
+      dut.io.opcode.poke(InstructionTypes.CUSTOM)
+      val packed = Seq(
+        InstructionsTypeDSPPacked.pqmul16 -> ALUFunctions.pqmul16,
+        InstructionsTypeDSPPacked.psadd16 -> ALUFunctions.psadd16,
+        InstructionsTypeDSPPacked.pssub16 -> ALUFunctions.pssub16,
+        InstructionsTypeDSPPacked.pdot16  -> ALUFunctions.pdot16
+      )
+      val scalar = Seq(ALUFunctions.qmul16, ALUFunctions.sadd16, ALUFunctions.ssub16, ALUFunctions.sadd32)
+      for (((funct3, func), scalarFunc) <- packed.zip(scalar)) {
+        dut.io.funct3.poke(funct3)
+        dut.io.funct7.poke(InstructionsTypeDSPPacked.funct7)
+        dut.io.alu_funct.expect(func)
+        dut.io.funct7.poke(0.U)
+        dut.io.alu_funct.expect(scalarFunc)
+      }
+    }
+  }
+
   it should "perform 64-bit division" in {
-    test(new Divider) { dut =>
+    cachedTest(new Divider) { dut =>
       def run64Op(op1Low: BigInt, op1High: BigInt, op2Low: BigInt, op2High: BigInt, funct3: Int): (BigInt, BigInt) = {
         dut.io.start.poke(false.B)
         dut.clock.step(1)
@@ -623,4 +686,87 @@ class DSPTest extends AnyFlatSpec with ChiselScalatestTester {
       assert(smallLargeRemResult == 100L, s"REM64 small%%large expected 100, got $smallLargeRemResult")
     }
   }
+
+  // RISC-V M results for 32-bit operands (funct3 4-7) and the 64-bit unsigned
+  // extension (funct3 bit 1 selects the remainder)
+  def referenceDiv32(a: Long, b: Long, funct3: Int): Long = {
+    val (sa, sb) = (a.toInt, b.toInt)
+    val value = funct3 match {
+      case 4 => if (sb == 0) -1L else if (sa == Int.MinValue && sb == -1) sa.toLong else (sa / sb).toLong
+      case 5 => if (b == 0) -1L else a / b
+      case 6 => if (sb == 0) sa.toLong else if (sa == Int.MinValue && sb == -1) 0L else (sa % sb).toLong
+      case _ => if (b == 0) a else a % b
+    }
+    value & 0xffffffffL
+  }
+
+  def referenceDiv64(a: BigInt, b: BigInt, funct3: Int): BigInt =
+    if ((funct3 & 2) != 0) { if (b == 0) a else a % b }
+    else { if (b == 0) (BigInt(1) << 64) - 1 else a / b }
+
+  // Runs one division; returns (64-bit result, cycles from start to valid,
+  // N + 1 in the Divider timing)
+  def runDivider(dut: Divider, a: BigInt, b: BigInt, funct3: Int, use64: Boolean): (BigInt, Int) = {
+    dut.io.op1.poke((a & 0xffffffffL).U)
+    dut.io.op1_high.poke((a >> 32).U)
+    dut.io.op2.poke((b & 0xffffffffL).U)
+    dut.io.op2_high.poke((b >> 32).U)
+    dut.io.funct3.poke(funct3.U)
+    dut.io.use_64.poke(use64.B)
+    dut.io.start.poke(true.B)
+    dut.clock.step()
+    dut.io.start.poke(false.B)
+    var cycles = 1
+    while (!dut.io.valid.peekBoolean()) {
+      dut.clock.step()
+      cycles += 1
+      assert(cycles < 50, "Divider did not assert valid")
+    }
+    val result = (dut.io.result_high.peekInt() << 32) | dut.io.result.peekInt()
+    dut.clock.step()
+    (result, cycles)
+  }
+
+  for (radix4 <- Seq(true, false)) {
+    it should s"match the RV32M spec on random operands (radix4 = $radix4)" in {
+      cachedTest(new Divider(radix4)) { dut =>
+        val random = new scala.util.Random(0x5eed)
+        // Random magnitudes, so that quotients of every length come up
+        def operand(): Long = (random.nextLong() >>> random.nextInt(64)) & 0xffffffffL
+        val edges = Seq(0L, 1L, 2L, 3L, 7L, 10L, 0x7fffffffL, 0x80000000L, 0xfffffff8L, 0xffffffffL)
+        val pairs = (for (a <- edges; b <- edges) yield (a, b)) ++ Seq.fill(200)((operand(), operand()))
+        for ((a, b) <- pairs; funct3 <- 4 to 7) {
+          val expected = referenceDiv32(a, b, funct3)
+          val result   = runDivider(dut, a, b, funct3, use64 = false)._1
+          assert(result == expected, f"funct3 $funct3: 0x$a%08x, 0x$b%08x gave 0x$result%x, expected 0x$expected%08x")
+        }
+        for (_ <- 0 until 100; funct3 <- Seq(5, 7)) {
+          val a        = (BigInt(operand()) << 32 | operand()) >> random.nextInt(64)
+          val b        = (BigInt(operand()) << 32 | operand()) >> random.nextInt(64)
+          val expected = referenceDiv64(a, b, funct3)
+          val result   = runDivider(dut, a, b, funct3, use64 = true)._1
+          assert(result == expected, s"64-bit funct3 $funct3: $a, $b gave $result, expected $expected")
+        }
+      }
+    }
+  }
+
+  it should "finish short quotients and the fast paths early on the radix-4 divider" in {
+    cachedTest(new Divider(radix4 = true)) { dut =>
+      val divu = InstructionsTypeM.divu.litValue.toInt
+      val div  = InstructionsTypeM.div.litValue.toInt
+      // Set-up cycle only (N = 1): powers of two, zero divisor, smaller dividend
+      assert(runDivider(dut, 0x12345678L, 16, divu, use64 = false) == ((0x1234567L, 2)))
+      assert(runDivider(dut, 0xffffff9cL, 4, div, use64 = false) == ((0xffffffe7L, 2)))
+      assert(runDivider(dut, 123, 0, divu, use64 = false) == ((0xffffffffL, 2)))
+      assert(runDivider(dut, 5, 9, divu, use64 = false) == ((0L, 2)))
+      // 100 / 7: a 5-bit quotient in 3 radix-4 steps
+      assert(runDivider(dut, 100, 7, divu, use64 = false) == ((14L, 5)))
+      // 0xffffffff / 3: 31 quotient bits, 16 steps
+      assert(runDivider(dut, 0xffffffffL, 3, divu, use64 = false) == ((0x55555555L, 18)))
+    }
+    cachedTest(new Divider(radix4 = false)) { dut =>
+      assert(runDivider(dut, 100, 7, InstructionsTypeM.divu.litValue.toInt, use64 = false)._2 == 6)
+    }
+  }
 }
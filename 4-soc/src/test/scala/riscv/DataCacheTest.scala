@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import scala.collection.mutable
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import riscv.core.DataCache
+
+class DataCacheTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Data Cache")
+
+  // Initial contents of the backing memory: distinct for every word
+  def word(address: Long): Long = (address * 5 + 0x11) & 0xffffffffL
+
+  def mergeBytes(old: Long, value: Long, strobe: Int): Long =
+    (0 until 4).foldLeft(old) { (w, i) =>
+      if ((strobe >> i & 1) == 1) (w & ~(0xffL << (8 * i))) | (value & (0xffL << (8 * i))) else w
+    }
+
+  // Drives the cache like MemoryAccess does and serves its bus side from a
+  // memory that grants at once and then moves one word per cycle: read data
+  // from the next cycle on, write beats likewise and the write response after
+  // the last one
+  class Harness(dut: DataCache) {
+    val memory        = mutable.Map[Long, Long]()
+    val busReads      = mutable.ArrayBuffer[Long]()
+    val busWrites     = mutable.ArrayBuffer[Long]()
+    val transactions  = mutable.ArrayBuffer[Int]() // Beats of every bus transaction
+    var reads         = List.empty[Long]           // Read beats still to answer
+    var writes        = List.empty[Long]           // Write beats still to take
+    var writeResponse = false
+    private var next  = (List.empty[Long], List.empty[Long], false)
+
+    def read(address: Long): Long = memory.getOrElse(address, word(address))
+
+    dut.io.cpu.request.poke(false.B)
+    dut.io.cpu.read.poke(false.B)
+    dut.io.cpu.write.poke(false.B)
+    dut.io.cpu.burst_length.poke(0.U)
+    dut.io.flush.poke(false.B)
+    dut.io.snoop.valid.poke(false.B)
+    dut.io.bus.busy.poke(false.B)
+    dut.io.bus.write_data_accepted.poke(false.B)
+
+    // Bus inputs for this cycle; call before peeking the CPU side
+    def driveBus(): Unit = {
+      val idleBus = reads.isEmpty && writes.isEmpty && !writeResponse
+      dut.io.bus.granted.poke(idleBus.B)
+      dut.io.bus.read_valid.poke(reads.nonEmpty.B)
+      dut.io.bus.read_data.poke(reads.headOption.map(read).getOrElse(0L).U)
+      dut.io.bus.write_beat.poke(writes.nonEmpty.B)
+      dut.io.bus.write_valid.poke(writeResponse.B)
+      next = (reads.drop(1), writes.drop(1), writes.length == 1)
+      writes.headOption.foreach { address =>
+        val strobe = dut.io.bus.write_strobe.map(_.peekBoolean()).zipWithIndex.map { case (b, i) =>
+          if (b) 1 << i else 0
+        }.sum
+        memory(address) = mergeBytes(read(address), dut.io.bus.write_data.peekInt().toLong, strobe)
+        busWrites += address
+      }
+      if (idleBus && dut.io.bus.request.peekBoolean()) {
+        val address = dut.io.bus.address.peekInt().toLong
+        val beats   = List.tabulate(dut.io.bus.burst_length.peekInt().toInt + 1)(i => address + 4 * i)
+        if (dut.io.bus.read.peekBoolean()) {
+          busReads ++= beats
+          transactions += beats.length
+          next = (beats, Nil, false)
+        } else if (dut.io.bus.write.peekBoolean()) {
+          transactions += beats.length
+          next = (Nil, beats, false)
+        }
+      }
+    }
+
+    def endCycle(): Unit = {
+      dut.clock.step()
+      reads = next._1
+      writes = next._2
+      writeResponse = next._3
+    }
+
+    def idle(cycles: Int): Unit =
+      for (_ <- 0 until cycles) {
+        driveBus()
+        endCycle()
+      }
+
+    // Runs one access to completion; returns (read data, stall cycles)
+    def access(address: Long, write: Boolean, data: Long, strobe: Int): (Long, Int) = {
+      dut.io.cpu.request.poke(true.B)
+      dut.io.cpu.read.poke((!write).B)
+      dut.io.cpu.write.poke(write.B)
+      dut.io.cpu.address.poke(address.U)
+      dut.io.cpu.write_data.poke(data.U)
+      for (i <- 0 until 4) dut.io.cpu.write_strobe(i).poke(((strobe >> i & 1) == 1).B)
+      var accepted             = false
+      var result: Option[Long] = None
+      var cycles               = 0
+      while (result.isEmpty) {
+        driveBus()
+        val done = if (write) dut.io.cpu.write_valid.peekBoolean() else dut.io.cpu.read_valid.peekBoolean()
+        if (accepted || dut.io.cpu.granted.peekBoolean()) {
+          accepted = true
+          if (done) result = Some(dut.io.cpu.read_data.peekInt().toLong)
+        }
+        endCycle()
+        if (accepted) {
+          dut.io.cpu.read.poke(false.B)
+          dut.io.cpu.write.poke(false.B)
+        }
+        cycles += 1
+        assert(cycles < 200, f"access to 0x$address%08x never completed")
+      }
+      dut.io.cpu.request.poke(false.B)
+      dut.io.cpu.write.poke(false.B)
+      (result.get, cycles - 1)
+    }
+
+    def load(address: Long): (Long, Int) = access(address, write = false, 0, 0)
+    def store(address: Long, data: Long, strobe: Int = 0xf): Int =
+      access(address, write = true, data, strobe)._2
+  }
+
+  it should "refill a line on a load miss and hit the rest of it without stalls" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h              = new Harness(dut)
+      val (data, stalls) = h.load(0x8104)
+      assert(data == word(0x8104))
+      assert(stalls >= 5, s"refill of 4 words took only $stalls cycles")
+      assert(h.busReads == Seq(0x8100L, 0x8104L, 0x8108L, 0x810cL))
+      assert(h.transactions == Seq(4), "line not refilled with one burst")
+      for (address <- Seq(0x8100L, 0x8104L, 0x8108L, 0x810cL)) {
+        assert(h.load(address) == ((word(address), 0)), f"0x$address%08x missed")
+      }
+      assert(h.busReads.length == 4)
+    }
+  }
+
+  it should "merge store bytes into a line and keep them until eviction" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.load(0x8200)
+      assert(h.store(0x8200, 0x0000ab00L, strobe = 0x2) == 0)
+      assert(h.load(0x8200)._1 == mergeBytes(word(0x8200), 0x0000ab00L, 0x2))
+      assert(h.busWrites.isEmpty, "write-back cache wrote through")
+    }
+  }
+
+  it should "complete a store miss at once and serve hits under the miss" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.load(0x8100)
+      assert(h.store(0x8400, 0x12345678L) == 0, "store miss stalled")
+      // Refill of 0x8400 in progress: other lines hit, stores to it merge
+      assert(h.load(0x8104) == ((word(0x8104), 0)))
+      assert(h.store(0x8404, 0xcafef00dL) == 0)
+      assert(h.store(0x8100, 0x55L, strobe = 0x1) == 0)
+      // A load to the missing line waits for the install
+      assert(h.load(0x8400)._1 == 0x12345678L)
+      assert(h.load(0x8404) == ((0xcafef00dL, 0)))
+      assert(h.load(0x8408) == ((word(0x8408), 0)))
+      assert(h.load(0x8100) == ((mergeBytes(word(0x8100), 0x55L, 0x1), 0)))
+      assert(h.busReads.count(a => (a & ~0xfL) == 0x8400L) == 4)
+    }
+  }
+
+  it should "write a dirty victim back before refilling its way" in {
+    // 32 sets of 16 bytes: addresses 512 bytes apart share a set
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.store(0x1000, 0xdeadbeefL)
+      h.load(0x1200)
+      h.load(0x1400) // Evicts 0x1000, the not recently used line
+      assert(h.busWrites == Seq(0x1000L, 0x1004L, 0x1008L, 0x100cL))
+      assert(h.read(0x1000) == 0xdeadbeefL)
+      assert(h.load(0x1000)._1 == 0xdeadbeefL)
+      // Clean victims are dropped silently
+      h.load(0x1600)
+      assert(h.busWrites.length == 4)
+    }
+  }
+
+  it should "move lines one single-beat transaction per word when bursts are off" in {
+    test(new DataCache(64, 2, 4, burst = false)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.store(0x1000, 0xdeadbeefL)
+      h.load(0x1200)
+      h.load(0x1400)
+      assert(h.busWrites == Seq(0x1000L, 0x1004L, 0x1008L, 0x100cL))
+      assert(h.transactions.length == 16 && h.transactions.forall(_ == 1))
+      assert(h.load(0x1000)._1 == 0xdeadbeefL)
+    }
+  }
+
+  it should "pass MMIO accesses through uncached" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.memory(0x40000000L) = 1
+      assert(h.load(0x40000000L)._1 == 1)
+      h.memory(0x40000000L) = 3
+      assert(h.load(0x40000000L)._1 == 3)
+      h.store(0x20000010L, 0x11223344L, strobe = 0xc)
+      assert(h.busReads == Seq(0x40000000L, 0x40000000L))
+      assert(h.busWrites == Seq(0x20000010L))
+      assert(h.read(0x20000010L) == mergeBytes(word(0x20000010L), 0x11223344L, 0xc))
+    }
+  }
+
+  it should "send every access to the simulator's control page to the bus" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      // SIM_EXIT (0x108): each store is a command, never a dirty line
+      h.store(0x108, 0x3L)
+      h.store(0x108, 0x3L)
+      assert(h.load(0x118)._2 > 0)
+      assert(h.load(0x118)._2 > 0, "control page word cached")
+      assert(h.busWrites == Seq(0x108L, 0x108L))
+      assert(h.busReads == Seq(0x118L, 0x118L))
+      assert(h.transactions.forall(_ == 1))
+    }
+  }
+
+  it should "drop the line of a word another master wrote" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.load(0x8100)
+      h.load(0x8200)
+      // A DMA write to 0x8104 behind the cache
+      h.memory(0x8104L) = 0xd0d0L
+      dut.io.snoop.valid.poke(true.B)
+      dut.io.snoop.bits.poke(0x8104.U)
+      h.idle(1)
+      dut.io.snoop.valid.poke(false.B)
+      val (data, stalls) = h.load(0x8104)
+      assert(data == 0xd0d0L && stalls > 0, "stale line kept")
+      assert(h.load(0x8200) == ((word(0x8200), 0)), "other line dropped")
+    }
+  }
+
+  it should "write back every dirty line on flush" in {
+    test(new DataCache(64, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.store(0x8100, 0x1L)
+      h.store(0x2008, 0x2L)
+      h.load(0x3000)
+      h.idle(1)
+      dut.io.flush.poke(true.B)
+      h.idle(1)
+      dut.io.flush.poke(false.B)
+      var cycles = 0
+      while (dut.io.flushing.peekBoolean()) {
+        h.idle(1)
+        cycles += 1
+        assert(cycles < 500, "flush never finished")
+      }
+      assert(h.read(0x8100) == 1 && h.read(0x2008) == 2)
+      assert(h.busWrites.length == 8, "only the two dirty lines are written back")
+      // Lines stay valid and clean
+      assert(h.load(0x8100) == ((1L, 0)))
+      h.idle(1)
+      dut.io.flush.poke(true.B)
+      h.idle(1)
+      dut.io.flush.poke(false.B)
+      while (dut.io.flushing.peekBoolean()) h.idle(1)
+      assert(h.busWrites.length == 8)
+    }
+  }
+}
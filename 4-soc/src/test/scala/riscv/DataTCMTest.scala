@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import java.nio.file.Files
+import java.nio.file.Paths
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import riscv.core.DataTCM
+import riscv.core.DebugWriteTarget
+
+class DataTCMTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Data TCM")
+
+  val base = Parameters.DataTCMBase
+
+  // Drives the TCM like MemoryAccess does: loads read the word in the same
+  // cycle, stores write it at the clock edge
+  class Harness(dut: DataTCM) {
+    dut.io.cpu.address.poke(0.U)
+    dut.io.cpu.write.poke(false.B)
+    dut.io.cpu.write_data.poke(0.U)
+    dut.io.cpu.write_strobe.foreach(_.poke(false.B))
+    dut.io.debug_write.valid.poke(false.B)
+    dut.io.debug_write.target.poke(DebugWriteTarget.TCM)
+    dut.io.debug_write.address.poke(0.U)
+    dut.io.debug_write.data.poke(0.U)
+
+    def load(address: Long): Long = {
+      dut.io.cpu.address.poke(address.U)
+      dut.io.cpu.read_data.peekInt().toLong
+    }
+
+    def store(address: Long, data: Long, strobe: Int = 0xf): Unit = {
+      dut.io.cpu.address.poke(address.U)
+      dut.io.cpu.write.poke(true.B)
+      dut.io.cpu.write_data.poke(data.U)
+      for (i <- 0 until 4) dut.io.cpu.write_strobe(i).poke(((strobe >> i & 1) == 1).B)
+      dut.clock.step()
+      dut.io.cpu.write.poke(false.B)
+    }
+
+    def debugWrite(index: Int, data: Long): Unit = {
+      dut.io.debug_write.valid.poke(true.B)
+      dut.io.debug_write.address.poke(index.U)
+      dut.io.debug_write.data.poke(data.U)
+      dut.clock.step()
+      dut.io.debug_write.valid.poke(false.B)
+    }
+  }
+
+  it should "claim only the addresses of its own range" in {
+    test(new DataTCM(bytes = 256, base = base)).withAnnotations(TestAnnotations.annos) { dut =>
+      new Harness(dut)
+      for ((address, hit) <- Seq(base -> true, base + 0xfc -> true, base + 0x100 -> false, base - 4 -> false)) {
+        dut.io.cpu.address.poke(address.U)
+        assert(dut.io.cpu.hit.peekBoolean() == hit, f"0x$address%08x")
+      }
+    }
+  }
+
+  it should "merge strobed stores and return them to the next load" in {
+    test(new DataTCM(bytes = 256, base = base)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.store(base + 8, 0x11223344L)
+      assert(h.load(base + 8) == 0x11223344L)
+      h.store(base + 8, 0x0000aa00L, strobe = 0x2)
+      h.store(base + 8, 0xbb000000L, strobe = 0x8)
+      assert(h.load(base + 8) == 0xbb22aa44L)
+      // Same index, outside the range: not the TCM's store
+      h.store(base + 0x108, 0xdeadbeefL)
+      assert(h.load(base + 8) == 0xbb22aa44L)
+    }
+  }
+
+  it should "take debug writes by word index and drop those past the end" in {
+    test(new DataTCM(bytes = 256, base = base)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut)
+      h.debugWrite(3, 0xcafef00dL)
+      assert(h.load(base + 12) == 0xcafef00dL)
+      h.store(base + 12, 0x12345678L)
+      h.debugWrite(64 + 3, 0xdeadbeefL)
+      assert(h.load(base + 12) == 0x12345678L)
+    }
+  }
+
+  it should "serve the pipeline's loads and stores without touching main memory" in {
+    // lui x5, 0x300; addi x6, x0, 0x123; sw x6, 0(x5); lw x7, 0(x5);
+    // addi x8, x7, 1; sw x0, 4(x5); sb x8, 5(x5); lw x9, 4(x5); j .
+    val program = Seq(0x003002b7L, 0x12300313L, 0x0062a023L, 0x0002a383L, 0x00138413L, 0x0002a223L, 0x008282a3L,
+      0x0042a483L, 0x0000006fL)
+    val image = Paths.get(System.getProperty("user.dir"), "test_run_dir", "tcm", "tcm.asmbin")
+    Files.createDirectories(image.getParent)
+    Files.write(image, program.flatMap(w => (0 until 4).map(i => (w >> (8 * i)).toByte)).toArray)
+
+    test(new TestTopModule(image.toString, dcacheLines = 0, dataTCMBytes = 16384))
+      .withAnnotations(TestAnnotations.annos) { dut =>
+        dut.clock.setTimeout(0)
+        dut.io.interrupt_flag.poke(0.U)
+        dut.clock.step(4000)
+
+        for ((register, value) <- Seq(7 -> 0x123L, 8 -> 0x124L, 9 -> 0x2400L)) {
+          dut.io.regs_debug_read_address.poke(register.U)
+          assert(dut.io.regs_debug_read_data.peekInt() == value, s"x$register")
+        }
+        // The RAM below the TCM (aliased in this harness's 32 KiB memory)
+        // never saw the stores
+        dut.io.mem_debug_read_address.poke(base.U)
+        dut.clock.step()
+        assert(dut.io.mem_debug_read_data.peekInt() != 0x123)
+      }
+  }
+}
@@ -6,11 +6,11 @@ import chiseltest._
 import org.scalatest.flatspec.AnyFlatSpec
 import peripheral._
 
-class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
+class HWSynthTest extends AnyFlatSpec with CachedModelTester {
   behavior of "HWSynthVoice"
 
   it should "generate non-zero saw wave with envelope" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       // Configure voice
       dut.io.freq.poke(2000.U)  // ~87 Hz
       dut.io.wave_type.poke(0.U)  // Saw
@@ -76,7 +76,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "have active signal when envelope is running" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       // Configure voice
       dut.io.freq.poke(1000.U)
       dut.io.wave_type.poke(0.U)
@@ -155,7 +155,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== Waveform Tests ==========
 
   it should "generate square wave (wave_type=1)" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 2000, wave = 1)
       dut.clock.step(1)
       dut.io.gate.poke(true.B)
@@ -175,7 +175,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "generate triangle wave (wave_type=2)" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 2000, wave = 2)
       dut.clock.step(1)
       dut.io.gate.poke(true.B)
@@ -195,7 +195,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "generate sine wave (wave_type=3)" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 2000, wave = 3)
       dut.clock.step(1)
       dut.io.gate.poke(true.B)
@@ -215,7 +215,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "generate noise (wave_type=4)" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 2000, wave = 4)
       dut.clock.step(1)
       dut.io.gate.poke(true.B)
@@ -245,7 +245,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== Envelope Tests ==========
 
   it should "envelope attack phase increases level" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 1000, wave = 0)
       dut.io.attack_rate.poke(0x10.U)  // Very slow attack to see increases
       dut.clock.step(1)
@@ -277,7 +277,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "envelope decay to sustain level" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 1000, wave = 0)
       dut.io.attack_rate.poke(0xFF.U)  // Very fast attack
       dut.io.decay_rate.poke(0x40.U)   // Moderate decay
@@ -324,7 +324,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "envelope release phase decreases" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 1000, wave = 0)
       dut.io.attack_rate.poke(0xFF.U)
       dut.io.release_rate.poke(0x40.U)
@@ -372,7 +372,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "voice becomes inactive after release completes" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       // Setup with parameters that ensure envelope reaches inactive state
       dut.io.freq.poke(1000.U)
       dut.io.wave_type.poke(0.U)
@@ -444,7 +444,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== SVF Filter Tests ==========
 
   it should "SVF filter LP mode passes DC" in {
-    test(new SVFFilter) { dut =>
+    cachedTest(new SVFFilter) { dut =>
       dut.io.input.poke(16000.S)
       dut.io.cutoff.poke(1000.U)  // Low cutoff
       dut.io.resonance.poke(0.U)
@@ -468,7 +468,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "SVF filter HP mode blocks DC" in {
-    test(new SVFFilter) { dut =>
+    cachedTest(new SVFFilter) { dut =>
       dut.io.input.poke(16000.S)
       dut.io.cutoff.poke(16000.U)  // High cutoff
       dut.io.resonance.poke(0.U)
@@ -492,7 +492,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "SVF filter BP mode outputs mid-range" in {
-    test(new SVFFilter) { dut =>
+    cachedTest(new SVFFilter) { dut =>
       dut.io.cutoff.poke(8000.U)
       dut.io.resonance.poke(128.U)  // 8-bit value (0-255)
       dut.io.mode.poke(2.U)  // BP
@@ -522,7 +522,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "SVF filter resonance affects output" in {
-    test(new SVFFilter) { dut =>
+    cachedTest(new SVFFilter) { dut =>
       dut.io.cutoff.poke(8000.U)
       dut.io.mode.poke(0.U)  // LP
       dut.io.tick.poke(false.B)
@@ -567,7 +567,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== Envelope to Filter Modulation Tests ==========
 
   it should "envelope modulates filter cutoff" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       setupVoice(dut, freq = 2000, wave = 0)
       dut.io.filter_cutoff.poke(8000.U)  // Base cutoff
       dut.io.env_to_filter.poke(16000.S)  // Strong positive modulation
@@ -614,7 +614,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== DC Blocker Tests ==========
 
   it should "DC blocker removes DC offset" in {
-    test(new DCBlocker) { dut =>
+    cachedTest(new DCBlocker) { dut =>
       dut.io.tick.poke(false.B)
       dut.clock.step(1)
 
@@ -636,7 +636,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "DC blocker passes AC signal" in {
-    test(new DCBlocker) { dut =>
+    cachedTest(new DCBlocker) { dut =>
       dut.io.tick.poke(false.B)
       dut.clock.step(1)
 
@@ -675,7 +675,7 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
   // ========== Integration Test ==========
 
   it should "full voice integration test" in {
-    test(new HWSynthVoice) { dut =>
+    cachedTest(new HWSynthVoice) { dut =>
       // Test full signal path: oscillator -> envelope -> filter -> output
       setupVoice(dut, freq = 3000, wave = 0)
       dut.io.attack_rate.poke(0x80.U)
@@ -744,4 +744,126 @@ class HWSynthTest extends AnyFlatSpec with ChiselScalatestTester {
       assert(finalEnv < 20000, "Envelope should decrease during release")
     }
   }
+
+  // ========== Time-Multiplexed Engine Tests ==========
+
+  behavior of "HWSynth"
+
+  val REG_CTRL       = 0x04
+  val REG_VOICE_MASK = 0x800
+  val REG_ACTIVE     = 0x804
+  val REG_VOICES     = 0x808
+  def voiceReg(voice: Int, off: Int): Int = 0x10 + voice * 0x20 + off
+
+  def axiWrite(dut: HWSynth, addr: Int, data: Long): Unit = {
+    dut.io.channels.write_address_channel.AWVALID.poke(true.B)
+    dut.io.channels.write_address_channel.AWADDR.poke(addr.U)
+    dut.io.channels.write_address_channel.AWPROT.poke(0.U)
+    dut.io.channels.write_data_channel.WVALID.poke(true.B)
+    dut.io.channels.write_data_channel.WDATA.poke(data.U)
+    dut.io.channels.write_data_channel.WSTRB.poke(0xf.U)
+    dut.io.channels.write_response_channel.BREADY.poke(true.B)
+    var cycles = 0
+    while (!dut.io.channels.write_response_channel.BVALID.peekBoolean() && cycles < 20) {
+      dut.clock.step()
+      cycles += 1
+    }
+    dut.clock.step()
+    dut.io.channels.write_address_channel.AWVALID.poke(false.B)
+    dut.io.channels.write_data_channel.WVALID.poke(false.B)
+    dut.io.channels.write_response_channel.BREADY.poke(false.B)
+  }
+
+  def axiRead(dut: HWSynth, addr: Int): BigInt = {
+    dut.io.channels.read_address_channel.ARVALID.poke(true.B)
+    dut.io.channels.read_address_channel.ARADDR.poke(addr.U)
+    dut.io.channels.read_address_channel.ARPROT.poke(0.U)
+    dut.io.channels.read_data_channel.RREADY.poke(true.B)
+    var cycles = 0
+    while (!dut.io.channels.read_data_channel.RVALID.peekBoolean() && cycles < 20) {
+      dut.clock.step()
+      cycles += 1
+    }
+    val data = dut.io.channels.read_data_channel.RDATA.peekInt()
+    dut.clock.step()
+    dut.io.channels.read_address_channel.ARVALID.poke(false.B)
+    dut.io.channels.read_data_channel.RREADY.poke(false.B)
+    dut.clock.step()
+    data
+  }
+
+  // Saw at full sustain, gated and triggered
+  def noteOn(dut: HWSynth, voice: Int, freq: Int): Unit = {
+    axiWrite(dut, voiceReg(voice, 0x00), freq)
+    axiWrite(dut, voiceReg(voice, 0x08), 0xff)
+    axiWrite(dut, voiceReg(voice, 0x0c), 32000)
+    axiWrite(dut, voiceReg(voice, 0x18), 0x3)
+  }
+
+  def collectSamples(dut: HWSynth, count: Int): Seq[Int] = {
+    val samples = Seq.newBuilder[Int]
+    var n       = 0
+    var cycles  = 0
+    while (n < count) {
+      if (dut.io.sample_valid.peekBoolean()) {
+        samples += dut.io.sample.peekInt().toInt
+        n += 1
+      }
+      dut.clock.step()
+      cycles += 1
+      assert(cycles < count * 64, "sample ticks stopped")
+    }
+    samples.result()
+  }
+
+  it should "step every voice in turn through one datapath" in {
+    cachedTest(new HWSynth(voices = 8, tickDivider = 32)) { dut =>
+      dut.clock.step(10) // Voice memories cleared
+      assert(axiRead(dut, REG_VOICES) == 8)
+      noteOn(dut, 1, 2000)
+      noteOn(dut, 6, 3000)
+      axiWrite(dut, REG_VOICE_MASK, 0xff)
+      axiWrite(dut, REG_CTRL, 0xf1)
+      val samples = collectSamples(dut, 100)
+      assert(axiRead(dut, REG_ACTIVE) == 0x42, "only the two gated voices run")
+      assert(
+        samples.max - samples.min > 10000,
+        s"voices produce no sound: min=${samples.min}, max=${samples.max}"
+      )
+    }
+  }
+
+  it should "play a voice the same in whichever slot holds it" in {
+    def play(slot: Int): Seq[Int] = {
+      var samples = Seq.empty[Int]
+      cachedTest(new HWSynth(voices = 8, tickDivider = 32)) { dut =>
+        dut.clock.step(10)
+        noteOn(dut, slot, 2500)
+        axiWrite(dut, REG_VOICE_MASK, 0xff)
+        axiWrite(dut, REG_CTRL, 0xf1)
+        samples = collectSamples(dut, 60)
+      }
+      samples
+    }
+    val first = play(0)
+    val last  = play(7)
+    assert(first.exists(_ != 0), "voice 0 stayed silent")
+    assert(first == last, "voice 7 differs from voice 0")
+  }
+
+  it should "hold voices outside VOICE_MASK" in {
+    cachedTest(new HWSynth(voices = 8, tickDivider = 32)) { dut =>
+      dut.clock.step(10)
+      noteOn(dut, 5, 2000)
+      axiWrite(dut, REG_VOICE_MASK, 0x0f)
+      axiWrite(dut, REG_CTRL, 0xf1)
+      collectSamples(dut, 10)
+      assert(axiRead(dut, REG_ACTIVE) == 0, "masked voice advanced")
+      axiWrite(dut, REG_VOICE_MASK, 0x20)
+      collectSamples(dut, 10)
+      assert(axiRead(dut, REG_ACTIVE) == 0x20)
+      // CTRL [7:4] only covers voices 0-3
+      assert(axiRead(dut, REG_CTRL) == 0x01)
+    }
+  }
 }
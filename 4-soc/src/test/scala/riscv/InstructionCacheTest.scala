@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import riscv.core.InstructionCache
+
+class InstructionCacheTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Instruction Cache")
+
+  // Contents of the backing memory: distinct for every word
+  def word(address: Long): Long = (address * 3 + 0x13) & 0xffffffffL
+
+  def init(dut: InstructionCache): Unit = {
+    dut.io.enable.poke(true.B)
+    dut.io.invalidate.poke(false.B)
+    dut.io.bus.write_valid.poke(false.B)
+    dut.io.bus.write_data_accepted.poke(false.B)
+    dut.io.bus.write_beat.poke(false.B)
+    dut.io.bus.busy.poke(false.B)
+  }
+
+  // One cycle of a memory that grants a read at once and answers it from the
+  // next cycle on, one word per cycle for a burst; returns the words still in
+  // flight afterwards
+  def serve(dut: InstructionCache, inFlight: List[Long]): List[Long] = {
+    dut.io.bus.granted.poke(inFlight.isEmpty.B)
+    dut.io.bus.read_valid.poke(inFlight.nonEmpty.B)
+    dut.io.bus.read_data.poke(word(inFlight.headOption.getOrElse(0L)).U)
+    val next =
+      if (inFlight.isEmpty && dut.io.bus.request.peekBoolean() && dut.io.bus.read.peekBoolean()) {
+        val address = dut.io.bus.address.peekInt().toLong
+        List.tabulate(dut.io.bus.burst_length.peekInt().toInt + 1)(i => address + 4 * i)
+      } else inFlight.drop(1)
+    dut.clock.step()
+    next
+  }
+
+  // Fetches address until it hits; returns (cycles waited, refills started)
+  def fetch(dut: InstructionCache, address: Long): (Int, Int) = {
+    dut.io.address.poke(address.U)
+    var inFlight: List[Long] = Nil
+    var cycles               = 0
+    var refills              = 0
+    while (!dut.io.valid.peekBoolean()) {
+      if (dut.io.refill_started.peekBoolean()) refills += 1
+      inFlight = serve(dut, inFlight)
+      cycles += 1
+      assert(cycles < 100, f"no hit for 0x$address%08x")
+    }
+    dut.io.instruction.expect(word(address).U)
+    serve(dut, inFlight)
+    (cycles, refills)
+  }
+
+  it should "refill a line on a miss and then hit every word of it" in {
+    test(new InstructionCache(16, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      val (cycles, refills) = fetch(dut, 0x1008)
+      assert(refills == 1)
+      assert(cycles >= 5, s"refill of 4 words took only $cycles cycles")
+      for (address <- Seq(0x1000L, 0x1004L, 0x1008L, 0x100cL)) {
+        assert(fetch(dut, address) == ((0, 0)), f"0x$address%08x missed")
+      }
+      // The next line is a separate miss
+      assert(fetch(dut, 0x1010)._2 == 1)
+    }
+  }
+
+  it should "keep two conflicting lines and replace the not recently used one" in {
+    // 8 lines, 2 ways, 16-byte lines: addresses 64 bytes apart share a set
+    test(new InstructionCache(8, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      val (a, b, c) = (0x1000L, 0x1040L, 0x1080L)
+      assert(fetch(dut, a)._2 == 1)
+      assert(fetch(dut, b)._2 == 1)
+      assert(fetch(dut, a)._2 == 0)
+      assert(fetch(dut, b)._2 == 0)
+
+      // a used last: c takes b's way
+      assert(fetch(dut, a)._2 == 0)
+      assert(fetch(dut, c)._2 == 1)
+      assert(fetch(dut, a)._2 == 0, "recently used line was evicted")
+      assert(fetch(dut, b)._2 == 1, "not recently used line was kept")
+    }
+  }
+
+  it should "drop every line on invalidate" in {
+    test(new InstructionCache(16, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      fetch(dut, 0x1000)
+      fetch(dut, 0x2000)
+      dut.io.invalidate.poke(true.B)
+      dut.clock.step()
+      dut.io.invalidate.poke(false.B)
+      assert(fetch(dut, 0x1000)._2 == 1)
+      assert(fetch(dut, 0x2000)._2 == 1)
+    }
+  }
+
+  it should "not install a line whose refill overlapped an invalidate" in {
+    test(new InstructionCache(16, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      dut.io.address.poke(0x1000.U)
+      var inFlight: List[Long] = Nil
+      for (_ <- 0 until 3) inFlight = serve(dut, inFlight)
+      dut.io.invalidate.poke(true.B)
+      inFlight = serve(dut, inFlight)
+      dut.io.invalidate.poke(false.B)
+
+      // The discarded refill finishes, then the same line is read again
+      var refills = 0
+      var cycles  = 0
+      while (!dut.io.valid.peekBoolean()) {
+        if (dut.io.refill_started.peekBoolean()) refills += 1
+        inFlight = serve(dut, inFlight)
+        cycles += 1
+        assert(cycles < 100, "no hit after invalidate")
+      }
+      assert(refills == 1)
+      dut.io.instruction.expect(word(0x1000).U)
+    }
+  }
+
+  it should "refill with one single-beat read per word when bursts are off" in {
+    test(new InstructionCache(16, 2, 4, burst = false)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      dut.io.address.poke(0x1000.U)
+      var inFlight: List[Long] = Nil
+      var reads                = 0
+      while (!dut.io.valid.peekBoolean()) {
+        if (inFlight.isEmpty && dut.io.bus.request.peekBoolean() && dut.io.bus.read.peekBoolean()) {
+          dut.io.bus.burst_length.expect(0.U)
+          reads += 1
+        }
+        inFlight = serve(dut, inFlight)
+      }
+      assert(reads == 4)
+      dut.io.instruction.expect(word(0x1000).U)
+    }
+  }
+
+  it should "not fetch while disabled" in {
+    test(new InstructionCache(16, 2, 4)).withAnnotations(TestAnnotations.annos) { dut =>
+      init(dut)
+      dut.io.enable.poke(false.B)
+      dut.io.address.poke(0x1000.U)
+      for (_ <- 0 until 10) {
+        dut.io.refill_started.expect(false.B)
+        dut.io.bus.request.expect(false.B)
+        dut.io.valid.expect(false.B)
+        dut.clock.step()
+      }
+    }
+  }
+}
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import java.nio.file.Files
+import java.nio.file.Paths
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import riscv.core.RetireBundle
+
+class RetireTraceTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Retire trace")
+
+  // The dual-issue hazards, in pairs from 0x1000: pairs reading both results
+  // of the pair before, a store and a load in slot A, a load that both slots
+  // of the next pair read, MUL and DIV beside an ALU operation, a branch on
+  // slot B's result and a slot B reading the ra a JAL just wrote. Ends in
+  // `j .` at 0x1060.
+  val hazardProgram = Seq(
+    0x00500093L, 0x00700113L, 0x002081b3L, 0x00110213L, // li ra,5; li sp,7; add gp,ra,sp; addi tp,sp,1
+    0x00004537L, 0x404182b3L, 0x00352023L, 0x00124333L, // lui a0,4; sub t0,gp,tp; sw gp,0(a0); xor t1,tp,ra
+    0x00052403L, 0x00308493L, 0x009405b3L, 0x00848633L, // lw s0,0(a0); addi s1,ra,3; add a1,s0,s1; add a2,s1,s0
+    0x024186b3L, 0x06428713L, 0x00a00793L, 0x00000813L, // mul a3,gp,tp; addi a4,t0,100; li a5,10; li a6,0
+    0x00f80833L, 0xfff78793L, 0xfe079ce3L, 0x024000efL, // 1: add a6,a6,a5; addi a5,a5,-1; bnez a5,1b; jal 0x1070
+    0x010088b3L, 0x0226c933L, 0x00130993L, 0x01390a33L, // add a7,ra,a6; div s2,a3,sp; addi s3,t1,1; add s4,s2,s3
+    0x0000006fL, 0x00000013L, 0x00000013L, 0x00000013L, // j .
+    0x00008a93L, 0x00408b13L, 0x00008067L              // mv s5,ra; addi s6,ra,4; ret
+  )
+  val hazardEnd = 0x1060L
+  val hazardRegisters = Map(
+    1  -> 0x1050L, 2  -> 7L, 3  -> 12L, 4  -> 8L, 5  -> 4L, 6  -> 13L, 8  -> 12L, 9  -> 8L, 10 -> 0x4000L, 11 -> 20L,
+    12 -> 20L, 13 -> 96L, 14 -> 104L, 15 -> 0L, 16 -> 55L, 17 -> 0x1087L, 18 -> 13L, 19 -> 14L, 20 -> 27L,
+    21 -> 0x1050L, 22 -> 0x1054L
+  )
+
+  // Runs hazardProgram to its final jump; returns the retired instructions
+  // (pc, instruction, rd, rd_data with rd 0 for none) and the pairs retired
+  def runHazardProgram(implementation: Int): (Seq[(Long, Long, Long, Long)], Int) = {
+    val image = Paths.get(System.getProperty("user.dir"), "test_run_dir", "retire", "hazards.asmbin")
+    Files.createDirectories(image.getParent)
+    Files.write(image, hazardProgram.flatMap(w => (0 until 4).map(i => (w >> (8 * i)).toByte)).toArray)
+
+    val retired = scala.collection.mutable.ArrayBuffer[(Long, Long, Long, Long)]()
+    var pairs   = 0
+    test(new TestTopModule(image.toString, implementation = implementation))
+      .withAnnotations(TestAnnotations.annos) { dut =>
+        dut.clock.setTimeout(0)
+        dut.io.interrupt_flag.poke(0.U)
+
+        def record(retire: RetireBundle): Unit = {
+          val rd = if (retire.rd_write.peekBoolean()) retire.rd.peekInt().toLong else 0L
+          retired += ((
+            retire.pc.peekInt().toLong,
+            retire.instruction.peekInt().toLong,
+            rd,
+            if (rd != 0) retire.rd_data.peekInt().toLong else 0L
+          ))
+        }
+        var cycles = 0
+        while (!retired.exists(_._1 == hazardEnd)) {
+          dut.clock.step(4)
+          if (dut.io.retire.valid.peekBoolean()) record(dut.io.retire)
+          if (dut.io.retire_b.valid.peekBoolean()) {
+            record(dut.io.retire_b)
+            pairs += 1
+          }
+          cycles += 1
+          assert(cycles < 5000, "hazard program never reached its end")
+        }
+
+        for ((register, value) <- hazardRegisters) {
+          dut.io.regs_debug_read_address.poke(register.U)
+          assert(dut.io.regs_debug_read_data.peekInt() == value, s"x$register")
+        }
+      }
+    (retired.takeWhile(_._1 != hazardEnd).toSeq, pairs)
+  }
+
+  it should "report each retired instruction once, in program order" in {
+    test(new TestTopModule("uart.asmbin")).withAnnotations(TestAnnotations.annos) { dut =>
+      dut.clock.setTimeout(0)
+      dut.io.interrupt_flag.poke(0.U)
+
+      // The CPU runs at a quarter of the test clock: sample once per CPU cycle
+      val retired = scala.collection.mutable.ArrayBuffer[(Long, Long, Boolean, Long)]()
+      for (_ <- 0 until 12000) {
+        dut.clock.step(4)
+        if (dut.io.retire.valid.peekBoolean()) {
+          retired += ((
+            dut.io.retire.pc.peekInt().toLong,
+            dut.io.retire.instruction.peekInt().toLong,
+            dut.io.retire.rd_write.peekBoolean(),
+            dut.io.retire.rd_data.peekInt().toLong
+          ))
+        }
+      }
+      assert(retired.length > 1000, s"only ${retired.length} instructions retired")
+      assert(retired.head._1 == Parameters.EntryAddress.litValue.toLong)
+
+      retired.sliding(2).foreach { case Seq((pc, inst, rd_write, rd_data), (next_pc, _, _, _)) =>
+        val opcode = inst & 0x7f
+        // Anything but a branch, jump or system instruction falls through
+        if (!Seq(0x63L, 0x6fL, 0x67L, 0x73L).contains(opcode))
+          assert(next_pc == pc + 4, f"0x$pc%08x (0x$inst%08x) followed by 0x$next_pc%08x")
+        val rd = (inst >> 7) & 0x1f
+        if (opcode == 0x37L && rd != 0) {
+          assert(rd_write && rd_data == (inst & 0xfffff000L), f"lui at 0x$pc%08x wrote 0x$rd_data%08x")
+        }
+        if (opcode == 0x17L && rd != 0) {
+          val expected = (pc + (inst & 0xfffff000L)) & 0xffffffffL
+          assert(rd_write && rd_data == expected, f"auipc at 0x$pc%08x wrote 0x$rd_data%08x")
+        }
+      }
+    }
+  }
+
+  it should "report both instructions of a dual-issue pair in program order" in {
+    test(new TestTopModule("uart.asmbin", implementation = ImplementationType.DualIssue))
+      .withAnnotations(TestAnnotations.annos) { dut =>
+        dut.clock.setTimeout(0)
+        dut.io.interrupt_flag.poke(0.U)
+
+        val retired = scala.collection.mutable.ArrayBuffer[(Long, Long)]()
+        var pairs   = 0
+        for (_ <- 0 until 12000) {
+          dut.clock.step(4)
+          if (dut.io.retire.valid.peekBoolean()) {
+            retired += ((dut.io.retire.pc.peekInt().toLong, dut.io.retire.instruction.peekInt().toLong))
+          }
+          if (dut.io.retire_b.valid.peekBoolean()) {
+            assert(dut.io.retire.valid.peekBoolean(), "slot B retired without slot A")
+            val pc = dut.io.retire_b.pc.peekInt().toLong
+            assert(pc == dut.io.retire.pc.peekInt().toLong + 4, f"slot B at 0x$pc%08x")
+            retired += ((pc, dut.io.retire_b.instruction.peekInt().toLong))
+            pairs += 1
+          }
+        }
+        assert(retired.length > 1000, s"only ${retired.length} instructions retired")
+        assert(pairs > 0, "no instruction pair issued")
+
+        retired.sliding(2).foreach { case Seq((pc, inst), (next_pc, _)) =>
+          if (!Seq(0x63L, 0x6fL, 0x67L, 0x73L).contains(inst & 0x7f))
+            assert(next_pc == pc + 4, f"0x$pc%08x (0x$inst%08x) followed by 0x$next_pc%08x")
+        }
+      }
+  }
+
+  it should "retire the same results through dual-issue hazards as the single-issue pipeline" in {
+    val (single, _)   = runHazardProgram(ImplementationType.FiveStageFinal)
+    val (dual, pairs) = runHazardProgram(ImplementationType.DualIssue)
+    assert(pairs >= 8, s"only $pairs pairs issued")
+    assert(single.length == 54, s"${single.length} instructions retired")
+    single.zip(dual).foreach { case (a, b) =>
+      assert(a == b, s"single-issue retired $a, dual-issue $b")
+    }
+    assert(dual.length == single.length)
+  }
+}
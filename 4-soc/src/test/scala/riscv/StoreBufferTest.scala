@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+package riscv
+
+import scala.collection.mutable
+
+import chisel3._
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import riscv.core.StoreBuffer
+
+class StoreBufferTest extends AnyFlatSpec with ChiselScalatestTester {
+  behavior.of("Store Buffer")
+
+  // Initial contents of the backing memory: distinct for every word
+  def word(address: Long): Long = (address * 7 + 0x23) & 0xffffffffL
+
+  def mergeBytes(old: Long, value: Long, strobe: Int): Long =
+    (0 until 4).foldLeft(old) { (w, i) =>
+      if ((strobe >> i & 1) == 1) (w & ~(0xffL << (8 * i))) | (value & (0xffL << (8 * i))) else w
+    }
+
+  // Drives the buffer like MemoryAccess does and serves its bus side from a
+  // memory that takes one transaction at a time: granted while idle, read data
+  // in the next cycle, the write response writeLatency cycles after the grant
+  class Harness(dut: StoreBuffer, writeLatency: Int = 1) {
+    val memory      = mutable.Map[Long, Long]()
+    val events      = mutable.ArrayBuffer[(String, Long)]() // Bus transactions in order
+    var fullStalls  = 0
+    var drainStalls = 0
+    var forwards    = 0
+    // (write, address, cycles until the response)
+    private var pending: Option[(Boolean, Long, Int)] = None
+    private var next: Option[(Boolean, Long, Int)]    = None
+
+    def read(address: Long): Long = memory.getOrElse(address, word(address))
+
+    dut.io.cpu.request.poke(false.B)
+    dut.io.cpu.read.poke(false.B)
+    dut.io.cpu.write.poke(false.B)
+    dut.io.cpu.burst_length.poke(0.U)
+    dut.io.bus.busy.poke(false.B)
+    dut.io.bus.write_data_accepted.poke(false.B)
+    dut.io.bus.write_beat.poke(false.B)
+
+    // Bus inputs for this cycle; call before peeking the CPU side
+    def driveBus(): Unit = {
+      val done = pending.exists(_._3 == 0)
+      dut.io.bus.granted.poke(pending.isEmpty.B)
+      dut.io.bus.read_valid.poke((done && !pending.get._1).B)
+      dut.io.bus.write_valid.poke((done && pending.get._1).B)
+      dut.io.bus.read_data.poke(pending.map(p => read(p._2)).getOrElse(0L).U)
+      next = pending match {
+        case Some(_) if done                => None
+        case Some((write, address, cycles)) => Some((write, address, cycles - 1))
+        case None                           => None
+      }
+      if (pending.isEmpty && dut.io.bus.request.peekBoolean()) {
+        val address = dut.io.bus.address.peekInt().toLong
+        if (dut.io.bus.read.peekBoolean()) {
+          events += (("read", address))
+          next = Some((false, address, 0))
+        } else if (dut.io.bus.write.peekBoolean()) {
+          val strobe = dut.io.bus.write_strobe.map(_.peekBoolean()).zipWithIndex.map { case (b, i) =>
+            if (b) 1 << i else 0
+          }.sum
+          memory(address) = mergeBytes(read(address), dut.io.bus.write_data.peekInt().toLong, strobe)
+          events += (("write", address))
+          next = Some((true, address, writeLatency - 1))
+        }
+      }
+      if (dut.io.full_stall.peekBoolean()) fullStalls += 1
+      if (dut.io.drain_stall.peekBoolean()) drainStalls += 1
+      if (dut.io.forwarded.peekBoolean()) forwards += 1
+    }
+
+    def endCycle(): Unit = {
+      dut.clock.step()
+      pending = next
+    }
+
+    // Runs until every buffered store is written
+    def drain(): Unit = {
+      var cycles = 0
+      while (!dut.io.empty.peekBoolean() || pending.nonEmpty) {
+        driveBus()
+        endCycle()
+        cycles += 1
+        assert(cycles < 200, "store buffer never drained")
+      }
+    }
+
+    // Runs one access to completion; returns (read data, stall cycles)
+    def access(address: Long, write: Boolean, data: Long, strobe: Int): (Long, Int) = {
+      dut.io.cpu.request.poke(true.B)
+      dut.io.cpu.read.poke((!write).B)
+      dut.io.cpu.write.poke(write.B)
+      dut.io.cpu.address.poke(address.U)
+      dut.io.cpu.write_data.poke(data.U)
+      for (i <- 0 until 4) dut.io.cpu.write_strobe(i).poke(((strobe >> i & 1) == 1).B)
+      var accepted             = false
+      var result: Option[Long] = None
+      var cycles               = 0
+      while (result.isEmpty) {
+        driveBus()
+        val done = if (write) dut.io.cpu.write_valid.peekBoolean() else dut.io.cpu.read_valid.peekBoolean()
+        if (accepted || dut.io.cpu.granted.peekBoolean()) {
+          accepted = true
+          if (done) result = Some(dut.io.cpu.read_data.peekInt().toLong)
+        }
+        endCycle()
+        if (accepted) {
+          dut.io.cpu.read.poke(false.B)
+          dut.io.cpu.write.poke(false.B)
+        }
+        cycles += 1
+        assert(cycles < 200, f"access to 0x$address%08x never completed")
+      }
+      dut.io.cpu.request.poke(false.B)
+      dut.io.cpu.write.poke(false.B)
+      (result.get, cycles - 1)
+    }
+
+    def load(address: Long): (Long, Int) = access(address, write = false, 0, 0)
+    def store(address: Long, data: Long, strobe: Int = 0xf): Int =
+      access(address, write = true, data, strobe)._2
+  }
+
+  it should "complete stores at once and write them in program order" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 3)
+      for (i <- 0 until 4) {
+        assert(h.store(0x8100 + 8 * i, i + 1) == 0, s"store $i stalled")
+      }
+      dut.io.empty.expect(false.B)
+      h.drain()
+      assert(h.events == (0 until 4).map(i => ("write", 0x8100L + 8 * i)))
+      for (i <- 0 until 4) assert(h.read(0x8100 + 8 * i) == i + 1)
+    }
+  }
+
+  it should "stall a store only while every entry is taken" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 10)
+      for (i <- 0 until 4) assert(h.store(0x8100 + 8 * i, i) == 0)
+      assert(h.store(0x8200, 0x55L) > 0, "store to a full buffer completed at once")
+      assert(h.fullStalls > 0)
+      h.drain()
+      assert(h.events.map(_._2) == Seq(0x8100L, 0x8108L, 0x8110L, 0x8118L, 0x8200L))
+    }
+  }
+
+  it should "merge a store into the youngest entry for its word" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 10)
+      h.store(0x8100, 0x1L)
+      h.store(0x8200, 0x11223344L)
+      assert(h.store(0x8200, 0xaaL, strobe = 0x1) == 0)
+      h.drain()
+      assert(h.events == Seq(("write", 0x8100L), ("write", 0x8200L)))
+      assert(h.read(0x8200) == 0x112233aaL)
+    }
+  }
+
+  it should "never merge stores to the simulator's control page" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 10)
+      h.store(0x8100, 0x1L)
+      h.store(0x10c, 0x1L)
+      h.store(0x10c, 0x2L)
+      h.drain()
+      assert(h.events == Seq(("write", 0x8100L), ("write", 0x10cL), ("write", 0x10cL)))
+    }
+  }
+
+  it should "forward a buffered word and hold a load that needs the other bytes" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 10)
+      h.store(0x8300, 0xcafef00dL)
+      assert(h.load(0x8300) == ((0xcafef00dL, 0)))
+      assert(h.forwards == 1)
+      h.store(0x8400, 0x0000ab00L, strobe = 0x2)
+      val (data, stalls) = h.load(0x8400)
+      assert(data == mergeBytes(word(0x8400), 0x0000ab00L, 0x2))
+      assert(stalls > 0 && h.drainStalls > 0)
+      assert(h.events.indexOf(("write", 0x8400L)) < h.events.indexOf(("read", 0x8400L)))
+      assert(h.forwards == 1)
+    }
+  }
+
+  it should "let loads of other words go ahead of buffered stores" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 3)
+      h.store(0x8600, 0x6L)
+      h.store(0x8608, 0x7L)
+      h.store(0x8610, 0x8L)
+      assert(h.load(0x8700)._1 == word(0x8700))
+      h.drain()
+      // The first store was on the bus already; the load passes the others
+      assert(h.events == Seq(("write", 0x8600L), ("read", 0x8700L), ("write", 0x8608L), ("write", 0x8610L)))
+    }
+  }
+
+  it should "keep MMIO stores in order and an MMIO load behind them" in {
+    test(new StoreBuffer(4)).withAnnotations(TestAnnotations.annos) { dut =>
+      val h = new Harness(dut, writeLatency = 3)
+      h.memory(0x40000000L) = 1
+      assert(h.store(0x20000010L, 0x1L) == 0)
+      assert(h.store(0x20000010L, 0x2L) == 0)
+      assert(h.store(0x20000010L, 0x3L) == 0)
+      assert(h.load(0x40000000L)._1 == 1)
+      assert(h.drainStalls > 0)
+      assert(h.events == Seq.fill(3)(("write", 0x20000010L)) :+ (("read", 0x40000000L)))
+      assert(h.read(0x20000010L) == 3)
+      dut.io.empty.expect(true.B)
+    }
+  }
+}
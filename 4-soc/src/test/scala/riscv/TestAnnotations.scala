@@ -4,11 +4,22 @@
 
 package riscv
 
+import java.nio.charset.StandardCharsets
 import java.nio.file.Files
 import java.nio.file.Paths
+import java.security.MessageDigest
+import java.util.concurrent.ConcurrentHashMap
 
+import chisel3.stage.ChiselStage
+import chisel3.Module
+import chisel3.RawModule
+import chiseltest.simulator.CachingAnnotation
+import chiseltest.ChiselScalatestTester
 import chiseltest.VerilatorBackendAnnotation
 import chiseltest.WriteVcdAnnotation
+import firrtl.annotations.Annotation
+import firrtl.options.TargetDirAnnotation
+import org.scalatest.TestSuite
 object VerilatorEnabler {
   val annos = if (sys.env.contains("Path")) {
     if (
@@ -50,3 +61,78 @@ object WriteVcdEnabler {
 object TestAnnotations {
   val annos = VerilatorEnabler.annos ++ WriteVcdEnabler.annos
 }
+
+/**
+ * Compiled Verilator models shared between tests
+ *
+ * A model lives in test_run_dir/cached/<hash of the elaborated CHIRRTL>, so
+ * every test of an identical DUT, in any suite, runs on one build:
+ * chiseltest's CachingAnnotation reuses the binary while the circuit and its
+ * annotations are unchanged and rebuilds it otherwise. One lock per model
+ * keeps suites running in parallel from rebuilding a model another is using.
+ *
+ * A DUT that names its configuration (cachedSharedTest) is keyed on that name
+ * instead, without the extra elaboration.
+ */
+object ModelCache {
+  private val locks = new ConcurrentHashMap[String, AnyRef]()
+
+  def key(dut: => RawModule): String = hash(ChiselStage.emitChirrtl(dut))
+
+  def key(configuration: String): String = hash(configuration)
+
+  private def hash(text: String): String =
+    MessageDigest
+      .getInstance("SHA-256")
+      .digest(text.getBytes(StandardCharsets.UTF_8))
+      .take(12)
+      .map(b => f"$b%02x")
+      .mkString
+
+  def directory(key: String): String = s"test_run_dir/cached/$key"
+
+  def lock(key: String): AnyRef = locks.computeIfAbsent(key, _ => new AnyRef)
+}
+
+/**
+ * test() on a cached model when the Verilator backend is enabled. Treadle
+ * runs, and WRITE_VCD runs (each test keeps its own waveform directory), go
+ * through test() unchanged.
+ */
+trait CachedModelTester extends ChiselScalatestTester { this: TestSuite =>
+  def cachedTest[T <: Module](dut: => T, annos: Seq[Annotation] = TestAnnotations.annos)(body: T => Any): Unit = {
+    if (!annos.contains(VerilatorBackendAnnotation) || annos.contains(WriteVcdAnnotation)) {
+      test(dut).withAnnotations(annos)(body)
+    } else {
+      val key = ModelCache.key(dut)
+      ModelCache.lock(key).synchronized {
+        test(dut).withAnnotations(annos ++ Seq(CachingAnnotation, TargetDirAnnotation(ModelCache.directory(key))))(body)
+      }
+    }
+  }
+
+  /**
+   * cachedTest() for DUTs that elaborate to the same circuit under one
+   * configuration name, such as the compliance top, whose program only
+   * reaches the model through a shared $readmemh image. Everything runs under
+   * the model's lock, with the Verilator backend or not: setup (writing that
+   * image), the single elaboration by test() that rewrites the image's
+   * verilog/ copy, and the simulation that loads it. So no other test of the
+   * configuration can swap the program in between.
+   */
+  def cachedSharedTest[T <: Module](
+      configuration: String,
+      dut: => T,
+      annos: Seq[Annotation] = TestAnnotations.annos
+  )(setup: => Unit)(body: T => Any): Unit = {
+    val key = ModelCache.key(configuration)
+    ModelCache.lock(key).synchronized {
+      setup
+      if (!annos.contains(VerilatorBackendAnnotation) || annos.contains(WriteVcdAnnotation)) {
+        test(dut).withAnnotations(annos)(body)
+      } else {
+        test(dut).withAnnotations(annos ++ Seq(CachingAnnotation, TargetDirAnnotation(ModelCache.directory(key))))(body)
+      }
+    }
+  }
+}
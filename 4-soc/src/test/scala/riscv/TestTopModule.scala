@@ -10,10 +10,24 @@ import peripheral.InstructionROM
 import peripheral.Memory
 import peripheral.ROMLoader
 import riscv.core.CPU
+import riscv.core.DebugWriteBundle
+import riscv.core.RetireBundle
 
 // Simplified test harness for RISCOF compliance tests
-// Uses AXI4-Lite to connect CPU to Memory, matching the 4-soc architecture
-class TestTopModule(exeFilename: String) extends Module {
+// Uses AXI4-Lite to connect CPU to Memory, matching the 4-soc architecture.
+// icacheLines = 0 fetches from the zero-latency instruction port instead of
+// through the instruction cache; dcacheLines = 0 leaves out the data cache, so
+// that mem_debug_read_data sees every store. romWords fixes the program ROM
+// size (InstructionROM), 0 fits it to the program. implementation selects the
+// pipeline variant (ImplementationType), and dataTCMBytes sizes the data TCM.
+class TestTopModule(
+    exeFilename: String,
+    icacheLines: Int = Parameters.ICacheLines,
+    dcacheLines: Int = Parameters.DCacheLines,
+    romWords: Int = 0,
+    implementation: Int = ImplementationType.FiveStageFinal,
+    dataTCMBytes: Int = Parameters.DataTCMBytes
+) extends Module {
   val io = IO(new Bundle {
     val regs_debug_read_address = Input(UInt(Parameters.PhysicalRegisterAddrWidth))
     val mem_debug_read_address  = Input(UInt(Parameters.AddrWidth))
@@ -22,10 +36,12 @@ class TestTopModule(exeFilename: String) extends Module {
     val csr_debug_read_address  = Input(UInt(Parameters.CSRRegisterAddrWidth))
     val csr_debug_read_data     = Output(UInt(Parameters.DataWidth))
     val interrupt_flag          = Input(UInt(Parameters.InterruptFlagWidth))
+    val retire                  = Output(new RetireBundle)
+    val retire_b                = Output(new RetireBundle)
   })
 
   val mem             = Module(new Memory(8192))
-  val instruction_rom = Module(new InstructionROM(exeFilename))
+  val instruction_rom = Module(new InstructionROM(exeFilename, romWords))
   val rom_loader      = Module(new ROMLoader(instruction_rom.capacity))
 
   rom_loader.io.rom_data     := instruction_rom.io.data
@@ -41,13 +57,14 @@ class TestTopModule(exeFilename: String) extends Module {
   CPU_clkdiv := CPU_next
 
   withClock(CPU_tick.asClock) {
-    val cpu = Module(new CPU)
+    val cpu = Module(new CPU(implementation, icacheLines, dcacheLines, dataTCMBytes))
 
-    // AXI4-Lite slave adapter for memory
-    val mem_slave = Module(new AXI4LiteSlave(Parameters.AddrBits, Parameters.DataBits))
+    // AXI4 slave adapter for memory (serves the caches' line bursts)
+    val mem_slave = Module(new AXI4LiteSlave(Parameters.AddrBits, Parameters.DataBits, burst = true))
 
     cpu.io.debug_read_address     := 0.U
     cpu.io.csr_debug_read_address := 0.U
+    cpu.io.debug_write            := 0.U.asTypeOf(new DebugWriteBundle)
     cpu.io.instruction_valid      := rom_loader.io.load_finished
 
     // Instruction fetch from memory
@@ -86,6 +103,8 @@ class TestTopModule(exeFilename: String) extends Module {
     io.regs_debug_read_data       := cpu.io.debug_read_data
     cpu.io.csr_debug_read_address := io.csr_debug_read_address
     io.csr_debug_read_data        := cpu.io.csr_debug_read_data
+    io.retire                     := cpu.io.retire
+    io.retire_b                   := cpu.io.retire_b
 
     // Drive memory_bundle INPUT signals (not used - actual memory goes through AXI4)
     // These must be driven to avoid FIRRTL RefNotInitializedException
@@ -95,6 +114,16 @@ class TestTopModule(exeFilename: String) extends Module {
     cpu.io.memory_bundle.write_data_accepted := false.B
     cpu.io.memory_bundle.busy                := false.B
     cpu.io.memory_bundle.granted             := true.B
+    cpu.io.memory_bundle.write_beat          := false.B
+
+    // No DMA controller in this harness
+    cpu.io.dma_bundle.request      := false.B
+    cpu.io.dma_bundle.read         := false.B
+    cpu.io.dma_bundle.write        := false.B
+    cpu.io.dma_bundle.address      := 0.U
+    cpu.io.dma_bundle.write_data   := 0.U
+    cpu.io.dma_bundle.write_strobe := VecInit(Seq.fill(Parameters.WordSize)(false.B))
+    cpu.io.dma_bundle.burst_length := 0.U
   }
 
   mem.io.debug_read_address := io.mem_debug_read_address
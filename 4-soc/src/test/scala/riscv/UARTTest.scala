@@ -14,7 +14,7 @@ import peripheral.Tx
 import peripheral.Uart
 import peripheral.UartConstants._
 
-class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
+class UARTTest extends AnyFlatSpec with CachedModelTester {
   // Test parameters: slow baud rate for faster simulation
   val testFrequency = 1000                         // 1 kHz clock
   val testBaudRate  = 100                          // 100 baud (10 clock cycles per bit)
@@ -23,14 +23,14 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   behavior.of("UART Tx")
 
   it should "be ready when idle" in {
-    test(new Tx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Tx(testFrequency, testBaudRate)) { dut =>
       dut.io.channel.ready.expect(true.B)
       dut.io.txd.expect(1.U) // Idle high
     }
   }
 
   it should "transmit start bit, data, and stop bits" in {
-    test(new Tx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Tx(testFrequency, testBaudRate)) { dut =>
       // Send byte 0x55 (01010101) - good for testing bit transitions
       dut.io.channel.valid.poke(true.B)
       dut.io.channel.bits.poke(0x55.U)
@@ -57,7 +57,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "not accept data when busy" in {
-    test(new Tx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Tx(testFrequency, testBaudRate)) { dut =>
       // Start transmission
       dut.io.channel.valid.poke(true.B)
       dut.io.channel.bits.poke(0xaa.U)
@@ -76,7 +76,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   behavior.of("UART Rx")
 
   it should "signal valid when byte received" in {
-    test(new Rx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Rx(testFrequency, testBaudRate)) { dut =>
       // Initially idle (high)
       dut.io.rxd.poke(1.U)
       dut.io.channel.valid.expect(false.B)
@@ -112,7 +112,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "receive 0x00 byte correctly" in {
-    test(new Rx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Rx(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -136,7 +136,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "receive 0xFF byte correctly" in {
-    test(new Rx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Rx(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -162,14 +162,14 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   behavior.of("UART Buffer")
 
   it should "be ready when empty" in {
-    test(new Buffer).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Buffer) { dut =>
       dut.io.in.ready.expect(true.B)
       dut.io.out.valid.expect(false.B)
     }
   }
 
   it should "store and forward one byte" in {
-    test(new Buffer).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Buffer) { dut =>
       // Write data to buffer
       dut.io.in.valid.poke(true.B)
       dut.io.in.bits.poke(0x42.U)
@@ -193,7 +193,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "not accept data when full" in {
-    test(new Buffer).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Buffer) { dut =>
       // Fill buffer
       dut.io.in.valid.poke(true.B)
       dut.io.in.bits.poke(0x42.U)
@@ -212,7 +212,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   behavior.of("BufferedTx")
 
   it should "accept byte into buffer while transmitting" in {
-    test(new BufferedTx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new BufferedTx(testFrequency, testBaudRate)) { dut =>
       // Initially ready (buffer empty)
       dut.io.channel.ready.expect(true.B)
 
@@ -247,7 +247,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "transmit consecutive bytes" in {
-    test(new BufferedTx(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new BufferedTx(testFrequency, testBaudRate)) { dut =>
       // Send first byte
       dut.io.channel.valid.poke(true.B)
       dut.io.channel.bits.poke(0xaa.U)
@@ -282,6 +282,29 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
+  it should "stay busy until the whole frame has left the line" in {
+    cachedTest(new BufferedTx(testFrequency, testBaudRate)) { dut =>
+      dut.io.busy.expect(false.B)
+
+      // 0xFF: after the start bit the line stays high for the rest of the frame
+      dut.io.channel.valid.poke(true.B)
+      dut.io.channel.bits.poke(0xff.U)
+      dut.clock.step()
+      dut.io.channel.valid.poke(false.B)
+
+      val maxWait = 200
+      var cycles  = 0
+      while (dut.io.busy.peekBoolean() && cycles < maxWait) {
+        dut.clock.step()
+        cycles += 1
+      }
+      assert(cycles >= TX_FRAME_BITS * bitCycles, s"busy dropped after $cycles cycles, mid-frame")
+      assert(cycles < maxWait, s"busy still set after $maxWait cycles")
+      dut.io.txd.expect(1.U)
+      dut.io.channel.ready.expect(true.B)
+    }
+  }
+
   // ==================== Integration Tests ====================
   // Test the full Uart module with AXI4-Lite interface
 
@@ -344,7 +367,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "read baud rate from MMIO register" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       // Initialize
       dut.io.rxd.poke(1.U) // Idle high
       dut.clock.step(5)
@@ -356,7 +379,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "show TX ready in STATUS register when idle" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -367,7 +390,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "transmit byte via TX_DATA register" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -388,7 +411,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "set RX valid in STATUS when data received" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -419,7 +442,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "generate interrupt on RX and clear on read" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -451,7 +474,7 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
   }
 
   it should "allow manual interrupt control via INTERRUPT register" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       dut.io.rxd.poke(1.U)
       dut.clock.step(5)
 
@@ -470,10 +493,96 @@ class UARTTest extends AnyFlatSpec with ChiselScalatestTester {
     }
   }
 
+  it should "enqueue bytes injected on the RX sideband" in {
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
+      dut.io.rxd.poke(1.U)
+      dut.io.rx_inject.valid.poke(false.B)
+      dut.clock.step(5)
+
+      // Inject one byte straight into the RX FIFO (no serial framing)
+      dut.io.rx_inject.ready.expect(true.B)
+      dut.io.rx_inject.valid.poke(true.B)
+      dut.io.rx_inject.bits.poke(0x5a.U)
+      dut.clock.step()
+      dut.io.rx_inject.valid.poke(false.B)
+
+      // Same interrupt and STATUS behavior as a byte received on rxd
+      dut.io.signal_interrupt.expect(true.B)
+      val status = axiRead(dut, REG_STATUS)
+      assert((status & 0x02) != 0, s"RX should be valid after injection, status=$status")
+      val rxData = axiRead(dut, REG_RX_DATA)
+      assert((rxData & 0xff) == 0x5a, s"Expected injected 0x5A, got 0x${(rxData & 0xff).toString(16)}")
+    }
+  }
+
+  it should "raise irq only for enabled RX and TX conditions" in {
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
+      dut.io.rxd.poke(1.U)
+      dut.io.rx_inject.valid.poke(false.B)
+      dut.clock.step(5)
+
+      // TX ready but nothing enabled
+      dut.io.irq.expect(false.B)
+      axiWrite(dut, REG_IRQ_EN, 0x2)
+      dut.io.irq.expect(true.B, "idle transmitter with TX enable")
+      assert(axiRead(dut, REG_IRQ_EN) == 0x2)
+      axiWrite(dut, REG_TX_DATA, 0x41)
+      axiWrite(dut, REG_TX_DATA, 0x42)
+      dut.io.irq.expect(false.B, "TX buffer full")
+
+      // RX enable: high while the FIFO holds bytes
+      axiWrite(dut, REG_IRQ_EN, 0x1)
+      dut.io.irq.expect(false.B)
+      dut.io.rx_inject.valid.poke(true.B)
+      dut.io.rx_inject.bits.poke(0x33.U)
+      dut.clock.step()
+      dut.io.rx_inject.valid.poke(false.B)
+      dut.io.irq.expect(true.B, "RX FIFO non-empty")
+      assert((axiRead(dut, REG_RX_DATA) & 0xff) == 0x33)
+      dut.io.irq.expect(false.B, "RX FIFO drained")
+    }
+  }
+
+  it should "pulse the TX sideband once per byte written" in {
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
+      dut.io.rxd.poke(1.U)
+      dut.clock.step(5)
+
+      // Issue the TX_DATA write by hand so every cycle can be observed
+      dut.io.channels.write_address_channel.AWVALID.poke(true.B)
+      dut.io.channels.write_address_channel.AWADDR.poke(REG_TX_DATA.U)
+      dut.io.channels.write_address_channel.AWPROT.poke(0.U)
+      dut.io.channels.write_data_channel.WVALID.poke(true.B)
+      dut.io.channels.write_data_channel.WDATA.poke(0xa5.U)
+      dut.io.channels.write_data_channel.WSTRB.poke(0xf.U)
+      dut.io.channels.write_response_channel.BREADY.poke(true.B)
+
+      var pulses = 0
+      var cycles = 0
+      while (!dut.io.channels.write_response_channel.BVALID.peekBoolean() && cycles < 20) {
+        if (dut.io.tx_byte.valid.peekBoolean()) {
+          dut.io.tx_byte.bits.expect(0xa5.U)
+          pulses += 1
+        }
+        dut.clock.step()
+        cycles += 1
+      }
+      dut.io.channels.write_address_channel.AWVALID.poke(false.B)
+      dut.io.channels.write_data_channel.WVALID.poke(false.B)
+      for (_ <- 0 until 5) {
+        if (dut.io.tx_byte.valid.peekBoolean()) pulses += 1
+        dut.clock.step()
+      }
+      dut.io.channels.write_response_channel.BREADY.poke(false.B)
+
+      assert(pulses == 1, s"Expected exactly one TX sideband pulse, saw $pulses")
+    }
+  }
+
   behavior.of("Uart TX/RX Loopback")
 
   it should "receive transmitted data in loopback" in {
-    test(new Uart(testFrequency, testBaudRate)).withAnnotations(TestAnnotations.annos) { dut =>
+    cachedTest(new Uart(testFrequency, testBaudRate)) { dut =>
       // Connect TX to RX for loopback (internal to test)
       // We'll manually feed TX output to RX input
 
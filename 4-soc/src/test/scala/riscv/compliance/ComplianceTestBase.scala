@@ -6,6 +6,9 @@ package riscv.compliance
 
 import java.io.File
 import java.io.PrintWriter
+import java.nio.file.Files
+import java.nio.file.Paths
+import java.nio.file.StandardCopyOption
 
 import scala.sys.process._
 
@@ -13,6 +16,9 @@ import chisel3._
 import chiseltest._
 import firrtl.annotations.Annotation
 import org.scalatest.flatspec.AnyFlatSpec
+import riscv.CachedModelTester
+import riscv.ImplementationType
+import riscv.Parameters
 import riscv.TestTopModule
 
 // RISCOF Compliance Test Framework for MyCPU 4-soc
@@ -114,14 +120,21 @@ object ElfSignatureExtractor {
   }
 }
 
-abstract class ComplianceTestBase extends AnyFlatSpec with ChiselScalatestTester {
+abstract class ComplianceTestBase extends AnyFlatSpec with CachedModelTester {
+
+  // Every test runs on one compiled model (CachedModelTester): the program is
+  // copied to the same image file and the ROM always holds the 7168 words of
+  // RAM above the entry address, so the tests elaborate to the same design
+  // and only the image that $readmemh loads at start-up differs.
+  val ROMWords = 8192 - 1024
 
   /**
    * Run a single RISCOF compliance test on the MyCPU 4-soc implementation.
    *
    * Test execution sequence:
    * 1. Extract signature region boundaries from ELF symbol table
-   * 2. Instantiate TestTopModule with test binary
+   * 2. Under the model's lock, copy the test binary to the shared image and
+   *    instantiate TestTopModule
    * 3. Execute test for sufficient cycles (100K cycles with 4:1 clock ratio = 400K master cycles)
    * 4. Read signature memory region via debug interface
    * 5. Write signature data to file for RISCOF validation
@@ -147,11 +160,35 @@ abstract class ComplianceTestBase extends AnyFlatSpec with ChiselScalatestTester
     val testDir            = elfPath.getParent
     val absoluteAsmbinPath = testDir.resolve(asmbinFile).toAbsolutePath.toString
 
-    // Instantiate 4-soc CPU (pipelined with AXI4-Lite)
-    test(new TestTopModule(absoluteAsmbinPath)).withAnnotations(annos) { c =>
+    val image = Paths.get(System.getProperty("user.dir"), "test_run_dir", "compliance", "compliance.asmbin")
+    // Program words as InstructionROM counts them (three trailing NOPs)
+    val programWords = (Files.size(Paths.get(absoluteAsmbinPath)) / 4).toInt + 3
+
+    // Instantiate 4-soc CPU (pipelined with AXI4-Lite). No instruction cache:
+    // the cycle budget below predates it, and InstructionCacheTest covers it.
+    // The dual-issue pipeline (MYCPU_PARAMS=Implementation=4, make
+    // compliance-dual) keeps it, without which it never pairs. The data cache
+    // and store buffer are as configured (make compliance-cached turns them
+    // on); the FENCE.I in RVMODEL_HALT drains and writes them back before the
+    // signature is read from memory.
+    val implementation = Parameters.Implementation
+    val icacheLines    = if (implementation == ImplementationType.DualIssue) Parameters.ICacheLines else 0
+    val dcacheLines    = Parameters.DCacheLines
+    val params         = sys.env.getOrElse("MYCPU_PARAMS", "")
+    val configuration  = s"compliance $image $icacheLines $dcacheLines $ROMWords $implementation $params"
+    def dut            = new TestTopModule(image.toString, icacheLines, dcacheLines, ROMWords, implementation)
+    // The image is copied, and elaborated into the model, under its lock
+    cachedSharedTest(configuration, dut, annos) {
+      Files.createDirectories(image.getParent)
+      Files.copy(Paths.get(absoluteAsmbinPath), image, StandardCopyOption.REPLACE_EXISTING)
+    } { c =>
       // Disable clock timeout - some tests require many cycles
       c.clock.setTimeout(0)
 
+      // ROMLoader copies the whole ROM before the CPU starts; the padding
+      // costs one cycle a word, stepped here to keep each test's CPU budget
+      if (programWords < ROMWords) c.clock.step(ROMWords - programWords)
+
       // Execute test program for sufficient cycles
       // 4-soc uses 4:1 clock divider, so 50K iterations * 4 = 200K CPU cycles
       for (_ <- 1 to 50) {
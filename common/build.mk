@@ -8,6 +8,40 @@
 #   - check-toolchain: Validate RISC-V toolchain
 #   - check-verilator: Validate Verilator installation
 #   - check-deps: Validate all dependencies
+#
+# Also exports SIM_COMMON_DIR, the directory of the C++ headers shared by the
+# Verilator harnesses (sparse memory model, ...). Pass it to verilator as
+# -CFLAGS "-I$(SIM_COMMON_DIR)".
+
+SIM_COMMON_DIR := $(abspath $(dir $(lastword $(MAKEFILE_LIST))))/sim
+
+# Waveform format of the Verilator harnesses. "make verilator TRACE_FORMAT=fst"
+# builds a model that writes FST (-fst <file>) instead of VCD (-vcd <file>).
+# Pass $(VERILATOR_TRACE) to verilator and add $(SIM_TRACE_CFLAGS) to -CFLAGS.
+TRACE_FORMAT ?= vcd
+ifeq ($(TRACE_FORMAT),fst)
+VERILATOR_TRACE := --trace-fst
+SIM_TRACE_CFLAGS := -DSIM_TRACE_FST
+else
+VERILATOR_TRACE := --trace
+SIM_TRACE_CFLAGS :=
+endif
+
+# "make verilator HOST_PROFILE=1" builds a 2-mmio-trap or 4-soc harness that
+# reports where host time goes (eval, memory, peripherals, I/O) with each
+# progress line and at exit. Add $(SIM_HOST_PROFILE_CFLAGS) to -CFLAGS.
+HOST_PROFILE ?= 0
+ifeq ($(HOST_PROFILE),1)
+SIM_HOST_PROFILE_CFLAGS := -DSIM_HOST_PROFILE
+else
+SIM_HOST_PROFILE_CFLAGS :=
+endif
+
+# Backend of "make compliance": sbt runs the tests through ChiselTest, while
+# verilator builds the stage's VTop once and runs one test per core
+# (MYCPU_JOBS=<n> limits the count), e.g. "make compliance
+# COMPLIANCE_BACKEND=verilator".
+COMPLIANCE_BACKEND ?= sbt
 
 # RISCOF validation - checks if riscof is available before compliance tests
 .PHONY: check-riscof
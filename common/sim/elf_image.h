@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Loadable image of a 32-bit little-endian RISC-V ELF, so the harnesses can
+// run the linker's output directly instead of an objcopy'd .asmbin.
+//
+// Every PT_LOAD segment is copied to its physical address and the part past
+// its file size (.bss, .sbss) is zeroed host-side. The cores all start at a
+// fixed reset vector; an entry point elsewhere is reached through a two-word
+// lui/jalr trampoline written at the reset vector, which must then lie
+// outside every segment. symbol() answers address lookups such as
+// begin_signature, end_signature and tohost from the same symbol table.
+
+#pragma once
+
+#include <elf.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sparse_memory.h"
+
+class ElfImage
+{
+public:
+    struct Segment {
+        uint32_t address;
+        uint32_t file_size;
+        uint32_t memory_size;  // file_size plus the zero-filled tail
+        uint32_t offset;
+    };
+
+    // True if the file starts with the ELF magic; raw images are loaded as
+    // before.
+    static bool is_elf(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[SELFMAG];
+        return file.read(magic, SELFMAG) &&
+               std::memcmp(magic, ELFMAG, SELFMAG) == 0;
+    }
+
+    explicit ElfImage(const std::string &filename) : name(filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Could not open file " + filename);
+        image.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+
+        Elf32_Ehdr ehdr;
+        if (image.size() < sizeof(ehdr))
+            throw std::runtime_error(filename + ": not an ELF file");
+        std::memcpy(&ehdr, image.data(), sizeof(ehdr));
+        if (std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+            ehdr.e_ident[EI_CLASS] != ELFCLASS32 ||
+            ehdr.e_ident[EI_DATA] != ELFDATA2LSB || ehdr.e_machine != EM_RISCV)
+            throw std::runtime_error(
+                filename + ": not a 32-bit little-endian RISC-V ELF file");
+        entry_point = ehdr.e_entry;
+
+        if (ehdr.e_phentsize != sizeof(Elf32_Phdr) ||
+            ehdr.e_phoff + size_t(ehdr.e_phnum) * sizeof(Elf32_Phdr) >
+                image.size())
+            throw std::runtime_error(filename + ": bad program header table");
+        for (size_t i = 0; i < ehdr.e_phnum; i++) {
+            Elf32_Phdr ph;
+            std::memcpy(&ph,
+                        image.data() + ehdr.e_phoff + i * sizeof(Elf32_Phdr),
+                        sizeof(ph));
+            if (ph.p_type != PT_LOAD || !ph.p_memsz)
+                continue;
+            if (ph.p_filesz > ph.p_memsz ||
+                size_t(ph.p_offset) + ph.p_filesz > image.size())
+                throw std::runtime_error(filename + ": bad PT_LOAD segment");
+            segs.push_back({ph.p_paddr, ph.p_filesz, ph.p_memsz, ph.p_offset});
+        }
+        if (segs.empty())
+            throw std::runtime_error(filename + ": no PT_LOAD segments");
+
+        read_symbols(ehdr);
+    }
+
+    uint32_t entry() const { return entry_point; }
+    const std::vector<Segment> &segments() const { return segs; }
+
+    // Address of a defined symbol; false if the ELF has none by that name
+    bool symbol(const std::string &symbol_name, uint32_t &address) const
+    {
+        auto it = syms.find(symbol_name);
+        if (it == syms.end())
+            return false;
+        address = it->second;
+        return true;
+    }
+
+    // Copies the segments into memory, zero-fills their tails and, if the
+    // entry point differs from reset_vector, writes the trampoline there.
+    // Returns the number of bytes copied from the file.
+    size_t load(SparseMemory &memory, uint32_t reset_vector) const
+    {
+        size_t copied = 0;
+        for (const Segment &s : segs) {
+            if (!memory.contains(s.address) ||
+                s.memory_size > memory.size() - s.address)
+                throw std::runtime_error(
+                    name + ": segment at 0x" + hex(s.address) +
+                    " does not fit in " + std::to_string(memory.size()) +
+                    " bytes of memory");
+            memory.copy_in(s.address, image.data() + s.offset, s.file_size);
+            memory.zero(s.address + s.file_size, s.memory_size - s.file_size);
+            copied += s.file_size;
+        }
+
+        if (entry_point == reset_vector)
+            return copied;
+        for (const Segment &s : segs) {
+            if (reset_vector < s.address + s.memory_size &&
+                reset_vector + 8 > s.address)
+                throw std::runtime_error(
+                    name + ": entry point 0x" + hex(entry_point) +
+                    " but the core starts inside a segment at 0x" +
+                    hex(reset_vector));
+        }
+        // lui t0, %hi(entry); jalr zero, %lo(entry)(t0)
+        uint32_t hi = (entry_point + 0x800) & 0xFFFFF000u;
+        uint32_t lo = (entry_point - hi) & 0xFFFu;
+        uint32_t trampoline[2] = {hi | (5u << 7) | 0x37u,
+                                  (lo << 20) | (5u << 15) | 0x67u};
+        memory.copy_in(reset_vector, trampoline, sizeof(trampoline));
+        return copied;
+    }
+
+private:
+    std::string name;
+    std::vector<char> image;
+    std::vector<Segment> segs;
+    std::map<std::string, uint32_t> syms;
+    uint32_t entry_point = 0;
+
+    static std::string hex(uint32_t value)
+    {
+        char text[9];
+        snprintf(text, sizeof(text), "%08x", value);
+        return text;
+    }
+
+    void read_symbols(const Elf32_Ehdr &ehdr)
+    {
+        if (!ehdr.e_shoff)
+            return;
+        if (ehdr.e_shentsize != sizeof(Elf32_Shdr) ||
+            ehdr.e_shoff + size_t(ehdr.e_shnum) * sizeof(Elf32_Shdr) >
+                image.size())
+            throw std::runtime_error(name + ": bad section header table");
+        std::vector<Elf32_Shdr> sections(ehdr.e_shnum);
+        std::memcpy(sections.data(), image.data() + ehdr.e_shoff,
+                    sections.size() * sizeof(Elf32_Shdr));
+
+        for (const Elf32_Shdr &symtab : sections) {
+            if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= sections.size())
+                continue;
+            const Elf32_Shdr &strtab = sections[symtab.sh_link];
+            if (symtab.sh_offset + symtab.sh_size > image.size() ||
+                strtab.sh_offset + strtab.sh_size > image.size())
+                throw std::runtime_error(name + ": bad symbol table");
+
+            size_t count = symtab.sh_size / sizeof(Elf32_Sym);
+            for (size_t i = 0; i < count; i++) {
+                Elf32_Sym sym;
+                std::memcpy(&sym,
+                            image.data() + symtab.sh_offset +
+                                i * sizeof(Elf32_Sym),
+                            sizeof(sym));
+                if (sym.st_shndx == SHN_UNDEF || sym.st_name >= strtab.sh_size)
+                    continue;
+                const char *text = image.data() + strtab.sh_offset + sym.st_name;
+                std::string symbol_name(
+                    text, strnlen(text, strtab.sh_size - sym.st_name));
+                // Globals win over a local of the same name
+                if (!symbol_name.empty() &&
+                    (ELF32_ST_BIND(sym.st_info) != STB_LOCAL ||
+                     !syms.count(symbol_name)))
+                    syms[symbol_name] = sym.st_value;
+            }
+        }
+    }
+};
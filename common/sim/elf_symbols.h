@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Function symbol table of a 32-bit little-endian RISC-V ELF, for mapping
+// simulated PCs back to firmware functions.
+
+#pragma once
+
+#include <elf.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class ElfSymbols
+{
+public:
+    struct Symbol {
+        uint32_t start;
+        uint32_t end;  // Exclusive
+        std::string name;
+    };
+
+    // Collects STT_FUNC symbols and global untyped labels (e.g. _start from
+    // assembly) that lie in executable sections. Symbols without a size
+    // extend to the next symbol.
+    explicit ElfSymbols(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Could not open file " + filename);
+        std::vector<char> image((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+
+        Elf32_Ehdr ehdr;
+        if (image.size() < sizeof(ehdr))
+            throw std::runtime_error(filename + ": not an ELF file");
+        std::memcpy(&ehdr, image.data(), sizeof(ehdr));
+        if (std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+            ehdr.e_ident[EI_CLASS] != ELFCLASS32 ||
+            ehdr.e_ident[EI_DATA] != ELFDATA2LSB)
+            throw std::runtime_error(filename +
+                                     ": not a 32-bit little-endian ELF file");
+        if (ehdr.e_shentsize != sizeof(Elf32_Shdr) ||
+            ehdr.e_shoff + size_t(ehdr.e_shnum) * sizeof(Elf32_Shdr) >
+                image.size())
+            throw std::runtime_error(filename + ": bad section header table");
+
+        std::vector<Elf32_Shdr> sections(ehdr.e_shnum);
+        std::memcpy(sections.data(), image.data() + ehdr.e_shoff,
+                    sections.size() * sizeof(Elf32_Shdr));
+
+        for (const Elf32_Shdr &sh : sections) {
+            if ((sh.sh_flags & (SHF_ALLOC | SHF_EXECINSTR)) !=
+                    (SHF_ALLOC | SHF_EXECINSTR) ||
+                !sh.sh_size)
+                continue;
+            text_start = std::min(text_start, sh.sh_addr);
+            text_end = std::max(text_end, sh.sh_addr + sh.sh_size);
+        }
+
+        for (const Elf32_Shdr &symtab : sections) {
+            if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= sections.size())
+                continue;
+            const Elf32_Shdr &strtab = sections[symtab.sh_link];
+            if (symtab.sh_offset + symtab.sh_size > image.size() ||
+                strtab.sh_offset + strtab.sh_size > image.size())
+                throw std::runtime_error(filename + ": bad symbol table");
+
+            size_t count = symtab.sh_size / sizeof(Elf32_Sym);
+            for (size_t i = 0; i < count; i++) {
+                Elf32_Sym sym;
+                std::memcpy(&sym,
+                            image.data() + symtab.sh_offset +
+                                i * sizeof(Elf32_Sym),
+                            sizeof(sym));
+                unsigned type = ELF32_ST_TYPE(sym.st_info);
+                unsigned bind = ELF32_ST_BIND(sym.st_info);
+                if (type != STT_FUNC &&
+                    !(type == STT_NOTYPE && bind == STB_GLOBAL))
+                    continue;
+                if (sym.st_shndx == SHN_UNDEF ||
+                    sym.st_shndx >= sections.size() ||
+                    !(sections[sym.st_shndx].sh_flags & SHF_EXECINSTR))
+                    continue;
+                if (sym.st_name >= strtab.sh_size)
+                    continue;
+                const char *name =
+                    image.data() + strtab.sh_offset + sym.st_name;
+                syms.push_back({sym.st_value, sym.st_value + sym.st_size,
+                                std::string(name, strnlen(name,
+                                                          strtab.sh_size -
+                                                              sym.st_name))});
+            }
+        }
+
+        std::sort(syms.begin(), syms.end(),
+                  [](const Symbol &a, const Symbol &b) {
+                      if (a.start != b.start)
+                          return a.start < b.start;
+                      return a.end - a.start > b.end - b.start;
+                  });
+        // Aliases at the same address keep the first (sized) entry
+        syms.erase(std::unique(syms.begin(), syms.end(),
+                               [](const Symbol &a, const Symbol &b) {
+                                   return a.start == b.start;
+                               }),
+                   syms.end());
+        for (size_t i = 0; i < syms.size(); i++) {
+            uint32_t next = i + 1 < syms.size() ? syms[i + 1].start
+                                                : std::max(text_end,
+                                                           syms[i].start);
+            if (syms[i].end <= syms[i].start || syms[i].end > next)
+                syms[i].end = next;
+        }
+        if (syms.empty() || text_end <= text_start)
+            throw std::runtime_error(filename + ": no function symbols");
+    }
+
+    // Symbol covering address, or nullptr
+    const Symbol *find(uint32_t address) const
+    {
+        auto it = std::upper_bound(
+            syms.begin(), syms.end(), address,
+            [](uint32_t a, const Symbol &s) { return a < s.start; });
+        if (it == syms.begin())
+            return nullptr;
+        --it;
+        return address < it->end ? &*it : nullptr;
+    }
+
+    size_t index_of(const Symbol *sym) const { return sym - syms.data(); }
+    // Address range of the executable sections
+    uint32_t code_start() const { return text_start; }
+    uint32_t code_end() const { return text_end; }
+    const std::vector<Symbol> &symbols() const { return syms; }
+
+private:
+    std::vector<Symbol> syms;
+    uint32_t text_start = UINT32_MAX;
+    uint32_t text_end = 0;
+};
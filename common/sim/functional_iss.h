@@ -0,0 +1,582 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Functional RV32IM + Zicsr + Zba/Zbb/Zbs + custom-0 DSP instruction set
+// simulator, for fast-forwarding a harness to a region of interest.
+//
+// The ISS executes in place on the harness's SparseMemory, one instruction
+// per step and no timing, until it reaches a stop PC, an instruction count or
+// a marker store. The harness then writes the registers, CSRs and PC into
+// the RTL through its debug-write port and continues cycle-accurately from
+// the same memory image.
+//
+// Only architectural CPU state is modelled. Device registers go through the
+// harness's read and write hooks, which return plausible "ready" values and
+// drop or mirror stores; the peripherals' own state is not transferred.
+// Interrupts are never taken: a WFI with interrupts enabled ends the run,
+// so the RTL executes it and takes the interrupt it is waiting for.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "sim_control.h"
+#include "sparse_memory.h"
+
+class FunctionalISS
+{
+public:
+    enum class Stop { INSTRET, PC, MARKER, EXIT, WFI, ILLEGAL };
+
+    // CSR numbers the harness transfers into the RTL (CSR.scala)
+    static constexpr uint16_t MSTATUS = 0x300;
+    static constexpr uint16_t MISA = 0x301;
+    static constexpr uint16_t MIE = 0x304;
+    static constexpr uint16_t MTVEC = 0x305;
+    static constexpr uint16_t MCOUNTINHIBIT = 0x320;
+    static constexpr uint16_t MSCRATCH = 0x340;
+    static constexpr uint16_t MEPC = 0x341;
+    static constexpr uint16_t MCAUSE = 0x342;
+    static constexpr uint16_t MCYCLE = 0xB00;
+    static constexpr uint16_t MINSTRET = 0xB02;
+    static constexpr uint16_t MCYCLEH = 0xB80;
+    static constexpr uint16_t MINSTRETH = 0xB82;
+
+    // Accesses outside RAM. write returns true to end the run after the
+    // store (e.g. the program asked the simulation to exit); it also sees
+    // stores to the SimControl registers, which land in RAM as well.
+    struct Devices {
+        std::function<uint32_t(uint32_t address)> read;
+        std::function<bool(uint32_t address, uint32_t value, uint32_t mask)>
+            write;
+    };
+
+    // What ends the run besides max_instret; marker_address 0 disables the
+    // marker, stop_pc 1 (never a fetch address) disables the PC stop.
+    struct Target {
+        uint64_t max_instret = UINT64_MAX;
+        uint32_t stop_pc = 1;
+        uint32_t marker_address = 0;
+        uint32_t marker_value = 0;
+    };
+
+    FunctionalISS(SparseMemory &memory, uint32_t reset_pc, Devices devices)
+        : pc(reset_pc), ram(memory), io(std::move(devices))
+    {
+    }
+
+    // Runs until a stop condition; a PC or marker stop leaves the stopping
+    // instruction unexecuted, so the RTL runs it first.
+    Stop run(const Target &target)
+    {
+        while (instret < target.max_instret) {
+            if (pc == target.stop_pc)
+                return Stop::PC;
+            uint32_t inst = ram.read(pc);
+            uint32_t opcode = inst & 0x7F;
+            if (opcode == 0x23 && target.marker_address &&
+                store_address(inst) == target.marker_address &&
+                x[rs2(inst)] == target.marker_value)
+                return Stop::MARKER;
+            if (inst == WFI && (mstatus & MSTATUS_MIE) && mie)
+                return Stop::WFI;
+            Stop stop;
+            if (!step(inst, stop))
+                return stop;
+        }
+        return Stop::INSTRET;
+    }
+
+    static const char *name(Stop stop)
+    {
+        switch (stop) {
+        case Stop::INSTRET:
+            return "instruction count";
+        case Stop::PC:
+            return "stop PC";
+        case Stop::MARKER:
+            return "marker";
+        case Stop::EXIT:
+            return "program exit";
+        case Stop::WFI:
+            return "WFI with interrupts enabled";
+        case Stop::ILLEGAL:
+            return "illegal instruction";
+        }
+        return "";
+    }
+
+    uint32_t pc;
+    uint32_t x[32] = {};
+    uint64_t instret = 0;
+
+    uint32_t mstatus = 0;
+    uint32_t mie = 0;
+    uint32_t mtvec = 0;
+    uint32_t mscratch = 0;
+    uint32_t mepc = 0;
+    uint32_t mcause = 0;
+    uint32_t mcountinhibit = 0;
+
+private:
+    static constexpr uint32_t WFI = 0x10500073;
+    static constexpr uint32_t ECALL = 0x00000073;
+    static constexpr uint32_t EBREAK = 0x00100073;
+    static constexpr uint32_t MRET = 0x30200073;
+    static constexpr uint32_t MSTATUS_MIE = 1u << 3;
+    static constexpr uint32_t MSTATUS_MPIE = 1u << 7;
+
+    SparseMemory &ram;
+    Devices io;
+
+    static uint32_t rd(uint32_t inst) { return (inst >> 7) & 31; }
+    static uint32_t rs1(uint32_t inst) { return (inst >> 15) & 31; }
+    static uint32_t rs2(uint32_t inst) { return (inst >> 20) & 31; }
+    static uint32_t funct3(uint32_t inst) { return (inst >> 12) & 7; }
+    static uint32_t funct7(uint32_t inst) { return inst >> 25; }
+    static int32_t imm_i(uint32_t inst) { return int32_t(inst) >> 20; }
+    static int32_t imm_s(uint32_t inst)
+    {
+        return (int32_t(inst & 0xFE000000) >> 20) | ((inst >> 7) & 31);
+    }
+    static int32_t imm_b(uint32_t inst)
+    {
+        return (int32_t(inst & 0x80000000) >> 19) | ((inst & 0x80) << 4) |
+               ((inst >> 20) & 0x7E0) | ((inst >> 7) & 0x1E);
+    }
+    static int32_t imm_j(uint32_t inst)
+    {
+        return (int32_t(inst & 0x80000000) >> 11) | (inst & 0xFF000) |
+               ((inst >> 9) & 0x800) | ((inst >> 20) & 0x7FE);
+    }
+
+    uint32_t store_address(uint32_t inst) const
+    {
+        return x[rs1(inst)] + imm_s(inst);
+    }
+
+    uint32_t load_word(uint32_t address)
+    {
+        if (ram.contains(address))
+            return ram.read(address);
+        return io.read ? io.read(address & ~3u) : 0;
+    }
+
+    uint32_t load(uint32_t address, unsigned size)
+    {
+        unsigned shift = (address & 3) * 8;
+        uint64_t word = load_word(address);
+        if ((address & 3) + size > 4)
+            word |= uint64_t(load_word(address + 4)) << 32;
+        word >>= shift;
+        return size == 4 ? uint32_t(word) : uint32_t(word) & ((1u << (size * 8)) - 1);
+    }
+
+    // Returns true to end the run
+    bool store(uint32_t address, uint32_t value, unsigned size)
+    {
+        uint32_t mask = size == 4 ? 0xFFFFFFFFu : (1u << (size * 8)) - 1;
+        unsigned shift = (address & 3) * 8;
+        bool stop = false;
+        for (unsigned part = 0; part < 2; part++) {
+            uint32_t word = (address & ~3u) + part * 4;
+            uint32_t m = part ? uint32_t(uint64_t(mask) << shift >> 32) : mask << shift;
+            uint32_t v = part ? uint32_t(uint64_t(value) << shift >> 32) : value << shift;
+            if (!m)
+                break;
+            if (ram.contains(word))
+                ram.write(word, v, m);
+            if ((!ram.contains(word) ||
+                 (word >= SimControl::BASE && word < SimControl::LIMIT)) &&
+                io.write)
+                stop |= io.write(word, v, m);
+        }
+        return stop;
+    }
+
+    uint32_t read_csr(uint16_t csr) const
+    {
+        switch (csr) {
+        case MSTATUS:
+            return mstatus;
+        case MISA:
+            return 0x40801102;  // RV32IMBX, as CSR.scala with Zb*
+        case MIE:
+            return mie;
+        case MTVEC:
+            return mtvec;
+        case MCOUNTINHIBIT:
+            return mcountinhibit;
+        case MSCRATCH:
+            return mscratch;
+        case MEPC:
+            return mepc;
+        case MCAUSE:
+            return mcause;
+        // No timing: cycles read as retired instructions (CPI 1)
+        case MCYCLE:
+        case MINSTRET:
+        case 0xC00:
+        case 0xC02:
+            return uint32_t(instret);
+        case MCYCLEH:
+        case MINSTRETH:
+        case 0xC80:
+        case 0xC82:
+            return uint32_t(instret >> 32);
+        default:
+            return 0;
+        }
+    }
+
+    void write_csr(uint16_t csr, uint32_t value)
+    {
+        switch (csr) {
+        case MSTATUS:
+            mstatus = value;
+            break;
+        case MIE:
+            mie = value;
+            break;
+        case MTVEC:
+            mtvec = value;
+            break;
+        case MCOUNTINHIBIT:
+            mcountinhibit = value & 0x003FFFFD;
+            break;
+        case MSCRATCH:
+            mscratch = value;
+            break;
+        case MEPC:
+            mepc = value;
+            break;
+        case MCAUSE:
+            mcause = value;
+            break;
+        case MINSTRET:
+            instret = (instret & ~uint64_t(0xFFFFFFFF)) | value;
+            break;
+        case MINSTRETH:
+            instret = (instret & 0xFFFFFFFF) | uint64_t(value) << 32;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void trap(uint32_t cause)
+    {
+        mepc = pc;
+        mcause = cause;
+        mstatus = (mstatus & ~(MSTATUS_MIE | MSTATUS_MPIE)) |
+                  ((mstatus & MSTATUS_MIE) ? MSTATUS_MPIE : 0);
+        pc = mtvec & ~3u;
+    }
+
+    static uint32_t clz(uint32_t v) { return v ? __builtin_clz(v) : 32; }
+    static uint32_t ctz(uint32_t v) { return v ? __builtin_ctz(v) : 32; }
+    static uint32_t rol(uint32_t v, uint32_t s)
+    {
+        s &= 31;
+        return s ? (v << s) | (v >> (32 - s)) : v;
+    }
+    static uint32_t ror(uint32_t v, uint32_t s)
+    {
+        s &= 31;
+        return s ? (v >> s) | (v << (32 - s)) : v;
+    }
+
+    // R-type OP (0x33): base, M, Zba, Zbb and Zbs; false if unknown
+    static bool alu(uint32_t f7, uint32_t f3, uint32_t a, uint32_t b,
+                    uint32_t &result)
+    {
+        int32_t sa = int32_t(a), sb = int32_t(b);
+        switch (f7 << 3 | f3) {
+        case 0x00 << 3 | 0: result = a + b; return true;
+        case 0x20 << 3 | 0: result = a - b; return true;
+        case 0x00 << 3 | 1: result = a << (b & 31); return true;
+        case 0x00 << 3 | 2: result = sa < sb; return true;
+        case 0x00 << 3 | 3: result = a < b; return true;
+        case 0x00 << 3 | 4: result = a ^ b; return true;
+        case 0x00 << 3 | 5: result = a >> (b & 31); return true;
+        case 0x20 << 3 | 5: result = uint32_t(sa >> (b & 31)); return true;
+        case 0x00 << 3 | 6: result = a | b; return true;
+        case 0x00 << 3 | 7: result = a & b; return true;
+        // M
+        case 0x01 << 3 | 0: result = a * b; return true;
+        case 0x01 << 3 | 1: result = uint32_t((int64_t(sa) * sb) >> 32); return true;
+        case 0x01 << 3 | 2: result = uint32_t((int64_t(sa) * uint64_t(b)) >> 32); return true;
+        case 0x01 << 3 | 3: result = uint32_t((uint64_t(a) * b) >> 32); return true;
+        case 0x01 << 3 | 4:
+            result = b == 0 ? 0xFFFFFFFFu
+                     : (a == 0x80000000u && sb == -1) ? a
+                                                      : uint32_t(sa / sb);
+            return true;
+        case 0x01 << 3 | 5: result = b == 0 ? 0xFFFFFFFFu : a / b; return true;
+        case 0x01 << 3 | 6:
+            result = b == 0 ? a
+                     : (a == 0x80000000u && sb == -1) ? 0
+                                                      : uint32_t(sa % sb);
+            return true;
+        case 0x01 << 3 | 7: result = b == 0 ? a : a % b; return true;
+        // Zba
+        case 0x10 << 3 | 2: result = (a << 1) + b; return true;
+        case 0x10 << 3 | 4: result = (a << 2) + b; return true;
+        case 0x10 << 3 | 6: result = (a << 3) + b; return true;
+        // Zbb
+        case 0x20 << 3 | 7: result = a & ~b; return true;
+        case 0x20 << 3 | 6: result = a | ~b; return true;
+        case 0x20 << 3 | 4: result = ~(a ^ b); return true;
+        case 0x05 << 3 | 4: result = sa < sb ? a : b; return true;
+        case 0x05 << 3 | 5: result = a < b ? a : b; return true;
+        case 0x05 << 3 | 6: result = sa > sb ? a : b; return true;
+        case 0x05 << 3 | 7: result = a > b ? a : b; return true;
+        case 0x30 << 3 | 1: result = rol(a, b); return true;
+        case 0x30 << 3 | 5: result = ror(a, b); return true;
+        case 0x04 << 3 | 4:
+            if (b != 0)  // zext.h has rs2 = 0
+                return false;
+            result = a & 0xFFFF;
+            return true;
+        // Zbs
+        case 0x24 << 3 | 1: result = a & ~(1u << (b & 31)); return true;
+        case 0x24 << 3 | 5: result = (a >> (b & 31)) & 1; return true;
+        case 0x34 << 3 | 1: result = a ^ (1u << (b & 31)); return true;
+        case 0x14 << 3 | 1: result = a | (1u << (b & 31)); return true;
+        default: return false;
+        }
+    }
+
+    static uint32_t saturate16(int64_t v)
+    {
+        return uint32_t(int32_t(v > 32767 ? 32767 : v < -32768 ? -32768 : v));
+    }
+    static uint32_t saturate32(int64_t v)
+    {
+        return uint32_t(int32_t(v > INT32_MAX ? INT32_MAX
+                                : v < INT32_MIN ? INT32_MIN
+                                                : v));
+    }
+    static uint32_t q15(int32_t a, int32_t b)
+    {
+        return uint32_t(int32_t(int16_t(uint32_t(a * b) >> 15)));
+    }
+
+    // custom-0 DSP ops (ALU.scala); funct7 1 selects the packed 2x16 forms
+    static bool dsp(uint32_t f7, uint32_t f3, uint32_t a, uint32_t b,
+                    uint32_t &result)
+    {
+        int32_t a0 = int16_t(a), b0 = int16_t(b);
+        int32_t a1 = int16_t(a >> 16), b1 = int16_t(b >> 16);
+        if (f7 == 1) {
+            switch (f3) {
+            case 0: result = (q15(a1, b1) << 16) | (q15(a0, b0) & 0xFFFF); return true;
+            case 1: result = (saturate16(a1 + b1) << 16) | (saturate16(a0 + b0) & 0xFFFF); return true;
+            case 2: result = (saturate16(a1 - b1) << 16) | (saturate16(a0 - b0) & 0xFFFF); return true;
+            case 3: result = uint32_t(int32_t((int64_t(a0 * b0) + a1 * b1) >> 15)); return true;
+            default: return false;
+            }
+        }
+        switch (f3) {
+        case 0: result = q15(a0, b0); return true;
+        case 1: result = saturate16(a0 + b0); return true;
+        case 2: result = saturate16(a0 - b0); return true;
+        case 3: result = saturate32(int64_t(int32_t(a)) + int32_t(b)); return true;
+        case 4: result = saturate32(int64_t(int32_t(a)) - int32_t(b)); return true;
+        case 5: {
+            int32_t p = a0 * b0;
+            result = uint32_t(int32_t(int16_t((p + (p >= 0 ? 0x4000 : 0x3FFF)) >> 15)));
+            return true;
+        }
+        case 6: result = saturate16(int64_t(a0) << (b & 31)); return true;
+        case 7: result = uint32_t(uint64_t(int64_t(int32_t(a)) * b0) >> 15); return true;
+        default: return false;
+        }
+    }
+
+    // OP-IMM shifts and unary Zbb/Zbs forms (funct3 1 and 5)
+    static bool alu_shift_imm(uint32_t inst, uint32_t a, uint32_t &result)
+    {
+        uint32_t shamt = rs2(inst);
+        uint32_t f7 = funct7(inst);
+        if (funct3(inst) == 1) {
+            switch (f7) {
+            case 0x00: result = a << shamt; return true;
+            case 0x24: result = a & ~(1u << shamt); return true;
+            case 0x34: result = a ^ (1u << shamt); return true;
+            case 0x14: result = a | (1u << shamt); return true;
+            case 0x30:
+                switch (shamt) {
+                case 0: result = clz(a); return true;
+                case 1: result = ctz(a); return true;
+                case 2: result = __builtin_popcount(a); return true;
+                case 4: result = uint32_t(int32_t(int8_t(a))); return true;
+                case 5: result = uint32_t(int32_t(int16_t(a))); return true;
+                default: return false;
+                }
+            default: return false;
+            }
+        }
+        switch (f7) {
+        case 0x00: result = a >> shamt; return true;
+        case 0x20: result = uint32_t(int32_t(a) >> shamt); return true;
+        case 0x30: result = ror(a, shamt); return true;
+        case 0x24: result = (a >> shamt) & 1; return true;
+        case 0x14:
+            if (shamt != 7)  // orc.b
+                return false;
+            result = 0;
+            for (int i = 0; i < 32; i += 8)
+                if ((a >> i) & 0xFF)
+                    result |= 0xFFu << i;
+            return true;
+        case 0x34:
+            if (shamt != 0x18)  // rev8
+                return false;
+            result = __builtin_bswap32(a);
+            return true;
+        default: return false;
+        }
+    }
+
+    // Executes one instruction; returns false with stop set to end the run
+    bool step(uint32_t inst, Stop &stop)
+    {
+        uint32_t next = pc + 4;
+        uint32_t a = x[rs1(inst)], b = x[rs2(inst)];
+        uint32_t result = 0;
+        bool write_rd = true;
+        bool end = false;
+
+        switch (inst & 0x7F) {
+        case 0x37:  // LUI
+            result = inst & 0xFFFFF000;
+            break;
+        case 0x17:  // AUIPC
+            result = pc + (inst & 0xFFFFF000);
+            break;
+        case 0x6F:  // JAL
+            result = next;
+            next = pc + imm_j(inst);
+            break;
+        case 0x67:  // JALR
+            result = next;
+            next = (a + imm_i(inst)) & ~1u;
+            break;
+        case 0x63: {  // Branches
+            bool taken;
+            switch (funct3(inst)) {
+            case 0: taken = a == b; break;
+            case 1: taken = a != b; break;
+            case 4: taken = int32_t(a) < int32_t(b); break;
+            case 5: taken = int32_t(a) >= int32_t(b); break;
+            case 6: taken = a < b; break;
+            case 7: taken = a >= b; break;
+            default: stop = Stop::ILLEGAL; return false;
+            }
+            if (taken)
+                next = pc + imm_b(inst);
+            write_rd = false;
+            break;
+        }
+        case 0x03: {  // Loads
+            uint32_t address = a + imm_i(inst);
+            switch (funct3(inst)) {
+            case 0: result = uint32_t(int32_t(int8_t(load(address, 1)))); break;
+            case 1: result = uint32_t(int32_t(int16_t(load(address, 2)))); break;
+            case 2: result = load(address, 4); break;
+            case 4: result = load(address, 1); break;
+            case 5: result = load(address, 2); break;
+            default: stop = Stop::ILLEGAL; return false;
+            }
+            break;
+        }
+        case 0x23: {  // Stores
+            unsigned f3 = funct3(inst);
+            if (f3 > 2) {
+                stop = Stop::ILLEGAL;
+                return false;
+            }
+            end = store(store_address(inst), b, 1u << f3);
+            write_rd = false;
+            break;
+        }
+        case 0x13: {  // OP-IMM
+            int32_t imm = imm_i(inst);
+            switch (funct3(inst)) {
+            case 0: result = a + imm; break;
+            case 2: result = int32_t(a) < imm; break;
+            case 3: result = a < uint32_t(imm); break;
+            case 4: result = a ^ imm; break;
+            case 6: result = a | imm; break;
+            case 7: result = a & imm; break;
+            default:
+                if (!alu_shift_imm(inst, a, result)) {
+                    stop = Stop::ILLEGAL;
+                    return false;
+                }
+            }
+            break;
+        }
+        case 0x33:  // OP
+            if (!alu(funct7(inst), funct3(inst), a, b, result)) {
+                stop = Stop::ILLEGAL;
+                return false;
+            }
+            break;
+        case 0x0B:  // custom-0 DSP
+            if (!dsp(funct7(inst), funct3(inst), a, b, result)) {
+                stop = Stop::ILLEGAL;
+                return false;
+            }
+            break;
+        case 0x0F:  // FENCE, FENCE.I: memory is already coherent
+            write_rd = false;
+            break;
+        case 0x73: {  // SYSTEM
+            uint32_t f3 = funct3(inst);
+            if (f3 == 0) {
+                write_rd = false;
+                if (inst == ECALL || inst == EBREAK) {
+                    trap(inst == ECALL ? 11 : 3);
+                    next = pc;  // The handler address
+                } else if (inst == MRET) {
+                    mstatus = (mstatus & ~MSTATUS_MIE) |
+                              ((mstatus & MSTATUS_MPIE) ? MSTATUS_MIE : 0) |
+                              MSTATUS_MPIE;
+                    next = mepc;
+                } else if (inst != WFI) {
+                    stop = Stop::ILLEGAL;
+                    return false;
+                }
+                break;
+            }
+            uint16_t csr = inst >> 20;
+            uint32_t operand = f3 & 4 ? rs1(inst) : a;
+            result = read_csr(csr);
+            switch (f3 & 3) {
+            case 1: write_csr(csr, operand); break;
+            case 2: if (rs1(inst)) write_csr(csr, result | operand); break;
+            case 3: if (rs1(inst)) write_csr(csr, result & ~operand); break;
+            default: stop = Stop::ILLEGAL; return false;
+            }
+            break;
+        }
+        default:
+            stop = Stop::ILLEGAL;
+            return false;
+        }
+
+        if (write_rd && rd(inst))
+            x[rd(inst)] = result;
+        pc = next;
+        instret++;
+        if (end) {
+            stop = Stop::EXIT;
+            return false;
+        }
+        return true;
+    }
+};
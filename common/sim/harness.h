@@ -0,0 +1,750 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Verilator harness shared by the stages that expose a single memory bundle
+// (0-minimal to 3-pipeline).
+//
+// 4-soc is not built on it. Its sim.cpp drives an AXI4-Lite bus with
+// bit-level UART and audio models, DMA, VGA and checkpoints in a loop of its
+// own, and shares only the building blocks below it: sparse_memory.h,
+// sim_control.h, elf_image.h, pc_profiler.h and host_profile.h. A fast-path
+// change made here therefore reaches 4-soc only through those headers, until
+// the port outlined in 4-soc/README.md ("Porting onto harness.h") is done.
+//
+// A stage's sim.cpp only describes what differs between the stages, as a
+// policy type derived from HarnessStage:
+//
+//   struct Stage : HarnessStage<VTop> {
+//       static constexpr unsigned DEVICE_SELECT_BITS = 3;
+//       using Devices = DeviceMap<DeviceSlot<2, ConsoleUart>>;
+//       static uint32_t device_select(const VTop &top)
+//       {
+//           return top.io_device_select;
+//       }
+//   };
+//   int main(int argc, char **argv)
+//   {
+//       return Harness<Stage>::main(argc, argv);
+//   }
+//
+// Port bindings are static inline functions and the device map is a list of
+// compile-time (select, device) pairs, so the per-cycle bus access compiles
+// to a short compare chain over the selects the stage actually maps; a stage
+// without devices has no device path at all. RAM, the sim-control exit device
+// (sim_control.h), the PC profiler and both clocking modes are implemented
+// once here.
+//
+// Options: -instruction <file>, -memory <words>, -time <ticks>, -halt <addr>,
+// -tohost <addr>, -watch <addr>, -signature <begin> <end> <file>,
+// -signature-file <file>, -fast-clock, -profile <elf> and -profile-out
+// <prefix>, plus whatever the stage reads in configure(). -halt stops when
+// 0xBABECAFE is stored to addr, -tohost when an odd value is (riscv-tests
+// style, exit status value >> 1), and -watch logs every store to the word at
+// addr. All three are RAM watchpoints, so they cost nothing until the address
+// is written.
+//
+// -instruction takes a raw image, loaded at the reset vector, or an ELF
+// (elf_image.h), loaded segment by segment with .bss zeroed. An ELF's tohost
+// symbol is watched unless -tohost is given, and -signature-file dumps
+// begin_signature to end_signature.
+//
+// Built with -DSIM_HOST_PROFILE, both loops time eval(), memory, the stage's
+// peripherals and I/O (host_profile.h) and report the split with every
+// progress line and at exit.
+//
+// Tracing: -vcd <file> (or -fst <file> in an FST build, see wave_tracer.h),
+// -trace-depth <levels>, and the flight recorder options:
+//   -trace-start-cycle <n>     start dumping at CPU cycle n
+//   -trace-start-pc <addr>     start dumping when addr is fetched
+//   -trace-start-write <addr>  start dumping at the first store to addr
+//   -trace-window <cycles>     keep only the last cycles in memory and write
+//                              them out when the simulation stops
+
+#pragma once
+
+#include <verilated.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "elf_image.h"
+#include "host_profile.h"
+#include "pc_profiler.h"
+#include "sim_control.h"
+#include "sparse_memory.h"
+#include "wave_tracer.h"
+
+// Parses a string as a number, supporting "0x" prefix for hexadecimal values.
+inline uint32_t parse_number(const std::string &str)
+{
+    if (str.size() > 2 &&
+        (str.substr(0, 2) == "0x" || str.substr(0, 2) == "0X")) {
+        return std::stoul(str.substr(2), nullptr, 16);
+    }
+    return std::stoul(str);
+}
+
+// Command line of a harness. Options are looked up once at start-up.
+class HarnessArgs
+{
+    std::vector<std::string> args;
+
+public:
+    HarnessArgs(int argc, char **argv) : args(argv, argv + argc) {}
+
+    bool has(const std::string &flag) const
+    {
+        return std::find(args.begin(), args.end(), flag) != args.end();
+    }
+
+    // The count arguments following flag, or nullptr if flag is absent or
+    // not followed by enough arguments.
+    const std::string *value(const std::string &flag, size_t count = 1) const
+    {
+        auto it = std::find(args.begin(), args.end(), flag);
+        if (it == args.end() || size_t(std::distance(it, args.end())) <= count)
+            return nullptr;
+        return &*std::next(it);
+    }
+};
+
+// CPU memory, addressed in bytes. Which out-of-range accesses are reported is
+// a compile-time choice of the stage: stack and speculative accesses that
+// leave the RAM are expected on some stages and would only be noise.
+//
+// Watchpoints let the harness react to stores instead of polling memory: a
+// callback registered on an address range runs after each write that touches
+// it. Writes outside the hull of all watched ranges cost one compare.
+template <bool CheckFetch, bool CheckRead, bool CheckWrite>
+class Memory
+{
+public:
+    // Receives the watched word address and its contents after the write
+    using Watch = std::function<void(uint32_t address, uint32_t word)>;
+
+private:
+    struct Watchpoint {
+        uint32_t begin;
+        uint32_t end;  // Exclusive
+        Watch callback;
+    };
+
+    SparseMemory memory;
+    std::vector<Watchpoint> watchpoints;
+    uint32_t watch_begin = 0;
+    uint32_t watch_span = 0;  // Hull of all ranges, 0 if none
+
+    void notify(uint32_t address)
+    {
+        address &= ~3u;
+        for (const Watchpoint &w : watchpoints) {
+            if (address < w.end && address + 4 > w.begin)
+                w.callback(address, memory.read(address));
+        }
+    }
+
+public:
+    // size is in 32-bit words; pages are only committed when touched.
+    explicit Memory(size_t size) : memory(size * 4) {}
+
+    inline uint32_t read(size_t address) const
+    {
+        if (CheckRead && !memory.contains(address))
+            printf("invalid read address 0x%08zx\n", address & ~size_t(3));
+        return memory.read(address);
+    }
+
+    inline uint32_t fetch(size_t address) const
+    {
+        if (CheckFetch && !memory.contains(address))
+            printf("invalid read Inst address 0x%08zx\n", address & ~size_t(3));
+        return memory.read(address);
+    }
+
+    // strobe has bit i set for byte lane i
+    inline void write(size_t address, uint32_t value, uint8_t strobe)
+    {
+        if (CheckWrite && !memory.contains(address))
+            printf("invalid write address 0x%08zx\n", address & ~size_t(3));
+        memory.write(address, value, SparseMemory::strobe_mask(strobe));
+        if ((uint32_t(address) & ~3u) - watch_begin < watch_span)
+            notify(address);
+    }
+
+    // Calls callback after every write to a word overlapping [begin, end)
+    void watch(uint32_t begin, uint32_t end, Watch callback)
+    {
+        if (end <= begin)
+            throw std::runtime_error("empty watch range");
+        uint32_t word = begin & ~3u;
+        uint32_t hull_end = watch_span ? watch_begin + watch_span : end;
+        watch_begin = watch_span ? std::min(watch_begin, word) : word;
+        watch_span = std::max(hull_end, end) - watch_begin;
+        watchpoints.push_back({begin, end, std::move(callback)});
+    }
+
+    // Maps a binary file into memory at a specified address (copy-on-write,
+    // the file itself is never modified).
+    void load_binary(const std::string &filename, size_t load_address)
+    {
+        memory.load_binary(filename, load_address);
+    }
+
+    void load_elf(const ElfImage &elf, uint32_t reset_vector)
+    {
+        elf.load(memory, reset_vector);
+    }
+};
+
+// One MMIO device of a stage, reached when the CPU's device select equals
+// Select. Device is default-constructible and provides
+// uint32_t read(uint32_t offset) and void write(uint32_t offset, uint32_t).
+template <uint32_t Select, typename Device>
+struct DeviceSlot {
+    static constexpr uint32_t SELECT = Select;
+    using type = Device;
+};
+
+template <typename... Slots>
+class DeviceMap
+{
+    static_assert(((Slots::SELECT != 0) && ...),
+                  "device select 0 is the RAM");
+
+    std::tuple<typename Slots::type...> devices;
+
+    template <size_t... I>
+    inline uint32_t read([[maybe_unused]] uint32_t select,
+                         [[maybe_unused]] uint32_t offset,
+                         std::index_sequence<I...>)
+    {
+        uint32_t data = 0;
+        (void) ((select == Slots::SELECT
+                     ? (data = std::get<I>(devices).read(offset), true)
+                     : false) ||
+                ...);
+        return data;
+    }
+
+    template <size_t... I>
+    inline void write([[maybe_unused]] uint32_t select,
+                      [[maybe_unused]] uint32_t offset,
+                      [[maybe_unused]] uint32_t value,
+                      std::index_sequence<I...>)
+    {
+        (void) ((select == Slots::SELECT
+                     ? (std::get<I>(devices).write(offset, value), true)
+                     : false) ||
+                ...);
+    }
+
+public:
+    // Unmapped selects read as 0 and ignore writes
+    inline uint32_t read(uint32_t select, uint32_t offset)
+    {
+        return read(select, offset, std::index_sequence_for<Slots...>{});
+    }
+
+    inline void write(uint32_t select, uint32_t offset, uint32_t value)
+    {
+        write(select, offset, value, std::index_sequence_for<Slots...>{});
+    }
+
+};
+
+// Character output: every write prints the low byte of the value.
+struct ConsoleUart {
+    uint32_t read(uint32_t) { return 0; }
+    void write(uint32_t, uint32_t value)
+    {
+        std::cout << static_cast<char>(value) << std::flush;
+    }
+};
+
+// Defaults for the stage policy. A stage overrides what it needs by
+// redeclaring the member in its derived type; the harness calls them through
+// the derived type, so unused hooks inline to nothing.
+template <typename TopType>
+struct HarnessStage {
+    using Top = TopType;
+    using Devices = DeviceMap<>;
+
+    // Upper address bits that select the device; 0 if the CPU has no device
+    // select output and the whole address goes to RAM.
+    static constexpr unsigned DEVICE_SELECT_BITS = 0;
+    // Default loop: harness ticks per CPU clock
+    static constexpr unsigned TICKS_PER_CYCLE = 4;
+    // Number of progress lines printed over -time
+    static constexpr unsigned PROGRESS_STEPS = 100;
+    // Out-of-range accesses that are reported
+    static constexpr bool CHECK_FETCH = true;
+    static constexpr bool CHECK_READ = false;
+    static constexpr bool CHECK_WRITE = false;
+
+    static uint32_t device_select(const Top &) { return 0; }
+
+    // Reads stage-specific options
+    void configure(const HarnessArgs &) {}
+    // Drives stage-specific inputs before the first eval
+    void reset(Top &) {}
+    // Drives clocks derived from the CPU clock
+    void clock(Top &, bool) {}
+    // Default loop only: drives stage-specific inputs before each eval
+    void drive(Top &, vluint64_t) {}
+    // Called after every rising edge; returning false stops the simulation
+    bool cycle(Top &) { return true; }
+    // Called once after the simulation loop; the model can still be read
+    void finish(Top &) {}
+};
+
+template <typename Stage>
+class Harness
+{
+    using Top = typename Stage::Top;
+    using RAM =
+        Memory<Stage::CHECK_FETCH, Stage::CHECK_READ, Stage::CHECK_WRITE>;
+
+    static constexpr unsigned TICKS_PER_CYCLE = Stage::TICKS_PER_CYCLE;
+    static_assert(TICKS_PER_CYCLE >= 2 && TICKS_PER_CYCLE % 2 == 0,
+                  "the default loop needs whole clock periods");
+    static constexpr uint32_t DEVICE_SHIFT = 32 - Stage::DEVICE_SELECT_BITS;
+    static constexpr uint32_t DEVICE_MASK =
+        Stage::DEVICE_SELECT_BITS ? (1u << DEVICE_SHIFT) - 1u : ~0u;
+    static constexpr int RESET_TICKS = 2;
+    static constexpr uint32_t RESET_VECTOR = 0x1000;  // Parameters.EntryAddress
+    static constexpr uint32_t HALT_MAGIC = 0xBABECAFE;
+
+    Stage stage;
+    std::unique_ptr<Top> top;
+    WaveTracer<Top> tracer;
+    std::unique_ptr<RAM> memory;
+    std::unique_ptr<ElfImage> elf;
+    typename Stage::Devices devices;
+    SimControl sim_ctrl;
+    std::unique_ptr<PcProfiler> profiler;
+    std::string profile_prefix = "profile";
+    HostProfile host_profile;
+
+    vluint64_t main_time = 0;
+    vluint64_t max_sim_time = 10000;
+    uint64_t cycles = 0;
+    bool finished = false;
+    uint32_t halt_address = 0;
+    int tohost_status = 0;
+    vluint64_t progress_step = 1;
+    vluint64_t progress_countdown = 1;
+    bool fast_clock = false;
+    bool dump_signature = false;
+    uint32_t signature_begin = 0, signature_end = 0;
+    std::string signature_filename;
+
+    // Dumping starts once a trigger fires; with no trigger it starts at once
+    bool tracing = false;
+    bool trace_armed = false;
+    uint64_t trace_start_cycle = UINT64_MAX;
+    uint64_t trace_start_pc = UINT64_MAX;
+    uint64_t trace_start_write = UINT64_MAX;
+
+    void start_trace(const char *reason)
+    {
+        trace_armed = false;
+        tracing = true;
+        std::cerr << "Tracing to " << tracer.file() << " from cycle " << cycles
+                  << " (" << reason << ")" << std::endl;
+    }
+
+    inline void dump()
+    {
+        if (tracing)
+            tracer.dump(main_time);
+    }
+
+    // Performs the access currently on the memory bundle and returns the
+    // read data. Reads are side-effect free; a write is committed only when
+    // commit is set, once per CPU cycle, so RAM watchpoints and devices see
+    // each store exactly once.
+    inline uint32_t access_bus(bool commit)
+    {
+        uint32_t select = Stage::device_select(*top);
+        uint32_t address = top->io_memory_bundle_address & DEVICE_MASK;
+
+        if (commit && top->io_memory_bundle_write_enable) {
+            uint32_t value = top->io_memory_bundle_write_data;
+            if (select == 0) {
+                uint8_t strobe =
+                    (top->io_memory_bundle_write_strobe_0 ? 1 : 0) |
+                    (top->io_memory_bundle_write_strobe_1 ? 2 : 0) |
+                    (top->io_memory_bundle_write_strobe_2 ? 4 : 0) |
+                    (top->io_memory_bundle_write_strobe_3 ? 8 : 0);
+                memory->write(address, value, strobe);
+            } else {
+                devices.write(select, address, value);
+            }
+        }
+
+        if (select == 0)
+            return memory->read(address);
+        return devices.read(select, address);
+    }
+
+    inline void set_clock(bool level)
+    {
+        top->clock = level;
+        stage.clock(*top, level);
+    }
+
+    // Called after the eval that follows each rising edge
+    inline bool posedge()
+    {
+        cycles++;
+        if (profiler)
+            profiler->sample(top->io_instruction_address);
+        if (tracing) {
+            tracer.cycle();
+        } else if (trace_armed) {
+            if (cycles >= trace_start_cycle)
+                start_trace("cycle trigger");
+            else if (top->io_instruction_address == trace_start_pc)
+                start_trace("PC trigger");
+        }
+        return stage.cycle(*top);
+    }
+
+    // Counts ticks down to the next progress line instead of dividing
+    inline void progress(vluint64_t ticks)
+    {
+        if (progress_countdown > ticks) {
+            progress_countdown -= ticks;
+            return;
+        }
+        vluint64_t overshoot = ticks - progress_countdown;
+        progress_countdown = progress_step - overshoot % progress_step;
+        std::cerr << "Simulation progress: " << (main_time * 100 / max_sim_time)
+                  << "%";
+        std::string split = host_profile.interval(cycles);
+        if (!split.empty())
+            std::cerr << " (" << split << ")";
+        std::cerr << std::endl;
+    }
+
+    // Everything that stops the run on a store is a RAM watchpoint, so the
+    // loops only test finished.
+    void watch_memory(const HarnessArgs &args)
+    {
+        memory->watch(SimControl::BASE, SimControl::LIMIT,
+                      [this](uint32_t address, uint32_t word) {
+                          if (sim_ctrl.write(address, word, cycles))
+                              finished = true;
+                      });
+        if (halt_address)
+            memory->watch(halt_address, halt_address + 4,
+                          [this](uint32_t, uint32_t word) {
+                              if (word == HALT_MAGIC)
+                                  finished = true;
+                          });
+        // riscv-tests convention: (code << 1) | 1, code 0 is a pass
+        uint32_t tohost = 0;
+        if (auto v = args.value("-tohost"))
+            tohost = parse_number(*v);
+        else if (elf && elf->symbol("tohost", tohost))
+            std::cout << "tohost at 0x" << std::hex << tohost << std::dec
+                      << std::endl;
+        if (tohost) {
+            memory->watch(tohost, tohost + 4, [this](uint32_t, uint32_t word) {
+                if (!(word & 1))
+                    return;
+                tohost_status = static_cast<int>(word >> 1);
+                if (tohost_status)
+                    std::cout << "tohost: test failed (code " << tohost_status
+                              << ") at cycle " << cycles << std::endl;
+                else
+                    std::cout << "tohost: test passed at cycle " << cycles
+                              << std::endl;
+                finished = true;
+            });
+        }
+        if (trace_start_write != UINT64_MAX) {
+            uint32_t trigger = static_cast<uint32_t>(trace_start_write);
+            memory->watch(trigger, trigger + 4, [this](uint32_t, uint32_t) {
+                if (trace_armed)
+                    start_trace("store trigger");
+            });
+        }
+        if (auto v = args.value("-watch")) {
+            uint32_t address = parse_number(*v);
+            memory->watch(address, address + 4,
+                          [this](uint32_t word_address, uint32_t word) {
+                              fprintf(stderr,
+                                      "watch: cycle %llu [0x%08x] = 0x%08x\n",
+                                      (unsigned long long) cycles,
+                                      word_address, word);
+                          });
+        }
+    }
+
+    void init()
+    {
+        top->reset = 1;
+        top->io_instruction_valid = 1;
+        stage.reset(*top);
+        set_clock(false);
+        top->eval();
+        dump();
+    }
+
+    // One rising edge per CPU cycle: the posedge eval, then a single settle
+    // eval with the clock low once the fetched instruction is applied. The
+    // bus is accessed once per cycle instead of on every eval. main_time
+    // still advances TICKS_PER_CYCLE per cycle, so -time and -vcd keep the
+    // meaning they have in the default loop.
+    void run_fast_clock()
+    {
+        init();
+        host_profile.start();
+        uint32_t data_memory_read_word = 0;
+        while (main_time < max_sim_time && !Verilated::gotFinish()) {
+            top->io_memory_bundle_read_data = data_memory_read_word;
+            set_clock(true);
+            top->eval();
+            top->reset = 0;
+            host_profile.mark(HostProfile::EVAL);
+            if (!posedge())
+                break;
+            host_profile.mark(HostProfile::PERIPHERALS);
+
+            top->io_instruction = memory->fetch(top->io_instruction_address);
+            set_clock(false);
+            host_profile.mark(HostProfile::MEMORY);
+            top->eval();
+            main_time += TICKS_PER_CYCLE;
+            host_profile.mark(HostProfile::EVAL);
+
+            data_memory_read_word = access_bus(true);
+            host_profile.mark(HostProfile::MEMORY);
+            dump();
+
+            if (finished)
+                break;
+            progress(TICKS_PER_CYCLE);
+            host_profile.mark(HostProfile::IO);
+        }
+    }
+
+    // The clock is high for the first half of every TICKS_PER_CYCLE ticks,
+    // with one eval per tick. Memory responds one tick after an address is
+    // presented, which is what gives single-cycle cores time for loads.
+    void run_default_clock()
+    {
+        init();
+        host_profile.start();
+        uint32_t data_memory_read_word = 0;
+        uint32_t inst_memory_read_word = 0;
+        while (main_time < max_sim_time && !Verilated::gotFinish()) {
+            ++main_time;
+            unsigned phase = (main_time - 1) % TICKS_PER_CYCLE;
+            bool rising = phase == 0;
+            set_clock(phase < TICKS_PER_CYCLE / 2);
+            if (main_time > RESET_TICKS)
+                top->reset = 0;
+
+            top->io_memory_bundle_read_data = data_memory_read_word;
+            top->io_instruction = inst_memory_read_word;
+            stage.drive(*top, main_time);
+            host_profile.mark(HostProfile::PERIPHERALS);
+            top->eval();
+            host_profile.mark(HostProfile::EVAL);
+            if (rising && !posedge())
+                break;
+            host_profile.mark(HostProfile::PERIPHERALS);
+
+            data_memory_read_word = access_bus(rising);
+            inst_memory_read_word = memory->fetch(top->io_instruction_address);
+            host_profile.mark(HostProfile::MEMORY);
+            dump();
+
+            if (finished)
+                break;
+            progress(1);
+            host_profile.mark(HostProfile::IO);
+        }
+    }
+
+    // Generates a signature file from a specified memory range: one
+    // lower-case hex word per line, formatted into a single buffer.
+    void generate_signature()
+    {
+        static const char HEX[] = "0123456789abcdef";
+        std::string text;
+        if (signature_end > signature_begin)
+            text.reserve((signature_end - signature_begin) / 4 * 9 + 9);
+        for (size_t addr = signature_begin; addr < signature_end; addr += 4) {
+            uint32_t word = memory->read(addr);
+            char line[9];
+            for (int i = 7; i >= 0; i--, word >>= 4)
+                line[i] = HEX[word & 0xF];
+            line[8] = '\n';
+            text.append(line, sizeof(line));
+        }
+
+        std::ofstream signature_file(signature_filename, std::ios::binary);
+        if (!signature_file.write(text.data(), text.size())) {
+            std::cerr << "Error: Could not write signature file "
+                      << signature_filename << std::endl;
+        }
+    }
+
+    void configure_trace(const HarnessArgs &args)
+    {
+        const std::string flag = std::string("-") + tracer.FORMAT;
+        const std::string other = flag == "-vcd" ? "-fst" : "-vcd";
+        if (args.value(other))
+            throw std::runtime_error(
+                other + " needs a model verilated with TRACE_FORMAT=" +
+                other.substr(1));
+        const std::string *file = args.value(flag);
+        if (!file)
+            return;
+
+        int depth = tracer.DEFAULT_DEPTH;
+        if (auto v = args.value("-trace-depth"))
+            depth = std::stoi(*v);
+        if (auto v = args.value("-trace-window"))
+            tracer.set_window(std::stoull(*v));
+        if (auto v = args.value("-trace-start-cycle")) {
+            trace_start_cycle = std::stoull(*v);
+            trace_armed = true;
+        }
+        if (auto v = args.value("-trace-start-pc")) {
+            trace_start_pc = parse_number(*v);
+            trace_armed = true;
+        }
+        if (auto v = args.value("-trace-start-write")) {
+            trace_start_write = parse_number(*v) & ~3u;
+            trace_armed = true;
+        }
+        tracing = !trace_armed;
+        tracer.enable(*file, *top, depth);
+    }
+
+public:
+    explicit Harness(const HarnessArgs &args) : top(std::make_unique<Top>())
+    {
+        size_t memory_words = 1024 * 1024;  // 4MB
+        if (auto v = args.value("-halt"))
+            halt_address = parse_number(*v);
+        if (auto v = args.value("-memory"))
+            memory_words = std::stoull(*v);
+        if (auto v = args.value("-time"))
+            max_sim_time = std::stoull(*v);
+        progress_step =
+            std::max<vluint64_t>(max_sim_time / Stage::PROGRESS_STEPS, 1);
+        progress_countdown = progress_step;
+        if (auto v = args.value("-signature", 3)) {
+            dump_signature = true;
+            signature_begin = parse_number(v[0]);
+            signature_end = parse_number(v[1]);
+            signature_filename = v[2];
+        }
+        if (auto v = args.value("-profile"))
+            profiler = std::make_unique<PcProfiler>(*v);
+        if (auto v = args.value("-profile-out"))
+            profile_prefix = *v;
+        fast_clock = args.has("-fast-clock");
+        configure_trace(args);
+        stage.configure(args);
+
+        memory = std::make_unique<RAM>(memory_words);
+        if (auto v = args.value("-instruction")) {
+            if (ElfImage::is_elf(*v)) {
+                elf = std::make_unique<ElfImage>(*v);
+                memory->load_elf(*elf, RESET_VECTOR);
+            } else {
+                memory->load_binary(*v, RESET_VECTOR);
+            }
+        }
+        if (auto v = args.value("-signature-file")) {
+            if (!elf || !elf->symbol("begin_signature", signature_begin) ||
+                !elf->symbol("end_signature", signature_end))
+                throw std::runtime_error(
+                    "-signature-file needs an ELF with begin_signature and "
+                    "end_signature");
+            dump_signature = true;
+            signature_filename = *v;
+        }
+        watch_memory(args);
+    }
+
+    ~Harness()
+    {
+        if (top)
+            top->final();
+    }
+
+    // Runs the simulation; returns the exit status set by the firmware
+    int run()
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (fast_clock)
+            run_fast_clock();
+        else
+            run_default_clock();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "Simulated " << cycles << " cycles in " << elapsed.count()
+                  << " s (" << cycles / elapsed.count() / 1000.0 << " kHz)"
+                  << std::endl;
+        std::string split = host_profile.summary(cycles);
+        if (!split.empty())
+            std::cout << "Host time: " << split << std::endl;
+        sim_ctrl.report();
+
+        if (dump_signature)
+            generate_signature();
+        if (trace_armed) {
+            std::cerr << "Trace trigger never fired; " << tracer.file()
+                      << " holds no samples" << std::endl;
+        } else if (tracer.windowed()) {
+            if (tracer.save())
+                std::cout << "Trace window ending at cycle " << cycles
+                          << " written to " << tracer.file() << std::endl;
+            else
+                std::cerr << "Error: Could not write trace " << tracer.file()
+                          << std::endl;
+        }
+        if (profiler) {
+            if (profiler->write(profile_prefix))
+                std::cout << "Profile written to " << profile_prefix
+                          << ".txt and " << profile_prefix << ".folded"
+                          << std::endl;
+            else
+                std::cerr << "Error: Could not write profile " << profile_prefix
+                          << std::endl;
+        }
+        stage.finish(*top);
+        return tohost_status ? tohost_status : sim_ctrl.exit_status();
+    }
+
+    static int main(int argc, char **argv)
+    {
+        Verilated::commandArgs(argc, argv);
+        try {
+            Harness harness(HarnessArgs(argc, argv));
+            return harness.run();
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+};
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Host-side time split of a simulation loop: how much of a run goes into
+// Verilated eval() and how much into the harness around it.
+//
+// The loop calls mark(component) after each piece of work; the time stamp
+// counter ticks since the previous mark are charged to that component, so
+// one rdtsc per mark is the whole cost and nothing between two marks goes
+// unaccounted. The counter is calibrated against steady_clock over the run.
+//
+// Built with -DSIM_HOST_PROFILE ("make verilator HOST_PROFILE=1"). Without
+// it HostProfile is an empty class whose calls compile to nothing and whose
+// reports are empty strings.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(SIM_HOST_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#ifdef SIM_HOST_PROFILE
+class HostProfile
+{
+public:
+    enum Component { EVAL, MEMORY, PERIPHERALS, IO, HARNESS, COMPONENTS };
+
+    // Starts the clock; time before this is not charged to anything
+    void start()
+    {
+        start_time = interval_time = std::chrono::steady_clock::now();
+        start_ticks = interval_ticks = last = now();
+        for (unsigned i = 0; i < COMPONENTS; i++)
+            total[i] = interval_total[i] = 0;
+        interval_cycles = 0;
+    }
+
+    inline void mark(Component component)
+    {
+        uint64_t t = now();
+        total[component] += t - last;
+        last = t;
+    }
+
+    // Split since the previous interval() call (or start()), for progress
+    // lines; cycles is the running simulated cycle count
+    std::string interval(uint64_t cycles)
+    {
+        uint64_t ticks = last - interval_ticks;
+        auto time = std::chrono::steady_clock::now();
+        std::chrono::duration<double> seconds = time - interval_time;
+        uint64_t split[COMPONENTS];
+        for (unsigned i = 0; i < COMPONENTS; i++) {
+            split[i] = total[i] - interval_total[i];
+            interval_total[i] = total[i];
+        }
+        std::string text =
+            format(cycles - interval_cycles, seconds.count(), split, ticks);
+        interval_ticks = last;
+        interval_time = time;
+        interval_cycles = cycles;
+        return text;
+    }
+
+    // Split over the whole run
+    std::string summary(uint64_t cycles) const
+    {
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start_time;
+        return format(cycles, seconds.count(), total, last - start_ticks);
+    }
+
+private:
+    static constexpr const char *NAMES[COMPONENTS] = {
+        "eval", "memory", "peripherals", "io", "harness"};
+
+    uint64_t total[COMPONENTS] = {};
+    uint64_t interval_total[COMPONENTS] = {};
+    uint64_t last = 0;
+    uint64_t start_ticks = 0;
+    uint64_t interval_ticks = 0;
+    uint64_t interval_cycles = 0;
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point interval_time;
+
+    static inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static std::string format(uint64_t cycles, double seconds,
+                              const uint64_t *split, uint64_t ticks)
+    {
+        char text[160];
+        int n = snprintf(text, sizeof(text), "%.3f MHz host",
+                         seconds > 0 ? cycles / seconds / 1e6 : 0.0);
+        for (unsigned i = 0; i < COMPONENTS && n < int(sizeof(text)); i++)
+            n += snprintf(text + n, sizeof(text) - n, ", %s %.1f%%", NAMES[i],
+                          ticks ? 100.0 * split[i] / ticks : 0.0);
+        return text;
+    }
+};
+#else
+class HostProfile
+{
+public:
+    enum Component { EVAL, MEMORY, PERIPHERALS, IO, HARNESS, COMPONENTS };
+
+    void start() {}
+    inline void mark(Component) {}
+    std::string interval(uint64_t) { return {}; }
+    std::string summary(uint64_t) const { return {}; }
+};
+#endif
@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Timing model of the main memory behind a Verilator harness's RAM port.
+//
+// The harness still serves RAM contents itself; MemoryTiming only decides
+// when. read() returns the cycle a word is answered, and write() posts a word
+// that is accepted at once but keeps its bank busy; write_ready() refuses
+// further writes while max_writes of them are still in flight.
+//
+// Addresses map to banks row by row (row:bank:column). Every word keeps its
+// bank busy for bank_busy cycles, which bounds the bandwidth. With the
+// row-buffer model (row_miss > 0) an access outside the bank's open row
+// first pays row_miss cycles to precharge and activate the row. The first
+// word of a transaction waits latency more cycles (controller and PHY); the
+// later words of a burst stream behind it.
+//
+// The default configuration is the ideal memory the harnesses always had:
+// every access is answered in the cycle it is made.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+class MemoryTiming
+{
+public:
+    struct Config {
+        unsigned latency = 0;      // Cycles before the first word of a read
+        unsigned banks = 1;        // Independent banks, interleaved by row
+        unsigned bank_busy = 0;    // Cycles a bank is occupied per word
+        unsigned max_writes = 0;   // Posted writes in flight (0 = no limit)
+        unsigned row_bytes = 2048; // Row (page) size of one bank
+        unsigned row_miss = 0;     // Precharge + activate (0 = no row model)
+
+        bool ideal() const
+        {
+            return !latency && !bank_busy && !max_writes && !row_miss;
+        }
+    };
+
+    struct Stats {
+        uint64_t reads = 0;         // Words read
+        uint64_t writes = 0;        // Words written
+        uint64_t transactions = 0;  // Reads that started a transaction
+        uint64_t first_latency = 0; // Request to first word, summed
+        uint64_t read_latency = 0;  // Request to data of every word, summed
+        uint64_t row_hits = 0;
+        uint64_t row_misses = 0;
+        uint64_t write_full = 0;    // Cycles write_ready() was false
+    };
+
+    MemoryTiming() : MemoryTiming(Config{}) {}
+
+    explicit MemoryTiming(const Config &timing)
+        : config(timing), state(std::max(1u, timing.banks))
+    {
+        if (!config.row_bytes)
+            config.row_bytes = 2048;
+    }
+
+    // Idle banks, closed rows and zero statistics, for a new run
+    void reset()
+    {
+        std::fill(state.begin(), state.end(), Bank());
+        in_flight.clear();
+        counts = Stats();
+    }
+
+    // Cycle at which the word at address, requested at cycle now, is
+    // returned; burst is set for the later words of a burst
+    uint64_t read(uint64_t now, uint32_t address, bool burst)
+    {
+        uint64_t ready = access(now, address) + (burst ? 0 : config.latency);
+        counts.reads++;
+        counts.read_latency += ready - now;
+        if (!burst) {
+            counts.transactions++;
+            counts.first_latency += ready - now;
+        }
+        return ready;
+    }
+
+    // Posts the word written at address at cycle now
+    void write(uint64_t now, uint32_t address)
+    {
+        access(now, address);
+        in_flight.push_back(state[bank_of(address)].free);
+        counts.writes++;
+    }
+
+    // Whether a write can be posted in cycle now
+    bool write_ready(uint64_t now)
+    {
+        while (!in_flight.empty() && in_flight.front() <= now)
+            in_flight.pop_front();
+        if (!config.max_writes || in_flight.size() < config.max_writes)
+            return true;
+        counts.write_full++;
+        return false;
+    }
+
+    const Config &configuration() const { return config; }
+    const Stats &stats() const { return counts; }
+
+    // Bytes transferred per cycle over a run of cycles
+    double bandwidth(uint64_t cycles) const
+    {
+        return cycles ? 4.0 * (counts.reads + counts.writes) / cycles : 0.0;
+    }
+
+    double average_latency() const
+    {
+        return counts.transactions
+                   ? double(counts.first_latency) / counts.transactions
+                   : 0.0;
+    }
+
+    // One line for the run summary
+    std::string summary(uint64_t cycles) const
+    {
+        char text[192];
+        int n = snprintf(
+            text, sizeof(text),
+            "%llu reads, %llu writes, %.3f bytes/cycle, "
+            "%.2f cycles to first word, %.2f per word",
+            (unsigned long long) counts.reads,
+            (unsigned long long) counts.writes, bandwidth(cycles),
+            average_latency(),
+            counts.reads ? double(counts.read_latency) / counts.reads : 0.0);
+        if (config.row_miss && n < int(sizeof(text)))
+            n += snprintf(text + n, sizeof(text) - n, ", %.1f%% row hits",
+                          row_hit_rate() * 100);
+        if (config.max_writes && n < int(sizeof(text)))
+            snprintf(text + n, sizeof(text) - n, ", writes full %llu cycles",
+                     (unsigned long long) counts.write_full);
+        return text;
+    }
+
+    // JSON members for a report, each preceded by sep
+    void write_fields(FILE *f, const char *sep, uint64_t cycles) const
+    {
+        std::fprintf(f,
+                     "%s\"mem_reads\": %llu,%s\"mem_writes\": %llu,"
+                     "%s\"mem_bytes_per_cycle\": %.6f,"
+                     "%s\"mem_read_latency\": %.6f,%s\"mem_row_hits\": %llu,"
+                     "%s\"mem_row_misses\": %llu,%s\"mem_write_full\": %llu",
+                     sep, (unsigned long long) counts.reads, sep,
+                     (unsigned long long) counts.writes, sep,
+                     bandwidth(cycles), sep, average_latency(), sep,
+                     (unsigned long long) counts.row_hits, sep,
+                     (unsigned long long) counts.row_misses, sep,
+                     (unsigned long long) counts.write_full);
+    }
+
+private:
+    struct Bank {
+        uint64_t free = 0;        // First cycle the bank can start a word
+        int64_t open_row = -1;
+    };
+
+    Config config;
+    std::vector<Bank> state;
+    std::deque<uint64_t> in_flight;  // Cycles posted writes release the bank
+    Stats counts;
+
+    double row_hit_rate() const
+    {
+        uint64_t total = counts.row_hits + counts.row_misses;
+        return total ? double(counts.row_hits) / total : 0.0;
+    }
+
+    inline unsigned bank_of(uint32_t address) const
+    {
+        return (address / config.row_bytes) % state.size();
+    }
+
+    // Occupies the bank for one word requested at now; returns the cycle the
+    // word is transferred, after any wait for the bank and row activation
+    uint64_t access(uint64_t now, uint32_t address)
+    {
+        Bank &bank = state[bank_of(address)];
+        uint64_t start = std::max(now, bank.free);
+        if (config.row_miss) {
+            int64_t row = address / config.row_bytes / state.size();
+            if (row == bank.open_row) {
+                counts.row_hits++;
+            } else {
+                counts.row_misses++;
+                bank.open_row = row;
+                start += config.row_miss;
+            }
+        }
+        bank.free = start + config.bank_busy;
+        return start;
+    }
+};
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Cycle-accurate PC profiler for the Verilator harnesses.
+//
+// sample() is called once per CPU cycle with the fetch PC. Every cycle is
+// counted in a dense per-word histogram over the ELF's code range, so the
+// flat profile costs one increment per cycle. A shadow call stack is only
+// updated when the PC leaves the current function: entering a function at its
+// first instruction is a call, reaching a function already on the stack is a
+// return to it, anything else (tail call, wrong-path fetch) replaces the top
+// frame. Cycles are attributed to the current stack for a folded-stack file
+// that flamegraph.pl or speedscope can render.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "elf_symbols.h"
+
+class PcProfiler
+{
+public:
+    static constexpr size_t MAX_DEPTH = 64;
+
+    explicit PcProfiler(const std::string &elf_filename)
+        : symbols(elf_filename),
+          code_start(symbols.code_start()),
+          code_end(symbols.code_end())
+    {
+        histogram.assign((code_end - code_start) / 4 + 1, 0);
+    }
+
+    inline void sample(uint32_t pc)
+    {
+        if (pc - code_start < code_end - code_start)
+            histogram[(pc - code_start) >> 2]++;
+        else
+            outside_cycles++;
+        if (pc - current_start >= current_end - current_start)
+            transition(pc);
+        run_cycles++;
+        total_cycles++;
+    }
+
+    // Writes <prefix>.txt (flat profile) and <prefix>.folded
+    bool write(const std::string &prefix)
+    {
+        flush_run();
+        const auto &syms = symbols.symbols();
+
+        std::vector<uint64_t> self(syms.size(), 0), inclusive(syms.size(), 0);
+        for (size_t i = 0; i < histogram.size(); i++) {
+            if (!histogram[i])
+                continue;
+            if (const ElfSymbols::Symbol *s = symbols.find(code_start + i * 4))
+                self[symbols.index_of(s)] += histogram[i];
+        }
+        for (const auto &entry : folded) {
+            std::vector<uint32_t> seen;
+            for (uint32_t f : entry.first) {
+                if (f == UNKNOWN || std::count(seen.begin(), seen.end(), f))
+                    continue;
+                seen.push_back(f);
+                inclusive[f] += entry.second;
+            }
+        }
+
+        FILE *flat = std::fopen((prefix + ".txt").c_str(), "w");
+        if (!flat)
+            return false;
+        std::vector<size_t> order;
+        for (size_t i = 0; i < syms.size(); i++)
+            if (self[i] || inclusive[i])
+                order.push_back(i);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return self[a] != self[b] ? self[a] > self[b]
+                                      : inclusive[a] > inclusive[b];
+        });
+        std::fprintf(flat, "# %llu cycles profiled (%llu outside symbols)\n",
+                     (unsigned long long) total_cycles,
+                     (unsigned long long) outside_cycles);
+        std::fprintf(flat, "#  self%%    self cycles   incl%%    incl cycles  "
+                           "function\n");
+        for (size_t i : order)
+            std::fprintf(flat, "%6.2f %14llu %7.2f %14llu  %s\n",
+                         percent(self[i]), (unsigned long long) self[i],
+                         percent(inclusive[i]),
+                         (unsigned long long) inclusive[i],
+                         syms[i].name.c_str());
+
+        std::vector<size_t> hot;
+        for (size_t i = 0; i < histogram.size(); i++)
+            if (histogram[i])
+                hot.push_back(i);
+        size_t top = std::min<size_t>(hot.size(), 32);
+        std::partial_sort(
+            hot.begin(), hot.begin() + top, hot.end(),
+            [&](size_t a, size_t b) { return histogram[a] > histogram[b]; });
+        std::fprintf(flat, "\n# Hottest PCs\n");
+        for (size_t k = 0; k < top; k++) {
+            uint32_t pc = code_start + hot[k] * 4;
+            const ElfSymbols::Symbol *s = symbols.find(pc);
+            std::fprintf(flat, "%6.2f %14llu  0x%08x  %s+0x%x\n",
+                         percent(histogram[hot[k]]),
+                         (unsigned long long) histogram[hot[k]], pc,
+                         s ? s->name.c_str() : "?", s ? pc - s->start : 0);
+        }
+        bool ok = std::fclose(flat) == 0;
+
+        FILE *stacks = std::fopen((prefix + ".folded").c_str(), "w");
+        if (!stacks)
+            return false;
+        for (const auto &entry : folded) {
+            for (size_t i = 0; i < entry.first.size(); i++)
+                std::fprintf(stacks, "%s%s", i ? ";" : "",
+                             entry.first[i] == UNKNOWN
+                                 ? "[unknown]"
+                                 : syms[entry.first[i]].name.c_str());
+            std::fprintf(stacks, " %llu\n", (unsigned long long) entry.second);
+        }
+        return std::fclose(stacks) == 0 && ok;
+    }
+
+private:
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    double percent(uint64_t n) const
+    {
+        return total_cycles ? 100.0 * n / total_cycles : 0.0;
+    }
+
+    void flush_run()
+    {
+        if (run_cycles && !stack.empty())
+            folded[stack] += run_cycles;
+        run_cycles = 0;
+    }
+
+    void transition(uint32_t pc)
+    {
+        flush_run();
+        const ElfSymbols::Symbol *s = symbols.find(pc);
+        uint32_t f = s ? symbols.index_of(s) : UNKNOWN;
+        // An unknown PC gets an empty range so the next cycle looks again
+        current_start = s ? s->start : pc;
+        current_end = s ? s->end : pc;
+
+        for (size_t depth = stack.size(); depth-- > 1;) {
+            if (stack[depth - 1] == f) {
+                stack.resize(depth);  // Returned to a caller
+                return;
+            }
+        }
+        if (s && pc == s->start && stack.size() < MAX_DEPTH)
+            stack.push_back(f);  // Call
+        else if (stack.empty())
+            stack.push_back(f);
+        else
+            stack.back() = f;  // Tail call, jump or wrong-path fetch
+    }
+
+    ElfSymbols symbols;
+    uint32_t code_start;
+    uint32_t code_end;
+    std::vector<uint64_t> histogram;
+    uint64_t outside_cycles = 0;
+    uint64_t total_cycles = 0;
+
+    uint32_t current_start = 0;
+    uint32_t current_end = 0;
+    std::vector<uint32_t> stack;
+    uint64_t run_cycles = 0;
+    std::map<std::vector<uint32_t>, uint64_t> folded;
+};
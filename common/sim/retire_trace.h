@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Binary retire trace for the Verilator harnesses: one record per retired
+// instruction, written by a background thread.
+//
+// The file starts with the 8-byte magic "MYCPURT1". Every record starts with
+// a flag byte, followed by the fields the flags select, in this order:
+//
+//   PC_JUMP   zigzag varint, pc - (previous pc + 4); absent: sequential
+//   CYCLES    varint, cycles since the previous record - 1; absent: 1
+//   INSN      instruction word, 4 bytes little-endian; absent: the word last
+//             recorded for this pc in a 4096-entry direct-mapped table
+//             indexed by pc[13:2], which the reader keeps in step
+//   RD        rd (1 byte), then zigzag varint of the value minus the previous
+//             value recorded for that register
+//   MEM       zigzag varint, address minus the previous load/store address;
+//             present for loads and stores only
+//
+// The first record is encoded as if it followed pc 0xFFFFFFFC at cycle 0,
+// with all registers zero and an empty instruction table. A typical record is
+// a flag byte and a short value delta; records stay byte-aligned so zstd still
+// finds the repetition of loops, and the output is piped through zstd when the
+// filename ends in ".zst".
+//
+// record() only appends to a buffer; full buffers are swapped with the writer
+// thread's, so the simulation only waits if the disk falls a whole buffer
+// behind.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RetireTrace
+{
+public:
+    enum Flags : uint8_t {
+        PC_JUMP = 1 << 0,
+        CYCLES = 1 << 1,
+        INSN = 1 << 2,
+        RD = 1 << 3,
+        MEM = 1 << 4,
+    };
+    static constexpr char MAGIC[8] = {'M', 'Y', 'C', 'P', 'U', 'R', 'T', '1'};
+    static constexpr size_t INSN_TABLE_SIZE = 4096;
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    // Opens the file (or a zstd pipe to it); throws on failure
+    explicit RetireTrace(const std::string &filename) : name(filename)
+    {
+        compressed = name.size() > 4 &&
+                     name.compare(name.size() - 4, 4, ".zst") == 0;
+        if (compressed) {
+            if (name.find('\'') != std::string::npos)
+                throw std::runtime_error("Unsupported trace filename " + name);
+            std::string command = "zstd -q -f -o '" + name + "'";
+            out = popen(command.c_str(), "w");
+        } else {
+            out = fopen(name.c_str(), "wb");
+        }
+        if (!out)
+            throw std::runtime_error("Cannot open retire trace " + name);
+        fwrite(MAGIC, 1, sizeof(MAGIC), out);
+        buffer.reserve(BUFFER_SIZE + 32);
+        pending.reserve(BUFFER_SIZE + 32);
+        thread = std::thread(&RetireTrace::write_loop, this);
+    }
+
+    ~RetireTrace() { close(); }
+
+    RetireTrace(const RetireTrace &) = delete;
+    RetireTrace &operator=(const RetireTrace &) = delete;
+
+    inline void record(uint64_t cycle,
+                       uint32_t pc,
+                       uint32_t instruction,
+                       bool rd_write,
+                       uint8_t rd,
+                       uint32_t rd_data,
+                       uint32_t mem_address)
+    {
+        size_t start = buffer.size();
+        buffer.push_back(0);
+        uint8_t flags = 0;
+
+        if (pc != last_pc + 4) {
+            flags |= PC_JUMP;
+            put_signed(pc - (last_pc + 4));
+        }
+        last_pc = pc;
+
+        if (cycle - last_cycle != 1) {
+            flags |= CYCLES;
+            put_varint(cycle - last_cycle - 1);
+        }
+        last_cycle = cycle;
+
+        InsnEntry &entry = insn_table[(pc >> 2) % INSN_TABLE_SIZE];
+        if (entry.pc != pc || entry.instruction != instruction) {
+            flags |= INSN;
+            for (int shift = 0; shift < 32; shift += 8)
+                buffer.push_back(instruction >> shift);
+            entry = {pc, instruction};
+        }
+
+        if (rd_write && rd != 0) {
+            flags |= RD;
+            rd &= 31;
+            buffer.push_back(rd);
+            put_signed(rd_data - regs[rd]);
+            regs[rd] = rd_data;
+        }
+
+        uint32_t opcode = instruction & 0x7f;
+        if (opcode == 0x03 || opcode == 0x23) {
+            flags |= MEM;
+            put_signed(mem_address - last_mem_address);
+            last_mem_address = mem_address;
+        }
+
+        buffer[start] = flags;
+        records++;
+        if (buffer.size() >= BUFFER_SIZE)
+            hand_off();
+    }
+
+    // Flushes everything recorded so far and closes the file; returns false
+    // if any write failed.
+    bool close()
+    {
+        if (!out)
+            return ok;
+        hand_off();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+        if (compressed)
+            ok = pclose(out) == 0 && ok;
+        else
+            ok = fclose(out) == 0 && ok;
+        out = nullptr;
+        return ok;
+    }
+
+    uint64_t instructions() const { return records; }
+    uint64_t bytes() const { return written + sizeof(MAGIC); }
+    const std::string &filename() const { return name; }
+
+private:
+    struct InsnEntry {
+        uint32_t pc = 0xFFFFFFFF;
+        uint32_t instruction = 0;
+    };
+
+    inline void put_varint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    // 32-bit wrapping difference, zigzag encoded so small negatives stay short
+    inline void put_signed(uint32_t difference)
+    {
+        uint32_t sign = static_cast<int32_t>(difference) < 0 ? ~0u : 0u;
+        put_varint((difference << 1) ^ sign);
+    }
+
+    // Waits for the writer to finish the previous buffer, then gives it this
+    // one
+    void hand_off()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&] { return pending.empty(); });
+        written += buffer.size();
+        pending.swap(buffer);
+        lock.unlock();
+        wake.notify_all();
+    }
+
+    void write_loop()
+    {
+        std::vector<uint8_t> chunk;
+        chunk.reserve(BUFFER_SIZE + 32);
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return !pending.empty() || stopping; });
+                if (pending.empty())
+                    break;
+                chunk.swap(pending);
+            }
+            idle.notify_all();
+            if (fwrite(chunk.data(), 1, chunk.size(), out) != chunk.size())
+                ok = false;
+            chunk.clear();
+        }
+    }
+
+    std::string name;
+    bool compressed = false;
+    FILE *out = nullptr;
+
+    // Simulation thread
+    std::vector<uint8_t> buffer;
+    uint32_t last_pc = 0xFFFFFFFC;
+    uint64_t last_cycle = 0;
+    uint32_t last_mem_address = 0;
+    uint32_t regs[32] = {};
+    InsnEntry insn_table[INSN_TABLE_SIZE];
+    uint64_t records = 0;
+    uint64_t written = 0;
+
+    // Shared with the writer thread
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::vector<uint8_t> pending;
+    bool stopping = false;
+    bool ok = true;
+
+    std::thread thread;
+};
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Simulation control registers shared by the Verilator harnesses: the exit,
+// result, timestamp and region-timer device. See 4-soc/csrc/mmio.h for the
+// firmware side.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Simulation control registers, decoded in the RAM write path. They sit in
+// the unused page below the program image (0x1000), so firmware reaches them
+// with plain stores and the writes still land in RAM. 4-soc's data cache and
+// store buffer pass this page through uncached (Parameters.UncachedBytes).
+class SimControl
+{
+public:
+    static constexpr uint32_t BASE = 0x100;
+    static constexpr uint32_t DONE = 0x100;       // TEST_DONE_FLAG
+    static constexpr uint32_t RESULT = 0x104;     // TEST_RESULT
+    static constexpr uint32_t EXIT = 0x108;       // Exit, status = value
+    static constexpr uint32_t TIMESTAMP = 0x10C;  // Print host time, tag = value
+    static constexpr uint32_t REGION_BEGIN = 0x110;
+    static constexpr uint32_t REGION_END = 0x114;
+    static constexpr uint32_t LIMIT = 0x118;
+    static constexpr uint32_t DONE_MAGIC = 0xCAFEF00D;
+    // Not a register: a RAM word past LIMIT that the 4-soc harness sets to
+    // PRELOADED_MAGIC after loading an ELF with .bss already zeroed; init.S
+    // reads and clears it
+    static constexpr uint32_t PRELOADED = 0x11C;
+    static constexpr uint32_t PRELOADED_MAGIC = 0x464C457F;  // "\x7fELF"
+    static constexpr unsigned REGIONS = 8;
+
+    SimControl() : start_time(std::chrono::steady_clock::now()) {}
+
+    bool contains(uint32_t addr) const { return addr >= BASE && addr < LIMIT; }
+
+    // Returns true once the firmware has asked the simulation to stop
+    bool write(uint32_t addr, uint32_t value, uint64_t cpu_cycle)
+    {
+        switch (addr & ~3u) {
+        case DONE:
+            if (value != DONE_MAGIC)
+                break;
+            std::cout << "\n✅ Test done";
+            if (has_result)
+                std::cout << " (result=0x" << std::hex << result << std::dec
+                          << ")";
+            std::cout << " at cycle " << cpu_cycle << "\n";
+            finished = true;
+            break;
+        case RESULT:
+            result = value;
+            has_result = true;
+            break;
+        case EXIT:
+            std::cout << "\n🏁 Exit(" << value << ") at cycle " << cpu_cycle
+                      << "\n";
+            status = static_cast<int>(value & 0xFF);
+            finished = true;
+            break;
+        case TIMESTAMP: {
+            std::chrono::duration<double> host =
+                std::chrono::steady_clock::now() - start_time;
+            std::cout << "⏱️  Timestamp " << value << ": cycle " << cpu_cycle
+                      << ", host +" << host.count() << " s\n";
+            break;
+        }
+        case REGION_BEGIN:
+            if (value < REGIONS) {
+                regions[value].start = cpu_cycle;
+                regions[value].active = true;
+            }
+            break;
+        case REGION_END:
+            if (value < REGIONS && regions[value].active) {
+                regions[value].cycles += cpu_cycle - regions[value].start;
+                regions[value].passes++;
+                regions[value].active = false;
+            }
+            break;
+        default:
+            break;
+        }
+        return finished;
+    }
+
+    int exit_status() const { return status; }
+
+    void report() const
+    {
+        for (unsigned i = 0; i < REGIONS; i++) {
+            if (!regions[i].passes)
+                continue;
+            std::cout << "📏 Region " << i << ": " << regions[i].cycles
+                      << " cycles in " << regions[i].passes << " pass"
+                      << (regions[i].passes == 1 ? "" : "es") << "\n";
+        }
+    }
+
+private:
+    struct Region {
+        uint64_t start = 0;
+        uint64_t cycles = 0;
+        uint64_t passes = 0;
+        bool active = false;
+    };
+
+    std::chrono::steady_clock::time_point start_time;
+    Region regions[REGIONS];
+    uint32_t result = 0;
+    bool has_result = false;
+    bool finished = false;
+    int status = 0;
+};
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Sparse memory model shared by the Verilator harnesses.
+//
+// The whole simulated address space is reserved up front with an anonymous
+// MAP_NORESERVE mapping, so the kernel only commits (and zeroes) pages that
+// are actually touched. Program images are mapped copy-on-write straight
+// from the file at their load address instead of being read and copied, and
+// every page written by the simulation is recorded in a dirty bitmap. A
+// multi-hundred-megabyte memory therefore costs nothing at process start.
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class SparseMemory
+{
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr size_t PAGE_SHIFT = 12;
+
+    explicit SparseMemory(size_t size_bytes)
+        : bytes((size_bytes + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1)),
+          dirty((bytes / PAGE_SIZE + 63) / 64, 0),
+          mapped((bytes / PAGE_SIZE + 63) / 64, 0)
+    {
+        void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Cannot reserve " +
+                                     std::to_string(bytes) +
+                                     " bytes of simulated memory");
+        base = static_cast<uint8_t *>(p);
+    }
+
+    ~SparseMemory() { munmap(base, bytes); }
+
+    SparseMemory(const SparseMemory &) = delete;
+    SparseMemory &operator=(const SparseMemory &) = delete;
+
+    size_t size() const { return bytes; }
+    bool contains(size_t address) const { return address < bytes; }
+
+    // Word access; address is a byte address, the low two bits are ignored.
+    // Out-of-range reads return 0 and out-of-range writes are dropped.
+    inline uint32_t read(size_t address) const
+    {
+        address &= ~size_t(3);
+        if (address >= bytes)
+            return 0;
+        return *reinterpret_cast<const uint32_t *>(base + address);
+    }
+
+    inline void write(size_t address, uint32_t value, uint32_t mask)
+    {
+        address &= ~size_t(3);
+        if (address >= bytes)
+            return;
+        uint32_t *word = reinterpret_cast<uint32_t *>(base + address);
+        *word = (*word & ~mask) | (value & mask);
+        size_t page = address >> PAGE_SHIFT;
+        dirty[page >> 6] |= uint64_t(1) << (page & 63);
+    }
+
+    // Byte-enable strobe (bit i = byte lane i) to a 32-bit write mask
+    static constexpr uint32_t strobe_mask(uint8_t strobe)
+    {
+        return ((strobe & 1) ? 0x000000FFu : 0) |
+               ((strobe & 2) ? 0x0000FF00u : 0) |
+               ((strobe & 4) ? 0x00FF0000u : 0) |
+               ((strobe & 8) ? 0xFF000000u : 0);
+    }
+
+    // Map a binary image at load_address. Page-aligned loads are mapped
+    // MAP_PRIVATE over the reservation (zero-copy, copy-on-write; the file is
+    // never modified). Unaligned loads fall back to pread(). Returns the
+    // image size in bytes.
+    size_t load_binary(const std::string &filename, size_t load_address)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open file " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot determine size: " + filename);
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        if (load_address > bytes || size > bytes - load_address) {
+            close(fd);
+            throw std::runtime_error(
+                "File " + filename + " is too large (File is " +
+                std::to_string(size) + " bytes. Memory is " +
+                std::to_string(bytes - std::min(load_address, bytes)) +
+                " bytes.)");
+        }
+        if (size == 0) {
+            close(fd);
+            return 0;
+        }
+
+        bool zero_copy = false;
+        if ((load_address & (PAGE_SIZE - 1)) == 0) {
+            void *p = mmap(base + load_address, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_FIXED, fd, 0);
+            zero_copy = p != MAP_FAILED;
+        }
+        if (!zero_copy) {
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = pread(fd, base + load_address + done, size - done,
+                                  static_cast<off_t>(done));
+                if (n <= 0) {
+                    close(fd);
+                    throw std::runtime_error("Read error: " + filename);
+                }
+                done += static_cast<size_t>(n);
+            }
+        }
+        close(fd);
+
+        mark_mapped(load_address, size);
+        return size;
+    }
+
+    // Copy size bytes to address (e.g. an ELF segment); the pages count as
+    // loaded image, not as simulation writes
+    void copy_in(size_t address, const void *data, size_t size)
+    {
+        if (address > bytes || size > bytes - address)
+            throw std::runtime_error("Image outside simulated memory");
+        if (size == 0)
+            return;
+        std::copy_n(static_cast<const uint8_t *>(data), size, base + address);
+        mark_mapped(address, size);
+    }
+
+    // Zero size bytes at address. Pages never loaded or written are already
+    // zero and are left uncommitted.
+    void zero(size_t address, size_t size)
+    {
+        if (address > bytes || size > bytes - address)
+            throw std::runtime_error("Range outside simulated memory");
+        size_t end = address + size;
+        while (address < end) {
+            size_t page = address >> PAGE_SHIFT;
+            size_t page_end = std::min(end, (page + 1) << PAGE_SHIFT);
+            if (((dirty[page >> 6] | mapped[page >> 6]) >> (page & 63)) & 1)
+                std::fill(base + address, base + page_end, 0);
+            address = page_end;
+        }
+    }
+
+    // Drop all contents (loaded images and writes) and return to all-zero
+    void clear()
+    {
+        void *p = mmap(base, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+                       -1, 0);
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Cannot reset simulated memory");
+        std::fill(dirty.begin(), dirty.end(), 0);
+        std::fill(mapped.begin(), mapped.end(), 0);
+    }
+
+    bool page_dirty(size_t page) const
+    {
+        return (dirty[page >> 6] >> (page & 63)) & 1;
+    }
+
+    // Call f(page_index, page_data) for every page that can hold non-zero
+    // data: pages backed by a loaded image or written since. Pages never
+    // touched are known to be zero and are skipped.
+    template <typename F>
+    void for_each_populated_page(F &&f) const
+    {
+        for (size_t i = 0; i < dirty.size(); i++) {
+            uint64_t bits = dirty[i] | mapped[i];
+            while (bits) {
+                size_t page = i * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                f(page, base + (page << PAGE_SHIFT));
+            }
+        }
+    }
+
+    // Overwrite one whole page (e.g. from a checkpoint); marks it dirty
+    void write_page(size_t page, const void *data)
+    {
+        if ((page << PAGE_SHIFT) >= bytes)
+            throw std::runtime_error("Page outside simulated memory");
+        std::copy_n(static_cast<const uint8_t *>(data), PAGE_SIZE,
+                    base + (page << PAGE_SHIFT));
+        dirty[page >> 6] |= uint64_t(1) << (page & 63);
+    }
+
+private:
+    void mark_mapped(size_t address, size_t size)
+    {
+        for (size_t page = address >> PAGE_SHIFT;
+             page <= (address + size - 1) >> PAGE_SHIFT; page++)
+            mapped[page >> 6] |= uint64_t(1) << (page & 63);
+    }
+
+    size_t bytes;
+    uint8_t *base = nullptr;
+    std::vector<uint64_t> dirty;   // Written by the simulation
+    std::vector<uint64_t> mapped;  // Backed by a loaded image
+};
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Transaction-level view of the 4-soc VGA peripheral, without SDL.
+//
+// VGAFramebuffer shadows the peripheral's 12 frames of 64×64 palette indices
+// from its framebuffer write sideband. At the end of each scanned frame the
+// harness resolves the selected frame through CTRL and the palette into 64×64
+// 6-bit RRGGBB colours, the way the scan-out would, instead of storing 640×480
+// pixels one pixel clock at a time.
+//
+// VGAFrameDump writes the resolved frames as a numbered PNG or raw sequence
+// and logs one CRC-32 per frame, so a frame sequence can be checked against a
+// reference without looking at images.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// CRC-32 (IEEE 802.3, as in PNG and zlib), continuing from crc
+inline uint32_t vga_crc32(const uint8_t *data, size_t size, uint32_t crc = 0)
+{
+    static const auto TABLE = [] {
+        std::vector<uint32_t> table(256);
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return table;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+class VGAFramebuffer
+{
+public:
+    static constexpr int WIDTH = 64;
+    static constexpr int HEIGHT = 64;
+    static constexpr int PIXELS = WIDTH * HEIGHT;
+    static constexpr int FRAMES = 12;
+    static constexpr int WORDS_PER_FRAME = PIXELS / 8;
+    static constexpr int SCALE = 6;  // Each pixel is 6×6 on the 640×480 screen
+
+    // CTRL bits (VGA.scala)
+    static constexpr uint32_t CTRL_ENABLE = 1u << 0;
+    static constexpr uint32_t CTRL_BLANK = 1u << 1;
+    static constexpr unsigned CTRL_FRAME_SHIFT = 4;
+
+    // Colour of the display area while the display is disabled, and of the
+    // border around the scaled frame
+    static constexpr uint8_t BACKGROUND = 0x01;
+
+    VGAFramebuffer() : words(FRAMES * WORDS_PER_FRAME, 0) {}
+
+    inline void write(uint32_t address, uint32_t data)
+    {
+        if (address < words.size())
+            words[address] = data;
+    }
+
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    // 64×64 RRGGBB colours of the frame CTRL selects
+    void resolve(uint32_t ctrl, const uint8_t *palette, uint8_t *pixels) const
+    {
+        if (ctrl & CTRL_BLANK) {
+            std::fill(pixels, pixels + PIXELS, 0);
+            return;
+        }
+        if (!(ctrl & CTRL_ENABLE)) {
+            std::fill(pixels, pixels + PIXELS, BACKGROUND);
+            return;
+        }
+        unsigned frame = (ctrl >> CTRL_FRAME_SHIFT) & 0xF;
+        const uint32_t *word = &words[std::min<unsigned>(frame, FRAMES - 1) *
+                                      WORDS_PER_FRAME];
+        for (int i = 0; i < PIXELS; i++)
+            pixels[i] = palette[(word[i >> 3] >> ((i & 7) * 4)) & 0xF] & 0x3F;
+    }
+
+    // Raw words for checkpoints
+    uint32_t *data() { return words.data(); }
+    size_t bytes() const { return words.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t> words;
+};
+
+class VGAFrameDump
+{
+public:
+    enum class Format { PNG, RAW };
+
+    // Frames go to <prefix>-<n>.png (or .raw, 4096 RRGGBB bytes) and the CRC
+    // log to <prefix>.crc
+    VGAFrameDump(const std::string &file_prefix, Format file_format)
+        : prefix(file_prefix), format(file_format), log(prefix + ".crc")
+    {
+        if (!log)
+            throw std::runtime_error("Cannot create " + prefix + ".crc");
+        log << "# frame cpu_cycle crc32\n";
+    }
+
+    // Writes one resolved frame; returns its CRC-32 over the RRGGBB bytes
+    uint32_t write(uint64_t cpu_cycle, const uint8_t *pixels)
+    {
+        uint32_t crc = vga_crc32(pixels, VGAFramebuffer::PIXELS);
+        char name[32];
+        snprintf(name, sizeof(name), "-%05llu.%s", (unsigned long long) count,
+                 format == Format::PNG ? "png" : "raw");
+        std::ofstream file(prefix + name, std::ios::binary);
+        if (format == Format::PNG)
+            write_png(file, pixels);
+        else
+            file.write(reinterpret_cast<const char *>(pixels),
+                       VGAFramebuffer::PIXELS);
+        if (!file)
+            throw std::runtime_error("Cannot write " + prefix + name);
+
+        char line[64];
+        snprintf(line, sizeof(line), "%llu %llu %08x\n",
+                 (unsigned long long) count, (unsigned long long) cpu_cycle,
+                 crc);
+        log << line << std::flush;
+        count++;
+        return crc;
+    }
+
+    uint64_t frames() const { return count; }
+
+private:
+    std::string prefix;
+    Format format;
+    std::ofstream log;
+    uint64_t count = 0;
+
+    static void put32(std::string &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<char>(value >> shift));
+    }
+
+    static void chunk(std::ostream &file, const char *type,
+                      const std::string &data)
+    {
+        std::string out;
+        put32(out, data.size());
+        out.append(type, 4);
+        out += data;
+        put32(out, vga_crc32(reinterpret_cast<const uint8_t *>(out.data()) + 4,
+                             out.size() - 4));
+        file.write(out.data(), out.size());
+    }
+
+    // 8-bit RGB PNG; the image data is one stored (uncompressed) deflate
+    // block, which needs no zlib and is small at 64×64
+    static void write_png(std::ostream &file, const uint8_t *pixels)
+    {
+        static const char SIGNATURE[8] = {'\x89', 'P',  'N',    'G',
+                                          '\r',   '\n', '\x1a', '\n'};
+        file.write(SIGNATURE, sizeof(SIGNATURE));
+
+        std::string header;
+        put32(header, VGAFramebuffer::WIDTH);
+        put32(header, VGAFramebuffer::HEIGHT);
+        header += std::string("\x08\x02\x00\x00\x00", 5);
+        chunk(file, "IHDR", header);
+
+        std::string raw;
+        for (int y = 0; y < VGAFramebuffer::HEIGHT; y++) {
+            raw.push_back(0);  // Filter: none
+            for (int x = 0; x < VGAFramebuffer::WIDTH; x++) {
+                uint8_t c = pixels[y * VGAFramebuffer::WIDTH + x];
+                raw.push_back(static_cast<char>(((c >> 4) & 3) * 85));
+                raw.push_back(static_cast<char>(((c >> 2) & 3) * 85));
+                raw.push_back(static_cast<char>((c & 3) * 85));
+            }
+        }
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : raw) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        std::string zlib("\x78\x01\x01", 3);
+        uint16_t len = raw.size();
+        zlib.push_back(static_cast<char>(len & 0xFF));
+        zlib.push_back(static_cast<char>(len >> 8));
+        zlib.push_back(static_cast<char>(~len & 0xFF));
+        zlib.push_back(static_cast<char>((~len >> 8) & 0xFF));
+        zlib += raw;
+        put32(zlib, (b << 16) | a);
+        chunk(file, "IDAT", zlib);
+        chunk(file, "IEND", "");
+    }
+};
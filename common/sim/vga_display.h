@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// SDL2 window for the VGA peripheral, shared by the Verilator harnesses.
+//
+// The simulation thread only stores pixels: update_pixel() is one table
+// lookup and one 32-bit store into the back buffer. At the end of each frame
+// (vsync falling edge) the frame is handed to a render thread, which owns
+// every SDL call: texture upload, presentation and event polling. Frames are
+// presented at most target_fps times per host second; frames completed in
+// between are dropped without a copy, so a fast simulation is never
+// throttled by the display and a slow one never waits for it.
+
+#pragma once
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 6-bit RRGGBB to opaque ARGB8888, each 2-bit channel scaled by 85
+constexpr std::array<uint32_t, 64> vga_palette()
+{
+    std::array<uint32_t, 64> lut{};
+    for (uint32_t c = 0; c < 64; c++)
+        lut[c] = 0xFF000000u | (((c >> 4) & 3) * 85u) << 16 |
+                 (((c >> 2) & 3) * 85u) << 8 | (c & 3) * 85u;
+    return lut;
+}
+
+class VGADisplay
+{
+public:
+    static constexpr int H_RES = 640;
+    static constexpr int V_RES = 480;
+    static constexpr unsigned DEFAULT_FPS = 30;
+
+    // Opens the window; throws if SDL cannot provide a renderer, even with
+    // the dummy video driver.
+    explicit VGADisplay(const std::string &window_title,
+                        unsigned target_fps = DEFAULT_FPS)
+        : title(window_title),
+          frame_interval(std::chrono::microseconds(
+              1000000 / (target_fps ? target_fps : DEFAULT_FPS))),
+          back(H_RES * V_RES, 0xFF000000),
+          pending(H_RES * V_RES, 0xFF000000)
+    {
+        std::promise<std::string> ready;
+        std::future<std::string> error = ready.get_future();
+        thread = std::thread(&VGADisplay::render_loop, this, std::move(ready));
+        std::string message = error.get();
+        if (!message.empty()) {
+            thread.join();
+            throw std::runtime_error(message);
+        }
+    }
+
+    ~VGADisplay()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    VGADisplay(const VGADisplay &) = delete;
+    VGADisplay &operator=(const VGADisplay &) = delete;
+
+    // Stores the pixel at the hardware-provided position
+    inline void update_pixel(uint8_t rrggbb,
+                             bool activevideo,
+                             uint16_t x_pos,
+                             uint16_t y_pos)
+    {
+        if (activevideo && x_pos < H_RES && y_pos < V_RES)
+            back[y_pos * H_RES + x_pos] = PALETTE[rrggbb & 0x3F];
+    }
+
+    // Replaces the back buffer with a width×height RRGGBB frame scaled by
+    // scale and centred on a border colour, then ends the frame. For
+    // harnesses that rebuild frames from the framebuffer (vga_capture.h)
+    // instead of calling update_pixel() every pixel clock.
+    void draw_frame(const uint8_t *rrggbb, int width, int height, int scale,
+                    uint8_t border)
+    {
+        std::fill(back.begin(), back.end(), PALETTE[border & 0x3F]);
+        int left = (H_RES - width * scale) / 2;
+        int top = (V_RES - height * scale) / 2;
+        for (int y = 0; y < height * scale; y++) {
+            uint32_t *row = &back[(top + y) * H_RES + left];
+            const uint8_t *source = &rrggbb[(y / scale) * width];
+            for (int x = 0; x < width * scale; x++)
+                row[x] = PALETTE[source[x / scale] & 0x3F];
+        }
+        end_frame();
+    }
+
+    // Vsync falling edge marks a completed frame
+    inline void check_vsync(bool vsync)
+    {
+        if (!vsync && prev_vsync)
+            end_frame();
+        prev_vsync = vsync;
+    }
+
+    // Hands the frame to the render thread unless one was presented less
+    // than a frame interval ago.
+    void end_frame(bool force = false)
+    {
+        frames++;
+        auto now = std::chrono::steady_clock::now();
+        if (!force && now < next_present) {
+            dropped++;
+            return;
+        }
+        next_present = now + frame_interval;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = back;
+            frame_ready = true;
+        }
+        wake.notify_one();
+    }
+
+    // Presents the last (possibly partial) frame, e.g. when the run ends
+    void render() { end_frame(true); }
+
+    bool quit_requested() const
+    {
+        return quit.load(std::memory_order_relaxed);
+    }
+
+    uint64_t frames_completed() const { return frames; }
+    uint64_t frames_dropped() const { return dropped; }
+
+private:
+    static constexpr std::array<uint32_t, 64> PALETTE = vga_palette();
+
+    // SDL_Init plus window, renderer and texture; returns an empty string on
+    // success. Falls back to the dummy driver when there is no display.
+    std::string open_window()
+    {
+        if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+            fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+            if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0)
+                return std::string("SDL_Init failed: ") + SDL_GetError();
+            fprintf(stderr,
+                    "Using SDL dummy video driver (no visible window)\n");
+        }
+        window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED,
+                                  SDL_WINDOWPOS_UNDEFINED, H_RES, V_RES,
+                                  SDL_WINDOW_SHOWN);
+        if (!window)
+            return std::string("SDL_CreateWindow failed: ") + SDL_GetError();
+        renderer = SDL_CreateRenderer(window, -1, 0);
+        if (!renderer)
+            return std::string("SDL_CreateRenderer failed: ") + SDL_GetError();
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STREAMING, H_RES, V_RES);
+        if (!texture)
+            return std::string("SDL_CreateTexture failed: ") + SDL_GetError();
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+        SDL_RenderClear(renderer);
+        SDL_RenderPresent(renderer);
+        printf("[SDL2] Window opened: %dx%d '%s'\n", H_RES, V_RES,
+               title.c_str());
+        printf("[SDL2] Press ESC or close window to stop simulation early\n");
+        return "";
+    }
+
+    void close_window()
+    {
+        if (texture)
+            SDL_DestroyTexture(texture);
+        if (renderer)
+            SDL_DestroyRenderer(renderer);
+        if (window)
+            SDL_DestroyWindow(window);
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+    }
+
+    void render_loop(std::promise<std::string> ready)
+    {
+        std::string error = open_window();
+        if (!error.empty()) {
+            close_window();
+            ready.set_value(error);
+            return;
+        }
+        ready.set_value("");
+
+        std::vector<uint32_t> frame(H_RES * V_RES, 0xFF000000);
+        for (;;) {
+            bool present = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Wake up periodically to keep the window responsive
+                wake.wait_for(lock, std::chrono::milliseconds(20),
+                              [&] { return frame_ready || stopping; });
+                if (frame_ready) {
+                    frame.swap(pending);
+                    frame_ready = false;
+                    present = true;
+                }
+                if (stopping && !present)
+                    break;
+            }
+
+            SDL_Event e;
+            while (SDL_PollEvent(&e)) {
+                if (e.type == SDL_QUIT ||
+                    (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE))
+                    quit.store(true, std::memory_order_relaxed);
+            }
+            if (present) {
+                SDL_UpdateTexture(texture, nullptr, frame.data(),
+                                  H_RES * sizeof(uint32_t));
+                SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+                SDL_RenderPresent(renderer);
+            }
+        }
+        close_window();
+    }
+
+    std::string title;
+    std::chrono::steady_clock::duration frame_interval;
+    std::chrono::steady_clock::time_point next_present{};
+
+    // Simulation thread
+    std::vector<uint32_t> back;
+    bool prev_vsync = true;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+
+    // Shared with the render thread
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<uint32_t> pending;
+    bool frame_ready = false;
+    bool stopping = false;
+    std::atomic<bool> quit{false};
+
+    // Render thread
+    SDL_Window *window = nullptr;
+    SDL_Renderer *renderer = nullptr;
+    SDL_Texture *texture = nullptr;
+    std::thread thread;
+};
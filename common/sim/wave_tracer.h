@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+// MyCPU is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+
+// Waveform tracing for the Verilator harnesses.
+//
+// The format is fixed when the model is verilated: --trace gives VCD, and
+// --trace-fst together with -DSIM_TRACE_FST gives FST. FST is compressed and
+// typically an order of magnitude smaller and faster to write.
+//
+// In window mode (VCD only) the trace is kept in memory as two segments of
+// the requested number of cycles. A new segment starts with a full dump of
+// every signal, so the older segment can be dropped at any time. save()
+// writes the header and the last two segments, which always cover at least
+// the last window cycles. Long runs can therefore keep a flight recorder
+// armed and pay only for memory, not for gigabytes of disk.
+
+#pragma once
+
+#include <verilated.h>
+
+#ifdef SIM_TRACE_FST
+#include <verilated_fst_c.h>
+#else
+#include <verilated_vcd_c.h>
+#endif
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef SIM_TRACE_FST
+// In-memory VCD sink. VerilatedVcdC writes the header and a first data
+// segment on open(), and a data-only segment after each openNext().
+class VcdRingFile : public VerilatedVcdFile
+{
+    std::string header;
+    std::string previous;
+    std::string current;
+    bool split = false;
+    bool opened = false;
+
+public:
+    bool open(const std::string &) override
+    {
+        if (!opened) {
+            opened = true;
+            return true;
+        }
+        if (!split) {
+            static const std::string END = "$enddefinitions $end\n";
+            size_t end = current.find(END);
+            end = end == std::string::npos ? 0 : end + END.size();
+            header = current.substr(0, end);
+            current.erase(0, end);
+            split = true;
+        }
+        previous.swap(current);
+        current.clear();
+        return true;
+    }
+
+    void close() override {}
+
+    ssize_t write(const char *buf, ssize_t len) override
+    {
+        current.append(buf, len);
+        return len;
+    }
+
+    bool save(const std::string &filename) const
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << header << previous << current;
+        return static_cast<bool>(out);
+    }
+};
+#endif
+
+template <typename Top>
+class WaveTracer
+{
+#ifdef SIM_TRACE_FST
+    using Backend = VerilatedFstC;
+#else
+    using Backend = VerilatedVcdC;
+    std::unique_ptr<VcdRingFile> ring;
+#endif
+    std::unique_ptr<Backend> tfp;
+    std::string filename;
+    uint64_t window = 0;
+    uint64_t segment_cycles = 0;
+
+public:
+#ifdef SIM_TRACE_FST
+    static constexpr const char *FORMAT = "fst";
+#else
+    static constexpr const char *FORMAT = "vcd";
+#endif
+    static constexpr int DEFAULT_DEPTH = 99;
+
+    // Keep only the last cycles cycles (at least) in memory; call before
+    // enable().
+    void set_window(uint64_t cycles)
+    {
+#ifdef SIM_TRACE_FST
+        (void) cycles;
+        throw std::runtime_error(
+            "-trace-window needs a VCD build (TRACE_FORMAT=vcd)");
+#else
+        window = cycles;
+#endif
+    }
+
+    // Enables tracing of depth levels of hierarchy into filename.
+    void enable(const std::string &name, Top &top, int depth = DEFAULT_DEPTH)
+    {
+        filename = name;
+        Verilated::traceEverOn(true);
+#ifndef SIM_TRACE_FST
+        if (window) {
+            ring = std::make_unique<VcdRingFile>();
+            tfp = std::make_unique<Backend>(ring.get());
+        }
+#endif
+        if (!tfp)
+            tfp = std::make_unique<Backend>();
+        top.trace(tfp.get(), depth);
+        tfp->open(filename.c_str());
+        tfp->set_time_resolution("1ps");
+        tfp->set_time_unit("1ns");
+        if (!tfp->isOpen()) {
+            throw std::runtime_error("Failed to open trace file " + filename);
+        }
+    }
+
+    bool enabled() const { return tfp != nullptr; }
+    bool windowed() const { return window != 0; }
+
+    inline void dump(vluint64_t time) { tfp->dump(time); }
+
+    // Called once per traced CPU cycle
+    inline void cycle()
+    {
+#ifndef SIM_TRACE_FST
+        if (window && ++segment_cycles >= window) {
+            segment_cycles = 0;
+            tfp->openNext(true);
+        }
+#endif
+    }
+
+    // Writes the in-memory window out; the file is complete after this even
+    // if the simulation keeps running.
+    bool save()
+    {
+#ifndef SIM_TRACE_FST
+        if (ring) {
+            tfp->flush();
+            return ring->save(filename);
+        }
+#endif
+        if (tfp)
+            tfp->flush();
+        return true;
+    }
+
+    const std::string &file() const { return filename; }
+
+    ~WaveTracer()
+    {
+        if (!tfp)
+            return;
+        tfp->close();
+#ifndef SIM_TRACE_FST
+        if (ring)
+            ring->save(filename);
+#endif
+    }
+};
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Wavetable generator for the picosynth wavetable oscillators.
+
+Writes Q15 single-cycle tables of 256 samples plus a guard sample (a copy of
+sample 0) for linear interpolation:
+- sine: one table
+- band-limited saw and square: one table per octave of phase increment
+  (mip levels), each summing only the harmonics that stay below Nyquist
+  for the highest increment of its octave
+
+Phase increments are fractions of the sample rate (q15_t, Nyquist = 16384),
+so the tables do not depend on SAMPLE_RATE. Level l covers increments below
+2^(7+l) and holds 128 >> l harmonics; level 0 is capped at the 127 harmonics
+a 256-sample table can represent.
+
+All levels of a set share one scale factor, chosen so that the highest peak
+of any level (Gibbs overshoot, or the bare fundamental of a square) is
+Q15_MAX. The levels keep the same loudness instead of being normalized one
+by one.
+"""
+
+import argparse
+import math
+import sys
+from pathlib import Path
+from typing import Callable, List
+
+TABLE_SIZE = 256
+LEVELS = 8
+Q15_MAX = 32767
+
+
+def harmonics(level: int) -> int:
+    return min(127, 128 >> level)
+
+
+def additive(amplitude: Callable[[int], float], count: int) -> List[float]:
+    """One cycle of sum(amplitude(h) * sin(h * x)) for h = 1..count"""
+    return [
+        sum(amplitude(h) * math.sin(2 * math.pi * h * i / TABLE_SIZE) for h in range(1, count + 1))
+        for i in range(TABLE_SIZE)
+    ]
+
+
+def saw(h: int) -> float:
+    # Rising ramp from -1 to +1, like picosynth_wave_saw()
+    return -2 / (math.pi * h)
+
+
+def square(h: int) -> float:
+    # +1 for the first half cycle, like picosynth_wave_square()
+    return 4 / (math.pi * h) if h % 2 else 0.0
+
+
+def to_q15(table: List[float], scale: float) -> List[int]:
+    values = [max(-Q15_MAX, min(Q15_MAX, round(v * scale))) for v in table]
+    return values + values[:1]
+
+
+def mip_set(amplitude: Callable[[int], float]) -> List[List[int]]:
+    tables = [additive(amplitude, harmonics(level)) for level in range(LEVELS)]
+    scale = Q15_MAX / max(abs(v) for t in tables for v in t)
+    return [to_q15(t, scale) for t in tables]
+
+
+def format_table(values: List[int], indent: str) -> str:
+    lines = []
+    for i in range(0, len(values), 10):
+        lines.append(indent + ", ".join(f"{v:6d}" for v in values[i : i + 10]) + ",")
+    return "\n".join(lines)
+
+
+def format_set(name: str, comment: str, tables: List[List[int]]) -> str:
+    out = [f"/* {comment} */", f"static const q15_t {name}[{len(tables)}][WAVETABLE_SIZE + 1] = {{"]
+    for level, table in enumerate(tables):
+        out.append(f"    /* Level {level}: {harmonics(level)} harmonics */")
+        out.append("    {")
+        out.append(format_table(table, "        "))
+        out.append("    },")
+    out.append("};")
+    return "\n".join(out)
+
+
+def generate() -> str:
+    sine = to_q15([math.sin(2 * math.pi * i / TABLE_SIZE) for i in range(TABLE_SIZE)], Q15_MAX)
+    parts = [
+        "// SPDX-License-Identifier: MIT",
+        "// Auto-generated picosynth wavetables",
+        "// DO NOT EDIT - Generated by scripts/gen-wavetables.py",
+        "",
+        "#ifndef PICOSYNTH_WAVETABLES_H_",
+        "#define PICOSYNTH_WAVETABLES_H_",
+        "",
+        '#include "picosynth.h"',
+        '#include "tcm.h"',
+        "",
+        f"#define WAVETABLE_SIZE {TABLE_SIZE}",
+        f"#define WAVETABLE_LEVELS {LEVELS}",
+        "",
+        "/* Sine, full cycle (data TCM: every sine oscillator reads it) */",
+        "static const q15_t wavetable_sine[WAVETABLE_SIZE + 1] TCM_RODATA = {",
+        format_table(sine, "    "),
+        "};",
+        "",
+        format_set("wavetable_saw", "Band-limited rising saw, one level per octave", mip_set(saw)),
+        "",
+        format_set("wavetable_square", "Band-limited square, one level per octave", mip_set(square)),
+        "",
+        "#endif /* PICOSYNTH_WAVETABLES_H_ */",
+        "",
+    ]
+    return "\n".join(parts)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--output", "-o", default="wavetables.h", help="Output header")
+    args = parser.parse_args()
+    Path(args.output).write_text(generate())
+    print(f"Wrote {args.output}", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
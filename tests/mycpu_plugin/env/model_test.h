@@ -11,7 +11,18 @@
         .align 8; .global end_regstate; end_regstate:                   \
         .word 4;
 
+// RVMODEL_HALT_FENCE_I (4-soc): a FENCE.I before the tohost store writes
+// the data cache's dirty lines back, so the signature read from memory is
+// current when the harness stops. Encoded as a word, as the test's -march
+// may lack Zifencei.
+#ifdef RVMODEL_HALT_FENCE_I
+#define RVMODEL_HALT_FLUSH .word 0x0000100f;
+#else
+#define RVMODEL_HALT_FLUSH
+#endif
+
 #define RVMODEL_HALT                                                    \
+  RVMODEL_HALT_FLUSH                                                    \
   li x1, 1;                                                             \
   write_tohost:                                                         \
     sw x1, tohost, t5;                                                  \
@@ -3,6 +3,7 @@ import shutil
 import subprocess
 import logging
 import threading
+from concurrent.futures import ThreadPoolExecutor, as_completed
 
 import riscof.utils as utils
 from riscof.pluginTemplate import pluginTemplate
@@ -22,12 +23,31 @@ class mycpu(pluginTemplate):
             raise SystemExit(1)
 
         self.num_jobs = str(config['jobs'] if 'jobs' in config else 1)
+        # Execution backend: 'sbt' runs every test through ChiselTest in one
+        # sbt session; 'verilator' builds the stage's VTop once and runs the
+        # tests as parallel processes. MYCPU_BACKEND overrides the config.
+        self.backend = os.environ.get('MYCPU_BACKEND',
+                                      config.get('backend', 'sbt'))
+        if self.backend not in ('sbt', 'verilator'):
+            raise ValueError(f'Unknown mycpu backend: {self.backend}')
+        # Parallel Verilator processes; MYCPU_JOBS overrides, 0 means one
+        # per core
+        jobs = int(os.environ.get('MYCPU_JOBS', config.get('jobs', 0)))
+        self.sim_jobs = jobs if jobs > 0 else (os.cpu_count() or 1)
+        # Verilator cycle budget; tests normally stop at the tohost store
+        self.max_cycles = int(config.get('max_cycles', 1000000))
         self.pluginpath = os.path.abspath(config['pluginpath'])
         self.isa_spec = os.path.abspath(config['ispec'])
         self.platform_spec = os.path.abspath(config['pspec'])
 
-        # Path to MyCPU project (can be 1-single-cycle, 2-mmio-trap, or 3-pipeline)
+        # Path to MyCPU project (1-single-cycle, 2-mmio-trap, 3-pipeline or 4-soc)
         self.mycpu_project = os.path.abspath(config['PATH'])
+        # 4-soc flushes its data cache at the halt (model_test.h) so the
+        # signature is read from memory; the other stages lack FENCE.I
+        if os.path.basename(self.mycpu_project) == '4-soc':
+            self.compile_flags = '-DRVMODEL_HALT_FENCE_I'
+        else:
+            self.compile_flags = ''
 
         if 'target_run' in config and config['target_run'] == '0':
             self.target_run = False
@@ -55,6 +75,7 @@ class mycpu(pluginTemplate):
             f'-I {self.pluginpath}/env/ '
             f'-I {archtest_env} {{1}} -o {{2}} {{3}}')
         self.riscv_objcopy = f'{riscv_prefix}-objcopy'
+        self.riscv_nm = f'{riscv_prefix}-nm'
 
     def build(self, isa_yaml, platform_yaml):
         ispec = utils.load_yaml(isa_yaml)['hart0']
@@ -75,6 +96,11 @@ class mycpu(pluginTemplate):
         if "C" in ispec["ISA"]:
             self.isa += 'c'
 
+        # Bit manipulation (4-soc)
+        for ext in ('Zba', 'Zbb', 'Zbs'):
+            if ext in ispec["ISA"]:
+                self.isa += '_' + ext.lower()
+
         # Z-extensions (Zicsr, Zifencei, etc.)
         if "Zicsr" in ispec["ISA"]:
             self.isa += '_zicsr'
@@ -108,7 +134,7 @@ class mycpu(pluginTemplate):
             test_isa = testentry['isa'].lower()
             if 'zicsr' not in test_isa and 'rv32' in test_isa:
                 test_isa += '_zicsr'
-            compile_cmd = self.compile_cmd.format(test_isa, test, elf, '')
+            compile_cmd = self.compile_cmd.format(test_isa, test, elf, self.compile_flags)
 
             logger.debug('Compiling test: ' + compile_cmd)
             utils.shellCommand(compile_cmd).run(cwd=test_dir)
@@ -135,6 +161,10 @@ class mycpu(pluginTemplate):
         if not self.target_run:
             return
 
+        if self.backend == 'verilator':
+            self._run_verilator(test_metadata)
+            return
+
         # Phase 2: Generate batch test file with all tests
         logger.info(f'=== Generating batch test file with {len(test_metadata)} tests ===')
         batch_test_scala = self._generate_batch_test_scala(test_metadata)
@@ -150,7 +180,8 @@ class mycpu(pluginTemplate):
         project_map = {
             '1-single-cycle': 'singleCycle',
             '2-mmio-trap': 'mmioTrap',
-            '3-pipeline': 'pipeline'
+            '3-pipeline': 'pipeline',
+            '4-soc': 'soc'
         }
         sbt_project_name = project_map.get(project_dir_name, 'singleCycle')
         parent_dir = os.path.dirname(self.mycpu_project)
@@ -231,6 +262,92 @@ class mycpu(pluginTemplate):
 
         return
 
+    def _run_verilator(self, test_metadata):
+        """Build the stage's VTop once, then run every test on it in parallel"""
+        logger.info('=== Building Verilator model ===')
+        build_log = os.path.join(self.work_dir, 'verilator_build.log')
+        with open(build_log, 'w') as log_file:
+            result = subprocess.run(['make', '-C', self.mycpu_project, 'verilator'],
+                                    stdout=log_file, stderr=subprocess.STDOUT)
+        vtop = os.path.join(self.mycpu_project, 'verilog/verilator/obj_dir/VTop')
+        if result.returncode != 0 or not os.path.exists(vtop):
+            logger.error(f'Verilator build failed, see {build_log}')
+            for meta in test_metadata:
+                self._write_empty_signature(meta['sig_file'])
+            return
+
+        logger.info(f'=== Running {len(test_metadata)} tests on {self.sim_jobs} cores ===')
+        passed = 0
+        with ThreadPoolExecutor(max_workers=self.sim_jobs) as pool:
+            futures = {pool.submit(self._run_vtop, vtop, meta): meta
+                       for meta in test_metadata}
+            for count, future in enumerate(as_completed(futures), 1):
+                meta = futures[future]
+                try:
+                    ok, message = future.result()
+                except Exception as e:
+                    ok, message = False, str(e)
+                if ok:
+                    passed += 1
+                    logger.info(f'[{count}/{len(test_metadata)}] {meta["name"]}')
+                else:
+                    logger.warning(f'[{count}/{len(test_metadata)}] {meta["name"]}: {message}')
+                if not os.path.exists(meta['sig_file']):
+                    self._write_empty_signature(meta['sig_file'])
+
+        logger.info(f'Results: {passed} reached tohost, '
+                    f'{len(test_metadata) - passed} did not')
+
+    def _run_vtop(self, vtop, meta):
+        """Runs one test; returns (reached tohost, message)"""
+        symbols = self._symbols(meta['elf'])
+        begin = symbols.get('begin_signature')
+        end = symbols.get('end_signature')
+        tohost = symbols.get('tohost')
+        if begin is None or end is None or end <= begin:
+            # Same fallback region as the ChiselTest harness
+            begin, end = 0x1000, 0x2004
+        cmd = [vtop, '-fast-clock',
+               '-instruction', meta['asmbin'],
+               '-time', str(self.max_cycles * 4),
+               '-signature', hex(begin), hex(end), meta['sig_file']]
+        if tohost is not None:
+            cmd += ['-tohost', hex(tohost)]
+
+        sim_log = os.path.join(meta['test_dir'], 'verilator.log')
+        with open(sim_log, 'w') as log_file:
+            log_file.write(' '.join(cmd) + '\n')
+            log_file.flush()
+            try:
+                result = subprocess.run(cmd, cwd=meta['test_dir'], stdout=log_file,
+                                        stderr=subprocess.STDOUT, timeout=300)
+            except subprocess.TimeoutExpired:
+                return False, f'timed out, see {sim_log}'
+        if tohost is None:
+            return True, ''
+        with open(sim_log) as log_file:
+            if result.returncode != 0 or 'tohost: test passed' not in log_file.read():
+                return False, f'no tohost pass (exit status {result.returncode}), see {sim_log}'
+        return True, ''
+
+    def _symbols(self, elf):
+        """Address of every symbol in elf, by name"""
+        output = subprocess.run([self.riscv_nm, elf], capture_output=True,
+                                text=True, check=True).stdout
+        symbols = {}
+        for line in output.splitlines():
+            parts = line.split()
+            if len(parts) == 3:
+                symbols[parts[2]] = int(parts[0], 16)
+        return symbols
+
+    @staticmethod
+    def _write_empty_signature(sig_file):
+        # Lets RISCOF continue and report the test as failed
+        with open(sig_file, 'w') as f:
+            for i in range(256):
+                f.write('00000000\n')
+
     def _generate_test_scala(self, testname, elfFile, sigFile, asmbinFile):
         """Generate Scala test file for this compliance test"""
         return f'''// Auto-generated compliance test